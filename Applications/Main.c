@@ -44,6 +44,19 @@
 #include "HAPPlatformAccessorySetupNFC+Init.h"
 #endif
 
+// Accessory server statistics may be exported over a Unix domain socket on platforms with a file handle based run loop.
+#if !defined(_WIN32) && !defined(DARWIN)
+#define HAVE_STATISTICS_SOCKET 1
+#include <fcntl.h>
+#include <stdarg.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "HAPPlatformFileHandle.h"
+#endif
+
 #ifdef _WIN32
 #if defined(_DEBUG)
 #ifdef VLD
@@ -73,6 +86,12 @@ static bool clearPairings = false;
 
 #define PREFERRED_ADVERTISING_INTERVAL (HAPBLEAdvertisingIntervalCreateFromMilliseconds(417.5f))
 
+/**
+ * Capacity of the event notification storage per IP session, with room for a value digest per attribute.
+ * Only the part that the attribute database requires is used.
+ */
+#define MAX_IP_EVENT_NOTIFICATIONS (HAPIPSessionGetNumEventNotifications(kAttributeCount, kAttributeCount))
+
 /**
  * Global platform objects.
  * Only tracks objects that will be released in DeinitializePlatform.
@@ -147,7 +166,8 @@ static void InitializePlatform(void) {
             &(const HAPPlatformTCPStreamManagerOptions) {
                     .interfaceName = NULL,       // Listen on all available network interfaces.
                     .port = kHAPNetworkPort_Any, // Listen on unused port number from the ephemeral port range.
-                    .maxConcurrentTCPStreams = kHAPIPSessionStorage_DefaultNumElements });
+                    // One spare TCP stream so that new connections can replace idle sessions when all are in use.
+                    .maxConcurrentTCPStreams = kHAPIPSessionStorage_DefaultNumElements + 1 });
 
     // Service discovery.
     static HAPPlatformServiceDiscovery serviceDiscovery;
@@ -274,21 +294,27 @@ void HandleUpdatedState(HAPAccessoryServerRef* _Nonnull server, void* _Nullable
 
 #if IP
 static void InitializeIP(void) {
+    // Determine the storage that the attribute database requires.
+    HAPAccessoryServerStorageUsage requirements;
+    HAPAccessoryServerGetStorageRequirements(AppGetAccessoryInfo(), /* bridgedAccessories: */ NULL, &requirements);
+
     // Prepare accessory server storage.
     static HAPIPSession ipSessions[kHAPIPSessionStorage_DefaultNumElements];
     static uint8_t ipInboundBuffers[HAPArrayCount(ipSessions)][kHAPIPSession_DefaultInboundBufferSize];
     static uint8_t ipOutboundBuffers[HAPArrayCount(ipSessions)][kHAPIPSession_DefaultOutboundBufferSize];
-    static HAPIPEventNotificationRef ipEventNotifications[HAPArrayCount(ipSessions)][kAttributeCount];
+    static HAPIPEventNotificationRef ipEventNotifications[HAPArrayCount(ipSessions)][MAX_IP_EVENT_NOTIFICATIONS];
+    HAPPrecondition(requirements.ip.numEventNotifications <= HAPArrayCount(ipEventNotifications[0]));
     for (size_t i = 0; i < HAPArrayCount(ipSessions); i++) {
         ipSessions[i].inboundBuffer.bytes = ipInboundBuffers[i];
         ipSessions[i].inboundBuffer.numBytes = sizeof ipInboundBuffers[i];
         ipSessions[i].outboundBuffer.bytes = ipOutboundBuffers[i];
         ipSessions[i].outboundBuffer.numBytes = sizeof ipOutboundBuffers[i];
         ipSessions[i].eventNotifications = ipEventNotifications[i];
-        ipSessions[i].numEventNotifications = HAPArrayCount(ipEventNotifications[i]);
+        ipSessions[i].numEventNotifications = requirements.ip.numEventNotifications;
     }
     static HAPIPReadContextRef ipReadContexts[kAttributeCount];
     static HAPIPWriteContextRef ipWriteContexts[kAttributeCount];
+    static HAPIPCharacteristicIndexElementRef ipCharacteristicIndexElements[kAttributeCount];
     static uint8_t ipScratchBuffer[kHAPIPSession_DefaultScratchBufferSize];
     static HAPIPAccessoryServerStorage ipAccessoryServerStorage = {
         .sessions = ipSessions,
@@ -297,6 +323,8 @@ static void InitializeIP(void) {
         .numReadContexts = HAPArrayCount(ipReadContexts),
         .writeContexts = ipWriteContexts,
         .numWriteContexts = HAPArrayCount(ipWriteContexts),
+        .characteristicIndexElements = ipCharacteristicIndexElements,
+        .numCharacteristicIndexElements = HAPArrayCount(ipCharacteristicIndexElements),
         .scratchBuffer = { .bytes = ipScratchBuffer, .numBytes = sizeof ipScratchBuffer }
     };
 
@@ -333,6 +361,297 @@ static void InitializeBLE(void) {
 }
 #endif
 
+#if HAVE_STATISTICS_SOCKET
+/**
+ * Command line option that enables the statistics socket. Takes the path of the Unix domain socket as argument.
+ *
+ * - Connecting to the socket (e.g., with "nc -U <path>") returns a text report and closes it.
+ *
+ * - The socket is only accessible by the user that runs the application.
+ */
+#define kStatisticsSocketOption "--statistics-socket"
+
+/**
+ * Statistics socket.
+ */
+static struct {
+    /** Listening socket. -1 if not open. */
+    int fileDescriptor;
+
+    /** File handle of the listening socket. */
+    HAPPlatformFileHandleRef fileHandle;
+
+    /** Path of the listening socket. */
+    const char* path;
+} statisticsSocket = { .fileDescriptor = -1 };
+
+/**
+ * Statistics client.
+ */
+typedef struct {
+    /** Client socket. Non-blocking. */
+    int fileDescriptor;
+
+    /**
+     * Whether the report has been truncated because the client did not receive it fast enough.
+     * The run loop is never blocked by a statistics client.
+     */
+    bool isTruncated;
+} StatisticsClient;
+
+/**
+ * Names of the request types, as reported over the statistics socket.
+ */
+static const char* const statisticsRequestTypeNames[] = {
+    "get_accessories", "get_characteristics", "put_characteristics", "prepare",      "pair_setup",
+    "pair_verify",     "pairings",            "event_notification",  "ble_procedure"
+};
+HAP_STATIC_ASSERT(
+        HAPArrayCount(statisticsRequestTypeNames) == kHAPAccessoryServerRequestType_NumTypes,
+        statisticsRequestTypeNames_complete);
+
+/**
+ * Writes a formatted line to a statistics client.
+ *
+ * - Once a line cannot be written completely without blocking, the report is truncated.
+ *
+ * @param      client               Statistics client.
+ * @param      format               A format string.
+ * @param      ...                  Arguments for the format string.
+ */
+HAP_PRINTFLIKE(2, 3)
+static void WriteStatisticsLine(StatisticsClient* client, const char* format, ...) {
+    HAPPrecondition(client);
+
+    if (client->isTruncated) {
+        return;
+    }
+
+    char line[256];
+    va_list args;
+    va_start(args, format);
+    int numBytes = vsnprintf(line, sizeof line, format, args);
+    va_end(args);
+    if (numBytes > 0) {
+        size_t numLineBytes = HAPMin((size_t) numBytes, sizeof line - 1);
+        ssize_t numSentBytes = send(client->fileDescriptor, line, numLineBytes, MSG_NOSIGNAL);
+        if (numSentBytes < 0 || (size_t) numSentBytes != numLineBytes) {
+            client->isTruncated = true;
+        }
+    }
+}
+
+static void WriteCharacteristicStatistics(
+        void* _Nullable context,
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPCharacteristicStatistics* statistics,
+        bool* shouldContinue) {
+    HAPPrecondition(context);
+    StatisticsClient* client = context;
+    HAPPrecondition(shouldContinue);
+
+    WriteStatisticsLine(
+            client,
+            "characteristic %llu.%llu reads %lu read_total_ms %lu read_max_ms %lu "
+            "writes %lu write_total_ms %lu write_max_ms %lu\n",
+            (unsigned long long) statistics->accessory->aid,
+            (unsigned long long) statistics->iid,
+            (unsigned long) statistics->read.numCalls,
+            (unsigned long) statistics->read.totalDuration,
+            (unsigned long) statistics->read.maxDuration,
+            (unsigned long) statistics->write.numCalls,
+            (unsigned long) statistics->write.totalDuration,
+            (unsigned long) statistics->write.maxDuration);
+    *shouldContinue = !client->isTruncated;
+}
+
+static void WriteIPSessionStatistics(
+        void* _Nullable context,
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPIPSessionStatistics* statistics,
+        bool* shouldContinue) {
+    HAPPrecondition(context);
+    StatisticsClient* client = context;
+    HAPPrecondition(shouldContinue);
+
+    WriteStatisticsLine(
+            client,
+            "session %zu secured %d bytes_received %llu bytes_sent %llu\n",
+            statistics->sessionIndex,
+            statistics->isSecured ? 1 : 0,
+            (unsigned long long) statistics->numBytesReceived,
+            (unsigned long long) statistics->numBytesSent);
+    *shouldContinue = !client->isTruncated;
+}
+
+/**
+ * Sets a socket to non-blocking mode.
+ *
+ * @param      fileDescriptor       Socket.
+ *
+ * @return true                     If successful.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool SetNonBlocking(int fileDescriptor) {
+    int flags = fcntl(fileDescriptor, F_GETFL);
+    return flags != -1 && fcntl(fileDescriptor, F_SETFL, flags | O_NONBLOCK) != -1;
+}
+
+/**
+ * Accepts a statistics client and writes the accessory server statistics to it.
+ *
+ * - The report is written without blocking. It is truncated if it does not fit into the socket send buffer.
+ */
+static void HandleStatisticsSocketEvent(
+        HAPPlatformFileHandleRef fileHandle HAP_UNUSED,
+        HAPPlatformFileHandleEvent fileHandleEvents,
+        void* _Nullable context HAP_UNUSED) {
+    if (!fileHandleEvents.isReadyForReading) {
+        return;
+    }
+    StatisticsClient client = { .fileDescriptor = accept(statisticsSocket.fileDescriptor, NULL, NULL) };
+    if (client.fileDescriptor == -1) {
+        return;
+    }
+    if (!SetNonBlocking(client.fileDescriptor)) {
+        (void) close(client.fileDescriptor);
+        return;
+    }
+
+    HAPAccessoryServerStatistics statistics;
+    HAPAccessoryServerGetStatistics(&accessoryServer, &statistics);
+    for (size_t i = 0; i < HAPArrayCount(statistics.requests); i++) {
+        const HAPLatencyHistogram* histogram = &statistics.requests[i];
+        char buckets[16 * kHAPLatencyHistogram_NumBuckets];
+        size_t numBucketBytes = 0;
+        for (size_t j = 0; j < HAPArrayCount(histogram->buckets); j++) {
+            int n = snprintf(
+                    &buckets[numBucketBytes],
+                    sizeof buckets - numBucketBytes,
+                    " %lu",
+                    (unsigned long) histogram->buckets[j]);
+            if (n > 0) {
+                numBucketBytes = HAPMin(numBucketBytes + (size_t) n, sizeof buckets - 1);
+            }
+        }
+        buckets[numBucketBytes] = '\0';
+        WriteStatisticsLine(
+                &client,
+                "request %s count %lu total_ms %llu max_ms %lu buckets%s\n",
+                statisticsRequestTypeNames[i],
+                (unsigned long) histogram->numSamples,
+                (unsigned long long) histogram->totalLatency,
+                (unsigned long) histogram->maxLatency,
+                buckets);
+    }
+    WriteStatisticsLine(
+            &client,
+            "ip sessions_accepted %lu bytes_received %llu bytes_sent %llu\n",
+            (unsigned long) statistics.ip.numSessionsAccepted,
+            (unsigned long long) statistics.ip.numBytesReceived,
+            (unsigned long long) statistics.ip.numBytesSent);
+    HAPAccessoryServerEnumerateIPSessionStatistics(&accessoryServer, WriteIPSessionStatistics, &client);
+    HAPAccessoryServerEnumerateCharacteristicStatistics(&accessoryServer, WriteCharacteristicStatistics, &client);
+    if (client.isTruncated) {
+        HAPLog(&kHAPLog_Default, "Statistics report truncated (client not receiving).");
+    }
+
+    (void) close(client.fileDescriptor);
+}
+
+/**
+ * Returns the path of the statistics socket, if it has been requested on the command line.
+ *
+ * @param      argc                 Number of command line arguments.
+ * @param      argv                 Command line arguments.
+ *
+ * @return Path of the statistics socket, if requested. NULL otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static const char* _Nullable GetStatisticsSocketPath(int argc, char* _Nullable argv[_Nullable]) {
+    if (!argv) {
+        return NULL;
+    }
+    for (int i = 1; i + 1 < argc; i++) {
+        if (argv[i] && HAPStringAreEqual(HAPNonnull(argv[i]), kStatisticsSocketOption)) {
+            return argv[i + 1];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Opens the statistics socket.
+ *
+ * @param      path                 Path of the Unix domain socket. Must remain valid until the socket is closed.
+ */
+static void InitializeStatisticsSocket(const char* path) {
+    HAPPrecondition(path);
+
+    HAPError err;
+
+    struct sockaddr_un address = { .sun_family = AF_UNIX };
+    size_t numPathBytes = HAPStringGetNumBytes(path);
+    if (numPathBytes >= sizeof address.sun_path) {
+        HAPLogError(&kHAPLog_Default, "Statistics socket path too long: %s.", path);
+        return;
+    }
+    HAPRawBufferCopyBytes(address.sun_path, path, numPathBytes + 1);
+    (void) unlink(path);
+
+    int fileDescriptor = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fileDescriptor == -1) {
+        HAPLogError(&kHAPLog_Default, "Failed to create statistics socket.");
+        return;
+    }
+    if (!SetNonBlocking(fileDescriptor)) {
+        HAPLogError(&kHAPLog_Default, "Failed to configure statistics socket.");
+        (void) close(fileDescriptor);
+        return;
+    }
+    // Restrict access to the user that runs the application.
+    mode_t mask = umask(S_IRWXG | S_IRWXO);
+    int e = bind(fileDescriptor, (const struct sockaddr*) &address, sizeof address);
+    (void) umask(mask);
+    if (e == -1 || listen(fileDescriptor, /* backlog: */ 1) == -1) {
+        HAPLogError(&kHAPLog_Default, "Failed to listen on statistics socket %s.", path);
+        (void) close(fileDescriptor);
+        return;
+    }
+    err = HAPPlatformFileHandleRegister(
+            &statisticsSocket.fileHandle,
+            fileDescriptor,
+            (HAPPlatformFileHandleEvent) {
+                    .isReadyForReading = true, .isReadyForWriting = false, .hasErrorConditionPending = false },
+            HandleStatisticsSocketEvent,
+            /* context: */ NULL);
+    if (err) {
+        HAPAssert(err == kHAPError_OutOfResources);
+        HAPLogError(&kHAPLog_Default, "Failed to register statistics socket.");
+        (void) close(fileDescriptor);
+        (void) unlink(path);
+        return;
+    }
+    statisticsSocket.fileDescriptor = fileDescriptor;
+    statisticsSocket.path = path;
+    HAPLogInfo(&kHAPLog_Default, "Exporting accessory server statistics on %s.", path);
+}
+
+/**
+ * Closes the statistics socket.
+ */
+static void DeinitializeStatisticsSocket(void) {
+    if (statisticsSocket.fileDescriptor == -1) {
+        return;
+    }
+    HAPPlatformFileHandleDeregister(statisticsSocket.fileHandle);
+    (void) close(statisticsSocket.fileDescriptor);
+    (void) unlink(statisticsSocket.path);
+    statisticsSocket.fileDescriptor = -1;
+}
+#endif
+
 #ifdef _WIN32
 //static 
 BOOL WINAPI	ConsoleControlHandler( DWORD inControlEvent )
@@ -479,6 +798,14 @@ int main(int argc, char* _Nullable argv[_Nullable]) {
             &platform.hapAccessoryServerCallbacks,
             /* context: */ NULL);
 
+#if HAVE_STATISTICS_SOCKET
+    // Export accessory server statistics if requested.
+    const char* _Nullable statisticsSocketPath = GetStatisticsSocketPath(argc, argv);
+    if (statisticsSocketPath) {
+        InitializeStatisticsSocket(HAPNonnull(statisticsSocketPath));
+    }
+#endif
+
     // Create app object.
     AppCreate(&accessoryServer, &platform.keyValueStore);
 
@@ -492,6 +819,10 @@ int main(int argc, char* _Nullable argv[_Nullable]) {
     // Cleanup.
     AppRelease();
 
+#if HAVE_STATISTICS_SOCKET
+    DeinitializeStatisticsSocket();
+#endif
+
     HAPAccessoryServerRelease(&accessoryServer);
 
     DeinitializePlatform();
@@ -6,6 +6,12 @@
 
 #include "util_http_reader.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 #define CR 13
 #define LF 10
 #define SP 32
@@ -34,40 +40,105 @@ void util_http_reader_init(struct util_http_reader* r, int type) {
     r->result_length = 0;
 }
 
-HAP_RESULT_USE_CHECK
-static int is_digit(int c) {
-    return ('0' <= c) && (c <= '9');
-}
-
-HAP_RESULT_USE_CHECK
-static int is_whitespace(int c) {
-    return (c == SP) || (c == HT);
-}
+#define CLASS_TOKEN      0x01
+#define CLASS_URI        0x02
+#define CLASS_VERSION    0x04
+#define CLASS_DIGIT      0x08
+#define CLASS_TEXT       0x10
+#define CLASS_PLAIN_TEXT 0x20
 
-HAP_RESULT_USE_CHECK
-static int is_token_char(int c) {
-    return (33 <= c) && (c < 127) && (c != '(') && (c != ')') && (c != '<') && (c != '>') && (c != '@') && (c != ',') &&
-           (c != ';') && (c != ':') && (c != '\\') && (c != '"') && (c != '/') && (c != '[') && (c != ']') &&
-           (c != '?') && (c != '=') && (c != '{') && (c != '}');
-}
+/**
+ * Character classes of all octets.
+ *
+ * - CLASS_TOKEN: token characters (RFC 7230, Section 3.2.6).
+ * - CLASS_URI: characters that may appear in a request target.
+ * - CLASS_VERSION: characters that may appear in an HTTP version.
+ * - CLASS_DIGIT: decimal digits.
+ * - CLASS_TEXT: characters that may appear in a header field value or a reason phrase.
+ * - CLASS_PLAIN_TEXT: text characters that do not need further inspection, i.e. excluding HT, '"' and '\'.
+ */
+static const uint8_t char_classes[256] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x30, 0x33, 0x10, 0x33, 0x33, 0x33, 0x33, 0x33, 0x32, 0x32, 0x33, 0x33, 0x32, 0x33, 0x37, 0x36,
+    0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x32, 0x32, 0x30, 0x32, 0x30, 0x32,
+    0x32, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x37, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33,
+    0x37, 0x33, 0x33, 0x33, 0x37, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x32, 0x10, 0x32, 0x31, 0x33,
+    0x31, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33,
+    0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x30, 0x31, 0x30, 0x33, 0x00,
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30,
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30,
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30,
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30,
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30,
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30,
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30,
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30,
+};
 
 HAP_RESULT_USE_CHECK
-static int is_uri_char(int c) {
-    return (('A' <= c) && (c <= 'Z')) || (('a' <= c) && (c <= 'z')) || (('0' <= c) && (c <= '9')) || (c == '%') ||
-           (c == '-') || (c == '.') || (c == '_') || (c == '~') || (c == ':') || (c == '/') || (c == '?') ||
-           (c == '#') || (c == '[') || (c == ']') || (c == '@') || (c == '!') || (c == '$') || (c == '&') ||
-           (c == '\'') || (c == '(') || (c == ')') || (c == '*') || (c == '+') || (c == ',') || (c == ';') ||
-           (c == '=');
+static int is_char_of_class(int c, uint8_t char_class) {
+    return (char_classes[(uint8_t) c] & char_class) != 0;
 }
 
 HAP_RESULT_USE_CHECK
-static int is_version_char(int c) {
-    return (c == 'H') || (c == 'T') || (c == 'P') || (c == '/') || (c == '.') || (('0' <= c) && (c <= '9'));
+static int is_whitespace(int c) {
+    return (c == SP) || (c == HT);
 }
 
+/**
+ * Returns the number of leading plain text octets in a buffer.
+ *
+ * On platforms with SIMD support, 16 octets are inspected at a time. Control characters (including CR and LF),
+ * DEL, '"' and '\' terminate the scan.
+ */
 HAP_RESULT_USE_CHECK
-static int is_text_char(int c) {
-    return (c < 0) || ((32 <= c) && (c < 127)) || (128 <= c) || (c == HT);
+static size_t skip_plain_text(const char* buffer, size_t length) {
+    size_t n;
+    HAPPrecondition(buffer != NULL);
+    n = 0;
+#if defined(__SSE2__)
+    {
+        const __m128i max_control = _mm_set1_epi8(0x1F);
+        const __m128i del = _mm_set1_epi8(0x7F);
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        while (length - n >= 16) {
+            __m128i v = _mm_loadu_si128((const __m128i*) &buffer[n]);
+            __m128i special = _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(_mm_min_epu8(v, max_control), v), _mm_cmpeq_epi8(v, del)),
+                    _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)));
+            int mask = _mm_movemask_epi8(special);
+            if (mask) {
+                return n + (size_t) __builtin_ctz((unsigned int) mask);
+            }
+            n += 16;
+        }
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    {
+        const uint8x16_t min_printable = vdupq_n_u8(0x20);
+        const uint8x16_t del = vdupq_n_u8(0x7F);
+        const uint8x16_t quote = vdupq_n_u8('"');
+        const uint8x16_t backslash = vdupq_n_u8('\\');
+        while (length - n >= 16) {
+            uint8x16_t v = vld1q_u8((const uint8_t*) &buffer[n]);
+            uint8x16_t special = vorrq_u8(
+                    vorrq_u8(vcltq_u8(v, min_printable), vceqq_u8(v, del)),
+                    vorrq_u8(vceqq_u8(v, quote), vceqq_u8(v, backslash)));
+            if (vmaxvq_u8(special)) {
+                // Locate the special octet within this block using the scalar loop below.
+                break;
+            }
+            n += 16;
+        }
+    }
+#endif
+    while ((n < length) && is_char_of_class(buffer[n], CLASS_PLAIN_TEXT)) {
+        n++;
+    }
+    HAPAssert((n == length) || ((n < length) && !is_char_of_class(buffer[n], CLASS_PLAIN_TEXT)));
+    return n;
 }
 
 HAP_RESULT_USE_CHECK
@@ -84,34 +155,49 @@ static size_t skip_whitespace(char* buffer, size_t length) {
 }
 
 HAP_RESULT_USE_CHECK
-static size_t read_octets(struct util_http_reader* r, char* buffer, size_t length, int (*predicate)(int)) {
+static size_t read_octets(struct util_http_reader* r, char* buffer, size_t length, uint8_t char_class) {
     size_t n;
     HAPPrecondition(r != NULL);
     HAPPrecondition(buffer != NULL);
-    HAPPrecondition(predicate != NULL);
     n = 0;
     HAPAssert(n <= length);
-    while ((n < length) && predicate(buffer[n])) {
-        n++;
+    if (char_class == CLASS_TEXT) {
+        for (;;) {
+            n += skip_plain_text(&buffer[n], length - n);
+            if ((n == length) || !is_char_of_class(buffer[n], CLASS_TEXT)) {
+                break;
+            }
+            n++;
+        }
+    } else {
+        while ((n < length) && is_char_of_class(buffer[n], char_class)) {
+            n++;
+        }
     }
-    HAPAssert((n == length) || ((n < length) && !predicate(buffer[n])));
+    HAPAssert((n == length) || ((n < length) && !is_char_of_class(buffer[n], char_class)));
     r->result_token = buffer;
     r->result_length = n;
     return n;
 }
 
 HAP_RESULT_USE_CHECK
-static size_t read_octets_and_quotes(struct util_http_reader* r, char* buffer, size_t length, int (*predicate)(int)) {
+static size_t read_octets_and_quotes(struct util_http_reader* r, char* buffer, size_t length) {
     size_t n;
     HAPPrecondition(r != NULL);
     HAPPrecondition(buffer != NULL);
-    HAPPrecondition(predicate != NULL);
     n = 0;
     HAPAssert(n <= length);
-    while ((n < length) && (r->in_quoted_pair || predicate(buffer[n]))) {
+    while (n < length) {
         if (r->in_quoted_pair) {
             r->in_quoted_pair = 0;
-        } else if (r->in_quoted_string) {
+            n++;
+            continue;
+        }
+        n += skip_plain_text(&buffer[n], length - n);
+        if ((n == length) || !is_char_of_class(buffer[n], CLASS_TEXT)) {
+            break;
+        }
+        if (r->in_quoted_string) {
             if (buffer[n] == '\\') {
                 r->in_quoted_pair = 1;
             } else if (buffer[n] == '"') {
@@ -122,7 +208,7 @@ static size_t read_octets_and_quotes(struct util_http_reader* r, char* buffer, s
         }
         n++;
     }
-    HAPAssert((n == length) || ((n < length) && !r->in_quoted_pair && !predicate(buffer[n])));
+    HAPAssert((n == length) || ((n < length) && !r->in_quoted_pair && !is_char_of_class(buffer[n], CLASS_TEXT)));
     r->result_token = buffer;
     r->result_length = n;
     return n;
@@ -167,14 +253,14 @@ size_t util_http_reader_read(struct util_http_reader* r, char* buffer, size_t le
                     break;
                 case util_HTTP_READER_STATE_READING_METHOD:
                     if (r->substate == SUBSTATE_NONE) {
-                        if (is_token_char(buffer[n])) {
+                        if (is_char_of_class(buffer[n], CLASS_TOKEN)) {
                             r->substate = SUBSTATE_READING;
                         } else {
                             r->state = util_HTTP_READER_STATE_ERROR;
                         }
                     } else {
                         HAPAssert(r->substate == SUBSTATE_READING);
-                        n += read_octets(r, &buffer[n], length - n, is_token_char);
+                        n += read_octets(r, &buffer[n], length - n, CLASS_TOKEN);
                         HAPAssert(n <= length);
                         if (n < length) {
                             r->state = util_HTTP_READER_STATE_COMPLETED_METHOD;
@@ -205,14 +291,14 @@ size_t util_http_reader_read(struct util_http_reader* r, char* buffer, size_t le
                     break;
                 case util_HTTP_READER_STATE_READING_URI:
                     if (r->substate == SUBSTATE_NONE) {
-                        if (is_uri_char(buffer[n])) {
+                        if (is_char_of_class(buffer[n], CLASS_URI)) {
                             r->substate = SUBSTATE_READING;
                         } else {
                             r->state = util_HTTP_READER_STATE_ERROR;
                         }
                     } else {
                         HAPAssert(r->substate == SUBSTATE_READING);
-                        n += read_octets(r, &buffer[n], length - n, is_uri_char);
+                        n += read_octets(r, &buffer[n], length - n, CLASS_URI);
                         HAPAssert(n <= length);
                         if (n < length) {
                             r->state = util_HTTP_READER_STATE_COMPLETED_URI;
@@ -269,14 +355,14 @@ size_t util_http_reader_read(struct util_http_reader* r, char* buffer, size_t le
                     break;
                 case util_HTTP_READER_STATE_READING_VERSION:
                     if (r->substate == SUBSTATE_NONE) {
-                        if (is_version_char(buffer[n])) {
+                        if (is_char_of_class(buffer[n], CLASS_VERSION)) {
                             r->substate = SUBSTATE_READING;
                         } else {
                             r->state = util_HTTP_READER_STATE_ERROR;
                         }
                     } else {
                         HAPAssert(r->substate == SUBSTATE_READING);
-                        n += read_octets(r, &buffer[n], length - n, is_version_char);
+                        n += read_octets(r, &buffer[n], length - n, CLASS_VERSION);
                         HAPAssert(n <= length);
                         if (n < length) {
                             r->state = util_HTTP_READER_STATE_COMPLETED_VERSION;
@@ -312,14 +398,14 @@ size_t util_http_reader_read(struct util_http_reader* r, char* buffer, size_t le
                     break;
                 case util_HTTP_READER_STATE_READING_STATUS:
                     if (r->substate == SUBSTATE_NONE) {
-                        if (is_digit(buffer[n])) {
+                        if (is_char_of_class(buffer[n], CLASS_DIGIT)) {
                             r->substate = SUBSTATE_READING;
                         } else {
                             r->state = util_HTTP_READER_STATE_ERROR;
                         }
                     } else {
                         HAPAssert(r->substate == SUBSTATE_READING);
-                        n += read_octets(r, &buffer[n], length - n, is_digit);
+                        n += read_octets(r, &buffer[n], length - n, CLASS_DIGIT);
                         HAPAssert(n <= length);
                         if (n < length) {
                             r->state = util_HTTP_READER_STATE_COMPLETED_STATUS;
@@ -349,7 +435,7 @@ size_t util_http_reader_read(struct util_http_reader* r, char* buffer, size_t le
                     }
                     break;
                 case util_HTTP_READER_STATE_READING_REASON:
-                    n += read_octets(r, &buffer[n], length - n, is_text_char);
+                    n += read_octets(r, &buffer[n], length - n, CLASS_TEXT);
                     HAPAssert(n <= length);
                     if (n < length) {
                         r->state = util_HTTP_READER_STATE_COMPLETED_REASON;
@@ -382,14 +468,14 @@ size_t util_http_reader_read(struct util_http_reader* r, char* buffer, size_t le
                     break;
                 case util_HTTP_READER_STATE_READING_HEADER_NAME:
                     if (r->substate == SUBSTATE_NONE) {
-                        if (is_token_char(buffer[n])) {
+                        if (is_char_of_class(buffer[n], CLASS_TOKEN)) {
                             r->substate = SUBSTATE_READING;
                         } else {
                             r->state = util_HTTP_READER_STATE_ENDING_HEADER_LINES;
                         }
                     } else {
                         HAPAssert(r->substate == SUBSTATE_READING);
-                        n += read_octets(r, &buffer[n], length - n, is_token_char);
+                        n += read_octets(r, &buffer[n], length - n, CLASS_TOKEN);
                         HAPAssert(n <= length);
                         if (n < length) {
                             r->state = util_HTTP_READER_STATE_COMPLETED_HEADER_NAME;
@@ -409,7 +495,7 @@ size_t util_http_reader_read(struct util_http_reader* r, char* buffer, size_t le
                     }
                     break;
                 case util_HTTP_READER_STATE_READING_HEADER_VALUE:
-                    n += read_octets_and_quotes(r, &buffer[n], length - n, is_text_char);
+                    n += read_octets_and_quotes(r, &buffer[n], length - n);
                     HAPAssert(n <= length);
                     if (n < length) {
                         r->state = util_HTTP_READER_STATE_COMPLETED_HEADER_VALUE;
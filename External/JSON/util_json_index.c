@@ -0,0 +1,337 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "util_json_index.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#define BLOCK_SIZE 16
+
+#define NO_POSITION SIZE_MAX
+
+void util_json_index_init(struct util_json_index* x, const char* buffer, size_t length) {
+    HAPPrecondition(x != NULL);
+    HAPPrecondition(buffer != NULL);
+    x->state = util_JSON_READER_STATE_READING_WHITESPACE;
+    x->token = NULL;
+    x->token_length = 0;
+    x->position = 0;
+    x->buffer = buffer;
+    x->length = length;
+    x->scanned = 0;
+    x->escaped_position = NO_POSITION;
+    x->in_string = 0;
+    x->num_structurals = 0;
+    x->next_structural = 0;
+}
+
+HAP_RESULT_USE_CHECK
+static int is_whitespace(int c) {
+    return (c == ' ') || (c == '\t') || (c == '\n') || (c == '\r');
+}
+
+HAP_RESULT_USE_CHECK
+static int is_digit(int c) {
+    return ('0' <= c) && (c <= '9');
+}
+
+HAP_RESULT_USE_CHECK
+static int is_structural_candidate(int c) {
+    return (c == '"') || (c == '\\') || (c == '{') || (c == '}') || (c == '[') || (c == ']') || (c == ':') ||
+           (c == ',');
+}
+
+HAP_RESULT_USE_CHECK
+static size_t count_trailing_zeros(uint32_t mask) {
+    HAPPrecondition(mask != 0);
+#if defined(__GNUC__)
+    return (size_t) __builtin_ctz(mask);
+#else
+    size_t n = 0;
+    while (!(mask & 1)) {
+        mask >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+/**
+ * Classifies a block of at most BLOCK_SIZE octets.
+ *
+ * @return Bit mask with bit i set if octet i is a quote, a backslash, a brace, a bracket, a colon or a comma.
+ */
+HAP_RESULT_USE_CHECK
+static uint32_t classify_block(const char* block, size_t length) {
+    uint32_t mask;
+    size_t i;
+    HAPPrecondition(block != NULL);
+    HAPPrecondition(length <= BLOCK_SIZE);
+#if defined(__SSE2__)
+    if (length == BLOCK_SIZE) {
+        // '[' and ']' differ from '{' and '}' only in bit 0x20.
+        __m128i v = _mm_loadu_si128((const __m128i*) block);
+        __m128i braces = _mm_or_si128(v, _mm_set1_epi8(0x20));
+        __m128i candidates = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(braces, _mm_set1_epi8('{')), _mm_cmpeq_epi8(braces, _mm_set1_epi8('}'))),
+                _mm_or_si128(
+                        _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(':')), _mm_cmpeq_epi8(v, _mm_set1_epi8(','))),
+                        _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\\')))));
+        return (uint32_t) _mm_movemask_epi8(candidates);
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    if (length == BLOCK_SIZE) {
+        static const uint8_t bit_weights[BLOCK_SIZE] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+        // '[' and ']' differ from '{' and '}' only in bit 0x20.
+        uint8x16_t v = vld1q_u8((const uint8_t*) block);
+        uint8x16_t braces = vorrq_u8(v, vdupq_n_u8(0x20));
+        uint8x16_t candidates = vorrq_u8(
+                vorrq_u8(vceqq_u8(braces, vdupq_n_u8('{')), vceqq_u8(braces, vdupq_n_u8('}'))),
+                vorrq_u8(
+                        vorrq_u8(vceqq_u8(v, vdupq_n_u8(':')), vceqq_u8(v, vdupq_n_u8(','))),
+                        vorrq_u8(vceqq_u8(v, vdupq_n_u8('"')), vceqq_u8(v, vdupq_n_u8('\\')))));
+        uint8x16_t bits = vandq_u8(candidates, vld1q_u8(bit_weights));
+        return (uint32_t) vaddv_u8(vget_low_u8(bits)) | ((uint32_t) vaddv_u8(vget_high_u8(bits)) << 8);
+    }
+#endif
+    mask = 0;
+    for (i = 0; i < length; i++) {
+        if (is_structural_candidate(block[i])) {
+            mask |= (uint32_t) 1 << i;
+        }
+    }
+    return mask;
+}
+
+/**
+ * Fills the structural position buffer, continuing where the previous scan stopped.
+ *
+ * Quotes inside strings are only recorded if they terminate the string. Other structural characters inside strings
+ * are not recorded.
+ */
+static void scan(struct util_json_index* x) {
+    HAPPrecondition(x != NULL);
+    x->num_structurals = 0;
+    x->next_structural = 0;
+    while ((x->scanned < x->length) && (x->num_structurals < util_JSON_INDEX_CAPACITY)) {
+        size_t block_start = x->scanned;
+        size_t block_length = x->length - block_start < BLOCK_SIZE ? x->length - block_start : BLOCK_SIZE;
+        uint32_t mask = classify_block(&x->buffer[block_start], block_length);
+        x->scanned = block_start + block_length;
+        while (mask) {
+            size_t p = block_start + count_trailing_zeros(mask);
+            mask &= mask - 1;
+            if (x->num_structurals == util_JSON_INDEX_CAPACITY) {
+                // Resume at this octet on the next scan.
+                x->scanned = p;
+                break;
+            }
+            if (p == x->escaped_position) {
+                continue;
+            }
+            if (x->in_string) {
+                if (x->buffer[p] == '"') {
+                    x->in_string = 0;
+                    x->structurals[x->num_structurals++] = p;
+                } else if (x->buffer[p] == '\\') {
+                    x->escaped_position = p + 1;
+                }
+            } else if (x->buffer[p] == '"') {
+                x->in_string = 1;
+                x->structurals[x->num_structurals++] = p;
+            } else if (x->buffer[p] != '\\') {
+                x->structurals[x->num_structurals++] = p;
+            }
+        }
+    }
+}
+
+/**
+ * Returns the position of the next unconsumed structural character, or the buffer length if there is none.
+ */
+HAP_RESULT_USE_CHECK
+static size_t peek_structural(struct util_json_index* x) {
+    HAPPrecondition(x != NULL);
+    if (x->next_structural == x->num_structurals) {
+        scan(x);
+        if (x->num_structurals == 0) {
+            return x->length;
+        }
+    }
+    return x->structurals[x->next_structural];
+}
+
+/**
+ * Returns the length of a number at the start of a buffer, or 0 if the buffer does not start with a valid number.
+ */
+HAP_RESULT_USE_CHECK
+static size_t read_number(const char* buffer, size_t length) {
+    size_t n;
+    HAPPrecondition(buffer != NULL);
+    n = 0;
+    if ((n < length) && (buffer[n] == '-')) {
+        n++;
+    }
+    if ((n < length) && (buffer[n] == '0')) {
+        n++;
+    } else if ((n < length) && is_digit(buffer[n])) {
+        do {
+            n++;
+        } while ((n < length) && is_digit(buffer[n]));
+    } else {
+        return 0;
+    }
+    if ((n < length) && (buffer[n] == '.')) {
+        n++;
+        if ((n == length) || !is_digit(buffer[n])) {
+            return 0;
+        }
+        do {
+            n++;
+        } while ((n < length) && is_digit(buffer[n]));
+    }
+    if ((n < length) && ((buffer[n] == 'e') || (buffer[n] == 'E'))) {
+        n++;
+        if ((n < length) && ((buffer[n] == '+') || (buffer[n] == '-'))) {
+            n++;
+        }
+        if ((n == length) || !is_digit(buffer[n])) {
+            return 0;
+        }
+        do {
+            n++;
+        } while ((n < length) && is_digit(buffer[n]));
+    }
+    return n;
+}
+
+void util_json_index_read(struct util_json_index* x) {
+    size_t structural, n;
+    HAPPrecondition(x != NULL);
+    if ((x->state == util_JSON_READER_STATE_ERROR) || (x->position == x->length)) {
+        return;
+    }
+    x->token = NULL;
+    x->token_length = 0;
+    structural = peek_structural(x);
+    HAPAssert(x->position <= structural);
+    while ((x->position < structural) && is_whitespace(x->buffer[x->position])) {
+        x->position++;
+    }
+    if (x->position == x->length) {
+        x->state = util_JSON_READER_STATE_READING_WHITESPACE;
+    } else if (x->position == structural) {
+        x->next_structural++;
+        switch (x->buffer[x->position]) {
+            case '{':
+                x->position++;
+                x->state = util_JSON_READER_STATE_BEGINNING_OBJECT;
+                break;
+            case '}':
+                x->position++;
+                x->state = util_JSON_READER_STATE_COMPLETED_OBJECT;
+                break;
+            case '[':
+                x->position++;
+                x->state = util_JSON_READER_STATE_BEGINNING_ARRAY;
+                break;
+            case ']':
+                x->position++;
+                x->state = util_JSON_READER_STATE_COMPLETED_ARRAY;
+                break;
+            case ':':
+                x->position++;
+                x->state = util_JSON_READER_STATE_AFTER_NAME_SEPARATOR;
+                break;
+            case ',':
+                x->position++;
+                x->state = util_JSON_READER_STATE_AFTER_VALUE_SEPARATOR;
+                break;
+            case '"':
+                structural = peek_structural(x);
+                if (structural == x->length) {
+                    x->state = util_JSON_READER_STATE_ERROR;
+                    break;
+                }
+                HAPAssert(x->buffer[structural] == '"');
+                x->next_structural++;
+                x->token = &x->buffer[x->position];
+                x->token_length = structural + 1 - x->position;
+                x->position = structural + 1;
+                x->state = util_JSON_READER_STATE_COMPLETED_STRING;
+                break;
+            default:
+                HAPFatalError();
+                break;
+        }
+    } else {
+        // Numbers and literals cannot contain structural characters.
+        n = structural - x->position;
+        switch (x->buffer[x->position]) {
+            case '-':
+            case '0':
+            case '1':
+            case '2':
+            case '3':
+            case '4':
+            case '5':
+            case '6':
+            case '7':
+            case '8':
+            case '9':
+                n = read_number(&x->buffer[x->position], n);
+                if ((n == 0) || (x->position + n == x->length) ||
+                    (!is_whitespace(x->buffer[x->position + n]) && (x->buffer[x->position + n] != ']') &&
+                     (x->buffer[x->position + n] != '}') && (x->buffer[x->position + n] != ','))) {
+                    x->state = util_JSON_READER_STATE_ERROR;
+                    break;
+                }
+                x->token = &x->buffer[x->position];
+                x->token_length = n;
+                x->position += n;
+                x->state = util_JSON_READER_STATE_COMPLETED_NUMBER;
+                break;
+            case 'f':
+                if ((n < 5) || !HAPRawBufferAreEqual(&x->buffer[x->position], "false", 5)) {
+                    x->state = util_JSON_READER_STATE_ERROR;
+                    break;
+                }
+                x->token = &x->buffer[x->position];
+                x->token_length = 5;
+                x->position += 5;
+                x->state = util_JSON_READER_STATE_COMPLETED_FALSE;
+                break;
+            case 't':
+                if ((n < 4) || !HAPRawBufferAreEqual(&x->buffer[x->position], "true", 4)) {
+                    x->state = util_JSON_READER_STATE_ERROR;
+                    break;
+                }
+                x->token = &x->buffer[x->position];
+                x->token_length = 4;
+                x->position += 4;
+                x->state = util_JSON_READER_STATE_COMPLETED_TRUE;
+                break;
+            case 'n':
+                if ((n < 4) || !HAPRawBufferAreEqual(&x->buffer[x->position], "null", 4)) {
+                    x->state = util_JSON_READER_STATE_ERROR;
+                    break;
+                }
+                x->token = &x->buffer[x->position];
+                x->token_length = 4;
+                x->position += 4;
+                x->state = util_JSON_READER_STATE_COMPLETED_NULL;
+                break;
+            default:
+                x->state = util_JSON_READER_STATE_ERROR;
+                break;
+        }
+    }
+    HAPAssert(x->position <= x->length);
+}
@@ -0,0 +1,57 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#ifndef UTIL_JSON_INDEX_H
+#define UTIL_JSON_INDEX_H
+
+#include "HAPPlatform.h"
+
+#include "util_json_reader.h"
+
+/**
+ * Number of structural positions that are buffered per scan.
+ */
+#define util_JSON_INDEX_CAPACITY 32
+
+/**
+ * JSON tokenizer that is driven by a structural index.
+ *
+ * A first stage classifies the buffer (16 octets at a time where SIMD is available) and records the positions of
+ * quotes, braces, brackets, colons and commas that are not part of a string. A second stage reads one token at a
+ * time by jumping between those positions, so that strings are skipped without inspecting their contents.
+ *
+ * Tokens are reported through the util_JSON_READER_STATE_* constants with the same acceptance rules as
+ * util_json_reader. Strings, numbers and literals are reported as a single COMPLETED state. Once the buffer has been
+ * consumed, further reads leave the state unchanged.
+ */
+struct util_json_index {
+    /** Most recently read token. */
+    int state;
+
+    /** Start of the most recently read string (including quotes), number or literal. */
+    const char* token;
+
+    /** Length of the most recently read string, number or literal. */
+    size_t token_length;
+
+    /** Number of octets that have been consumed. */
+    size_t position;
+
+    // Private.
+    const char* buffer;
+    size_t length;
+    size_t scanned;
+    size_t escaped_position;
+    int in_string;
+    size_t structurals[util_JSON_INDEX_CAPACITY];
+    size_t num_structurals;
+    size_t next_structural;
+};
+
+void util_json_index_init(struct util_json_index* x, const char* buffer, size_t length);
+void util_json_index_read(struct util_json_index* x);
+
+#endif
@@ -36,6 +36,7 @@ extern "C" {
 
 #include "HAPPairing.h"
 #include "HAPPairingBLESessionCache.h"
+#include "HAPPairingPublicKeyCache.h"
 #include "HAPPairingPairSetup.h"
 #include "HAPPairingPairVerify.h"
 #include "HAPPairingPairings.h"
@@ -79,6 +80,7 @@ extern "C" {
 #include "HAPAccessoryValidation.h"
 #include "HAPCharacteristic.h"
 
+#include "HAPBitSet.h"
 #include "HAPJSONUtils.h"
 #include "HAPLog+Attributes.h"
 #include "HAPMACAddress.h"
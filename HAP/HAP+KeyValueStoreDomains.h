@@ -82,6 +82,20 @@ extern "C" {
  */
 #define kHAPKeyValueStoreKey_Configuration_NumUnsuccessfulAuthAttempts ((HAPPlatformKeyValueStoreKey) 0x22)
 
+/**
+ * Fingerprint of the accessory definitions that were last validated.
+ *
+ * Format: uint64_t, little endian.
+ */
+#define kHAPKeyValueStoreKey_Configuration_ValidationFingerprint ((HAPPlatformKeyValueStoreKey) 0x23)
+
+/**
+ * Hash of the accessory configuration that is visible to controllers as of the last start.
+ *
+ * Format: uint64_t, little endian.
+ */
+#define kHAPKeyValueStoreKey_Configuration_ConfigurationHash ((HAPPlatformKeyValueStoreKey) 0x24)
+
 /**
  * BLE Global State Number.
  *
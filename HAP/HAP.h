@@ -215,7 +215,7 @@ void HAPTLVWriterGetScratchBytes(
 /**
  * HomeKit Accessory server.
  */
-typedef HAP_OPAQUE(2418) HAPAccessoryServerRef;
+typedef HAP_OPAQUE(3616) HAPAccessoryServerRef;
 HAP_NONNULL_SUPPORT(HAPAccessoryServerRef)
 
 /**
@@ -434,6 +434,43 @@ typedef struct {
          *   in-between).
          */
         bool supportsWriteResponse : 1;
+
+        /**
+         * Event notifications are only sent when the value differs from the one last delivered on the same session.
+         *
+         * - When an event is raised, the characteristic value is read once the coalescing delay has elapsed.
+         *   If it is identical to the value that the controller received in the previous event notification
+         *   on that session, the event notification is dropped.
+         *
+         * - This is useful for characteristics that are raised periodically regardless of whether their state
+         *   actually changed, e.g. power meters of bridged accessories that re-report the same reading.
+         *
+         * - This property has no effect on the Programmable Switch Event characteristic,
+         *   as each of its events represents a distinct button press that must always be delivered.
+         */
+        bool suppressUnchangedEventNotifications : 1;
+
+        /**
+         * The value of the characteristic is cached by the accessory server.
+         *
+         * - Reads over IP are served from the cached value without invoking the read handler. This is useful for
+         *   bridged accessories whose backends are expensive to query, as every GET /accessories,
+         *   GET /characteristics and event notification otherwise invokes the read handler.
+         *
+         * - The cached value is filled by reads and by HAPAccessoryServerRaiseEventWithValue. It is discarded
+         *   when the characteristic is written and when HAPAccessoryServerRaiseEvent or
+         *   HAPAccessoryServerRaiseEventOnSession is called. Therefore, an event must be raised whenever the value
+         *   changes for any other reason than a write.
+         *
+         * - The value must not depend on the controller or transport that reads it (request->session,
+         *   request->transportType). Read permissions are still checked on every read.
+         *
+         * - Cached values are stored in the valueCacheElements of the IP accessory server storage.
+         *   Characteristics that do not fit, TLV8 characteristics, characteristics with the ip.controlPoint or
+         *   ip.supportsWriteResponse property, and values that are longer than
+         *   kHAPIPCharacteristicValueCache_MaxValueBytes are not cached.
+         */
+        bool cacheable : 1;
     } ip;
 
     /**
@@ -3581,12 +3618,50 @@ typedef HAP_OPAQUE(64) HAPIPWriteContextRef;
 /**
  * IP session descriptor.
  */
-typedef HAP_OPAQUE(832) HAPIPSessionDescriptorRef;
+typedef HAP_OPAQUE(864) HAPIPSessionDescriptorRef;
+
+/**
+ * Element of the event notification state of an IP session.
+ *
+ * - Event notification subscriptions and pending events are stored as bit sets with one bit per HomeKit
+ *   characteristic. In addition, two elements are used per characteristic with the
+ *   ip.suppressUnchangedEventNotifications property to track the value that was last delivered.
+ */
+typedef HAP_OPAQUE(8) HAPIPEventNotificationRef;
+
+/**
+ * Returns the number of HAPIPEventNotificationRef elements that are needed per IP session.
+ *
+ * @param      numCharacteristics   Number of HomeKit characteristics. Services may be included.
+ * @param      numValueDigests      Number of HomeKit characteristics with the ip.suppressUnchangedEventNotifications
+ *                                  property. Event notifications of characteristics that do not fit are not suppressed.
+ *
+ * @return Number of HAPIPEventNotificationRef elements.
+ */
+#define HAPIPSessionGetNumEventNotifications(numCharacteristics, numValueDigests) \
+    (2 * (((numCharacteristics) + 63) / 64) + 2 * (numValueDigests))
+
+/**
+ * Element of the IP characteristic index.
+ *
+ * - For accessories that support IP (Ethernet / Wi-Fi), at least one of these elements must be allocated per HomeKit
+ *   characteristic, and provided as part of a HAPIPAccessoryServerStorage structure.
+ */
+typedef HAP_OPAQUE(64) HAPIPCharacteristicIndexElementRef;
+
+/**
+ * Maximum length of a characteristic value that is cached by the accessory server.
+ *
+ * - String values are measured in bytes without NULL-terminator, data values after base64 encoding.
+ */
+#define kHAPIPCharacteristicValueCache_MaxValueBytes ((size_t) 64)
 
 /**
- * IP event notification.
+ * Element of the IP characteristic value cache.
+ *
+ * - One element is used per characteristic with the ip.cacheable property.
  */
-typedef HAP_OPAQUE(24) HAPIPEventNotificationRef;
+typedef HAP_OPAQUE(80) HAPIPCharacteristicValueCacheElementRef;
 
 /**
  * Default size for the inbound buffer of an IP session.
@@ -3656,13 +3731,13 @@ typedef struct {
     /**
      * Event notifications.
      *
-     * - At least one of these structures must be allocated per HomeKit characteristic and service and must remain
-     *   valid while the accessory server is initialized.
+     * - At least HAPIPSessionGetNumEventNotifications elements must be allocated and must remain valid
+     *   while the accessory server is initialized.
      */
     HAPIPEventNotificationRef* eventNotifications;
 
     /**
-     * Number of event notification structures.
+     * Number of event notification elements.
      */
     size_t numEventNotifications;
 } HAPIPSession;
@@ -3689,6 +3764,10 @@ typedef struct {
      *   Each session contains additional memory that needs to be allocated. See HAPIPSession.
      *
      * - At least eight elements are required for IP (Ethernet / Wi-Fi) accessories.
+     *
+     * - When all sessions are in use, a new connection replaces the least recently active session that has no
+     *   event notification subscriptions. For this to work, the TCP stream manager must support one more
+     *   concurrent TCP stream than the number of sessions.
      */
     HAPIPSession* sessions;
 
@@ -3723,6 +3802,32 @@ typedef struct {
      */
     size_t numWriteContexts;
 
+    /**
+     * IP characteristic index.
+     *
+     * - At least one of these elements must be allocated per HomeKit characteristic and must remain
+     *   valid while the accessory server is initialized.
+     */
+    HAPIPCharacteristicIndexElementRef* characteristicIndexElements;
+
+    /**
+     * Number of IP characteristic index elements.
+     */
+    size_t numCharacteristicIndexElements;
+
+    /**
+     * IP characteristic value cache. Optional.
+     *
+     * - One element is used per characteristic with the ip.cacheable property. Values of characteristics that do not
+     *   fit are not cached. Memory must remain valid while the accessory server is initialized.
+     */
+    HAPIPCharacteristicValueCacheElementRef* _Nullable valueCacheElements;
+
+    /**
+     * Number of IP characteristic value cache elements.
+     */
+    size_t numValueCacheElements;
+
     /**
      * Scratch buffer.
      */
@@ -3892,6 +3997,15 @@ typedef struct {
      */
     HAPPlatformKeyValueStoreKey maxPairings;
 
+    /**
+     * Whether validation of accessory definitions is skipped on start if they have not changed.
+     *
+     * - A fingerprint of the validated accessory definitions is stored in the key-value store. If the accessory
+     *   definitions have the same fingerprint on the next start, the detailed checks are skipped.
+     *   This shortens the start of bridges with many bridged accessories.
+     */
+    bool skipUnchangedAccessoryValidation;
+
     /**
      * IP specific initialization options.
      */
@@ -4181,6 +4295,9 @@ bool HAPAccessoryServerIsPaired(HAPAccessoryServerRef* server);
  *
  * - To start a bridge, use HAPAccessoryServerStartBridge instead.
  *
+ * - The IP accessory server storage must be large enough for the attribute database.
+ *   See HAPAccessoryServerGetStorageRequirements.
+ *
  * - The server state can be observed using the handleUpdatedState callback. The server never stops on its own.
  *
  * @param      server               An initialized accessory server that is not running.
@@ -4206,16 +4323,22 @@ void HAPAccessoryServerStart(HAPAccessoryServerRef* server, const HAPAccessory*
  *
  * - A bridge accessory must not bridge more than kHAPAccessoryServerMaxBridgedAccessories accessories.
  *
+ * - The IP accessory server storage must be large enough for the attribute database.
+ *   See HAPAccessoryServerGetStorageRequirements.
+ *
  * - To change the bridged accessories (e.g. after firmware update or after modified bridge configuration),
  *   stop the server, then apply changes to the @p bridgedAccessories array, then start the server again.
  *
+ * - The configuration number is incremented automatically when the accessory instance IDs or the instance IDs, types,
+ *   formats, permissions or metadata of services and characteristics changed since the last start.
+ *
  * - The server state can be observed using the handleUpdatedState callback. The server never stops on its own.
  *
  * @param      server               An initialized accessory server that is not running.
  * @param      bridgeAccessory      Bridge accessory to serve. Must remain valid while started.
  * @param      bridgedAccessories   Array of bridged accessories. NULL-terminated. Must remain valid while started.
- * @param      configurationChanged Whether or not the bridge configuration changed since the last start.
- *                                  This includes adding / removing accessories or updating FW of a bridged accessory.
+ * @param      configurationChanged Whether or not to increment the configuration number even if no change is detected,
+ *                                  e.g. after updating FW of a bridged accessory.
  */
 void HAPAccessoryServerStartBridge(
         HAPAccessoryServerRef* server,
@@ -4223,6 +4346,35 @@ void HAPAccessoryServerStartBridge(
         const HAPAccessory* _Nullable const* _Nullable bridgedAccessories,
         bool configurationChanged);
 
+/**
+ * Replaces the bridged accessories of a running bridge, e.g. after devices joined or left the bridged network.
+ *
+ * - Only supported for bridges that have been started with HAPAccessoryServerStartBridge and are running.
+ *   Must not be called from within an accessory server callback.
+ *
+ * - IP sessions stay open. Event notification subscriptions for characteristics of accessories that are both in the
+ *   previous and in the new bridged accessories are kept. Subscriptions for characteristics of removed accessories
+ *   are ended, and their handleUnsubscribe callbacks are invoked. IP sessions that are currently sending
+ *   the accessory attribute database are closed.
+ *
+ * - The configuration number is incremented if the configuration that is visible to controllers changed,
+ *   and the Bonjour TXT records are updated accordingly so that controllers refresh their cache.
+ *
+ * - The previous @p bridgedAccessories array and the accessories that it contains must remain valid until this
+ *   function returns. Accessories that are kept must not be modified.
+ *
+ * @param      server               A running accessory server.
+ * @param      bridgedAccessories   Array of bridged accessories. NULL-terminated. Must remain valid while started.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_OutOfResources If the IP accessory server storage is too small for the new bridged accessories.
+ *                                  The previous bridged accessories are kept in that case.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPAccessoryServerUpdateBridgedAccessories(
+        HAPAccessoryServerRef* server,
+        const HAPAccessory* _Nullable const* _Nullable bridgedAccessories);
+
 /**
  * Stops the accessory server.
  *
@@ -4319,6 +4471,339 @@ void HAPAccessoryServerRaiseEventOnSession(
         const HAPAccessory* accessory,
         HAPSessionRef* session);
 
+/**
+ * Raises an event notification for a given characteristic in a given service provided by a given accessory object,
+ * and provides the new value of the characteristic.
+ *
+ * - For characteristics with the ip.cacheable property, the value is stored in the value cache, so that subsequent
+ *   reads (including the read that produces the event notification) do not invoke the read handler.
+ *   For other characteristics, this is equivalent to HAPAccessoryServerRaiseEvent.
+ *
+ * - The value is encoded according to the characteristic format:
+ *   - kHAPCharacteristicFormat_Bool: bool.
+ *   - kHAPCharacteristicFormat_UInt8, UInt16, UInt32, UInt64: uint8_t, uint16_t, uint32_t, uint64_t.
+ *   - kHAPCharacteristicFormat_Int: int32_t.
+ *   - kHAPCharacteristicFormat_Float: float.
+ *   - kHAPCharacteristicFormat_String: UTF-8 bytes, without NULL-terminator.
+ *   - kHAPCharacteristicFormat_Data: Raw bytes.
+ *   - kHAPCharacteristicFormat_TLV8: Not cached. The value is ignored.
+ *
+ * - The value must be the one that the read handler would return. Like read handler results, Float values are
+ *   rounded to the step value. Values that do not satisfy the characteristic constraints are not cached,
+ *   and the read handler is invoked instead.
+ *
+ * @param      server               Accessory server.
+ * @param      characteristic       The characteristic whose value has changed.
+ * @param      service              The service that contains the characteristic.
+ * @param      accessory            The accessory that provides the service.
+ * @param      valueBytes           New value of the characteristic.
+ * @param      numValueBytes        Length of the new value.
+ */
+void HAPAccessoryServerRaiseEventWithValue(
+        HAPAccessoryServerRef* server,
+        const HAPCharacteristic* characteristic,
+        const HAPService* service,
+        const HAPAccessory* accessory,
+        const void* valueBytes,
+        size_t numValueBytes);
+
+/**
+ * Storage usage of an accessory server.
+ *
+ * - Each field corresponds to a field of HAPIPAccessoryServerStorage or HAPBLEAccessoryServerStorage.
+ *   Element counts and buffer sizes that are provided to the accessory server must be at least as large.
+ */
+typedef struct {
+    /**
+     * IP accessory server storage. See HAPIPAccessoryServerStorage.
+     */
+    struct {
+        /** Number of IP sessions. */
+        size_t numSessions;
+
+        /** Number of IP read contexts. */
+        size_t numReadContexts;
+
+        /** Number of IP write contexts. */
+        size_t numWriteContexts;
+
+        /** Number of IP characteristic index elements. */
+        size_t numCharacteristicIndexElements;
+
+        /** Number of IP characteristic value cache elements. */
+        size_t numValueCacheElements;
+
+        /** Number of event notification elements per IP session. */
+        size_t numEventNotifications;
+
+        /** Size of the inbound buffer of an IP session. */
+        size_t numInboundBufferBytes;
+
+        /** Size of the outbound buffer of an IP session. */
+        size_t numOutboundBufferBytes;
+
+        /** Size of the scratch buffer. */
+        size_t numScratchBufferBytes;
+    } ip;
+
+    /**
+     * BLE accessory server storage. See HAPBLEAccessoryServerStorage.
+     */
+    struct {
+        /** Number of BLE GATT table elements. */
+        size_t numGATTTableElements;
+
+        /** Number of BLE session cache elements. */
+        size_t numSessionCacheElements;
+
+        /** Number of HAP-BLE procedures. */
+        size_t numProcedures;
+
+        /** Size of the HAP-BLE procedure buffer. */
+        size_t numProcedureBufferBytes;
+    } ble;
+} HAPAccessoryServerStorageUsage;
+
+/**
+ * Computes the storage that an accessory attribute database requires.
+ *
+ * - Element counts that only depend on the attribute database are computed exactly.
+ *   Element counts and buffer sizes that depend on the workload (number of IP sessions, buffer sizes) are set to
+ *   the minimum that is accepted by the accessory server, or to 0 if there is none. Use
+ *   HAPAccessoryServerGetStorageHighWaterMarks to measure them under a representative workload.
+ *
+ * @param      primaryAccessory     Primary accessory.
+ * @param      bridgedAccessories   Array of bridged accessories. NULL-terminated. Optional.
+ * @param[out] requirements         Storage requirements.
+ */
+void HAPAccessoryServerGetStorageRequirements(
+        const HAPAccessory* primaryAccessory,
+        const HAPAccessory* _Nullable const* _Nullable bridgedAccessories,
+        HAPAccessoryServerStorageUsage* requirements);
+
+/**
+ * Gets the largest storage usage that has been observed since the accessory server was created.
+ *
+ * - Element counts that only depend on the attribute database are updated when the accessory server is started.
+ *
+ * - A high-water mark that reaches the provided element count or buffer size indicates that requests may have been
+ *   rejected because the storage was exhausted.
+ *
+ * @param      server               Accessory server.
+ * @param[out] highWaterMarks       Storage high-water marks.
+ */
+void HAPAccessoryServerGetStorageHighWaterMarks(
+        HAPAccessoryServerRef* server,
+        HAPAccessoryServerStorageUsage* highWaterMarks);
+
+/**
+ * Request type that is tracked by the accessory server statistics.
+ */
+HAP_ENUM_BEGIN(uint8_t, HAPAccessoryServerRequestType) { /** HAP over IP: GET /accessories. */
+                                                         kHAPAccessoryServerRequestType_GetAccessories,
+
+                                                         /** HAP over IP: GET /characteristics. */
+                                                         kHAPAccessoryServerRequestType_GetCharacteristics,
+
+                                                         /** HAP over IP: PUT /characteristics. */
+                                                         kHAPAccessoryServerRequestType_PutCharacteristics,
+
+                                                         /** HAP over IP: PUT /prepare. */
+                                                         kHAPAccessoryServerRequestType_Prepare,
+
+                                                         /** HAP over IP: POST /pair-setup. */
+                                                         kHAPAccessoryServerRequestType_PairSetup,
+
+                                                         /** HAP over IP: POST /pair-verify. */
+                                                         kHAPAccessoryServerRequestType_PairVerify,
+
+                                                         /** HAP over IP: POST /pairings. */
+                                                         kHAPAccessoryServerRequestType_Pairings,
+
+                                                         /** HAP over IP: Event notification message sent. */
+                                                         kHAPAccessoryServerRequestType_EventNotification,
+
+                                                         /** HAP over Bluetooth LE: HAP-BLE procedure transaction. */
+                                                         kHAPAccessoryServerRequestType_BLEProcedure
+} HAP_ENUM_END(uint8_t, HAPAccessoryServerRequestType);
+
+/**
+ * Number of request types that are tracked by the accessory server statistics.
+ */
+#define kHAPAccessoryServerRequestType_NumTypes ((size_t) kHAPAccessoryServerRequestType_BLEProcedure + 1)
+
+/**
+ * Number of buckets of a latency histogram.
+ */
+#define kHAPLatencyHistogram_NumBuckets ((size_t) 16)
+
+/**
+ * Latency histogram.
+ *
+ * - Latencies are measured in milliseconds and recorded into logarithmic buckets:
+ *   Bucket 0 counts latencies below 1 ms, bucket i counts latencies in the range [2^(i-1), 2^i) ms,
+ *   and the last bucket also counts all latencies that exceed its range.
+ */
+typedef struct {
+    /** Number of recorded latencies. */
+    uint32_t numSamples;
+
+    /** Largest recorded latency in milliseconds. */
+    uint32_t maxLatency;
+
+    /** Sum of all recorded latencies in milliseconds. */
+    uint64_t totalLatency;
+
+    /** Number of recorded latencies per bucket. */
+    uint32_t buckets[kHAPLatencyHistogram_NumBuckets];
+} HAPLatencyHistogram;
+
+/**
+ * Accessory server statistics.
+ */
+typedef struct {
+    /** Latency histogram per request type. Indexed by HAPAccessoryServerRequestType. */
+    HAPLatencyHistogram requests[kHAPAccessoryServerRequestType_NumTypes];
+
+    /**
+     * HAP over IP statistics.
+     */
+    struct {
+        /** Number of accepted TCP connections. */
+        uint32_t numSessionsAccepted;
+
+        /** Number of bytes received over all IP sessions. */
+        uint64_t numBytesReceived;
+
+        /** Number of bytes sent over all IP sessions. */
+        uint64_t numBytesSent;
+    } ip;
+} HAPAccessoryServerStatistics;
+
+/**
+ * Gets the statistics that have been collected since the accessory server was created or since they were reset.
+ *
+ * @param      server               Accessory server.
+ * @param[out] statistics           Accessory server statistics.
+ */
+void HAPAccessoryServerGetStatistics(HAPAccessoryServerRef* server, HAPAccessoryServerStatistics* statistics);
+
+/**
+ * Resets the accessory server statistics, including per-characteristic and per-session statistics.
+ *
+ * @param      server               Accessory server.
+ */
+void HAPAccessoryServerResetStatistics(HAPAccessoryServerRef* server);
+
+/**
+ * Timing statistics of a characteristic callback.
+ */
+typedef struct {
+    /** Number of invocations. */
+    uint32_t numCalls;
+
+    /** Largest duration of an invocation in milliseconds. */
+    uint32_t maxDuration;
+
+    /** Sum of the durations of all invocations in milliseconds. Saturates at UINT32_MAX. */
+    uint32_t totalDuration;
+} HAPCharacteristicCallbackStatistics;
+
+/**
+ * Statistics of a characteristic.
+ */
+typedef struct {
+    /** Characteristic. */
+    const HAPCharacteristic* characteristic;
+
+    /** The service that contains the characteristic. */
+    const HAPService* service;
+
+    /** The accessory that provides the service. */
+    const HAPAccessory* accessory;
+
+    /** Instance ID of the characteristic. */
+    uint64_t iid;
+
+    /** Timing of the handleRead callback. */
+    HAPCharacteristicCallbackStatistics read;
+
+    /** Timing of the handleWrite callback. */
+    HAPCharacteristicCallbackStatistics write;
+} HAPCharacteristicStatistics;
+
+/**
+ * Callback that should be invoked for each characteristic.
+ *
+ * @param      context              Context.
+ * @param      server               Accessory server.
+ * @param      statistics           Statistics of the characteristic.
+ * @param[in,out] shouldContinue    True if enumeration shall continue, False otherwise. Is set to true on input.
+ */
+typedef void (*HAPAccessoryServerEnumerateCharacteristicStatisticsCallback)(
+        void* _Nullable context,
+        HAPAccessoryServerRef* server,
+        const HAPCharacteristicStatistics* statistics,
+        bool* shouldContinue);
+
+/**
+ * Enumerates the callback timing statistics of all characteristics.
+ *
+ * - Callback timings are collected for requests that are received over HAP over IP.
+ *   Statistics are only available after the accessory server has been started.
+ *
+ * @param      server               Accessory server.
+ * @param      callback             Function to call on each characteristic.
+ * @param      context              Context that is passed to the callback.
+ */
+void HAPAccessoryServerEnumerateCharacteristicStatistics(
+        HAPAccessoryServerRef* server,
+        HAPAccessoryServerEnumerateCharacteristicStatisticsCallback callback,
+        void* _Nullable context);
+
+/**
+ * Statistics of an IP session.
+ */
+typedef struct {
+    /** Index of the IP session in HAPIPAccessoryServerStorage. */
+    size_t sessionIndex;
+
+    /** Whether or not a security session has been established. */
+    bool isSecured;
+
+    /** Number of bytes received. */
+    uint64_t numBytesReceived;
+
+    /** Number of bytes sent. */
+    uint64_t numBytesSent;
+} HAPIPSessionStatistics;
+
+/**
+ * Callback that should be invoked for each open IP session.
+ *
+ * @param      context              Context.
+ * @param      server               Accessory server.
+ * @param      statistics           Statistics of the IP session.
+ * @param[in,out] shouldContinue    True if enumeration shall continue, False otherwise. Is set to true on input.
+ */
+typedef void (*HAPAccessoryServerEnumerateIPSessionStatisticsCallback)(
+        void* _Nullable context,
+        HAPAccessoryServerRef* server,
+        const HAPIPSessionStatistics* statistics,
+        bool* shouldContinue);
+
+/**
+ * Enumerates the statistics of all open IP sessions.
+ *
+ * @param      server               Accessory server.
+ * @param      callback             Function to call on each open IP session.
+ * @param      context              Context that is passed to the callback.
+ */
+void HAPAccessoryServerEnumerateIPSessionStatistics(
+        HAPAccessoryServerRef* server,
+        HAPAccessoryServerEnumerateIPSessionStatisticsCallback callback,
+        void* _Nullable context);
+
 /**
  * Restores the given key-value store to factory settings.
  *
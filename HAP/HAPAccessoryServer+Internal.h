@@ -58,6 +58,9 @@ typedef struct {
     /** Maximum number of allowed pairings. */
     HAPPlatformKeyValueStoreKey maxPairings;
 
+    /** Whether validation of unchanged accessory definitions is skipped on start. */
+    bool skipUnchangedAccessoryValidation;
+
     /** Accessory to serve. */
     const HAPAccessory* _Nullable primaryAccessory;
 
@@ -71,8 +74,20 @@ typedef struct {
 
         /** Long-term secret key. */
         HAPAccessoryServerLongTermSecretKey ed_LTSK;
+
+        /** Signing context holding the expanded long-term secret key. Valid while the server is running. */
+        HAP_ed25519_sign_ctx ed_LTSKSignContext;
     } identity;
 
+    /** Cache of controller long-term public keys in verification-ready form. */
+    HAPPairingPublicKeyCache pairingPublicKeyCache;
+
+    /** Largest storage usage that has been observed. */
+    HAPAccessoryServerStorageUsage storageHighWaterMarks;
+
+    /** Request statistics. */
+    HAPAccessoryServerStatistics statistics;
+
     /**
      * Accessory setup state.
      */
@@ -139,6 +154,28 @@ typedef struct {
 
         bool flagsPresent : 1;  /**< Whether Pairing Type flags were present in Pair Setup M1. */
         bool keepSetupInfo : 1; /**< Whether setup info should be kept on disconnect. */
+
+        /**
+         * MFi proof of Pair Setup M4.
+         *
+         * - Over IP, the MFi proof is created asynchronously and the M4 response is deferred until it is available.
+         */
+        struct {
+            /** Apple Authentication Coprocessor request. */
+            HAPMFiHWAuthRequest request;
+
+            /** MFi proof. */
+            uint8_t bytes[kHAPMFiHWAuth_MaxSignatureBytes];
+
+            /** Length of the MFi proof. */
+            size_t numBytes;
+
+            /** Result of the Apple Authentication Coprocessor request. */
+            HAPError error;
+
+            bool isPending : 1;   /**< Whether the request is being processed. */
+            bool isAvailable : 1; /**< Whether the request has completed. */
+        } mfiProof;
     } pairSetup;
 
     /**
@@ -163,6 +200,35 @@ typedef struct {
         /** The number of active sessions served by the accessory server. */
         size_t numSessions;
 
+        /** Open sessions that have not completed Pair Verify, ordered by time of last activity. */
+        HAPIPSessionActivityList unsecuredSessions;
+
+        /** Secured sessions without event notification subscriptions, ordered by time of last activity. */
+        HAPIPSessionActivityList unsubscribedSessions;
+
+        /** Open sessions with at least one event notification subscription, ordered by time of last activity. */
+        HAPIPSessionActivityList subscribedSessions;
+
+        /** Free sessions, linked through their nextActiveSession field. */
+        HAPIPSession* _Nullable freeSessions;
+
+        /**
+         * IP characteristic index. Elements are stored in storage->characteristicIndexElements.
+         */
+        struct {
+            /** Number of characteristics in the index. */
+            size_t numElements;
+
+            /** Length of each event notification bit set of an IP session, in HAPIPEventNotificationRef elements. */
+            size_t numBitSetElements;
+
+            /** Number of value digests in the event notification state of an IP session. */
+            size_t numValueDigests;
+
+            /** Number of characteristics whose value is cached. */
+            size_t numValueCacheElements;
+        } characteristicIndex;
+
         /**
          * Characteristic write request context.
          */
@@ -194,6 +260,9 @@ typedef struct {
 
         /** Currently registered Bonjour service. */
         HAPIPServiceDiscoveryType discoverableService;
+
+        /** Cached TXT record values of the _hap service. */
+        HAPIPServiceDiscoveryTXTRecordCache txtRecordCache;
     } ip;
 
     /**
@@ -228,6 +297,9 @@ typedef struct {
             /** Connection handle of the connected controller, if applicable. */
             HAPPlatformBLEPeripheralManagerConnectionHandle connectionHandle;
 
+            /** Negotiated ATT MTU of the connection. */
+            uint16_t mtu;
+
             /** Whether a HomeKit controller is connected. */
             bool connected : 1;
 
@@ -238,6 +310,27 @@ typedef struct {
         /** Timestamp for Least Recently Used scheme in Pair Resume session cache. */
         uint32_t sessionCacheTimestamp;
 
+        /**
+         * Global State Number.
+         *
+         * - The GSN is persisted ahead of time in ranges of kHAPBLEAccessoryServer_NumReservedGSNs values
+         *   so that it stays monotonic across power loss without a key-value store write per increment.
+         */
+        struct {
+            HAPBLEAccessoryServerGSN state; /**< Current GSN. */
+            uint16_t numReservedGSNs;       /**< Number of persisted GSN values that have not been used yet. */
+            bool isLoaded : 1;              /**< Whether the GSN has been loaded from the key-value store. */
+            bool isSaved : 1;               /**< Whether the current GSN is persisted exactly. */
+        } gsn;
+
+        /**
+         * Broadcast encryption key parameters.
+         */
+        struct {
+            HAPBLEAccessoryServerBroadcastParameters parameters; /**< Parameters. */
+            bool isLoaded : 1; /**< Whether the parameters have been loaded from the key-value store. */
+        } broadcast;
+
         /**
          * Advertisement state.
          */
@@ -300,6 +393,50 @@ void* _Nullable HAPAccessoryServerGetClientContext(HAPAccessoryServerRef* server
  */
 void HAPAccessoryServerDelegateScheduleHandleUpdatedState(HAPAccessoryServerRef* server);
 
+/**
+ * Raises a storage high-water mark of the accessory server to the current usage.
+ *
+ * @param      highWaterMark        High-water mark. Field of the accessory server's storage high-water marks.
+ * @param      value                Current usage.
+ */
+void HAPAccessoryServerUpdateHighWaterMark(size_t* highWaterMark, size_t value);
+
+/**
+ * Records the latency of a request that has been handled by the accessory server.
+ *
+ * @param      server               Accessory server.
+ * @param      requestType          Request type.
+ * @param      startTime            Time at which handling of the request started.
+ */
+void HAPAccessoryServerRecordRequest(
+        HAPAccessoryServerRef* server,
+        HAPAccessoryServerRequestType requestType,
+        HAPTime startTime);
+
+/**
+ * Discards the cached value of a characteristic.
+ *
+ * - Must be called before a characteristic is written, so that its value is read again afterwards.
+ *
+ * @param      server               Accessory server.
+ * @param      characteristic       Characteristic.
+ * @param      service              The service that contains the characteristic.
+ * @param      accessory            The accessory that provides the service.
+ */
+void HAPAccessoryServerInvalidateCachedValue(
+        HAPAccessoryServerRef* server,
+        const HAPCharacteristic* characteristic,
+        const HAPService* service,
+        const HAPAccessory* accessory);
+
+/**
+ * Records the duration of a characteristic callback invocation.
+ *
+ * @param[in,out] statistics        Timing statistics of the characteristic callback.
+ * @param      startTime            Time at which the callback was invoked.
+ */
+void HAPCharacteristicCallbackStatisticsRecord(HAPCharacteristicCallbackStatistics* statistics, HAPTime startTime);
+
 /**
  * Loads the accessory server LTSK. If none exists, it is generated.
  *
@@ -24,6 +24,8 @@ static void CompleteShutdown(HAPAccessoryServerRef* server_) {
     // Reset state.
     server->primaryAccessory = NULL;
     server->ip.bridgedAccessories = NULL;
+    HAP_ed25519_sign_done(&server->identity.ed_LTSKSignContext);
+    HAPPairingPublicKeyCacheInvalidateAllEntries(server_);
 
     // Check that everything is cleaned up.
     HAPAssert(!server->ip.discoverableService);
@@ -148,6 +150,7 @@ void HAPAccessoryServerCreate(
     // Copy generic options.
     HAPPrecondition(options->maxPairings >= kHAPPairingStorage_MinElements);
     server->maxPairings = options->maxPairings;
+    server->skipUnchangedAccessoryValidation = options->skipUnchangedAccessoryValidation;
 
     // Copy platform.
     HAPAssert(sizeof *platform == sizeof server->platform);
@@ -455,17 +458,167 @@ void HAPAccessoryServerLoadLTSK(HAPPlatformKeyValueStoreRef keyValueStore, HAPAc
     }
 }
 
+/**
+ * Validates the accessory definitions before starting the accessory server.
+ *
+ * - If enabled, validation is skipped when the accessory definitions have the fingerprint of accessory definitions
+ *   that were validated before. The fingerprint is updated after successful validation.
+ *
+ * @param      server_              Accessory server.
+ * @param      primaryAccessory     Primary accessory to host.
+ * @param      bridgedAccessories   NULL-terminated array of bridged accessories for a bridge accessory. NULL otherwise.
+ */
+static void ValidateAccessories(
+        HAPAccessoryServerRef* server_,
+        const HAPAccessory* primaryAccessory,
+        const HAPAccessory* _Nullable const* _Nullable bridgedAccessories) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(primaryAccessory);
+
+    HAPError err;
+
+    uint64_t fingerprint = 0;
+    if (server->skipUnchangedAccessoryValidation) {
+        fingerprint = HAPAccessoryValidationGetFingerprint(primaryAccessory, bridgedAccessories);
+
+        uint8_t bytes[sizeof(uint64_t)];
+        bool found;
+        size_t numBytes;
+        err = HAPPlatformKeyValueStoreGet(
+                server->platform.keyValueStore,
+                kHAPKeyValueStoreDomain_Configuration,
+                kHAPKeyValueStoreKey_Configuration_ValidationFingerprint,
+                bytes,
+                sizeof bytes,
+                &numBytes,
+                &found);
+        if (err) {
+            HAPAssert(err == kHAPError_Unknown);
+            HAPFatalError();
+        }
+        if (found && numBytes == sizeof bytes && HAPReadLittleUInt64(bytes) == fingerprint) {
+            HAPLogDebug(
+                    &logObject,
+                    "Accessory definition unchanged (fingerprint 0x%016llX).",
+                    (unsigned long long) fingerprint);
+            return;
+        }
+    }
+
+    HAPLogDebug(
+            &logObject,
+            "Checking accessory definition. "
+            "If this crashes, verify that accessory, service and characteristic lists are properly NULL-terminated.");
+    HAPPrecondition(HAPRegularAccessoryIsValid(server_, primaryAccessory));
+    if (bridgedAccessories) {
+        HAPPrecondition(HAPBridgedAccessoriesAreValid(bridgedAccessories));
+    }
+    HAPLogDebug(&logObject, "Accessory definition ok.");
+
+    if (server->skipUnchangedAccessoryValidation) {
+        uint8_t bytes[sizeof(uint64_t)];
+        HAPWriteLittleUInt64(bytes, fingerprint);
+        err = HAPPlatformKeyValueStoreSet(
+                server->platform.keyValueStore,
+                kHAPKeyValueStoreDomain_Configuration,
+                kHAPKeyValueStoreKey_Configuration_ValidationFingerprint,
+                bytes,
+                sizeof bytes);
+        if (err) {
+            HAPAssert(err == kHAPError_Unknown);
+            HAPFatalError();
+        }
+    }
+}
+
+/**
+ * Increments the configuration number if the configuration that is visible to controllers changed since the last start.
+ *
+ * - If no configuration hash has been stored yet, the configuration number is left unchanged. This is the case on
+ *   first start, and after a firmware update from a version without configuration hashes which already increments it.
+ *
+ * @param      server_              Accessory server.
+ * @param      primaryAccessory     Primary accessory to host.
+ * @param      bridgedAccessories   NULL-terminated array of bridged accessories for a bridge accessory. NULL otherwise.
+ * @param      configurationChanged Whether or not to increment the configuration number regardless of the hash.
+ */
+static void UpdateConfigurationNumber(
+        HAPAccessoryServerRef* server_,
+        const HAPAccessory* primaryAccessory,
+        const HAPAccessory* _Nullable const* _Nullable bridgedAccessories,
+        bool configurationChanged) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(primaryAccessory);
+
+    HAPError err;
+
+    uint64_t hash = HAPAccessoryGetConfigurationHash(primaryAccessory, bridgedAccessories);
+
+    uint8_t bytes[sizeof(uint64_t)];
+    bool found;
+    size_t numBytes;
+    err = HAPPlatformKeyValueStoreGet(
+            server->platform.keyValueStore,
+            kHAPKeyValueStoreDomain_Configuration,
+            kHAPKeyValueStoreKey_Configuration_ConfigurationHash,
+            bytes,
+            sizeof bytes,
+            &numBytes,
+            &found);
+    if (err) {
+        HAPAssert(err == kHAPError_Unknown);
+        HAPFatalError();
+    }
+    if (found && numBytes != sizeof bytes) {
+        HAPLogError(
+                &logObject,
+                "Key-value store corrupted - unexpected length for configuration hash: %lu.",
+                (unsigned long) numBytes);
+        HAPFatalError();
+    }
+    bool hashChanged = found && HAPReadLittleUInt64(bytes) != hash;
+
+    // Increment configuration number if necessary.
+    if (configurationChanged || hashChanged) {
+        HAPLogInfo(&logObject, "Configuration changed. Incrementing CN.");
+        err = HAPAccessoryServerIncrementCN(server->platform.keyValueStore);
+        if (err) {
+            HAPAssert(err == kHAPError_Unknown);
+            HAPFatalError();
+        }
+    }
+
+    // Save configuration hash.
+    if (!found || hashChanged) {
+        HAPWriteLittleUInt64(bytes, hash);
+        err = HAPPlatformKeyValueStoreSet(
+                server->platform.keyValueStore,
+                kHAPKeyValueStoreDomain_Configuration,
+                kHAPKeyValueStoreKey_Configuration_ConfigurationHash,
+                bytes,
+                sizeof bytes);
+        if (err) {
+            HAPAssert(err == kHAPError_Unknown);
+            HAPFatalError();
+        }
+    }
+}
+
 /**
  * Prepares starting the accessory server.
  *
  * @param      server_              Accessory server.
  * @param      primaryAccessory     Primary accessory to host.
  * @param      bridgedAccessories   NULL-terminated array of bridged accessories for a bridge accessory. NULL otherwise.
+ * @param      configurationChanged Whether or not the configuration changed since the last start.
  */
 static void HAPAccessoryServerPrepareStart(
         HAPAccessoryServerRef* server_,
         const HAPAccessory* primaryAccessory,
-        const HAPAccessory* _Nullable const* _Nullable bridgedAccessories) {
+        const HAPAccessory* _Nullable const* _Nullable bridgedAccessories,
+        bool configurationChanged) {
     HAPPrecondition(server_);
     HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
     HAPPrecondition(server->state == kHAPAccessoryServerState_Idle);
@@ -594,6 +747,9 @@ static void HAPAccessoryServerPrepareStart(
         }
     }
 
+    // Configuration number update.
+    UpdateConfigurationNumber(server_, primaryAccessory, bridgedAccessories, configurationChanged);
+
     // Register accessory.
     HAPLogDebug(&logObject, "Registering accessories.");
     server->primaryAccessory = primaryAccessory;
@@ -603,6 +759,8 @@ static void HAPAccessoryServerPrepareStart(
     HAPLogDebug(&logObject, "Loading accessory identity.");
     HAPAccessoryServerLoadLTSK(server->platform.keyValueStore, &server->identity.ed_LTSK);
     HAP_ed25519_public_key(server->identity.ed_LTPK, server->identity.ed_LTSK.bytes);
+    HAP_ed25519_sign_init(
+            &server->identity.ed_LTSKSignContext, server->identity.ed_LTSK.bytes, server->identity.ed_LTPK);
 
     // Cleanup pairings.
     err = HAPAccessoryServerCleanupPairings(server_);
@@ -623,17 +781,60 @@ static void HAPAccessoryServerPrepareStart(
     HAPAccessoryServerUpdateAdvertisingData(server_);
 }
 
+/**
+ * Checks whether the IP accessory server storage is large enough to serve an accessory attribute database.
+ *
+ * @param      server               Accessory server.
+ * @param      primaryAccessory     Primary accessory.
+ * @param      bridgedAccessories   Array of bridged accessories. NULL-terminated. Optional.
+ *
+ * @return true                     If the IP accessory server storage is large enough.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool IPStorageFitsAccessories(
+        const HAPAccessoryServer* server,
+        const HAPAccessory* primaryAccessory,
+        const HAPAccessory* _Nullable const* _Nullable bridgedAccessories) {
+    HAPPrecondition(server);
+    HAPPrecondition(primaryAccessory);
+
+    HAPAccessoryServerStorageUsage requirements;
+    HAPAccessoryServerGetStorageRequirements(primaryAccessory, bridgedAccessories, &requirements);
+    const HAPIPAccessoryServerStorage* storage = HAPNonnull(server->ip.storage);
+    if (requirements.ip.numCharacteristicIndexElements > storage->numCharacteristicIndexElements) {
+        HAPLog(&logObject,
+               "IP accessory server storage too small: %lu characteristic index elements required, %lu available.",
+               (unsigned long) requirements.ip.numCharacteristicIndexElements,
+               (unsigned long) storage->numCharacteristicIndexElements);
+        return false;
+    }
+    // Value digests are optional. Event notifications of characteristics without one are not suppressed.
+    size_t numEventNotifications =
+            HAPIPSessionGetNumEventNotifications(requirements.ip.numCharacteristicIndexElements, 0);
+    for (size_t i = 0; i < storage->numSessions; i++) {
+        if (storage->sessions[i].numEventNotifications < numEventNotifications) {
+            HAPLog(&logObject,
+                   "IP accessory server storage too small: %lu event notification elements required, %lu available.",
+                   (unsigned long) numEventNotifications,
+                   (unsigned long) storage->sessions[i].numEventNotifications);
+            return false;
+        }
+    }
+    return true;
+}
+
 void HAPAccessoryServerStart(HAPAccessoryServerRef* server_, const HAPAccessory* accessory) {
     HAPPrecondition(server_);
     HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
     HAPPrecondition(accessory);
 
-    HAPLogDebug(
-            &logObject,
-            "Checking accessory definition. "
-            "If this crashes, verify that service and characteristic lists are properly NULL-terminated.");
-    HAPPrecondition(HAPRegularAccessoryIsValid(server_, accessory));
-    HAPLogDebug(&logObject, "Accessory definition ok.");
+    ValidateAccessories(server_, accessory, /* bridgedAccessories: */ NULL);
+
+    // Check IP requirements.
+    if (server->transports.ip) {
+        HAPPrecondition(IPStorageFitsAccessories(server, accessory, /* bridgedAccessories: */ NULL));
+    }
 
     // Check Bluetooth LE requirements.
     if (server->transports.ble) {
@@ -641,7 +842,8 @@ void HAPAccessoryServerStart(HAPAccessoryServerRef* server_, const HAPAccessory*
     }
 
     // Start accessory server.
-    HAPAccessoryServerPrepareStart(server_, accessory, /* bridgedAccessories: */ NULL);
+    HAPAccessoryServerPrepareStart(
+            server_, accessory, /* bridgedAccessories: */ NULL, /* configurationChanged: */ false);
     if (server->state != kHAPAccessoryServerState_Running) {
         HAPAssert(server->state == kHAPAccessoryServerState_Idle);
         return;
@@ -665,38 +867,19 @@ void HAPAccessoryServerStartBridge(
     HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
     HAPPrecondition(bridgeAccessory);
 
-    HAPError err;
+    ValidateAccessories(server_, bridgeAccessory, bridgedAccessories);
 
-    HAPLogDebug(
-            &logObject,
-            "Checking accessory definition. "
-            "If this crashes, verify that accessory, service and characteristic lists are properly NULL-terminated.");
-    HAPPrecondition(HAPRegularAccessoryIsValid(server_, bridgeAccessory));
-    if (bridgedAccessories) {
-        size_t i;
-        for (i = 0; bridgedAccessories[i]; i++) {
-            HAPPrecondition(HAPBridgedAccessoryIsValid(bridgedAccessories[i]));
-        }
-        HAPPrecondition(i <= kHAPAccessoryServerMaxBridgedAccessories);
+    // Check IP requirements.
+    if (server->transports.ip) {
+        HAPPrecondition(IPStorageFitsAccessories(server, bridgeAccessory, bridgedAccessories));
     }
-    HAPLogDebug(&logObject, "Accessory definition ok.");
 
-    HAPAccessoryServerPrepareStart(server_, bridgeAccessory, bridgedAccessories);
+    HAPAccessoryServerPrepareStart(server_, bridgeAccessory, bridgedAccessories, configurationChanged);
     if (server->state != kHAPAccessoryServerState_Running) {
         HAPAssert(server->state == kHAPAccessoryServerState_Idle);
         return;
     }
 
-    // Increment configuration number if necessary.
-    if (configurationChanged) {
-        HAPLogInfo(&logObject, "Configuration changed. Incrementing CN.");
-        err = HAPAccessoryServerIncrementCN(server->platform.keyValueStore);
-        if (err) {
-            HAPAssert(err == kHAPError_Unknown);
-            HAPFatalError();
-        }
-    }
-
     if (server->transports.ip) {
         const HAPAccessoryServerServerEngine* _Nullable serverEngine =
                 HAPNonnull(server->transports.ip)->serverEngine.get();
@@ -706,6 +889,32 @@ void HAPAccessoryServerStartBridge(
     }
 }
 
+HAP_RESULT_USE_CHECK
+HAPError HAPAccessoryServerUpdateBridgedAccessories(
+        HAPAccessoryServerRef* server_,
+        const HAPAccessory* _Nullable const* _Nullable bridgedAccessories) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(server->transports.ip);
+    HAPPrecondition(HAPAccessoryServerGetState(server_) == kHAPAccessoryServerState_Running);
+    HAPPrecondition(server->primaryAccessory);
+
+    ValidateAccessories(server_, HAPNonnull(server->primaryAccessory), bridgedAccessories);
+
+    // Check storage requirements.
+    if (!IPStorageFitsAccessories(server, HAPNonnull(server->primaryAccessory), bridgedAccessories)) {
+        HAPLog(&logObject, "Not updating bridged accessories (IP accessory server storage too small).");
+        return kHAPError_OutOfResources;
+    }
+
+    HAPLogInfo(&logObject, "Updating bridged accessories.");
+    UpdateConfigurationNumber(
+            server_, HAPNonnull(server->primaryAccessory), bridgedAccessories, /* configurationChanged: */ false);
+    HAPNonnull(server->transports.ip)->updateBridgedAccessories(server_, bridgedAccessories);
+
+    return kHAPError_None;
+}
+
 void HAPAccessoryServerStop(HAPAccessoryServerRef* server_) {
     HAPPrecondition(server_);
     HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
@@ -1019,6 +1228,9 @@ HAPError HAPAccessoryServerCleanupPairings(HAPAccessoryServerRef* server_) {
             }
         }
 
+        // Purge cached public keys.
+        HAPPairingPublicKeyCacheInvalidateAllEntries(server_);
+
         // Purge Pair Resume cache.
         if (server->transports.ble) {
             HAPRawBufferZero(
@@ -1037,6 +1249,7 @@ HAPError HAPAccessoryServerCleanupPairings(HAPAccessoryServerRef* server_) {
             HAPAssert(err == kHAPError_Unknown);
             return err;
         }
+        HAPRawBufferZero(&server->ble.broadcast, sizeof server->ble.broadcast);
     }
 
     return kHAPError_None;
@@ -1158,7 +1371,60 @@ HAPError HAPAccessoryServerIncrementCN(HAPPlatformKeyValueStoreRef keyValueStore
     return kHAPError_None;
 }
 
-void HAPAccessoryServerRaiseEvent(
+/**
+ * Updates the cached value of a characteristic.
+ *
+ * @param      server_              Accessory server.
+ * @param      characteristic       Characteristic.
+ * @param      service              The service that contains the characteristic.
+ * @param      accessory            The accessory that provides the service.
+ * @param      valueBytes           New value of the characteristic. NULL to discard the cached value.
+ * @param      numValueBytes        Length of the new value.
+ */
+static void UpdateCachedValue(
+        HAPAccessoryServerRef* server_,
+        const HAPCharacteristic* characteristic,
+        const HAPService* service,
+        const HAPAccessory* accessory,
+        const void* _Nullable valueBytes,
+        size_t numValueBytes) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(characteristic);
+    HAPPrecondition(service);
+    HAPPrecondition(accessory);
+
+    if (!((const HAPBaseCharacteristic*) characteristic)->properties.ip.cacheable) {
+        return;
+    }
+    if (server->transports.ip) {
+        HAPNonnull(server->transports.ip)->valueCache.update(
+                server_, characteristic, service, accessory, valueBytes, numValueBytes);
+    }
+}
+
+void HAPAccessoryServerInvalidateCachedValue(
+        HAPAccessoryServerRef* server,
+        const HAPCharacteristic* characteristic,
+        const HAPService* service,
+        const HAPAccessory* accessory) {
+    HAPPrecondition(server);
+    HAPPrecondition(characteristic);
+    HAPPrecondition(service);
+    HAPPrecondition(accessory);
+
+    UpdateCachedValue(server, characteristic, service, accessory, /* valueBytes: */ NULL, /* numValueBytes: */ 0);
+}
+
+/**
+ * Raises an event notification on all transports.
+ *
+ * @param      server_              Accessory server.
+ * @param      characteristic       The characteristic whose value has changed.
+ * @param      service              The service that contains the characteristic.
+ * @param      accessory            The accessory that provides the service.
+ */
+static void RaiseEvent(
         HAPAccessoryServerRef* server_,
         const HAPCharacteristic* characteristic,
         const HAPService* service,
@@ -1193,6 +1459,37 @@ void HAPAccessoryServerRaiseEvent(
     }
 }
 
+void HAPAccessoryServerRaiseEvent(
+        HAPAccessoryServerRef* server,
+        const HAPCharacteristic* characteristic,
+        const HAPService* service,
+        const HAPAccessory* accessory) {
+    HAPPrecondition(server);
+    HAPPrecondition(characteristic);
+    HAPPrecondition(service);
+    HAPPrecondition(accessory);
+
+    HAPAccessoryServerInvalidateCachedValue(server, characteristic, service, accessory);
+    RaiseEvent(server, characteristic, service, accessory);
+}
+
+void HAPAccessoryServerRaiseEventWithValue(
+        HAPAccessoryServerRef* server,
+        const HAPCharacteristic* characteristic,
+        const HAPService* service,
+        const HAPAccessory* accessory,
+        const void* valueBytes,
+        size_t numValueBytes) {
+    HAPPrecondition(server);
+    HAPPrecondition(characteristic);
+    HAPPrecondition(service);
+    HAPPrecondition(accessory);
+    HAPPrecondition(valueBytes);
+
+    UpdateCachedValue(server, characteristic, service, accessory, valueBytes, numValueBytes);
+    RaiseEvent(server, characteristic, service, accessory);
+}
+
 void HAPAccessoryServerRaiseEventOnSession(
         HAPAccessoryServerRef* server_,
         const HAPCharacteristic* characteristic,
@@ -1208,6 +1505,8 @@ void HAPAccessoryServerRaiseEventOnSession(
 
     HAPError err;
 
+    HAPAccessoryServerInvalidateCachedValue(server_, characteristic, service, accessory);
+
     if (server->transports.ble) {
         err = HAPNonnull(server->transports.ble)->didRaiseEvent(server_, characteristic, service, accessory, session);
         if (err) {
@@ -1228,6 +1527,184 @@ void HAPAccessoryServerRaiseEventOnSession(
     }
 }
 
+/**
+ * Returns whether a service is supported in the context of a given transport.
+ *
+ * @param      transportType        Transport type.
+ * @param      service              Service.
+ *
+ * @return true                     If the service is supported.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool IsServiceSupported(HAPTransportType transportType, const HAPService* service) {
+    HAPPrecondition(transportType == kHAPTransportType_IP || transportType == kHAPTransportType_BLE);
+    HAPPrecondition(service);
+
+    if (transportType == kHAPTransportType_IP && HAPUUIDAreEqual(service->serviceType, &kHAPServiceType_Pairing)) {
+        return false;
+    }
+
+    return true;
+}
+
+void HAPAccessoryServerGetStorageRequirements(
+        const HAPAccessory* primaryAccessory,
+        const HAPAccessory* _Nullable const* _Nullable bridgedAccessories,
+        HAPAccessoryServerStorageUsage* requirements) {
+    HAPPrecondition(primaryAccessory);
+    HAPPrecondition(requirements);
+
+    HAPRawBufferZero(requirements, sizeof *requirements);
+
+    // IP: One read context, write context and characteristic index element per characteristic,
+    // event notification state per session according to HAPIPSessionGetNumEventNotifications,
+    // one value cache element per cacheable characteristic.
+    size_t numCharacteristics = 0;
+    size_t numValueDigests = 0;
+    size_t numValueCacheElements = 0;
+    for (size_t i = 0; i == 0 || (bridgedAccessories && bridgedAccessories[i - 1]); i++) {
+        const HAPAccessory* accessory = i == 0 ? primaryAccessory : HAPNonnull(bridgedAccessories)[i - 1];
+        if (!accessory->services) {
+            continue;
+        }
+        for (size_t j = 0; accessory->services[j]; j++) {
+            const HAPService* service = accessory->services[j];
+            if (!IsServiceSupported(kHAPTransportType_IP, service) || !service->characteristics) {
+                continue;
+            }
+            for (size_t k = 0; service->characteristics[k]; k++) {
+                const HAPCharacteristic* characteristic = service->characteristics[k];
+                if (!HAPIPCharacteristicIsSupported(characteristic)) {
+                    continue;
+                }
+                numCharacteristics++;
+                if (HAPIPCharacteristicSuppressesUnchangedEventNotifications(characteristic)) {
+                    numValueDigests++;
+                }
+                if (HAPIPCharacteristicIsCacheable(characteristic)) {
+                    numValueCacheElements++;
+                }
+            }
+        }
+    }
+    // At least eight IP sessions are required. See HAPIPAccessoryServerStorage.
+    requirements->ip.numSessions = 8;
+    requirements->ip.numReadContexts = numCharacteristics;
+    requirements->ip.numWriteContexts = numCharacteristics;
+    requirements->ip.numCharacteristicIndexElements = numCharacteristics;
+    requirements->ip.numValueCacheElements = numValueCacheElements;
+    requirements->ip.numEventNotifications = HAPIPSessionGetNumEventNotifications(numCharacteristics, numValueDigests);
+
+    // BLE: One GATT table element per service and characteristic of the primary accessory.
+    // Bridged accessories are not supported over BLE.
+    if (primaryAccessory->services) {
+        for (size_t i = 0; primaryAccessory->services[i]; i++) {
+            const HAPService* service = primaryAccessory->services[i];
+            if (!IsServiceSupported(kHAPTransportType_BLE, service)) {
+                continue;
+            }
+            requirements->ble.numGATTTableElements++;
+            if (service->characteristics) {
+                for (size_t j = 0; service->characteristics[j]; j++) {
+                    requirements->ble.numGATTTableElements++;
+                }
+            }
+        }
+    }
+    requirements->ble.numSessionCacheElements = kHAPBLESessionCache_MinElements;
+    requirements->ble.numProcedures = 1;
+    requirements->ble.numProcedureBufferBytes = 1;
+}
+
+void HAPAccessoryServerGetStorageHighWaterMarks(
+        HAPAccessoryServerRef* server_,
+        HAPAccessoryServerStorageUsage* highWaterMarks) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(highWaterMarks);
+
+    *highWaterMarks = server->storageHighWaterMarks;
+}
+
+void HAPAccessoryServerUpdateHighWaterMark(size_t* highWaterMark, size_t value) {
+    HAPPrecondition(highWaterMark);
+
+    if (value > *highWaterMark) {
+        *highWaterMark = value;
+    }
+}
+
+void HAPAccessoryServerGetStatistics(HAPAccessoryServerRef* server_, HAPAccessoryServerStatistics* statistics) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(statistics);
+
+    *statistics = server->statistics;
+}
+
+void HAPAccessoryServerResetStatistics(HAPAccessoryServerRef* server_) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+
+    HAPRawBufferZero(&server->statistics, sizeof server->statistics);
+    if (server->transports.ip) {
+        HAPNonnull(server->transports.ip)->resetStatistics(server_);
+    }
+}
+
+/**
+ * Records a latency into a latency histogram.
+ *
+ * @param      histogram            Latency histogram.
+ * @param      latency              Latency in milliseconds.
+ */
+static void HAPLatencyHistogramRecord(HAPLatencyHistogram* histogram, HAPTime latency) {
+    HAPPrecondition(histogram);
+
+    size_t bucket = 0;
+    for (HAPTime t = latency; t && bucket < kHAPLatencyHistogram_NumBuckets - 1; t >>= 1) {
+        bucket++;
+    }
+    histogram->buckets[bucket]++;
+    histogram->numSamples++;
+    histogram->totalLatency += latency;
+    if (latency > histogram->maxLatency) {
+        histogram->maxLatency = latency > UINT32_MAX ? UINT32_MAX : (uint32_t) latency;
+    }
+}
+
+void HAPAccessoryServerRecordRequest(
+        HAPAccessoryServerRef* server_,
+        HAPAccessoryServerRequestType requestType,
+        HAPTime startTime) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition((size_t) requestType < HAPArrayCount(server->statistics.requests));
+
+    HAPTime now = HAPPlatformClockGetCurrent();
+    HAPLatencyHistogramRecord(&server->statistics.requests[requestType], now >= startTime ? now - startTime : 0);
+}
+
+void HAPCharacteristicCallbackStatisticsRecord(HAPCharacteristicCallbackStatistics* statistics, HAPTime startTime) {
+    HAPPrecondition(statistics);
+
+    HAPTime now = HAPPlatformClockGetCurrent();
+    HAPTime duration = now >= startTime ? now - startTime : 0;
+    if (duration > UINT32_MAX) {
+        duration = UINT32_MAX;
+    }
+    statistics->numCalls++;
+    if (duration > statistics->maxDuration) {
+        statistics->maxDuration = (uint32_t) duration;
+    }
+    if (duration > UINT32_MAX - statistics->totalDuration) {
+        statistics->totalDuration = UINT32_MAX;
+    } else {
+        statistics->totalDuration += (uint32_t) duration;
+    }
+}
+
 void HAPAccessoryServerHandleSubscribe(
         HAPAccessoryServerRef* server,
         HAPSessionRef* session_,
@@ -1508,14 +1985,8 @@ bool HAPAccessoryServerSupportsService(
         HAPTransportType transportType,
         const HAPService* service) {
     HAPPrecondition(server_);
-    HAPPrecondition(transportType == kHAPTransportType_IP || transportType == kHAPTransportType_BLE);
-    HAPPrecondition(service);
 
-    if (transportType == kHAPTransportType_IP && HAPUUIDAreEqual(service->serviceType, &kHAPServiceType_Pairing)) {
-        return false;
-    }
-
-    return true;
+    return IsServiceSupported(transportType, service);
 }
 
 HAP_RESULT_USE_CHECK
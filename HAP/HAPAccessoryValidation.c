@@ -56,6 +56,91 @@ static const HAPLogObject logObject = { .subsystem = kHAP_LogSubsystem, .categor
  */
 #define kHAPAccessory_MaxSerialNumberBytes ((size_t) 64)
 
+/**
+ * Maximum number of services of an accessory.
+ */
+#define kHAPAccessory_MaxServices ((size_t) 100)
+
+/**
+ * Restores the max-heap property of a subtree of instance IDs.
+ *
+ * @param      iids                 Instance IDs.
+ * @param      root                 Index of the root of the subtree.
+ * @param      numIIDs              Number of instance IDs in the heap.
+ */
+static void SiftDownInstanceID(uint64_t* iids, size_t root, size_t numIIDs) {
+    HAPPrecondition(iids);
+
+    for (;;) {
+        size_t largest = root;
+        for (size_t child = 2 * root + 1; child <= 2 * root + 2 && child < numIIDs; child++) {
+            if (iids[child] > iids[largest]) {
+                largest = child;
+            }
+        }
+        if (largest == root) {
+            return;
+        }
+        uint64_t iid = iids[root];
+        iids[root] = iids[largest];
+        iids[largest] = iid;
+        root = largest;
+    }
+}
+
+/**
+ * Sorts instance IDs in ascending order (heapsort).
+ *
+ * @param[in,out] iids              Instance IDs.
+ * @param      numIIDs              Number of instance IDs.
+ */
+static void SortInstanceIDs(uint64_t* iids, size_t numIIDs) {
+    HAPPrecondition(iids);
+
+    for (size_t i = numIIDs / 2; i > 0; i--) {
+        SiftDownInstanceID(iids, i - 1, numIIDs);
+    }
+    for (size_t i = numIIDs; i > 1; i--) {
+        uint64_t iid = iids[0];
+        iids[0] = iids[i - 1];
+        iids[i - 1] = iid;
+        SiftDownInstanceID(iids, 0, i - 1);
+    }
+}
+
+/**
+ * Looks up an instance ID in a sorted array of instance IDs (binary search).
+ *
+ * @param      iids                 Instance IDs, sorted in ascending order.
+ * @param      numIIDs              Number of instance IDs.
+ * @param      iid                  Instance ID to look up.
+ * @param[out] index                Index of the instance ID, if found.
+ *
+ * @return true                     If the instance ID was found.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool FindInstanceID(const uint64_t* iids, size_t numIIDs, uint64_t iid, size_t* index) {
+    HAPPrecondition(iids);
+    HAPPrecondition(index);
+
+    size_t lower = 0;
+    size_t upper = numIIDs;
+    while (lower < upper) {
+        size_t middle = lower + (upper - lower) / 2;
+        if (iids[middle] < iid) {
+            lower = middle + 1;
+        } else {
+            upper = middle;
+        }
+    }
+    if (lower == numIIDs || iids[lower] != iid) {
+        return false;
+    }
+    *index = lower;
+    return true;
+}
+
 /**
  * Validates generic rules of an accessory definition.
  *
@@ -205,6 +290,34 @@ static bool AccessoryIsValid(const HAPAccessory* accessory) {
                 &logObject, accessory, "Accessory must at least contain the Accessory Information Service.");
         return false;
     }
+
+    // Collect service instance IDs in ascending order to check uniqueness and to look up linked services.
+    uint64_t serviceIIDs[kHAPAccessory_MaxServices];
+    size_t numServices = 0;
+    for (size_t i = 0; accessory->services[i]; i++) {
+        if (numServices == HAPArrayCount(serviceIIDs)) {
+            HAPLogAccessoryError(
+                    &logObject,
+                    accessory,
+                    "Accessory has too many services - expected: max %zu.",
+                    kHAPAccessory_MaxServices);
+            return false;
+        }
+        serviceIIDs[numServices] = accessory->services[i]->iid;
+        numServices++;
+    }
+    SortInstanceIDs(serviceIIDs, numServices);
+    for (size_t i = 1; i < numServices; i++) {
+        if (serviceIIDs[i] == serviceIIDs[i - 1]) {
+            HAPLogAccessoryError(
+                    &logObject,
+                    accessory,
+                    "Service iid 0x%016llX specified multiple times.",
+                    (unsigned long long) serviceIIDs[i]);
+            return false;
+        }
+    }
+
     for (size_t i = 0; accessory->services[i]; i++) {
         const HAPService* service = accessory->services[i];
 
@@ -237,31 +350,14 @@ static bool AccessoryIsValid(const HAPAccessory* accessory) {
         }
 
         if (service->linkedServices) {
+            // Linked services are tracked by their index in the sorted service instance IDs.
+            uint8_t linkedServiceIndexes[HAPBitSetGetNumBytes(kHAPAccessory_MaxServices)];
+            HAPRawBufferZero(linkedServiceIndexes, sizeof linkedServiceIndexes);
             for (size_t j = 0; service->linkedServices[j]; j++) {
                 uint16_t linkedService = service->linkedServices[j];
 
-                for (size_t k = 0; k < j; k++) {
-                    if (linkedService == service->linkedServices[k]) {
-                        HAPLogServiceError(
-                                &logObject,
-                                service,
-                                accessory,
-                                "linkedServices entry 0x%016llX specified multiple times.",
-                                (unsigned long long) service->linkedServices[k]);
-                        return false;
-                    }
-                }
-
-                bool found = false;
-                for (size_t k = 0; accessory->services[k]; k++) {
-                    const HAPService* otherService = accessory->services[k];
-
-                    if (otherService->iid == linkedService) {
-                        found = true;
-                        break;
-                    }
-                }
-                if (!found) {
+                size_t serviceIndex;
+                if (!FindInstanceID(serviceIIDs, numServices, linkedService, &serviceIndex)) {
                     HAPLogServiceError(
                             &logObject,
                             service,
@@ -270,6 +366,16 @@ static bool AccessoryIsValid(const HAPAccessory* accessory) {
                             (unsigned long long) linkedService);
                     return false;
                 }
+                if (HAPBitSetContainsBit(linkedServiceIndexes, sizeof linkedServiceIndexes, serviceIndex)) {
+                    HAPLogServiceError(
+                            &logObject,
+                            service,
+                            accessory,
+                            "linkedServices entry 0x%016llX specified multiple times.",
+                            (unsigned long long) linkedService);
+                    return false;
+                }
+                HAPBitSetInsertBit(linkedServiceIndexes, sizeof linkedServiceIndexes, serviceIndex);
             }
         }
 
@@ -438,6 +544,29 @@ static bool AccessoryIsValid(const HAPAccessory* accessory) {
                     "Characteristic marked as ip.supportsWriteResponse but no handleWrite callback set."); \
             return false; \
         } \
+\
+        /* ip.suppressUnchangedEventNotifications. */ \
+        if (chr->properties.ip.suppressUnchangedEventNotifications && !chr->properties.supportsEventNotification) { \
+            HAPLogCharacteristicError( \
+                    &logObject, \
+                    characteristic, \
+                    service, \
+                    accessory, \
+                    "Characteristic marked as ip.suppressUnchangedEventNotifications " \
+                    "but not as supportsEventNotification."); \
+            return false; \
+        } \
+\
+        /* ip.cacheable. */ \
+        if (chr->properties.ip.cacheable && !chr->properties.readable) { \
+            HAPLogCharacteristicError( \
+                    &logObject, \
+                    characteristic, \
+                    service, \
+                    accessory, \
+                    "Characteristic marked as ip.cacheable but not as readable."); \
+            return false; \
+        } \
 \
         /* ble.supportsBroadcastNotification */ \
         if (chr->properties.ble.supportsBroadcastNotification && !chr->callbacks.handleRead) { \
@@ -807,3 +936,423 @@ bool HAPBridgedAccessoryIsValid(const HAPAccessory* bridgedAccessory) {
 
     return true;
 }
+
+bool HAPBridgedAccessoriesAreValid(const HAPAccessory* _Nullable const* bridgedAccessories) {
+    HAPPrecondition(bridgedAccessories);
+
+    uint64_t aids[kHAPAccessoryServerMaxBridgedAccessories];
+    size_t numAccessories = 0;
+    for (size_t i = 0; bridgedAccessories[i]; i++) {
+        if (numAccessories == HAPArrayCount(aids)) {
+            HAPLogError(
+                    &logObject,
+                    "Too many bridged accessories - expected: max %zu.",
+                    kHAPAccessoryServerMaxBridgedAccessories);
+            return false;
+        }
+        if (!HAPBridgedAccessoryIsValid(bridgedAccessories[i])) {
+            return false;
+        }
+        aids[numAccessories] = bridgedAccessories[i]->aid;
+        numAccessories++;
+    }
+
+    // Check that accessory instance IDs are unique.
+    SortInstanceIDs(aids, numAccessories);
+    for (size_t i = 1; i < numAccessories; i++) {
+        if (aids[i] == aids[i - 1]) {
+            HAPLogError(
+                    &logObject, "Bridged accessory aid %llu specified multiple times.", (unsigned long long) aids[i]);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Version of the validation rules. Must be incremented when the validation rules change
+ * so that fingerprints of accessory definitions that were validated with previous rules are no longer accepted.
+ */
+#define kHAPAccessoryValidationFingerprint_Version ((uint8_t) 1)
+
+/**
+ * Initial value of a fingerprint.
+ */
+#define kFingerprint_Seed ((uint64_t) 0xCBF29CE484222325)
+
+/**
+ * Multiplier that is used to mix values into a fingerprint (64-bit golden ratio).
+ */
+#define kFingerprint_Multiplier ((uint64_t) 0x9E3779B97F4A7C15)
+
+/**
+ * Mixes an integer into a fingerprint.
+ *
+ * - Data is mixed in 64 bits at a time so that fingerprinting is cheaper than validation.
+ *
+ * @param[in,out] fingerprint       Fingerprint.
+ * @param      value                Value to mix in.
+ */
+static void UpdateFingerprintWithUInt64(uint64_t* fingerprint, uint64_t value) {
+    HAPPrecondition(fingerprint);
+
+    *fingerprint = (*fingerprint ^ value) * kFingerprint_Multiplier;
+    *fingerprint ^= *fingerprint >> 32;
+}
+
+/**
+ * Mixes bytes into a fingerprint.
+ *
+ * @param[in,out] fingerprint       Fingerprint.
+ * @param      bytes                Bytes to mix in.
+ * @param      numBytes             Length of bytes.
+ */
+static void UpdateFingerprint(uint64_t* fingerprint, const void* bytes, size_t numBytes) {
+    HAPPrecondition(fingerprint);
+    HAPPrecondition(bytes);
+
+    uint64_t value = 0;
+    for (size_t i = 0; i < numBytes; i++) {
+        value |= (uint64_t)((const uint8_t*) bytes)[i] << (i % sizeof value * CHAR_BIT);
+        if (i % sizeof value == sizeof value - 1) {
+            UpdateFingerprintWithUInt64(fingerprint, value);
+            value = 0;
+        }
+    }
+    UpdateFingerprintWithUInt64(fingerprint, value);
+}
+
+/**
+ * Mixes an optional string into a fingerprint.
+ *
+ * - The length is mixed in last so that adjacent strings cannot be confused.
+ *
+ * @param[in,out] fingerprint       Fingerprint.
+ * @param      string               String to mix in. NULL if not set.
+ */
+static void UpdateFingerprintWithString(uint64_t* fingerprint, const char* _Nullable string) {
+    HAPPrecondition(fingerprint);
+
+    if (!string) {
+        UpdateFingerprintWithUInt64(fingerprint, UINT64_MAX);
+        return;
+    }
+    uint64_t value = 0;
+    size_t i;
+    for (i = 0; HAPNonnull(string)[i]; i++) {
+        value |= (uint64_t)(uint8_t) HAPNonnull(string)[i] << (i % sizeof value * CHAR_BIT);
+        if (i % sizeof value == sizeof value - 1) {
+            UpdateFingerprintWithUInt64(fingerprint, value);
+            value = 0;
+        }
+    }
+    UpdateFingerprintWithUInt64(fingerprint, value);
+    UpdateFingerprintWithUInt64(fingerprint, i);
+}
+
+/**
+ * Mixes the numeric constraints of a characteristic into a fingerprint.
+ *
+ * @param[in,out] fingerprint       Fingerprint.
+ * @param      chr                  Characteristic.
+ */
+#define UPDATE_FINGERPRINT_WITH_NUMERIC_CONSTRAINTS(fingerprint, chr) \
+    do { \
+        UpdateFingerprintWithUInt64((fingerprint), (chr)->units); \
+        UpdateFingerprintWithUInt64((fingerprint), (chr)->constraints.minimumValue); \
+        UpdateFingerprintWithUInt64((fingerprint), (chr)->constraints.maximumValue); \
+        UpdateFingerprintWithUInt64((fingerprint), (chr)->constraints.stepValue); \
+    } while (0)
+
+/**
+ * Mixes the part of a characteristic definition that is visible to controllers into a fingerprint.
+ *
+ * - This covers the instance ID, type, format, permissions and metadata of the characteristic.
+ *
+ * @param[in,out] fingerprint       Fingerprint.
+ * @param      characteristic_      Characteristic.
+ */
+static void UpdateFingerprintWithCharacteristicConfiguration(
+        uint64_t* fingerprint,
+        const HAPCharacteristic* characteristic_) {
+    HAPPrecondition(fingerprint);
+    HAPPrecondition(characteristic_);
+    const HAPBaseCharacteristic* characteristic = characteristic_;
+
+    UpdateFingerprintWithUInt64(fingerprint, characteristic->iid);
+    UpdateFingerprint(fingerprint, characteristic->characteristicType, sizeof *characteristic->characteristicType);
+    UpdateFingerprintWithUInt64(fingerprint, characteristic->format);
+    UpdateFingerprintWithString(fingerprint, characteristic->manufacturerDescription);
+    UpdateFingerprintWithUInt64(
+            fingerprint,
+            (uint64_t) characteristic->properties.readable << 0U |
+                    (uint64_t) characteristic->properties.writable << 1U |
+                    (uint64_t) characteristic->properties.supportsEventNotification << 2U |
+                    (uint64_t) characteristic->properties.supportsAuthorizationData << 3U |
+                    (uint64_t) characteristic->properties.requiresTimedWrite << 4U |
+                    (uint64_t) characteristic->properties.ip.supportsWriteResponse << 5U |
+                    (uint64_t) characteristic->properties.hidden << 6U);
+
+    switch (characteristic->format) {
+        case kHAPCharacteristicFormat_Data: {
+            const HAPDataCharacteristic* chr = characteristic_;
+            UpdateFingerprintWithUInt64(fingerprint, chr->constraints.maxLength);
+        } break;
+        case kHAPCharacteristicFormat_Bool: {
+        } break;
+        case kHAPCharacteristicFormat_UInt8: {
+            const HAPUInt8Characteristic* chr = characteristic_;
+            UPDATE_FINGERPRINT_WITH_NUMERIC_CONSTRAINTS(fingerprint, chr);
+            size_t numValidValues = 0;
+            for (size_t i = 0; chr->constraints.validValues && chr->constraints.validValues[i]; i++) {
+                UpdateFingerprintWithUInt64(fingerprint, *chr->constraints.validValues[i]);
+                numValidValues++;
+            }
+            UpdateFingerprintWithUInt64(fingerprint, numValidValues);
+            size_t numValidValuesRanges = 0;
+            for (size_t i = 0; chr->constraints.validValuesRanges && chr->constraints.validValuesRanges[i]; i++) {
+                UpdateFingerprintWithUInt64(fingerprint, chr->constraints.validValuesRanges[i]->start);
+                UpdateFingerprintWithUInt64(fingerprint, chr->constraints.validValuesRanges[i]->end);
+                numValidValuesRanges++;
+            }
+            UpdateFingerprintWithUInt64(fingerprint, numValidValuesRanges);
+        } break;
+        case kHAPCharacteristicFormat_UInt16: {
+            const HAPUInt16Characteristic* chr = characteristic_;
+            UPDATE_FINGERPRINT_WITH_NUMERIC_CONSTRAINTS(fingerprint, chr);
+        } break;
+        case kHAPCharacteristicFormat_UInt32: {
+            const HAPUInt32Characteristic* chr = characteristic_;
+            UPDATE_FINGERPRINT_WITH_NUMERIC_CONSTRAINTS(fingerprint, chr);
+        } break;
+        case kHAPCharacteristicFormat_UInt64: {
+            const HAPUInt64Characteristic* chr = characteristic_;
+            UPDATE_FINGERPRINT_WITH_NUMERIC_CONSTRAINTS(fingerprint, chr);
+        } break;
+        case kHAPCharacteristicFormat_Int: {
+            const HAPIntCharacteristic* chr = characteristic_;
+            UpdateFingerprintWithUInt64(fingerprint, chr->units);
+            UpdateFingerprintWithUInt64(fingerprint, (uint64_t)(int64_t) chr->constraints.minimumValue);
+            UpdateFingerprintWithUInt64(fingerprint, (uint64_t)(int64_t) chr->constraints.maximumValue);
+            UpdateFingerprintWithUInt64(fingerprint, (uint64_t)(int64_t) chr->constraints.stepValue);
+        } break;
+        case kHAPCharacteristicFormat_Float: {
+            const HAPFloatCharacteristic* chr = characteristic_;
+            UpdateFingerprintWithUInt64(fingerprint, chr->units);
+            UpdateFingerprintWithUInt64(fingerprint, HAPFloatGetBitPattern(chr->constraints.minimumValue));
+            UpdateFingerprintWithUInt64(fingerprint, HAPFloatGetBitPattern(chr->constraints.maximumValue));
+            UpdateFingerprintWithUInt64(fingerprint, HAPFloatGetBitPattern(chr->constraints.stepValue));
+        } break;
+        case kHAPCharacteristicFormat_String: {
+            const HAPStringCharacteristic* chr = characteristic_;
+            UpdateFingerprintWithUInt64(fingerprint, chr->constraints.maxLength);
+        } break;
+        case kHAPCharacteristicFormat_TLV8: {
+        } break;
+    }
+}
+
+#undef UPDATE_FINGERPRINT_WITH_NUMERIC_CONSTRAINTS
+
+/**
+ * Mixes the part of a service definition that is visible to controllers into a fingerprint.
+ *
+ * - This covers the instance ID, type, properties and linked services of the service, but not its characteristics.
+ *
+ * @param[in,out] fingerprint       Fingerprint.
+ * @param      service              Service.
+ */
+static void UpdateFingerprintWithServiceConfiguration(uint64_t* fingerprint, const HAPService* service) {
+    HAPPrecondition(fingerprint);
+    HAPPrecondition(service);
+
+    UpdateFingerprintWithUInt64(fingerprint, service->iid);
+    UpdateFingerprint(fingerprint, service->serviceType, sizeof *service->serviceType);
+    UpdateFingerprintWithUInt64(
+            fingerprint,
+            (uint64_t) service->properties.primaryService << 0U | (uint64_t) service->properties.hidden << 1U);
+
+    size_t numLinkedServices = 0;
+    for (size_t i = 0; service->linkedServices && service->linkedServices[i]; i++) {
+        UpdateFingerprintWithUInt64(fingerprint, service->linkedServices[i]);
+        numLinkedServices++;
+    }
+    UpdateFingerprintWithUInt64(fingerprint, numLinkedServices);
+}
+
+/**
+ * Mixes the presence of the callbacks of a characteristic into a fingerprint.
+ *
+ * @param[in,out] fingerprint       Fingerprint.
+ * @param      chr                  Characteristic.
+ */
+#define UPDATE_FINGERPRINT_WITH_CALLBACKS(fingerprint, chr) \
+    do { \
+        UpdateFingerprintWithUInt64((fingerprint), (chr)->callbacks.handleRead != NULL); \
+        UpdateFingerprintWithUInt64((fingerprint), (chr)->callbacks.handleWrite != NULL); \
+    } while (0)
+
+/**
+ * Mixes the presence of the callbacks of a characteristic into a fingerprint.
+ *
+ * - Function addresses are not mixed in, as they change between runs.
+ *
+ * @param[in,out] fingerprint       Fingerprint.
+ * @param      characteristic_      Characteristic.
+ */
+static void UpdateFingerprintWithCallbacks(uint64_t* fingerprint, const HAPCharacteristic* characteristic_) {
+    HAPPrecondition(fingerprint);
+    HAPPrecondition(characteristic_);
+    const HAPBaseCharacteristic* characteristic = characteristic_;
+
+    switch (characteristic->format) {
+        case kHAPCharacteristicFormat_Data: {
+            UPDATE_FINGERPRINT_WITH_CALLBACKS(fingerprint, (const HAPDataCharacteristic*) characteristic_);
+        } break;
+        case kHAPCharacteristicFormat_Bool: {
+            UPDATE_FINGERPRINT_WITH_CALLBACKS(fingerprint, (const HAPBoolCharacteristic*) characteristic_);
+        } break;
+        case kHAPCharacteristicFormat_UInt8: {
+            UPDATE_FINGERPRINT_WITH_CALLBACKS(fingerprint, (const HAPUInt8Characteristic*) characteristic_);
+        } break;
+        case kHAPCharacteristicFormat_UInt16: {
+            UPDATE_FINGERPRINT_WITH_CALLBACKS(fingerprint, (const HAPUInt16Characteristic*) characteristic_);
+        } break;
+        case kHAPCharacteristicFormat_UInt32: {
+            UPDATE_FINGERPRINT_WITH_CALLBACKS(fingerprint, (const HAPUInt32Characteristic*) characteristic_);
+        } break;
+        case kHAPCharacteristicFormat_UInt64: {
+            UPDATE_FINGERPRINT_WITH_CALLBACKS(fingerprint, (const HAPUInt64Characteristic*) characteristic_);
+        } break;
+        case kHAPCharacteristicFormat_Int: {
+            UPDATE_FINGERPRINT_WITH_CALLBACKS(fingerprint, (const HAPIntCharacteristic*) characteristic_);
+        } break;
+        case kHAPCharacteristicFormat_Float: {
+            UPDATE_FINGERPRINT_WITH_CALLBACKS(fingerprint, (const HAPFloatCharacteristic*) characteristic_);
+        } break;
+        case kHAPCharacteristicFormat_String: {
+            UPDATE_FINGERPRINT_WITH_CALLBACKS(fingerprint, (const HAPStringCharacteristic*) characteristic_);
+        } break;
+        case kHAPCharacteristicFormat_TLV8: {
+            UPDATE_FINGERPRINT_WITH_CALLBACKS(fingerprint, (const HAPTLV8Characteristic*) characteristic_);
+        } break;
+    }
+}
+
+#undef UPDATE_FINGERPRINT_WITH_CALLBACKS
+
+/**
+ * Mixes an accessory definition into a fingerprint.
+ *
+ * - In addition to the part that is visible to controllers, this covers all fields that are checked by validation.
+ * - Properties are mixed in as raw bytes. Unused bits of definitions with static storage duration are zero.
+ *   Definitions with indeterminate unused bits may produce a different fingerprint, which only leads to revalidation.
+ *
+ * @param[in,out] fingerprint       Fingerprint.
+ * @param      accessory            Accessory.
+ */
+static void UpdateFingerprintWithAccessory(uint64_t* fingerprint, const HAPAccessory* accessory) {
+    HAPPrecondition(fingerprint);
+    HAPPrecondition(accessory);
+
+    UpdateFingerprintWithUInt64(fingerprint, accessory->aid);
+    UpdateFingerprintWithUInt64(fingerprint, accessory->category);
+    UpdateFingerprintWithString(fingerprint, accessory->name);
+    UpdateFingerprintWithString(fingerprint, accessory->manufacturer);
+    UpdateFingerprintWithString(fingerprint, accessory->model);
+    UpdateFingerprintWithString(fingerprint, accessory->serialNumber);
+    UpdateFingerprintWithString(fingerprint, accessory->firmwareVersion);
+    UpdateFingerprintWithString(fingerprint, accessory->hardwareVersion);
+
+    size_t numServices = 0;
+    for (size_t i = 0; accessory->services && accessory->services[i]; i++) {
+        const HAPService* service = accessory->services[i];
+        UpdateFingerprintWithServiceConfiguration(fingerprint, service);
+        UpdateFingerprintWithString(fingerprint, service->debugDescription);
+        UpdateFingerprintWithString(fingerprint, service->name);
+        UpdateFingerprint(fingerprint, &service->properties, sizeof service->properties);
+
+        size_t numCharacteristics = 0;
+        for (size_t j = 0; service->characteristics && service->characteristics[j]; j++) {
+            const HAPBaseCharacteristic* characteristic = service->characteristics[j];
+            UpdateFingerprintWithCharacteristicConfiguration(fingerprint, characteristic);
+            UpdateFingerprintWithString(fingerprint, characteristic->debugDescription);
+            UpdateFingerprint(fingerprint, &characteristic->properties, sizeof characteristic->properties);
+            UpdateFingerprintWithCallbacks(fingerprint, characteristic);
+            numCharacteristics++;
+        }
+        UpdateFingerprintWithUInt64(fingerprint, numCharacteristics);
+        numServices++;
+    }
+    UpdateFingerprintWithUInt64(fingerprint, numServices);
+}
+
+HAP_RESULT_USE_CHECK
+uint64_t HAPAccessoryValidationGetFingerprint(
+        const HAPAccessory* primaryAccessory,
+        const HAPAccessory* _Nullable const* _Nullable bridgedAccessories) {
+    HAPPrecondition(primaryAccessory);
+
+    uint64_t fingerprint = kFingerprint_Seed;
+    UpdateFingerprintWithUInt64(&fingerprint, kHAPAccessoryValidationFingerprint_Version);
+    UpdateFingerprintWithAccessory(&fingerprint, primaryAccessory);
+    size_t numBridgedAccessories = 0;
+    for (size_t i = 0; bridgedAccessories && bridgedAccessories[i]; i++) {
+        UpdateFingerprintWithAccessory(&fingerprint, HAPNonnull(bridgedAccessories[i]));
+        numBridgedAccessories++;
+    }
+    UpdateFingerprintWithUInt64(&fingerprint, numBridgedAccessories);
+    return fingerprint;
+}
+
+/**
+ * Mixes the part of an accessory definition that is visible to controllers into a configuration hash.
+ *
+ * - Characteristics that are not served over IP are skipped.
+ *
+ * @param[in,out] hash              Configuration hash.
+ * @param      accessory            Accessory.
+ */
+static void UpdateConfigurationHashWithAccessory(uint64_t* hash, const HAPAccessory* accessory) {
+    HAPPrecondition(hash);
+    HAPPrecondition(accessory);
+
+    UpdateFingerprintWithUInt64(hash, accessory->aid);
+
+    size_t numServices = 0;
+    for (size_t i = 0; accessory->services && accessory->services[i]; i++) {
+        const HAPService* service = accessory->services[i];
+        UpdateFingerprintWithServiceConfiguration(hash, service);
+
+        size_t numCharacteristics = 0;
+        for (size_t j = 0; service->characteristics && service->characteristics[j]; j++) {
+            const HAPCharacteristic* characteristic = service->characteristics[j];
+            if (!HAPIPCharacteristicIsSupported(characteristic)) {
+                continue;
+            }
+            UpdateFingerprintWithCharacteristicConfiguration(hash, characteristic);
+            numCharacteristics++;
+        }
+        UpdateFingerprintWithUInt64(hash, numCharacteristics);
+        numServices++;
+    }
+    UpdateFingerprintWithUInt64(hash, numServices);
+}
+
+HAP_RESULT_USE_CHECK
+uint64_t HAPAccessoryGetConfigurationHash(
+        const HAPAccessory* primaryAccessory,
+        const HAPAccessory* _Nullable const* _Nullable bridgedAccessories) {
+    HAPPrecondition(primaryAccessory);
+
+    uint64_t hash = kFingerprint_Seed;
+    UpdateConfigurationHashWithAccessory(&hash, primaryAccessory);
+    size_t numBridgedAccessories = 0;
+    for (size_t i = 0; bridgedAccessories && bridgedAccessories[i]; i++) {
+        UpdateConfigurationHashWithAccessory(&hash, HAPNonnull(bridgedAccessories[i]));
+        numBridgedAccessories++;
+    }
+    UpdateFingerprintWithUInt64(&hash, numBridgedAccessories);
+    return hash;
+}
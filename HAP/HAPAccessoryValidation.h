@@ -38,6 +38,53 @@ bool HAPRegularAccessoryIsValid(HAPAccessoryServerRef* server, const HAPAccessor
  */
 bool HAPBridgedAccessoryIsValid(const HAPAccessory* bridgedAccessory);
 
+/**
+ * Validates the bridged accessory definitions of a bridge.
+ *
+ * - Each bridged accessory is validated with HAPBridgedAccessoryIsValid.
+ * - Accessory instance IDs must be unique and there must be at most kHAPAccessoryServerMaxBridgedAccessories.
+ *
+ * @param      bridgedAccessories   NULL-terminated array of bridged accessories.
+ *
+ * @return true                     If the bridged accessory definitions are valid.
+ * @return false                    Otherwise.
+ */
+bool HAPBridgedAccessoriesAreValid(const HAPAccessory* _Nullable const* bridgedAccessories);
+
+/**
+ * Computes a fingerprint of accessory definitions that covers everything that is checked during validation.
+ *
+ * - If the fingerprint matches the fingerprint of accessory definitions that have already been validated,
+ *   the accessory definitions are valid as well. Fingerprints are stable across restarts.
+ *
+ * @param      primaryAccessory     Primary accessory.
+ * @param      bridgedAccessories   NULL-terminated array of bridged accessories for a bridge accessory. NULL otherwise.
+ *
+ * @return Fingerprint of the accessory definitions.
+ */
+HAP_RESULT_USE_CHECK
+uint64_t HAPAccessoryValidationGetFingerprint(
+        const HAPAccessory* primaryAccessory,
+        const HAPAccessory* _Nullable const* _Nullable bridgedAccessories);
+
+/**
+ * Computes a hash of the part of accessory definitions that is visible to controllers.
+ *
+ * - This covers accessory instance IDs and the instance IDs, types, formats, permissions and metadata of all services
+ *   and characteristics that are served over IP. Characteristic values are not covered.
+ *
+ * - When the hash changes, the configuration number must be incremented so that controllers refresh their cache.
+ *
+ * @param      primaryAccessory     Primary accessory.
+ * @param      bridgedAccessories   NULL-terminated array of bridged accessories for a bridge accessory. NULL otherwise.
+ *
+ * @return Configuration hash of the accessory definitions.
+ */
+HAP_RESULT_USE_CHECK
+uint64_t HAPAccessoryGetConfigurationHash(
+        const HAPAccessory* primaryAccessory,
+        const HAPAccessory* _Nullable const* _Nullable bridgedAccessories);
+
 #if __has_feature(nullability)
 #pragma clang assume_nonnull end
 #endif
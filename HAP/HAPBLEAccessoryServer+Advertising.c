@@ -8,18 +8,89 @@
 
 static const HAPLogObject logObject = { .subsystem = kHAP_LogSubsystem, .category = "BLEAccessoryServer" };
 
+/**
+ * GSN state flag: GSN has been incremented in the current connect / disconnect cycle.
+ */
+#define kGSNFlags_DidIncrement ((uint8_t) 0x01U)
+
+/**
+ * GSN state flag: The persisted GSN is the end of a reserved range and may be ahead of the GSN that was in use.
+ */
+#define kGSNFlags_IsReserved ((uint8_t) 0x02U)
+
+/**
+ * Adds to a GSN, wrapping around from 65535 to 1.
+ *
+ * @param      gsn                  GSN.
+ * @param      numIncrements        Number of increments.
+ *
+ * @return GSN after the increments.
+ */
 HAP_RESULT_USE_CHECK
-HAPError HAPBLEAccessoryServerGetGSN(HAPPlatformKeyValueStoreRef keyValueStore, HAPBLEAccessoryServerGSN* gsn) {
-    HAPPrecondition(keyValueStore);
+static uint16_t AddGSN(uint16_t gsn, uint16_t numIncrements) {
     HAPPrecondition(gsn);
 
+    return (uint16_t)(((uint32_t) gsn - 1 + numIncrements) % UINT16_MAX + 1);
+}
+
+/**
+ * Writes GSN state to the key-value store.
+ *
+ * @param      server               Accessory server.
+ * @param      gsn                  GSN to persist.
+ * @param      flags                GSN state flags.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_Unknown        If an I/O error occurred.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError StoreGSN(HAPAccessoryServer* server, uint16_t gsn, uint8_t flags) {
+    HAPPrecondition(server);
+
+    HAPError err;
+
+    uint8_t gsnBytes[] = { HAPExpandLittleUInt16(gsn), flags };
+    err = HAPPlatformKeyValueStoreSet(
+            server->platform.keyValueStore,
+            kHAPKeyValueStoreDomain_Configuration,
+            kHAPKeyValueStoreKey_Configuration_BLEGSN,
+            gsnBytes,
+            sizeof gsnBytes);
+    if (err) {
+        HAPAssert(err == kHAPError_Unknown);
+        return err;
+    }
+
+    return kHAPError_None;
+}
+
+/**
+ * Loads GSN state from the key-value store, unless it is already loaded.
+ *
+ * - If the persisted GSN is the end of a reserved range, the accessory server was not stopped cleanly.
+ *   The GSN continues from the end of the range and a broadcast encryption key that would have expired
+ *   within the skipped values is expired.
+ *
+ * @param      server               Accessory server.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_Unknown        If an I/O error occurred.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError LoadGSN(HAPAccessoryServer* server) {
+    HAPPrecondition(server);
+
     HAPError err;
 
+    if (server->ble.gsn.isLoaded) {
+        return kHAPError_None;
+    }
+
     bool found;
     size_t numBytes;
     uint8_t gsnBytes[sizeof(uint16_t) + sizeof(uint8_t)];
     err = HAPPlatformKeyValueStoreGet(
-            keyValueStore,
+            server->platform.keyValueStore,
             kHAPKeyValueStoreDomain_Configuration,
             kHAPKeyValueStoreKey_Configuration_BLEGSN,
             gsnBytes,
@@ -37,10 +108,87 @@ HAPError HAPBLEAccessoryServerGetGSN(HAPPlatformKeyValueStoreRef keyValueStore,
         HAPLog(&logObject, "Invalid GSN length %lu.", (unsigned long) numBytes);
         return kHAPError_Unknown;
     }
+    uint16_t gsn = HAPReadLittleUInt16(&gsnBytes[0]);
+    if (!gsn) {
+        HAPLog(&logObject, "Invalid GSN 0.");
+        return kHAPError_Unknown;
+    }
+
+    if (gsnBytes[2] & kGSNFlags_IsReserved) {
+        HAPLogInfo(&logObject, "Recovering GSN from end of reserved range: %u.", gsn);
+
+        // Expire broadcast encryption key if its expiration GSN may have been skipped.
+        uint16_t keyExpirationGSN;
+        err = HAPBLEAccessoryServerBroadcastGetParameters(
+                (HAPAccessoryServerRef*) server, &keyExpirationGSN, NULL, NULL);
+        if (err) {
+            HAPAssert(err == kHAPError_Unknown);
+            return err;
+        }
+        if (keyExpirationGSN) {
+            uint16_t numSkippedGSNs = (uint16_t)(((uint32_t) gsn + UINT16_MAX - keyExpirationGSN) % UINT16_MAX);
+            if (numSkippedGSNs && numSkippedGSNs < kHAPBLEAccessoryServer_NumReservedGSNs) {
+                err = HAPBLEAccessoryServerBroadcastExpireKey((HAPAccessoryServerRef*) server);
+                if (err) {
+                    HAPAssert(err == kHAPError_Unknown);
+                    return err;
+                }
+            }
+        }
+
+        // State may have changed after the last persisted increment. Allow the next event to increment the GSN.
+        gsnBytes[2] &= (uint8_t) ~kGSNFlags_DidIncrement;
+    }
+
+    HAPRawBufferZero(&server->ble.gsn, sizeof server->ble.gsn);
+    server->ble.gsn.state.gsn = gsn;
+    server->ble.gsn.state.didIncrement = (gsnBytes[2] & kGSNFlags_DidIncrement) == kGSNFlags_DidIncrement;
+    server->ble.gsn.numReservedGSNs = 0;
+    server->ble.gsn.isLoaded = true;
+    server->ble.gsn.isSaved = !(gsnBytes[2] & kGSNFlags_IsReserved);
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPBLEAccessoryServerGetGSN(HAPAccessoryServerRef* server_, HAPBLEAccessoryServerGSN* gsn) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(gsn);
+
+    HAPError err;
+
+    err = LoadGSN(server);
+    if (err) {
+        HAPAssert(err == kHAPError_Unknown);
+        return err;
+    }
+
+    HAPRawBufferCopyBytes(gsn, &server->ble.gsn.state, sizeof *gsn);
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPBLEAccessoryServerSaveGSN(HAPAccessoryServerRef* server_) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+
+    HAPError err;
+
+    if (!server->ble.gsn.isLoaded || server->ble.gsn.isSaved) {
+        return kHAPError_None;
+    }
+
+    err = StoreGSN(
+            server,
+            server->ble.gsn.state.gsn,
+            server->ble.gsn.state.didIncrement ? kGSNFlags_DidIncrement : (uint8_t) 0x00);
+    if (err) {
+        HAPAssert(err == kHAPError_Unknown);
+        return err;
+    }
+    server->ble.gsn.numReservedGSNs = 0;
+    server->ble.gsn.isSaved = true;
 
-    HAPRawBufferZero(gsn, sizeof *gsn);
-    gsn->gsn = HAPReadLittleUInt16(&gsnBytes[0]);
-    gsn->didIncrement = (gsnBytes[2] & 0x01u) == 0x01;
     return kHAPError_None;
 }
 
@@ -90,8 +238,7 @@ HAPError HAPBLEAccessoryServerGetAdvertisingParameters(
         uint16_t keyExpirationGSN;
         HAPBLEAccessoryServerBroadcastEncryptionKey broadcastKey;
         HAPDeviceID advertisingID;
-        err = HAPBLEAccessoryServerBroadcastGetParameters(
-                server->platform.keyValueStore, &keyExpirationGSN, &broadcastKey, &advertisingID);
+        err = HAPBLEAccessoryServerBroadcastGetParameters(server_, &keyExpirationGSN, &broadcastKey, &advertisingID);
         if (err) {
             HAPAssert(err == kHAPError_Unknown);
             return err;
@@ -101,7 +248,7 @@ HAPError HAPBLEAccessoryServerGetAdvertisingParameters(
             return kHAPError_Unknown;
         }
         HAPBLEAccessoryServerGSN gsn;
-        err = HAPBLEAccessoryServerGetGSN(server->platform.keyValueStore, &gsn);
+        err = HAPBLEAccessoryServerGetGSN(server_, &gsn);
         if (err) {
             HAPAssert(err == kHAPError_Unknown);
             return err;
@@ -299,7 +446,7 @@ HAPError HAPBLEAccessoryServerGetAdvertisingParameters(
         adv += 2;
         /* 0x0F   GSN */ {
             HAPBLEAccessoryServerGSN gsn;
-            err = HAPBLEAccessoryServerGetGSN(server->platform.keyValueStore, &gsn);
+            err = HAPBLEAccessoryServerGetGSN(server_, &gsn);
             if (err) {
                 HAPAssert(err == kHAPError_Unknown);
                 return err;
@@ -544,23 +691,14 @@ HAPError HAPBLEAccessoryServerDidConnect(HAPAccessoryServerRef* server_) {
     }
 
     // Reset disconnected events coalescing.
-    HAPBLEAccessoryServerGSN gsn;
-    err = HAPBLEAccessoryServerGetGSN(server->platform.keyValueStore, &gsn);
+    err = LoadGSN(server);
     if (err) {
         HAPAssert(err == kHAPError_Unknown);
         return err;
     }
-    gsn.didIncrement = false;
-    uint8_t gsnBytes[] = { HAPExpandLittleUInt16(gsn.gsn), gsn.didIncrement ? (uint8_t) 0x01 : (uint8_t) 0x00 };
-    err = HAPPlatformKeyValueStoreSet(
-            server->platform.keyValueStore,
-            kHAPKeyValueStoreDomain_Configuration,
-            kHAPKeyValueStoreKey_Configuration_BLEGSN,
-            gsnBytes,
-            sizeof gsnBytes);
-    if (err) {
-        HAPAssert(err == kHAPError_Unknown);
-        return err;
+    if (server->ble.gsn.state.didIncrement) {
+        server->ble.gsn.state.didIncrement = false;
+        server->ble.gsn.isSaved = false;
     }
 
     // Reset broadcasted events.
@@ -597,23 +735,14 @@ HAPError HAPBLEAccessoryServerDidDisconnect(HAPAccessoryServerRef* server_) {
     }
 
     // Reset GSN update coalescing.
-    HAPBLEAccessoryServerGSN gsn;
-    err = HAPBLEAccessoryServerGetGSN(server->platform.keyValueStore, &gsn);
+    err = LoadGSN(server);
     if (err) {
         HAPAssert(err == kHAPError_Unknown);
         return err;
     }
-    gsn.didIncrement = false;
-    uint8_t gsnBytes[] = { HAPExpandLittleUInt16(gsn.gsn), gsn.didIncrement ? (uint8_t) 0x01 : (uint8_t) 0x00 };
-    err = HAPPlatformKeyValueStoreSet(
-            server->platform.keyValueStore,
-            kHAPKeyValueStoreDomain_Configuration,
-            kHAPKeyValueStoreKey_Configuration_BLEGSN,
-            gsnBytes,
-            sizeof gsnBytes);
-    if (err) {
-        HAPAssert(err == kHAPError_Unknown);
-        return err;
+    if (server->ble.gsn.state.didIncrement) {
+        server->ble.gsn.state.didIncrement = false;
+        server->ble.gsn.isSaved = false;
     }
 
     HAPAssert(!server->ble.adv.broadcastedEvent.iid);
@@ -632,6 +761,8 @@ HAPError HAPBLEAccessoryServerDidDisconnect(HAPAccessoryServerRef* server_) {
 /**
  * Increments GSN, invalidating broadcast encryption key if necessary.
  *
+ * - When all reserved GSN values have been used, the end of the next range is persisted before incrementing.
+ *
  * @param      server_              Accessory server.
  *
  * @return kHAPError_None           If successful.
@@ -646,50 +777,47 @@ static HAPError HAPBLEAccessoryServerIncrementGSN(HAPAccessoryServerRef* server_
 
     // Get key expiration GSN.
     uint16_t keyExpirationGSN;
-    err = HAPBLEAccessoryServerBroadcastGetParameters(server->platform.keyValueStore, &keyExpirationGSN, NULL, NULL);
+    err = HAPBLEAccessoryServerBroadcastGetParameters(server_, &keyExpirationGSN, NULL, NULL);
     if (err) {
         HAPAssert(err == kHAPError_Unknown);
         return err;
     }
 
     // Get GSN.
-    HAPBLEAccessoryServerGSN gsn;
-    err = HAPBLEAccessoryServerGetGSN(server->platform.keyValueStore, &gsn);
+    err = LoadGSN(server);
     if (err) {
         HAPAssert(err == kHAPError_Unknown);
         return err;
     }
 
     // Expire broadcast encryption key if necessary.
-    if (gsn.gsn == keyExpirationGSN) {
-        err = HAPBLEAccessoryServerBroadcastExpireKey(server->platform.keyValueStore);
+    if (server->ble.gsn.state.gsn == keyExpirationGSN) {
+        err = HAPBLEAccessoryServerBroadcastExpireKey(server_);
         if (err) {
             HAPAssert(err == kHAPError_Unknown);
             return err;
         }
     }
 
-    // Increment GSN.
-    if (gsn.gsn == UINT16_MAX) {
-        gsn.gsn = 1;
-    } else {
-        gsn.gsn++;
+    // Reserve next range of GSN values.
+    if (!server->ble.gsn.numReservedGSNs) {
+        err = StoreGSN(
+                server,
+                AddGSN(server->ble.gsn.state.gsn, kHAPBLEAccessoryServer_NumReservedGSNs),
+                kGSNFlags_DidIncrement | kGSNFlags_IsReserved);
+        if (err) {
+            HAPAssert(err == kHAPError_Unknown);
+            return err;
+        }
+        server->ble.gsn.numReservedGSNs = kHAPBLEAccessoryServer_NumReservedGSNs;
     }
-    gsn.didIncrement = true;
-    HAPLogInfo(&logObject, "New GSN: %u.", gsn.gsn);
 
-    // Save GSN state.
-    uint8_t gsnBytes[] = { HAPExpandLittleUInt16(gsn.gsn), gsn.didIncrement ? (uint8_t) 0x01 : (uint8_t) 0x00 };
-    err = HAPPlatformKeyValueStoreSet(
-            server->platform.keyValueStore,
-            kHAPKeyValueStoreDomain_Configuration,
-            kHAPKeyValueStoreKey_Configuration_BLEGSN,
-            gsnBytes,
-            sizeof gsnBytes);
-    if (err) {
-        HAPAssert(err == kHAPError_Unknown);
-        return err;
-    }
+    // Increment GSN.
+    server->ble.gsn.state.gsn = AddGSN(server->ble.gsn.state.gsn, 1);
+    server->ble.gsn.state.didIncrement = true;
+    server->ble.gsn.numReservedGSNs--;
+    server->ble.gsn.isSaved = false;
+    HAPLogInfo(&logObject, "New GSN: %u.", server->ble.gsn.state.gsn);
 
     return kHAPError_None;
 }
@@ -743,14 +871,13 @@ HAPError HAPBLEAccessoryServerDidRaiseEvent(
         // Section 7.4.6.2 Broadcasted Events
         if (!server->ble.adv.connected) {
             uint16_t keyExpirationGSN;
-            err = HAPBLEAccessoryServerBroadcastGetParameters(
-                    server->platform.keyValueStore, &keyExpirationGSN, NULL, NULL);
+            err = HAPBLEAccessoryServerBroadcastGetParameters(server_, &keyExpirationGSN, NULL, NULL);
             if (err) {
                 HAPAssert(err == kHAPError_Unknown);
                 return err;
             }
             HAPBLEAccessoryServerGSN gsn;
-            err = HAPBLEAccessoryServerGetGSN(server->platform.keyValueStore, &gsn);
+            err = HAPBLEAccessoryServerGetGSN(server_, &gsn);
             if (err) {
                 HAPAssert(err == kHAPError_Unknown);
                 return err;
@@ -1027,7 +1154,7 @@ HAPError HAPBLEAccessoryServerDidRaiseEvent(
         // Section 7.4.6.3 Disconnected Events
 
         HAPBLEAccessoryServerGSN gsn;
-        err = HAPBLEAccessoryServerGetGSN(server->platform.keyValueStore, &gsn);
+        err = HAPBLEAccessoryServerGetGSN(server_, &gsn);
         if (err) {
             HAPAssert(err == kHAPError_Unknown);
             return err;
@@ -1113,7 +1240,7 @@ HAPError HAPBLEAccessoryServerDidSendEventNotification(
     // See HomeKit Accessory Protocol Specification R14
     // Section 7.4.6.1 Connected Events
     HAPBLEAccessoryServerGSN gsn;
-    err = HAPBLEAccessoryServerGetGSN(server->platform.keyValueStore, &gsn);
+    err = HAPBLEAccessoryServerGetGSN(server_, &gsn);
     if (err) {
         HAPAssert(err == kHAPError_Unknown);
         return err;
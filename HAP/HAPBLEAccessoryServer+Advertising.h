@@ -25,17 +25,41 @@ typedef struct {
     bool didIncrement : 1; /**< Whether GSN has been incremented in the current connect / disconnect cycle. */
 } HAPBLEAccessoryServerGSN;
 
+/**
+ * BLE: Number of GSN values that are reserved in the key-value store ahead of time.
+ *
+ * - The persisted GSN is only updated once every kHAPBLEAccessoryServer_NumReservedGSNs increments.
+ *   After power loss, the GSN continues after the end of the reserved range so that it never goes backwards.
+ */
+#define kHAPBLEAccessoryServer_NumReservedGSNs ((uint16_t) 32)
+
 /**
  * BLE: Fetches GSN state.
  *
- * @param      keyValueStore        Key-value store
+ * - The GSN is loaded from the key-value store once and kept in the accessory server while it is running.
+ *
+ * @param      server               Accessory server.
  * @param[out] gsn                  GSN.
  *
  * @return kHAPError_None           If successful.
  * @return kHAPError_Unknown        If an I/O error occurred.
  */
 HAP_RESULT_USE_CHECK
-HAPError HAPBLEAccessoryServerGetGSN(HAPPlatformKeyValueStoreRef keyValueStore, HAPBLEAccessoryServerGSN* gsn);
+HAPError HAPBLEAccessoryServerGetGSN(HAPAccessoryServerRef* server, HAPBLEAccessoryServerGSN* gsn);
+
+/**
+ * BLE: Persists the exact GSN state, releasing GSN values that have been reserved but not used.
+ *
+ * - Also persists a reset of GSN update coalescing that was not followed by an increment.
+ * - Should be called when the accessory server stops.
+ *
+ * @param      server               Accessory server.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_Unknown        If an I/O error occurred.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPBLEAccessoryServerSaveGSN(HAPAccessoryServerRef* server);
 
 /**
  * BLE: Get advertisement parameters.
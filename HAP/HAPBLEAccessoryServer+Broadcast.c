@@ -8,83 +8,149 @@
 
 static const HAPLogObject logObject = { .subsystem = kHAP_LogSubsystem, .category = "BLEAccessoryServer" };
 
-typedef struct {
-    uint16_t keyExpirationGSN;
-    HAPBLEAccessoryServerBroadcastEncryptionKey key;
-    bool hasAdvertisingID;
-    HAPDeviceID advertisingID;
-} HAPBLEAccessoryServerBroadcastParameters;
-
-#define HAP_BLE_ACCESSORY_SERVER_GET_BROADCAST_PARAMETERS_OR_RETURN_ERROR(keyValueStore, parameters) \
-    do { \
-        bool found; \
-        size_t numBytes; \
-        uint8_t parametersBytes \
-                [sizeof(uint16_t) + sizeof(HAPBLEAccessoryServerBroadcastEncryptionKey) + sizeof(uint8_t) + \
-                 sizeof(HAPDeviceID)]; \
-        err = HAPPlatformKeyValueStoreGet( \
-                (keyValueStore), \
-                kHAPKeyValueStoreDomain_Configuration, \
-                kHAPKeyValueStoreKey_Configuration_BLEBroadcastParameters, \
-                parametersBytes, \
-                sizeof parametersBytes, \
-                &numBytes, \
-                &found); \
-        if (err) { \
-            HAPAssert(err == kHAPError_Unknown); \
-            return err; \
-        } \
-        if (!found) { \
-            HAPRawBufferZero(parametersBytes, sizeof parametersBytes); \
-        } else if (numBytes != sizeof parametersBytes) { \
-            HAPLog(&logObject, "Invalid BLE broadcast state length: %lu.", (unsigned long) numBytes); \
-            return kHAPError_Unknown; \
-        } \
-        HAPRawBufferZero((parameters), sizeof *(parameters)); \
-        (parameters)->keyExpirationGSN = HAPReadLittleUInt16(&parametersBytes[0]); \
-        HAPAssert(sizeof(parameters)->key.value == 32); \
-        HAPRawBufferCopyBytes((parameters)->key.value, &parametersBytes[2], 32); \
-        (parameters)->hasAdvertisingID = (uint8_t)(parametersBytes[34] & 0x01U) == 0x01; \
-        HAPAssert(sizeof(parameters)->advertisingID.bytes == 6); \
-        HAPRawBufferCopyBytes((parameters)->advertisingID.bytes, &parametersBytes[35], 6); \
-    } while (0)
+/**
+ * Loads the broadcast encryption key parameters from the key-value store, unless they are already loaded.
+ *
+ * @param      server               Accessory server.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_Unknown        If an I/O error occurred.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError LoadParameters(HAPAccessoryServer* server) {
+    HAPPrecondition(server);
+
+    HAPError err;
+
+    if (server->ble.broadcast.isLoaded) {
+        return kHAPError_None;
+    }
+
+    bool found;
+    size_t numBytes;
+    uint8_t parametersBytes
+            [sizeof(uint16_t) + sizeof(HAPBLEAccessoryServerBroadcastEncryptionKey) + sizeof(uint8_t) +
+             sizeof(HAPDeviceID)];
+    err = HAPPlatformKeyValueStoreGet(
+            server->platform.keyValueStore,
+            kHAPKeyValueStoreDomain_Configuration,
+            kHAPKeyValueStoreKey_Configuration_BLEBroadcastParameters,
+            parametersBytes,
+            sizeof parametersBytes,
+            &numBytes,
+            &found);
+    if (err) {
+        HAPAssert(err == kHAPError_Unknown);
+        return err;
+    }
+    if (!found) {
+        HAPRawBufferZero(parametersBytes, sizeof parametersBytes);
+    } else if (numBytes != sizeof parametersBytes) {
+        HAPLog(&logObject, "Invalid BLE broadcast state length: %lu.", (unsigned long) numBytes);
+        return kHAPError_Unknown;
+    }
+
+    HAPBLEAccessoryServerBroadcastParameters* parameters = &server->ble.broadcast.parameters;
+    HAPRawBufferZero(parameters, sizeof *parameters);
+    parameters->keyExpirationGSN = HAPReadLittleUInt16(&parametersBytes[0]);
+    HAPAssert(sizeof parameters->key.value == 32);
+    HAPRawBufferCopyBytes(parameters->key.value, &parametersBytes[2], 32);
+    parameters->hasAdvertisingID = (uint8_t)(parametersBytes[34] & 0x01U) == 0x01;
+    HAPAssert(sizeof parameters->advertisingID.bytes == 6);
+    HAPRawBufferCopyBytes(parameters->advertisingID.bytes, &parametersBytes[35], 6);
+    server->ble.broadcast.isLoaded = true;
+
+    return kHAPError_None;
+}
+
+/**
+ * Stores broadcast encryption key parameters and writes them through to the key-value store.
+ *
+ * - If the key-value store cannot be written, the parameters are reloaded on next access.
+ *
+ * @param      server               Accessory server.
+ * @param      parameters           Parameters to store.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_Unknown        If an I/O error occurred.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError SaveParameters(HAPAccessoryServer* server, const HAPBLEAccessoryServerBroadcastParameters* parameters) {
+    HAPPrecondition(server);
+    HAPPrecondition(parameters);
+
+    HAPError err;
+
+    uint8_t parametersBytes
+            [sizeof(uint16_t) + sizeof(HAPBLEAccessoryServerBroadcastEncryptionKey) + sizeof(uint8_t) +
+             sizeof(HAPDeviceID)];
+    HAPWriteLittleUInt16(&parametersBytes[0], parameters->keyExpirationGSN);
+    HAPAssert(sizeof parameters->key.value == 32);
+    HAPRawBufferCopyBytes(&parametersBytes[2], parameters->key.value, 32);
+    parametersBytes[34] = parameters->hasAdvertisingID ? (uint8_t) 0x01 : (uint8_t) 0x00;
+    HAPAssert(sizeof parameters->advertisingID.bytes == 6);
+    HAPRawBufferCopyBytes(&parametersBytes[35], parameters->advertisingID.bytes, 6);
+    err = HAPPlatformKeyValueStoreSet(
+            server->platform.keyValueStore,
+            kHAPKeyValueStoreDomain_Configuration,
+            kHAPKeyValueStoreKey_Configuration_BLEBroadcastParameters,
+            parametersBytes,
+            sizeof parametersBytes);
+    if (err) {
+        HAPAssert(err == kHAPError_Unknown);
+        server->ble.broadcast.isLoaded = false;
+        return err;
+    }
+
+    if (&server->ble.broadcast.parameters != parameters) {
+        HAPRawBufferCopyBytes(&server->ble.broadcast.parameters, parameters, sizeof *parameters);
+    }
+    server->ble.broadcast.isLoaded = true;
+
+    return kHAPError_None;
+}
 
 HAP_RESULT_USE_CHECK
 HAPError HAPBLEAccessoryServerBroadcastGetParameters(
-        HAPPlatformKeyValueStoreRef keyValueStore,
+        HAPAccessoryServerRef* server_,
         uint16_t* keyExpirationGSN,
         HAPBLEAccessoryServerBroadcastEncryptionKey* _Nullable broadcastKey,
         HAPDeviceID* _Nullable advertisingID) {
-    HAPPrecondition(keyValueStore);
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
     HAPPrecondition(keyExpirationGSN);
 
     HAPError err;
 
     // Get parameters.
-    HAPBLEAccessoryServerBroadcastParameters parameters;
-    HAP_BLE_ACCESSORY_SERVER_GET_BROADCAST_PARAMETERS_OR_RETURN_ERROR(keyValueStore, &parameters);
+    err = LoadParameters(server);
+    if (err) {
+        HAPAssert(err == kHAPError_Unknown);
+        return err;
+    }
+    const HAPBLEAccessoryServerBroadcastParameters* parameters = &server->ble.broadcast.parameters;
 
     // Copy result.
-    *keyExpirationGSN = parameters.keyExpirationGSN;
-    if (parameters.keyExpirationGSN) {
+    *keyExpirationGSN = parameters->keyExpirationGSN;
+    if (parameters->keyExpirationGSN) {
         if (broadcastKey) {
-            HAPRawBufferCopyBytes(HAPNonnull(broadcastKey), &parameters.key, sizeof *broadcastKey);
+            HAPRawBufferCopyBytes(HAPNonnull(broadcastKey), &parameters->key, sizeof *broadcastKey);
             HAPLogSensitiveBufferDebug(
                     &logObject,
-                    parameters.key.value,
-                    sizeof parameters.key.value,
+                    parameters->key.value,
+                    sizeof parameters->key.value,
                     "BLE Broadcast Encryption Key (Expires after GSN %u).",
-                    parameters.keyExpirationGSN);
+                    parameters->keyExpirationGSN);
         }
     }
     if (advertisingID) {
-        if (parameters.hasAdvertisingID) {
-            HAPRawBufferCopyBytes(HAPNonnull(advertisingID), &parameters.advertisingID, sizeof *advertisingID);
+        if (parameters->hasAdvertisingID) {
+            HAPRawBufferCopyBytes(HAPNonnull(advertisingID), &parameters->advertisingID, sizeof *advertisingID);
         } else {
             // Fallback to Device ID.
             // See HomeKit Accessory Protocol Specification R14
             // Section 7.4.2.2.2 Manufacturer Data
-            err = HAPDeviceIDGet(keyValueStore, HAPNonnull(advertisingID));
+            err = HAPDeviceIDGet(server->platform.keyValueStore, HAPNonnull(advertisingID));
             if (err) {
                 HAPAssert(err == kHAPError_Unknown);
                 return err;
@@ -106,12 +172,16 @@ HAPError
     HAPError err;
 
     // Get state.
-    HAPBLEAccessoryServerBroadcastParameters parameters;
-    HAP_BLE_ACCESSORY_SERVER_GET_BROADCAST_PARAMETERS_OR_RETURN_ERROR(server->platform.keyValueStore, &parameters);
+    err = LoadParameters(server);
+    if (err) {
+        HAPAssert(err == kHAPError_Unknown);
+        return err;
+    }
+    HAPBLEAccessoryServerBroadcastParameters parameters = server->ble.broadcast.parameters;
 
     // Get GSN.
     HAPBLEAccessoryServerGSN gsn;
-    err = HAPBLEAccessoryServerGetGSN(server->platform.keyValueStore, &gsn);
+    err = HAPBLEAccessoryServerGetGSN((HAPAccessoryServerRef*) server, &gsn);
     if (err) {
         HAPAssert(err == kHAPError_Unknown);
         return err;
@@ -188,21 +258,7 @@ HAPError
     }
 
     // Save.
-    uint8_t parametersBytes
-            [sizeof(uint16_t) + sizeof(HAPBLEAccessoryServerBroadcastEncryptionKey) + sizeof(uint8_t) +
-             sizeof(HAPDeviceID)];
-    HAPWriteLittleUInt16(&parametersBytes[0], parameters.keyExpirationGSN);
-    HAPAssert(sizeof parameters.key.value == 32);
-    HAPRawBufferCopyBytes(&parametersBytes[2], parameters.key.value, 32);
-    parametersBytes[34] = parameters.hasAdvertisingID ? (uint8_t) 0x01 : (uint8_t) 0x00;
-    HAPAssert(sizeof parameters.advertisingID.bytes == 6);
-    HAPRawBufferCopyBytes(&parametersBytes[35], parameters.advertisingID.bytes, 6);
-    err = HAPPlatformKeyValueStoreSet(
-            server->platform.keyValueStore,
-            kHAPKeyValueStoreDomain_Configuration,
-            kHAPKeyValueStoreKey_Configuration_BLEBroadcastParameters,
-            parametersBytes,
-            sizeof parametersBytes);
+    err = SaveParameters(server, &parameters);
     if (err) {
         HAPAssert(err == kHAPError_Unknown);
         return err;
@@ -213,16 +269,21 @@ HAPError
 
 HAP_RESULT_USE_CHECK
 HAPError HAPBLEAccessoryServerBroadcastSetAdvertisingID(
-        HAPPlatformKeyValueStoreRef keyValueStore,
+        HAPAccessoryServerRef* server_,
         const HAPDeviceID* advertisingID) {
-    HAPPrecondition(keyValueStore);
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
     HAPPrecondition(advertisingID);
 
     HAPError err;
 
     // Get state.
-    HAPBLEAccessoryServerBroadcastParameters parameters;
-    HAP_BLE_ACCESSORY_SERVER_GET_BROADCAST_PARAMETERS_OR_RETURN_ERROR(keyValueStore, &parameters);
+    err = LoadParameters(server);
+    if (err) {
+        HAPAssert(err == kHAPError_Unknown);
+        return err;
+    }
+    HAPBLEAccessoryServerBroadcastParameters parameters = server->ble.broadcast.parameters;
 
     // Copy advertising identifier.
     parameters.hasAdvertisingID = true;
@@ -230,21 +291,7 @@ HAPError HAPBLEAccessoryServerBroadcastSetAdvertisingID(
     HAPRawBufferCopyBytes(&parameters.advertisingID, advertisingID, sizeof parameters.advertisingID);
 
     // Save.
-    uint8_t parametersBytes
-            [sizeof(uint16_t) + sizeof(HAPBLEAccessoryServerBroadcastEncryptionKey) + sizeof(uint8_t) +
-             sizeof(HAPDeviceID)];
-    HAPWriteLittleUInt16(&parametersBytes[0], parameters.keyExpirationGSN);
-    HAPAssert(sizeof parameters.key.value == 32);
-    HAPRawBufferCopyBytes(&parametersBytes[2], parameters.key.value, 32);
-    parametersBytes[34] = parameters.hasAdvertisingID ? (uint8_t) 0x01 : (uint8_t) 0x00;
-    HAPAssert(sizeof parameters.advertisingID.bytes == 6);
-    HAPRawBufferCopyBytes(&parametersBytes[35], parameters.advertisingID.bytes, 6);
-    err = HAPPlatformKeyValueStoreSet(
-            keyValueStore,
-            kHAPKeyValueStoreDomain_Configuration,
-            kHAPKeyValueStoreKey_Configuration_BLEBroadcastParameters,
-            parametersBytes,
-            sizeof parametersBytes);
+    err = SaveParameters(server, &parameters);
     if (err) {
         HAPAssert(err == kHAPError_Unknown);
         return err;
@@ -254,37 +301,28 @@ HAPError HAPBLEAccessoryServerBroadcastSetAdvertisingID(
 }
 
 HAP_RESULT_USE_CHECK
-HAPError HAPBLEAccessoryServerBroadcastExpireKey(HAPPlatformKeyValueStoreRef keyValueStore) {
-    HAPPrecondition(keyValueStore);
+HAPError HAPBLEAccessoryServerBroadcastExpireKey(HAPAccessoryServerRef* server_) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
 
     HAPError err;
 
     HAPLogInfo(&logObject, "Expiring broadcast encryption key.");
 
     // Get state.
-    HAPBLEAccessoryServerBroadcastParameters parameters;
-    HAP_BLE_ACCESSORY_SERVER_GET_BROADCAST_PARAMETERS_OR_RETURN_ERROR(keyValueStore, &parameters);
+    err = LoadParameters(server);
+    if (err) {
+        HAPAssert(err == kHAPError_Unknown);
+        return err;
+    }
+    HAPBLEAccessoryServerBroadcastParameters parameters = server->ble.broadcast.parameters;
 
     // Expire encryption key.
     parameters.keyExpirationGSN = 0;
     HAPRawBufferZero(&parameters.key, sizeof parameters.key);
 
     // Save.
-    uint8_t parametersBytes
-            [sizeof(uint16_t) + sizeof(HAPBLEAccessoryServerBroadcastEncryptionKey) + sizeof(uint8_t) +
-             sizeof(HAPDeviceID)];
-    HAPWriteLittleUInt16(&parametersBytes[0], parameters.keyExpirationGSN);
-    HAPAssert(sizeof parameters.key.value == 32);
-    HAPRawBufferCopyBytes(&parametersBytes[2], parameters.key.value, 32);
-    parametersBytes[34] = parameters.hasAdvertisingID ? (uint8_t) 0x01 : (uint8_t) 0x00;
-    HAPAssert(sizeof parameters.advertisingID.bytes == 6);
-    HAPRawBufferCopyBytes(&parametersBytes[35], parameters.advertisingID.bytes, 6);
-    err = HAPPlatformKeyValueStoreSet(
-            keyValueStore,
-            kHAPKeyValueStoreDomain_Configuration,
-            kHAPKeyValueStoreKey_Configuration_BLEBroadcastParameters,
-            parametersBytes,
-            sizeof parametersBytes);
+    err = SaveParameters(server, &parameters);
     if (err) {
         HAPAssert(err == kHAPError_Unknown);
         return err;
@@ -70,6 +70,10 @@ static void PrepareStart(HAPAccessoryServerRef* server_) {
     HAPRawBufferZero(storage->session, sizeof *storage->session);
     HAPRawBufferZero(storage->procedures, storage->numProcedures * sizeof *storage->procedures);
     HAPRawBufferZero(storage->procedureBuffer.bytes, storage->procedureBuffer.numBytes);
+
+    // Reload GSN and broadcast encryption key parameters. Key-value store may have been modified while stopped.
+    HAPRawBufferZero(&server->ble.gsn, sizeof server->ble.gsn);
+    HAPRawBufferZero(&server->ble.broadcast, sizeof server->ble.broadcast);
 }
 
 static void Start(HAPAccessoryServerRef* server_) {
@@ -140,6 +144,13 @@ static void TryStop(HAPAccessoryServerRef* server_, bool* didStop) {
     HAPPlatformBLEPeripheralManagerRemoveAllServices(blePeripheralManager);
     HAPPlatformBLEPeripheralManagerSetDelegate(blePeripheralManager, NULL);
 
+    // Release reserved GSN values.
+    HAPError err = HAPBLEAccessoryServerSaveGSN(server_);
+    if (err) {
+        HAPAssert(err == kHAPError_Unknown);
+        HAPLog(&logObject, "Failed to save GSN. Reserved GSN values will be skipped on next start.");
+    }
+
     *didStop = true;
 }
 
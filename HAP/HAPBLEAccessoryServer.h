@@ -39,11 +39,11 @@ struct HAPBLEAccessoryServerTransport {
     void (*updateAdvertisingData)(HAPAccessoryServerRef* server);
 
     HAP_RESULT_USE_CHECK
-    HAPError (*getGSN)(HAPPlatformKeyValueStoreRef keyValueStore, HAPBLEAccessoryServerGSN* gsn);
+    HAPError (*getGSN)(HAPAccessoryServerRef* server, HAPBLEAccessoryServerGSN* gsn);
 
     struct {
         HAP_RESULT_USE_CHECK
-        HAPError (*expireKey)(HAPPlatformKeyValueStoreRef keyValueStore);
+        HAPError (*expireKey)(HAPAccessoryServerRef* server);
     } broadcast;
 
     struct {
@@ -200,13 +200,22 @@ static HAPError ParseRequest(
         size_t numValueBytesWithNULL = numValueBytes + 1;
 
         // Case 3.
-        void* valueStart = &bytes[0];
-
-        // Move VAL.
-        HAPRawBufferCopyBytes(valueStart, HAPNonnullVoid(valueTLV.value.bytes), numValueBytesWithNULL);
-        value->bytes = valueStart;
-        value->numBytes = numValueBytes;
-        value->maxBytes = maxBytes;
+        if (numValueBytesWithNULL <= maxBytes) {
+            void* valueStart = &bytes[0];
+
+            // Move VAL.
+            HAPRawBufferCopyBytes(valueStart, HAPNonnullVoid(valueTLV.value.bytes), numValueBytesWithNULL);
+            value->bytes = valueStart;
+            value->numBytes = numValueBytes;
+            value->maxBytes = maxBytes;
+        } else {
+            // VAL occupies more than half of the buffer and does not fit into the free space. Keep it in place.
+            uint8_t* valueStart = (void*) (uintptr_t) valueTLV.value.bytes;
+            HAPAssert(valueStart < bytes);
+            value->bytes = valueStart;
+            value->numBytes = numValueBytes;
+            value->maxBytes = (size_t)(bytes - valueStart) + maxBytes;
+        }
     }
 
     HAPAssert(((const uint8_t*) value->bytes)[value->numBytes] == '\0');
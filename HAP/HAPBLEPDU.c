@@ -688,3 +688,16 @@ done:
     (void) b;
     return kHAPError_None;
 }
+
+HAP_RESULT_USE_CHECK
+size_t HAPBLEPDUGetMaxFragmentBytes(size_t maxBytes, uint16_t mtu) {
+    HAPPrecondition(mtu >= kHAPPlatformBLEPeripheralManager_DefaultMTU);
+
+    // Each ATT Read Response and Read Blob Response carries up to ATT_MTU - 1 bytes of the value.
+    size_t numResponseBytes = (size_t) mtu - 1;
+    size_t numRoundTrips = (maxBytes + 1) / numResponseBytes;
+    if (!numRoundTrips) {
+        return maxBytes;
+    }
+    return numRoundTrips * numResponseBytes - 1;
+}
@@ -277,6 +277,24 @@ HAPError HAPBLEPDUDeserializeContinuation(
 HAP_RESULT_USE_CHECK
 HAPError HAPBLEPDUSerialize(const HAPBLEPDU* pdu, void* bytes, size_t maxBytes, size_t* numBytes);
 
+/**
+ * Returns the maximum length of a GATT value that carries a fragment which does not complete a HAP-BLE PDU.
+ *
+ * - A central reads a long attribute value with a "Read Request" followed by "Read Blob Requests" until a response
+ *   is shorter than ATT_MTU - 1 bytes. A value with a length of k * (ATT_MTU - 1) - 1 bytes is therefore transferred
+ *   in k round trips, while any longer value needs an additional round trip for its last few bytes.
+ *
+ * @param      maxBytes             Capacity of the GATT value.
+ * @param      mtu                  Negotiated ATT MTU.
+ *
+ * @return Largest GATT value length up to maxBytes that is transferred in whole ATT responses.
+ *
+ * @see Bluetooth Core Specification Version 5
+ *      Vol 3 Part F Section 3.4.4.5 Read Blob Request
+ */
+HAP_RESULT_USE_CHECK
+size_t HAPBLEPDUGetMaxFragmentBytes(size_t maxBytes, uint16_t mtu);
+
 #if __has_feature(nullability)
 #pragma clang assume_nonnull end
 #endif
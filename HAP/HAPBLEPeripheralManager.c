@@ -226,6 +226,7 @@ static void HandleConnectedCentral(
     AbortAllFallbackProcedures(server_);
     ResetEventState(server_);
     server->ble.connection.connectionHandle = connectionHandle;
+    server->ble.connection.mtu = kHAPPlatformBLEPeripheralManager_DefaultMTU;
     server->ble.connection.connected = true;
 
     err = HAPBLEAccessoryServerDidConnect(server_);
@@ -271,6 +272,29 @@ static void HandleDisconnectedCentral(
     }
 }
 
+static void HandleUpdatedMTU(
+        HAPPlatformBLEPeripheralManagerRef blePeripheralManager,
+        HAPPlatformBLEPeripheralManagerConnectionHandle connectionHandle,
+        uint16_t mtu,
+        void* _Nullable context) {
+    HAPPrecondition(blePeripheralManager);
+    HAPPrecondition(mtu >= kHAPPlatformBLEPeripheralManager_DefaultMTU);
+    HAPPrecondition(context);
+    HAPAccessoryServerRef* server_ = context;
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+
+    HAPLogInfo(&logObject, "%s(0x%04x, %u)", __func__, connectionHandle, mtu);
+
+    // The ATT MTU exchange may be reported after the central has already disconnected.
+    // The next connection starts over with the default ATT MTU, so the update is dropped.
+    if (!server->ble.connection.connected || connectionHandle != server->ble.connection.connectionHandle) {
+        HAPLog(&logObject, "Ignoring ATT MTU update for connection 0x%04x that is not active.", connectionHandle);
+        return;
+    }
+
+    server->ble.connection.mtu = mtu;
+}
+
 /**
  * Continues sending of pending HAP event notifications.
  *
@@ -1109,6 +1133,7 @@ HAP_PWT_HAPBLEProcedureType(5, 4) HAP_RESULT_USE_CHECK static HAPError AttachPro
             service,
             accessory);
     server->ble.connection.procedureAttached = true;
+    HAPAccessoryServerUpdateHighWaterMark(&server->storageHighWaterMarks.ble.numProcedures, 1);
 
     *procedureType = kHAPBLEProcedureType_Full;
     *procedure = fullProcedure;
@@ -1478,7 +1503,8 @@ void HAPBLEPeripheralManagerRegister(HAPAccessoryServerRef* server_) {
                                                                .handleReadRequest = HandleReadRequest,
                                                                .handleWriteRequest = HandleWriteRequest,
                                                                .handleReadyToUpdateSubscribers =
-                                                                       HandleReadyToUpdateSubscribers });
+                                                                       HandleReadyToUpdateSubscribers,
+                                                               .handleUpdatedMTU = HandleUpdatedMTU });
 
     // Register DB.
     size_t o = 0;
@@ -1632,6 +1658,7 @@ void HAPBLEPeripheralManagerRegister(HAPAccessoryServerRef* server_) {
 
     // Finalize GATT database.
     HAPPlatformBLEPeripheralManagerPublishServices(blePeripheralManager);
+    HAPAccessoryServerUpdateHighWaterMark(&server->storageHighWaterMarks.ble.numGATTTableElements, o);
 }
 
 void HAPBLEPeripheralManagerRaiseEvent(
@@ -1232,6 +1232,7 @@ HAPError HAPBLEProcedureHandleGATTRead(
     HAPPrecondition(bleProcedure_);
     HAPBLEProcedure* bleProcedure = (HAPBLEProcedure*) bleProcedure_;
     HAPPrecondition(bleProcedure->server);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) bleProcedure->server;
     HAPPrecondition(bleProcedure->session);
     HAPSession* session = (HAPSession*) bleProcedure->session;
     HAPPrecondition(session->transportType == kHAPTransportType_BLE);
@@ -1271,11 +1272,28 @@ HAPError HAPBLEProcedureHandleGATTRead(
 
     // Process pending request.
     if (HAPBLETransactionIsRequestAvailable(&bleProcedure->transaction)) {
+        HAPAccessoryServerUpdateHighWaterMark(
+                &server->storageHighWaterMarks.ble.numProcedureBufferBytes,
+                bleProcedure->transaction._.request.totalBodyBytes);
+        HAPTime startTime = HAPPlatformClockGetCurrent();
         err = HAPBLEProcedureProcessTransaction(bleProcedure_);
         if (err) {
             HAPAssert(err == kHAPError_InvalidState);
             return err;
         }
+        HAPAccessoryServerRecordRequest(
+                HAPNonnull(bleProcedure->server), kHAPAccessoryServerRequestType_BLEProcedure, startTime);
+        HAPAccessoryServerUpdateHighWaterMark(
+                &server->storageHighWaterMarks.ble.numProcedureBufferBytes,
+                bleProcedure->transaction._.response.totalBodyBytes);
+    }
+
+    // Fragments that do not complete the response are sized to fill whole ATT responses at the negotiated ATT MTU.
+    size_t numResponseBytes;
+    err = HAPBLETransactionGetNumRemainingResponseBytes(&bleProcedure->transaction, &numResponseBytes);
+    if (!err && numResponseBytes > maxBytes) {
+        size_t numTagBytes = bleProcedure->startedSecured ? CHACHA20_POLY1305_TAG_BYTES : 0;
+        maxBytes = HAPBLEPDUGetMaxFragmentBytes(maxBytes + numTagBytes, server->ble.connection.mtu) - numTagBytes;
     }
 
     // Prepare next response fragment.
@@ -207,6 +207,33 @@ void HAPBLETransactionSetResponse(
     }
 }
 
+HAP_RESULT_USE_CHECK
+HAPError HAPBLETransactionGetNumRemainingResponseBytes(const HAPBLETransaction* bleTransaction, size_t* numBytes) {
+    HAPPrecondition(bleTransaction);
+    HAPPrecondition(numBytes);
+
+    switch (bleTransaction->state) {
+        case kHAPBLETransactionState_WaitingForInitialRead: {
+            *numBytes = kHAPBLEPDU_NumResponseHeaderBytes;
+            if (bleTransaction->_.response.totalBodyBytes) {
+                *numBytes += kHAPBLEPDU_NumBodyHeaderBytes + bleTransaction->_.response.totalBodyBytes;
+            }
+        }
+            return kHAPError_None;
+        case kHAPBLETransactionState_WritingResponse: {
+            *numBytes = kHAPBLEPDU_NumContinuationHeaderBytes + bleTransaction->_.response.totalBodyBytes -
+                        bleTransaction->_.response.bodyOffset;
+        }
+            return kHAPError_None;
+        case kHAPBLETransactionState_WaitingForInitialWrite:
+        case kHAPBLETransactionState_ReadingRequest:
+        case kHAPBLETransactionState_HandlingRequest: {
+        }
+            return kHAPError_InvalidState;
+    }
+    HAPFatalError();
+}
+
 HAP_RESULT_USE_CHECK
 HAPError HAPBLETransactionHandleRead(
         HAPBLETransaction* bleTransaction,
@@ -164,6 +164,18 @@ void HAPBLETransactionSetResponse(
         HAPBLEPDUStatus status,
         const HAPTLVWriterRef* _Nullable bodyWriter);
 
+/**
+ * Returns the length of the next response fragment if all remaining response data is sent in that fragment.
+ *
+ * @param      bleTransaction       Transaction.
+ * @param[out] numBytes             Length of a fragment that contains all remaining response data.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If no response is being sent.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPBLETransactionGetNumRemainingResponseBytes(const HAPBLETransaction* bleTransaction, size_t* numBytes);
+
 /**
  * Fills a buffer with the next response fragment to be sent.
  *
@@ -4,13 +4,10 @@
 // you may not use this file except in compliance with the License.
 // See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
 
-#undef HAP_DISALLOW_USE_IGNORED
-#define HAP_DISALLOW_USE_IGNORED 1
-
 #include "HAP+Internal.h"
 
 HAP_RESULT_USE_CHECK
-bool HAPBitSetContainsInternal(const uint8_t* bitSet, size_t numBytes, uint8_t bitIndex) {
+bool HAPBitSetContainsBit(const uint8_t* bitSet, size_t numBytes, size_t bitIndex) {
     HAPPrecondition(bitSet);
 
     size_t byteIndex = bitIndex / CHAR_BIT;
@@ -20,7 +17,7 @@ bool HAPBitSetContainsInternal(const uint8_t* bitSet, size_t numBytes, uint8_t b
     return bitSet[byteIndex] & bitMask;
 }
 
-void HAPBitSetInsertInternal(uint8_t* bitSet, size_t numBytes, uint8_t bitIndex) {
+void HAPBitSetInsertBit(uint8_t* bitSet, size_t numBytes, size_t bitIndex) {
     HAPPrecondition(bitSet);
 
     size_t byteIndex = bitIndex / CHAR_BIT;
@@ -30,7 +27,7 @@ void HAPBitSetInsertInternal(uint8_t* bitSet, size_t numBytes, uint8_t bitIndex)
     bitSet[byteIndex] |= bitMask;
 }
 
-void HAPBitSetRemoveInternal(uint8_t* bitSet, size_t numBytes, uint8_t bitIndex) {
+void HAPBitSetRemoveBit(uint8_t* bitSet, size_t numBytes, size_t bitIndex) {
     HAPPrecondition(bitSet);
 
     size_t byteIndex = bitIndex / CHAR_BIT;
@@ -39,3 +36,66 @@ void HAPBitSetRemoveInternal(uint8_t* bitSet, size_t numBytes, uint8_t bitIndex)
 
     bitSet[byteIndex] &= (uint8_t) ~bitMask;
 }
+
+/**
+ * Returns the number of bits that are set in a 64-bit word.
+ *
+ * @param      word                 Word.
+ *
+ * @return Number of bits that are set.
+ */
+HAP_RESULT_USE_CHECK
+static size_t GetWordCount(uint64_t word) {
+    word = word - ((word >> 1) & 0x5555555555555555ULL);
+    word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (size_t)((word * 0x0101010101010101ULL) >> 56);
+}
+
+HAP_RESULT_USE_CHECK
+size_t HAPBitSetGetCount(const uint8_t* bitSet, size_t numBytes) {
+    HAPPrecondition(bitSet);
+
+    size_t count = 0;
+    size_t i = 0;
+    for (; numBytes - i >= sizeof(uint64_t); i += sizeof(uint64_t)) {
+        count += GetWordCount(HAPReadLittleUInt64(&bitSet[i]));
+    }
+    for (; i < numBytes; i++) {
+        count += GetWordCount(bitSet[i]);
+    }
+    return count;
+}
+
+HAP_RESULT_USE_CHECK
+bool HAPBitSetFindNext(const uint8_t* bitSet, size_t numBytes, size_t* bitIndex) {
+    HAPPrecondition(bitSet);
+    HAPPrecondition(bitIndex);
+
+    size_t byteIndex = *bitIndex / CHAR_BIT;
+    uint8_t byteMask = (uint8_t)(0xFFu << (*bitIndex % CHAR_BIT));
+    while (byteIndex < numBytes) {
+        // Skip cleared words.
+        if (!(byteIndex % sizeof(uint64_t)) && byteMask == 0xFF) {
+            while (numBytes - byteIndex >= sizeof(uint64_t) && !HAPReadLittleUInt64(&bitSet[byteIndex])) {
+                byteIndex += sizeof(uint64_t);
+            }
+            if (byteIndex == numBytes) {
+                break;
+            }
+        }
+
+        uint8_t byte = bitSet[byteIndex] & byteMask;
+        if (byte) {
+            size_t i = 0;
+            while (!(byte & (1u << i))) {
+                i++;
+            }
+            *bitIndex = byteIndex * CHAR_BIT + i;
+            return true;
+        }
+        byteIndex++;
+        byteMask = 0xFF;
+    }
+    return false;
+}
@@ -4,8 +4,8 @@
 // you may not use this file except in compliance with the License.
 // See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
 
-#ifndef HAP_UTILS_H
-#define HAP_UTILS_H
+#ifndef HAP_BIT_SET_H
+#define HAP_BIT_SET_H
 
 #ifdef __cplusplus
 extern "C" {
@@ -17,6 +17,15 @@ extern "C" {
 #pragma clang assume_nonnull begin
 #endif
 
+/**
+ * Returns the number of bytes that are needed to store a bit set with the given number of bits.
+ *
+ * @param      numBits              Number of bits.
+ *
+ * @return Number of bytes.
+ */
+#define HAPBitSetGetNumBytes(numBits) (((numBits) + CHAR_BIT - 1) / CHAR_BIT)
+
 /**
  * Indicates whether the specified bit is set in a bit set.
  *
@@ -26,7 +35,7 @@ extern "C" {
  * @return true                     If the specified bit is set.
  * @return false                    Otherwise.
  */
-#define HAPBitSetContains(bitSet, bitIndex) HAPBitSetContainsInternal((bitSet), sizeof(bitSet), (bitIndex))
+#define HAPBitSetContains(bitSet, bitIndex) HAPBitSetContainsBit((bitSet), sizeof(bitSet), (bitIndex))
 
 /**
  * Inserts the specified bit into a bit set.
@@ -34,7 +43,7 @@ extern "C" {
  * @param      bitSet               Byte array representing the bit set.
  * @param      bitIndex             Bit index.
  */
-#define HAPBitSetInsert(bitSet, bitIndex) HAPBitSetInsertInternal((bitSet), sizeof(bitSet), (bitIndex))
+#define HAPBitSetInsert(bitSet, bitIndex) HAPBitSetInsertBit((bitSet), sizeof(bitSet), (bitIndex))
 
 /**
  * Removes the specified bit from a bit set.
@@ -42,22 +51,69 @@ extern "C" {
  * @param      bitSet               Byte array representing the bit set.
  * @param      bitIndex             Bit index.
  */
-#define HAPBitSetRemove(bitSet, bitIndex) HAPBitSetRemoveInternal((bitSet), sizeof(bitSet), (bitIndex))
+#define HAPBitSetRemove(bitSet, bitIndex) HAPBitSetRemoveBit((bitSet), sizeof(bitSet), (bitIndex))
 
-//----------------------------------------------------------------------------------------------------------------------
-// Internal functions. Do not use directly.
-
-/**@cond */
+/**
+ * Indicates whether the specified bit is set in a bit set.
+ *
+ * - Bit n is stored in byte n / 8 at bit position n % 8.
+ *
+ * @param      bitSet               Bit set.
+ * @param      numBytes             Length of the bit set.
+ * @param      bitIndex             Bit index.
+ *
+ * @return true                     If the specified bit is set.
+ * @return false                    Otherwise.
+ */
 HAP_RESULT_USE_CHECK
-bool HAPBitSetContainsInternal(const uint8_t* bitSet, size_t numBytes, uint8_t bitIndex);
-HAP_DISALLOW_USE(HAPBitSetContainsInternal)
+bool HAPBitSetContainsBit(const uint8_t* bitSet, size_t numBytes, size_t bitIndex);
 
-void HAPBitSetInsertInternal(uint8_t* bitSet, size_t numBytes, uint8_t bitIndex);
-HAP_DISALLOW_USE(HAPBitSetInsertInternal)
+/**
+ * Inserts the specified bit into a bit set.
+ *
+ * @param      bitSet               Bit set.
+ * @param      numBytes             Length of the bit set.
+ * @param      bitIndex             Bit index.
+ */
+void HAPBitSetInsertBit(uint8_t* bitSet, size_t numBytes, size_t bitIndex);
 
-void HAPBitSetRemoveInternal(uint8_t* bitSet, size_t numBytes, uint8_t bitIndex);
-HAP_DISALLOW_USE(HAPBitSetRemoveInternal)
-/**@endcond */
+/**
+ * Removes the specified bit from a bit set.
+ *
+ * @param      bitSet               Bit set.
+ * @param      numBytes             Length of the bit set.
+ * @param      bitIndex             Bit index.
+ */
+void HAPBitSetRemoveBit(uint8_t* bitSet, size_t numBytes, size_t bitIndex);
+
+/**
+ * Returns the number of bits that are set in a bit set.
+ *
+ * - The bit set is processed 64 bits at a time.
+ *
+ * @param      bitSet               Bit set.
+ * @param      numBytes             Length of the bit set.
+ *
+ * @return Number of bits that are set.
+ */
+HAP_RESULT_USE_CHECK
+size_t HAPBitSetGetCount(const uint8_t* bitSet, size_t numBytes);
+
+/**
+ * Finds the next bit that is set in a bit set.
+ *
+ * - Runs of cleared bits are skipped 64 bits at a time.
+ *
+ * @param      bitSet               Bit set.
+ * @param      numBytes             Length of the bit set.
+ * @param[in,out] bitIndex          On input, bit index from which to start the search.
+ *                                  On output, index of the next bit that is set, if found.
+ *
+ * @return true                     If a bit that is set has been found.
+ * @return false                    If no bit at or after the start index is set.
+ */
+HAP_RESULT_USE_CHECK
+bool HAPBitSetFindNext(const uint8_t* bitSet, size_t numBytes, size_t* bitIndex);
 
 #if __has_feature(nullability)
 #pragma clang assume_nonnull end
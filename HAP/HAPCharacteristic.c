@@ -165,6 +165,9 @@ HAPError HAPDataCharacteristicHandleWrite(
         return kHAPError_InvalidData;
     }
 
+    // Discard cached value. The write handler may provide the new value with HAPAccessoryServerRaiseEventWithValue.
+    HAPAccessoryServerInvalidateCachedValue(server, request->characteristic, request->service, request->accessory);
+
     // Call handler.
     HAPLogCharacteristicInfo(
             &logObject, request->characteristic, request->service, request->accessory, "Calling write handler.");
@@ -312,6 +315,9 @@ HAPError HAPBoolCharacteristicHandleWrite(
         return kHAPError_InvalidData;
     }
 
+    // Discard cached value. The write handler may provide the new value with HAPAccessoryServerRaiseEventWithValue.
+    HAPAccessoryServerInvalidateCachedValue(server, request->characteristic, request->service, request->accessory);
+
     // Call handler.
     HAPLogCharacteristicInfo(
             &logObject, request->characteristic, request->service, request->accessory, "Calling write handler.");
@@ -521,6 +527,9 @@ HAPError HAPUInt8CharacteristicHandleWrite(
         return kHAPError_InvalidData;
     }
 
+    // Discard cached value. The write handler may provide the new value with HAPAccessoryServerRaiseEventWithValue.
+    HAPAccessoryServerInvalidateCachedValue(server, request->characteristic, request->service, request->accessory);
+
     // Call handler.
     HAPLogCharacteristicInfo(
             &logObject, request->characteristic, request->service, request->accessory, "Calling write handler.");
@@ -677,6 +686,9 @@ HAPError HAPUInt16CharacteristicHandleWrite(
         return kHAPError_InvalidData;
     }
 
+    // Discard cached value. The write handler may provide the new value with HAPAccessoryServerRaiseEventWithValue.
+    HAPAccessoryServerInvalidateCachedValue(server, request->characteristic, request->service, request->accessory);
+
     // Call handler.
     HAPLogCharacteristicInfo(
             &logObject, request->characteristic, request->service, request->accessory, "Calling write handler.");
@@ -833,6 +845,9 @@ HAPError HAPUInt32CharacteristicHandleWrite(
         return kHAPError_InvalidData;
     }
 
+    // Discard cached value. The write handler may provide the new value with HAPAccessoryServerRaiseEventWithValue.
+    HAPAccessoryServerInvalidateCachedValue(server, request->characteristic, request->service, request->accessory);
+
     // Call handler.
     HAPLogCharacteristicInfo(
             &logObject, request->characteristic, request->service, request->accessory, "Calling write handler.");
@@ -989,6 +1004,9 @@ HAPError HAPUInt64CharacteristicHandleWrite(
         return kHAPError_InvalidData;
     }
 
+    // Discard cached value. The write handler may provide the new value with HAPAccessoryServerRaiseEventWithValue.
+    HAPAccessoryServerInvalidateCachedValue(server, request->characteristic, request->service, request->accessory);
+
     // Call handler.
     HAPLogCharacteristicInfo(
             &logObject, request->characteristic, request->service, request->accessory, "Calling write handler.");
@@ -1145,6 +1163,9 @@ HAPError HAPIntCharacteristicHandleWrite(
         return kHAPError_InvalidData;
     }
 
+    // Discard cached value. The write handler may provide the new value with HAPAccessoryServerRaiseEventWithValue.
+    HAPAccessoryServerInvalidateCachedValue(server, request->characteristic, request->service, request->accessory);
+
     // Call handler.
     HAPLogCharacteristicInfo(
             &logObject, request->characteristic, request->service, request->accessory, "Calling write handler.");
@@ -1285,7 +1306,7 @@ static bool HAPFloatCharacteristicIsValueFulfillingConstraints(
 }
 
 HAP_RESULT_USE_CHECK
-static float HAPFloatCharacteristicRoundValueToStep(const HAPFloatCharacteristic* characteristic, float value) {
+float HAPFloatCharacteristicRoundValueToStep(const HAPFloatCharacteristic* characteristic, float value) {
     if (!HAPFloatIsZero(characteristic->constraints.stepValue)) {
         value = ROUND_VALUE_TO_STEP(value, characteristic->constraints);
     }
@@ -1363,6 +1384,9 @@ HAPError HAPFloatCharacteristicHandleWrite(
     // Round to step.
     value = HAPFloatCharacteristicRoundValueToStep(request->characteristic, value);
 
+    // Discard cached value. The write handler may provide the new value with HAPAccessoryServerRaiseEventWithValue.
+    HAPAccessoryServerInvalidateCachedValue(server, request->characteristic, request->service, request->accessory);
+
     // Call handler.
     HAPLogCharacteristicInfo(
             &logObject, request->characteristic, request->service, request->accessory, "Calling write handler.");
@@ -1437,9 +1461,8 @@ static bool HAPStringCharacteristicIsValueFulfillingConstraints(
         const HAPStringCharacteristic* characteristic,
         const HAPService* service HAP_UNUSED,
         const HAPAccessory* accessory,
-        const char* value) {
-    size_t numValueBytes = HAPStringGetNumBytes(value);
-    if (!IS_LENGTH_IN_RANGE(HAPStringGetNumBytes(value), characteristic->constraints)) {
+        size_t numValueBytes) {
+    if (!IS_LENGTH_IN_RANGE(numValueBytes, characteristic->constraints)) {
         HAPLogCharacteristic(
                 &logObject,
                 characteristic,
@@ -1529,7 +1552,7 @@ HAPError HAPStringCharacteristicHandleRead(
 
     // Validate constraints.
     HAPAssert(HAPStringCharacteristicIsValueFulfillingConstraints(
-            request->characteristic, request->service, request->accessory, value));
+            request->characteristic, request->service, request->accessory, HAPStringGetNumBytes(value)));
 
     return kHAPError_None;
 }
@@ -1553,10 +1576,13 @@ HAPError HAPStringCharacteristicHandleWrite(
 
     // Validate constraints.
     if (!HAPStringCharacteristicIsValueFulfillingConstraints(
-                request->characteristic, request->service, request->accessory, value)) {
+                request->characteristic, request->service, request->accessory, HAPStringGetNumBytes(value))) {
         return kHAPError_InvalidData;
     }
 
+    // Discard cached value. The write handler may provide the new value with HAPAccessoryServerRaiseEventWithValue.
+    HAPAccessoryServerInvalidateCachedValue(server, request->characteristic, request->service, request->accessory);
+
     // Call handler.
     HAPLogCharacteristicInfo(
             &logObject, request->characteristic, request->service, request->accessory, "Calling write handler.");
@@ -1681,6 +1707,9 @@ HAPError HAPTLV8CharacteristicHandleWrite(
 
     HAPError err;
 
+    // Discard cached value. The write handler may provide the new value with HAPAccessoryServerRaiseEventWithValue.
+    HAPAccessoryServerInvalidateCachedValue(server, request->characteristic, request->service, request->accessory);
+
     // Call handler.
     HAPLogCharacteristicInfo(
             &logObject, request->characteristic, request->service, request->accessory, "Calling write handler.");
@@ -1747,3 +1776,76 @@ void HAPTLV8CharacteristicHandleUnsubscribe(
         request->characteristic->callbacks.handleUnsubscribe(server, request, context);
     }
 }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+HAP_RESULT_USE_CHECK
+bool HAPCharacteristicIsValueFulfillingConstraints(
+        const HAPCharacteristic* characteristic_,
+        const HAPService* service,
+        const HAPAccessory* accessory,
+        const void* valueBytes,
+        size_t numValueBytes) {
+    HAPPrecondition(characteristic_);
+    const HAPBaseCharacteristic* characteristic = characteristic_;
+    HAPPrecondition(service);
+    HAPPrecondition(accessory);
+    HAPPrecondition(valueBytes);
+
+    switch (characteristic->format) {
+        case kHAPCharacteristicFormat_Data: {
+            return HAPDataCharacteristicIsValueFulfillingConstraints(
+                    characteristic_, service, accessory, numValueBytes);
+        }
+        case kHAPCharacteristicFormat_Bool: {
+            HAPPrecondition(numValueBytes == sizeof(bool));
+            bool value;
+            HAPRawBufferCopyBytes(&value, valueBytes, sizeof value);
+            return HAPBoolCharacteristicIsValueFulfillingConstraints(characteristic_, service, accessory, value);
+        }
+        case kHAPCharacteristicFormat_UInt8: {
+            HAPPrecondition(numValueBytes == sizeof(uint8_t));
+            uint8_t value;
+            HAPRawBufferCopyBytes(&value, valueBytes, sizeof value);
+            return HAPUInt8CharacteristicIsValueFulfillingConstraints(characteristic_, service, accessory, value);
+        }
+        case kHAPCharacteristicFormat_UInt16: {
+            HAPPrecondition(numValueBytes == sizeof(uint16_t));
+            uint16_t value;
+            HAPRawBufferCopyBytes(&value, valueBytes, sizeof value);
+            return HAPUInt16CharacteristicIsValueFulfillingConstraints(characteristic_, service, accessory, value);
+        }
+        case kHAPCharacteristicFormat_UInt32: {
+            HAPPrecondition(numValueBytes == sizeof(uint32_t));
+            uint32_t value;
+            HAPRawBufferCopyBytes(&value, valueBytes, sizeof value);
+            return HAPUInt32CharacteristicIsValueFulfillingConstraints(characteristic_, service, accessory, value);
+        }
+        case kHAPCharacteristicFormat_UInt64: {
+            HAPPrecondition(numValueBytes == sizeof(uint64_t));
+            uint64_t value;
+            HAPRawBufferCopyBytes(&value, valueBytes, sizeof value);
+            return HAPUInt64CharacteristicIsValueFulfillingConstraints(characteristic_, service, accessory, value);
+        }
+        case kHAPCharacteristicFormat_Int: {
+            HAPPrecondition(numValueBytes == sizeof(int32_t));
+            int32_t value;
+            HAPRawBufferCopyBytes(&value, valueBytes, sizeof value);
+            return HAPIntCharacteristicIsValueFulfillingConstraints(characteristic_, service, accessory, value);
+        }
+        case kHAPCharacteristicFormat_Float: {
+            HAPPrecondition(numValueBytes == sizeof(float));
+            float value;
+            HAPRawBufferCopyBytes(&value, valueBytes, sizeof value);
+            return HAPFloatCharacteristicIsValueFulfillingConstraints(characteristic_, service, accessory, value);
+        }
+        case kHAPCharacteristicFormat_String: {
+            return HAPStringCharacteristicIsValueFulfillingConstraints(
+                    characteristic_, service, accessory, numValueBytes);
+        }
+        case kHAPCharacteristicFormat_TLV8: {
+            return true;
+        }
+    }
+    HAPFatalError();
+}
@@ -306,6 +306,42 @@ bool HAPCharacteristicReadRequiresAdminPermissions(const HAPCharacteristic* char
 HAP_RESULT_USE_CHECK
 bool HAPCharacteristicWriteRequiresAdminPermissions(const HAPCharacteristic* characteristic);
 
+/**
+ * Checks whether a characteristic value that has not been obtained through a read handler satisfies the constraints
+ * of the characteristic.
+ *
+ * - The value is encoded as for HAPAccessoryServerRaiseEventWithValue.
+ *
+ * - Float values that satisfy the constraints still need to be rounded with HAPFloatCharacteristicRoundValueToStep.
+ *
+ * @param      characteristic       Characteristic.
+ * @param      service              The service that contains the characteristic.
+ * @param      accessory            The accessory that provides the service.
+ * @param      valueBytes           Value.
+ * @param      numValueBytes        Length of value.
+ *
+ * @return true                     If the value satisfies the constraints of the characteristic.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+bool HAPCharacteristicIsValueFulfillingConstraints(
+        const HAPCharacteristic* characteristic,
+        const HAPService* service,
+        const HAPAccessory* accessory,
+        const void* valueBytes,
+        size_t numValueBytes);
+
+/**
+ * Rounds a Float characteristic value to the step value of the characteristic.
+ *
+ * @param      characteristic       Characteristic.
+ * @param      value                Value that satisfies the constraints of the characteristic.
+ *
+ * @return Value, rounded to the closest multiple of the step value relative to the minimum value.
+ */
+HAP_RESULT_USE_CHECK
+float HAPFloatCharacteristicRoundValueToStep(const HAPFloatCharacteristic* characteristic, float value);
+
 /**
  * Reads a Data characteristic value.
  *
@@ -1054,6 +1054,166 @@ error:
     return kHAPError_OutOfResources;
 }
 
+/**
+ * Converts a JSON number to the value of a characteristic write request.
+ *
+ * @param      bytes                Textual representation of the number.
+ * @param      numBytes             Length of @p bytes.
+ * @param[out] parameters           Write request parameters to update.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidData    If the number is out of range or malformed.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError ReadNumberValue(const char* bytes, size_t numBytes, HAPIPWriteRequestParameters* parameters) {
+    HAPPrecondition(bytes);
+    HAPPrecondition(parameters);
+
+    HAPError err;
+
+    char number[64];
+    if (numBytes >= sizeof number) {
+        return kHAPError_InvalidData;
+    }
+    HAPRawBufferCopyBytes(number, bytes, numBytes);
+    number[numBytes] = '\0';
+
+    bool isFloat = false;
+    for (size_t i = 0; i < numBytes; i++) {
+        if (number[i] == '.') {
+            isFloat = true;
+            break;
+        }
+    }
+    if (isFloat) {
+        float floatValue;
+        err = HAPFloatFromString(number, &floatValue);
+        if (err) {
+            HAPAssert(err == kHAPError_InvalidData);
+            return err;
+        }
+        parameters->value.floatValue = floatValue;
+        parameters->type = kHAPIPWriteValueType_Float;
+        return kHAPError_None;
+    }
+
+    int64_t intValue;
+    err = HAPInt64FromString(number, &intValue);
+    if (!err) {
+        if (intValue < 0) {
+            if (intValue < INT32_MIN) {
+                return kHAPError_InvalidData;
+            }
+            parameters->value.intValue = (int32_t) intValue;
+            parameters->type = kHAPIPWriteValueType_Int;
+        } else {
+            parameters->value.unsignedIntValue = (uint64_t) intValue;
+            parameters->type = kHAPIPWriteValueType_UInt;
+        }
+        return kHAPError_None;
+    }
+    HAPAssert(err == kHAPError_InvalidData);
+
+    uint64_t unsignedIntValue;
+    err = HAPUInt64FromString(number, &unsignedIntValue);
+    if (err) {
+        HAPAssert(err == kHAPError_InvalidData);
+        return err;
+    }
+    parameters->value.unsignedIntValue = unsignedIntValue;
+    parameters->type = kHAPIPWriteValueType_UInt;
+    return kHAPError_None;
+}
+
+/**
+ * Validates and unescapes a JSON string in place.
+ *
+ * @param      bytes                JSON string, including the enclosing quotes.
+ * @param      numBytes             Length of @p bytes.
+ * @param[out] valueBytes           Start of the unescaped string data.
+ * @param[out] numValueBytes        Length of the unescaped string data.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidData    If the string is not valid UTF-8 or contains invalid escape sequences.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError ReadStringValue(char* bytes, size_t numBytes, char* _Nullable* valueBytes, size_t* numValueBytes) {
+    HAPPrecondition(bytes);
+    HAPPrecondition(numBytes >= 2);
+    HAPPrecondition(valueBytes);
+    HAPPrecondition(numValueBytes);
+
+    *valueBytes = &bytes[1];
+    *numValueBytes = numBytes - 2;
+    if (!HAPUTF8IsValidData(&bytes[1], numBytes - 2)) {
+        return kHAPError_InvalidData;
+    }
+    return HAPJSONUtilsUnescapeStringData(&bytes[1], numValueBytes);
+}
+
+/**
+ * Appends a write context for a completely parsed characteristic write request.
+ *
+ * @param      parameters           Write request parameters.
+ * @param      writeContexts        Write contexts.
+ * @param      maxWriteContexts     Capacity of @p writeContexts.
+ * @param[in,out] numWriteContexts  Number of valid write contexts.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidData    If the accessory or characteristic instance ID is missing.
+ * @return kHAPError_OutOfResources If not enough contexts were available.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError AppendWriteContext(
+        const HAPIPWriteRequestParameters* parameters,
+        HAPIPWriteContextRef* writeContexts,
+        size_t maxWriteContexts,
+        size_t* numWriteContexts) {
+    HAPPrecondition(parameters);
+    HAPPrecondition(writeContexts);
+    HAPPrecondition(numWriteContexts);
+
+    if ((parameters->aid.isDefined) && (parameters->iid.isDefined)) {
+        if (*numWriteContexts < maxWriteContexts) {
+            HAPIPWriteContext* writeContext = (HAPIPWriteContext*) &writeContexts[*numWriteContexts];
+            HAPRawBufferZero(writeContext, sizeof *writeContext);
+            writeContext->aid = parameters->aid.value;
+            writeContext->iid = parameters->iid.value;
+            writeContext->type = parameters->type;
+            switch (parameters->type) {
+                case kHAPIPWriteValueType_None: {
+                } break;
+                case kHAPIPWriteValueType_Int: {
+                    writeContext->value.intValue = parameters->value.intValue;
+                } break;
+                case kHAPIPWriteValueType_UInt: {
+                    writeContext->value.unsignedIntValue = parameters->value.unsignedIntValue;
+                } break;
+                case kHAPIPWriteValueType_Float: {
+                    writeContext->value.floatValue = parameters->value.floatValue;
+                } break;
+                case kHAPIPWriteValueType_String: {
+                    writeContext->value.stringValue.bytes = parameters->value.stringValue.bytes;
+                    writeContext->value.stringValue.numBytes = parameters->value.stringValue.numBytes;
+                } break;
+            }
+            writeContext->ev = parameters->ev;
+            writeContext->authorizationData.bytes = parameters->authorizationData.bytes;
+            writeContext->authorizationData.numBytes = parameters->authorizationData.numBytes;
+            writeContext->remote = parameters->remote;
+            writeContext->response = parameters->response;
+            (*numWriteContexts)++;
+        } else {
+            HAPAssert(*numWriteContexts == maxWriteContexts);
+            return kHAPError_OutOfResources;
+        }
+    } else {
+        return kHAPError_InvalidData;
+    }
+    return kHAPError_None;
+}
+
+#ifdef HAP_TESTING
 HAP_RESULT_USE_CHECK
 static size_t read_characteristic_write_request_parameters(
         struct util_json_reader* r,
@@ -1062,13 +1222,8 @@ static size_t read_characteristic_write_request_parameters(
         HAPIPWriteRequestParameters* parameters,
         HAPError* err) {
     size_t i, j, k, n;
-    int frac;
     uint64_t aid, iid;
     unsigned int ev, remote;
-    float fval;
-    int64_t llval;
-    uint64_t ullval;
-    char number[64];
     unsigned int response;
 
     HAPAssert(r != NULL);
@@ -1168,56 +1323,9 @@ static size_t read_characteristic_write_request_parameters(
                 }
                 HAPAssert(i <= k);
                 HAPAssert(k <= length);
-                n = 0;
-                HAPAssert(n <= sizeof number);
-                frac = 0;
-                while ((i < k) && (n < sizeof number)) {
-                    if (!frac && (buffer[i] == '.')) {
-                        frac = 1;
-                    }
-                    number[n] = buffer[i];
-                    n++;
-                    i++;
-                }
-                if (n < sizeof number) {
-                    HAPAssert(i == k);
-                    number[n] = '\0';
-                    if (frac) {
-                        *err = HAPFloatFromString(number, &fval);
-                        if (*err) {
-                            HAPAssert(*err == kHAPError_InvalidData);
-                            goto exit;
-                        }
-                        parameters->value.floatValue = fval;
-                        parameters->type = kHAPIPWriteValueType_Float;
-                    } else {
-                        *err = HAPInt64FromString(number, &llval);
-                        if (!*err) {
-                            if (llval < 0) {
-                                if (llval >= INT32_MIN) {
-                                    parameters->value.intValue = (int32_t) llval;
-                                    parameters->type = kHAPIPWriteValueType_Int;
-                                } else {
-                                    *err = kHAPError_InvalidData;
-                                    goto exit;
-                                }
-                            } else {
-                                parameters->value.unsignedIntValue = (uint64_t) llval;
-                                parameters->type = kHAPIPWriteValueType_UInt;
-                            }
-                        } else {
-                            HAPAssert(*err == kHAPError_InvalidData);
-                            *err = HAPUInt64FromString(number, &ullval);
-                            if (*err) {
-                                HAPAssert(*err == kHAPError_InvalidData);
-                                goto exit;
-                            }
-                            parameters->value.unsignedIntValue = ullval;
-                            parameters->type = kHAPIPWriteValueType_UInt;
-                        }
-                    }
-                } else {
-                    *err = kHAPError_InvalidData;
+                *err = ReadNumberValue(&buffer[i], k - i, parameters);
+                if (*err) {
+                    HAPAssert(*err == kHAPError_InvalidData);
                     goto exit;
                 }
             } break;
@@ -1231,16 +1339,11 @@ static size_t read_characteristic_write_request_parameters(
                 }
                 HAPAssert(i <= k);
                 HAPAssert(k <= length);
-                HAPAssert(k - i >= 2);
-                parameters->value.stringValue.bytes = &buffer[i + 1];
-                parameters->value.stringValue.numBytes = k - i - 2;
-                if (!HAPUTF8IsValidData(
-                            HAPNonnull(parameters->value.stringValue.bytes), parameters->value.stringValue.numBytes)) {
-                    *err = kHAPError_InvalidData;
-                    goto exit;
-                }
-                *err = HAPJSONUtilsUnescapeStringData(
-                        HAPNonnull(parameters->value.stringValue.bytes), &parameters->value.stringValue.numBytes);
+                *err = ReadStringValue(
+                        &buffer[i],
+                        k - i,
+                        &parameters->value.stringValue.bytes,
+                        &parameters->value.stringValue.numBytes);
                 if (*err) {
                     HAPAssert(*err == kHAPError_InvalidData);
                     goto exit;
@@ -1337,16 +1440,11 @@ static size_t read_characteristic_write_request_parameters(
         }
         HAPAssert(i <= k);
         HAPAssert(k <= length);
-        HAPAssert(k - i >= 2);
-        parameters->authorizationData.bytes = &buffer[i + 1];
-        parameters->authorizationData.numBytes = k - i - 2;
-        if (!HAPUTF8IsValidData(
-                    HAPNonnull(parameters->authorizationData.bytes), parameters->authorizationData.numBytes)) {
-            *err = kHAPError_InvalidData;
-            goto exit;
-        }
-        *err = HAPJSONUtilsUnescapeStringData(
-                HAPNonnull(parameters->authorizationData.bytes), &parameters->authorizationData.numBytes);
+        *err = ReadStringValue(
+                &buffer[i],
+                k - i,
+                &parameters->authorizationData.bytes,
+                &parameters->authorizationData.numBytes);
         if (*err) {
             HAPAssert(*err == kHAPError_InvalidData);
             goto exit;
@@ -1503,43 +1601,7 @@ static size_t read_characteristic_write_request(
         *err = kHAPError_InvalidData;
         goto exit;
     }
-    if ((parameters.aid.isDefined) && (parameters.iid.isDefined)) {
-        if (*numReadContexts < max_contexts) {
-            HAPIPWriteContext* writeContext = (HAPIPWriteContext*) &contexts[*numReadContexts];
-            HAPRawBufferZero(writeContext, sizeof *writeContext);
-            writeContext->aid = parameters.aid.value;
-            writeContext->iid = parameters.iid.value;
-            writeContext->type = parameters.type;
-            switch (parameters.type) {
-                case kHAPIPWriteValueType_None: {
-                } break;
-                case kHAPIPWriteValueType_Int: {
-                    writeContext->value.intValue = parameters.value.intValue;
-                } break;
-                case kHAPIPWriteValueType_UInt: {
-                    writeContext->value.unsignedIntValue = parameters.value.unsignedIntValue;
-                } break;
-                case kHAPIPWriteValueType_Float: {
-                    writeContext->value.floatValue = parameters.value.floatValue;
-                } break;
-                case kHAPIPWriteValueType_String: {
-                    writeContext->value.stringValue.bytes = parameters.value.stringValue.bytes;
-                    writeContext->value.stringValue.numBytes = parameters.value.stringValue.numBytes;
-                } break;
-            }
-            writeContext->ev = parameters.ev;
-            writeContext->authorizationData.bytes = parameters.authorizationData.bytes;
-            writeContext->authorizationData.numBytes = parameters.authorizationData.numBytes;
-            writeContext->remote = parameters.remote;
-            writeContext->response = parameters.response;
-            (*numReadContexts)++;
-        } else {
-            HAPAssert(*numReadContexts == max_contexts);
-            *err = kHAPError_OutOfResources;
-        }
-    } else {
-        *err = kHAPError_InvalidData;
-    }
+    *err = AppendWriteContext(&parameters, contexts, max_contexts, numReadContexts);
 exit:
     HAPAssert((r->state != util_JSON_READER_STATE_ERROR) || *err);
     HAPAssert(k <= length);
@@ -1547,7 +1609,7 @@ exit:
 }
 
 HAP_RESULT_USE_CHECK
-HAPError HAPIPAccessoryProtocolGetCharacteristicWriteRequests(
+HAPError HAPIPAccessoryProtocolGetCharacteristicWriteRequestsWithJSONReader(
         char* bytes,
         size_t numBytes,
         HAPIPWriteContextRef* writeContexts,
@@ -1665,11 +1727,370 @@ HAPError HAPIPAccessoryProtocolGetCharacteristicWriteRequests(
     k += util_json_reader_read(&json_reader, &bytes[k], numBytes - k);
     if (k < numBytes) {
         return kHAPError_InvalidData;
+    }
+    HAPAssert(k == numBytes);
+    if ((json_reader.state != util_JSON_READER_STATE_COMPLETED_OBJECT) &&
+        (json_reader.state != util_JSON_READER_STATE_READING_WHITESPACE)) {
+        return kHAPError_InvalidData;
+    }
+    return kHAPError_None;
+}
+#endif
+
+/**
+ * Checks whether a JSON string token matches an object member name.
+ *
+ * @param      token                JSON string, including the enclosing quotes.
+ * @param      numTokenBytes        Length of @p token.
+ * @param      name                 Member name.
+ *
+ * @return true                     If the token matches the member name without any escape sequences.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool IsMemberName(const char* token, size_t numTokenBytes, const char* name) {
+    HAPPrecondition(token);
+    HAPPrecondition(numTokenBytes >= 2);
+    HAPPrecondition(name);
+
+    size_t numNameBytes = HAPStringGetNumBytes(name);
+    return numTokenBytes == numNameBytes + 2 && HAPRawBufferAreEqual(&token[1], name, numNameBytes);
+}
+
+/**
+ * Returns a mutable pointer to the most recently read token of a structural index.
+ *
+ * @param      bytes                Buffer that the index has been initialized with.
+ * @param      index                Structural index.
+ *
+ * @return Most recently read token.
+ */
+HAP_RESULT_USE_CHECK
+static char* GetMutableToken(char* bytes, const struct util_json_index* index) {
+    HAPPrecondition(bytes);
+    HAPPrecondition(index);
+    HAPPrecondition(index->token);
+    HAPPrecondition(index->token_length <= index->position);
+
+    return &bytes[index->position - index->token_length];
+}
+
+/**
+ * Reads a flag that may be encoded as 0, 1, false, or true.
+ *
+ * @param      index                Structural index.
+ * @param[out] value                Flag value.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidData    If the value is not a valid flag.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError ReadIndexedFlag(struct util_json_index* index, bool* value) {
+    HAPPrecondition(index);
+    HAPPrecondition(value);
+
+    util_json_index_read(index);
+    switch (index->state) {
+        case util_JSON_READER_STATE_COMPLETED_NUMBER: {
+            unsigned int flag;
+            size_t n = try_read_uint(HAPNonnull(index->token), index->token_length, &flag);
+            if ((n != index->token_length) || (flag > 1)) {
+                return kHAPError_InvalidData;
+            }
+            *value = flag == 1;
+        } break;
+        case util_JSON_READER_STATE_COMPLETED_FALSE: {
+            *value = false;
+        } break;
+        case util_JSON_READER_STATE_COMPLETED_TRUE: {
+            *value = true;
+        } break;
+        default: {
+            return kHAPError_InvalidData;
+        }
+    }
+    return kHAPError_None;
+}
+
+/**
+ * Reads a member of a characteristic write request object.
+ *
+ * @param      bytes                Buffer that the index has been initialized with.
+ * @param      index                Structural index.
+ * @param[in,out] parameters        Write request parameters to update.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidData    If the member is malformed.
+ * @return kHAPError_OutOfResources If an unknown member value is nested too deeply.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError ReadIndexedCharacteristicWriteRequestParameter(
+        char* bytes,
+        struct util_json_index* index,
+        HAPIPWriteRequestParameters* parameters) {
+    HAPPrecondition(bytes);
+    HAPPrecondition(index);
+    HAPPrecondition(parameters);
+
+    HAPError err;
+
+    util_json_index_read(index);
+    if (index->state != util_JSON_READER_STATE_COMPLETED_STRING) {
+        return kHAPError_InvalidData;
+    }
+    const char* name = HAPNonnull(index->token);
+    size_t numNameBytes = index->token_length;
+    util_json_index_read(index);
+    if (index->state != util_JSON_READER_STATE_AFTER_NAME_SEPARATOR) {
+        return kHAPError_InvalidData;
+    }
+
+    if (IsMemberName(name, numNameBytes, "aid") || IsMemberName(name, numNameBytes, "iid")) {
+        util_json_index_read(index);
+        if (index->state != util_JSON_READER_STATE_COMPLETED_NUMBER) {
+            return kHAPError_InvalidData;
+        }
+        uint64_t instanceID;
+        size_t n = try_read_uint64(HAPNonnull(index->token), index->token_length, &instanceID);
+        if (n != index->token_length) {
+            return kHAPError_InvalidData;
+        }
+        if (name[1] == 'a') {
+            parameters->aid.isDefined = true;
+            parameters->aid.value = instanceID;
+        } else {
+            parameters->iid.isDefined = true;
+            parameters->iid.value = instanceID;
+        }
+    } else if (IsMemberName(name, numNameBytes, "value")) {
+        util_json_index_read(index);
+        switch (index->state) {
+            case util_JSON_READER_STATE_COMPLETED_NUMBER: {
+                err = ReadNumberValue(HAPNonnull(index->token), index->token_length, parameters);
+                if (err) {
+                    HAPAssert(err == kHAPError_InvalidData);
+                    return err;
+                }
+            } break;
+            case util_JSON_READER_STATE_COMPLETED_STRING: {
+                err = ReadStringValue(
+                        GetMutableToken(bytes, index),
+                        index->token_length,
+                        &parameters->value.stringValue.bytes,
+                        &parameters->value.stringValue.numBytes);
+                if (err) {
+                    HAPAssert(err == kHAPError_InvalidData);
+                    return err;
+                }
+                parameters->type = kHAPIPWriteValueType_String;
+            } break;
+            case util_JSON_READER_STATE_COMPLETED_FALSE: {
+                parameters->value.unsignedIntValue = 0;
+                parameters->type = kHAPIPWriteValueType_UInt;
+            } break;
+            case util_JSON_READER_STATE_COMPLETED_TRUE: {
+                parameters->value.unsignedIntValue = 1;
+                parameters->type = kHAPIPWriteValueType_UInt;
+            } break;
+            default: {
+                return kHAPError_InvalidData;
+            }
+        }
+    } else if (IsMemberName(name, numNameBytes, "ev")) {
+        bool ev;
+        err = ReadIndexedFlag(index, &ev);
+        if (err) {
+            return err;
+        }
+        parameters->ev = ev ? kHAPIPEventNotificationState_Enabled : kHAPIPEventNotificationState_Disabled;
+    } else if (IsMemberName(name, numNameBytes, "authData")) {
+        util_json_index_read(index);
+        if (index->state != util_JSON_READER_STATE_COMPLETED_STRING) {
+            return kHAPError_InvalidData;
+        }
+        err = ReadStringValue(
+                GetMutableToken(bytes, index),
+                index->token_length,
+                &parameters->authorizationData.bytes,
+                &parameters->authorizationData.numBytes);
+        if (err) {
+            HAPAssert(err == kHAPError_InvalidData);
+            return err;
+        }
+    } else if (IsMemberName(name, numNameBytes, "remote")) {
+        err = ReadIndexedFlag(index, &parameters->remote);
+        if (err) {
+            return err;
+        }
+    } else if (IsMemberName(name, numNameBytes, "r")) {
+        err = ReadIndexedFlag(index, &parameters->response);
+        if (err) {
+            return err;
+        }
     } else {
-        HAPAssert(k == numBytes);
-        HAPAssert(
-                (json_reader.state == util_JSON_READER_STATE_COMPLETED_OBJECT) ||
-                (json_reader.state == util_JSON_READER_STATE_READING_WHITESPACE));
+        err = HAPJSONUtilsSkipIndexedValue(index);
+        if (err) {
+            HAPAssert((err == kHAPError_InvalidData) || (err == kHAPError_OutOfResources));
+            return err;
+        }
+    }
+    return kHAPError_None;
+}
+
+/**
+ * Reads a characteristic write request object.
+ *
+ * @param      bytes                Buffer that the index has been initialized with.
+ * @param      index                Structural index.
+ * @param      writeContexts        Write contexts.
+ * @param      maxWriteContexts     Capacity of @p writeContexts.
+ * @param[in,out] numWriteContexts  Number of valid write contexts.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidData    If the object is malformed.
+ * @return kHAPError_OutOfResources If not enough contexts were available or a value is nested too deeply.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError ReadIndexedCharacteristicWriteRequest(
+        char* bytes,
+        struct util_json_index* index,
+        HAPIPWriteContextRef* writeContexts,
+        size_t maxWriteContexts,
+        size_t* numWriteContexts) {
+    HAPPrecondition(bytes);
+    HAPPrecondition(index);
+    HAPPrecondition(writeContexts);
+    HAPPrecondition(numWriteContexts);
+
+    HAPError err;
+
+    HAPIPWriteRequestParameters parameters;
+    HAPRawBufferZero(&parameters, sizeof parameters);
+    util_json_index_read(index);
+    if (index->state != util_JSON_READER_STATE_BEGINNING_OBJECT) {
+        return kHAPError_InvalidData;
+    }
+    do {
+        err = ReadIndexedCharacteristicWriteRequestParameter(bytes, index, &parameters);
+        if (err) {
+            return err;
+        }
+        util_json_index_read(index);
+    } while (index->state == util_JSON_READER_STATE_AFTER_VALUE_SEPARATOR);
+    if (index->state != util_JSON_READER_STATE_COMPLETED_OBJECT) {
+        return kHAPError_InvalidData;
+    }
+    return AppendWriteContext(&parameters, writeContexts, maxWriteContexts, numWriteContexts);
+}
+
+/**
+ * Checks that only input tolerated by util_json_reader based parsing follows the top-level object.
+ *
+ * - Whitespace and at most one trailing closing brace are accepted.
+ *
+ * @param      index                Structural index after reading the end of the top-level object.
+ *
+ * @return true                     If the remaining input is acceptable.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool IsIndexedTrailerValid(struct util_json_index* index) {
+    HAPPrecondition(index);
+
+    util_json_index_read(index);
+    if (index->position != index->length) {
+        return false;
+    }
+    return (index->state == util_JSON_READER_STATE_COMPLETED_OBJECT) ||
+           (index->state == util_JSON_READER_STATE_READING_WHITESPACE);
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPIPAccessoryProtocolGetCharacteristicWriteRequests(
+        char* bytes,
+        size_t numBytes,
+        HAPIPWriteContextRef* writeContexts,
+        size_t maxWriteContexts,
+        size_t* numWriteContexts,
+        bool* hasPID,
+        uint64_t* pid) {
+    HAPPrecondition(bytes);
+    HAPPrecondition(writeContexts);
+    HAPPrecondition(numWriteContexts);
+    HAPPrecondition(hasPID);
+    HAPPrecondition(pid);
+
+    // See HomeKit Accessory Protocol Specification R14
+    // Section 6.7.2 Writing Characteristics
+    HAPError err;
+
+    struct util_json_index index;
+    util_json_index_init(&index, bytes, numBytes);
+    *numWriteContexts = 0;
+    *hasPID = false;
+    *pid = 0;
+    util_json_index_read(&index);
+    if (index.state != util_JSON_READER_STATE_BEGINNING_OBJECT) {
+        return kHAPError_InvalidData;
+    }
+    do {
+        util_json_index_read(&index);
+        if (index.state != util_JSON_READER_STATE_COMPLETED_STRING) {
+            return kHAPError_InvalidData;
+        }
+        const char* name = HAPNonnull(index.token);
+        size_t numNameBytes = index.token_length;
+        util_json_index_read(&index);
+        if (index.state != util_JSON_READER_STATE_AFTER_NAME_SEPARATOR) {
+            return kHAPError_InvalidData;
+        }
+        if (IsMemberName(name, numNameBytes, "characteristics")) {
+            util_json_index_read(&index);
+            if (index.state != util_JSON_READER_STATE_BEGINNING_ARRAY) {
+                return kHAPError_InvalidData;
+            }
+            do {
+                err = ReadIndexedCharacteristicWriteRequest(
+                        bytes, &index, writeContexts, maxWriteContexts, numWriteContexts);
+                if (err) {
+                    return err;
+                }
+                util_json_index_read(&index);
+            } while (index.state == util_JSON_READER_STATE_AFTER_VALUE_SEPARATOR);
+            if (index.state != util_JSON_READER_STATE_COMPLETED_ARRAY) {
+                return kHAPError_InvalidData;
+            }
+        } else if (IsMemberName(name, numNameBytes, "pid")) {
+            if (*hasPID) {
+                HAPLog(&logObject, "Multiple PID entries detected.");
+                return kHAPError_InvalidData;
+            }
+            util_json_index_read(&index);
+            if (index.state != util_JSON_READER_STATE_COMPLETED_NUMBER) {
+                return kHAPError_InvalidData;
+            }
+            uint64_t value;
+            size_t n = try_read_uint64(HAPNonnull(index.token), index.token_length, &value);
+            if (n != index.token_length) {
+                HAPLogBuffer(&logObject, index.token, index.token_length, "Invalid PID requested.");
+                return kHAPError_InvalidData;
+            }
+            *pid = value;
+            *hasPID = true;
+        } else {
+            err = HAPJSONUtilsSkipIndexedValue(&index);
+            if (err) {
+                HAPAssert((err == kHAPError_InvalidData) || (err == kHAPError_OutOfResources));
+                return kHAPError_InvalidData;
+            }
+        }
+        util_json_index_read(&index);
+    } while (index.state == util_JSON_READER_STATE_AFTER_VALUE_SEPARATOR);
+    if (index.state != util_JSON_READER_STATE_COMPLETED_OBJECT) {
+        return kHAPError_InvalidData;
+    }
+    if (!IsIndexedTrailerValid(&index)) {
+        return kHAPError_InvalidData;
     }
     return kHAPError_None;
 }
@@ -1992,8 +2413,9 @@ error:
     return kHAPError_OutOfResources;
 }
 
+#ifdef HAP_TESTING
 HAP_RESULT_USE_CHECK
-HAPError HAPIPAccessoryProtocolGetCharacteristicWritePreparation(
+HAPError HAPIPAccessoryProtocolGetCharacteristicWritePreparationWithJSONReader(
         const char* bytes,
         size_t numBytes,
         uint64_t* ttl,
@@ -2119,11 +2541,11 @@ HAPError HAPIPAccessoryProtocolGetCharacteristicWritePreparation(
     k += util_json_reader_read(&json_reader, &bytes[k], numBytes - k);
     if (k < numBytes) {
         goto error;
-    } else {
-        HAPAssert(k == numBytes);
-        HAPAssert(
-                (json_reader.state == util_JSON_READER_STATE_COMPLETED_OBJECT) ||
-                (json_reader.state == util_JSON_READER_STATE_READING_WHITESPACE));
+    }
+    HAPAssert(k == numBytes);
+    if ((json_reader.state != util_JSON_READER_STATE_COMPLETED_OBJECT) &&
+        (json_reader.state != util_JSON_READER_STATE_READING_WHITESPACE)) {
+        goto error;
     }
     if (!hasTTL || !hasPID) {
         HAPLog(&logObject, "TTL or PID missing in request.");
@@ -2133,3 +2555,93 @@ HAPError HAPIPAccessoryProtocolGetCharacteristicWritePreparation(
 error:
     return kHAPError_InvalidData;
 }
+#endif
+
+HAP_RESULT_USE_CHECK
+HAPError HAPIPAccessoryProtocolGetCharacteristicWritePreparation(
+        const char* bytes,
+        size_t numBytes,
+        uint64_t* ttl,
+        uint64_t* pid) {
+    HAPPrecondition(bytes);
+    HAPPrecondition(ttl);
+    HAPPrecondition(pid);
+
+    // See HomeKit Accessory Protocol Specification R14
+    // Section 6.7.2.4 Timed Write Procedures
+    HAPError err;
+
+    bool hasTTL = false;
+    bool hasPID = false;
+    struct util_json_index index;
+    util_json_index_init(&index, bytes, numBytes);
+    util_json_index_read(&index);
+    if (index.state != util_JSON_READER_STATE_BEGINNING_OBJECT) {
+        return kHAPError_InvalidData;
+    }
+    do {
+        util_json_index_read(&index);
+        if (index.state != util_JSON_READER_STATE_COMPLETED_STRING) {
+            return kHAPError_InvalidData;
+        }
+        const char* name = HAPNonnull(index.token);
+        size_t numNameBytes = index.token_length;
+        util_json_index_read(&index);
+        if (index.state != util_JSON_READER_STATE_AFTER_NAME_SEPARATOR) {
+            return kHAPError_InvalidData;
+        }
+        if (IsMemberName(name, numNameBytes, "ttl") || IsMemberName(name, numNameBytes, "pid")) {
+            bool isTTL = name[1] == 't';
+            if (isTTL ? hasTTL : hasPID) {
+                HAPLog(&logObject, "Multiple %s entries detected.", isTTL ? "TTL" : "PID");
+                return kHAPError_InvalidData;
+            }
+            util_json_index_read(&index);
+            if (index.state != util_JSON_READER_STATE_COMPLETED_NUMBER) {
+                return kHAPError_InvalidData;
+            }
+            uint64_t value;
+            size_t n = try_read_uint64(HAPNonnull(index.token), index.token_length, &value);
+            // TTL: Specified TTL in milliseconds the controller requests the accessory to securely execute a write
+            // command. Maximum value of this is 9007199254740991.
+            // PID: 64-bit unsigned integer assigned by the controller to uniquely identify the timed write
+            // transaction.
+            // See HomeKit Accessory Protocol Specification R14
+            // Table 6-3 Properties of Characteristic Objects in JSON
+            if ((n != index.token_length) || (isTTL && value > 9007199254740991)) {
+                HAPLogBuffer(
+                        &logObject,
+                        index.token,
+                        index.token_length,
+                        "Invalid %s requested.",
+                        isTTL ? "TTL" : "PID");
+                return kHAPError_InvalidData;
+            }
+            if (isTTL) {
+                *ttl = value;
+                hasTTL = true;
+            } else {
+                *pid = value;
+                hasPID = true;
+            }
+        } else {
+            err = HAPJSONUtilsSkipIndexedValue(&index);
+            if (err) {
+                HAPAssert((err == kHAPError_InvalidData) || (err == kHAPError_OutOfResources));
+                return kHAPError_InvalidData;
+            }
+        }
+        util_json_index_read(&index);
+    } while (index.state == util_JSON_READER_STATE_AFTER_VALUE_SEPARATOR);
+    if (index.state != util_JSON_READER_STATE_COMPLETED_OBJECT) {
+        return kHAPError_InvalidData;
+    }
+    if (!IsIndexedTrailerValid(&index)) {
+        return kHAPError_InvalidData;
+    }
+    if (!hasTTL || !hasPID) {
+        HAPLog(&logObject, "TTL or PID missing in request.");
+        return kHAPError_InvalidData;
+    }
+    return kHAPError_None;
+}
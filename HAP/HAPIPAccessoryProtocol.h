@@ -130,6 +130,37 @@ HAPError HAPIPAccessoryProtocolGetCharacteristicWriteRequests(
         bool* hasPID,
         uint64_t* pid);
 
+#ifdef HAP_TESTING
+/**
+ * Parses a PUT /characteristic request with the sequential util_json_reader tokenizer.
+ *
+ * - HAPIPAccessoryProtocolGetCharacteristicWriteRequests uses a structural index instead and must produce identical
+ *   results. This variant is kept as a reference to cross-check it.
+ * - Only available in builds that define HAP_TESTING.
+ *
+ * @param      bytes                Bytes
+ * @param      numBytes             Length of @p bytes.
+ * @param[out] writeContexts        Contexts to store data about the received write requests.
+ * @param      maxWriteContexts     Capacity of @p writeContexts.
+ * @param[out] numWriteContexts     Number of valid contexts.
+ * @param[out] hasPID               True if a PID was specified. False otherwise.
+ * @param[out] pid                  PID, if a PID was specified.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidData    If request malformed.
+ * @return kHAPError_OutOfResources If not enough contexts were available.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPIPAccessoryProtocolGetCharacteristicWriteRequestsWithJSONReader(
+        char* bytes,
+        size_t numBytes,
+        HAPIPWriteContextRef* writeContexts,
+        size_t maxWriteContexts,
+        size_t* numWriteContexts,
+        bool* hasPID,
+        uint64_t* pid);
+#endif
+
 HAP_RESULT_USE_CHECK
 size_t HAPIPAccessoryProtocolGetNumCharacteristicWriteResponseBytes(
         HAPAccessoryServerRef* server,
@@ -173,6 +204,30 @@ HAPError HAPIPAccessoryProtocolGetCharacteristicWritePreparation(
         size_t numBytes,
         uint64_t* ttl,
         uint64_t* pid);
+
+#ifdef HAP_TESTING
+/**
+ * Parses a PUT /prepare request with the sequential util_json_reader tokenizer.
+ *
+ * - HAPIPAccessoryProtocolGetCharacteristicWritePreparation uses a structural index instead and must produce
+ *   identical results. This variant is kept as a reference to cross-check it.
+ * - Only available in builds that define HAP_TESTING.
+ *
+ * @param      bytes                Buffer
+ * @param      numBytes             Length of @p bytes.
+ * @param[out] ttl                  TTL.
+ * @param[out] pid                  PID.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidData    If request malformed.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPIPAccessoryProtocolGetCharacteristicWritePreparationWithJSONReader(
+        const char* bytes,
+        size_t numBytes,
+        uint64_t* ttl,
+        uint64_t* pid);
+#endif
 #if __has_feature(nullability)
 #pragma clang assume_nonnull end
 #endif
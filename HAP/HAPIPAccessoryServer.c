@@ -140,6 +140,11 @@ static const HAPLogObject logObject = { .subsystem = kHAP_LogSubsystem, .categor
  */
 #define kHAPIPSession_MaxIdleTime ((HAPTime)(60 * HAPSecond))
 
+/**
+ * Minimum time a secured IP session must have been idle before it may be evicted to admit a new connection.
+ */
+#define kHAPIPSession_MinIdleTimeBeforeEviction ((HAPTime)(10 * HAPSecond))
+
 /**
  * Maximum delay during which event notifications will be coalesced into a single message.
  */
@@ -178,6 +183,318 @@ static void log_protocol_error(
             line);
 }
 
+/**
+ * Returns the IP characteristic index element at a given characteristic index.
+ *
+ * @param      server               Accessory server.
+ * @param      characteristicIndex  Characteristic index.
+ *
+ * @return IP characteristic index element.
+ */
+HAP_RESULT_USE_CHECK
+static HAPIPCharacteristicIndexElement*
+        GetCharacteristicIndexElement(const HAPAccessoryServer* server, size_t characteristicIndex) {
+    HAPPrecondition(server);
+    HAPPrecondition(server->ip.storage);
+    HAPPrecondition(characteristicIndex < server->ip.characteristicIndex.numElements);
+
+    return (HAPIPCharacteristicIndexElement*) &server->ip.storage->characteristicIndexElements[characteristicIndex];
+}
+
+/**
+ * Compares an IP characteristic index element against an accessory instance ID and characteristic instance ID.
+ *
+ * @param      element              IP characteristic index element.
+ * @param      aid                  Accessory instance ID.
+ * @param      iid                  Characteristic instance ID.
+ *
+ * @return A negative value, zero, or a positive value if the element is ordered before, equal to, or after the IDs.
+ */
+HAP_RESULT_USE_CHECK
+static int
+        CompareCharacteristicIndexElement(const HAPIPCharacteristicIndexElement* element, uint64_t aid, uint64_t iid) {
+    HAPPrecondition(element);
+
+    uint64_t elementIID = ((const HAPBaseCharacteristic*) element->characteristic)->iid;
+    if (element->accessory->aid != aid) {
+        return element->accessory->aid < aid ? -1 : 1;
+    }
+    if (elementIID != iid) {
+        return elementIID < iid ? -1 : 1;
+    }
+    return 0;
+}
+
+/**
+ * Looks up the characteristic index of a characteristic.
+ *
+ * @param      server_              Accessory server.
+ * @param      aid                  Accessory instance ID.
+ * @param      iid                  Characteristic instance ID.
+ * @param[out] characteristicIndex  Characteristic index, if found.
+ *
+ * @return true                     If the characteristic is supported over IP.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool GetCharacteristicIndex(
+        const HAPAccessoryServerRef* server_,
+        uint64_t aid,
+        uint64_t iid,
+        size_t* characteristicIndex) {
+    HAPPrecondition(server_);
+    const HAPAccessoryServer* server = (const HAPAccessoryServer*) server_;
+    HAPPrecondition(characteristicIndex);
+
+    size_t lower = 0;
+    size_t upper = server->ip.characteristicIndex.numElements;
+    while (lower < upper) {
+        size_t middle = lower + (upper - lower) / 2;
+        int result = CompareCharacteristicIndexElement(GetCharacteristicIndexElement(server, middle), aid, iid);
+        if (!result) {
+            *characteristicIndex = middle;
+            return true;
+        }
+        if (result < 0) {
+            lower = middle + 1;
+        } else {
+            upper = middle;
+        }
+    }
+    return false;
+}
+
+/**
+ * Records the duration of a characteristic callback invocation in the IP characteristic index.
+ *
+ * @param      server               Accessory server.
+ * @param      characteristic       Characteristic whose callback was invoked.
+ * @param      accessory            The accessory that provides the characteristic.
+ * @param      isWrite              Whether the handleWrite callback was invoked instead of the handleRead callback.
+ * @param      startTime            Time at which the callback was invoked.
+ */
+static void RecordCharacteristicCallback(
+        HAPAccessoryServer* server,
+        const HAPCharacteristic* characteristic,
+        const HAPAccessory* accessory,
+        bool isWrite,
+        HAPTime startTime) {
+    HAPPrecondition(server);
+    HAPPrecondition(characteristic);
+    HAPPrecondition(accessory);
+
+    size_t characteristicIndex;
+    if (!GetCharacteristicIndex(
+                (const HAPAccessoryServerRef*) server,
+                accessory->aid,
+                ((const HAPBaseCharacteristic*) characteristic)->iid,
+                &characteristicIndex)) {
+        return;
+    }
+    HAPIPCharacteristicIndexElement* element = GetCharacteristicIndexElement(server, characteristicIndex);
+    HAPCharacteristicCallbackStatistics* statistics = isWrite ? &element->writeStatistics : &element->readStatistics;
+    HAPCharacteristicCallbackStatisticsRecord(statistics, startTime);
+}
+
+/**
+ * Restores the heap property of a subtree of the IP characteristic index.
+ *
+ * @param      elements             IP characteristic index elements.
+ * @param      root                 Root of the subtree.
+ * @param      numElements          Number of elements in the heap.
+ */
+static void SiftDownCharacteristicIndexElement(
+        HAPIPCharacteristicIndexElementRef* elements,
+        size_t root,
+        size_t numElements) {
+    HAPPrecondition(elements);
+
+    for (;;) {
+        size_t largest = root;
+        for (size_t child = 2 * root + 1; child <= 2 * root + 2 && child < numElements; child++) {
+            const HAPIPCharacteristicIndexElement* element = (const HAPIPCharacteristicIndexElement*) &elements[child];
+            if (CompareCharacteristicIndexElement(
+                        (const HAPIPCharacteristicIndexElement*) &elements[largest],
+                        element->accessory->aid,
+                        ((const HAPBaseCharacteristic*) element->characteristic)->iid) < 0) {
+                largest = child;
+            }
+        }
+        if (largest == root) {
+            return;
+        }
+        HAPIPCharacteristicIndexElementRef element;
+        HAPRawBufferCopyBytes(&element, &elements[root], sizeof element);
+        HAPRawBufferCopyBytes(&elements[root], &elements[largest], sizeof elements[root]);
+        HAPRawBufferCopyBytes(&elements[largest], &element, sizeof elements[largest]);
+        root = largest;
+    }
+}
+
+/**
+ * Builds the IP characteristic index of the attribute database and lays out the event notification state
+ * of the IP sessions accordingly.
+ *
+ * - The event notification state of open IP sessions is not updated and must be rebuilt by the caller.
+ *
+ * - The IP accessory server storage must have been checked against the attribute database when the accessory server
+ *   was started or the bridged accessories were updated.
+ *
+ * @param      server_              Accessory server.
+ */
+static void BuildCharacteristicIndex(HAPAccessoryServerRef* server_) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(server->primaryAccessory);
+    HAPIPAccessoryServerStorage* storage = HAPNonnull(server->ip.storage);
+
+    // Collect characteristics that are supported over IP.
+    size_t numElements = 0;
+    for (size_t i = 0; i == 0 || (server->ip.bridgedAccessories && server->ip.bridgedAccessories[i - 1]); i++) {
+        const HAPAccessory* accessory = i == 0 ? server->primaryAccessory : server->ip.bridgedAccessories[i - 1];
+        for (size_t j = 0; accessory->services[j]; j++) {
+            const HAPService* service = accessory->services[j];
+            if (!HAPAccessoryServerSupportsService(server_, kHAPTransportType_IP, service)) {
+                continue;
+            }
+            for (size_t k = 0; service->characteristics[k]; k++) {
+                const HAPBaseCharacteristic* characteristic = service->characteristics[k];
+                if (!HAPIPCharacteristicIsSupported(characteristic)) {
+                    continue;
+                }
+                HAPAssert(numElements < storage->numCharacteristicIndexElements);
+                HAPIPCharacteristicIndexElement* element =
+                        (HAPIPCharacteristicIndexElement*) &storage->characteristicIndexElements[numElements];
+                HAPRawBufferZero(element, sizeof *element);
+                element->characteristic = characteristic;
+                element->service = service;
+                element->accessory = accessory;
+                numElements++;
+            }
+        }
+    }
+
+    server->ip.characteristicIndex.numElements = numElements;
+
+    // Sort by accessory instance ID and characteristic instance ID (heapsort).
+    // Attribute databases are usually declared in ascending order, in which case there is nothing to sort.
+    size_t numSortedElements = 1;
+    while (numSortedElements < numElements) {
+        const HAPIPCharacteristicIndexElement* element = GetCharacteristicIndexElement(server, numSortedElements);
+        if (CompareCharacteristicIndexElement(
+                    GetCharacteristicIndexElement(server, numSortedElements - 1),
+                    element->accessory->aid,
+                    ((const HAPBaseCharacteristic*) element->characteristic)->iid) >= 0) {
+            break;
+        }
+        numSortedElements++;
+    }
+    for (size_t i = numSortedElements < numElements ? numElements / 2 : 0; i > 0; i--) {
+        SiftDownCharacteristicIndexElement(storage->characteristicIndexElements, i - 1, numElements);
+    }
+    for (size_t i = numSortedElements < numElements ? numElements : 0; i > 1; i--) {
+        HAPIPCharacteristicIndexElementRef element;
+        HAPRawBufferCopyBytes(&element, &storage->characteristicIndexElements[0], sizeof element);
+        HAPRawBufferCopyBytes(
+                &storage->characteristicIndexElements[0],
+                &storage->characteristicIndexElements[i - 1],
+                sizeof storage->characteristicIndexElements[0]);
+        HAPRawBufferCopyBytes(&storage->characteristicIndexElements[i - 1], &element, sizeof element);
+        SiftDownCharacteristicIndexElement(storage->characteristicIndexElements, 0, i - 1);
+    }
+
+    // Instance IDs must be unique within an accessory. Duplicates are adjacent after sorting.
+    for (size_t i = 1; i < numElements; i++) {
+        const HAPIPCharacteristicIndexElement* element = GetCharacteristicIndexElement(server, i);
+        if (!CompareCharacteristicIndexElement(
+                    GetCharacteristicIndexElement(server, i - 1),
+                    element->accessory->aid,
+                    ((const HAPBaseCharacteristic*) element->characteristic)->iid)) {
+            HAPLogCharacteristicError(
+                    &logObject,
+                    element->characteristic,
+                    element->service,
+                    element->accessory,
+                    "Characteristic iid specified multiple times.");
+            HAPFatalError();
+        }
+    }
+
+    // Lay out event notification state: subscriptions, pending events, value digests.
+    size_t numBitSetElements = HAPIPSessionGetNumEventNotifications(numElements, 0) / 2;
+    size_t maxValueDigests = SIZE_MAX;
+    for (size_t i = 0; i < storage->numSessions; i++) {
+        HAPAssert(storage->sessions[i].numEventNotifications >= 2 * numBitSetElements);
+        maxValueDigests = HAPMin(
+                maxValueDigests,
+                (storage->sessions[i].numEventNotifications - 2 * numBitSetElements) /
+                        kHAPIPEventNotificationValueDigest_NumElements);
+    }
+    server->ip.characteristicIndex.numBitSetElements = numBitSetElements;
+
+    size_t numValueDigests = 0;
+    for (size_t i = 0; i < numElements; i++) {
+        HAPIPCharacteristicIndexElement* element = GetCharacteristicIndexElement(server, i);
+        if (!HAPIPCharacteristicSuppressesUnchangedEventNotifications(element->characteristic)) {
+            continue;
+        }
+        if (numValueDigests == maxValueDigests || numValueDigests == UINT32_MAX) {
+            HAPLogCharacteristic(
+                    &logObject,
+                    element->characteristic,
+                    element->service,
+                    element->accessory,
+                    "Not suppressing unchanged event notifications (event notification storage too small).");
+            continue;
+        }
+        element->valueDigestIndex = (uint32_t) numValueDigests;
+        element->hasValueDigest = true;
+        numValueDigests++;
+    }
+    server->ip.characteristicIndex.numValueDigests = numValueDigests;
+
+    // Lay out value cache. Values that were cached for the previous attribute database are discarded.
+    size_t numValueCacheElements = 0;
+    for (size_t i = 0; i < numElements; i++) {
+        HAPIPCharacteristicIndexElement* element = GetCharacteristicIndexElement(server, i);
+        if (!HAPIPCharacteristicIsCacheable(element->characteristic)) {
+            continue;
+        }
+        if (numValueCacheElements == storage->numValueCacheElements || numValueCacheElements == UINT32_MAX) {
+            HAPLogCharacteristic(
+                    &logObject,
+                    element->characteristic,
+                    element->service,
+                    element->accessory,
+                    "Not caching value (value cache too small).");
+            continue;
+        }
+        HAPIPCharacteristicValueCacheElement* valueCacheElement =
+                (HAPIPCharacteristicValueCacheElement*) &HAPNonnull(
+                        storage->valueCacheElements)[numValueCacheElements];
+        HAPRawBufferZero(valueCacheElement, sizeof *valueCacheElement);
+        element->valueCacheIndex = (uint32_t) numValueCacheElements;
+        element->hasValueCache = true;
+        numValueCacheElements++;
+    }
+    server->ip.characteristicIndex.numValueCacheElements = numValueCacheElements;
+
+    HAPAccessoryServerUpdateHighWaterMark(
+            &server->storageHighWaterMarks.ip.numCharacteristicIndexElements, numElements);
+    HAPAccessoryServerUpdateHighWaterMark(
+            &server->storageHighWaterMarks.ip.numEventNotifications,
+            2 * numBitSetElements + kHAPIPEventNotificationValueDigest_NumElements * numValueDigests);
+    HAPAccessoryServerUpdateHighWaterMark(
+            &server->storageHighWaterMarks.ip.numValueCacheElements, numValueCacheElements);
+
+    HAPLogDebug(
+            &logObject,
+            "Characteristic index: %lu characteristics, %lu value digests, %lu cached values.",
+            (unsigned long) numElements,
+            (unsigned long) numValueDigests,
+            (unsigned long) numValueCacheElements);
+}
+
 static void get_db_ctx(
         HAPAccessoryServerRef* server_,
         uint64_t aid,
@@ -195,47 +512,117 @@ static void get_db_ctx(
     *svc = NULL;
     *acc = NULL;
 
-    const HAPAccessory* accessory = NULL;
+    size_t characteristicIndex;
+    if (GetCharacteristicIndex(server_, aid, iid, &characteristicIndex)) {
+        const HAPIPCharacteristicIndexElement* element = GetCharacteristicIndexElement(server, characteristicIndex);
+        *chr = element->characteristic;
+        *svc = element->service;
+        *acc = element->accessory;
+    }
+}
 
-    if (server->primaryAccessory->aid == aid) {
-        accessory = server->primaryAccessory;
-    } else if (server->ip.bridgedAccessories) {
-        for (size_t i = 0; server->ip.bridgedAccessories[i]; i++) {
-            if (server->ip.bridgedAccessories[i]->aid == aid) {
-                accessory = server->ip.bridgedAccessories[i];
-                break;
-            }
-        }
+/**
+ * Returns the length of each event notification bit set of an IP session.
+ *
+ * @param      session              IP session descriptor.
+ *
+ * @return Length of each event notification bit set in bytes.
+ */
+HAP_RESULT_USE_CHECK
+static size_t GetEventNotificationBitSetNumBytes(const HAPIPSessionDescriptor* session) {
+    HAPPrecondition(session);
+    HAPPrecondition(session->server);
+    const HAPAccessoryServer* server = (const HAPAccessoryServer*) session->server;
+
+    return server->ip.characteristicIndex.numBitSetElements * sizeof(HAPIPEventNotificationRef);
+}
+
+/**
+ * Returns the bit set of characteristics that an IP session is subscribed to, addressed by characteristic index.
+ *
+ * @param      session              IP session descriptor.
+ *
+ * @return Bit set of subscribed characteristics.
+ */
+HAP_RESULT_USE_CHECK
+static uint8_t* GetSubscribedCharacteristics(const HAPIPSessionDescriptor* session) {
+    HAPPrecondition(session);
+    HAPPrecondition(session->eventNotifications);
+
+    return (uint8_t*) &session->eventNotifications[0];
+}
+
+/**
+ * Returns the bit set of characteristics with pending events on an IP session, addressed by characteristic index.
+ *
+ * @param      session              IP session descriptor.
+ *
+ * @return Bit set of characteristics with pending events.
+ */
+HAP_RESULT_USE_CHECK
+static uint8_t* GetPendingCharacteristics(const HAPIPSessionDescriptor* session) {
+    HAPPrecondition(session);
+    HAPPrecondition(session->server);
+    const HAPAccessoryServer* server = (const HAPAccessoryServer*) session->server;
+    HAPPrecondition(session->eventNotifications);
+
+    return (uint8_t*) &session->eventNotifications[server->ip.characteristicIndex.numBitSetElements];
+}
+
+/**
+ * Returns the value digest of a characteristic on an IP session.
+ *
+ * @param      session              IP session descriptor.
+ * @param      element              IP characteristic index element of the characteristic.
+ *
+ * @return Value digest, if the value digest of the characteristic is tracked. NULL otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static HAPIPEventNotificationValueDigest* _Nullable
+        GetValueDigest(const HAPIPSessionDescriptor* session, const HAPIPCharacteristicIndexElement* element) {
+    HAPPrecondition(session);
+    HAPPrecondition(session->server);
+    const HAPAccessoryServer* server = (const HAPAccessoryServer*) session->server;
+    HAPPrecondition(session->eventNotifications);
+    HAPPrecondition(element);
+
+    if (!element->hasValueDigest) {
+        return NULL;
     }
+    HAPAssert(element->valueDigestIndex < server->ip.characteristicIndex.numValueDigests);
+    return (HAPIPEventNotificationValueDigest*) &session->eventNotifications
+            [2 * server->ip.characteristicIndex.numBitSetElements +
+             kHAPIPEventNotificationValueDigest_NumElements * element->valueDigestIndex];
+}
 
-    if (accessory) {
-        size_t i = 0;
-        while (accessory->services[i] && !*chr) {
-            const HAPService* service = accessory->services[i];
-            if (HAPAccessoryServerSupportsService(server_, kHAPTransportType_IP, service)) {
-                size_t j = 0;
-                while (service->characteristics[j] && !*chr) {
-                    const HAPBaseCharacteristic* characteristic = service->characteristics[j];
-                    if (HAPIPCharacteristicIsSupported(characteristic)) {
-                        if (characteristic->iid == iid) {
-                            *chr = characteristic;
-                            *svc = service;
-                            *acc = accessory;
-                        } else {
-                            j++;
-                        }
-                    } else {
-                        j++;
-                    }
-                }
-                if (!*chr) {
-                    i++;
-                }
-            } else {
-                i++;
-            }
-        }
+/**
+ * Returns the cached value of a characteristic.
+ *
+ * @param      server               Accessory server.
+ * @param      aid                  Accessory instance ID.
+ * @param      iid                  Characteristic instance ID.
+ *
+ * @return Value cache element, if the value of the characteristic is cached. NULL otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static HAPIPCharacteristicValueCacheElement* _Nullable
+        GetValueCacheElement(const HAPAccessoryServer* server, uint64_t aid, uint64_t iid) {
+    HAPPrecondition(server);
+
+    if (!server->ip.characteristicIndex.numValueCacheElements) {
+        return NULL;
+    }
+    size_t characteristicIndex;
+    if (!GetCharacteristicIndex((const HAPAccessoryServerRef*) server, aid, iid, &characteristicIndex)) {
+        return NULL;
+    }
+    const HAPIPCharacteristicIndexElement* element = GetCharacteristicIndexElement(server, characteristicIndex);
+    if (!element->hasValueCache) {
+        return NULL;
     }
+    HAPAssert(element->valueCacheIndex < server->ip.characteristicIndex.numValueCacheElements);
+    return (HAPIPCharacteristicValueCacheElement*) &HAPNonnull(
+            HAPNonnull(server->ip.storage)->valueCacheElements)[element->valueCacheIndex];
 }
 
 static void publish_homeKit_service(HAPAccessoryServerRef* server_) {
@@ -263,11 +650,188 @@ static void HAPIPSessionDestroy(HAPIPSession* ipSession) {
 
     HAPLogDebug(&logObject, "session:%p:releasing session", (const void*) session);
 
+    HAPAccessoryServer* server = (HAPAccessoryServer*) session->server;
     HAPRawBufferZero(&ipSession->descriptor, sizeof ipSession->descriptor);
     HAPRawBufferZero(ipSession->inboundBuffer.bytes, ipSession->inboundBuffer.numBytes);
     HAPRawBufferZero(ipSession->outboundBuffer.bytes, ipSession->outboundBuffer.numBytes);
     HAPRawBufferZero(
             ipSession->eventNotifications, ipSession->numEventNotifications * sizeof *ipSession->eventNotifications);
+
+    // Return session to the free list.
+    session->nextActiveSession = server->ip.freeSessions;
+    server->ip.freeSessions = ipSession;
+}
+
+/**
+ * Takes a free IP session from the free list.
+ *
+ * @param      server_              Accessory server.
+ *
+ * @return Free IP session, if available. NULL otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static HAPIPSession* _Nullable TakeFreeSession(HAPAccessoryServerRef* server_) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+
+    HAPIPSession* _Nullable ipSession = server->ip.freeSessions;
+    if (!ipSession) {
+        return NULL;
+    }
+    HAPIPSessionDescriptor* session = (HAPIPSessionDescriptor*) &HAPNonnull(ipSession)->descriptor;
+    HAPAssert(!session->server);
+    server->ip.freeSessions = session->nextActiveSession;
+    session->nextActiveSession = NULL;
+    return ipSession;
+}
+
+/**
+ * Returns whether an open IP session has completed Pair Verify.
+ *
+ * @param      session              IP session descriptor.
+ *
+ * @return true                     If the session is secured.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool IsSessionSecured(const HAPIPSessionDescriptor* session) {
+    HAPPrecondition(session);
+
+    // The isSecured flag is only set once the first request after Pair Verify has been received.
+    return session->securitySession.isSecured || (session->securitySession.type == kHAPIPSecuritySessionType_HAP &&
+                                                  HAPSessionIsSecured(&session->securitySession._.hap));
+}
+
+/**
+ * Returns the session activity list that an open IP session belongs to.
+ *
+ * - Whether a session is filed as secured is tracked separately from its security session, so that a session is
+ *   always removed from the list it has been inserted into. See UpdateSessionActivityList.
+ *
+ * @param      ipSession            IP session.
+ *
+ * @return Session activity list of the IP session.
+ */
+HAP_RESULT_USE_CHECK
+static HAPIPSessionActivityList* GetSessionActivityList(HAPIPSession* ipSession) {
+    HAPPrecondition(ipSession);
+    HAPIPSessionDescriptor* session = (HAPIPSessionDescriptor*) &ipSession->descriptor;
+    HAPPrecondition(session->server);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) session->server;
+
+    if (session->numEventNotifications) {
+        return &server->ip.subscribedSessions;
+    }
+    return session->isFiledAsSecured ? &server->ip.unsubscribedSessions : &server->ip.unsecuredSessions;
+}
+
+/**
+ * Inserts an open IP session into its session activity list, ordered by time of last activity.
+ *
+ * - Sessions that have just been active are appended in constant time. Sessions that move between lists without
+ *   being active (e.g., when their last subscription ends) are inserted behind all sessions that were active later.
+ *
+ * @param      ipSession            IP session.
+ */
+static void InsertSessionIntoActivityList(HAPIPSession* ipSession) {
+    HAPPrecondition(ipSession);
+    HAPIPSessionDescriptor* session = (HAPIPSessionDescriptor*) &ipSession->descriptor;
+    HAPIPSessionActivityList* list = GetSessionActivityList(ipSession);
+    HAPPrecondition(!session->prevActiveSession);
+    HAPPrecondition(!session->nextActiveSession);
+    HAPPrecondition(list->head != ipSession);
+
+    HAPIPSession* _Nullable prevSession = list->tail;
+    while (prevSession && ((HAPIPSessionDescriptor*) &HAPNonnull(prevSession)->descriptor)->stamp > session->stamp) {
+        prevSession = ((HAPIPSessionDescriptor*) &HAPNonnull(prevSession)->descriptor)->prevActiveSession;
+    }
+
+    if (prevSession) {
+        HAPIPSessionDescriptor* prev = (HAPIPSessionDescriptor*) &HAPNonnull(prevSession)->descriptor;
+        session->nextActiveSession = prev->nextActiveSession;
+        prev->nextActiveSession = ipSession;
+        session->prevActiveSession = prevSession;
+    } else {
+        session->nextActiveSession = list->head;
+        list->head = ipSession;
+    }
+    if (session->nextActiveSession) {
+        HAPIPSessionDescriptor* next = (HAPIPSessionDescriptor*) &HAPNonnull(session->nextActiveSession)->descriptor;
+        HAPAssert(next->prevActiveSession == prevSession);
+        next->prevActiveSession = ipSession;
+    } else {
+        HAPAssert(list->tail == prevSession);
+        list->tail = ipSession;
+    }
+}
+
+/**
+ * Removes an open IP session from its session activity list.
+ *
+ * @param      ipSession            IP session.
+ */
+static void RemoveSessionFromActivityList(HAPIPSession* ipSession) {
+    HAPPrecondition(ipSession);
+    HAPIPSessionDescriptor* session = (HAPIPSessionDescriptor*) &ipSession->descriptor;
+    HAPIPSessionActivityList* list = GetSessionActivityList(ipSession);
+
+    if (session->prevActiveSession) {
+        ((HAPIPSessionDescriptor*) &HAPNonnull(session->prevActiveSession)->descriptor)->nextActiveSession =
+                session->nextActiveSession;
+    } else {
+        HAPAssert(list->head == ipSession);
+        list->head = session->nextActiveSession;
+    }
+    if (session->nextActiveSession) {
+        ((HAPIPSessionDescriptor*) &HAPNonnull(session->nextActiveSession)->descriptor)->prevActiveSession =
+                session->prevActiveSession;
+    } else {
+        HAPAssert(list->tail == ipSession);
+        list->tail = session->prevActiveSession;
+    }
+    session->prevActiveSession = NULL;
+    session->nextActiveSession = NULL;
+}
+
+/**
+ * Moves an open IP session to the session activity list that matches its current security state.
+ *
+ * @param      ipSession            IP session.
+ */
+static void UpdateSessionActivityList(HAPIPSession* ipSession) {
+    HAPPrecondition(ipSession);
+    HAPIPSessionDescriptor* session = (HAPIPSessionDescriptor*) &ipSession->descriptor;
+
+    bool isSecured = IsSessionSecured(session);
+    if (session->isFiledAsSecured != isSecured) {
+        RemoveSessionFromActivityList(ipSession);
+        session->isFiledAsSecured = isSecured;
+        InsertSessionIntoActivityList(ipSession);
+    }
+}
+
+/**
+ * Records activity on an open IP session.
+ *
+ * @param      session              IP session descriptor.
+ * @param      clock_now_ms         Current time.
+ */
+static void TouchSession(HAPIPSessionDescriptor* session, HAPTime clock_now_ms) {
+    HAPPrecondition(session);
+    HAPPrecondition(session->server);
+    HAPPrecondition(session->state != kHAPIPSessionState_Idle);
+    HAPIPSession* ipSession = (HAPIPSession*) session;
+    HAPAssert(&ipSession->descriptor == (HAPIPSessionDescriptorRef*) session);
+
+    HAPAssert(clock_now_ms >= session->stamp);
+    session->stamp = clock_now_ms;
+    if (session->nextActiveSession) {
+        RemoveSessionFromActivityList(ipSession);
+        session->isFiledAsSecured = IsSessionSecured(session);
+        InsertSessionIntoActivityList(ipSession);
+    } else {
+        UpdateSessionActivityList(ipSession);
+    }
 }
 
 static void collect_garbage(HAPAccessoryServerRef* server_) {
@@ -389,29 +953,44 @@ static void schedule_max_idle_time_timer(HAPAccessoryServerRef* server_) {
         HAPPlatformTCPStreamManagerCloseListener(HAPNonnull(server->platform.ip.tcpStreamManager));
     }
 
-    for (size_t i = 0; i < server->ip.storage->numSessions; i++) {
-        HAPIPSession* ipSession = &server->ip.storage->sessions[i];
-        HAPIPSessionDescriptor* session = (HAPIPSessionDescriptor*) &ipSession->descriptor;
-        if (!session->server) {
-            continue;
+    if (server->ip.state == kHAPIPAccessoryServerState_Stopping) {
+        for (size_t i = 0; i < server->ip.storage->numSessions; i++) {
+            HAPIPSession* ipSession = &server->ip.storage->sessions[i];
+            HAPIPSessionDescriptor* session = (HAPIPSessionDescriptor*) &ipSession->descriptor;
+            if (!session->server) {
+                continue;
+            }
+
+            if ((session->state == kHAPIPSessionState_Reading) && (session->inboundBuffer.position == 0)) {
+                CloseSession(session);
+            }
         }
+    }
 
-        if ((session->state == kHAPIPSessionState_Reading) && (session->inboundBuffer.position == 0) &&
-            (server->ip.state == kHAPIPAccessoryServerState_Stopping)) {
-            CloseSession(session);
-        } else if (
-                ((session->state == kHAPIPSessionState_Reading) || (session->state == kHAPIPSessionState_Writing)) &&
-                ((server->ip.numSessions == server->ip.storage->numSessions) ||
-                 (server->ip.state == kHAPIPAccessoryServerState_Stopping))) {
-            HAPAssert(clock_now_ms >= session->stamp);
-            HAPTime dt_ms = clock_now_ms - session->stamp;
-            if (dt_ms < kHAPIPSession_MaxIdleTime) {
-                HAPAssert(kHAPIPSession_MaxIdleTime <= INT64_MAX);
-                int64_t t_ms = (int64_t)(kHAPIPSession_MaxIdleTime - dt_ms);
-                if ((timeout_ms == -1) || (t_ms < timeout_ms)) {
-                    timeout_ms = t_ms;
+    if ((server->ip.numSessions == server->ip.storage->numSessions) ||
+        (server->ip.state == kHAPIPAccessoryServerState_Stopping)) {
+        // Session activity lists are ordered by time of last activity.
+        // Only the least recently active sessions need to be checked.
+        HAPIPSessionActivityList* lists[] = { &server->ip.unsecuredSessions,
+                                              &server->ip.unsubscribedSessions,
+                                              &server->ip.subscribedSessions };
+        for (size_t i = 0; i < HAPArrayCount(lists); i++) {
+            while (lists[i]->head) {
+                HAPIPSessionDescriptor* session = (HAPIPSessionDescriptor*) &HAPNonnull(lists[i]->head)->descriptor;
+                HAPAssert(
+                        (session->state == kHAPIPSessionState_Reading) ||
+                        (session->state == kHAPIPSessionState_Writing) ||
+                        (session->state == kHAPIPSessionState_Waiting));
+                HAPAssert(clock_now_ms >= session->stamp);
+                HAPTime dt_ms = clock_now_ms - session->stamp;
+                if (dt_ms < kHAPIPSession_MaxIdleTime) {
+                    HAPAssert(kHAPIPSession_MaxIdleTime <= INT64_MAX);
+                    int64_t t_ms = (int64_t)(kHAPIPSession_MaxIdleTime - dt_ms);
+                    if ((timeout_ms == -1) || (t_ms < timeout_ms)) {
+                        timeout_ms = t_ms;
+                    }
+                    break;
                 }
-            } else {
                 HAPLogInfo(&logObject, "Connection timeout.");
                 CloseSession(session);
             }
@@ -454,6 +1033,8 @@ static void RegisterSession(HAPIPSessionDescriptor* session) {
     HAPPrecondition(server->ip.numSessions < server->ip.storage->numSessions);
 
     server->ip.numSessions++;
+    HAPAccessoryServerUpdateHighWaterMark(&server->storageHighWaterMarks.ip.numSessions, server->ip.numSessions);
+    InsertSessionIntoActivityList((HAPIPSession*) session);
     if (server->ip.numSessions == server->ip.storage->numSessions) {
         schedule_max_idle_time_timer(session->server);
     }
@@ -476,20 +1057,33 @@ static void CloseSession(HAPIPSessionDescriptor* session) {
 
     HAPLogDebug(&logObject, "session:%p:closing", (const void*) session);
 
+    RemoveSessionFromActivityList((HAPIPSession*) session);
+    size_t characteristicIndex = 0;
     while (session->numEventNotifications) {
-        HAPIPEventNotification* eventNotification =
-                (HAPIPEventNotification*) &session->eventNotifications[session->numEventNotifications - 1];
-        const HAPCharacteristic* characteristic;
-        const HAPService* service;
-        const HAPAccessory* accessory;
-        get_db_ctx(
-                session->server, eventNotification->aid, eventNotification->iid, &characteristic, &service, &accessory);
-        if (eventNotification->flag) {
+        bool found = HAPBitSetFindNext(
+                GetSubscribedCharacteristics(session),
+                GetEventNotificationBitSetNumBytes(session),
+                &characteristicIndex);
+        HAPAssert(found);
+        const HAPIPCharacteristicIndexElement* element = GetCharacteristicIndexElement(server, characteristicIndex);
+        HAPBitSetRemoveBit(
+                GetSubscribedCharacteristics(session),
+                GetEventNotificationBitSetNumBytes(session),
+                characteristicIndex);
+        if (HAPBitSetContainsBit(
+                    GetPendingCharacteristics(session),
+                    GetEventNotificationBitSetNumBytes(session),
+                    characteristicIndex)) {
+            HAPBitSetRemoveBit(
+                    GetPendingCharacteristics(session),
+                    GetEventNotificationBitSetNumBytes(session),
+                    characteristicIndex);
             HAPAssert(session->numEventNotificationFlags);
             session->numEventNotificationFlags--;
         }
         session->numEventNotifications--;
-        handle_characteristic_unsubscribe_request(session, characteristic, service, accessory);
+        handle_characteristic_unsubscribe_request(
+                session, element->characteristic, element->service, element->accessory);
     }
     if (session->securitySession.isOpen) {
         HAPLogDebug(&logObject, "session:%p:closing security context", (const void*) session);
@@ -803,6 +1397,39 @@ static void handle_characteristic_unsubscribe_request(
     HAPAccessoryServerHandleUnsubscribe(HAPNonnull(session->server), &session->securitySession._.hap, chr, svc, acc);
 }
 
+/**
+ * Ends the event notification subscription of an IP session for a characteristic.
+ *
+ * @param      session              IP session descriptor.
+ * @param      characteristicIndex  Characteristic index of a characteristic that the IP session is subscribed to.
+ */
+static void EndSubscription(HAPIPSessionDescriptor* session, size_t characteristicIndex) {
+    HAPPrecondition(session);
+    HAPPrecondition(session->server);
+    HAPPrecondition(session->numEventNotifications);
+
+    uint8_t* subscribedCharacteristics = GetSubscribedCharacteristics(session);
+    size_t numBitSetBytes = GetEventNotificationBitSetNumBytes(session);
+    HAPPrecondition(HAPBitSetContainsBit(subscribedCharacteristics, numBitSetBytes, characteristicIndex));
+    HAPBitSetRemoveBit(subscribedCharacteristics, numBitSetBytes, characteristicIndex);
+    if (session->numEventNotifications == 1) {
+        RemoveSessionFromActivityList((HAPIPSession*) session);
+        session->numEventNotifications--;
+        InsertSessionIntoActivityList((HAPIPSession*) session);
+    } else {
+        session->numEventNotifications--;
+    }
+    uint8_t* pendingCharacteristics = GetPendingCharacteristics(session);
+    if (HAPBitSetContainsBit(pendingCharacteristics, numBitSetBytes, characteristicIndex)) {
+        HAPBitSetRemoveBit(pendingCharacteristics, numBitSetBytes, characteristicIndex);
+        HAPAssert(session->numEventNotificationFlags > 0);
+        session->numEventNotificationFlags--;
+    }
+    const HAPIPCharacteristicIndexElement* element =
+            GetCharacteristicIndexElement((const HAPAccessoryServer*) session->server, characteristicIndex);
+    handle_characteristic_unsubscribe_request(session, element->characteristic, element->service, element->accessory);
+}
+
 static void handle_characteristic_read_request(
         HAPIPSessionDescriptor* session,
         const HAPCharacteristic* chr,
@@ -888,45 +1515,31 @@ static void handle_characteristic_write_request(
             writeContext->status = kHAPIPAccessoryServerStatusCode_NotificationNotSupported;
         } else {
             writeContext->status = kHAPIPAccessoryServerStatusCode_Success;
-            HAPAssert(session->numEventNotifications <= session->maxEventNotifications);
-            size_t i = 0;
-            while ((i < session->numEventNotifications) &&
-                   ((((HAPIPEventNotification*) &session->eventNotifications[i])->aid != writeContext->aid) ||
-                    (((HAPIPEventNotification*) &session->eventNotifications[i])->iid != writeContext->iid))) {
-                i++;
-            }
-            HAPAssert(
-                    (i == session->numEventNotifications) ||
-                    ((i < session->numEventNotifications) &&
-                     (((HAPIPEventNotification*) &session->eventNotifications[i])->aid == writeContext->aid) &&
-                     (((HAPIPEventNotification*) &session->eventNotifications[i])->iid == writeContext->iid)));
-            if (i == session->numEventNotifications) {
-                if (writeContext->ev == kHAPIPEventNotificationState_Enabled) {
-                    if (i == session->maxEventNotifications) {
-                        writeContext->status = kHAPIPAccessoryServerStatusCode_OutOfResources;
-                    } else {
-                        ((HAPIPEventNotification*) &session->eventNotifications[i])->aid = writeContext->aid;
-                        ((HAPIPEventNotification*) &session->eventNotifications[i])->iid = writeContext->iid;
-                        ((HAPIPEventNotification*) &session->eventNotifications[i])->flag = false;
-                        session->numEventNotifications++;
-                        handle_characteristic_subscribe_request(session, characteristic, service, accessory);
-                    }
-                }
-            } else if (writeContext->ev == kHAPIPEventNotificationState_Disabled) {
-                session->numEventNotifications--;
-                if (((HAPIPEventNotification*) &session->eventNotifications[i])->flag) {
-                    HAPAssert(session->numEventNotificationFlags > 0);
-                    session->numEventNotificationFlags--;
+            size_t characteristicIndex;
+            bool found = GetCharacteristicIndex(
+                    HAPNonnull(session->server), writeContext->aid, writeContext->iid, &characteristicIndex);
+            HAPAssert(found);
+            uint8_t* subscribedCharacteristics = GetSubscribedCharacteristics(session);
+            size_t numBitSetBytes = GetEventNotificationBitSetNumBytes(session);
+            bool isSubscribed = HAPBitSetContainsBit(subscribedCharacteristics, numBitSetBytes, characteristicIndex);
+            if (!isSubscribed && writeContext->ev == kHAPIPEventNotificationState_Enabled) {
+                HAPBitSetInsertBit(subscribedCharacteristics, numBitSetBytes, characteristicIndex);
+                const HAPIPCharacteristicIndexElement* element =
+                        GetCharacteristicIndexElement((const HAPAccessoryServer*) session->server, characteristicIndex);
+                HAPIPEventNotificationValueDigest* _Nullable valueDigest = GetValueDigest(session, element);
+                if (valueDigest) {
+                    valueDigest->isValid = false;
                 }
-                while (i < session->numEventNotifications) {
-                    HAPRawBufferCopyBytes(
-                            &session->eventNotifications[i],
-                            &session->eventNotifications[i + 1],
-                            sizeof session->eventNotifications[i]);
-                    i++;
+                if (!session->numEventNotifications) {
+                    RemoveSessionFromActivityList((HAPIPSession*) session);
+                    session->numEventNotifications++;
+                    InsertSessionIntoActivityList((HAPIPSession*) session);
+                } else {
+                    session->numEventNotifications++;
                 }
-                HAPAssert(i == session->numEventNotifications);
-                handle_characteristic_unsubscribe_request(session, characteristic, service, accessory);
+                handle_characteristic_subscribe_request(session, characteristic, service, accessory);
+            } else if (isSubscribed && writeContext->ev == kHAPIPEventNotificationState_Disabled) {
+                EndSubscription(session, characteristicIndex);
             }
         }
     }
@@ -962,6 +1575,7 @@ static void handle_characteristic_write_request(
                 }
             }
             if (writeContext->status == kHAPIPAccessoryServerStatusCode_Success) {
+                HAPTime startTime = HAPPlatformClockGetCurrent();
                 switch (baseCharacteristic->format) {
                     case kHAPCharacteristicFormat_Data: {
                         if (writeContext->type == kHAPIPWriteValueType_String) {
@@ -1193,6 +1807,8 @@ static void handle_characteristic_write_request(
                     case kHAPCharacteristicFormat_TLV8: {
                         if (writeContext->type == kHAPIPWriteValueType_String) {
                             HAPAssert(writeContext->value.stringValue.bytes);
+                            // Memory that is freed up by decoding in place is made available as scratch memory.
+                            size_t numEncodedBytes = writeContext->value.stringValue.numBytes;
                             int r = util_base64_decode(
                                     writeContext->value.stringValue.bytes,
                                     writeContext->value.stringValue.numBytes,
@@ -1201,10 +1817,12 @@ static void handle_characteristic_write_request(
                                     &writeContext->value.stringValue.numBytes);
                             if (r == 0) {
                                 HAPTLVReaderRef tlvReader;
-                                HAPTLVReaderCreate(
+                                HAPTLVReaderCreateWithOptions(
                                         &tlvReader,
-                                        writeContext->value.stringValue.bytes,
-                                        writeContext->value.stringValue.numBytes);
+                                        &(const HAPTLVReaderOptions) {
+                                                .bytes = writeContext->value.stringValue.bytes,
+                                                .numBytes = writeContext->value.stringValue.numBytes,
+                                                .maxBytes = numEncodedBytes });
                                 err = HAPTLV8CharacteristicHandleWrite(
                                         HAPNonnull(session->server),
                                         &(const HAPTLV8CharacteristicWriteRequest) {
@@ -1225,6 +1843,12 @@ static void handle_characteristic_write_request(
                         }
                     } break;
                 }
+                RecordCharacteristicCallback(
+                        (HAPAccessoryServer*) session->server,
+                        characteristic,
+                        accessory,
+                        /* isWrite: */ true,
+                        startTime);
                 if (writeContext->status == kHAPIPAccessoryServerStatusCode_Success) {
                     if (baseCharacteristic->properties.ip.supportsWriteResponse) {
                         HAPIPByteBuffer dataBufferSnapshot;
@@ -1400,6 +2024,9 @@ static void put_characteristics(HAPIPSessionDescriptor* session) {
                 &contexts_count,
                 &pid_valid,
                 &pid);
+        if (!err || err == kHAPError_OutOfResources) {
+            HAPAccessoryServerUpdateHighWaterMark(&server->storageHighWaterMarks.ip.numWriteContexts, contexts_count);
+        }
         if (!err) {
             if ((session->timedWriteExpirationTime && pid_valid &&
                  session->timedWriteExpirationTime < HAPPlatformClockGetCurrent()) ||
@@ -1428,6 +2055,8 @@ static void put_characteristics(HAPIPSessionDescriptor* session) {
                 HAPAssert(data_buffer.limit <= data_buffer.capacity);
                 r = handle_characteristic_write_requests(
                         session, server->ip.storage->writeContexts, contexts_count, &data_buffer, pid_valid);
+                HAPAccessoryServerUpdateHighWaterMark(
+                        &server->storageHighWaterMarks.ip.numScratchBufferBytes, data_buffer.position);
                 if (r == 0) {
                     write_msg(&session->outboundBuffer, kHAPIPAccessoryServerResponse_NoContent);
                 } else {
@@ -1486,6 +2115,110 @@ static int32_t ConvertCharacteristicReadErrorToStatusCode(HAPError error) {
     HAPFatalError();
 }
 
+/**
+ * Serves a characteristic read request from the value cache.
+ *
+ * @param      characteristic       Characteristic.
+ * @param      cachedValue          Cached value of the characteristic.
+ * @param[out] readContext          Read context.
+ * @param      dataBuffer           Buffer for string and data values.
+ */
+static void ReadCachedValue(
+        const HAPBaseCharacteristic* characteristic,
+        const HAPIPCharacteristicValueCacheElement* cachedValue,
+        HAPIPReadContext* readContext,
+        HAPIPByteBuffer* dataBuffer) {
+    HAPPrecondition(characteristic);
+    HAPPrecondition(cachedValue);
+    HAPPrecondition(cachedValue->isValid);
+    HAPPrecondition(readContext);
+    HAPPrecondition(dataBuffer);
+    HAPPrecondition(dataBuffer->position <= dataBuffer->limit);
+
+    readContext->status = kHAPIPAccessoryServerStatusCode_Success;
+    switch (characteristic->format) {
+        case kHAPCharacteristicFormat_Bool:
+        case kHAPCharacteristicFormat_UInt8:
+        case kHAPCharacteristicFormat_UInt16:
+        case kHAPCharacteristicFormat_UInt32:
+        case kHAPCharacteristicFormat_UInt64: {
+            readContext->value.unsignedIntValue = cachedValue->value.unsignedIntValue;
+        } break;
+        case kHAPCharacteristicFormat_Int: {
+            readContext->value.intValue = cachedValue->value.intValue;
+        } break;
+        case kHAPCharacteristicFormat_Float: {
+            readContext->value.floatValue = cachedValue->value.floatValue;
+        } break;
+        case kHAPCharacteristicFormat_Data:
+        case kHAPCharacteristicFormat_String: {
+            if (cachedValue->numBytes >= dataBuffer->limit - dataBuffer->position) {
+                readContext->status = kHAPIPAccessoryServerStatusCode_OutOfResources;
+                break;
+            }
+            char* bytes = &dataBuffer->data[dataBuffer->position];
+            HAPRawBufferCopyBytes(bytes, cachedValue->bytes, cachedValue->numBytes);
+            bytes[cachedValue->numBytes] = '\0';
+            readContext->value.stringValue.bytes = bytes;
+            readContext->value.stringValue.numBytes = cachedValue->numBytes;
+            dataBuffer->position += cachedValue->numBytes + 1;
+        } break;
+        case kHAPCharacteristicFormat_TLV8: {
+            HAPFatalError();
+        }
+    }
+}
+
+/**
+ * Stores the value of a successful characteristic read request in the value cache.
+ *
+ * - String and data values that are too long are not cached.
+ *
+ * @param      characteristic       Characteristic.
+ * @param[out] cachedValue          Cached value of the characteristic.
+ * @param      readContext          Read context.
+ */
+static void WriteCachedValue(
+        const HAPBaseCharacteristic* characteristic,
+        HAPIPCharacteristicValueCacheElement* cachedValue,
+        const HAPIPReadContext* readContext) {
+    HAPPrecondition(characteristic);
+    HAPPrecondition(cachedValue);
+    HAPPrecondition(readContext);
+    HAPPrecondition(readContext->status == kHAPIPAccessoryServerStatusCode_Success);
+
+    switch (characteristic->format) {
+        case kHAPCharacteristicFormat_Bool:
+        case kHAPCharacteristicFormat_UInt8:
+        case kHAPCharacteristicFormat_UInt16:
+        case kHAPCharacteristicFormat_UInt32:
+        case kHAPCharacteristicFormat_UInt64: {
+            cachedValue->value.unsignedIntValue = readContext->value.unsignedIntValue;
+        } break;
+        case kHAPCharacteristicFormat_Int: {
+            cachedValue->value.intValue = readContext->value.intValue;
+        } break;
+        case kHAPCharacteristicFormat_Float: {
+            cachedValue->value.floatValue = readContext->value.floatValue;
+        } break;
+        case kHAPCharacteristicFormat_Data:
+        case kHAPCharacteristicFormat_String: {
+            if (readContext->value.stringValue.numBytes > sizeof cachedValue->bytes) {
+                return;
+            }
+            HAPRawBufferCopyBytes(
+                    cachedValue->bytes,
+                    HAPNonnull(readContext->value.stringValue.bytes),
+                    readContext->value.stringValue.numBytes);
+            cachedValue->numBytes = (uint8_t) readContext->value.stringValue.numBytes;
+        } break;
+        case kHAPCharacteristicFormat_TLV8: {
+            HAPFatalError();
+        }
+    }
+    cachedValue->isValid = true;
+}
+
 static void handle_characteristic_read_request(
         HAPIPSessionDescriptor* session,
         const HAPCharacteristic* chr_,
@@ -1521,7 +2254,14 @@ static void handle_characteristic_read_request(
     HAPAssert(data_buffer->position <= data_buffer->limit);
     HAPAssert(data_buffer->limit <= data_buffer->capacity);
     HAPIPReadContext* readContext = (HAPIPReadContext*) ctx;
+    HAPIPCharacteristicValueCacheElement* _Nullable cachedValue =
+            GetValueCacheElement((const HAPAccessoryServer*) session->server, acc->aid, chr->iid);
+    if (cachedValue && cachedValue->isValid) {
+        ReadCachedValue(chr, HAPNonnull(cachedValue), readContext, data_buffer);
+        return;
+    }
     readContext->status = kHAPIPAccessoryServerStatusCode_Success;
+    HAPTime startTime = HAPPlatformClockGetCurrent();
     switch (chr->format) {
         case kHAPCharacteristicFormat_Data: {
             err = HAPDataCharacteristicHandleRead(
@@ -1731,6 +2471,10 @@ static void handle_characteristic_read_request(
             }
         } break;
     }
+    RecordCharacteristicCallback((HAPAccessoryServer*) session->server, chr_, acc, /* isWrite: */ false, startTime);
+    if (cachedValue && readContext->status == kHAPIPAccessoryServerStatusCode_Success) {
+        WriteCachedValue(chr, HAPNonnull(cachedValue), readContext);
+    }
 }
 
 HAP_RESULT_USE_CHECK
@@ -1748,7 +2492,7 @@ static int handle_characteristic_read_requests(
     HAPPrecondition(!HAPSessionIsTransient(&session->securitySession._.hap));
 
     int r;
-    size_t i, j;
+    size_t i;
     const HAPCharacteristic* c;
     const HAPService* svc;
     const HAPAccessory* acc;
@@ -1761,19 +2505,14 @@ static int handle_characteristic_read_requests(
         if (c) {
             const HAPBaseCharacteristic* chr = c;
             HAPAssert(chr->iid == readContext->iid);
-            HAPAssert(session->numEventNotifications <= session->maxEventNotifications);
-            j = 0;
-            while ((j < session->numEventNotifications) &&
-                   ((((HAPIPEventNotification*) &session->eventNotifications[j])->aid != readContext->aid) ||
-                    (((HAPIPEventNotification*) &session->eventNotifications[j])->iid != readContext->iid))) {
-                j++;
-            }
-            HAPAssert(
-                    (j == session->numEventNotifications) ||
-                    ((j < session->numEventNotifications) &&
-                     (((HAPIPEventNotification*) &session->eventNotifications[j])->aid == readContext->aid) &&
-                     (((HAPIPEventNotification*) &session->eventNotifications[j])->iid == readContext->iid)));
-            readContext->ev = j < session->numEventNotifications;
+            size_t characteristicIndex;
+            bool found = GetCharacteristicIndex(
+                    HAPNonnull(session->server), readContext->aid, readContext->iid, &characteristicIndex);
+            HAPAssert(found);
+            readContext->ev = HAPBitSetContainsBit(
+                    GetSubscribedCharacteristics(session),
+                    GetEventNotificationBitSetNumBytes(session),
+                    characteristicIndex);
             if (!HAPCharacteristicReadRequiresAdminPermissions(chr) ||
                 HAPSessionControllerIsAdmin(&session->securitySession._.hap)) {
                 if (chr->properties.readable) {
@@ -1835,6 +2574,9 @@ static void get_characteristics(HAPIPSessionDescriptor* session) {
                 server->ip.storage->numReadContexts,
                 &contexts_count,
                 &parameters);
+        if (!err || err == kHAPError_OutOfResources) {
+            HAPAccessoryServerUpdateHighWaterMark(&server->storageHighWaterMarks.ip.numReadContexts, contexts_count);
+        }
         if (!err) {
             if (contexts_count == 0) {
                 write_msg(&session->outboundBuffer, kHAPIPAccessoryServerResponse_NoContent);
@@ -1852,6 +2594,8 @@ static void get_characteristics(HAPIPSessionDescriptor* session) {
                         server->ip.storage->readContexts,
                         contexts_count,
                         &data_buffer);
+                HAPAccessoryServerUpdateHighWaterMark(
+                        &server->storageHighWaterMarks.ip.numScratchBufferBytes, data_buffer.position);
                 content_length = HAPIPAccessoryProtocolGetNumCharacteristicReadResponseBytes(
                         HAPNonnull(session->server), server->ip.storage->readContexts, contexts_count, &parameters);
                 HAPAssert(session->outboundBuffer.data);
@@ -2093,6 +2837,108 @@ static void get_accessories(HAPIPSessionDescriptor* session) {
     handle_accessory_serialization(session);
 }
 
+/**
+ * Serializes the response of a pairing endpoint into the outbound buffer.
+ *
+ * @param      session              IP session descriptor.
+ * @param      read_hap_pairing_data Function that serializes the response.
+ * @param      pairing_status       Whether the accessory was paired before the request was processed.
+ *
+ * @return true                     If the response has been written.
+ * @return false                    If the response is deferred.
+ */
+HAP_RESULT_USE_CHECK
+static bool write_pairing_response(
+        HAPIPSessionDescriptor* session,
+        HAPError (*read_hap_pairing_data)(
+                HAPAccessoryServerRef* p_acc,
+                HAPSessionRef* p_sess,
+                HAPTLVWriterRef* p_writer),
+        bool pairing_status) {
+    HAPPrecondition(session);
+    HAPPrecondition(session->server);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) session->server;
+    HAPPrecondition(session->securitySession.type == kHAPIPSecuritySessionType_HAP);
+    HAPPrecondition(session->securitySession.isOpen);
+    HAPPrecondition(read_hap_pairing_data);
+
+    HAPError err;
+
+    int r;
+    uint8_t* p_tlv8_buffer;
+    size_t tlv8_length, mark;
+    HAPTLVWriterRef tlv8_writer;
+
+    HAPTLVWriterCreate(
+            &tlv8_writer, server->ip.storage->scratchBuffer.bytes, server->ip.storage->scratchBuffer.numBytes);
+    r = read_hap_pairing_data(HAPNonnull(session->server), &session->securitySession._.hap, &tlv8_writer);
+    if (r == kHAPError_Busy) {
+        return false;
+    }
+    if (r == 0) {
+        HAPTLVWriterGetBuffer(&tlv8_writer, (void*) &p_tlv8_buffer, &tlv8_length);
+        HAPAccessoryServerUpdateHighWaterMark(&server->storageHighWaterMarks.ip.numScratchBufferBytes, tlv8_length);
+        if (HAPAccessoryServerIsPaired(HAPNonnull(session->server)) != pairing_status) {
+            HAPIPServiceDiscoveryInvalidateHAPServiceStatusFlags(HAPNonnull(session->server));
+            HAPIPServiceDiscoverySetHAPService(HAPNonnull(session->server));
+        }
+        HAPAssert(session->outboundBuffer.data);
+        HAPAssert(session->outboundBuffer.position <= session->outboundBuffer.limit);
+        HAPAssert(session->outboundBuffer.limit <= session->outboundBuffer.capacity);
+        mark = session->outboundBuffer.position;
+        HAP_DIAGNOSTIC_IGNORED_ICCARM(Pa084)
+        if (tlv8_length <= UINT32_MAX) {
+            err = HAPIPByteBufferAppendStringWithFormat(
+                    &session->outboundBuffer,
+                    "HTTP/1.1 200 OK\r\n"
+                    "Content-Type: application/pairing+tlv8\r\n"
+                    "Content-Length: %lu\r\n\r\n",
+                    (unsigned long) tlv8_length);
+            HAPAssert(!err);
+            if (tlv8_length <= session->outboundBuffer.limit - session->outboundBuffer.position) {
+                HAPRawBufferCopyBytes(
+                        &session->outboundBuffer.data[session->outboundBuffer.position], p_tlv8_buffer, tlv8_length);
+                session->outboundBuffer.position += tlv8_length;
+                for (size_t i = 0; i < server->ip.storage->numSessions; i++) {
+                    HAPIPSession* ipSession = &server->ip.storage->sessions[i];
+                    HAPIPSessionDescriptor* t = (HAPIPSessionDescriptor*) &ipSession->descriptor;
+                    if (!t->server) {
+                        continue;
+                    }
+
+                    // Other sessions whose pairing has been removed during the pairing session
+                    // need to be closed as soon as possible.
+                    if (t != session && t->state == kHAPIPSessionState_Reading &&
+                        t->securitySession.type == kHAPIPSecuritySessionType_HAP && t->securitySession.isSecured &&
+                        !HAPSessionIsSecured(&t->securitySession._.hap)) {
+                        HAPLogInfo(&logObject, "Closing other session whose pairing has been removed.");
+                        CloseSession(t);
+                    }
+                }
+            } else {
+                HAPLog(&logObject, "Invalid configuration (outbound buffer too small).");
+                session->outboundBuffer.position = mark;
+                write_msg(&session->outboundBuffer, kHAPIPAccessoryServerResponse_InternalServerError);
+            }
+            HAP_DIAGNOSTIC_RESTORE_ICCARM(Pa084)
+        } else {
+            HAPLog(&logObject, "Content length exceeding UINT32_MAX.");
+            session->outboundBuffer.position = mark;
+            write_msg(&session->outboundBuffer, kHAPIPAccessoryServerResponse_OutOfResources);
+        }
+    } else {
+        log_result(
+                kHAPLogType_Error,
+                "error:Function 'read_hap_pairing_data' failed.",
+                r,
+                __func__,
+                HAP_FILE,
+                __LINE__);
+        write_msg(&session->outboundBuffer, kHAPIPAccessoryServerResponse_InternalServerError);
+    }
+    return true;
+}
+
 static void handle_pairing_data(
         HAPIPSessionDescriptor* session,
         HAPError (*write_hap_pairing_data)(
@@ -2109,15 +2955,10 @@ static void handle_pairing_data(
     HAPPrecondition(session->securitySession.type == kHAPIPSecuritySessionType_HAP);
     HAPPrecondition(session->securitySession.isOpen);
 
-    HAPError err;
-
     int r;
     bool pairing_status;
-    uint8_t* p_tlv8_buffer;
-    size_t tlv8_length, mark;
     HAPTLVReaderOptions tlv8_reader_init;
     HAPTLVReaderRef tlv8_reader;
-    HAPTLVWriterRef tlv8_writer;
 
     char* scratchBuffer = server->ip.storage->scratchBuffer.bytes;
     size_t maxScratchBufferBytes = server->ip.storage->scratchBuffer.numBytes;
@@ -2132,6 +2973,8 @@ static void handle_pairing_data(
     if (session->httpContentLength.isDefined) {
         HAPAssert(session->httpContentLength.value <= session->inboundBuffer.position - session->httpReaderPosition);
         if (session->httpContentLength.value <= maxScratchBufferBytes) {
+            HAPAccessoryServerUpdateHighWaterMark(
+                    &server->storageHighWaterMarks.ip.numScratchBufferBytes, session->httpContentLength.value);
             HAPRawBufferCopyBytes(
                     scratchBuffer,
                     &session->inboundBuffer.data[session->httpReaderPosition],
@@ -2142,68 +2985,9 @@ static void handle_pairing_data(
             HAPTLVReaderCreateWithOptions(&tlv8_reader, &tlv8_reader_init);
             r = write_hap_pairing_data(HAPNonnull(session->server), &session->securitySession._.hap, &tlv8_reader);
             if (r == 0) {
-                HAPTLVWriterCreate(&tlv8_writer, scratchBuffer, maxScratchBufferBytes);
-                r = read_hap_pairing_data(HAPNonnull(session->server), &session->securitySession._.hap, &tlv8_writer);
-                if (r == 0) {
-                    HAPTLVWriterGetBuffer(&tlv8_writer, (void*) &p_tlv8_buffer, &tlv8_length);
-                    if (HAPAccessoryServerIsPaired(HAPNonnull(session->server)) != pairing_status) {
-                        HAPIPServiceDiscoverySetHAPService(HAPNonnull(session->server));
-                    }
-                    HAPAssert(session->outboundBuffer.data);
-                    HAPAssert(session->outboundBuffer.position <= session->outboundBuffer.limit);
-                    HAPAssert(session->outboundBuffer.limit <= session->outboundBuffer.capacity);
-                    mark = session->outboundBuffer.position;
-                    HAP_DIAGNOSTIC_IGNORED_ICCARM(Pa084)
-                    if (tlv8_length <= UINT32_MAX) {
-                        err = HAPIPByteBufferAppendStringWithFormat(
-                                &session->outboundBuffer,
-                                "HTTP/1.1 200 OK\r\n"
-                                "Content-Type: application/pairing+tlv8\r\n"
-                                "Content-Length: %lu\r\n\r\n",
-                                (unsigned long) tlv8_length);
-                        HAPAssert(!err);
-                        if (tlv8_length <= session->outboundBuffer.limit - session->outboundBuffer.position) {
-                            HAPRawBufferCopyBytes(
-                                    &session->outboundBuffer.data[session->outboundBuffer.position],
-                                    p_tlv8_buffer,
-                                    tlv8_length);
-                            session->outboundBuffer.position += tlv8_length;
-                            for (size_t i = 0; i < server->ip.storage->numSessions; i++) {
-                                HAPIPSession* ipSession = &server->ip.storage->sessions[i];
-                                HAPIPSessionDescriptor* t = (HAPIPSessionDescriptor*) &ipSession->descriptor;
-                                if (!t->server) {
-                                    continue;
-                                }
-
-                                // Other sessions whose pairing has been removed during the pairing session
-                                // need to be closed as soon as possible.
-                                if (t != session && t->state == kHAPIPSessionState_Reading &&
-                                    t->securitySession.type == kHAPIPSecuritySessionType_HAP &&
-                                    t->securitySession.isSecured && !HAPSessionIsSecured(&t->securitySession._.hap)) {
-                                    HAPLogInfo(&logObject, "Closing other session whose pairing has been removed.");
-                                    CloseSession(t);
-                                }
-                            }
-                        } else {
-                            HAPLog(&logObject, "Invalid configuration (outbound buffer too small).");
-                            session->outboundBuffer.position = mark;
-                            write_msg(&session->outboundBuffer, kHAPIPAccessoryServerResponse_InternalServerError);
-                        }
-                        HAP_DIAGNOSTIC_RESTORE_ICCARM(Pa084)
-                    } else {
-                        HAPLog(&logObject, "Content length exceeding UINT32_MAX.");
-                        session->outboundBuffer.position = mark;
-                        write_msg(&session->outboundBuffer, kHAPIPAccessoryServerResponse_OutOfResources);
-                    }
-                } else {
-                    log_result(
-                            kHAPLogType_Error,
-                            "error:Function 'read_hap_pairing_data' failed.",
-                            r,
-                            __func__,
-                            HAP_FILE,
-                            __LINE__);
-                    write_msg(&session->outboundBuffer, kHAPIPAccessoryServerResponse_InternalServerError);
+                if (!write_pairing_response(session, read_hap_pairing_data, pairing_status)) {
+                    // The response is written once the pairing procedure continues. See HAPSessionContinueIPPairSetup.
+                    session->state = kHAPIPSessionState_Waiting;
                 }
             } else {
                 write_msg(&session->outboundBuffer, kHAPIPAccessoryServerResponse_BadRequest);
@@ -2378,6 +3162,8 @@ static void handle_secure_message(HAPIPSessionDescriptor* session) {
                 goto SendResponse;
             }
             HAPTLVWriterGetBuffer(&writer, &responseBodyBytes, &numResponseBodyBytes);
+            HAPAccessoryServerUpdateHighWaterMark(
+                    &server->storageHighWaterMarks.ip.numScratchBufferBytes, numResponseBodyBytes);
             status = kHAPBLEPDUStatus_Success;
         }
             goto SendResponse;
@@ -2435,6 +3221,8 @@ static void handle_secure_message(HAPIPSessionDescriptor* session) {
                 goto SendResponse;
             }
             HAPTLVWriterGetBuffer(&writer, &responseBodyBytes, &numResponseBodyBytes);
+            HAPAccessoryServerUpdateHighWaterMark(
+                    &server->storageHighWaterMarks.ip.numScratchBufferBytes, numResponseBodyBytes);
             status = kHAPBLEPDUStatus_Success;
         }
             goto SendResponse;
@@ -2561,12 +3349,15 @@ static void identify_primary_accessory(HAPIPSessionDescriptor* session) {
 static void handle_http_request(HAPIPSessionDescriptor* session) {
     HAPPrecondition(session);
     HAPPrecondition(session->server);
-    HAPAccessoryServer* server = (HAPAccessoryServer*) session->server;
+    HAPAccessoryServerRef* server_ = HAPNonnull(session->server);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
     HAPPrecondition(session->securitySession.isOpen);
 
     HAPAssert(session->httpReader.state == util_HTTP_READER_STATE_DONE);
     HAPAssert(!session->httpParserError);
 
+    HAPTime startTime = HAPPlatformClockGetCurrent();
+
     {
         HAPPrecondition(session->securitySession.type == kHAPIPSecuritySessionType_HAP);
 
@@ -2607,6 +3398,7 @@ static void handle_http_request(HAPIPSessionDescriptor* session) {
 
                     // Handle message.
                     handle_pairing_data(session, HAPSessionHandlePairSetupWrite, HAPSessionHandlePairSetupRead);
+                    HAPAccessoryServerRecordRequest(server_, kHAPAccessoryServerRequestType_PairSetup, startTime);
                 } else {
                     HAPLog(&logObject, "Rejected POST /pair-setup: Only non-secure access is supported.");
                     write_msg(&session->outboundBuffer, kHAPIPAccessoryServerResponse_BadRequest);
@@ -2621,6 +3413,7 @@ static void handle_http_request(HAPIPSessionDescriptor* session) {
                 HAPRawBufferAreEqual(HAPNonnull(session->httpMethod.bytes), "POST", 4)) {
                 if (!session->securitySession.isSecured) {
                     handle_pairing_data(session, HAPSessionHandlePairVerifyWrite, HAPSessionHandlePairVerifyRead);
+                    HAPAccessoryServerRecordRequest(server_, kHAPAccessoryServerRequestType_PairVerify, startTime);
                 } else {
                     HAPLog(&logObject, "Rejected POST /pair-verify: Only non-secure access is supported.");
                     write_msg(&session->outboundBuffer, kHAPIPAccessoryServerResponse_BadRequest);
@@ -2636,6 +3429,7 @@ static void handle_http_request(HAPIPSessionDescriptor* session) {
                 if (session->securitySession.isSecured || kHAPIPAccessoryServer_SessionSecurityDisabled) {
                     if (!HAPSessionIsTransient(&session->securitySession._.hap)) {
                         handle_pairing_data(session, HAPSessionHandlePairingsWrite, HAPSessionHandlePairingsRead);
+                        HAPAccessoryServerRecordRequest(server_, kHAPAccessoryServerRequestType_Pairings, startTime);
                     } else {
                         HAPLog(&logObject, "Rejected POST /pairings: Session is transient.");
                         write_msg(&session->outboundBuffer, kHAPIPAccessoryServerResponse_BadRequest);
@@ -2718,6 +3512,8 @@ static void handle_http_request(HAPIPSessionDescriptor* session) {
                 if (session->securitySession.isSecured || kHAPIPAccessoryServer_SessionSecurityDisabled) {
                     if (!HAPSessionIsTransient(&session->securitySession._.hap)) {
                         get_accessories(session);
+                        HAPAccessoryServerRecordRequest(
+                                server_, kHAPAccessoryServerRequestType_GetAccessories, startTime);
                     } else {
                         HAPLog(&logObject, "Rejected GET /accessories: Session is transient.");
                         write_msg(&session->outboundBuffer, kHAPIPAccessoryServerResponse_BadRequest);
@@ -2747,6 +3543,8 @@ static void handle_http_request(HAPIPSessionDescriptor* session) {
                 if (session->securitySession.isSecured || kHAPIPAccessoryServer_SessionSecurityDisabled) {
                     if (!HAPSessionIsTransient(&session->securitySession._.hap)) {
                         get_characteristics(session);
+                        HAPAccessoryServerRecordRequest(
+                                server_, kHAPAccessoryServerRequestType_GetCharacteristics, startTime);
                     } else {
                         HAPLog(&logObject, "Rejected GET /characteristics: Session is transient.");
                         write_msg(&session->outboundBuffer, kHAPIPAccessoryServerResponse_BadRequest);
@@ -2762,6 +3560,8 @@ static void handle_http_request(HAPIPSessionDescriptor* session) {
                 if (session->securitySession.isSecured || kHAPIPAccessoryServer_SessionSecurityDisabled) {
                     if (!HAPSessionIsTransient(&session->securitySession._.hap)) {
                         put_characteristics(session);
+                        HAPAccessoryServerRecordRequest(
+                                server_, kHAPAccessoryServerRequestType_PutCharacteristics, startTime);
                     } else {
                         HAPLog(&logObject, "Rejected PUT /characteristics: Session is transient.");
                         write_msg(&session->outboundBuffer, kHAPIPAccessoryServerResponse_BadRequest);
@@ -2791,6 +3591,7 @@ static void handle_http_request(HAPIPSessionDescriptor* session) {
                 if (session->securitySession.isSecured || kHAPIPAccessoryServer_SessionSecurityDisabled) {
                     if (!HAPSessionIsTransient(&session->securitySession._.hap)) {
                         put_prepare(session);
+                        HAPAccessoryServerRecordRequest(server_, kHAPAccessoryServerRequestType_Prepare, startTime);
                     } else {
                         HAPLog(&logObject, "Rejected PUT /prepare: Session is transient.");
                         write_msg(&session->outboundBuffer, kHAPIPAccessoryServerResponse_BadRequest);
@@ -2857,12 +3658,53 @@ static void handle_http_request(HAPIPSessionDescriptor* session) {
     }
 }
 
+/**
+ * Prepares the session for writing the response in the outbound buffer. The response is encrypted if necessary.
+ *
+ * @param      session              IP session descriptor.
+ */
+static void prepare_writing_response(HAPIPSessionDescriptor* session) {
+    HAPPrecondition(session);
+    HAPPrecondition(session->server);
+
+    size_t encrypted_length;
+
+    HAPAssert(session->outboundBuffer.data);
+    HAPAssert(session->outboundBuffer.position <= session->outboundBuffer.limit);
+    HAPAssert(session->outboundBuffer.limit <= session->outboundBuffer.capacity);
+    HAPIPByteBufferFlip(&session->outboundBuffer);
+    HAPLogBufferDebug(
+            &logObject,
+            session->outboundBuffer.data,
+            session->outboundBuffer.limit,
+            "session:%p:<",
+            (const void*) session);
+
+    if (session->securitySession.type == kHAPIPSecuritySessionType_HAP && session->securitySession.isSecured) {
+        encrypted_length = HAPIPSecurityProtocolGetNumEncryptedBytes(
+                session->outboundBuffer.limit - session->outboundBuffer.position);
+        if (encrypted_length > session->outboundBuffer.capacity - session->outboundBuffer.position) {
+            HAPLog(&logObject, "Out of resources (outbound buffer too small).");
+            session->outboundBuffer.limit = session->outboundBuffer.capacity;
+            write_msg(&session->outboundBuffer, kHAPIPAccessoryServerResponse_OutOfResources);
+            HAPIPByteBufferFlip(&session->outboundBuffer);
+            encrypted_length = HAPIPSecurityProtocolGetNumEncryptedBytes(
+                    session->outboundBuffer.limit - session->outboundBuffer.position);
+            HAPAssert(encrypted_length <= session->outboundBuffer.capacity - session->outboundBuffer.position);
+        }
+        HAPIPSecurityProtocolEncryptData(
+                HAPNonnull(session->server), &session->securitySession._.hap, &session->outboundBuffer);
+        HAPAssert(encrypted_length == session->outboundBuffer.limit - session->outboundBuffer.position);
+    }
+    session->state = kHAPIPSessionState_Writing;
+}
+
 static void handle_http(HAPIPSessionDescriptor* session) {
     HAPPrecondition(session);
     HAPPrecondition(session->server);
     HAPPrecondition(session->securitySession.isOpen);
 
-    size_t content_length, encrypted_length;
+    size_t content_length;
     HAPAssert(session->inboundBuffer.data);
     HAPAssert(session->inboundBuffer.position <= session->inboundBuffer.limit);
     HAPAssert(session->inboundBuffer.limit <= session->inboundBuffer.capacity);
@@ -2890,35 +3732,11 @@ static void handle_http(HAPIPSessionDescriptor* session) {
             HAPAssert(session->outboundBuffer.position <= session->outboundBuffer.limit);
             HAPAssert(session->outboundBuffer.limit <= session->outboundBuffer.capacity);
             HAPAssert(session->state == kHAPIPSessionState_Writing);
+        } else if (session->state == kHAPIPSessionState_Waiting) {
+            // Response is deferred.
+            HAPAssert(session->outboundBuffer.position == 0);
         } else {
-            HAPAssert(session->outboundBuffer.data);
-            HAPAssert(session->outboundBuffer.position <= session->outboundBuffer.limit);
-            HAPAssert(session->outboundBuffer.limit <= session->outboundBuffer.capacity);
-            HAPIPByteBufferFlip(&session->outboundBuffer);
-            HAPLogBufferDebug(
-                    &logObject,
-                    session->outboundBuffer.data,
-                    session->outboundBuffer.limit,
-                    "session:%p:<",
-                    (const void*) session);
-
-            if (session->securitySession.type == kHAPIPSecuritySessionType_HAP && session->securitySession.isSecured) {
-                encrypted_length = HAPIPSecurityProtocolGetNumEncryptedBytes(
-                        session->outboundBuffer.limit - session->outboundBuffer.position);
-                if (encrypted_length > session->outboundBuffer.capacity - session->outboundBuffer.position) {
-                    HAPLog(&logObject, "Out of resources (outbound buffer too small).");
-                    session->outboundBuffer.limit = session->outboundBuffer.capacity;
-                    write_msg(&session->outboundBuffer, kHAPIPAccessoryServerResponse_OutOfResources);
-                    HAPIPByteBufferFlip(&session->outboundBuffer);
-                    encrypted_length = HAPIPSecurityProtocolGetNumEncryptedBytes(
-                            session->outboundBuffer.limit - session->outboundBuffer.position);
-                    HAPAssert(encrypted_length <= session->outboundBuffer.capacity - session->outboundBuffer.position);
-                }
-                HAPIPSecurityProtocolEncryptData(
-                        HAPNonnull(session->server), &session->securitySession._.hap, &session->outboundBuffer);
-                HAPAssert(encrypted_length == session->outboundBuffer.limit - session->outboundBuffer.position);
-            }
-            session->state = kHAPIPSessionState_Writing;
+            prepare_writing_response(session);
         }
     }
 }
@@ -3072,6 +3890,72 @@ static void read_http_content_type(HAPIPSessionDescriptor* session) {
     }
 }
 
+/**
+ * HTTP header fields that are interpreted by the accessory server.
+ */
+HAP_ENUM_BEGIN(uint8_t, HAPIPHTTPHeaderField) {
+    kHAPIPHTTPHeaderField_Unknown,
+    kHAPIPHTTPHeaderField_ContentLength,
+    kHAPIPHTTPHeaderField_ContentType
+} HAP_ENUM_END(uint8_t, HAPIPHTTPHeaderField);
+
+/**
+ * Perfect hash table of the HTTP header fields that are interpreted by the accessory server.
+ *
+ * - Names are stored in lowercase.
+ *
+ * - Slots are indexed by GetHTTPHeaderFieldHash. The hash function must remain collision free when names are added.
+ */
+static const struct {
+    const char* _Nullable name;
+    HAPIPHTTPHeaderField field;
+} kHTTPHeaderFields[8] = {
+    [1] = { .name = "content-type", .field = kHAPIPHTTPHeaderField_ContentType },
+    [6] = { .name = "content-length", .field = kHAPIPHTTPHeaderField_ContentLength },
+};
+
+/**
+ * Hashes an HTTP header field name into a slot of kHTTPHeaderFields.
+ *
+ * The hash combines the length of the name with its last character and is case insensitive.
+ */
+HAP_RESULT_USE_CHECK
+static size_t GetHTTPHeaderFieldHash(const char* bytes, size_t numBytes) {
+    HAPPrecondition(bytes);
+    HAPPrecondition(numBytes);
+
+    return (numBytes ^ (uint8_t)(bytes[numBytes - 1] | 0x20)) % HAPArrayCount(kHTTPHeaderFields);
+}
+
+/**
+ * Identifies an HTTP header field by its name.
+ *
+ * @param      bytes                Header field name. Must only contain token characters.
+ * @param      numBytes             Length of header field name.
+ *
+ * @return Header field, or kHAPIPHTTPHeaderField_Unknown if the header field is not interpreted.
+ */
+HAP_RESULT_USE_CHECK
+static HAPIPHTTPHeaderField GetHTTPHeaderField(const char* bytes, size_t numBytes) {
+    HAPPrecondition(bytes);
+
+    if (!numBytes) {
+        return kHAPIPHTTPHeaderField_Unknown;
+    }
+    size_t slot = GetHTTPHeaderFieldHash(bytes, numBytes);
+    const char* _Nullable name = kHTTPHeaderFields[slot].name;
+    if (!name || HAPStringGetNumBytes(HAPNonnull(name)) != numBytes) {
+        return kHAPIPHTTPHeaderField_Unknown;
+    }
+    for (size_t i = 0; i < numBytes; i++) {
+        // Token characters only fold onto lowercase letters when they are uppercase letters.
+        if ((char) (bytes[i] | 0x20) != name[i]) {
+            return kHAPIPHTTPHeaderField_Unknown;
+        }
+    }
+    return kHTTPHeaderFields[slot].field;
+}
+
 static void read_http(HAPIPSessionDescriptor* session) {
     HAPPrecondition(session);
     HAPPrecondition(session->server);
@@ -3110,60 +3994,28 @@ static void read_http(HAPIPSessionDescriptor* session) {
             case util_HTTP_READER_STATE_COMPLETED_HEADER_VALUE: {
                 update_token(r, &session->httpHeaderFieldValue.bytes, &session->httpHeaderFieldValue.numBytes);
                 HAPAssert(session->httpHeaderFieldName.bytes);
-                if ((session->httpHeaderFieldName.numBytes == 14) &&
-                    (session->httpHeaderFieldName.bytes[0] == 'C' || session->httpHeaderFieldName.bytes[0] == 'c') &&
-                    (session->httpHeaderFieldName.bytes[1] == 'O' || session->httpHeaderFieldName.bytes[1] == 'o') &&
-                    (session->httpHeaderFieldName.bytes[2] == 'N' || session->httpHeaderFieldName.bytes[2] == 'n') &&
-                    (session->httpHeaderFieldName.bytes[3] == 'T' || session->httpHeaderFieldName.bytes[3] == 't') &&
-                    (session->httpHeaderFieldName.bytes[4] == 'E' || session->httpHeaderFieldName.bytes[4] == 'e') &&
-                    (session->httpHeaderFieldName.bytes[5] == 'N' || session->httpHeaderFieldName.bytes[5] == 'n') &&
-                    (session->httpHeaderFieldName.bytes[6] == 'T' || session->httpHeaderFieldName.bytes[6] == 't') &&
-                    (session->httpHeaderFieldName.bytes[7] == '-') &&
-                    (session->httpHeaderFieldName.bytes[8] == 'L' || session->httpHeaderFieldName.bytes[8] == 'l') &&
-                    (session->httpHeaderFieldName.bytes[9] == 'E' || session->httpHeaderFieldName.bytes[9] == 'e') &&
-                    (session->httpHeaderFieldName.bytes[10] == 'N' || session->httpHeaderFieldName.bytes[10] == 'n') &&
-                    (session->httpHeaderFieldName.bytes[11] == 'G' || session->httpHeaderFieldName.bytes[11] == 'g') &&
-                    (session->httpHeaderFieldName.bytes[12] == 'T' || session->httpHeaderFieldName.bytes[12] == 't') &&
-                    (session->httpHeaderFieldName.bytes[13] == 'H' || session->httpHeaderFieldName.bytes[13] == 'h')) {
-                    if (hasContentLength) {
-                        HAPLog(&logObject, "Request has multiple Content-Length headers.");
-                        session->httpParserError = true;
-                    } else {
-                        hasContentLength = true;
-                        read_http_content_length(session);
-                    }
-                } else if (
-                        (session->httpHeaderFieldName.numBytes == 12) &&
-                        (session->httpHeaderFieldName.bytes[0] == 'C' ||
-                         session->httpHeaderFieldName.bytes[0] == 'c') &&
-                        (session->httpHeaderFieldName.bytes[1] == 'O' ||
-                         session->httpHeaderFieldName.bytes[1] == 'o') &&
-                        (session->httpHeaderFieldName.bytes[2] == 'N' ||
-                         session->httpHeaderFieldName.bytes[2] == 'n') &&
-                        (session->httpHeaderFieldName.bytes[3] == 'T' ||
-                         session->httpHeaderFieldName.bytes[3] == 't') &&
-                        (session->httpHeaderFieldName.bytes[4] == 'E' ||
-                         session->httpHeaderFieldName.bytes[4] == 'e') &&
-                        (session->httpHeaderFieldName.bytes[5] == 'N' ||
-                         session->httpHeaderFieldName.bytes[5] == 'n') &&
-                        (session->httpHeaderFieldName.bytes[6] == 'T' ||
-                         session->httpHeaderFieldName.bytes[6] == 't') &&
-                        (session->httpHeaderFieldName.bytes[7] == '-') &&
-                        (session->httpHeaderFieldName.bytes[8] == 'T' ||
-                         session->httpHeaderFieldName.bytes[8] == 't') &&
-                        (session->httpHeaderFieldName.bytes[9] == 'Y' ||
-                         session->httpHeaderFieldName.bytes[9] == 'y') &&
-                        (session->httpHeaderFieldName.bytes[10] == 'P' ||
-                         session->httpHeaderFieldName.bytes[10] == 'p') &&
-                        (session->httpHeaderFieldName.bytes[11] == 'E' ||
-                         session->httpHeaderFieldName.bytes[11] == 'e')) {
-                    if (hasContentType) {
-                        HAPLog(&logObject, "Request has multiple Content-Type headers.");
-                        session->httpParserError = true;
-                    } else {
-                        hasContentType = true;
-                        read_http_content_type(session);
-                    }
+                switch (GetHTTPHeaderField(
+                        HAPNonnull(session->httpHeaderFieldName.bytes), session->httpHeaderFieldName.numBytes)) {
+                    case kHAPIPHTTPHeaderField_ContentLength: {
+                        if (hasContentLength) {
+                            HAPLog(&logObject, "Request has multiple Content-Length headers.");
+                            session->httpParserError = true;
+                        } else {
+                            hasContentLength = true;
+                            read_http_content_length(session);
+                        }
+                    } break;
+                    case kHAPIPHTTPHeaderField_ContentType: {
+                        if (hasContentType) {
+                            HAPLog(&logObject, "Request has multiple Content-Type headers.");
+                            session->httpParserError = true;
+                        } else {
+                            hasContentType = true;
+                            read_http_content_type(session);
+                        }
+                    } break;
+                    case kHAPIPHTTPHeaderField_Unknown: {
+                    } break;
                 }
                 session->httpHeaderFieldName.bytes = NULL;
                 session->httpHeaderFieldValue.bytes = NULL;
@@ -3199,6 +4051,7 @@ static void handle_input(HAPIPSessionDescriptor* session) {
         if (!session->securitySession.isSecured) {
             HAPLogDebug(&logObject, "Established HAP security session.");
             session->securitySession.isSecured = true;
+            UpdateSessionActivityList((HAPIPSession*) session);
         }
         session->inboundBuffer.position = session->inboundBufferMark;
         r = HAPIPSecurityProtocolDecryptData(
@@ -3233,19 +4086,173 @@ static void handle_input(HAPIPSessionDescriptor* session) {
                 CloseSession(session);
             }
         }
-    } else {
-        HAPAssert(r == -1);
-        HAPLog(&logObject, "Decryption error.");
-        CloseSession(session);
+    } else {
+        HAPAssert(r == -1);
+        HAPLog(&logObject, "Decryption error.");
+        CloseSession(session);
+    }
+}
+
+static void HandleTCPStreamEvent(
+        HAPPlatformTCPStreamManagerRef tcpStreamManager,
+        HAPPlatformTCPStreamRef tcpStream,
+        HAPPlatformTCPStreamEvent event,
+        void* _Nullable context);
+
+/**
+ * Computes the digest of a characteristic value that has been read for an event notification.
+ *
+ * @param      characteristic       Characteristic.
+ * @param      readContext          Read context containing the successfully read value.
+ * @param[out] digest               Digest of the characteristic value. The isValid flag is not modified.
+ */
+static void GetEventNotificationValueDigest(
+        const HAPBaseCharacteristic* characteristic,
+        const HAPIPReadContext* readContext,
+        HAPIPEventNotificationValueDigest* digest) {
+    HAPPrecondition(characteristic);
+    HAPPrecondition(readContext);
+    HAPPrecondition(readContext->status == kHAPIPAccessoryServerStatusCode_Success);
+    HAPPrecondition(digest);
+
+    HAPRawBufferZero(digest->bytes, sizeof digest->bytes);
+    digest->isHashed = false;
+    switch (characteristic->format) {
+        case kHAPCharacteristicFormat_Bool:
+        case kHAPCharacteristicFormat_UInt8:
+        case kHAPCharacteristicFormat_UInt16:
+        case kHAPCharacteristicFormat_UInt32:
+        case kHAPCharacteristicFormat_UInt64: {
+            HAPWriteLittleUInt64(digest->bytes, readContext->value.unsignedIntValue);
+            digest->numBytes = sizeof(uint64_t);
+            return;
+        }
+        case kHAPCharacteristicFormat_Int: {
+            HAPWriteLittleInt32(digest->bytes, readContext->value.intValue);
+            digest->numBytes = sizeof(int32_t);
+            return;
+        }
+        case kHAPCharacteristicFormat_Float: {
+            HAPWriteLittleUInt32(digest->bytes, HAPFloatGetBitPattern(readContext->value.floatValue));
+            digest->numBytes = sizeof(uint32_t);
+            return;
+        }
+        case kHAPCharacteristicFormat_Data:
+        case kHAPCharacteristicFormat_String:
+        case kHAPCharacteristicFormat_TLV8: {
+            const uint8_t* _Nullable bytes = (const uint8_t*) readContext->value.stringValue.bytes;
+            size_t numBytes = readContext->value.stringValue.numBytes;
+            HAPAssert(bytes || !numBytes);
+            HAPAssert(numBytes <= UINT32_MAX);
+            digest->numBytes = (uint32_t) numBytes;
+            if (numBytes <= sizeof digest->bytes) {
+                if (numBytes) {
+                    HAPRawBufferCopyBytes(digest->bytes, HAPNonnull(bytes), numBytes);
+                }
+                return;
+            }
+            uint64_t hash = 14695981039346656037ULL;
+            for (size_t i = 0; i < numBytes; i++) {
+                hash ^= HAPNonnull(bytes)[i];
+                hash *= 1099511628211ULL;
+            }
+            HAPWriteLittleUInt64(digest->bytes, hash);
+            digest->isHashed = true;
+            return;
+        }
+    }
+    HAPFatalError();
+}
+
+/**
+ * Records the value of a characteristic that is about to be delivered in an event notification on a session.
+ *
+ * - Only characteristics with the ip.suppressUnchangedEventNotifications property are tracked.
+ *
+ * @param      session              IP session descriptor.
+ * @param      readContext          Read context of the event notification.
+ *
+ * @return true                     If the value is identical to the one last delivered and should be suppressed.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool UpdateLastEventNotificationValue(HAPIPSessionDescriptor* session, const HAPIPReadContext* readContext) {
+    HAPPrecondition(session);
+    HAPPrecondition(session->server);
+    HAPPrecondition(readContext);
+
+    size_t characteristicIndex;
+    if (!GetCharacteristicIndex(
+                HAPNonnull(session->server), readContext->aid, readContext->iid, &characteristicIndex)) {
+        return false;
+    }
+    if (!HAPBitSetContainsBit(
+                GetSubscribedCharacteristics(session),
+                GetEventNotificationBitSetNumBytes(session),
+                characteristicIndex)) {
+        return false;
+    }
+    const HAPIPCharacteristicIndexElement* element =
+            GetCharacteristicIndexElement((const HAPAccessoryServer*) session->server, characteristicIndex);
+    HAPIPEventNotificationValueDigest* _Nullable valueDigest = GetValueDigest(session, element);
+    if (!valueDigest) {
+        return false;
+    }
+
+    if (readContext->status != kHAPIPAccessoryServerStatusCode_Success) {
+        valueDigest->isValid = false;
+        return false;
+    }
+
+    HAPIPEventNotificationValueDigest digest;
+    GetEventNotificationValueDigest(element->characteristic, readContext, &digest);
+    if (valueDigest->isValid && valueDigest->numBytes == digest.numBytes && valueDigest->isHashed == digest.isHashed &&
+        HAPRawBufferAreEqual(valueDigest->bytes, digest.bytes, sizeof digest.bytes)) {
+        HAPLogCharacteristicDebug(
+                &logObject,
+                element->characteristic,
+                element->service,
+                element->accessory,
+                "Suppressing event notification (value unchanged).");
+        return true;
+    }
+    HAPRawBufferCopyBytes(valueDigest->bytes, digest.bytes, sizeof digest.bytes);
+    valueDigest->numBytes = digest.numBytes;
+    valueDigest->isHashed = digest.isHashed;
+    valueDigest->isValid = true;
+    return false;
+}
+
+/**
+ * Forgets the values recorded for event notifications that could not be delivered on a session.
+ *
+ * @param      session              IP session descriptor.
+ * @param      readContexts         Read contexts of the event notifications.
+ * @param      numReadContexts      Number of read contexts.
+ */
+static void InvalidateLastEventNotificationValues(
+        HAPIPSessionDescriptor* session,
+        HAPIPReadContextRef* readContexts,
+        size_t numReadContexts) {
+    HAPPrecondition(session);
+    HAPPrecondition(session->server);
+    HAPPrecondition(readContexts);
+
+    for (size_t i = 0; i < numReadContexts; i++) {
+        const HAPIPReadContext* readContext = (const HAPIPReadContext*) &readContexts[i];
+        size_t characteristicIndex;
+        if (GetCharacteristicIndex(
+                    HAPNonnull(session->server), readContext->aid, readContext->iid, &characteristicIndex)) {
+            HAPIPEventNotificationValueDigest* _Nullable valueDigest = GetValueDigest(
+                    session,
+                    GetCharacteristicIndexElement((const HAPAccessoryServer*) session->server, characteristicIndex));
+            if (valueDigest) {
+                valueDigest->isValid = false;
+            }
+        }
     }
 }
 
-static void HandleTCPStreamEvent(
-        HAPPlatformTCPStreamManagerRef tcpStreamManager,
-        HAPPlatformTCPStreamRef tcpStream,
-        HAPPlatformTCPStreamEvent event,
-        void* _Nullable context);
-
 static void write_event_notifications(HAPIPSessionDescriptor* session) {
     HAPPrecondition(session);
     HAPPrecondition(session->server);
@@ -3257,7 +4264,7 @@ static void write_event_notifications(HAPIPSessionDescriptor* session) {
     HAPPrecondition(session->inboundBuffer.position == 0);
     HAPPrecondition(session->numEventNotificationFlags > 0);
     HAPPrecondition(session->numEventNotificationFlags <= session->numEventNotifications);
-    HAPPrecondition(session->numEventNotifications <= session->maxEventNotifications);
+    HAPPrecondition(session->numEventNotifications <= GetEventNotificationBitSetNumBytes(session) * CHAR_BIT);
 
     HAPError err;
 
@@ -3265,60 +4272,50 @@ static void write_event_notifications(HAPIPSessionDescriptor* session) {
         HAPTime clock_now_ms = HAPPlatformClockGetCurrent();
         HAPAssert(clock_now_ms >= session->eventNotificationStamp);
         HAPTime dt_ms = clock_now_ms - session->eventNotificationStamp;
+        bool isCoalescingDelayElapsed = dt_ms >= kHAPIPAccessoryServer_MaxEventNotificationDelay;
 
         size_t numReadContexts = 0;
 
-        for (size_t i = 0; i < session->numEventNotifications; i++) {
-            HAPIPEventNotification* eventNotification = (HAPIPEventNotification*) &session->eventNotifications[i];
-            if (eventNotification->flag) {
-                bool notifyNow;
-                if (dt_ms >= kHAPIPAccessoryServer_MaxEventNotificationDelay) {
-                    notifyNow = true;
-                    session->eventNotificationStamp = clock_now_ms;
-                } else {
-                    // Network-based notifications must be coalesced by the accessory using a delay of no less than
-                    // 1 second. The exception to this rule includes notifications for the following characteristics
-                    // which must be delivered immediately.
-                    // See HomeKit Accessory Protocol Specification R14
-                    // Section 6.8 Notifications
-                    const HAPCharacteristic* characteristic_;
-                    const HAPService* service;
-                    const HAPAccessory* accessory;
-                    get_db_ctx(
-                            session->server,
-                            eventNotification->aid,
-                            eventNotification->iid,
-                            &characteristic_,
-                            &service,
-                            &accessory);
-                    HAPAssert(accessory);
-                    HAPAssert(service);
-                    HAPAssert(characteristic_);
-                    const HAPBaseCharacteristic* characteristic = characteristic_;
-                    notifyNow = HAPUUIDAreEqual(
-                            characteristic->characteristicType, &kHAPCharacteristicType_ProgrammableSwitchEvent);
-                    if (notifyNow) {
-                        HAPLogCharacteristicDebug(
-                                &logObject,
-                                characteristic_,
-                                service,
-                                accessory,
-                                "Characteristic whitelisted to bypassing notification coalescing requirement.");
-                    }
-                }
+        uint8_t* pendingCharacteristics = GetPendingCharacteristics(session);
+        size_t numBitSetBytes = GetEventNotificationBitSetNumBytes(session);
+        HAPAssert(HAPBitSetGetCount(pendingCharacteristics, numBitSetBytes) == session->numEventNotificationFlags);
+        for (size_t characteristicIndex = 0;
+             HAPBitSetFindNext(pendingCharacteristics, numBitSetBytes, &characteristicIndex);
+             characteristicIndex++) {
+            const HAPIPCharacteristicIndexElement* element =
+                    GetCharacteristicIndexElement(server, characteristicIndex);
+            bool notifyNow;
+            if (isCoalescingDelayElapsed) {
+                notifyNow = true;
+            } else {
+                // Network-based notifications must be coalesced by the accessory using a delay of no less than
+                // 1 second. The exception to this rule includes notifications for the following characteristics
+                // which must be delivered immediately.
+                // See HomeKit Accessory Protocol Specification R14
+                // Section 6.8 Notifications
+                const HAPBaseCharacteristic* characteristic = element->characteristic;
+                notifyNow = HAPUUIDAreEqual(
+                        characteristic->characteristicType, &kHAPCharacteristicType_ProgrammableSwitchEvent);
                 if (notifyNow) {
-                    HAPAssert(numReadContexts < server->ip.storage->numReadContexts);
-                    HAPIPReadContext* readContext =
-                            (HAPIPReadContext*) &server->ip.storage->readContexts[numReadContexts];
-                    HAPRawBufferZero(readContext, sizeof *readContext);
-                    readContext->aid = eventNotification->aid;
-                    readContext->iid = eventNotification->iid;
-                    numReadContexts++;
-                    eventNotification->flag = false;
-                    HAPAssert(session->numEventNotificationFlags > 0);
-                    session->numEventNotificationFlags--;
+                    HAPLogCharacteristicDebug(
+                            &logObject,
+                            element->characteristic,
+                            element->service,
+                            element->accessory,
+                            "Characteristic whitelisted to bypassing notification coalescing requirement.");
                 }
             }
+            if (notifyNow) {
+                HAPAssert(numReadContexts < server->ip.storage->numReadContexts);
+                HAPIPReadContext* readContext = (HAPIPReadContext*) &server->ip.storage->readContexts[numReadContexts];
+                HAPRawBufferZero(readContext, sizeof *readContext);
+                readContext->aid = element->accessory->aid;
+                readContext->iid = ((const HAPBaseCharacteristic*) element->characteristic)->iid;
+                numReadContexts++;
+                HAPBitSetRemoveBit(pendingCharacteristics, numBitSetBytes, characteristicIndex);
+                HAPAssert(session->numEventNotificationFlags > 0);
+                session->numEventNotificationFlags--;
+            }
         }
 
         if (numReadContexts > 0) {
@@ -3337,6 +4334,31 @@ static void write_event_notifications(HAPIPSessionDescriptor* session) {
                     numReadContexts,
                     &data_buffer);
             (void) r;
+            HAPAccessoryServerUpdateHighWaterMark(&server->storageHighWaterMarks.ip.numReadContexts, numReadContexts);
+            HAPAccessoryServerUpdateHighWaterMark(
+                    &server->storageHighWaterMarks.ip.numScratchBufferBytes, data_buffer.position);
+
+            // Drop event notifications whose value did not change since it was last delivered on this session.
+            size_t numChangedReadContexts = 0;
+            for (size_t i = 0; i < numReadContexts; i++) {
+                HAPIPReadContext* readContext = (HAPIPReadContext*) &server->ip.storage->readContexts[i];
+                if (!UpdateLastEventNotificationValue(session, readContext)) {
+                    if (numChangedReadContexts != i) {
+                        HAPRawBufferCopyBytes(
+                                &server->ip.storage->readContexts[numChangedReadContexts],
+                                readContext,
+                                sizeof server->ip.storage->readContexts[numChangedReadContexts]);
+                    }
+                    numChangedReadContexts++;
+                }
+            }
+            numReadContexts = numChangedReadContexts;
+        }
+
+        if (numReadContexts > 0) {
+            if (isCoalescingDelayElapsed) {
+                session->eventNotificationStamp = clock_now_ms;
+            }
 
             size_t content_length = HAPIPAccessoryProtocolGetNumEventNotificationBytes(
                     HAPNonnull(session->server), server->ip.storage->readContexts, numReadContexts);
@@ -3382,6 +4404,8 @@ static void write_event_notifications(HAPIPSessionDescriptor* session) {
                     } else {
                         HAPLog(&logObject, "Skipping event notifications (outbound buffer too small).");
                         HAPIPByteBufferClear(&session->outboundBuffer);
+                        InvalidateLastEventNotificationValues(
+                                session, server->ip.storage->readContexts, numReadContexts);
                     }
                 } else {
                     HAPAssert(kHAPIPAccessoryServer_SessionSecurityDisabled);
@@ -3390,6 +4414,10 @@ static void write_event_notifications(HAPIPSessionDescriptor* session) {
                     HAP_DIAGNOSTIC_RESTORE_ICCARM(Pe111)
                 }
                 if (session->state == kHAPIPSessionState_Writing) {
+                    HAPAccessoryServerRecordRequest(
+                            HAPNonnull(session->server),
+                            kHAPAccessoryServerRequestType_EventNotification,
+                            clock_now_ms);
                     HAPPlatformTCPStreamEvent interests = { .hasBytesAvailable = false, .hasSpaceAvailable = true };
                     HAPPlatformTCPStreamUpdateInterests(
                             HAPNonnull(server->platform.ip.tcpStreamManager),
@@ -3401,18 +4429,12 @@ static void write_event_notifications(HAPIPSessionDescriptor* session) {
             } else {
                 HAPLog(&logObject, "Skipping event notifications (outbound buffer too small).");
                 session->outboundBuffer.position = mark;
+                InvalidateLastEventNotificationValues(session, server->ip.storage->readContexts, numReadContexts);
             }
         }
     } else {
-        for (size_t i = 0; i < session->numEventNotifications; i++) {
-            HAPIPEventNotification* eventNotification = (HAPIPEventNotification*) &session->eventNotifications[i];
-            if (eventNotification->flag) {
-                eventNotification->flag = false;
-                HAPAssert(session->numEventNotificationFlags > 0);
-                session->numEventNotificationFlags--;
-            }
-        }
-        HAPAssert(session->numEventNotificationFlags == 0);
+        HAPRawBufferZero(GetPendingCharacteristics(session), GetEventNotificationBitSetNumBytes(session));
+        session->numEventNotificationFlags = 0;
         session->eventNotificationStamp = HAPPlatformClockGetCurrent();
     }
 }
@@ -3490,6 +4512,7 @@ static void WriteOutboundData(HAPIPSessionDescriptor* session) {
     HAPAssert(b->data);
     HAPAssert(b->position <= b->limit);
     HAPAssert(b->limit <= b->capacity);
+    HAPAccessoryServerUpdateHighWaterMark(&server->storageHighWaterMarks.ip.numOutboundBufferBytes, b->limit);
 
     size_t numBytes;
     err = HAPPlatformTCPStreamWrite(
@@ -3521,6 +4544,8 @@ static void WriteOutboundData(HAPIPSessionDescriptor* session) {
     } else {
         HAPAssert(numBytes <= b->limit - b->position);
         b->position += numBytes;
+        session->numBytesSent += numBytes;
+        server->statistics.ip.numBytesSent += numBytes;
         if (b->position == b->limit) {
             if (session->securitySession.type == kHAPIPSecuritySessionType_HAP && session->securitySession.isSecured &&
                 !HAPSessionIsSecured(&session->securitySession._.hap)) {
@@ -3592,6 +4617,9 @@ static void ReadInboundData(HAPIPSessionDescriptor* session) {
     } else {
         HAPAssert(numBytes <= b->limit - b->position);
         b->position += numBytes;
+        session->numBytesReceived += numBytes;
+        server->statistics.ip.numBytesReceived += numBytes;
+        HAPAccessoryServerUpdateHighWaterMark(&server->storageHighWaterMarks.ip.numInboundBufferBytes, b->position);
         handle_input(session);
     }
 }
@@ -3614,7 +4642,7 @@ static void HandleTCPStreamEvent(
     if (event.hasBytesAvailable) {
         HAPAssert(!event.hasSpaceAvailable);
         HAPAssert(session->state == kHAPIPSessionState_Reading);
-        session->stamp = clock_now_ms;
+        TouchSession(session, clock_now_ms);
         ReadInboundData(session);
         handle_io_progression(session);
     }
@@ -3622,12 +4650,71 @@ static void HandleTCPStreamEvent(
     if (event.hasSpaceAvailable) {
         HAPAssert(!event.hasBytesAvailable);
         HAPAssert(session->state == kHAPIPSessionState_Writing);
-        session->stamp = clock_now_ms;
+        TouchSession(session, clock_now_ms);
         WriteOutboundData(session);
         handle_io_progression(session);
     }
 }
 
+/**
+ * Admission control for new connections when all IP sessions are in use.
+ *
+ * - The least recently active session without event notification subscriptions is closed and released
+ *   so that its storage can be reused for the new connection. Sessions with subscriptions are never evicted,
+ *   as controllers rely on them to receive event notifications.
+ *
+ * - Sessions that have not completed Pair Verify are evicted first. Secured sessions are only evicted once they
+ *   have been idle for at least kHAPIPSession_MinIdleTimeBeforeEviction, so that a burst of unauthenticated
+ *   connections cannot displace controllers that are in use.
+ *
+ * - Unsecured and secured sessions are kept in separate activity lists, so only the head of each list needs to be
+ *   considered. Sessions that completed Pair Verify since they were last active are moved to the secured list.
+ *
+ * @param      server_              Accessory server.
+ *
+ * @return true                     If a session was evicted and returned to the free list.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool EvictLeastRecentlyActiveSession(HAPAccessoryServerRef* server_) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+
+    HAPTime clock_now_ms = HAPPlatformClockGetCurrent();
+
+    HAPIPSession* _Nullable ipSession = server->ip.unsecuredSessions.head;
+    while (ipSession && IsSessionSecured((HAPIPSessionDescriptor*) &HAPNonnull(ipSession)->descriptor)) {
+        UpdateSessionActivityList(HAPNonnull(ipSession));
+        ipSession = server->ip.unsecuredSessions.head;
+    }
+    if (!ipSession) {
+        // A pending characteristic write request keeps its session busy. At most one session is skipped.
+        ipSession = server->ip.unsubscribedSessions.head;
+        if (ipSession && ipSession == server->ip.characteristicWriteRequestContext.ipSession) {
+            ipSession = ((HAPIPSessionDescriptor*) &HAPNonnull(ipSession)->descriptor)->nextActiveSession;
+        }
+        if (ipSession) {
+            HAPIPSessionDescriptor* session = (HAPIPSessionDescriptor*) &HAPNonnull(ipSession)->descriptor;
+            HAPAssert(!session->numEventNotifications);
+            HAPAssert(clock_now_ms >= session->stamp);
+            if (clock_now_ms - session->stamp < kHAPIPSession_MinIdleTimeBeforeEviction) {
+                ipSession = NULL;
+            }
+        }
+    }
+    if (!ipSession) {
+        return false;
+    }
+    HAPIPSessionDescriptor* session = (HAPIPSessionDescriptor*) &HAPNonnull(ipSession)->descriptor;
+
+    HAPLogInfo(&logObject, "session:%p:evicting least recently active session", (const void*) session);
+    CloseSession(session);
+    HAPIPSessionDestroy(HAPNonnull(ipSession));
+    HAPAssert(server->ip.numSessions > 0);
+    server->ip.numSessions--;
+    return true;
+}
+
 static void HandlePendingTCPStream(HAPPlatformTCPStreamManagerRef tcpStreamManager, void* _Nullable context) {
     HAPPrecondition(context);
     HAPAccessoryServerRef* server_ = context;
@@ -3649,14 +4736,10 @@ static void HandlePendingTCPStream(HAPPlatformTCPStreamManagerRef tcpStreamManag
         return;
     }
 
-    // Find free IP session.
-    HAPIPSession* ipSession = NULL;
-    for (size_t i = 0; i < server->ip.storage->numSessions; i++) {
-        HAPIPSessionDescriptor* descriptor = (HAPIPSessionDescriptor*) &server->ip.storage->sessions[i].descriptor;
-        if (!descriptor->server) {
-            ipSession = &server->ip.storage->sessions[i];
-            break;
-        }
+    // Take free IP session.
+    HAPIPSession* ipSession = TakeFreeSession(server_);
+    if (!ipSession && EvictLeastRecentlyActiveSession(server_)) {
+        ipSession = TakeFreeSession(server_);
     }
     if (!ipSession) {
         HAPLog(&logObject,
@@ -3674,6 +4757,7 @@ static void HandlePendingTCPStream(HAPPlatformTCPStreamManagerRef tcpStreamManag
     t->tcpStreamIsOpen = true;
     t->state = kHAPIPSessionState_Idle;
     t->stamp = HAPPlatformClockGetCurrent();
+    server->statistics.ip.numSessionsAccepted++;
     t->securitySession.isOpen = false;
     t->securitySession.isSecured = false;
     t->inboundBuffer.position = 0;
@@ -3796,6 +4880,15 @@ static void engine_init(HAPAccessoryServerRef* server_) {
             &logObject,
             "Storage configuration: writeContexts = %lu",
             (unsigned long) (server->ip.storage->numWriteContexts * sizeof(HAPIPWriteContextRef)));
+    HAPLogDebug(
+            &logObject,
+            "Storage configuration: numCharacteristicIndexElements = %lu",
+            (unsigned long) server->ip.storage->numCharacteristicIndexElements);
+    HAPLogDebug(
+            &logObject,
+            "Storage configuration: characteristicIndexElements = %lu",
+            (unsigned long) (server->ip.storage->numCharacteristicIndexElements *
+                             sizeof(HAPIPCharacteristicIndexElementRef)));
     HAPLogDebug(
             &logObject,
             "Storage configuration: scratchBuffer.numBytes = %lu",
@@ -3822,6 +4915,12 @@ static HAPError engine_deinit(HAPAccessoryServerRef* server_) {
     HAPAssert(storage->writeContexts);
     HAPRawBufferZero(storage->writeContexts, storage->numWriteContexts * sizeof *storage->writeContexts);
 
+    HAPAssert(storage->characteristicIndexElements);
+    HAPRawBufferZero(
+            storage->characteristicIndexElements,
+            storage->numCharacteristicIndexElements * sizeof *storage->characteristicIndexElements);
+    HAPRawBufferZero(&server->ip.characteristicIndex, sizeof server->ip.characteristicIndex);
+
     HAPAssert(storage->scratchBuffer.bytes);
     HAPRawBufferZero(storage->scratchBuffer.bytes, storage->scratchBuffer.numBytes);
 
@@ -3898,6 +4997,8 @@ static void engine_start(HAPAccessoryServerRef* server_) {
 
     HAPLogDebug(&logObject, "Starting server engine.");
 
+    BuildCharacteristicIndex(server_);
+
     server->ip.state = kHAPIPAccessoryServerState_Running;
     HAPAccessoryServerDelegateScheduleHandleUpdatedState(server_);
 
@@ -3951,8 +5052,20 @@ static HAPError engine_raise_event_on_session_(
 
     size_t events_raised = 0;
 
-    uint64_t aid = accessory_->aid;
-    uint64_t iid = ((const HAPBaseCharacteristic*) characteristic_)->iid;
+    size_t characteristicIndex;
+    if (!GetCharacteristicIndex(
+                server_,
+                accessory_->aid,
+                ((const HAPBaseCharacteristic*) characteristic_)->iid,
+                &characteristicIndex)) {
+        HAPLogCharacteristicDebug(
+                &logObject,
+                characteristic_,
+                service_,
+                accessory_,
+                "Not flagging event pending (not supported over IP).");
+        return kHAPError_None;
+    }
 
     for (size_t i = 0; i < server->ip.storage->numSessions; i++) {
         HAPIPSession* ipSession = &server->ip.storage->sessions[i];
@@ -3978,21 +5091,11 @@ static HAPError engine_raise_event_on_session_(
             (characteristic_ != server->ip.characteristicWriteRequestContext.characteristic) ||
             (service_ != server->ip.characteristicWriteRequestContext.service) ||
             (accessory_ != server->ip.characteristicWriteRequestContext.accessory)) {
-            HAPAssert(session->numEventNotifications <= session->maxEventNotifications);
-            size_t j = 0;
-            while ((j < session->numEventNotifications) &&
-                   ((((HAPIPEventNotification*) &session->eventNotifications[j])->aid != aid) ||
-                    (((HAPIPEventNotification*) &session->eventNotifications[j])->iid != iid))) {
-                j++;
-            }
-            HAPAssert(
-                    (j == session->numEventNotifications) ||
-                    ((j < session->numEventNotifications) &&
-                     (((HAPIPEventNotification*) &session->eventNotifications[j])->aid == aid) &&
-                     (((HAPIPEventNotification*) &session->eventNotifications[j])->iid == iid)));
-            if ((j < session->numEventNotifications) &&
-                !((HAPIPEventNotification*) &session->eventNotifications[j])->flag) {
-                ((HAPIPEventNotification*) &session->eventNotifications[j])->flag = true;
+            size_t numBitSetBytes = GetEventNotificationBitSetNumBytes(session);
+            uint8_t* pendingCharacteristics = GetPendingCharacteristics(session);
+            if (HAPBitSetContainsBit(GetSubscribedCharacteristics(session), numBitSetBytes, characteristicIndex) &&
+                !HAPBitSetContainsBit(pendingCharacteristics, numBitSetBytes, characteristicIndex)) {
+                HAPBitSetInsertBit(pendingCharacteristics, numBitSetBytes, characteristicIndex);
                 session->numEventNotificationFlags++;
                 events_raised++;
             }
@@ -4066,6 +5169,8 @@ static void Create(HAPAccessoryServerRef* server_, const HAPAccessoryServerOptio
     HAPIPAccessoryServerStorage* storage = options->ip.accessoryServerStorage;
     HAPPrecondition(storage->readContexts);
     HAPPrecondition(storage->writeContexts);
+    HAPPrecondition(storage->characteristicIndexElements);
+    HAPPrecondition(storage->valueCacheElements || !storage->numValueCacheElements);
     HAPPrecondition(storage->scratchBuffer.bytes);
     HAPPrecondition(storage->sessions);
     HAPPrecondition(storage->numSessions);
@@ -4077,6 +5182,14 @@ static void Create(HAPAccessoryServerRef* server_, const HAPAccessoryServerOptio
     }
     HAPRawBufferZero(storage->readContexts, storage->numReadContexts * sizeof *storage->readContexts);
     HAPRawBufferZero(storage->writeContexts, storage->numWriteContexts * sizeof *storage->writeContexts);
+    HAPRawBufferZero(
+            storage->characteristicIndexElements,
+            storage->numCharacteristicIndexElements * sizeof *storage->characteristicIndexElements);
+    if (storage->valueCacheElements) {
+        HAPRawBufferZero(
+                HAPNonnull(storage->valueCacheElements),
+                storage->numValueCacheElements * sizeof *storage->valueCacheElements);
+    }
     HAPRawBufferZero(storage->scratchBuffer.bytes, storage->scratchBuffer.numBytes);
     for (size_t i = 0; i < storage->numSessions; i++) {
         HAPIPSession* ipSession = &storage->sessions[i];
@@ -4100,6 +5213,9 @@ static void PrepareStart(HAPAccessoryServerRef* server_) {
     HAPIPAccessoryServerStorage* storage = HAPNonnull(server->ip.storage);
     HAPRawBufferZero(storage->readContexts, storage->numReadContexts * sizeof *storage->readContexts);
     HAPRawBufferZero(storage->writeContexts, storage->numWriteContexts * sizeof *storage->writeContexts);
+    HAPRawBufferZero(
+            storage->characteristicIndexElements,
+            storage->numCharacteristicIndexElements * sizeof *storage->characteristicIndexElements);
     HAPRawBufferZero(storage->scratchBuffer.bytes, storage->scratchBuffer.numBytes);
     for (size_t i = 0; i < storage->numSessions; i++) {
         HAPIPSession* ipSession = &storage->sessions[i];
@@ -4110,6 +5226,14 @@ static void PrepareStart(HAPAccessoryServerRef* server_) {
                 ipSession->eventNotifications,
                 ipSession->numEventNotifications * sizeof *ipSession->eventNotifications);
     }
+
+    // Link all sessions into the free list, lowest index first.
+    server->ip.freeSessions = NULL;
+    for (size_t i = storage->numSessions; i > 0; i--) {
+        HAPIPSession* ipSession = &storage->sessions[i - 1];
+        ((HAPIPSessionDescriptor*) &ipSession->descriptor)->nextActiveSession = server->ip.freeSessions;
+        server->ip.freeSessions = ipSession;
+    }
 }
 
 static void WillStart(HAPAccessoryServerRef* server_) {
@@ -4125,6 +5249,309 @@ static void HAPSessionInvalidateDependentIPState(HAPAccessoryServerRef* server_,
     HAPPrecondition(session);
 }
 
+/**
+ * Writes the deferred Pair Setup response of a session once the Pair Setup procedure can continue.
+ *
+ * @param      server_              Accessory server.
+ * @param      session              Session whose Pair Setup response has been deferred.
+ */
+static void HAPSessionContinueIPPairSetup(HAPAccessoryServerRef* server_, HAPSessionRef* session) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(session);
+
+    size_t i = HAPAccessoryServerGetIPSessionIndex(server_, session);
+    HAPIPSessionDescriptor* t = (HAPIPSessionDescriptor*) &server->ip.storage->sessions[i].descriptor;
+    HAPPrecondition(t->state == kHAPIPSessionState_Waiting);
+
+    bool isResponseWritten =
+            write_pairing_response(t, HAPSessionHandlePairSetupRead, HAPAccessoryServerIsPaired(server_));
+    HAPAssert(isResponseWritten);
+    prepare_writing_response(t);
+    handle_io_progression(t);
+}
+
+/**
+ * Returns whether an accessory is kept when the bridged accessories are replaced.
+ *
+ * @param      server               Accessory server.
+ * @param      accessory            Accessory in the IP characteristic index.
+ * @param      bridgedAccessories   New NULL-terminated array of bridged accessories.
+ *
+ * @return true                     If the accessory is the primary accessory or one of the new bridged accessories.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool IsAccessoryKept(
+        const HAPAccessoryServer* server,
+        const HAPAccessory* accessory,
+        const HAPAccessory* _Nullable const* _Nullable bridgedAccessories) {
+    HAPPrecondition(server);
+    HAPPrecondition(accessory);
+
+    if (accessory == server->primaryAccessory) {
+        return true;
+    }
+    for (size_t i = 0; bridgedAccessories && bridgedAccessories[i]; i++) {
+        if (bridgedAccessories[i] == accessory) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Length of the instance IDs of a characteristic that are saved in the scratch buffer
+ * while the bridged accessories are replaced.
+ */
+#define kCharacteristicIndexKeyBytes (2 * sizeof(uint64_t))
+
+static void UpdateBridgedAccessories(
+        HAPAccessoryServerRef* server_,
+        const HAPAccessory* _Nullable const* _Nullable bridgedAccessories) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(server->ip.state == kHAPIPAccessoryServerState_Running);
+    HAPIPAccessoryServerStorage* storage = HAPNonnull(server->ip.storage);
+
+    // Close sessions that are sending the accessory attribute database, as it is serialized incrementally.
+    for (size_t i = 0; i < storage->numSessions; i++) {
+        HAPIPSessionDescriptor* t = (HAPIPSessionDescriptor*) &storage->sessions[i].descriptor;
+        if (t->server && t->state != kHAPIPSessionState_Idle && t->accessorySerializationIsInProgress) {
+            HAPLog(&logObject, "session:%p:closing (attribute database changed)", (const void*) t);
+            CloseSession(t);
+        }
+    }
+
+    // Subscriptions are remapped by instance IDs, which are saved in the scratch buffer together with
+    // the previous event notification bit sets of one session at a time.
+    size_t numPreviousElements = server->ip.characteristicIndex.numElements;
+    size_t numPreviousBitSetBytes =
+            server->ip.characteristicIndex.numBitSetElements * sizeof(HAPIPEventNotificationRef);
+    uint8_t* keys = storage->scratchBuffer.bytes;
+    uint8_t* previousSubscribedCharacteristics = &keys[numPreviousElements * kCharacteristicIndexKeyBytes];
+    uint8_t* previousPendingCharacteristics = &previousSubscribedCharacteristics[numPreviousBitSetBytes];
+    bool canKeepSubscriptions = numPreviousElements * kCharacteristicIndexKeyBytes + 2 * numPreviousBitSetBytes <=
+                                storage->scratchBuffer.numBytes;
+    if (!canKeepSubscriptions) {
+        HAPLog(&logObject, "Ending all event notification subscriptions (scratch buffer too small).");
+    }
+
+    // End subscriptions for characteristics of removed accessories.
+    for (size_t i = 0; i < storage->numSessions; i++) {
+        HAPIPSessionDescriptor* t = (HAPIPSessionDescriptor*) &storage->sessions[i].descriptor;
+        if (!t->server || !t->numEventNotifications) {
+            continue;
+        }
+        const HAPAccessory* _Nullable accessory = NULL;
+        bool isAccessoryKept = false;
+        for (size_t characteristicIndex = 0; HAPBitSetFindNext(
+                     GetSubscribedCharacteristics(t), GetEventNotificationBitSetNumBytes(t), &characteristicIndex);
+             characteristicIndex++) {
+            const HAPIPCharacteristicIndexElement* element = GetCharacteristicIndexElement(server, characteristicIndex);
+            if (element->accessory != accessory) {
+                accessory = element->accessory;
+                isAccessoryKept =
+                        canKeepSubscriptions && IsAccessoryKept(server, element->accessory, bridgedAccessories);
+            }
+            if (!isAccessoryKept) {
+                EndSubscription(t, characteristicIndex);
+            }
+        }
+    }
+
+    // Save instance IDs of the characteristics.
+    if (canKeepSubscriptions) {
+        for (size_t i = 0; i < numPreviousElements; i++) {
+            const HAPIPCharacteristicIndexElement* element = GetCharacteristicIndexElement(server, i);
+            HAPWriteLittleUInt64(&keys[i * kCharacteristicIndexKeyBytes], element->accessory->aid);
+            HAPWriteLittleUInt64(
+                    &keys[i * kCharacteristicIndexKeyBytes + sizeof(uint64_t)],
+                    ((const HAPBaseCharacteristic*) element->characteristic)->iid);
+        }
+    }
+
+    // Rebuild characteristic index.
+    server->ip.bridgedAccessories = bridgedAccessories;
+    BuildCharacteristicIndex(server_);
+
+    // Remap subscriptions and pending events. Value digests are reset.
+    for (size_t i = 0; i < storage->numSessions; i++) {
+        HAPIPSession* ipSession = &storage->sessions[i];
+        HAPIPSessionDescriptor* t = (HAPIPSessionDescriptor*) &ipSession->descriptor;
+        if (!t->server) {
+            continue;
+        }
+        if (t->numEventNotifications) {
+            HAPAssert(canKeepSubscriptions);
+            HAPRawBufferCopyBytes(
+                    previousSubscribedCharacteristics, &ipSession->eventNotifications[0], 2 * numPreviousBitSetBytes);
+        }
+        HAPRawBufferZero(
+                ipSession->eventNotifications,
+                ipSession->numEventNotifications * sizeof *ipSession->eventNotifications);
+        if (!t->numEventNotifications) {
+            continue;
+        }
+
+        size_t numSubscribedCharacteristics = 0;
+        size_t numPendingCharacteristics = 0;
+        for (size_t previousIndex = 0;
+             HAPBitSetFindNext(previousSubscribedCharacteristics, numPreviousBitSetBytes, &previousIndex);
+             previousIndex++) {
+            size_t characteristicIndex;
+            if (!GetCharacteristicIndex(
+                        server_,
+                        HAPReadLittleUInt64(&keys[previousIndex * kCharacteristicIndexKeyBytes]),
+                        HAPReadLittleUInt64(&keys[previousIndex * kCharacteristicIndexKeyBytes + sizeof(uint64_t)]),
+                        &characteristicIndex)) {
+                continue;
+            }
+            HAPBitSetInsertBit(
+                    GetSubscribedCharacteristics(t), GetEventNotificationBitSetNumBytes(t), characteristicIndex);
+            numSubscribedCharacteristics++;
+            if (HAPBitSetContainsBit(previousPendingCharacteristics, numPreviousBitSetBytes, previousIndex)) {
+                HAPBitSetInsertBit(
+                        GetPendingCharacteristics(t), GetEventNotificationBitSetNumBytes(t), characteristicIndex);
+                numPendingCharacteristics++;
+            }
+        }
+        if (!numSubscribedCharacteristics) {
+            RemoveSessionFromActivityList(ipSession);
+            t->numEventNotifications = 0;
+            InsertSessionIntoActivityList(ipSession);
+        } else {
+            t->numEventNotifications = numSubscribedCharacteristics;
+        }
+        t->numEventNotificationFlags = numPendingCharacteristics;
+    }
+    HAPRawBufferZero(storage->scratchBuffer.bytes, storage->scratchBuffer.numBytes);
+
+    // Publish updated configuration number.
+    if (server->ip.isServiceDiscoverable) {
+        HAPIPServiceDiscoveryInvalidateHAPService(server_);
+        HAPIPServiceDiscoverySetHAPService(server_);
+    }
+}
+
+static void UpdateCachedValue(
+        HAPAccessoryServerRef* server_,
+        const HAPCharacteristic* characteristic_,
+        const HAPService* service,
+        const HAPAccessory* accessory,
+        const void* _Nullable valueBytes,
+        size_t numValueBytes) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(characteristic_);
+    const HAPBaseCharacteristic* characteristic = characteristic_;
+    HAPPrecondition(service);
+    HAPPrecondition(accessory);
+
+    HAPIPCharacteristicValueCacheElement* _Nullable cachedValue_ =
+            GetValueCacheElement(server, accessory->aid, characteristic->iid);
+    if (!cachedValue_) {
+        return;
+    }
+    HAPIPCharacteristicValueCacheElement* cachedValue = HAPNonnull(cachedValue_);
+    cachedValue->isValid = false;
+    if (!valueBytes) {
+        return;
+    }
+    if (!HAPCharacteristicIsValueFulfillingConstraints(
+                characteristic_, service, accessory, HAPNonnull(valueBytes), numValueBytes)) {
+        HAPLogCharacteristic(
+                &logObject, characteristic, service, accessory, "Not caching value (constraints not satisfied).");
+        return;
+    }
+
+    switch (characteristic->format) {
+        case kHAPCharacteristicFormat_Bool: {
+            HAPPrecondition(numValueBytes == sizeof(bool));
+            bool value;
+            HAPRawBufferCopyBytes(&value, HAPNonnull(valueBytes), sizeof value);
+            cachedValue->value.unsignedIntValue = value ? 1 : 0;
+        } break;
+        case kHAPCharacteristicFormat_UInt8: {
+            HAPPrecondition(numValueBytes == sizeof(uint8_t));
+            uint8_t value;
+            HAPRawBufferCopyBytes(&value, HAPNonnull(valueBytes), sizeof value);
+            cachedValue->value.unsignedIntValue = value;
+        } break;
+        case kHAPCharacteristicFormat_UInt16: {
+            HAPPrecondition(numValueBytes == sizeof(uint16_t));
+            uint16_t value;
+            HAPRawBufferCopyBytes(&value, HAPNonnull(valueBytes), sizeof value);
+            cachedValue->value.unsignedIntValue = value;
+        } break;
+        case kHAPCharacteristicFormat_UInt32: {
+            HAPPrecondition(numValueBytes == sizeof(uint32_t));
+            uint32_t value;
+            HAPRawBufferCopyBytes(&value, HAPNonnull(valueBytes), sizeof value);
+            cachedValue->value.unsignedIntValue = value;
+        } break;
+        case kHAPCharacteristicFormat_UInt64: {
+            HAPPrecondition(numValueBytes == sizeof(uint64_t));
+            uint64_t value;
+            HAPRawBufferCopyBytes(&value, HAPNonnull(valueBytes), sizeof value);
+            cachedValue->value.unsignedIntValue = value;
+        } break;
+        case kHAPCharacteristicFormat_Int: {
+            HAPPrecondition(numValueBytes == sizeof(int32_t));
+            HAPRawBufferCopyBytes(&cachedValue->value.intValue, HAPNonnull(valueBytes), numValueBytes);
+        } break;
+        case kHAPCharacteristicFormat_Float: {
+            HAPPrecondition(numValueBytes == sizeof(float));
+            float value;
+            HAPRawBufferCopyBytes(&value, HAPNonnull(valueBytes), sizeof value);
+            cachedValue->value.floatValue = HAPFloatCharacteristicRoundValueToStep(characteristic_, value);
+        } break;
+        case kHAPCharacteristicFormat_String: {
+            HAPPrecondition(HAPUTF8IsValidData(HAPNonnull(valueBytes), numValueBytes));
+            if (numValueBytes > sizeof cachedValue->bytes) {
+                HAPLogCharacteristicDebug(
+                        &logObject, characteristic, service, accessory, "Not caching value (value too long).");
+                return;
+            }
+            HAPRawBufferCopyBytes(cachedValue->bytes, HAPNonnull(valueBytes), numValueBytes);
+            cachedValue->numBytes = (uint8_t) numValueBytes;
+        } break;
+        case kHAPCharacteristicFormat_Data: {
+            if (util_base64_encoded_len(numValueBytes) > sizeof cachedValue->bytes) {
+                HAPLogCharacteristicDebug(
+                        &logObject, characteristic, service, accessory, "Not caching value (value too long).");
+                return;
+            }
+            size_t numBytes;
+            util_base64_encode(
+                    HAPNonnull(valueBytes), numValueBytes, cachedValue->bytes, sizeof cachedValue->bytes, &numBytes);
+            HAPAssert(numBytes <= sizeof cachedValue->bytes);
+            cachedValue->numBytes = (uint8_t) numBytes;
+        } break;
+        case kHAPCharacteristicFormat_TLV8: {
+            HAPFatalError();
+        }
+    }
+    cachedValue->isValid = true;
+}
+
+static void ResetStatistics(HAPAccessoryServerRef* server_) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(server->ip.storage);
+
+    for (size_t i = 0; i < server->ip.characteristicIndex.numElements; i++) {
+        HAPIPCharacteristicIndexElement* element = GetCharacteristicIndexElement(server, i);
+        HAPRawBufferZero(&element->readStatistics, sizeof element->readStatistics);
+        HAPRawBufferZero(&element->writeStatistics, sizeof element->writeStatistics);
+    }
+    for (size_t i = 0; i < server->ip.storage->numSessions; i++) {
+        HAPIPSessionDescriptor* t = (HAPIPSessionDescriptor*) &server->ip.storage->sessions[i].descriptor;
+        t->numBytesReceived = 0;
+        t->numBytesSent = 0;
+    }
+}
+
 static const HAPAccessoryServerServerEngine* _Nullable _serverEngine;
 
 static void HAPAccessoryServerInstallServerEngine(void) {
@@ -4146,7 +5573,11 @@ const HAPIPAccessoryServerTransport kHAPAccessoryServerTransport_IP = {
     .prepareStart = PrepareStart,
     .willStart = WillStart,
     .prepareStop = PrepareStop,
-    .session = { .invalidateDependentIPState = HAPSessionInvalidateDependentIPState },
+    .session = { .invalidateDependentIPState = HAPSessionInvalidateDependentIPState,
+                 .continuePairSetup = HAPSessionContinueIPPairSetup },
+    .resetStatistics = ResetStatistics,
+    .updateBridgedAccessories = UpdateBridgedAccessories,
+    .valueCache = { .update = UpdateCachedValue },
     .serverEngine = { .install = HAPAccessoryServerInstallServerEngine,
                       .uninstall = HAPAccessoryServerUninstallServerEngine,
                       .get = HAPAccessoryServerGetServerEngine }
@@ -4201,22 +5632,16 @@ bool HAPIPSessionAreEventNotificationsEnabled(
     HAPPrecondition(service);
     HAPPrecondition(accessory);
 
-    uint64_t aid = accessory->aid;
-    uint64_t iid = ((const HAPBaseCharacteristic*) characteristic)->iid;
-
-    size_t i = 0;
-    while ((i < session->numEventNotifications) &&
-           ((((HAPIPEventNotification*) &session->eventNotifications[i])->aid != aid) ||
-            (((HAPIPEventNotification*) &session->eventNotifications[i])->iid != iid))) {
-        i++;
+    size_t characteristicIndex;
+    if (!GetCharacteristicIndex(
+                HAPNonnull(session->server),
+                accessory->aid,
+                ((const HAPBaseCharacteristic*) characteristic)->iid,
+                &characteristicIndex)) {
+        return false;
     }
-    HAPAssert(
-            (i == session->numEventNotifications) ||
-            ((i < session->numEventNotifications) &&
-             (((HAPIPEventNotification*) &session->eventNotifications[i])->aid == aid) &&
-             (((HAPIPEventNotification*) &session->eventNotifications[i])->iid == iid)));
-
-    return i < session->numEventNotifications;
+    return HAPBitSetContainsBit(
+            GetSubscribedCharacteristics(session), GetEventNotificationBitSetNumBytes(session), characteristicIndex);
 }
 
 void HAPIPSessionHandleReadRequest(
@@ -4297,3 +5722,61 @@ void HAPIPSessionHandleReadRequest(
 }
 
 #endif
+
+void HAPAccessoryServerEnumerateCharacteristicStatistics(
+        HAPAccessoryServerRef* server_,
+        HAPAccessoryServerEnumerateCharacteristicStatisticsCallback callback,
+        void* _Nullable context) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(callback);
+
+    if (!server->transports.ip) {
+        return;
+    }
+
+    bool shouldContinue = true;
+    for (size_t i = 0; shouldContinue && i < server->ip.characteristicIndex.numElements; i++) {
+        const HAPIPCharacteristicIndexElement* element = GetCharacteristicIndexElement(server, i);
+        const HAPBaseCharacteristic* characteristic = element->characteristic;
+        callback(
+                context,
+                server_,
+                &(const HAPCharacteristicStatistics) { .characteristic = characteristic,
+                                                       .service = element->service,
+                                                       .accessory = element->accessory,
+                                                       .iid = characteristic->iid,
+                                                       .read = element->readStatistics,
+                                                       .write = element->writeStatistics },
+                &shouldContinue);
+    }
+}
+
+void HAPAccessoryServerEnumerateIPSessionStatistics(
+        HAPAccessoryServerRef* server_,
+        HAPAccessoryServerEnumerateIPSessionStatisticsCallback callback,
+        void* _Nullable context) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(callback);
+
+    if (!server->transports.ip) {
+        return;
+    }
+
+    bool shouldContinue = true;
+    for (size_t i = 0; shouldContinue && i < server->ip.storage->numSessions; i++) {
+        const HAPIPSessionDescriptor* t = (const HAPIPSessionDescriptor*) &server->ip.storage->sessions[i].descriptor;
+        if (!t->server) {
+            continue;
+        }
+        callback(
+                context,
+                server_,
+                &(const HAPIPSessionStatistics) { .sessionIndex = i,
+                                                  .isSecured = t->securitySession.isSecured,
+                                                  .numBytesReceived = t->numBytesReceived,
+                                                  .numBytesSent = t->numBytesSent },
+                &shouldContinue);
+    }
+}
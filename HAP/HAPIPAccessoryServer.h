@@ -54,8 +54,26 @@ struct HAPIPAccessoryServerTransport {
 
     struct {
         void (*invalidateDependentIPState)(HAPAccessoryServerRef* server_, HAPSessionRef* session);
+
+        void (*continuePairSetup)(HAPAccessoryServerRef* server_, HAPSessionRef* session);
     } session;
 
+    void (*resetStatistics)(HAPAccessoryServerRef* server);
+
+    void (*updateBridgedAccessories)(
+            HAPAccessoryServerRef* server,
+            const HAPAccessory* _Nullable const* _Nullable bridgedAccessories);
+
+    struct {
+        void (*update)(
+                HAPAccessoryServerRef* server,
+                const HAPCharacteristic* characteristic,
+                const HAPService* service,
+                const HAPAccessory* accessory,
+                const void* _Nullable valueBytes,
+                size_t numValueBytes);
+    } valueCache;
+
     struct {
         void (*install)(void);
 
@@ -123,7 +141,10 @@ HAP_ENUM_BEGIN(uint8_t, HAPIPSessionState) { /** Accessory server session is idl
                                              kHAPIPSessionState_Reading,
 
                                              /** Accessory server session is writing. */
-                                             kHAPIPSessionState_Writing
+                                             kHAPIPSessionState_Writing,
+
+                                             /** Accessory server session is waiting until its response is ready. */
+                                             kHAPIPSessionState_Waiting
 } HAP_ENUM_END(uint8_t, HAPIPSessionState);
 
 /**
@@ -143,19 +164,120 @@ HAP_ENUM_BEGIN(uint8_t, HAPIPAccessoryServerContentType) { /** Unknown HTTP/1.1
 } HAP_ENUM_END(uint8_t, HAPIPAccessoryServerContentType);
 
 /**
- * IP specific event notification state.
+ * Digest of the value of a characteristic that was last delivered in an event notification on an IP session.
+ *
+ * - Only maintained for characteristics with the ip.suppressUnchangedEventNotifications property.
+ *
+ * - Values of up to 8 bytes are stored verbatim. This includes the values of all numeric formats.
+ *   Longer values are represented by their length and their 64-bit FNV-1a hash.
+ *
+ * - Occupies kHAPIPEventNotificationValueDigest_NumElements elements of the event notification state of a session.
+ */
+typedef struct {
+    /** Value, or 64-bit FNV-1a hash of the value if isHashed is set. */
+    uint8_t bytes[sizeof(uint64_t)];
+
+    /** Length of the value. */
+    uint32_t numBytes;
+
+    /** Flag indicating whether bytes holds the hash of the value instead of the value. */
+    bool isHashed : 1;
+
+    /** Flag indicating whether the digest describes the value that was last delivered on this session. */
+    bool isValid : 1;
+} HAPIPEventNotificationValueDigest;
+
+/**
+ * Number of HAPIPEventNotificationRef elements that are used per value digest.
+ */
+#define kHAPIPEventNotificationValueDigest_NumElements ((size_t) 2)
+HAP_STATIC_ASSERT(
+        kHAPIPEventNotificationValueDigest_NumElements * sizeof(HAPIPEventNotificationRef) >=
+                sizeof(HAPIPEventNotificationValueDigest),
+        value_digest);
+
+/**
+ * Element of the IP characteristic index.
+ *
+ * - The index contains all characteristics that are supported over IP, sorted by accessory instance ID and
+ *   characteristic instance ID. The position of a characteristic in the index is its characteristic index.
+ *   Event notification state of IP sessions is stored in bit sets that are addressed by characteristic index.
+ */
+typedef struct {
+    /** Characteristic. */
+    const HAPCharacteristic* characteristic;
+
+    /** The service that contains the characteristic. */
+    const HAPService* service;
+
+    /** The accessory that provides the service. */
+    const HAPAccessory* accessory;
+
+    /** Index of the value digest of the characteristic in the event notification state of IP sessions. */
+    uint32_t valueDigestIndex;
+
+    /** Index of the cached value of the characteristic in the IP characteristic value cache. */
+    uint32_t valueCacheIndex;
+
+    /** Flag indicating whether the value digest of the characteristic is tracked. */
+    bool hasValueDigest : 1;
+
+    /** Flag indicating whether the value of the characteristic is cached. */
+    bool hasValueCache : 1;
+
+    /** Timing of the handleRead callback. */
+    HAPCharacteristicCallbackStatistics readStatistics;
+
+    /** Timing of the handleWrite callback. */
+    HAPCharacteristicCallbackStatistics writeStatistics;
+} HAPIPCharacteristicIndexElement;
+HAP_STATIC_ASSERT(
+        sizeof(HAPIPCharacteristicIndexElementRef) >= sizeof(HAPIPCharacteristicIndexElement),
+        characteristic_index_element);
+
+/**
+ * Element of the IP characteristic value cache.
+ *
+ * - Values are stored in the same representation as in a HAPIPReadContext.
+ *   String values are stored as is, data values are stored base64 encoded.
  */
 typedef struct {
-    /** Accessory instance ID. */
-    uint64_t aid;
+    /** Value. */
+    union {
+        /** Int value. */
+        int32_t intValue;
+
+        /** Bool and UInt value. */
+        uint64_t unsignedIntValue;
+
+        /** Float value. */
+        float floatValue;
+    } value;
+
+    /** String value, or base64 encoded data value. Not NULL-terminated. */
+    char bytes[kHAPIPCharacteristicValueCache_MaxValueBytes];
 
-    /** Characteristic instance ID. */
-    uint64_t iid;
+    /** Length of string value. */
+    uint8_t numBytes;
 
-    /** Flag indicating whether an event has been raised for the given characteristic in the given accessory. */
-    bool flag;
-} HAPIPEventNotification;
-HAP_STATIC_ASSERT(sizeof(HAPIPEventNotificationRef) >= sizeof(HAPIPEventNotification), event_notification);
+    /** Flag indicating whether the cached value is valid. */
+    bool isValid;
+} HAPIPCharacteristicValueCacheElement;
+HAP_STATIC_ASSERT(
+        sizeof(HAPIPCharacteristicValueCacheElementRef) >= sizeof(HAPIPCharacteristicValueCacheElement),
+        value_cache_element);
+HAP_STATIC_ASSERT(kHAPIPCharacteristicValueCache_MaxValueBytes <= UINT8_MAX, value_cache_max_value_bytes);
+
+/**
+ * Intrusive list of open IP sessions, ordered by time of last activity.
+ */
+typedef struct {
+    /** Least recently active session. */
+    HAPIPSession* _Nullable head;
+
+    /** Most recently active session. */
+    HAPIPSession* _Nullable tail;
+} HAPIPSessionActivityList;
 
 /**
  * IP specific accessory server session descriptor.
@@ -176,6 +298,21 @@ typedef struct {
     /** Time stamp of last activity on this session. */
     HAPTime stamp;
 
+    /** Number of bytes received on this session. */
+    uint64_t numBytesReceived;
+
+    /** Number of bytes sent on this session. */
+    uint64_t numBytesSent;
+
+    /** Previous (less recently active) session in the session activity list that contains this session. */
+    HAPIPSession* _Nullable prevActiveSession;
+
+    /** Next (more recently active) session in the session activity list that contains this session. */
+    HAPIPSession* _Nullable nextActiveSession;
+
+    /** Flag indicating whether this session is filed as secured in the session activity lists. */
+    bool isFiledAsSecured;
+
     /** Security session. */
     HAPIPSecuritySession securitySession;
 
@@ -284,12 +421,15 @@ typedef struct {
     HAPIPAccessoryServerContentType httpContentType;
 
     /**
-     * Array of event notification contexts on this session.
+     * Event notification state of this session.
+     *
+     * - Bit set of subscribed characteristics, followed by the bit set of characteristics with pending events,
+     *   followed by the value digests. Bit sets are addressed by characteristic index.
      */
     HAPIPEventNotificationRef* _Nullable eventNotifications;
 
     /**
-     * The maximum number of events this session can handle.
+     * The number of event notification elements of this session.
      */
     size_t maxEventNotifications;
 
@@ -14,6 +14,60 @@ bool HAPIPCharacteristicIsSupported(const HAPCharacteristic* characteristic_) {
     return !HAPUUIDAreEqual(characteristic->characteristicType, &kHAPCharacteristicType_ServiceSignature);
 }
 
+/**
+ * Determines whether a characteristic value describes a momentary occurrence rather than a persistent state.
+ *
+ * - Such values may legitimately repeat, so identical consecutive values must not be treated as unchanged.
+ *
+ * @param      characteristic       Characteristic.
+ *
+ * @return true                     If the characteristic value is momentary.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool HasMomentaryValue(const HAPBaseCharacteristic* characteristic) {
+    HAPPrecondition(characteristic);
+
+    // Every Programmable Switch Event notification represents a separate button press.
+    // See HomeKit Accessory Protocol Specification R14
+    // Section 9.75 Programmable Switch Event
+    return HAPUUIDAreEqual(characteristic->characteristicType, &kHAPCharacteristicType_ProgrammableSwitchEvent);
+}
+
+HAP_RESULT_USE_CHECK
+bool HAPIPCharacteristicSuppressesUnchangedEventNotifications(const HAPCharacteristic* characteristic_) {
+    HAPPrecondition(characteristic_);
+    const HAPBaseCharacteristic* characteristic = characteristic_;
+
+    if (!characteristic->properties.ip.suppressUnchangedEventNotifications) {
+        return false;
+    }
+
+    return !HasMomentaryValue(characteristic);
+}
+
+HAP_RESULT_USE_CHECK
+bool HAPIPCharacteristicIsCacheable(const HAPCharacteristic* characteristic_) {
+    HAPPrecondition(characteristic_);
+    const HAPBaseCharacteristic* characteristic = characteristic_;
+
+    if (!characteristic->properties.ip.cacheable || !characteristic->properties.readable) {
+        return false;
+    }
+
+    // Reads of control points depend on the preceding write.
+    if (characteristic->properties.ip.controlPoint || characteristic->properties.ip.supportsWriteResponse) {
+        return false;
+    }
+
+    // TLV8 values are typically too large to be cached and are often generated per request.
+    if (characteristic->format == kHAPCharacteristicFormat_TLV8) {
+        return false;
+    }
+
+    return !HasMomentaryValue(characteristic);
+}
+
 HAP_RESULT_USE_CHECK
 size_t HAPCharacteristicGetNumEnabledProperties(const HAPCharacteristic* characteristic_) {
     HAPPrecondition(characteristic_);
@@ -30,6 +30,30 @@ extern "C" {
 HAP_RESULT_USE_CHECK
 bool HAPIPCharacteristicIsSupported(const HAPCharacteristic* characteristic);
 
+/**
+ * Returns whether unchanged event notifications of a characteristic are suppressed over IP (Ethernet / Wi-Fi).
+ *
+ * - Suppression requires tracking the value that was last delivered per session (value digest).
+ *
+ * @param      characteristic       Characteristic.
+ *
+ * @return true                     If unchanged event notifications are suppressed.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+bool HAPIPCharacteristicSuppressesUnchangedEventNotifications(const HAPCharacteristic* characteristic);
+
+/**
+ * Returns whether the value of a characteristic is cached by the IP accessory server.
+ *
+ * @param      characteristic       Characteristic.
+ *
+ * @return true                     If the value of the characteristic is cached.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+bool HAPIPCharacteristicIsCacheable(const HAPCharacteristic* characteristic);
+
 /**
  * Returns the number of enabled properties of a characteristic.
  *
@@ -53,58 +53,189 @@ static const HAPLogObject logObject = { .subsystem = kHAP_LogSubsystem, .categor
 /** Number of TXT Record keys for _hap service. */
 #define kHAPTXTRecordKey_NumKeys (9)
 
+HAP_STATIC_ASSERT(
+        sizeof((HAPIPServiceDiscoveryTXTRecordCache*) NULL)->setupHashBytes ==
+                util_base64_encoded_len(sizeof(HAPAccessorySetupSetupHash)) + 1,
+        HAPIPServiceDiscoveryTXTRecordCache_SetupHash);
+
+/**
+ * Stores a TXT record value in the TXT record cache.
+ *
+ * @param      key                  TXT record key.
+ * @param[in,out] cachedBytes       Cached NULL-terminated value.
+ * @param      maxCachedBytes       Capacity of the cached value buffer.
+ * @param      bytes                NULL-terminated value.
+ *
+ * @return true                     If the cached value changed.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool UpdateTXTRecordValue(const char* key, char* cachedBytes, size_t maxCachedBytes, const char* bytes) {
+    HAPPrecondition(key);
+    HAPPrecondition(cachedBytes);
+    HAPPrecondition(bytes);
+
+    size_t numBytes = HAPStringGetNumBytes(bytes);
+    HAPPrecondition(numBytes < maxCachedBytes);
+    if (HAPStringAreEqual(cachedBytes, bytes)) {
+        return false;
+    }
+    HAPLogDebug(&logObject, "TXT record %s changed: %s.", key, bytes);
+    HAPRawBufferCopyBytes(cachedBytes, bytes, numBytes + 1);
+    return true;
+}
+
+/**
+ * Loads invalidated values of the _hap service TXT record cache.
+ *
+ * @param      server               Accessory server.
+ *
+ * @return true                     If at least one cached value changed.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool LoadHAPServiceTXTRecordCache(HAPAccessoryServerRef* server_) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPIPServiceDiscoveryTXTRecordCache* cache = &server->ip.txtRecordCache;
+
+    HAPError err;
+
+    bool changed = false;
+
+    if (!cache->isValid) {
+        // Configuration number.
+        uint16_t configurationNumber;
+        err = HAPAccessoryServerGetCN(server->platform.keyValueStore, &configurationNumber);
+        if (err) {
+            HAPAssert(err == kHAPError_Unknown);
+            HAPFatalError();
+        }
+        char configurationNumberBytes[kHAPUInt16_MaxDescriptionBytes];
+        err = HAPUInt64GetDescription(configurationNumber, configurationNumberBytes, sizeof configurationNumberBytes);
+        HAPAssert(!err);
+        changed |= UpdateTXTRecordValue(
+                kHAPTXTRecordKey_ConfigurationNumber,
+                cache->configurationNumberBytes,
+                sizeof cache->configurationNumberBytes,
+                configurationNumberBytes);
+
+        // Pairing Feature flags.
+        uint8_t pairingFeatureFlags = HAPAccessoryServerGetPairingFeatureFlags(server_);
+        char pairingFeatureFlagsBytes[kHAPUInt8_MaxDescriptionBytes];
+        err = HAPUInt64GetDescription(pairingFeatureFlags, pairingFeatureFlagsBytes, sizeof pairingFeatureFlagsBytes);
+        HAPAssert(!err);
+        changed |= UpdateTXTRecordValue(
+                kHAPTXTRecordKey_PairingFeatureFlags,
+                cache->pairingFeatureFlagsBytes,
+                sizeof cache->pairingFeatureFlagsBytes,
+                pairingFeatureFlagsBytes);
+
+        // Device ID.
+        HAPDeviceIDString deviceIDString;
+        err = HAPDeviceIDGetAsString(server->platform.keyValueStore, &deviceIDString);
+        if (err) {
+            HAPAssert(err == kHAPError_Unknown);
+            HAPFatalError();
+        }
+        changed |= UpdateTXTRecordValue(
+                kHAPTXTRecordKey_DeviceID,
+                cache->deviceIDString.stringValue,
+                sizeof cache->deviceIDString.stringValue,
+                deviceIDString.stringValue);
+
+        // Category.
+        char categoryBytes[kHAPUInt16_MaxDescriptionBytes];
+        err = HAPUInt64GetDescription(server->primaryAccessory->category, categoryBytes, sizeof categoryBytes);
+        HAPAssert(!err);
+        changed |= UpdateTXTRecordValue(
+                kHAPTXTRecordKey_Category, cache->categoryBytes, sizeof cache->categoryBytes, categoryBytes);
+
+        // Setup hash. Optional.
+        HAPSetupID setupID;
+        bool hasSetupID = false;
+        HAPPlatformAccessorySetupLoadSetupID(server->platform.accessorySetup, &hasSetupID, &setupID);
+        char setupHashBytes[sizeof cache->setupHashBytes];
+        if (hasSetupID) {
+            // Get raw setup hash from setup ID.
+            HAPAccessorySetupSetupHash setupHash;
+            HAPAccessorySetupGetSetupHash(&setupHash, &setupID, &deviceIDString);
+
+            // Base64 encode.
+            size_t numSetupHashBytes;
+            util_base64_encode(
+                    setupHash.bytes, sizeof setupHash.bytes, setupHashBytes, sizeof setupHashBytes, &numSetupHashBytes);
+            HAPAssert(numSetupHashBytes == sizeof setupHashBytes - 1);
+            setupHashBytes[sizeof setupHashBytes - 1] = '\0';
+        } else {
+            setupHashBytes[0] = '\0';
+        }
+        changed |= UpdateTXTRecordValue(
+                kHAPTXTRecordKey_SetupHash, cache->setupHashBytes, sizeof cache->setupHashBytes, setupHashBytes);
+
+        cache->isValid = true;
+        cache->areStatusFlagsValid = false;
+    }
+
+    if (!cache->areStatusFlagsValid) {
+        // Status flags.
+        uint8_t statusFlags = HAPAccessoryServerGetStatusFlags(server_);
+        char statusFlagsBytes[kHAPUInt8_MaxDescriptionBytes];
+        err = HAPUInt64GetDescription(statusFlags, statusFlagsBytes, sizeof statusFlagsBytes);
+        HAPAssert(!err);
+        changed |= UpdateTXTRecordValue(
+                kHAPTXTRecordKey_StatusFlags,
+                cache->statusFlagsBytes,
+                sizeof cache->statusFlagsBytes,
+                statusFlagsBytes);
+
+        cache->areStatusFlagsValid = true;
+    }
+
+    return changed;
+}
+
 void HAPIPServiceDiscoverySetHAPService(HAPAccessoryServerRef* server_) {
     HAPPrecondition(server_);
     HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
     HAPPrecondition(
             !server->ip.discoverableService || server->ip.discoverableService == kHAPIPServiceDiscoveryType_HAP);
 
-    HAPError err;
-
     // See HomeKit Accessory Protocol Specification R14
     // Section 6.4 Discovery
 
+    bool changed = LoadHAPServiceTXTRecordCache(server_);
+    if (server->ip.discoverableService && !changed) {
+        HAPLogDebug(&logObject, "%s service TXT records are unchanged.", kServiceDiscoveryProtocol_HAP);
+        return;
+    }
+    const HAPIPServiceDiscoveryTXTRecordCache* cache = &server->ip.txtRecordCache;
+
     HAPPlatformServiceDiscoveryTXTRecord txtRecords[kHAPTXTRecordKey_NumKeys];
     size_t numTXTRecords = 0;
 
     // Configuration number.
-    uint16_t configurationNumber;
-    err = HAPAccessoryServerGetCN(server->platform.keyValueStore, &configurationNumber);
-    if (err) {
-        HAPAssert(err == kHAPError_Unknown);
-        HAPFatalError();
-    }
-    char configurationNumberBytes[kHAPUInt16_MaxDescriptionBytes];
-    err = HAPUInt64GetDescription(configurationNumber, configurationNumberBytes, sizeof configurationNumberBytes);
-    HAPAssert(!err);
     HAPAssert(numTXTRecords < HAPArrayCount(txtRecords));
     txtRecords[numTXTRecords++] = (HAPPlatformServiceDiscoveryTXTRecord) {
         .key = kHAPTXTRecordKey_ConfigurationNumber,
-        .value = { .bytes = configurationNumberBytes, .numBytes = HAPStringGetNumBytes(configurationNumberBytes) }
+        .value = { .bytes = cache->configurationNumberBytes,
+                   .numBytes = HAPStringGetNumBytes(cache->configurationNumberBytes) }
     };
 
     // Pairing Feature flags.
-    uint8_t pairingFeatureFlags = HAPAccessoryServerGetPairingFeatureFlags(server_);
-    char pairingFeatureFlagsBytes[kHAPUInt8_MaxDescriptionBytes];
-    err = HAPUInt64GetDescription(pairingFeatureFlags, pairingFeatureFlagsBytes, sizeof pairingFeatureFlagsBytes);
-    HAPAssert(!err);
     HAPAssert(numTXTRecords < HAPArrayCount(txtRecords));
     txtRecords[numTXTRecords++] = (HAPPlatformServiceDiscoveryTXTRecord) {
         .key = kHAPTXTRecordKey_PairingFeatureFlags,
-        .value = { .bytes = pairingFeatureFlagsBytes, .numBytes = HAPStringGetNumBytes(pairingFeatureFlagsBytes) }
+        .value = { .bytes = cache->pairingFeatureFlagsBytes,
+                   .numBytes = HAPStringGetNumBytes(cache->pairingFeatureFlagsBytes) }
     };
 
     // Device ID.
-    HAPDeviceIDString deviceIDString;
-    err = HAPDeviceIDGetAsString(server->platform.keyValueStore, &deviceIDString);
-    if (err) {
-        HAPAssert(err == kHAPError_Unknown);
-        HAPFatalError();
-    }
     HAPAssert(numTXTRecords < HAPArrayCount(txtRecords));
     txtRecords[numTXTRecords++] = (HAPPlatformServiceDiscoveryTXTRecord) {
         .key = kHAPTXTRecordKey_DeviceID,
-        .value = { .bytes = deviceIDString.stringValue, .numBytes = HAPStringGetNumBytes(deviceIDString.stringValue) }
+        .value = { .bytes = cache->deviceIDString.stringValue,
+                   .numBytes = HAPStringGetNumBytes(cache->deviceIDString.stringValue) }
     };
 
     // Model.
@@ -131,48 +262,25 @@ void HAPIPServiceDiscoverySetHAPService(HAPAccessoryServerRef* server_) {
                                                                 .numBytes = HAPStringGetNumBytes(stateNumberBytes) } };
 
     // Status flags.
-    uint8_t statusFlags = HAPAccessoryServerGetStatusFlags(server_);
-    char statusFlagsBytes[kHAPUInt8_MaxDescriptionBytes];
-    err = HAPUInt64GetDescription(statusFlags, statusFlagsBytes, sizeof statusFlagsBytes);
-    HAPAssert(!err);
     HAPAssert(numTXTRecords < HAPArrayCount(txtRecords));
-    txtRecords[numTXTRecords++] =
-            (HAPPlatformServiceDiscoveryTXTRecord) { .key = kHAPTXTRecordKey_StatusFlags,
-                                                     .value = { .bytes = statusFlagsBytes,
-                                                                .numBytes = HAPStringGetNumBytes(statusFlagsBytes) } };
+    txtRecords[numTXTRecords++] = (HAPPlatformServiceDiscoveryTXTRecord) {
+        .key = kHAPTXTRecordKey_StatusFlags,
+        .value = { .bytes = cache->statusFlagsBytes, .numBytes = HAPStringGetNumBytes(cache->statusFlagsBytes) }
+    };
 
     // Category.
-    char categoryBytes[kHAPUInt16_MaxDescriptionBytes];
-    err = HAPUInt64GetDescription(server->primaryAccessory->category, categoryBytes, sizeof categoryBytes);
-    HAPAssert(!err);
     HAPAssert(numTXTRecords < HAPArrayCount(txtRecords));
-    txtRecords[numTXTRecords++] =
-            (HAPPlatformServiceDiscoveryTXTRecord) { .key = kHAPTXTRecordKey_Category,
-                                                     .value = { .bytes = categoryBytes,
-                                                                .numBytes = HAPStringGetNumBytes(categoryBytes) } };
+    txtRecords[numTXTRecords++] = (HAPPlatformServiceDiscoveryTXTRecord) {
+        .key = kHAPTXTRecordKey_Category,
+        .value = { .bytes = cache->categoryBytes, .numBytes = HAPStringGetNumBytes(cache->categoryBytes) }
+    };
 
     // Setup hash. Optional.
-    HAPSetupID setupID;
-    bool hasSetupID = false;
-    HAPPlatformAccessorySetupLoadSetupID(server->platform.accessorySetup, &hasSetupID, &setupID);
-    char setupHashBytes[util_base64_encoded_len(sizeof(HAPAccessorySetupSetupHash)) + 1];
-    if (hasSetupID) {
-        // Get raw setup hash from setup ID.
-        HAPAccessorySetupSetupHash setupHash;
-        HAPAccessorySetupGetSetupHash(&setupHash, &setupID, &deviceIDString);
-
-        // Base64 encode.
-        size_t numSetupHashBytes;
-        util_base64_encode(
-                setupHash.bytes, sizeof setupHash.bytes, setupHashBytes, sizeof setupHashBytes, &numSetupHashBytes);
-        HAPAssert(numSetupHashBytes == sizeof setupHashBytes - 1);
-        setupHashBytes[sizeof setupHashBytes - 1] = '\0';
-
-        // Append TXT record.
+    if (cache->setupHashBytes[0]) {
         HAPAssert(numTXTRecords < HAPArrayCount(txtRecords));
         txtRecords[numTXTRecords++] = (HAPPlatformServiceDiscoveryTXTRecord) {
             .key = kHAPTXTRecordKey_SetupHash,
-            .value = { .bytes = setupHashBytes, .numBytes = HAPStringGetNumBytes(setupHashBytes) }
+            .value = { .bytes = cache->setupHashBytes, .numBytes = HAPStringGetNumBytes(cache->setupHashBytes) }
         };
     }
 
@@ -196,6 +304,20 @@ void HAPIPServiceDiscoverySetHAPService(HAPAccessoryServerRef* server_) {
     }
 }
 
+void HAPIPServiceDiscoveryInvalidateHAPServiceStatusFlags(HAPAccessoryServerRef* server_) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+
+    server->ip.txtRecordCache.areStatusFlagsValid = false;
+}
+
+void HAPIPServiceDiscoveryInvalidateHAPService(HAPAccessoryServerRef* server_) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+
+    server->ip.txtRecordCache.isValid = false;
+}
+
 /**
  * _mfi-config service.
  */
@@ -326,6 +448,7 @@ void HAPIPServiceDiscoveryStop(HAPAccessoryServerRef* server_) {
         HAPPlatformServiceDiscoveryStop(HAPNonnull(server->platform.ip.serviceDiscovery));
         server->ip.discoverableService = kHAPIPServiceDiscoveryType_None;
     }
+    HAPRawBufferZero(&server->ip.txtRecordCache, sizeof server->ip.txtRecordCache);
 }
 
 #endif
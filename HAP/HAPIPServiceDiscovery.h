@@ -36,15 +36,68 @@ HAP_ENUM_BEGIN(uint8_t, HAPIPServiceDiscoveryType) { /**
                                                      kHAPIPServiceDiscoveryType_MFiConfig
 } HAP_ENUM_END(uint8_t, HAPIPServiceDiscoveryType);
 
+/**
+ * Pre-encoded TXT record values of the _hap service.
+ *
+ * - Values are loaded when the _hap service is registered and are kept until service discovery is stopped.
+ *   Only the status flags are reloaded while the service is registered, after they have been invalidated.
+ */
+typedef struct {
+    /** Configuration number. NULL-terminated. */
+    char configurationNumberBytes[kHAPUInt16_MaxDescriptionBytes];
+
+    /** Pairing Feature flags. NULL-terminated. */
+    char pairingFeatureFlagsBytes[kHAPUInt8_MaxDescriptionBytes];
+
+    /** Device ID. */
+    HAPDeviceIDString deviceIDString;
+
+    /** Status flags. NULL-terminated. */
+    char statusFlagsBytes[kHAPUInt8_MaxDescriptionBytes];
+
+    /** Accessory Category Identifier. NULL-terminated. */
+    char categoryBytes[kHAPUInt16_MaxDescriptionBytes];
+
+    /** Base64 encoded setup hash. NULL-terminated. Empty if no setup ID is available. */
+    char setupHashBytes[8 + 1];
+
+    /** Whether the cached values are valid. */
+    bool isValid : 1;
+
+    /** Whether the cached status flags are valid. */
+    bool areStatusFlagsValid : 1;
+} HAPIPServiceDiscoveryTXTRecordCache;
+
 /**
  * Registers or updates the Bonjour records for the _hap service.
  *
  * - Only one service may be active at a time. To switch services, first stop Bonjour service discovery.
  *
+ * - TXT record values are taken from the TXT record cache. If the service is already registered, the TXT records are
+ *   only updated if at least one value changed.
+ *
  * @param      server               Accessory server.
  */
 void HAPIPServiceDiscoverySetHAPService(HAPAccessoryServerRef* server);
 
+/**
+ * Invalidates the cached status flags of the _hap service, e.g., after the pairing state changed.
+ *
+ * - The status flags are reloaded by the next call to HAPIPServiceDiscoverySetHAPService.
+ *
+ * @param      server               Accessory server.
+ */
+void HAPIPServiceDiscoveryInvalidateHAPServiceStatusFlags(HAPAccessoryServerRef* server);
+
+/**
+ * Invalidates all cached TXT record values of the _hap service, e.g., after the configuration number changed.
+ *
+ * - The values are reloaded by the next call to HAPIPServiceDiscoverySetHAPService.
+ *
+ * @param      server               Accessory server.
+ */
+void HAPIPServiceDiscoveryInvalidateHAPService(HAPAccessoryServerRef* server);
+
 /**
  * Registers or updates the Bonjour records for the _mfi-config service.
  *
@@ -57,6 +110,8 @@ void HAPIPServiceDiscoverySetMFiConfigService(HAPAccessoryServerRef* server);
 /**
  * Stops Bonjour service discovery.
  *
+ * - The TXT record cache of the _hap service is invalidated.
+ *
  * @param      server               Accessory server.
  */
 void HAPIPServiceDiscoveryStop(HAPAccessoryServerRef* server);
@@ -199,6 +199,99 @@ HAPError HAPJSONUtilsSkipValue(struct util_json_reader* reader, const char* byte
     return kHAPError_None;
 }
 
+HAP_RESULT_USE_CHECK
+HAPError HAPJSONUtilsSkipIndexedValue(struct util_json_index* index) {
+    HAPPrecondition(index);
+
+    Stack stack;
+    StackCreate(&stack);
+
+    bool skipped_value = false;
+
+    util_json_index_read(index);
+    do {
+        HAPAssert(!skipped_value);
+        switch (index->state) {
+            case util_JSON_READER_STATE_BEGINNING_OBJECT: {
+                util_json_index_read(index);
+                if (index->state != util_JSON_READER_STATE_COMPLETED_OBJECT) {
+                    if (index->state != util_JSON_READER_STATE_COMPLETED_STRING) {
+                        return kHAPError_InvalidData;
+                    }
+                    util_json_index_read(index);
+                    if (index->state != util_JSON_READER_STATE_AFTER_NAME_SEPARATOR) {
+                        return kHAPError_InvalidData;
+                    }
+                    util_json_index_read(index);
+                    if (StackIsFull(&stack)) {
+                        return kHAPError_OutOfResources;
+                    }
+                    StackPush(&stack, SKIPPING_OBJECT_MEMBER_VALUE);
+                } else {
+                    skipped_value = true;
+                }
+            } break;
+            case util_JSON_READER_STATE_BEGINNING_ARRAY: {
+                util_json_index_read(index);
+                if (index->state != util_JSON_READER_STATE_COMPLETED_ARRAY) {
+                    if (StackIsFull(&stack)) {
+                        return kHAPError_OutOfResources;
+                    }
+                    StackPush(&stack, SKIPPING_ARRAY_VALUE);
+                } else {
+                    skipped_value = true;
+                }
+            } break;
+            case util_JSON_READER_STATE_COMPLETED_NUMBER:
+            case util_JSON_READER_STATE_COMPLETED_STRING:
+            case util_JSON_READER_STATE_COMPLETED_FALSE:
+            case util_JSON_READER_STATE_COMPLETED_TRUE:
+            case util_JSON_READER_STATE_COMPLETED_NULL: {
+                skipped_value = true;
+            } break;
+            default: {
+                return kHAPError_InvalidData;
+            }
+        }
+        while (!StackIsEmpty(&stack) && skipped_value) {
+            skipped_value = false;
+            util_json_index_read(index);
+            if (StackTop(&stack) == SKIPPING_OBJECT_MEMBER_VALUE) {
+                if (index->state != util_JSON_READER_STATE_COMPLETED_OBJECT) {
+                    if (index->state != util_JSON_READER_STATE_AFTER_VALUE_SEPARATOR) {
+                        return kHAPError_InvalidData;
+                    }
+                    util_json_index_read(index);
+                    if (index->state != util_JSON_READER_STATE_COMPLETED_STRING) {
+                        return kHAPError_InvalidData;
+                    }
+                    util_json_index_read(index);
+                    if (index->state != util_JSON_READER_STATE_AFTER_NAME_SEPARATOR) {
+                        return kHAPError_InvalidData;
+                    }
+                    util_json_index_read(index);
+                } else {
+                    StackPop(&stack);
+                    skipped_value = true;
+                }
+            } else {
+                HAPAssert(StackTop(&stack) == SKIPPING_ARRAY_VALUE);
+                if (index->state != util_JSON_READER_STATE_COMPLETED_ARRAY) {
+                    if (index->state != util_JSON_READER_STATE_AFTER_VALUE_SEPARATOR) {
+                        return kHAPError_InvalidData;
+                    }
+                    util_json_index_read(index);
+                } else {
+                    StackPop(&stack);
+                    skipped_value = true;
+                }
+            }
+        }
+    } while (!StackIsEmpty(&stack));
+    HAPAssert(skipped_value);
+    return kHAPError_None;
+}
+
 HAP_RESULT_USE_CHECK
 size_t HAPJSONUtilsGetFloatNumDescriptionBytes(float value) {
     HAPError err;
@@ -13,6 +13,7 @@ extern "C" {
 
 #include "HAP+Internal.h"
 
+#include "util_json_index.h"
 #include "util_json_reader.h"
 
 #if __has_feature(nullability)
@@ -34,6 +35,20 @@ extern "C" {
 HAP_RESULT_USE_CHECK
 HAPError HAPJSONUtilsSkipValue(struct util_json_reader* reader, const char* bytes, size_t maxBytes, size_t* numBytes);
 
+/**
+ * Skips over a JSON value (object, array, string, number, 'true', 'false', or 'null') using a structural index.
+ *
+ * - Accepts and rejects the same input as HAPJSONUtilsSkipValue.
+ *
+ * @param      index                Index used to skip over a JSON value.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidData    If a JSON syntax error was encountered.
+ * @return kHAPError_OutOfResources If the JSON value is nested too deeply.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPJSONUtilsSkipIndexedValue(struct util_json_index* index);
+
 /**
  * Determines the space needed by the string representation of a float in JSON format.
  *
@@ -13,6 +13,8 @@ void HAPMFiHWAuthCreate(HAPMFiHWAuth* mfiHWAuth, HAPPlatformMFiHWAuthRef platfor
 
     mfiHWAuth->platformMFiHWAuth = platformMFiHWAuth;
     mfiHWAuth->powerOffTimer = 0;
+    mfiHWAuth->requests = NULL;
+    mfiHWAuth->requestTimer = 0;
 }
 
 void HAPMFiHWAuthRelease(HAPMFiHWAuth* mfiHWAuth) {
@@ -27,6 +29,13 @@ void HAPMFiHWAuthRelease(HAPMFiHWAuth* mfiHWAuth) {
         HAPPlatformTimerDeregister(mfiHWAuth->powerOffTimer);
         mfiHWAuth->powerOffTimer = 0;
     }
+    if (mfiHWAuth->requestTimer) {
+        HAPPlatformTimerDeregister(mfiHWAuth->requestTimer);
+        mfiHWAuth->requestTimer = 0;
+    }
+    if (mfiHWAuth->requests) {
+        HAPLog(&logObject, "Deinitializing Apple Authentication Coprocessor with pending requests.");
+    }
 
     HAPRawBufferZero(mfiHWAuth, sizeof *mfiHWAuth);
 }
@@ -43,6 +52,11 @@ bool HAPMFiHWAuthIsSafeToRelease(HAPMFiHWAuth* mfiHWAuth) {
         return false;
     }
 
+    // Asynchronous requests are being processed.
+    if (mfiHWAuth->requests) {
+        return false;
+    }
+
     HAPError err;
 
     // Read Authentication Protocol Version.
@@ -173,9 +187,6 @@ static HAPError HAPMFiHWAuthEnable(HAPMFiHWAuth* mfiHWAuth) {
 #define HAP_MFI_HW_AUTH_READ_OR_RETURN_FALSE(mfiHWAuth, registerAddress, bytes, numBytes) \
     HAP_MFI_HW_AUTH_READ_OR_RETURN_FAIL_VALUE(mfiHWAuth, registerAddress, bytes, numBytes, false)
 
-#define HAP_MFI_HW_AUTH_READ_OR_RETURN_ERROR(mfiHWAuth, registerAddress, bytes, numBytes) \
-    HAP_MFI_HW_AUTH_READ_OR_RETURN_FAIL_VALUE(mfiHWAuth, registerAddress, bytes, numBytes, kHAPError_Unknown)
-
 #define HAP_MFI_HW_AUTH_WRITE_OR_RETURN_FAIL_VALUE(mfiHWAuth, bytes, numBytes, failValue) \
     do { \
         err = HAPPlatformMFiHWAuthWrite(HAPNonnull((mfiHWAuth)->platformMFiHWAuth), (bytes), (numBytes)); \
@@ -188,15 +199,18 @@ static HAPError HAPMFiHWAuthEnable(HAPMFiHWAuth* mfiHWAuth) {
 #define HAP_MFI_HW_AUTH_WRITE_OR_RETURN_FALSE(mfiHWAuth, bytes, numBytes) \
     HAP_MFI_HW_AUTH_WRITE_OR_RETURN_FAIL_VALUE(mfiHWAuth, bytes, numBytes, false)
 
-#define HAP_MFI_HW_AUTH_WRITE_OR_RETURN_ERROR(mfiHWAuth, bytes, numBytes) \
-    HAP_MFI_HW_AUTH_WRITE_OR_RETURN_FAIL_VALUE(mfiHWAuth, bytes, numBytes, kHAPError_Unknown)
-
 HAP_RESULT_USE_CHECK
 bool HAPMFiHWAuthIsAvailable(HAPMFiHWAuth* mfiHWAuth) {
     HAPPrecondition(mfiHWAuth);
 
     HAPError err;
 
+    // Do not interleave register accesses with asynchronous requests that are being processed.
+    // Requests fail on their own if the Apple Authentication Coprocessor turns out to be unavailable.
+    if (mfiHWAuth->requests) {
+        return true;
+    }
+
     // Enable Apple Authentication Coprocessor.
     err = HAPMFiHWAuthEnable(mfiHWAuth);
     if (err) {
@@ -308,262 +322,634 @@ bool HAPMFiHWAuthIsAvailable(HAPMFiHWAuth* mfiHWAuth) {
     return true;
 }
 
+/**
+ * Request types.
+ */
+HAP_ENUM_BEGIN(uint8_t, HAPMFiHWAuthRequestType) {
+    /** Read MFi certificate. */
+    kHAPMFiHWAuthRequestType_CopyCertificate = 1,
+
+    /** Generate signature. */
+    kHAPMFiHWAuthRequestType_CreateSignature
+} HAP_ENUM_END(uint8_t, HAPMFiHWAuthRequestType);
+
+/**
+ * Request processing steps. Every step performs at most one transfer.
+ */
+HAP_ENUM_BEGIN(uint8_t, HAPMFiHWAuthRequestStep) {
+    kHAPMFiHWAuthRequestStep_Enable,
+    kHAPMFiHWAuthRequestStep_ResetErrorCode,
+    kHAPMFiHWAuthRequestStep_ReadProtocolVersion,
+    kHAPMFiHWAuthRequestStep_ReadCertificateDataLength,
+    kHAPMFiHWAuthRequestStep_ReadCertificateData,
+    kHAPMFiHWAuthRequestStep_WriteChallengeDataLength,
+    kHAPMFiHWAuthRequestStep_WriteChallengeData,
+    kHAPMFiHWAuthRequestStep_WriteChallengeResponseDataLength,
+    kHAPMFiHWAuthRequestStep_WriteAuthenticationControl,
+    kHAPMFiHWAuthRequestStep_ReadAuthenticationStatus,
+    kHAPMFiHWAuthRequestStep_ReadChallengeResponseDataLength,
+    kHAPMFiHWAuthRequestStep_ReadChallengeResponseData,
+    kHAPMFiHWAuthRequestStep_CheckErrorCode,
+    kHAPMFiHWAuthRequestStep_Done
+} HAP_ENUM_END(uint8_t, HAPMFiHWAuthRequestStep);
+
+/**
+ * Reads a register from the Apple Authentication Coprocessor.
+ *
+ * @param      mfiHWAuth            Apple Authentication Coprocessor manager.
+ * @param      wait                 Whether to wait while the coprocessor does not acknowledge the transfer.
+ * @param      registerAddress      Address of the register to read.
+ * @param      bytes                Result buffer.
+ * @param      numBytes             Length of buffer.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_Busy           If the coprocessor did not acknowledge the transfer. Only if not waiting.
+ * @return kHAPError_Unknown        If communication with the Apple Authentication Coprocessor failed.
+ */
 HAP_RESULT_USE_CHECK
-HAPError HAPMFiHWAuthCopyCertificate(
-        HAPAccessoryServerRef* server_,
-        void* certificateBytes,
-        size_t maxCertificateBytes,
-        size_t* numCertificateBytes) {
-    HAPPrecondition(server_);
-    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
-    HAPPrecondition(server->platform.authentication.mfiHWAuth);
-    HAPPrecondition(certificateBytes);
-    HAPPrecondition(numCertificateBytes);
+static HAPError
+        RequestRead(HAPMFiHWAuth* mfiHWAuth, bool wait, uint8_t registerAddress, void* bytes, size_t numBytes) {
+    HAPPrecondition(mfiHWAuth);
+    HAPPrecondition(mfiHWAuth->platformMFiHWAuth);
 
     HAPError err;
 
-    // Enable Apple Authentication Coprocessor.
-    err = HAPMFiHWAuthEnable(&server->mfi);
-    if (err) {
-        HAPAssert(err == kHAPError_Unknown);
-        return err;
+    if (wait) {
+        err = HAPPlatformMFiHWAuthRead(HAPNonnull(mfiHWAuth->platformMFiHWAuth), registerAddress, bytes, numBytes);
+        HAPAssert(!err || err == kHAPError_Unknown);
+    } else {
+        err = HAPPlatformMFiHWAuthTryRead(HAPNonnull(mfiHWAuth->platformMFiHWAuth), registerAddress, bytes, numBytes);
+        HAPAssert(!err || err == kHAPError_Busy || err == kHAPError_Unknown);
     }
+    return err;
+}
 
-    // Reset Error Code.
-    {
-        uint8_t bytes[1];
-        HAP_MFI_HW_AUTH_READ_OR_RETURN_ERROR(&server->mfi, kHAPMFiHWAuthRegister_ErrorCode, bytes, sizeof bytes);
-    }
+/**
+ * Writes data to the Apple Authentication Coprocessor.
+ *
+ * @param      mfiHWAuth            Apple Authentication Coprocessor manager.
+ * @param      wait                 Whether to wait while the coprocessor does not acknowledge the transfer.
+ * @param      bytes                Buffer to write.
+ * @param      numBytes             Length of buffer.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_Busy           If the coprocessor did not acknowledge the transfer. Only if not waiting.
+ * @return kHAPError_Unknown        If communication with the Apple Authentication Coprocessor failed.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError RequestWrite(HAPMFiHWAuth* mfiHWAuth, bool wait, const void* bytes, size_t numBytes) {
+    HAPPrecondition(mfiHWAuth);
+    HAPPrecondition(mfiHWAuth->platformMFiHWAuth);
 
-    // Read Authentication Protocol Version.
-    uint8_t protocolVersionMajor;
-    {
-        uint8_t bytes[1];
-        HAP_MFI_HW_AUTH_READ_OR_RETURN_ERROR(
-                &server->mfi, kHAPMFiHWAuthRegister_AuthenticationProtocolMajorVersion, bytes, sizeof bytes);
-        protocolVersionMajor = bytes[0];
+    HAPError err;
 
-        if (protocolVersionMajor != 2 && protocolVersionMajor != 3) {
-            HAPLog(&logObject, "Unsupported Authentication Protocol Major Version: %u.", protocolVersionMajor);
-            return kHAPError_Unknown;
-        }
+    if (wait) {
+        err = HAPPlatformMFiHWAuthWrite(HAPNonnull(mfiHWAuth->platformMFiHWAuth), bytes, numBytes);
+        HAPAssert(!err || err == kHAPError_Unknown);
+    } else {
+        err = HAPPlatformMFiHWAuthTryWrite(HAPNonnull(mfiHWAuth->platformMFiHWAuth), bytes, numBytes);
+        HAPAssert(!err || err == kHAPError_Busy || err == kHAPError_Unknown);
     }
+    return err;
+}
 
-    // Read accessory certificate data length.
-    uint16_t accessoryCertificateDataLength;
-    {
-        uint8_t bytes[2];
+/**
+ * Performs the next step of a request.
+ *
+ * @param      mfiHWAuth            Apple Authentication Coprocessor manager.
+ * @param      request              Request.
+ * @param      wait                 Whether to wait while the coprocessor does not acknowledge transfers.
+ *
+ * @return kHAPError_None           If successful. Request is complete if its step is kHAPMFiHWAuthRequestStep_Done.
+ * @return kHAPError_Busy           If the coprocessor did not acknowledge the transfer. Only if not waiting.
+ * @return kHAPError_Unknown        If communication with the Apple Authentication Coprocessor failed.
+ * @return kHAPError_OutOfResources If the result buffer is not large enough.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError ContinueRequest(HAPMFiHWAuth* mfiHWAuth, HAPMFiHWAuthRequest* request, bool wait) {
+    HAPPrecondition(mfiHWAuth);
+    HAPPrecondition(request);
 
-        HAP_MFI_HW_AUTH_READ_OR_RETURN_ERROR(
-                &server->mfi, kHAPMFiHWAuthRegister_AccessoryCertificateDataLength, bytes, sizeof bytes);
-        accessoryCertificateDataLength = HAPReadBigUInt16(&bytes[0]);
+    HAPError err;
 
-        // See Accessory Interface Specification R30
-        // Section 64.5.7.12 Accessory Certificate Data Length
-        // See Accessory Interface Specification R29
-        // Section 69.8.2.11 Accessory Certificate Data Length
-        if ((protocolVersionMajor == 3 &&
-             (accessoryCertificateDataLength < 607 || accessoryCertificateDataLength > 609)) ||
-            (protocolVersionMajor == 2 && accessoryCertificateDataLength > 1280)) {
-            HAPLog(&logObject,
-                   "Apple Authentication Coprocessor returned %u for accessory certificate data length.",
-                   accessoryCertificateDataLength);
-            return kHAPError_Unknown;
+    uint8_t* resultBytes = request->bytes;
+    switch ((HAPMFiHWAuthRequestStep) request->step) {
+        case kHAPMFiHWAuthRequestStep_Enable: {
+            // Enable Apple Authentication Coprocessor.
+            err = HAPMFiHWAuthEnable(mfiHWAuth);
+            if (err) {
+                HAPAssert(err == kHAPError_Unknown);
+                return err;
+            }
+            request->step = kHAPMFiHWAuthRequestStep_ResetErrorCode;
+        } break;
+        case kHAPMFiHWAuthRequestStep_ResetErrorCode: {
+            uint8_t bytes[1];
+            err = RequestRead(mfiHWAuth, wait, kHAPMFiHWAuthRegister_ErrorCode, bytes, sizeof bytes);
+            if (err) {
+                return err;
+            }
+            request->step = kHAPMFiHWAuthRequestStep_ReadProtocolVersion;
+        } break;
+        case kHAPMFiHWAuthRequestStep_ReadProtocolVersion: {
+            uint8_t bytes[1];
+            err = RequestRead(
+                    mfiHWAuth, wait, kHAPMFiHWAuthRegister_AuthenticationProtocolMajorVersion, bytes, sizeof bytes);
+            if (err) {
+                return err;
+            }
+            request->protocolVersionMajor = bytes[0];
+
+            if (request->protocolVersionMajor != 2 && request->protocolVersionMajor != 3) {
+                HAPLog(&logObject,
+                       "Unsupported Authentication Protocol Major Version: %u.",
+                       request->protocolVersionMajor);
+                return kHAPError_Unknown;
+            }
+            if (request->type == kHAPMFiHWAuthRequestType_CopyCertificate) {
+                request->step = kHAPMFiHWAuthRequestStep_ReadCertificateDataLength;
+            } else if (request->protocolVersionMajor == 3) {
+                request->step = kHAPMFiHWAuthRequestStep_WriteChallengeData;
+            } else {
+                request->step = kHAPMFiHWAuthRequestStep_WriteChallengeDataLength;
+            }
+        } break;
+        case kHAPMFiHWAuthRequestStep_ReadCertificateDataLength: {
+            uint8_t bytes[2];
+            err = RequestRead(
+                    mfiHWAuth, wait, kHAPMFiHWAuthRegister_AccessoryCertificateDataLength, bytes, sizeof bytes);
+            if (err) {
+                return err;
+            }
+            uint16_t accessoryCertificateDataLength = HAPReadBigUInt16(&bytes[0]);
+
+            // See Accessory Interface Specification R30
+            // Section 64.5.7.12 Accessory Certificate Data Length
+            // See Accessory Interface Specification R29
+            // Section 69.8.2.11 Accessory Certificate Data Length
+            if ((request->protocolVersionMajor == 3 &&
+                 (accessoryCertificateDataLength < 607 || accessoryCertificateDataLength > 609)) ||
+                (request->protocolVersionMajor == 2 && accessoryCertificateDataLength > 1280)) {
+                HAPLog(&logObject,
+                       "Apple Authentication Coprocessor returned %u for accessory certificate data length.",
+                       accessoryCertificateDataLength);
+                return kHAPError_Unknown;
+            }
+            if (accessoryCertificateDataLength > request->maxBytes) {
+                HAPLog(&logObject, "Not enough space to get certificate.");
+                return kHAPError_OutOfResources;
+            }
+            request->numRemainingBytes = accessoryCertificateDataLength;
+            request->numBytes = 0;
+            request->certificatePart = 0;
+            request->step = kHAPMFiHWAuthRequestStep_ReadCertificateData;
+        } break;
+        case kHAPMFiHWAuthRequestStep_ReadCertificateData: {
+            if (request->protocolVersionMajor == 3) {
+                HAPAssert(request->certificatePart < 5);
+            } else {
+                HAPAssert(request->protocolVersionMajor == 2);
+                HAPAssert(request->certificatePart < 10);
+            }
+
+            uint16_t numBytes = HAPMin(request->numRemainingBytes, (uint16_t) 128);
+            err = RequestRead(
+                    mfiHWAuth,
+                    wait,
+                    (uint8_t)(kHAPMFiHWAuthRegister_AccessoryCertificateDataPart1 + request->certificatePart),
+                    &resultBytes[request->numBytes],
+                    numBytes);
+            if (err) {
+                return err;
+            }
+            request->numRemainingBytes -= numBytes;
+            request->numBytes += numBytes;
+            request->certificatePart++;
+            HAPAssert(request->numBytes <= request->maxBytes);
+            if (!request->numRemainingBytes) {
+                request->step = kHAPMFiHWAuthRequestStep_CheckErrorCode;
+            }
+        } break;
+        case kHAPMFiHWAuthRequestStep_WriteChallengeDataLength: {
+            HAPAssert(request->protocolVersionMajor == 2);
+            uint8_t bytes[1 + sizeof(uint16_t)];
+            bytes[0] = kHAPMFiHWAuthRegister_ChallengeDataLength;
+            HAPWriteBigUInt16(&bytes[1], SHA1_BYTES);
+            err = RequestWrite(mfiHWAuth, wait, bytes, sizeof bytes);
+            if (err) {
+                return err;
+            }
+            request->step = kHAPMFiHWAuthRequestStep_WriteChallengeData;
+        } break;
+        case kHAPMFiHWAuthRequestStep_WriteChallengeData: {
+            if (request->protocolVersionMajor == 3) {
+                // Write challenge data.
+                // Additional SHA256 hash computation is necessary.
+                // Apple Authentication Coprocessor will compute ECDSA signature.
+                // See HomeKit Accessory Protocol Specification R14
+                // Section 5.6.4 M4: Accessory -> iOS Device - `SRP Verify Response'
+                uint8_t bytes[1 + SHA256_BYTES];
+                bytes[0] = kHAPMFiHWAuthRegister_ChallengeData;
+                HAPRawBufferCopyBytes(&bytes[1], request->challengeSHA256, SHA256_BYTES);
+                err = RequestWrite(mfiHWAuth, wait, bytes, sizeof bytes);
+                if (err) {
+                    return err;
+                }
+                request->step = kHAPMFiHWAuthRequestStep_WriteAuthenticationControl;
+            } else {
+                HAPAssert(request->protocolVersionMajor == 2);
+
+                // Write challenge data.
+                // Additional SHA1 hash computation is necessary.
+                // Apple Authentication Coprocessor will compute RSA signature.
+                // See HomeKit Accessory Protocol Specification R14
+                // Section 5.6.4 M4: Accessory -> iOS Device - `SRP Verify Response'
+                uint8_t bytes[1 + SHA1_BYTES];
+                bytes[0] = kHAPMFiHWAuthRegister_ChallengeData;
+                HAPRawBufferCopyBytes(&bytes[1], request->challengeSHA1, SHA1_BYTES);
+                err = RequestWrite(mfiHWAuth, wait, bytes, sizeof bytes);
+                if (err) {
+                    return err;
+                }
+                request->step = kHAPMFiHWAuthRequestStep_WriteChallengeResponseDataLength;
+            }
+        } break;
+        case kHAPMFiHWAuthRequestStep_WriteChallengeResponseDataLength: {
+            // Write challenge response data length.
+            // Before a challenge response-generation process begins, this register should contain 0x80.
+            // See Accessory Interface Specification R29
+            // Section 69.8.2.7 Challenge Response Data Length
+            HAPAssert(request->protocolVersionMajor == 2);
+            uint8_t bytes[1 + sizeof(uint16_t)];
+            bytes[0] = kHAPMFiHWAuthRegister_ChallengeResponseDataLength;
+            HAPWriteBigUInt16(&bytes[1], 0x80);
+            err = RequestWrite(mfiHWAuth, wait, bytes, sizeof bytes);
+            if (err) {
+                return err;
+            }
+            request->step = kHAPMFiHWAuthRequestStep_WriteAuthenticationControl;
+        } break;
+        case kHAPMFiHWAuthRequestStep_WriteAuthenticationControl: {
+            uint8_t bytes[2];
+            bytes[0] = kHAPMFiHWAuthRegister_AuthenticationControlAndStatus;
+            bytes[1] = 1; // PROC_CONTROL
+            err = RequestWrite(mfiHWAuth, wait, bytes, sizeof bytes);
+            if (err) {
+                return err;
+            }
+            request->step = kHAPMFiHWAuthRequestStep_ReadAuthenticationStatus;
+        } break;
+        case kHAPMFiHWAuthRequestStep_ReadAuthenticationStatus: {
+            // Read status. The coprocessor does not acknowledge transfers until the signature has been generated.
+            // The proc results are stored in bits 6|5|4
+            // The bits 3, 2, 1 and 0 are 0.
+            uint8_t bytes[1];
+            err = RequestRead(
+                    mfiHWAuth, wait, kHAPMFiHWAuthRegister_AuthenticationControlAndStatus, bytes, sizeof bytes);
+            if (err) {
+                return err;
+            }
+            if (bytes[0] != (1 << 4)) {
+                HAPLog(&logObject,
+                       "Apple Authentication Coprocessor returned %02x for authentication protocol status.",
+                       bytes[0]);
+                return kHAPError_Unknown;
+            }
+            request->step = kHAPMFiHWAuthRequestStep_ReadChallengeResponseDataLength;
+        } break;
+        case kHAPMFiHWAuthRequestStep_ReadChallengeResponseDataLength: {
+            uint8_t bytes[2];
+            err = RequestRead(
+                    mfiHWAuth, wait, kHAPMFiHWAuthRegister_ChallengeResponseDataLength, bytes, sizeof bytes);
+            if (err) {
+                return err;
+            }
+            uint16_t challengeResponseDataLength = HAPReadBigUInt16(&bytes[0]);
+
+            // See Accessory Interface Specification R30
+            // Section 64.5.7.8 Challenge Response Data Length
+            // See Accessory Interface Specification R29
+            // Section 69.8.2.7 Challenge Response Data Length
+            if ((request->protocolVersionMajor == 3 && challengeResponseDataLength != 64) ||
+                (request->protocolVersionMajor == 2 && challengeResponseDataLength > kHAPMFiHWAuth_MaxSignatureBytes)) {
+                HAPLog(&logObject,
+                       "Apple Authentication Coprocessor returned %u for challenge response data length.",
+                       challengeResponseDataLength);
+                return kHAPError_Unknown;
+            }
+            if (challengeResponseDataLength > request->maxBytes) {
+                HAPLog(&logObject, "Not enough space to get signature.");
+                return kHAPError_OutOfResources;
+            }
+            request->numRemainingBytes = challengeResponseDataLength;
+            request->step = kHAPMFiHWAuthRequestStep_ReadChallengeResponseData;
+        } break;
+        case kHAPMFiHWAuthRequestStep_ReadChallengeResponseData: {
+            err = RequestRead(
+                    mfiHWAuth,
+                    wait,
+                    kHAPMFiHWAuthRegister_ChallengeResponseData,
+                    resultBytes,
+                    request->numRemainingBytes);
+            if (err) {
+                return err;
+            }
+            request->numBytes = request->numRemainingBytes;
+            request->numRemainingBytes = 0;
+            request->step = kHAPMFiHWAuthRequestStep_CheckErrorCode;
+        } break;
+        case kHAPMFiHWAuthRequestStep_CheckErrorCode: {
+            uint8_t bytes[1];
+            err = RequestRead(mfiHWAuth, wait, kHAPMFiHWAuthRegister_ErrorCode, bytes, sizeof bytes);
+            if (err) {
+                return err;
+            }
+            HAPMFiHWAuthError errorCode = (HAPMFiHWAuthError) bytes[0];
+            if (errorCode) {
+                HAPLog(&logObject,
+                       "Error occurred while getting %s: 0x%02x.",
+                       request->type == kHAPMFiHWAuthRequestType_CopyCertificate ? "accessory certificate" :
+                                                                                   "signature",
+                       errorCode);
+                return kHAPError_Unknown;
+            }
+            request->step = kHAPMFiHWAuthRequestStep_Done;
+        } break;
+        case kHAPMFiHWAuthRequestStep_Done: {
+            HAPFatalError();
         }
     }
 
-    // Read accessory certificate data.
-    if (accessoryCertificateDataLength > maxCertificateBytes) {
-        HAPLog(&logObject, "Not enough space to get certificate.");
-        return kHAPError_OutOfResources;
-    }
-    *numCertificateBytes = 0;
-    for (uint8_t i = 0; accessoryCertificateDataLength; i++) {
-        if (protocolVersionMajor == 3) {
-            HAPAssert(i < 5);
-        } else {
-            HAPAssert(protocolVersionMajor == 2);
-            HAPAssert(i < 10);
+    return kHAPError_None;
+}
+
+/**
+ * Performs a request to completion, blocking the run loop.
+ *
+ * - Pending asynchronous requests are completed first so that transfers of different requests do not interleave.
+ *
+ * @param      mfiHWAuth            Apple Authentication Coprocessor manager.
+ * @param      request              Request.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_Unknown        If communication with the Apple Authentication Coprocessor failed.
+ * @return kHAPError_OutOfResources If the result buffer is not large enough.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError PerformRequest(HAPMFiHWAuth* mfiHWAuth, HAPMFiHWAuthRequest* request) {
+    HAPPrecondition(mfiHWAuth);
+    HAPPrecondition(request);
+
+    HAPError err;
+
+    // Complete pending asynchronous requests.
+    while (mfiHWAuth->requests) {
+        HAPMFiHWAuthRequest* pendingRequest = HAPNonnull(mfiHWAuth->requests);
+        do {
+            err = ContinueRequest(mfiHWAuth, pendingRequest, /* wait: */ true);
+        } while (!err && pendingRequest->step != kHAPMFiHWAuthRequestStep_Done);
+        HAPAssert(!err || err == kHAPError_Unknown || err == kHAPError_OutOfResources);
+
+        mfiHWAuth->requests = pendingRequest->next;
+        pendingRequest->next = NULL;
+        HAPAssert(pendingRequest->callback);
+        size_t numBytes = err ? 0 : pendingRequest->numBytes;
+        HAPNonnull(pendingRequest->callback)(
+                pendingRequest->server, pendingRequest, err, numBytes, pendingRequest->context);
+    }
+    if (mfiHWAuth->requestTimer) {
+        HAPPlatformTimerDeregister(mfiHWAuth->requestTimer);
+        mfiHWAuth->requestTimer = 0;
+    }
+
+    do {
+        err = ContinueRequest(mfiHWAuth, request, /* wait: */ true);
+    } while (!err && request->step != kHAPMFiHWAuthRequestStep_Done);
+    HAPAssert(!err || err == kHAPError_Unknown || err == kHAPError_OutOfResources);
+    return err;
+}
+
+static void RequestTimerExpired(HAPPlatformTimerRef timer, void* _Nullable context) {
+    HAPPrecondition(context);
+    HAPMFiHWAuth* mfiHWAuth = context;
+    HAPPrecondition(timer == mfiHWAuth->requestTimer);
+    mfiHWAuth->requestTimer = 0;
+
+    HAPError err;
+
+    while (mfiHWAuth->requests) {
+        HAPMFiHWAuthRequest* request = HAPNonnull(mfiHWAuth->requests);
+        do {
+            err = ContinueRequest(mfiHWAuth, request, /* wait: */ false);
+            if (!err) {
+                request->busyDeadline = 0;
+            }
+        } while (!err && request->step != kHAPMFiHWAuthRequestStep_Done);
+
+        if (err == kHAPError_Busy) {
+            HAPTime now = HAPPlatformClockGetCurrent();
+            if (!request->busyDeadline) {
+                request->busyDeadline = now + kHAPMFiHWAuth_BusyTimeout;
+            }
+            if (now < request->busyDeadline) {
+                err = HAPPlatformTimerRegister(
+                        &mfiHWAuth->requestTimer, now + kHAPMFiHWAuth_RetryInterval, RequestTimerExpired, mfiHWAuth);
+                if (!err) {
+                    return;
+                }
+                HAPAssert(err == kHAPError_OutOfResources);
+                HAPLog(&logObject, "Not enough resources to resume request. Completing request synchronously.");
+                do {
+                    err = ContinueRequest(mfiHWAuth, request, /* wait: */ true);
+                } while (!err && request->step != kHAPMFiHWAuthRequestStep_Done);
+            } else {
+                HAPLog(&logObject, "Apple Authentication Coprocessor did not acknowledge transfer in time.");
+                err = kHAPError_Unknown;
+            }
         }
+        HAPAssert(!err || err == kHAPError_Unknown || err == kHAPError_OutOfResources);
 
-        uint16_t numBytes = HAPMin(accessoryCertificateDataLength, (uint16_t) 128);
-        HAP_MFI_HW_AUTH_READ_OR_RETURN_ERROR(
-                &server->mfi,
-                (uint8_t)(kHAPMFiHWAuthRegister_AccessoryCertificateDataPart1 + i),
-                &((uint8_t*) certificateBytes)[*numCertificateBytes],
-                numBytes);
-        accessoryCertificateDataLength -= numBytes;
-        *numCertificateBytes += numBytes;
+        mfiHWAuth->requests = request->next;
+        request->next = NULL;
+        HAPAssert(request->callback);
+        HAPNonnull(request->callback)(request->server, request, err, err ? 0 : request->numBytes, request->context);
     }
-    HAPAssert(*numCertificateBytes <= maxCertificateBytes);
+}
 
-    // Check for error.
-    {
-        uint8_t bytes[1];
-        HAP_MFI_HW_AUTH_READ_OR_RETURN_ERROR(&server->mfi, kHAPMFiHWAuthRegister_ErrorCode, bytes, sizeof bytes);
-        HAPMFiHWAuthError errorCode = (HAPMFiHWAuthError) bytes[0];
-        if (errorCode) {
-            HAPLog(&logObject, "Error occurred while getting accessory certificate: 0x%02x.", errorCode);
-            return kHAPError_Unknown;
+/**
+ * Appends a request to the queue of pending requests.
+ *
+ * @param      mfiHWAuth            Apple Authentication Coprocessor manager.
+ * @param      request              Initialized request.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_OutOfResources If no timer could be allocated to process the request.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError SubmitRequest(HAPMFiHWAuth* mfiHWAuth, HAPMFiHWAuthRequest* request) {
+    HAPPrecondition(mfiHWAuth);
+    HAPPrecondition(request);
+
+    HAPError err;
+
+    if (!mfiHWAuth->requests) {
+        HAPAssert(!mfiHWAuth->requestTimer);
+        err = HAPPlatformTimerRegister(&mfiHWAuth->requestTimer, 0, RequestTimerExpired, mfiHWAuth);
+        if (err) {
+            HAPAssert(err == kHAPError_OutOfResources);
+            HAPLog(&logObject, "Not enough resources to schedule request.");
+            return err;
         }
     }
+
+    HAPMFiHWAuthRequest** tail = &mfiHWAuth->requests;
+    while (*tail) {
+        HAPPrecondition(*tail != request);
+        tail = &HAPNonnull(*tail)->next;
+    }
+    *tail = request;
     return kHAPError_None;
 }
 
 HAP_RESULT_USE_CHECK
-HAPError HAPMFiHWAuthCreateSignature(
+HAPError HAPMFiHWAuthCopyCertificateAsync(
+        HAPAccessoryServerRef* server_,
+        HAPMFiHWAuthRequest* request,
+        void* certificateBytes,
+        size_t maxCertificateBytes,
+        HAPMFiHWAuthCompletionCallback callback,
+        void* _Nullable context) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(server->platform.authentication.mfiHWAuth);
+    HAPPrecondition(request);
+    HAPPrecondition(certificateBytes);
+    HAPPrecondition(callback);
+
+    HAPRawBufferZero(request, sizeof *request);
+    request->server = server_;
+    request->callback = callback;
+    request->context = context;
+    request->bytes = certificateBytes;
+    request->maxBytes = maxCertificateBytes;
+    request->type = kHAPMFiHWAuthRequestType_CopyCertificate;
+    request->step = kHAPMFiHWAuthRequestStep_Enable;
+    return SubmitRequest(&server->mfi, request);
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPMFiHWAuthCreateSignatureAsync(
         HAPAccessoryServerRef* server_,
+        HAPMFiHWAuthRequest* request,
         const void* challengeBytes,
         size_t numChallengeBytes,
         void* signatureBytes,
         size_t maxSignatureBytes,
-        size_t* numSignatureBytes) {
+        HAPMFiHWAuthCompletionCallback callback,
+        void* _Nullable context) {
     HAPPrecondition(server_);
     HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
     HAPPrecondition(server->platform.authentication.mfiHWAuth);
+    HAPPrecondition(request);
     HAPPrecondition(challengeBytes);
     HAPPrecondition(signatureBytes);
-    HAPPrecondition(numSignatureBytes);
-
-    HAPError err;
+    HAPPrecondition(callback);
+
+    HAPRawBufferZero(request, sizeof *request);
+    request->server = server_;
+    request->callback = callback;
+    request->context = context;
+    request->bytes = signatureBytes;
+    request->maxBytes = maxSignatureBytes;
+    request->type = kHAPMFiHWAuthRequestType_CreateSignature;
+    request->step = kHAPMFiHWAuthRequestStep_Enable;
+    HAP_sha256(request->challengeSHA256, challengeBytes, numChallengeBytes);
+    HAP_sha1(request->challengeSHA1, challengeBytes, numChallengeBytes);
+    return SubmitRequest(&server->mfi, request);
+}
 
-    // Enable Apple Authentication Coprocessor.
-    err = HAPMFiHWAuthEnable(&server->mfi);
-    if (err) {
-        HAPAssert(err == kHAPError_Unknown);
-        return err;
-    }
+void HAPMFiHWAuthCancelRequest(HAPAccessoryServerRef* server_, HAPMFiHWAuthRequest* request) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(request);
 
-    // Reset Error Code.
-    {
-        uint8_t bytes[1];
-        HAP_MFI_HW_AUTH_READ_OR_RETURN_ERROR(&server->mfi, kHAPMFiHWAuthRegister_ErrorCode, bytes, sizeof bytes);
+    HAPMFiHWAuthRequest** link = &server->mfi.requests;
+    while (*link != request) {
+        HAPPrecondition(*link);
+        link = &HAPNonnull(*link)->next;
     }
+    *link = request->next;
+    request->next = NULL;
 
-    // Read Authentication Protocol Version.
-    uint8_t protocolVersionMajor;
-    {
-        uint8_t bytes[1];
-        HAP_MFI_HW_AUTH_READ_OR_RETURN_ERROR(
-                &server->mfi, kHAPMFiHWAuthRegister_AuthenticationProtocolMajorVersion, bytes, sizeof bytes);
-        protocolVersionMajor = bytes[0];
-
-        if (protocolVersionMajor != 2 && protocolVersionMajor != 3) {
-            HAPLog(&logObject, "Unsupported Authentication Protocol Major Version: %u.", protocolVersionMajor);
-            return kHAPError_Unknown;
-        }
+    if (!server->mfi.requests && server->mfi.requestTimer) {
+        HAPPlatformTimerDeregister(server->mfi.requestTimer);
+        server->mfi.requestTimer = 0;
     }
+}
 
-    // Write challenge.
-    if (protocolVersionMajor == 3) {
-        // Write challenge data.
-        // Additional SHA256 hash computation is necessary.
-        // Apple Authentication Coprocessor will compute ECDSA signature.
-        // See HomeKit Accessory Protocol Specification R14
-        // Section 5.6.4 M4: Accessory -> iOS Device - `SRP Verify Response'
-        {
-            uint8_t bytes[1 + SHA256_BYTES];
-            bytes[0] = kHAPMFiHWAuthRegister_ChallengeData;
-            HAP_sha256(&bytes[1], challengeBytes, numChallengeBytes);
-            HAP_MFI_HW_AUTH_WRITE_OR_RETURN_ERROR(&server->mfi, bytes, sizeof bytes);
-        }
-    } else {
-        HAPAssert(protocolVersionMajor == 2);
-
-        // Write challenge data length.
-        {
-            uint8_t bytes[1 + sizeof(uint16_t)];
-            bytes[0] = kHAPMFiHWAuthRegister_ChallengeDataLength;
-            HAPWriteBigUInt16(&bytes[1], SHA1_BYTES);
-            HAP_MFI_HW_AUTH_WRITE_OR_RETURN_ERROR(&server->mfi, bytes, sizeof bytes);
-        }
-
-        // Write challenge data.
-        // Additional SHA1 hash computation is necessary.
-        // Apple Authentication Coprocessor will compute RSA signature.
-        // See HomeKit Accessory Protocol Specification R14
-        // Section 5.6.4 M4: Accessory -> iOS Device - `SRP Verify Response'
-        {
-            uint8_t bytes[1 + SHA1_BYTES];
-            bytes[0] = kHAPMFiHWAuthRegister_ChallengeData;
-            HAP_sha1(&bytes[1], challengeBytes, numChallengeBytes);
-            HAP_MFI_HW_AUTH_WRITE_OR_RETURN_ERROR(&server->mfi, bytes, sizeof bytes);
-        }
+HAP_RESULT_USE_CHECK
+HAPError HAPMFiHWAuthCopyCertificate(
+        HAPAccessoryServerRef* server_,
+        void* certificateBytes,
+        size_t maxCertificateBytes,
+        size_t* numCertificateBytes) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(server->platform.authentication.mfiHWAuth);
+    HAPPrecondition(certificateBytes);
+    HAPPrecondition(numCertificateBytes);
 
-        // Write challenge response data length.
-        // Before a challenge response-generation process begins, this register should contain 0x80.
-        // See Accessory Interface Specification R29
-        // Section 69.8.2.7 Challenge Response Data Length
-        {
-            uint8_t bytes[1 + sizeof(uint16_t)];
-            bytes[0] = kHAPMFiHWAuthRegister_ChallengeResponseDataLength;
-            HAPWriteBigUInt16(&bytes[1], 0x80);
-            HAP_MFI_HW_AUTH_WRITE_OR_RETURN_ERROR(&server->mfi, bytes, sizeof bytes);
-        }
-    }
+    HAPError err;
 
-    // Write authentication control.
-    {
-        uint8_t bytes[2];
-        bytes[0] = kHAPMFiHWAuthRegister_AuthenticationControlAndStatus;
-        bytes[1] = 1; // PROC_CONTROL
-        HAP_MFI_HW_AUTH_WRITE_OR_RETURN_ERROR(&server->mfi, bytes, sizeof bytes);
+    HAPMFiHWAuthRequest request;
+    HAPRawBufferZero(&request, sizeof request);
+    request.server = server_;
+    request.bytes = certificateBytes;
+    request.maxBytes = maxCertificateBytes;
+    request.type = kHAPMFiHWAuthRequestType_CopyCertificate;
+    request.step = kHAPMFiHWAuthRequestStep_Enable;
+    err = PerformRequest(&server->mfi, &request);
+    if (err) {
+        HAPAssert(err == kHAPError_Unknown || err == kHAPError_OutOfResources);
+        return err;
     }
 
-    // Read status.
-    // The proc results are stored in bits 6|5|4
-    // The bits 3, 2, 1 and 0 are 0.
-    {
-        uint8_t bytes[1];
-        HAP_MFI_HW_AUTH_READ_OR_RETURN_ERROR(
-                &server->mfi, kHAPMFiHWAuthRegister_AuthenticationControlAndStatus, bytes, sizeof bytes);
-        if (bytes[0] != (1 << 4)) {
-            HAPLog(&logObject,
-                   "Apple Authentication Coprocessor returned %02x for authentication protocol status.",
-                   bytes[0]);
-            return kHAPError_Unknown;
-        }
-    }
+    *numCertificateBytes = request.numBytes;
+    return kHAPError_None;
+}
 
-    // Read challenge response data length.
-    uint16_t challengeResponseDataLength;
-    {
-        uint8_t bytes[2];
-        HAP_MFI_HW_AUTH_READ_OR_RETURN_ERROR(
-                &server->mfi, kHAPMFiHWAuthRegister_ChallengeResponseDataLength, bytes, sizeof bytes);
-        challengeResponseDataLength = HAPReadBigUInt16(&bytes[0]);
+HAP_RESULT_USE_CHECK
+HAPError HAPMFiHWAuthCreateSignature(
+        HAPAccessoryServerRef* server_,
+        const void* challengeBytes,
+        size_t numChallengeBytes,
+        void* signatureBytes,
+        size_t maxSignatureBytes,
+        size_t* numSignatureBytes) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(server->platform.authentication.mfiHWAuth);
+    HAPPrecondition(challengeBytes);
+    HAPPrecondition(signatureBytes);
+    HAPPrecondition(numSignatureBytes);
 
-        // See Accessory Interface Specification R30
-        // Section 64.5.7.8 Challenge Response Data Length
-        // See Accessory Interface Specification R29
-        // Section 69.8.2.7 Challenge Response Data Length
-        if ((protocolVersionMajor == 3 && challengeResponseDataLength != 64) ||
-            (protocolVersionMajor == 2 && challengeResponseDataLength > 0x80)) {
-            HAPLog(&logObject,
-                   "Apple Authentication Coprocessor returned %u for challenge response data length.",
-                   challengeResponseDataLength);
-            return kHAPError_Unknown;
-        }
-    }
+    HAPError err;
 
-    // Read challenge response data.
-    if (challengeResponseDataLength > maxSignatureBytes) {
-        HAPLog(&logObject, "Not enough space to get signature.");
-        return kHAPError_OutOfResources;
+    HAPMFiHWAuthRequest request;
+    HAPRawBufferZero(&request, sizeof request);
+    request.server = server_;
+    request.bytes = signatureBytes;
+    request.maxBytes = maxSignatureBytes;
+    request.type = kHAPMFiHWAuthRequestType_CreateSignature;
+    request.step = kHAPMFiHWAuthRequestStep_Enable;
+    HAP_sha256(request.challengeSHA256, challengeBytes, numChallengeBytes);
+    HAP_sha1(request.challengeSHA1, challengeBytes, numChallengeBytes);
+    err = PerformRequest(&server->mfi, &request);
+    if (err) {
+        HAPAssert(err == kHAPError_Unknown || err == kHAPError_OutOfResources);
+        return err;
     }
-    HAP_MFI_HW_AUTH_READ_OR_RETURN_ERROR(
-            &server->mfi, kHAPMFiHWAuthRegister_ChallengeResponseData, signatureBytes, challengeResponseDataLength);
-    *numSignatureBytes = challengeResponseDataLength;
 
-    // Check for error.
-    {
-        uint8_t bytes[1];
-        HAP_MFI_HW_AUTH_READ_OR_RETURN_ERROR(&server->mfi, kHAPMFiHWAuthRegister_ErrorCode, bytes, sizeof bytes);
-        HAPMFiHWAuthError errorCode = (HAPMFiHWAuthError) bytes[0];
-        if (errorCode) {
-            HAPLog(&logObject, "Error occurred while getting signature: 0x%02x.", errorCode);
-            return kHAPError_Unknown;
-        }
-    }
+    *numSignatureBytes = request.numBytes;
     return kHAPError_None;
 }
@@ -17,6 +17,73 @@ extern "C" {
 #pragma clang assume_nonnull begin
 #endif
 
+/**
+ * Interval at which a request is resumed while the Apple Authentication Coprocessor does not acknowledge transfers.
+ */
+#define kHAPMFiHWAuth_RetryInterval ((HAPTime)(2 * HAPMillisecond))
+
+/**
+ * Time after which a transfer that the Apple Authentication Coprocessor does not acknowledge fails.
+ */
+#define kHAPMFiHWAuth_BusyTimeout ((HAPTime)(1 * HAPSecond))
+
+/**
+ * Maximum length of a signature that is created by the Apple Authentication Coprocessor.
+ *
+ * - Authentication Protocol Major Version 2 creates RSA signatures of up to 128 bytes.
+ *   Version 3 creates ECDSA signatures of 64 bytes.
+ */
+#define kHAPMFiHWAuth_MaxSignatureBytes ((size_t) 128)
+
+typedef struct HAPMFiHWAuthRequest HAPMFiHWAuthRequest;
+
+/**
+ * Completion handler of an asynchronous Apple Authentication Coprocessor request.
+ *
+ * @param      server               Accessory server.
+ * @param      request              Request that completed. May be reused.
+ * @param      error                kHAPError_None           If successful.
+ *                                  kHAPError_Unknown        If communication with the coprocessor failed.
+ *                                  kHAPError_OutOfResources If the result buffer is not large enough.
+ * @param      numBytes             Length of the result, if successful.
+ * @param      context              The context parameter given to the request.
+ */
+typedef void (*HAPMFiHWAuthCompletionCallback)(
+        HAPAccessoryServerRef* server,
+        HAPMFiHWAuthRequest* request,
+        HAPError error,
+        size_t numBytes,
+        void* _Nullable context);
+
+/**
+ * Asynchronous Apple Authentication Coprocessor request.
+ *
+ * - Storage is provided by the caller and must remain valid until the completion handler has been invoked
+ *   or until the request has been cancelled.
+ */
+struct HAPMFiHWAuthRequest {
+    // Opaque type. Do not access the instance fields directly.
+    /**@cond */
+    HAPMFiHWAuthRequest* _Nullable next;
+    HAPAccessoryServerRef* server;
+    HAPMFiHWAuthCompletionCallback _Nullable callback;
+    void* _Nullable context;
+
+    void* bytes;
+    size_t maxBytes;
+    size_t numBytes;
+    HAPTime busyDeadline;
+
+    uint8_t challengeSHA256[SHA256_BYTES];
+    uint8_t challengeSHA1[SHA1_BYTES];
+    uint16_t numRemainingBytes;
+    uint8_t type;
+    uint8_t step;
+    uint8_t protocolVersionMajor;
+    uint8_t certificatePart;
+    /**@endcond */
+};
+
 /**
  * Apple Authentication Coprocessor manager.
  */
@@ -30,6 +97,16 @@ typedef struct {
      * Time to check MFi power off.
      */
     HAPPlatformTimerRef powerOffTimer;
+
+    /**
+     * Queue of pending asynchronous requests. The first request is being processed.
+     */
+    HAPMFiHWAuthRequest* _Nullable requests;
+
+    /**
+     * Timer until processing of the first request resumes.
+     */
+    HAPPlatformTimerRef requestTimer;
 } HAPMFiHWAuth;
 HAP_NONNULL_SUPPORT(HAPMFiHWAuth)
 
@@ -74,6 +151,8 @@ bool HAPMFiHWAuthIsAvailable(HAPMFiHWAuth* mfiHWAuth);
 /**
  * Retrieves a copy of the MFi certificate.
  *
+ * - Pending asynchronous requests are completed first. The run loop is blocked until the certificate has been read.
+ *
  * @param      server               Accessory server.
  * @param[out] certificateBytes     MFi certificate buffer.
  * @param      maxCertificateBytes  Capacity of MFi certificate buffer.
@@ -93,6 +172,8 @@ HAPError HAPMFiHWAuthCopyCertificate(
 /**
  * Signs the digest of a challenge with the MFi Private Key.
  *
+ * - Pending asynchronous requests are completed first. The run loop is blocked until the signature has been created.
+ *
  * @param      server               Accessory server.
  * @param      challengeBytes       Challenge buffer.
  * @param      numChallengeBytes    Length of challenge buffer.
@@ -113,6 +194,72 @@ HAPError HAPMFiHWAuthCreateSignature(
         size_t maxSignatureBytes,
         size_t* numSignatureBytes);
 
+/**
+ * Retrieves a copy of the MFi certificate without blocking the run loop.
+ *
+ * - Requests are processed one at a time in the order in which they are submitted. While the coprocessor does not
+ *   acknowledge transfers, processing resumes from a timer every kHAPMFiHWAuth_RetryInterval.
+ *
+ * - The completion handler is always invoked asynchronously from the run loop.
+ *
+ * @param      server               Accessory server.
+ * @param      request              Request storage.
+ * @param[out] certificateBytes     MFi certificate buffer. Must remain valid until completion.
+ * @param      maxCertificateBytes  Capacity of MFi certificate buffer.
+ * @param      callback             Function to call on completion.
+ * @param      context              Context that is passed to the completion handler.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_OutOfResources If no timer could be allocated to process the request.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPMFiHWAuthCopyCertificateAsync(
+        HAPAccessoryServerRef* server,
+        HAPMFiHWAuthRequest* request,
+        void* certificateBytes,
+        size_t maxCertificateBytes,
+        HAPMFiHWAuthCompletionCallback callback,
+        void* _Nullable context);
+
+/**
+ * Signs the digest of a challenge with the MFi Private Key without blocking the run loop.
+ *
+ * - Requests are processed one at a time in the order in which they are submitted. While the coprocessor does not
+ *   acknowledge transfers, processing resumes from a timer every kHAPMFiHWAuth_RetryInterval.
+ *
+ * - The completion handler is always invoked asynchronously from the run loop.
+ *
+ * @param      server               Accessory server.
+ * @param      request              Request storage.
+ * @param      challengeBytes       Challenge buffer. Only needs to remain valid for the duration of this call.
+ * @param      numChallengeBytes    Length of challenge buffer.
+ * @param[out] signatureBytes       Signature buffer. Must remain valid until completion.
+ * @param      maxSignatureBytes    Capacity of signature buffer.
+ * @param      callback             Function to call on completion.
+ * @param      context              Context that is passed to the completion handler.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_OutOfResources If no timer could be allocated to process the request.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPMFiHWAuthCreateSignatureAsync(
+        HAPAccessoryServerRef* server,
+        HAPMFiHWAuthRequest* request,
+        const void* challengeBytes,
+        size_t numChallengeBytes,
+        void* signatureBytes,
+        size_t maxSignatureBytes,
+        HAPMFiHWAuthCompletionCallback callback,
+        void* _Nullable context);
+
+/**
+ * Cancels an asynchronous request. The completion handler will not be invoked.
+ *
+ * @param      server               Accessory server.
+ * @param      request              Request to cancel. Must have been submitted and not completed yet.
+ */
+void HAPMFiHWAuthCancelRequest(HAPAccessoryServerRef* server, HAPMFiHWAuthRequest* request);
+
 #if __has_feature(nullability)
 #pragma clang assume_nonnull end
 #endif
@@ -99,6 +99,14 @@ void HAPPairingBLESessionCacheSave(
         server->ble.sessionCacheTimestamp = 2;
     }
     cacheEntry->lastUsed = server->ble.sessionCacheTimestamp;
+
+    size_t numUsedElements = 0;
+    for (size_t i = 0; i < server->ble.storage->numSessionCacheElements; i++) {
+        if (((const HAPPairingBLESessionCacheEntry*) &server->ble.storage->sessionCacheElements[i])->lastUsed) {
+            numUsedElements++;
+        }
+    }
+    HAPAccessoryServerUpdateHighWaterMark(&server->storageHighWaterMarks.ble.numSessionCacheElements, numUsedElements);
 }
 
 void HAPPairingBLESessionCacheInvalidateEntriesForPairing(HAPAccessoryServerRef* server_, int pairingID) {
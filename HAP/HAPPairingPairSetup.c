@@ -16,6 +16,9 @@ void HAPPairingPairSetupResetForSession(HAPAccessoryServerRef* server_, HAPSessi
 
     // Reset session-specific Pair Setup procedure state that is stored in shared memory.
     if (server->pairSetup.sessionThatIsCurrentlyPairing == session_) {
+        if (server->pairSetup.mfiProof.isPending) {
+            HAPMFiHWAuthCancelRequest(server_, &server->pairSetup.mfiProof.request);
+        }
         bool keepSetupInfo = server->pairSetup.keepSetupInfo;
         HAPRawBufferZero(&server->pairSetup, sizeof server->pairSetup);
         HAPAccessorySetupInfoHandlePairingStop(server_, keepSetupInfo);
@@ -414,9 +417,65 @@ static HAPError HAPPairingPairSetupProcessM3(
     return kHAPError_None;
 }
 
+/**
+ * Derives the MFi challenge of Pair Setup M4 from the SRP session key.
+ *
+ * @param      server               Accessory server.
+ * @param[out] challengeBytes       MFi challenge.
+ * @param      numChallengeBytes    Length of MFi challenge.
+ */
+static void GetMFiChallenge(const HAPAccessoryServer* server, void* challengeBytes, size_t numChallengeBytes) {
+    HAPPrecondition(server);
+    HAPPrecondition(challengeBytes);
+
+    static const uint8_t salt[] = "MFi-Pair-Setup-Salt";
+    static const uint8_t info[] = "MFi-Pair-Setup-Info";
+    HAP_hkdf_sha512(
+            challengeBytes,
+            numChallengeBytes,
+            server->pairSetup.K,
+            sizeof server->pairSetup.K,
+            salt,
+            sizeof salt - 1,
+            info,
+            sizeof info - 1);
+    HAPLogSensitiveBufferDebug(&logObject, challengeBytes, numChallengeBytes, "Pair Setup M4: MFiChallenge.");
+}
+
+static void HandleMFiProofCreated(
+        HAPAccessoryServerRef* server_,
+        HAPMFiHWAuthRequest* request,
+        HAPError error,
+        size_t numBytes,
+        void* _Nullable context HAP_UNUSED) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(request == &server->pairSetup.mfiProof.request);
+    HAPPrecondition(server->pairSetup.mfiProof.isPending);
+    HAPPrecondition(server->pairSetup.sessionThatIsCurrentlyPairing);
+    HAPSession* session = (HAPSession*) HAPNonnull(server->pairSetup.sessionThatIsCurrentlyPairing);
+    HAPPrecondition(session->transportType == kHAPTransportType_IP);
+
+    if (error) {
+        HAPAssert(error == kHAPError_Unknown || error == kHAPError_OutOfResources);
+        HAPLog(&logObject, "Pair Setup M4: Failed to create MFi proof.");
+    }
+    server->pairSetup.mfiProof.isPending = false;
+    server->pairSetup.mfiProof.isAvailable = true;
+    server->pairSetup.mfiProof.error = error;
+    server->pairSetup.mfiProof.numBytes = numBytes;
+
+    // Send the deferred M4 response.
+    HAPAssert(server->transports.ip);
+    HAPNonnull(server->transports.ip)->session.continuePairSetup(server_, (HAPSessionRef*) session);
+}
+
 /**
  * Processes Pair Setup M4.
  *
+ * - Over IP, the MFi proof is created asynchronously. kHAPError_Busy is returned until it is available.
+ *   The transport is informed through its session.continuePairSetup callback and then reads M4 again.
+ *
  * @param      server_              Accessory server.
  * @param      session_             The session over which the response will be sent.
  * @param      responseWriter       TLV writer for serializing the response.
@@ -425,6 +484,7 @@ static HAPError HAPPairingPairSetupProcessM3(
  * @return kHAPError_Unknown        If communication with Apple Auth Coprocessor or persistent store access failed.
  * @return kHAPError_InvalidState   If a different request is expected in the current state.
  * @return kHAPError_OutOfResources If response writer does not have enough capacity.
+ * @return kHAPError_Busy           If the response is deferred until the MFi proof has been created.
  */
 HAP_RESULT_USE_CHECK
 static HAPError HAPPairingPairSetupGetM4(
@@ -447,8 +507,8 @@ static HAPError HAPPairingPairSetupGetM4(
 
     HAPLogDebug(&logObject, "Pair Setup M4: SRP Verify Response.");
 
-    // Compute SRP shared secret key.
-    {
+    // Compute SRP shared secret key. Skipped when the response has been deferred after successful verification.
+    if (!server->pairSetup.mfiProof.isAvailable) {
         void* bytes;
         size_t maxBytes;
         HAPTLVWriterGetScratchBytes(responseWriter, &bytes, &maxBytes);
@@ -573,6 +633,30 @@ static HAPError HAPPairingPairSetupGetM4(
                 "Pair Setup M4: SessionKey");
     }
 
+    // Start creating the MFi proof without blocking, and defer the response until it is available.
+    // The BLE transport cannot defer responses and uses the synchronous Apple Authentication Coprocessor API.
+    if (session->state.pairSetup.method == kHAPPairingMethod_PairSetupWithAuth &&
+        session->transportType == kHAPTransportType_IP && !server->pairSetup.mfiProof.isAvailable &&
+        server->platform.authentication.mfiHWAuth && HAPAccessoryServerSupportsMFiHWAuth(server_)) {
+        uint8_t challengeBytes[32];
+        GetMFiChallenge(server, challengeBytes, sizeof challengeBytes);
+        err = HAPMFiHWAuthCreateSignatureAsync(
+                server_,
+                &server->pairSetup.mfiProof.request,
+                challengeBytes,
+                sizeof challengeBytes,
+                server->pairSetup.mfiProof.bytes,
+                sizeof server->pairSetup.mfiProof.bytes,
+                HandleMFiProofCreated,
+                /* context: */ NULL);
+        if (!err) {
+            server->pairSetup.mfiProof.isPending = true;
+            return kHAPError_Busy;
+        }
+        HAPAssert(err == kHAPError_OutOfResources);
+        HAPLog(&logObject, "Pair Setup M4: Creating MFi proof synchronously.");
+    }
+
     // kTLVType_State.
     err = HAPTLVWriterAppend(
             responseWriter,
@@ -628,37 +712,43 @@ static HAPError HAPPairingPairSetupGetM4(
                 size_t maxBytes;
                 HAPTLVWriterGetScratchBytes(&subWriter, &bytes, &maxBytes);
 
-                const size_t numChallengeBytes = 32;
-                void* challengeBytes = HAPTLVScratchBufferAlloc(&bytes, &maxBytes, numChallengeBytes);
-                const size_t maxMFiProofBytes = maxBytes;
-                void* mfiProofBytes = HAPTLVScratchBufferAllocUnaligned(&bytes, &maxBytes, maxMFiProofBytes);
-                if (!challengeBytes || !mfiProofBytes) {
-                    HAPLog(&logObject, "Pair Setup M4: Not enough memory to allocate MFiChallenge / MFi Proof.");
-                    return kHAPError_OutOfResources;
-                }
-
-                // Generate MFi challenge.
-                static const uint8_t salt[] = "MFi-Pair-Setup-Salt";
-                static const uint8_t info[] = "MFi-Pair-Setup-Info";
-                HAP_hkdf_sha512(
-                        challengeBytes,
-                        numChallengeBytes,
-                        server->pairSetup.K,
-                        sizeof server->pairSetup.K,
-                        salt,
-                        sizeof salt - 1,
-                        info,
-                        sizeof info - 1);
-                HAPLogSensitiveBufferDebug(
-                        &logObject, challengeBytes, numChallengeBytes, "Pair Setup M4: MFiChallenge.");
-
-                // Generate the MFi proof.
+                const void* mfiProofBytes;
                 size_t numMFiProofBytes;
-                err = mfiAuth.createSignature(
-                        server_, challengeBytes, numChallengeBytes, mfiProofBytes, maxMFiProofBytes, &numMFiProofBytes);
-                if (err) {
-                    HAPAssert(err == kHAPError_Unknown);
-                    return err;
+                if (server->pairSetup.mfiProof.isAvailable) {
+                    // Use the MFi proof that has been created asynchronously.
+                    err = server->pairSetup.mfiProof.error;
+                    if (err) {
+                        HAPAssert(err == kHAPError_Unknown || err == kHAPError_OutOfResources);
+                        return kHAPError_Unknown;
+                    }
+                    mfiProofBytes = server->pairSetup.mfiProof.bytes;
+                    numMFiProofBytes = server->pairSetup.mfiProof.numBytes;
+                } else {
+                    const size_t numChallengeBytes = 32;
+                    void* challengeBytes = HAPTLVScratchBufferAlloc(&bytes, &maxBytes, numChallengeBytes);
+                    const size_t maxMFiProofBytes = maxBytes;
+                    void* proofBytes = HAPTLVScratchBufferAllocUnaligned(&bytes, &maxBytes, maxMFiProofBytes);
+                    if (!challengeBytes || !proofBytes) {
+                        HAPLog(&logObject, "Pair Setup M4: Not enough memory to allocate MFiChallenge / MFi Proof.");
+                        return kHAPError_OutOfResources;
+                    }
+
+                    // Generate MFi challenge.
+                    GetMFiChallenge(server, challengeBytes, numChallengeBytes);
+
+                    // Generate the MFi proof.
+                    err = mfiAuth.createSignature(
+                            server_,
+                            challengeBytes,
+                            numChallengeBytes,
+                            proofBytes,
+                            maxMFiProofBytes,
+                            &numMFiProofBytes);
+                    if (err) {
+                        HAPAssert(err == kHAPError_Unknown);
+                        return err;
+                    }
+                    mfiProofBytes = proofBytes;
                 }
                 HAPLogSensitiveBufferDebug(
                         &logObject, mfiProofBytes, numMFiProofBytes, "Pair Setup M4: kTLVType_Signature.");
@@ -1159,7 +1249,7 @@ static HAPError HAPPairingPairSetupGetM6(
         size_t numInfoBytes = XLength + numDeviceIDBytes + ED25519_PUBLIC_KEY_BYTES;
 
         // Generate signature.
-        HAP_ed25519_sign(signature, infoBytes, numInfoBytes, server->identity.ed_LTSK.bytes, server->identity.ed_LTPK);
+        HAP_ed25519_sign_with_ctx(signature, &server->identity.ed_LTSKSignContext, infoBytes, numInfoBytes);
         HAPLogSensitiveBufferDebug(&logObject, infoBytes, numInfoBytes, "Pair Setup M6: AccessoryDeviceInfo.");
         HAPLogSensitiveBufferDebug(&logObject, signature, ED25519_BYTES, "Pair Setup M6: kTLVType_Signature.");
 
@@ -1414,6 +1504,11 @@ HAPError HAPPairingPairSetupHandleRead(
         case 3: {
             session->state.pairSetup.state++;
             err = HAPPairingPairSetupGetM4(server, session_, responseWriter);
+            if (err == kHAPError_Busy) {
+                // Response is deferred. M4 is read again once the MFi proof is available.
+                session->state.pairSetup.state--;
+                return err;
+            }
             if (err) {
                 HAPAssert(err == kHAPError_Unknown || err == kHAPError_InvalidState || err == kHAPError_OutOfResources);
             }
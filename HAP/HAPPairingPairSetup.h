@@ -52,6 +52,9 @@ HAPError HAPPairingPairSetupHandleWrite(
 /**
  * Processes a read request on the Pair Setup endpoint.
  *
+ * - Over IP, the Pair Setup M4 response is deferred while the MFi proof is created asynchronously.
+ *   The IP transport's session.continuePairSetup callback is invoked once it may be read again.
+ *
  * @param      server               Accessory server.
  * @param      session              The session over which the response will be sent.
  * @param      responseWriter       TLV writer for serializing the response.
@@ -60,6 +63,7 @@ HAPError HAPPairingPairSetupHandleWrite(
  * @return kHAPError_Unknown        If communication with Apple Authentication Coprocessor failed.
  * @return kHAPError_InvalidState   If the request cannot be processed in the current state.
  * @return kHAPError_OutOfResources If response writer does not have enough capacity.
+ * @return kHAPError_Busy           If the response is deferred. Only over IP.
  */
 HAP_RESULT_USE_CHECK
 HAPError HAPPairingPairSetupHandleRead(
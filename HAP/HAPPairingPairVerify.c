@@ -476,7 +476,7 @@ static HAPError HAPPairingPairVerifyGetM2(
         size_t numInfoBytes = X25519_BYTES + numDeviceIDStringBytes + X25519_BYTES;
 
         // Generate signature.
-        HAP_ed25519_sign(signature, infoBytes, numInfoBytes, server->identity.ed_LTSK.bytes, server->identity.ed_LTPK);
+        HAP_ed25519_sign_with_ctx(signature, &server->identity.ed_LTSKSignContext, infoBytes, numInfoBytes);
         HAPLogSensitiveBufferDebug(&logObject, infoBytes, numInfoBytes, "Pair Verify M2: AccessoryInfo");
         HAPLogSensitiveBufferDebug(&logObject, signature, ED25519_BYTES, "Pair Verify M2: kTLVType_Signature");
 
@@ -873,9 +873,13 @@ static HAPError HAPPairingPairVerifyProcessM3(
     // Verify signature.
     HAPLogSensitiveBufferDebug(
             &logObject, signatureTLV.value.bytes, signatureTLV.value.numBytes, "Pair Verify M3: kTLVType_Signature.");
-    e = HAP_ed25519_verify(signatureTLV.value.bytes, infoBytes, numInfoBytes, pairing.publicKey.value);
-    if (e) {
-        HAPAssert(e == -1);
+    if (!HAPPairingPublicKeyCacheVerifySignature(
+                server_,
+                session->state.pairVerify.pairingID,
+                &pairing.publicKey,
+                signatureTLV.value.bytes,
+                infoBytes,
+                numInfoBytes)) {
         HAPLog(&logObject, "Pair Verify M3: iOSDeviceInfo signature is incorrect.");
         session->state.pairVerify.error = kHAPPairingError_Authentication;
         return kHAPError_None;
@@ -198,6 +198,7 @@ static HAPError HAPPairingPairingsAddPairingProcessM1(
             HAPAssert(err == kHAPError_Unknown);
             return err;
         }
+        HAPPairingPublicKeyCacheInvalidateEntriesForPairing(server_, (int) key);
 
         // If the admin controller pairing is removed, all pairings on the accessory must be removed.
         err = HAPAccessoryServerCleanupPairings(server_);
@@ -491,6 +492,9 @@ static HAPError HAPPairingPairingsRemovePairingGetM2(
             return kHAPError_None;
         }
 
+        // Remove cached public key of this pairing.
+        HAPPairingPublicKeyCacheInvalidateEntriesForPairing(server_, (int) key);
+
         // BLE: Remove all Pair Resume cache entries related to this pairing.
         if (server->transports.ble) {
             HAPNonnull(server->transports.ble)->sessionCache.invalidateEntriesForPairing(server_, (int) key);
@@ -0,0 +1,138 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAP+Internal.h"
+
+static const HAPLogObject logObject = { .subsystem = kHAP_LogSubsystem, .category = "PairingPublicKeyCache" };
+
+/**
+ * Releases a cache entry.
+ *
+ * @param      cacheEntry           Cache entry.
+ */
+static void ReleaseEntry(HAPPairingPublicKeyCacheEntry* cacheEntry) {
+    HAPPrecondition(cacheEntry);
+
+    if (cacheEntry->lastUsed) {
+        HAP_ed25519_verify_done(&cacheEntry->verifyContext);
+    }
+    HAPRawBufferZero(cacheEntry, sizeof *cacheEntry);
+}
+
+/**
+ * Marks a cache entry as most recently used.
+ *
+ * @param      cache                Cache.
+ * @param      cacheEntry           Cache entry.
+ */
+static void TouchEntry(HAPPairingPublicKeyCache* cache, HAPPairingPublicKeyCacheEntry* cacheEntry) {
+    HAPPrecondition(cache);
+    HAPPrecondition(cacheEntry);
+
+    cache->timestamp++;
+    if (cache->timestamp == 0) {
+        // Overflow => reset time stamps.
+        for (size_t i = 0; i < HAPArrayCount(cache->entries); i++) {
+            HAPPairingPublicKeyCacheEntry* e = &cache->entries[i];
+
+            if (e->lastUsed) {
+                e->lastUsed = 1;
+            }
+        }
+        cache->timestamp = 2;
+    }
+    cacheEntry->lastUsed = cache->timestamp;
+}
+
+HAP_RESULT_USE_CHECK
+bool HAPPairingPublicKeyCacheVerifySignature(
+        HAPAccessoryServerRef* server_,
+        int pairingID,
+        const HAPPairingPublicKey* publicKey,
+        const uint8_t signature[ED25519_BYTES],
+        const void* message,
+        size_t numMessageBytes) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(pairingID >= 0);
+    HAPPrecondition(publicKey);
+    HAPPrecondition(signature);
+    HAPPrecondition(message);
+    HAPPairingPublicKeyCache* cache = &server->pairingPublicKeyCache;
+
+    // Find cached public key. The public key is compared as well in case the pairing has been replaced.
+    HAPPairingPublicKeyCacheEntry* _Nullable cacheEntry = NULL;
+    for (size_t i = 0; i < HAPArrayCount(cache->entries); i++) {
+        HAPPairingPublicKeyCacheEntry* e = &cache->entries[i];
+
+        if (e->lastUsed && e->pairingID == pairingID) {
+            if (HAPRawBufferAreEqual(e->publicKey.value, publicKey->value, sizeof publicKey->value)) {
+                cacheEntry = e;
+            } else {
+                ReleaseEntry(e);
+            }
+            break;
+        }
+    }
+
+    if (!cacheEntry) {
+        // Search least recently used.
+        size_t index = 0;
+        uint32_t min = UINT32_MAX;
+        for (size_t i = 0; i < HAPArrayCount(cache->entries); i++) {
+            if (cache->entries[i].lastUsed < min) {
+                min = cache->entries[i].lastUsed;
+                index = i;
+            }
+        }
+        HAPPairingPublicKeyCacheEntry* e = &cache->entries[index];
+        ReleaseEntry(e);
+
+        // Prepare public key.
+        int ret = HAP_ed25519_verify_init(&e->verifyContext, publicKey->value);
+        if (ret) {
+            HAPAssert(ret == -1);
+            HAPLog(&logObject, "Not enough memory to cache public key of pairing ID %d.", pairingID);
+            HAPRawBufferZero(e, sizeof *e);
+            ret = HAP_ed25519_verify(signature, message, numMessageBytes, publicKey->value);
+            return ret == 0;
+        }
+        HAPRawBufferCopyBytes(e->publicKey.value, publicKey->value, sizeof e->publicKey.value);
+        e->pairingID = pairingID;
+        cacheEntry = e;
+    }
+    TouchEntry(cache, HAPNonnull(cacheEntry));
+
+    int ret = HAP_ed25519_verify_with_ctx(
+            signature, message, numMessageBytes, &HAPNonnull(cacheEntry)->verifyContext);
+    return ret == 0;
+}
+
+void HAPPairingPublicKeyCacheInvalidateEntriesForPairing(HAPAccessoryServerRef* server_, int pairingID) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPrecondition(pairingID >= 0);
+    HAPPairingPublicKeyCache* cache = &server->pairingPublicKeyCache;
+
+    for (size_t i = 0; i < HAPArrayCount(cache->entries); i++) {
+        HAPPairingPublicKeyCacheEntry* cacheEntry = &cache->entries[i];
+
+        if (cacheEntry->lastUsed && cacheEntry->pairingID == pairingID) {
+            ReleaseEntry(cacheEntry);
+        }
+    }
+}
+
+void HAPPairingPublicKeyCacheInvalidateAllEntries(HAPAccessoryServerRef* server_) {
+    HAPPrecondition(server_);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) server_;
+    HAPPairingPublicKeyCache* cache = &server->pairingPublicKeyCache;
+
+    for (size_t i = 0; i < HAPArrayCount(cache->entries); i++) {
+        ReleaseEntry(&cache->entries[i]);
+    }
+    cache->timestamp = 0;
+}
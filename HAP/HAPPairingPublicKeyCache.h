@@ -0,0 +1,105 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#ifndef HAP_PAIRING_PUBLIC_KEY_CACHE_H
+#define HAP_PAIRING_PUBLIC_KEY_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "HAP+Internal.h"
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull begin
+#endif
+
+/**
+ * Number of controller long-term public keys that are kept in verification-ready form.
+ *
+ * - Controllers of a home tend to reconnect frequently, so a few entries cover most Pair Verify requests.
+ */
+#define kHAPPairingPublicKeyCache_NumEntries ((size_t) 4)
+
+/**
+ * Controller long-term public key cache entry.
+ */
+typedef struct {
+    /** Verification context of the public key. */
+    HAP_ed25519_verify_ctx verifyContext;
+
+    /** Public key. */
+    HAPPairingPublicKey publicKey;
+
+    /** Pairing ID. */
+    int pairingID;
+
+    /** Timestamp for Least Recently Used scheme. 0: invalid. */
+    uint32_t lastUsed;
+} HAPPairingPublicKeyCacheEntry;
+
+/**
+ * Controller long-term public key cache.
+ */
+typedef struct {
+    /** Cache entries. */
+    HAPPairingPublicKeyCacheEntry entries[kHAPPairingPublicKeyCache_NumEntries];
+
+    /** Timestamp for Least Recently Used scheme. */
+    uint32_t timestamp;
+} HAPPairingPublicKeyCache;
+
+/**
+ * Verifies a signature that has been created by the controller of a pairing.
+ *
+ * - The verification-ready form of the controller long-term public key is cached, so that subsequent verifications
+ *   for the same pairing do not need to decompress it again.
+ *
+ * @param      server               Accessory server.
+ * @param      pairingID            Pairing ID.
+ * @param      publicKey            Long-term public key of the pairing.
+ * @param      signature            Signature.
+ * @param      message              Signed message.
+ * @param      numMessageBytes      Length of signed message.
+ *
+ * @return true                     If the signature is valid.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+bool HAPPairingPublicKeyCacheVerifySignature(
+        HAPAccessoryServerRef* server,
+        int pairingID,
+        const HAPPairingPublicKey* publicKey,
+        const uint8_t signature[_Nonnull ED25519_BYTES],
+        const void* message,
+        size_t numMessageBytes);
+
+/**
+ * Invalidates the cached public key of a pairing.
+ *
+ * - Must be called when a pairing is removed or updated.
+ *
+ * @param      server               Accessory server.
+ * @param      pairingID            Pairing ID.
+ */
+void HAPPairingPublicKeyCacheInvalidateEntriesForPairing(HAPAccessoryServerRef* server, int pairingID);
+
+/**
+ * Invalidates all cached public keys.
+ *
+ * @param      server               Accessory server.
+ */
+void HAPPairingPublicKeyCacheInvalidateAllEntries(HAPAccessoryServerRef* server);
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull end
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
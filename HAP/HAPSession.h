@@ -270,6 +270,8 @@ HAPError HAPSessionHandlePairSetupWrite(
 /**
  * Processes a Pair Setup read request.
  *
+ * - Over IP, the response may be deferred. See HAPPairingPairSetupHandleRead.
+ *
  * @param      server               Accessory server.
  * @param      session              The session over which the response will be sent.
  * @param      responseWriter       TLV writer for serializing the response.
@@ -278,6 +280,7 @@ HAPError HAPSessionHandlePairSetupWrite(
  * @return kHAPError_Unknown        If communication with Apple Authentication Coprocessor failed.
  * @return kHAPError_InvalidState   If the request cannot be processed in the current state.
  * @return kHAPError_OutOfResources If response writer does not have enough capacity.
+ * @return kHAPError_Busy           If the response is deferred. Only over IP.
  */
 HAP_RESULT_USE_CHECK
 HAPError HAPSessionHandlePairSetupRead(
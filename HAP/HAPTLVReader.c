@@ -309,6 +309,7 @@ static HAPError GetNextTLVInfo(
  *
  * @param      reader_              TLV reader.
  * @param      tlvType              Type of the TLV item.
+ * @param      startOffset          Offset of the TLV item at which to start searching.
  * @param[out] tlvBytes             Start of buffer containing the TLV item, if found. NULL otherwise.
  * @param[out] numTLVBytes          Length of the buffer containing the TLV item, including all headers, if found.
  *
@@ -319,11 +320,13 @@ HAP_RESULT_USE_CHECK
 static HAPError FindTLVInfo(
         const HAPTLVReaderRef* reader_,
         HAPTLVType tlvType,
+        size_t startOffset,
         void* _Nullable* _Nonnull tlvBytes,
         size_t* numTLVBytes) {
     HAPPrecondition(reader_);
     const HAPTLVReader* reader = (const HAPTLVReader*) reader_;
     HAPPrecondition(reader->isNonSequentialAccessEnabled);
+    HAPPrecondition(startOffset <= reader->numBytes);
     HAPPrecondition(tlvBytes);
     HAPPrecondition(numTLVBytes);
 
@@ -334,7 +337,7 @@ static HAPError FindTLVInfo(
 
     uint8_t* bytes = reader->bytes;
     size_t maxBytes = reader->numBytes;
-    size_t o = 0;
+    size_t o = startOffset;
     while (o < maxBytes) {
         HAPTLVType type;
         size_t numBytes;
@@ -568,6 +571,316 @@ static bool HAPTLVReaderIsTypeReserved(const HAPTLVReaderRef* reader_, HAPTLVTyp
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/** Offset denoting that no TLV item is present. */
+#define kHAPTLVReaderIndex_NoOffset ((uint16_t) UINT16_MAX)
+
+/**
+ * Index entry of a TLV type.
+ *
+ * - The first two TLV items with the TLV type are recorded, including all of their fragments.
+ */
+typedef struct {
+    uint16_t offsets[2];  /**< Offsets of the first TLV items with the TLV type. */
+    uint16_t numBytes[2]; /**< Lengths of the first TLV items with the TLV type, including all fragments. */
+    HAPTLVType tlvType;   /**< TLV type. */
+    bool isUsed : 1;      /**< Whether the entry is used. */
+} HAPTLVReaderIndexEntry;
+
+/**
+ * Maximum number of slots of a TLV reader index. With this many slots, the index is direct-mapped by TLV type.
+ */
+#define kHAPTLVReaderIndex_MaxSlots ((size_t)(UINT8_MAX + 1))
+
+/**
+ * Index of the TLV items within the buffer of a TLV reader whose TLV types are used by an aggregate format.
+ *
+ * - The index is built in a single pass over the buffer. Fragmented TLV items are recorded by the offset of their
+ *   first fragment and the length of the fragment chain. They are only merged when they are read.
+ *
+ * - Reading a TLV item rewrites it in place without moving other TLV items, so the recorded offsets remain valid.
+ *   A TLV item that has already been read is recognized by its TLV type having been replaced with a reserved TLV type.
+ *
+ * - Entries are stored in an open addressing hash table keyed by TLV type, with linear probing. The table has a power
+ *   of two number of slots and is at most half full, or direct-mapped for formats that use many TLV types.
+ *   TLV types are usually small consecutive numbers, so collisions are rare.
+ *
+ * - Entries are stored in the scratch buffer of the TLV reader. Indexes of nested TLV readers are stored in the
+ *   scratch buffer that remains available.
+ */
+typedef struct {
+    HAPTLVReaderIndexEntry* entries; /**< Index entries, one per slot. */
+    size_t numSlots;                 /**< Number of slots. */
+    void* _Nullable scratchBytes;    /**< Remaining scratch buffer. */
+    size_t numScratchBytes;          /**< Capacity of the remaining scratch buffer. */
+} HAPTLVReaderIndex;
+
+/**
+ * Gets the slot of a TLV type in a TLV reader index.
+ *
+ * @param      index                TLV reader index.
+ * @param      tlvType              TLV type.
+ *
+ * @return Index entry of the TLV type, if present. Otherwise, the unused index entry where it would be added.
+ */
+HAP_RESULT_USE_CHECK
+static HAPTLVReaderIndexEntry* GetIndexSlot(const HAPTLVReaderIndex* index, HAPTLVType tlvType) {
+    HAPPrecondition(index);
+    HAPPrecondition(index->numSlots && !(index->numSlots & (index->numSlots - 1)));
+
+    size_t slot = tlvType & (index->numSlots - 1);
+    for (size_t i = 0; i < index->numSlots; i++) {
+        HAPTLVReaderIndexEntry* entry = &index->entries[slot];
+        if (!entry->isUsed || entry->tlvType == tlvType) {
+            return entry;
+        }
+        slot = (slot + 1) & (index->numSlots - 1);
+    }
+    HAPFatalError();
+}
+
+/**
+ * Adds an entry for a TLV type to a TLV reader index, unless the TLV type already has an entry.
+ *
+ * @param      tlvType              TLV type.
+ * @param      index                TLV reader index. NULL to only count the number of entries that are needed.
+ * @param[in,out] numEntries        Number of index entries.
+ */
+static void AddIndexEntry(HAPTLVType tlvType, HAPTLVReaderIndex* _Nullable index, size_t* numEntries) {
+    HAPPrecondition(numEntries);
+
+    if (index) {
+        HAPTLVReaderIndexEntry* entry = GetIndexSlot(HAPNonnull(index), tlvType);
+        if (entry->isUsed) {
+            return;
+        }
+        HAPAssert(*numEntries < index->numSlots);
+        *entry = (HAPTLVReaderIndexEntry) {
+            .offsets = { kHAPTLVReaderIndex_NoOffset, kHAPTLVReaderIndex_NoOffset },
+            .tlvType = tlvType,
+            .isUsed = true,
+        };
+    }
+    (*numEntries)++;
+}
+
+/**
+ * Adds entries for the TLV types that are used by a format to a TLV reader index.
+ *
+ * - The same TLV types as with HAPTLVFormatUsesType are covered.
+ *
+ * @param      format_              Format.
+ * @param      index                TLV reader index. NULL to only count the number of entries that are needed.
+ * @param[in,out] numEntries        Number of index entries.
+ */
+static void AddIndexEntries(const HAPTLVFormat* format_, HAPTLVReaderIndex* _Nullable index, size_t* numEntries) {
+    HAPPrecondition(format_);
+    const HAPBaseTLVFormat* format = format_;
+    HAPPrecondition(numEntries);
+
+    if (!HAPTLVFormatIsAggregate(format_)) {
+        return;
+    }
+    if (format->type == kHAPTLVFormatType_Sequence) {
+        const HAPSequenceTLVFormat* fmt = format_;
+        if (fmt->item.isFlat) {
+            AddIndexEntries(fmt->item.format, index, numEntries);
+        } else {
+            AddIndexEntry(fmt->item.tlvType, index, numEntries);
+        }
+        AddIndexEntry(fmt->separator.tlvType, index, numEntries);
+    } else if (format->type == kHAPTLVFormatType_Struct) {
+        const HAPStructTLVFormat* fmt = format_;
+        if (fmt->members) {
+            for (size_t i = 0; fmt->members[i]; i++) {
+                const HAPStructTLVMember* member = fmt->members[i];
+                if (member->isFlat) {
+                    AddIndexEntries(member->format, index, numEntries);
+                } else {
+                    AddIndexEntry(member->tlvType, index, numEntries);
+                }
+            }
+        }
+    } else {
+        HAPAssert(format->type == kHAPTLVFormatType_Union);
+        const HAPUnionTLVFormat* fmt = format_;
+        if (fmt->variants) {
+            for (size_t i = 0; fmt->variants[i]; i++) {
+                AddIndexEntry(fmt->variants[i]->tlvType, index, numEntries);
+            }
+        }
+    }
+}
+
+/**
+ * Gets the index entry of a TLV type.
+ *
+ * @param      index                TLV reader index.
+ * @param      tlvType              TLV type.
+ *
+ * @return Index entry of the TLV type, if the TLV type is used by the indexed format. NULL otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static HAPTLVReaderIndexEntry* _Nullable GetIndexEntry(const HAPTLVReaderIndex* index, HAPTLVType tlvType) {
+    HAPPrecondition(index);
+
+    HAPTLVReaderIndexEntry* entry = GetIndexSlot(index, tlvType);
+    return entry->isUsed ? entry : NULL;
+}
+
+/**
+ * Builds an index of the TLV items within the buffer of a TLV reader whose TLV types are used by a format.
+ *
+ * - Non-sequential access must be enabled on the TLV reader.
+ *
+ * @param      reader_              TLV reader.
+ * @param      format_              Struct or union format.
+ * @param      scratchBytes         Scratch buffer to store the index in.
+ * @param      numScratchBytes      Capacity of the scratch buffer.
+ * @param[out] index                TLV reader index.
+ *
+ * @return true                     If the index has been built.
+ * @return false                    If the scratch buffer is not large enough or the buffer cannot be indexed.
+ */
+HAP_RESULT_USE_CHECK
+static bool CreateIndex(
+        const HAPTLVReaderRef* reader_,
+        const HAPTLVFormat* format_,
+        void* _Nullable scratchBytes,
+        size_t numScratchBytes,
+        HAPTLVReaderIndex* index) {
+    HAPPrecondition(reader_);
+    const HAPTLVReader* reader = (const HAPTLVReader*) reader_;
+    HAPPrecondition(reader->isNonSequentialAccessEnabled);
+    HAPPrecondition(format_);
+    const HAPBaseTLVFormat* format = format_;
+    HAPPrecondition(index);
+
+    HAPError err;
+
+    HAPRawBufferZero(index, sizeof *index);
+
+    if (format->type != kHAPTLVFormatType_Struct && format->type != kHAPTLVFormatType_Union) {
+        return false;
+    }
+    if (reader->numBytes >= kHAPTLVReaderIndex_NoOffset) {
+        return false;
+    }
+
+    size_t maxEntries = 0;
+    AddIndexEntries(format_, NULL, &maxEntries);
+    if (!maxEntries) {
+        return false;
+    }
+    size_t numSlots = 1;
+    while (numSlots < 2 * maxEntries && numSlots < kHAPTLVReaderIndex_MaxSlots) {
+        numSlots *= 2;
+    }
+    void* entries = NULL;
+    if (scratchBytes) {
+        entries = HAPTLVScratchBufferAlloc(&scratchBytes, &numScratchBytes, numSlots * sizeof *index->entries);
+    }
+    if (!entries) {
+        HAPLogDebug(&logObject, "Not enough scratch memory to index TLV items (%zu types).", maxEntries);
+        return false;
+    }
+    HAPRawBufferZero(entries, numSlots * sizeof *index->entries);
+    index->entries = entries;
+    index->numSlots = numSlots;
+    size_t numEntries = 0;
+    AddIndexEntries(format_, index, &numEntries);
+    HAPAssert(numEntries <= maxEntries);
+    index->scratchBytes = scratchBytes;
+    index->numScratchBytes = numScratchBytes;
+
+    uint8_t* tlvBytes = reader->bytes;
+    size_t maxTLVBytes = reader->numBytes;
+    size_t o = 0;
+    while (o < maxTLVBytes) {
+        HAPTLVType tlvType;
+        size_t numTLVBytes;
+        err = GetNextTLVInfo(reader_, &tlvBytes[o], maxTLVBytes - o, &tlvType, &numTLVBytes);
+        if (err) {
+            HAPAssert(err == kHAPError_InvalidData);
+            return false;
+        }
+
+        HAPTLVReaderIndexEntry* entry = GetIndexEntry(index, tlvType);
+        if (entry) {
+            for (size_t i = 0; i < HAPArrayCount(entry->offsets); i++) {
+                if (entry->offsets[i] == kHAPTLVReaderIndex_NoOffset) {
+                    entry->offsets[i] = (uint16_t) o;
+                    entry->numBytes[i] = (uint16_t) numTLVBytes;
+                    break;
+                }
+            }
+        }
+
+        o += numTLVBytes;
+    }
+    return true;
+}
+
+/**
+ * Finds the first TLV item with a given TLV type that has not been read yet using a TLV reader index.
+ *
+ * - The result is the same as with FindTLVInfo, but only recorded TLV items are inspected in the common case.
+ *
+ * @param      reader_              TLV reader.
+ * @param      index                TLV reader index.
+ * @param      tlvType              Type of the TLV item.
+ * @param[out] tlvBytes             Start of buffer containing the TLV item, if found. NULL otherwise.
+ * @param[out] numTLVBytes          Length of the buffer containing the TLV item, including all headers, if found.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidData    If data within the buffer is malformed.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError FindIndexedTLVInfo(
+        const HAPTLVReaderRef* reader_,
+        const HAPTLVReaderIndex* index,
+        HAPTLVType tlvType,
+        void* _Nullable* _Nonnull tlvBytes,
+        size_t* numTLVBytes) {
+    HAPPrecondition(reader_);
+    const HAPTLVReader* reader = (const HAPTLVReader*) reader_;
+    HAPPrecondition(index);
+    HAPPrecondition(tlvBytes);
+    HAPPrecondition(numTLVBytes);
+
+    *tlvBytes = NULL;
+    *numTLVBytes = 0;
+
+    const HAPTLVReaderIndexEntry* entry = GetIndexEntry(index, tlvType);
+    if (!entry) {
+        return FindTLVInfo(reader_, tlvType, /* startOffset: */ 0, tlvBytes, numTLVBytes);
+    }
+
+    // A recorded TLV item that has not been read yet still starts with its TLV type, and its fragment chain
+    // has not been modified. A TLV item that has been read starts with a reserved TLV type instead.
+    uint8_t* bytes = reader->bytes;
+    size_t maxBytes = reader->numBytes;
+    for (size_t i = 0; i < HAPArrayCount(entry->offsets); i++) {
+        if (entry->offsets[i] == kHAPTLVReaderIndex_NoOffset) {
+            return kHAPError_None;
+        }
+        HAPAssert(entry->offsets[i] < maxBytes);
+        HAPAssert(entry->numBytes[i] <= maxBytes - entry->offsets[i]);
+
+        if (bytes[entry->offsets[i]] == tlvType) {
+            *tlvBytes = &bytes[entry->offsets[i]];
+            *numTLVBytes = entry->numBytes[i];
+            return kHAPError_None;
+        }
+    }
+
+    // Both recorded TLV items have been read. Look for a third one.
+    size_t last = HAPArrayCount(entry->offsets) - 1;
+    return FindTLVInfo(
+            reader_, tlvType, (size_t) entry->offsets[last] + entry->numBytes[last], tlvBytes, numTLVBytes);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 HAP_RESULT_USE_CHECK
 static HAPError EnableNonSequentialAccessWithFormat(HAPTLVReaderRef* reader, const HAPTLVFormat* format) {
     HAPPrecondition(reader);
@@ -676,6 +989,7 @@ static HAPError HAPTLVReaderDecodeScalar(
 HAP_RESULT_USE_CHECK
 static HAPError HAPTLVReaderDecodeAggregate(
         HAPTLVReaderRef* reader,
+        const HAPTLVReaderIndex* _Nullable index,
         const HAPTLVFormat* format,
         HAPTLVValue* value,
         HAPStringBuilderRef* stringBuilder,
@@ -738,7 +1052,7 @@ static HAPError EnumerateSequenceTLV(
             itemReader->maxBytes = numTLVBytes;
 
             err = HAPTLVReaderDecodeAggregate(
-                    &itemReader_, fmt->item.format, value, &stringBuilder, /* nestingLevel: */ 0);
+                    &itemReader_, /* index: */ NULL, fmt->item.format, value, &stringBuilder, /* nestingLevel: */ 0);
             if (err) {
                 HAPAssert(err == kHAPError_InvalidData);
                 HAPLog(&logObject, "Invalid value.");
@@ -778,7 +1092,12 @@ static HAPError EnumerateSequenceTLV(
                     return err;
                 }
                 err = HAPTLVReaderDecodeAggregate(
-                        &subReader, fmt->item.format, value, &stringBuilder, /* nestingLevel: */ 1);
+                        &subReader,
+                        /* index: */ NULL,
+                        fmt->item.format,
+                        value,
+                        &stringBuilder,
+                        /* nestingLevel: */ 1);
                 if (err) {
                     HAPAssert(err == kHAPError_InvalidData);
                     HAPLogTLV(&logObject, fmt->item.tlvType, fmt->item.debugDescription, "Invalid value.");
@@ -841,6 +1160,7 @@ static HAPError EnumerateSequenceTLV(
 HAP_RESULT_USE_CHECK
 static HAPError HAPTLVReaderFindAndDecodeTLV(
         HAPTLVReaderRef* reader,
+        const HAPTLVReaderIndex* _Nullable index,
         HAPTLVType tlvType,
         const char* debugDescription,
         const HAPTLVFormat* format,
@@ -859,7 +1179,11 @@ static HAPError HAPTLVReaderFindAndDecodeTLV(
 
     void* tlvBytes;
     size_t numTLVBytes;
-    err = FindTLVInfo(reader, tlvType, &tlvBytes, &numTLVBytes);
+    if (index) {
+        err = FindIndexedTLVInfo(reader, HAPNonnull(index), tlvType, &tlvBytes, &numTLVBytes);
+    } else {
+        err = FindTLVInfo(reader, tlvType, /* startOffset: */ 0, &tlvBytes, &numTLVBytes);
+    }
     if (err) {
         HAPAssert(err == kHAPError_InvalidData);
         return err;
@@ -887,7 +1211,18 @@ static HAPError HAPTLVReaderFindAndDecodeTLV(
             HAPAssert(err == kHAPError_InvalidData);
             return err;
         }
-        err = HAPTLVReaderDecodeAggregate(&subReader, format, HAPNonnullVoid(value), stringBuilder, nestingLevel + 1);
+        HAPTLVReaderIndex subIndex;
+        bool hasSubIndex = false;
+        if (index) {
+            hasSubIndex = CreateIndex(&subReader, format, index->scratchBytes, index->numScratchBytes, &subIndex);
+        }
+        err = HAPTLVReaderDecodeAggregate(
+                &subReader,
+                hasSubIndex ? &subIndex : NULL,
+                format,
+                HAPNonnullVoid(value),
+                stringBuilder,
+                nestingLevel + 1);
         if (err) {
             HAPAssert(err == kHAPError_InvalidData);
             HAPLogTLV(&logObject, tlvType, debugDescription, "Invalid value.");
@@ -909,7 +1244,11 @@ static HAPError HAPTLVReaderFindAndDecodeTLV(
         }
     }
 
-    err = FindTLVInfo(reader, tlvType, &tlvBytes, &numTLVBytes);
+    if (index) {
+        err = FindIndexedTLVInfo(reader, HAPNonnull(index), tlvType, &tlvBytes, &numTLVBytes);
+    } else {
+        err = FindTLVInfo(reader, tlvType, /* startOffset: */ 0, &tlvBytes, &numTLVBytes);
+    }
     if (err) {
         HAPAssert(err == kHAPError_InvalidData);
         return err;
@@ -1133,6 +1472,7 @@ static HAPTLVValue* GetStructMemberValue(const HAPStructTLVMember* member, HAPTL
 HAP_RESULT_USE_CHECK
 static HAPError HAPTLVReaderDecodeAggregate(
         HAPTLVReaderRef* reader,
+        const HAPTLVReaderIndex* _Nullable index,
         const HAPTLVFormat* format_,
         HAPTLVValue* value_,
         HAPStringBuilderRef* stringBuilder,
@@ -1179,7 +1519,8 @@ static HAPError HAPTLVReaderDecodeAggregate(
                 if (member->isFlat) {
                     HAPAssert(HAPTLVFormatIsAggregate(member->format));
                     HAPAssert(!member->isOptional);
-                    err = HAPTLVReaderDecodeAggregate(reader, member->format, memberValue, stringBuilder, nestingLevel);
+                    err = HAPTLVReaderDecodeAggregate(
+                            reader, index, member->format, memberValue, stringBuilder, nestingLevel);
                     if (err) {
                         HAPAssert(err == kHAPError_InvalidData);
                         return err;
@@ -1188,6 +1529,7 @@ static HAPError HAPTLVReaderDecodeAggregate(
                     bool found;
                     err = HAPTLVReaderFindAndDecodeTLV(
                             reader,
+                            index,
                             member->tlvType,
                             member->debugDescription,
                             member->format,
@@ -1225,6 +1567,7 @@ static HAPError HAPTLVReaderDecodeAggregate(
                 bool found;
                 err = HAPTLVReaderFindAndDecodeTLV(
                         reader,
+                        index,
                         variant->tlvType,
                         variant->debugDescription,
                         variant->format,
@@ -1282,7 +1625,13 @@ HAPError HAPTLVReaderDecodeVoid(HAPTLVReaderRef* reader, const HAPTLVFormat* for
         HAPAssert(err == kHAPError_InvalidData);
         return err;
     }
-    err = HAPTLVReaderDecodeAggregate(reader, format, value, &stringBuilder, /* nestingLevel: */ 0);
+    void* scratchBytes;
+    size_t numScratchBytes;
+    HAPTLVReaderGetScratchBytes(reader, &scratchBytes, &numScratchBytes);
+    HAPTLVReaderIndex index;
+    bool hasIndex = CreateIndex(reader, format, scratchBytes, numScratchBytes, &index);
+    err = HAPTLVReaderDecodeAggregate(
+            reader, hasIndex ? &index : NULL, format, value, &stringBuilder, /* nestingLevel: */ 0);
     if (err) {
         HAPAssert(err == kHAPError_InvalidData);
         HAPLog(&logObject, "Invalid value.");
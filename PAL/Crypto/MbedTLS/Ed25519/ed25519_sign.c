@@ -339,8 +339,7 @@ void ed25519_SignMessage(
         const void* blinding,         /*  IN: [optional] null or blinding context */
         const unsigned char* msg,     /*  IN: [msg_size bytes] message to sign */
         size_t msg_size) {
-    Affine_POINT R;
-    U_WORD a[K_WORDS], t[K_WORDS], r[K_WORDS];
+    U_WORD a[K_WORDS];
     U8 md[SHA512_DIGEST_LENGTH];
 
     /* [a:b] = H(sk) */
@@ -348,10 +347,32 @@ void ed25519_SignMessage(
     ecp_TrimSecretKey(md); /* a = first 32 bytes */
     ecp_BytesToWords(a, md);
 
+    ed25519_SignMessageExpanded(signature, a, md + 32, privKey + 32, blinding, msg, msg_size);
+
+    /* Clear sensitive data */
+    ecp_SetValue(a, 0);
+    mem_clear(md, sizeof md);
+}
+
+/*
+ * Generate message signature with an expanded secret key [a:b] = H(sk)
+ */
+void ed25519_SignMessageExpanded(
+        unsigned char* signature,    /* OUT: [64 bytes] signature (R,S) */
+        const U_WORD* a,             /*  IN: secret scalar a */
+        const unsigned char* prefix, /*  IN: [32 bytes] prefix b */
+        const unsigned char* pubKey, /*  IN: [32 bytes] public key */
+        const void* blinding,        /*  IN: [optional] null or blinding context */
+        const unsigned char* msg,    /*  IN: [msg_size bytes] message to sign */
+        size_t msg_size) {
+    Affine_POINT R;
+    U_WORD t[K_WORDS], r[K_WORDS];
+    U8 md[SHA512_DIGEST_LENGTH];
+
     /* r = H(b + m) mod BPO */
     mbedtls_sha512_context ctx;
     sha512_init(&ctx);
-    sha512_update(&ctx, md + 32, 32);
+    sha512_update(&ctx, prefix, 32);
     sha512_update(&ctx, msg, msg_size);
     sha512_final(&ctx, md);
     eco_DigestToWords(r, md);
@@ -363,9 +384,9 @@ void ed25519_SignMessage(
 
     /* S = r + H(encoded(R) + pk + m) * a  mod BPO */
     sha512_init(&ctx);
-    sha512_update(&ctx, signature, 32);    /* encoded(R) */
-    sha512_update(&ctx, privKey + 32, 32); /* pk */
-    sha512_update(&ctx, msg, msg_size);    /* m */
+    sha512_update(&ctx, signature, 32); /* encoded(R) */
+    sha512_update(&ctx, pubKey, 32);    /* pk */
+    sha512_update(&ctx, msg, msg_size); /* m */
     sha512_final(&ctx, md);
     eco_DigestToWords(t, md);
 
@@ -375,6 +396,5 @@ void ed25519_SignMessage(
     ecp_WordsToBytes(signature + 32, t); /* S part of signature */
 
     /* Clear sensitive data */
-    ecp_SetValue(a, 0);
     ecp_SetValue(r, 0);
 }
@@ -51,6 +51,16 @@ void ed25519_SignMessage(
         const unsigned char* msg,     /* IN: [msg_size bytes] message to sign */
         size_t msg_size);             /* IN: size of message */
 
+/* Generate message signature with an expanded secret key [a:b] = H(sk) */
+void ed25519_SignMessageExpanded(
+        unsigned char* signature,    /* OUT:[64 bytes] signature (R,S) */
+        const U_WORD* a,             /* IN: secret scalar a */
+        const unsigned char* prefix, /* IN: [32 bytes] prefix b */
+        const unsigned char* pubKey, /* IN: [32 bytes] public key */
+        const void* blinding,        /* IN: [optional] null or blinding context */
+        const unsigned char* msg,    /* IN: [msg_size bytes] message to sign */
+        size_t msg_size);            /* IN: size of message */
+
 void ed25519_Blinding_Init(
         EDP_BLINDING_CTX* ctx,     /* IO: blinding context */
         const unsigned char* seed, /* IN: [size bytes] random blinding seed */
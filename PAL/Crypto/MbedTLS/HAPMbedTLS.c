@@ -112,6 +112,120 @@ int HAP_ed25519_verify(
     return (ret == 1) ? 0 : -1;
 }
 
+typedef struct {
+    U_WORD a[K_WORDS];
+    uint8_t prefix[32];
+    uint8_t pk[ED25519_PUBLIC_KEY_BYTES];
+} ED25519_SIGN_CTX;
+
+HAP_STATIC_ASSERT(sizeof(HAP_ed25519_sign_ctx) >= sizeof(ED25519_SIGN_CTX), HAP_ed25519_sign_ctx);
+
+void HAP_ed25519_sign_init(
+        HAP_ed25519_sign_ctx* ctx,
+        const uint8_t sk[ED25519_SECRET_KEY_BYTES],
+        const uint8_t pk[ED25519_PUBLIC_KEY_BYTES]) {
+    ED25519_SIGN_CTX* sign_ctx = (ED25519_SIGN_CTX*) ctx;
+    USE_AND_CLEAR(md, SHA512_BYTES, {
+        HAP_sha512(md, sk, ED25519_SECRET_KEY_BYTES);
+        ecp_TrimSecretKey(md);
+        ecp_BytesToWords(sign_ctx->a, md);
+        memcpy(sign_ctx->prefix, md + 32, sizeof sign_ctx->prefix);
+    });
+    memcpy(sign_ctx->pk, pk, ED25519_PUBLIC_KEY_BYTES);
+}
+
+void HAP_ed25519_sign_with_ctx(
+        uint8_t sig[ED25519_BYTES],
+        const HAP_ed25519_sign_ctx* ctx,
+        const uint8_t* m,
+        size_t m_len) {
+    const ED25519_SIGN_CTX* sign_ctx = (const ED25519_SIGN_CTX*) ctx;
+    WITH_BLINDING({ ed25519_SignMessageExpanded(sig, sign_ctx->a, sign_ctx->prefix, sign_ctx->pk, &ctx, m, m_len); });
+}
+
+void HAP_ed25519_sign_done(HAP_ed25519_sign_ctx* ctx) {
+    HAP_constant_time_fill_zero(ctx, sizeof *ctx);
+}
+
+typedef struct {
+    EDP_SIGV_CTX* ctx;
+} EDP_SIGV_CTX_Handle;
+
+HAP_STATIC_ASSERT(sizeof(HAP_ed25519_verify_ctx) >= sizeof(EDP_SIGV_CTX_Handle), HAP_ed25519_verify_ctx);
+
+int HAP_ed25519_verify_init(HAP_ed25519_verify_ctx* ctx, const uint8_t pk[ED25519_PUBLIC_KEY_BYTES]) {
+    EDP_SIGV_CTX_Handle* handle = (EDP_SIGV_CTX_Handle*) ctx;
+    // Decompresses the public key and precomputes its multiples for the double-scalar multiplication.
+    handle->ctx = ed25519_Verify_Init(NULL, pk);
+    return handle->ctx ? 0 : -1;
+}
+
+int HAP_ed25519_verify_with_ctx(
+        const uint8_t sig[ED25519_BYTES],
+        const uint8_t* m,
+        size_t m_len,
+        const HAP_ed25519_verify_ctx* ctx) {
+    const EDP_SIGV_CTX_Handle* handle = (const EDP_SIGV_CTX_Handle*) ctx;
+    int ret = ed25519_Verify_Check(handle->ctx, sig, m, m_len);
+    return (ret == 1) ? 0 : -1;
+}
+
+void HAP_ed25519_verify_done(HAP_ed25519_verify_ctx* ctx) {
+    EDP_SIGV_CTX_Handle* handle = (EDP_SIGV_CTX_Handle*) ctx;
+    ed25519_Verify_Finish(handle->ctx);
+    handle->ctx = NULL;
+}
+
+#else
+
+typedef struct {
+    uint8_t sk[ED25519_SECRET_KEY_BYTES];
+    uint8_t pk[ED25519_PUBLIC_KEY_BYTES];
+} ED25519_SIGN_CTX;
+
+HAP_STATIC_ASSERT(sizeof(HAP_ed25519_sign_ctx) >= sizeof(ED25519_SIGN_CTX), HAP_ed25519_sign_ctx);
+
+void HAP_ed25519_sign_init(
+        HAP_ed25519_sign_ctx* ctx,
+        const uint8_t sk[ED25519_SECRET_KEY_BYTES],
+        const uint8_t pk[ED25519_PUBLIC_KEY_BYTES]) {
+    ED25519_SIGN_CTX* sign_ctx = (ED25519_SIGN_CTX*) ctx;
+    memcpy(sign_ctx->sk, sk, ED25519_SECRET_KEY_BYTES);
+    memcpy(sign_ctx->pk, pk, ED25519_PUBLIC_KEY_BYTES);
+}
+
+void HAP_ed25519_sign_with_ctx(
+        uint8_t sig[ED25519_BYTES],
+        const HAP_ed25519_sign_ctx* ctx,
+        const uint8_t* m,
+        size_t m_len) {
+    const ED25519_SIGN_CTX* sign_ctx = (const ED25519_SIGN_CTX*) ctx;
+    HAP_ed25519_sign(sig, m, m_len, sign_ctx->sk, sign_ctx->pk);
+}
+
+void HAP_ed25519_sign_done(HAP_ed25519_sign_ctx* ctx) {
+    HAP_constant_time_fill_zero(ctx, sizeof *ctx);
+}
+
+HAP_STATIC_ASSERT(sizeof(HAP_ed25519_verify_ctx) >= ED25519_PUBLIC_KEY_BYTES, HAP_ed25519_verify_ctx);
+
+int HAP_ed25519_verify_init(HAP_ed25519_verify_ctx* ctx, const uint8_t pk[ED25519_PUBLIC_KEY_BYTES]) {
+    memcpy(ctx, pk, ED25519_PUBLIC_KEY_BYTES);
+    return 0;
+}
+
+int HAP_ed25519_verify_with_ctx(
+        const uint8_t sig[ED25519_BYTES],
+        const uint8_t* m,
+        size_t m_len,
+        const HAP_ed25519_verify_ctx* ctx) {
+    return HAP_ed25519_verify(sig, m, m_len, (const uint8_t*) ctx);
+}
+
+void HAP_ed25519_verify_done(HAP_ed25519_verify_ctx* ctx) {
+    memset(ctx, 0, sizeof *ctx);
+}
+
 #endif
 
 static int blinding_rng(void* context HAP_UNUSED, uint8_t* buffer, size_t n) {
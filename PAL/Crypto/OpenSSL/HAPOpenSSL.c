@@ -83,6 +83,71 @@ int HAP_ed25519_verify(
     return (ret == 1) ? 0 : -1;
 }
 
+typedef struct {
+    EVP_PKEY* key;
+} EVP_PKEY_Handle;
+
+HAP_STATIC_ASSERT(sizeof(HAP_ed25519_sign_ctx) >= sizeof(EVP_PKEY_Handle), HAP_ed25519_sign_ctx);
+
+void HAP_ed25519_sign_init(
+        HAP_ed25519_sign_ctx* ctx,
+        const uint8_t sk[ED25519_SECRET_KEY_BYTES],
+        const uint8_t pk[ED25519_PUBLIC_KEY_BYTES] HAP_UNUSED) {
+    EVP_PKEY_Handle* handle = (EVP_PKEY_Handle*) ctx;
+    handle->key = EVP_PKEY_new_raw_private_key(EVP_PKEY_ED25519, NULL, sk, ED25519_SECRET_KEY_BYTES);
+    HAPAssert(handle->key);
+}
+
+void HAP_ed25519_sign_with_ctx(
+        uint8_t sig[ED25519_BYTES],
+        const HAP_ed25519_sign_ctx* ctx,
+        const uint8_t* m,
+        size_t m_len) {
+    const EVP_PKEY_Handle* handle = (const EVP_PKEY_Handle*) ctx;
+    WITH_CTX(EVP_MD_CTX, EVP_MD_CTX_new(), {
+        int ret = EVP_DigestSignInit(ctx, NULL, NULL, NULL, handle->key);
+        HAPAssert(ret == 1);
+        size_t len = ED25519_BYTES;
+        EVP_DigestSign(ctx, sig, &len, m, m_len);
+        HAPAssert(len == ED25519_BYTES);
+    });
+}
+
+void HAP_ed25519_sign_done(HAP_ed25519_sign_ctx* ctx) {
+    EVP_PKEY_Handle* handle = (EVP_PKEY_Handle*) ctx;
+    EVP_PKEY_free(handle->key);
+    handle->key = NULL;
+}
+
+HAP_STATIC_ASSERT(sizeof(HAP_ed25519_verify_ctx) >= sizeof(EVP_PKEY_Handle), HAP_ed25519_verify_ctx);
+
+int HAP_ed25519_verify_init(HAP_ed25519_verify_ctx* ctx, const uint8_t pk[ED25519_PUBLIC_KEY_BYTES]) {
+    EVP_PKEY_Handle* handle = (EVP_PKEY_Handle*) ctx;
+    handle->key = EVP_PKEY_new_raw_public_key(EVP_PKEY_ED25519, NULL, pk, ED25519_PUBLIC_KEY_BYTES);
+    return handle->key ? 0 : -1;
+}
+
+int HAP_ed25519_verify_with_ctx(
+        const uint8_t sig[ED25519_BYTES],
+        const uint8_t* m,
+        size_t m_len,
+        const HAP_ed25519_verify_ctx* ctx) {
+    const EVP_PKEY_Handle* handle = (const EVP_PKEY_Handle*) ctx;
+    int ret;
+    WITH_CTX(EVP_MD_CTX, EVP_MD_CTX_new(), {
+        ret = EVP_DigestVerifyInit(ctx, NULL, NULL, NULL, handle->key);
+        HAPAssert(ret == 1);
+        ret = EVP_DigestVerify(ctx, sig, ED25519_BYTES, m, m_len);
+    });
+    return (ret == 1) ? 0 : -1;
+}
+
+void HAP_ed25519_verify_done(HAP_ed25519_verify_ctx* ctx) {
+    EVP_PKEY_Handle* handle = (EVP_PKEY_Handle*) ctx;
+    EVP_PKEY_free(handle->key);
+    handle->key = NULL;
+}
+
 void HAP_X25519_scalarmult_base(uint8_t r[X25519_BYTES], const uint8_t n[X25519_SCALAR_BYTES]) {
     WITH_PKEY(key, EVP_PKEY_new_raw_private_key(EVP_PKEY_X25519, NULL, n, X25519_SCALAR_BYTES), {
         size_t len = X25519_BYTES;
@@ -436,6 +501,15 @@ static void copy_and_free_if_overlapping(uint8_t** tmp, uint8_t** out, size_t n)
     }
 }
 
+// HAP uses 64-bit nonces, but OpenSSL 3 only accepts 96-bit nonces for ChaCha20-Poly1305.
+// Shorter nonces are left-padded with zeros, as OpenSSL 1.1 did internally and as the MbedTLS backend does.
+static const uint8_t* expand_nonce(uint8_t nonce[CHACHA20_POLY1305_NONCE_BYTES_MAX], const uint8_t* n, size_t n_len) {
+    HAPPrecondition(n_len <= CHACHA20_POLY1305_NONCE_BYTES_MAX);
+    memset(nonce, 0, CHACHA20_POLY1305_NONCE_BYTES_MAX - n_len);
+    memcpy(&nonce[CHACHA20_POLY1305_NONCE_BYTES_MAX - n_len], n, n_len);
+    return nonce;
+}
+
 void HAP_chacha20_poly1305_init(
         HAP_chacha20_poly1305_ctx* ctx,
         const uint8_t* n HAP_UNUSED,
@@ -461,9 +535,10 @@ void HAP_chacha20_poly1305_update_enc(
         HAPAssert(ret == 1);
         ret = EVP_CIPHER_CTX_ctrl(handle->ctx, EVP_CTRL_AEAD_SET_TAG, CHACHA20_POLY1305_TAG_BYTES, NULL);
         HAPAssert(ret == 1);
-        ret = EVP_CIPHER_CTX_ctrl(handle->ctx, EVP_CTRL_AEAD_SET_IVLEN, n_len, NULL);
+        ret = EVP_CIPHER_CTX_ctrl(handle->ctx, EVP_CTRL_AEAD_SET_IVLEN, CHACHA20_POLY1305_NONCE_BYTES_MAX, NULL);
         HAPAssert(ret == 1);
-        ret = EVP_EncryptInit_ex(handle->ctx, NULL, NULL, k, n);
+        uint8_t nonce[CHACHA20_POLY1305_NONCE_BYTES_MAX];
+        ret = EVP_EncryptInit_ex(handle->ctx, NULL, NULL, k, expand_nonce(nonce, n, n_len));
         HAPAssert(ret == 1);
     }
     if (m_len > 0) {
@@ -514,9 +589,10 @@ void HAP_chacha20_poly1305_update_dec(
         handle->ctx = EVP_CIPHER_CTX_new();
         ret = EVP_DecryptInit_ex(handle->ctx, EVP_chacha20_poly1305(), 0, 0, 0);
         HAPAssert(ret == 1);
-        ret = EVP_CIPHER_CTX_ctrl(handle->ctx, EVP_CTRL_AEAD_SET_IVLEN, n_len, NULL);
+        ret = EVP_CIPHER_CTX_ctrl(handle->ctx, EVP_CTRL_AEAD_SET_IVLEN, CHACHA20_POLY1305_NONCE_BYTES_MAX, NULL);
         HAPAssert(ret == 1);
-        ret = EVP_DecryptInit_ex(handle->ctx, NULL, NULL, k, n);
+        uint8_t nonce[CHACHA20_POLY1305_NONCE_BYTES_MAX];
+        ret = EVP_DecryptInit_ex(handle->ctx, NULL, NULL, k, expand_nonce(nonce, n, n_len));
         HAPAssert(ret == 1);
     }
     if (c_len > 0) {
@@ -264,6 +264,12 @@ static id pop(NSMutableArray* array) {
             if (delegate.handleConnectedCentral) {
                 delegate.handleConnectedCentral(blePeripheralManager, connectionHandle, delegate.context);
             }
+            // Read responses are sent in chunks of maximumUpdateValueLength bytes (see didReceiveReadRequest).
+            // Report the ATT MTU for which an ATT response carries a chunk of that size.
+            size_t mtu = central.maximumUpdateValueLength + 1;
+            if (delegate.handleUpdatedMTU && mtu > kHAPPlatformBLEPeripheralManager_DefaultMTU && mtu <= UINT16_MAX) {
+                delegate.handleUpdatedMTU(blePeripheralManager, connectionHandle, (uint16_t) mtu, delegate.context);
+            }
         }
     }
 }
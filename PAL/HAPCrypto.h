@@ -31,6 +31,32 @@ int HAP_ed25519_verify(
         size_t m_len,
         const uint8_t pk[ED25519_PUBLIC_KEY_BYTES]);
 
+// Signing context that keeps a secret key in expanded form, so that it can sign repeatedly without re-deriving it.
+typedef HAP_OPAQUE(96) HAP_ed25519_sign_ctx;
+
+void HAP_ed25519_sign_init(
+        HAP_ed25519_sign_ctx* ctx,
+        const uint8_t sk[ED25519_SECRET_KEY_BYTES],
+        const uint8_t pk[ED25519_PUBLIC_KEY_BYTES]);
+void HAP_ed25519_sign_with_ctx(
+        uint8_t sig[ED25519_BYTES],
+        const HAP_ed25519_sign_ctx* ctx,
+        const uint8_t* m,
+        size_t m_len);
+void HAP_ed25519_sign_done(HAP_ed25519_sign_ctx* ctx);
+
+// Verification context that keeps a public key in verification-ready form, so that it can verify repeatedly.
+// HAP_ed25519_verify_init returns -1 if the context could not be allocated.
+typedef HAP_OPAQUE(32) HAP_ed25519_verify_ctx;
+
+int HAP_ed25519_verify_init(HAP_ed25519_verify_ctx* ctx, const uint8_t pk[ED25519_PUBLIC_KEY_BYTES]);
+int HAP_ed25519_verify_with_ctx(
+        const uint8_t sig[ED25519_BYTES],
+        const uint8_t* m,
+        size_t m_len,
+        const HAP_ed25519_verify_ctx* ctx);
+void HAP_ed25519_verify_done(HAP_ed25519_verify_ctx* ctx);
+
 #define X25519_SCALAR_BYTES 32
 #define X25519_BYTES        32
 
@@ -16,6 +16,38 @@ const HAPLogObject kHAPLog_Default = { .subsystem = NULL, .category = NULL };
  */
 #define kHAPLogMessage_MaxBytes ((size_t)(2 * 1024))
 
+/**
+ * Checks whether log messages of a log type are enabled for a log object.
+ *
+ * @param      log                  Log object.
+ * @param      type                 Log type.
+ *
+ * @return true                     If log messages of the log type are enabled.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool IsLogTypeEnabled(const HAPLogObject* log, HAPLogType type) {
+    HAPPrecondition(log);
+
+    HAPPlatformLogEnabledTypes enabledTypes = HAPPlatformLogGetEnabledTypes(log);
+    switch (enabledTypes) {
+        case kHAPPlatformLogEnabledTypes_None: {
+            return false;
+        }
+        case kHAPPlatformLogEnabledTypes_Default: {
+            return type != kHAPLogType_Info && type != kHAPLogType_Debug;
+        }
+        case kHAPPlatformLogEnabledTypes_Info: {
+            return type != kHAPLogType_Debug;
+        }
+        case kHAPPlatformLogEnabledTypes_Debug: {
+            return true;
+        }
+    }
+    HAPFatalError();
+}
+
+#if !HAP_LOG_BINARY
 HAP_PRINTFLIKE(5, 0)
 static void
         Capture(const HAPLogObject* _Nullable const log,
@@ -26,30 +58,10 @@ static void
                 va_list args) {
     HAPError err;
 
-    if (!log) {
+    if (!log || !IsLogTypeEnabled(HAPNonnull(log), type)) {
         return;
     }
 
-    // Check if logs are enabled.
-    HAPPlatformLogEnabledTypes enabledTypes = HAPPlatformLogGetEnabledTypes(log);
-    switch (enabledTypes) {
-        case kHAPPlatformLogEnabledTypes_None: {
-            return;
-        }
-        case kHAPPlatformLogEnabledTypes_Default: {
-            if (type == kHAPLogType_Info || type == kHAPLogType_Debug) {
-                return;
-            }
-        } break;
-        case kHAPPlatformLogEnabledTypes_Info: {
-            if (type == kHAPLogType_Debug) {
-                return;
-            }
-        } break;
-        case kHAPPlatformLogEnabledTypes_Debug: {
-        } break;
-    }
-
     // Format log message.
     char message[kHAPLogMessage_MaxBytes];
     HAPRawBufferZero(message, sizeof message);
@@ -168,3 +180,803 @@ void HAPLogFaultInternal(const HAPLogObject* _Nullable log, const char* format,
     Capture(log, /* bufferBytes: */ NULL, /* numBufferBytes: */ 0, kHAPLogType_Fault, format, args);
     va_end(args);
 }
+#endif
+
+//----------------------------------------------------------------------------------------------------------------------
+// Binary logging.
+
+/**
+ * Maximum length of a string argument in a binary log record. Longer strings are truncated.
+ */
+#define kHAPLogBinaryString_MaxBytes ((size_t) 255)
+
+/**
+ * Length of the binary log record header: record type and body length.
+ */
+#define kHAPLogBinaryRecordHeader_NumBytes ((size_t) 3)
+
+/**
+ * Conversion specification of a format string.
+ */
+typedef struct {
+    /** Flags and width, prefixed with a '%'. NULL-terminated. */
+    char prefix[16];
+
+    /** Length modifier. 0 = none, 1 = 'l', 2 = 'll', 3 = 'z'. */
+    uint32_t length;
+
+    /** Conversion type. */
+    char type;
+} Conversion;
+
+/**
+ * Parses a conversion specification, accepting the same syntax as HAPStringWithFormat.
+ *
+ * @param      format               Format string, pointing to the character after the '%'.
+ * @param[out] conversion           Conversion specification.
+ *
+ * @return Format string, pointing to the character after the conversion specification. NULL if the specification is
+ *         too long.
+ */
+HAP_RESULT_USE_CHECK
+static const char* _Nullable ParseConversion(const char* format, Conversion* conversion) {
+    HAPPrecondition(format);
+    HAPPrecondition(conversion);
+
+    HAPRawBufferZero(conversion, sizeof *conversion);
+    size_t n = 0;
+    conversion->prefix[n++] = '%';
+    while (*format == '0' || *format == '+' || *format == ' ') {
+        if (n == sizeof conversion->prefix - 1) {
+            return NULL;
+        }
+        conversion->prefix[n++] = *format++;
+    }
+    while (*format >= '0' && *format <= '9') {
+        if (n == sizeof conversion->prefix - 1) {
+            return NULL;
+        }
+        conversion->prefix[n++] = *format++;
+    }
+    if (*format == 'l') {
+        conversion->length = 1;
+        format++;
+        if (*format == 'l') {
+            conversion->length = 2;
+            format++;
+        }
+    } else if (*format == 'z') {
+        conversion->length = 3;
+        format++;
+    }
+    conversion->type = *format;
+    return *format ? format + 1 : format;
+}
+
+/**
+ * Binary log record writer.
+ */
+typedef struct {
+    uint8_t* bytes;
+    size_t maxBytes;
+    size_t numBytes;
+} BinaryWriter;
+
+HAP_RESULT_USE_CHECK
+static HAPError AppendBytes(BinaryWriter* writer, const void* bytes, size_t numBytes) {
+    HAPPrecondition(writer);
+    HAPPrecondition(bytes);
+
+    if (numBytes > writer->maxBytes - writer->numBytes) {
+        return kHAPError_OutOfResources;
+    }
+    HAPRawBufferCopyBytes(&writer->bytes[writer->numBytes], bytes, numBytes);
+    writer->numBytes += numBytes;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError AppendVarint(BinaryWriter* writer, uint64_t value) {
+    HAPPrecondition(writer);
+
+    do {
+        uint8_t byte = (uint8_t)(value & 0x7FU);
+        value >>= 7U;
+        if (value) {
+            byte |= 0x80U;
+        }
+        HAPError err = AppendBytes(writer, &byte, sizeof byte);
+        if (err) {
+            return err;
+        }
+    } while (value);
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError AppendSignedVarint(BinaryWriter* writer, int64_t value) {
+    HAPPrecondition(writer);
+
+    return AppendVarint(writer, ((uint64_t) value << 1U) ^ (uint64_t)(value >> 63));
+}
+
+/**
+ * Finishes a binary log record that has been written after the record header.
+ *
+ * @param      writer               Writer.
+ * @param      recordType           Record type.
+ * @param[out] numBytes             Length of the serialized record.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_OutOfResources If the record body is too long.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError FinishRecord(BinaryWriter* writer, HAPLogBinaryRecordType recordType, size_t* numBytes) {
+    HAPPrecondition(writer);
+    HAPPrecondition(writer->numBytes >= kHAPLogBinaryRecordHeader_NumBytes);
+    HAPPrecondition(numBytes);
+
+    size_t numBodyBytes = writer->numBytes - kHAPLogBinaryRecordHeader_NumBytes;
+    if (numBodyBytes > UINT16_MAX) {
+        return kHAPError_OutOfResources;
+    }
+    writer->bytes[0] = recordType;
+    HAPWriteLittleUInt16(&writer->bytes[1], numBodyBytes);
+    *numBytes = writer->numBytes;
+    return kHAPError_None;
+}
+
+#if defined(__ELF__)
+/**
+ * Start of the section that contains binary log format strings. Provided by the linker.
+ */
+extern const char __start_hap_log_formats[] __attribute__((weak));
+
+/**
+ * Returns the offset of a string relative to the start of the kHAPLogBinaryFormatSection section.
+ *
+ * @param      string               String literal.
+ *
+ * @return Offset of the string.
+ */
+HAP_RESULT_USE_CHECK
+static int64_t GetStringOffset(const char* string) {
+    HAPPrecondition(string);
+    HAPPrecondition(__start_hap_log_formats);
+
+    return (int64_t)((uintptr_t) string - (uintptr_t) __start_hap_log_formats);
+}
+
+const char* _Nullable HAPLogBinaryGetString(void* _Nullable context HAP_UNUSED, int64_t offset) {
+    if (!__start_hap_log_formats) {
+        return NULL;
+    }
+    return (const char*) ((uintptr_t) __start_hap_log_formats + (uintptr_t) offset);
+}
+
+/**
+ * Checks whether all conversions of a format string can be encoded into a binary log record.
+ *
+ * @param      format               Format string.
+ *
+ * @return true                     If all conversions are supported.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool IsFormatSupported(const char* format) {
+    HAPPrecondition(format);
+
+    for (const char* c = format; *c;) {
+        if (*c++ != '%') {
+            continue;
+        }
+        Conversion conversion;
+        const char* _Nullable next = ParseConversion(c, &conversion);
+        if (!next) {
+            return false;
+        }
+        c = HAPNonnull(next);
+        switch (conversion.type) {
+            case '%':
+            case 'd':
+            case 'i':
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'p':
+            case 'c':
+            case 'g':
+            case 's': {
+            } break;
+            default: {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError EncodeRecord(
+        void* bytes,
+        size_t maxBytes,
+        size_t* numBytes,
+        HAPTime time,
+        const HAPLogObject* log,
+        HAPLogType type,
+        const void* _Nullable bufferBytes,
+        size_t numBufferBytes,
+        const char* format,
+        ...) {
+    va_list args;
+    va_start(args, format);
+    HAPError err = HAPLogBinaryEncodeRecordWithArguments(
+            bytes, maxBytes, numBytes, time, log, type, bufferBytes, numBufferBytes, format, args);
+    va_end(args);
+    return err;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPLogBinaryEncodeRecordWithArguments(
+        void* bytes,
+        size_t maxBytes,
+        size_t* numBytes,
+        HAPTime time,
+        const HAPLogObject* log,
+        HAPLogType type,
+        const void* _Nullable bufferBytes,
+        size_t numBufferBytes,
+        const char* format,
+        va_list arguments) {
+    HAPPrecondition(bytes);
+    HAPPrecondition(numBytes);
+    HAPPrecondition(log);
+    HAPPrecondition(!numBufferBytes || bufferBytes);
+    HAPPrecondition(format);
+
+    HAPError err;
+
+    // The arguments of conversions that cannot be encoded are unknown. The format string is logged as text instead.
+    if (!IsFormatSupported(format)) {
+        return EncodeRecord(
+                bytes,
+                maxBytes,
+                numBytes,
+                time,
+                log,
+                type,
+                bufferBytes,
+                numBufferBytes,
+                HAPLogBinaryFormat("<Unsupported log format> %s"),
+                format);
+    }
+
+    if (maxBytes < kHAPLogBinaryRecordHeader_NumBytes) {
+        return kHAPError_OutOfResources;
+    }
+    BinaryWriter writer = { .bytes = bytes, .maxBytes = maxBytes, .numBytes = kHAPLogBinaryRecordHeader_NumBytes };
+
+    uint8_t flags = 0;
+    if (log->subsystem) {
+        flags |= kHAPLogBinaryRecordFlags_Subsystem;
+    }
+    if (log->category) {
+        flags |= kHAPLogBinaryRecordFlags_Category;
+    }
+    if (bufferBytes) {
+        flags |= kHAPLogBinaryRecordFlags_Buffer;
+    }
+    uint8_t typeByte = type;
+    err = AppendVarint(&writer, time);
+    if (!err) {
+        err = AppendBytes(&writer, &typeByte, sizeof typeByte);
+    }
+    if (!err) {
+        err = AppendBytes(&writer, &flags, sizeof flags);
+    }
+    if (!err && log->subsystem) {
+        err = AppendSignedVarint(&writer, GetStringOffset(HAPNonnull(log->subsystem)));
+    }
+    if (!err && log->category) {
+        err = AppendSignedVarint(&writer, GetStringOffset(HAPNonnull(log->category)));
+    }
+    if (!err) {
+        int64_t formatOffset = GetStringOffset(format);
+        HAPPrecondition(formatOffset >= 0);
+        err = AppendVarint(&writer, (uint64_t) formatOffset);
+    }
+    if (err) {
+        return err;
+    }
+
+    // Arguments.
+    for (const char* c = format; *c;) {
+        if (*c++ != '%') {
+            continue;
+        }
+        Conversion conversion;
+        const char* _Nullable next = ParseConversion(c, &conversion);
+        HAPAssert(next);
+        c = HAPNonnull(next);
+        switch (conversion.type) {
+            case '%': {
+            } break;
+            case 'd':
+            case 'i': {
+                int64_t value;
+                if (conversion.length == 0) {
+                    value = (int64_t) va_arg(arguments, int);
+                } else if (conversion.length == 1) {
+                    value = (int64_t) va_arg(arguments, long);
+                } else if (conversion.length == 2) {
+                    value = (int64_t) va_arg(arguments, long long);
+                } else {
+                    value = (int64_t) va_arg(arguments, size_t);
+                }
+                err = AppendSignedVarint(&writer, value);
+            } break;
+            case 'u':
+            case 'x':
+            case 'X': {
+                uint64_t value;
+                if (conversion.length == 0) {
+                    value = (uint64_t) va_arg(arguments, unsigned int);
+                } else if (conversion.length == 1) {
+                    value = (uint64_t) va_arg(arguments, unsigned long);
+                } else if (conversion.length == 2) {
+                    value = (uint64_t) va_arg(arguments, unsigned long long);
+                } else {
+                    value = (uint64_t) va_arg(arguments, size_t);
+                }
+                err = AppendVarint(&writer, value);
+            } break;
+            case 'p': {
+                err = AppendVarint(&writer, (uint64_t)(uintptr_t) va_arg(arguments, void*));
+            } break;
+            case 'c': {
+                uint8_t value = (uint8_t) va_arg(arguments, int);
+                err = AppendBytes(&writer, &value, sizeof value);
+            } break;
+            case 'g': {
+                double value = va_arg(arguments, double);
+                uint64_t bitPattern;
+                HAPAssert(sizeof bitPattern == sizeof value);
+                HAPRawBufferCopyBytes(&bitPattern, &value, sizeof bitPattern);
+                uint8_t valueBytes[sizeof bitPattern];
+                HAPWriteLittleUInt64(valueBytes, bitPattern);
+                err = AppendBytes(&writer, valueBytes, sizeof valueBytes);
+            } break;
+            case 's': {
+                const char* _Nullable value = va_arg(arguments, const char*);
+                if (!value) {
+                    value = "(null)";
+                }
+                size_t numValueBytes = HAPStringGetNumBytes(HAPNonnull(value));
+                if (numValueBytes > kHAPLogBinaryString_MaxBytes) {
+                    numValueBytes = kHAPLogBinaryString_MaxBytes;
+                }
+                err = AppendVarint(&writer, numValueBytes);
+                if (!err) {
+                    err = AppendBytes(&writer, HAPNonnull(value), numValueBytes);
+                }
+            } break;
+            default: {
+                HAPFatalError();
+            }
+        }
+        if (err) {
+            return err;
+        }
+    }
+
+    // Buffer.
+    if (bufferBytes) {
+        err = AppendVarint(&writer, numBufferBytes);
+        if (err) {
+            return err;
+        }
+        // The number of stored bytes is encoded in at most 3 bytes.
+        size_t numRemainingBytes = writer.maxBytes - writer.numBytes;
+        size_t numStoredBytes = numRemainingBytes > 3 ? numRemainingBytes - 3 : 0;
+        if (numStoredBytes > numBufferBytes) {
+            numStoredBytes = numBufferBytes;
+        }
+        err = AppendVarint(&writer, numStoredBytes);
+        if (!err) {
+            err = AppendBytes(&writer, HAPNonnullVoid(bufferBytes), numStoredBytes);
+        }
+        if (err) {
+            return err;
+        }
+    }
+
+    return FinishRecord(&writer, kHAPLogBinaryRecordType_Message, numBytes);
+}
+
+#if HAP_LOG_BINARY
+void HAPLogBinaryInternal(
+        const HAPLogObject* _Nullable log,
+        const void* _Nullable bufferBytes,
+        size_t numBufferBytes,
+        HAPLogType type,
+        const char* format,
+        ...) {
+    HAPError err;
+
+    if (!log || !IsLogTypeEnabled(HAPNonnull(log), type)) {
+        return;
+    }
+
+    // The platform clock may log itself, for example when it is first used. Nested messages are logged without time.
+    static volatile bool isReadingClock;
+    HAPTime now = 0;
+    if (!isReadingClock) {
+        isReadingClock = true;
+        now = HAPPlatformClockGetCurrent();
+        isReadingClock = false;
+    }
+
+    uint8_t bytes[kHAPLogBinaryRecord_MaxBytes];
+    size_t numBytes;
+
+    va_list args;
+    va_start(args, format);
+    err = HAPLogBinaryEncodeRecordWithArguments(
+            bytes, sizeof bytes, &numBytes, now, HAPNonnull(log), type, bufferBytes, numBufferBytes, format, args);
+    va_end(args);
+    if (err) {
+        HAPAssert(err == kHAPError_OutOfResources);
+        err = EncodeRecord(
+                bytes,
+                sizeof bytes,
+                &numBytes,
+                now,
+                HAPNonnull(log),
+                kHAPLogType_Error,
+                /* bufferBytes: */ NULL,
+                /* numBufferBytes: */ 0,
+                HAPLogBinaryFormat("<Log message too long>"));
+        HAPAssert(!err);
+        type = kHAPLogType_Error;
+    }
+
+    HAPPlatformLogCaptureBinary(HAPNonnull(log), type, bytes, numBytes);
+}
+#endif
+#endif
+
+HAP_RESULT_USE_CHECK
+HAPError HAPLogBinaryEncodeDroppedRecord(void* bytes, size_t maxBytes, size_t* numBytes, uint64_t numDroppedMessages) {
+    HAPPrecondition(bytes);
+    HAPPrecondition(numBytes);
+
+    if (maxBytes < kHAPLogBinaryRecordHeader_NumBytes) {
+        return kHAPError_OutOfResources;
+    }
+    BinaryWriter writer = { .bytes = bytes, .maxBytes = maxBytes, .numBytes = kHAPLogBinaryRecordHeader_NumBytes };
+    HAPError err = AppendVarint(&writer, numDroppedMessages);
+    if (err) {
+        return err;
+    }
+    return FinishRecord(&writer, kHAPLogBinaryRecordType_Dropped, numBytes);
+}
+
+/**
+ * Binary log record reader.
+ */
+typedef struct {
+    const uint8_t* bytes;
+    size_t numBytes;
+    size_t offset;
+} BinaryReader;
+
+HAP_RESULT_USE_CHECK
+static HAPError ReadBytes(BinaryReader* reader, const uint8_t* _Nullable* _Nonnull bytes, size_t numBytes) {
+    HAPPrecondition(reader);
+    HAPPrecondition(bytes);
+
+    if (numBytes > reader->numBytes - reader->offset) {
+        return kHAPError_InvalidData;
+    }
+    *bytes = &reader->bytes[reader->offset];
+    reader->offset += numBytes;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError ReadVarint(BinaryReader* reader, uint64_t* value) {
+    HAPPrecondition(reader);
+    HAPPrecondition(value);
+
+    *value = 0;
+    for (uint32_t shift = 0; shift < 64; shift += 7) {
+        if (reader->offset == reader->numBytes) {
+            return kHAPError_InvalidData;
+        }
+        uint8_t byte = reader->bytes[reader->offset++];
+        *value |= (uint64_t)(byte & 0x7FU) << shift;
+        if (!(byte & 0x80U)) {
+            return kHAPError_None;
+        }
+    }
+    return kHAPError_InvalidData;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError ReadSignedVarint(BinaryReader* reader, int64_t* value) {
+    HAPPrecondition(reader);
+    HAPPrecondition(value);
+
+    uint64_t zigzagValue;
+    HAPError err = ReadVarint(reader, &zigzagValue);
+    if (err) {
+        return err;
+    }
+    *value = (int64_t)(zigzagValue >> 1U) ^ -(int64_t)(zigzagValue & 1U);
+    return kHAPError_None;
+}
+
+/**
+ * Decodes the arguments of a binary log message and formats the log message.
+ *
+ * @param      reader               Reader, positioned at the first argument.
+ * @param      format               Format string.
+ * @param[out] bytes                Buffer to format the log message into.
+ * @param      maxBytes             Capacity of the buffer.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidData    If the arguments are malformed.
+ * @return kHAPError_OutOfResources If the buffer is not large enough.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError FormatMessage(BinaryReader* reader, const char* format, char* bytes, size_t maxBytes) {
+    HAPPrecondition(reader);
+    HAPPrecondition(format);
+    HAPPrecondition(bytes);
+
+    HAPError err;
+
+    if (!maxBytes) {
+        return kHAPError_OutOfResources;
+    }
+    size_t n = 0;
+    bytes[n] = '\0';
+    for (const char* c = format; *c;) {
+        if (*c != '%') {
+            if (n + 1 >= maxBytes) {
+                return kHAPError_OutOfResources;
+            }
+            bytes[n++] = *c++;
+            bytes[n] = '\0';
+            continue;
+        }
+        c++;
+        Conversion conversion;
+        const char* _Nullable next = ParseConversion(c, &conversion);
+        if (!next) {
+            return kHAPError_InvalidData;
+        }
+        c = HAPNonnull(next);
+
+        // Conversion specification for HAPStringWithFormat, with the flags and width of the original.
+        char specification[sizeof conversion.prefix + 4];
+        err = HAPStringWithFormat(specification, sizeof specification, "%s", conversion.prefix);
+        HAPAssert(!err);
+        size_t o = HAPStringGetNumBytes(specification);
+
+        switch (conversion.type) {
+            case '%': {
+                err = HAPStringWithFormat(&bytes[n], maxBytes - n, "%%");
+            } break;
+            case 'd':
+            case 'i':
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'p': {
+                specification[o++] = 'l';
+                specification[o++] = 'l';
+                specification[o++] = conversion.type == 'p' ? 'x' : conversion.type;
+                specification[o] = '\0';
+                if (conversion.type == 'd' || conversion.type == 'i') {
+                    int64_t value;
+                    err = ReadSignedVarint(reader, &value);
+                    if (!err) {
+                        err = HAPStringWithFormat(&bytes[n], maxBytes - n, specification, (long long) value);
+                    }
+                } else {
+                    uint64_t value;
+                    err = ReadVarint(reader, &value);
+                    if (!err && conversion.type == 'p') {
+                        err = HAPStringWithFormat(&bytes[n], maxBytes - n, "0x");
+                        n += HAPStringGetNumBytes(&bytes[n]);
+                    }
+                    if (!err) {
+                        err = HAPStringWithFormat(&bytes[n], maxBytes - n, specification, (unsigned long long) value);
+                    }
+                }
+            } break;
+            case 'c': {
+                specification[o++] = 'c';
+                specification[o] = '\0';
+                const uint8_t* value;
+                err = ReadBytes(reader, &value, 1);
+                if (!err) {
+                    err = HAPStringWithFormat(&bytes[n], maxBytes - n, specification, (char) value[0]);
+                }
+            } break;
+            case 'g': {
+                specification[o++] = 'g';
+                specification[o] = '\0';
+                const uint8_t* valueBytes;
+                err = ReadBytes(reader, &valueBytes, sizeof(uint64_t));
+                if (!err) {
+                    uint64_t bitPattern = HAPReadLittleUInt64(valueBytes);
+                    double value;
+                    HAPRawBufferCopyBytes(&value, &bitPattern, sizeof value);
+                    err = HAPStringWithFormat(&bytes[n], maxBytes - n, specification, value);
+                }
+            } break;
+            case 's': {
+                specification[o++] = 's';
+                specification[o] = '\0';
+                uint64_t numValueBytes;
+                err = ReadVarint(reader, &numValueBytes);
+                if (!err && numValueBytes > kHAPLogBinaryString_MaxBytes) {
+                    err = kHAPError_InvalidData;
+                }
+                const uint8_t* valueBytes;
+                if (!err) {
+                    err = ReadBytes(reader, &valueBytes, (size_t) numValueBytes);
+                }
+                if (!err) {
+                    char value[kHAPLogBinaryString_MaxBytes + 1];
+                    HAPRawBufferCopyBytes(value, valueBytes, (size_t) numValueBytes);
+                    value[numValueBytes] = '\0';
+                    err = HAPStringWithFormat(&bytes[n], maxBytes - n, specification, value);
+                }
+            } break;
+            default: {
+                err = kHAPError_InvalidData;
+            } break;
+        }
+        if (err) {
+            return err;
+        }
+        n += HAPStringGetNumBytes(&bytes[n]);
+    }
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPLogBinaryDecodeRecord(
+        const void* bytes,
+        size_t numBytes,
+        size_t* numRecordBytes,
+        HAPLogBinaryStringResolver resolveString,
+        void* _Nullable context,
+        char* messageBytes,
+        size_t maxMessageBytes,
+        HAPLogBinaryRecord* record) {
+    HAPPrecondition(bytes);
+    HAPPrecondition(numRecordBytes);
+    HAPPrecondition(resolveString);
+    HAPPrecondition(messageBytes);
+    HAPPrecondition(record);
+
+    HAPError err;
+
+    HAPRawBufferZero(record, sizeof *record);
+
+    const uint8_t* b = bytes;
+    if (numBytes < kHAPLogBinaryRecordHeader_NumBytes) {
+        return kHAPError_OutOfResources;
+    }
+    size_t numBodyBytes = HAPReadLittleUInt16(&b[1]);
+    if (numBodyBytes > numBytes - kHAPLogBinaryRecordHeader_NumBytes) {
+        return kHAPError_OutOfResources;
+    }
+    *numRecordBytes = kHAPLogBinaryRecordHeader_NumBytes + numBodyBytes;
+    BinaryReader reader = { .bytes = &b[kHAPLogBinaryRecordHeader_NumBytes], .numBytes = numBodyBytes };
+
+    switch (b[0]) {
+        case kHAPLogBinaryRecordType_Message: {
+            record->recordType = kHAPLogBinaryRecordType_Message;
+
+            uint64_t time;
+            err = ReadVarint(&reader, &time);
+            if (err) {
+                return err;
+            }
+            record->time = time;
+
+            const uint8_t* header;
+            err = ReadBytes(&reader, &header, 2);
+            if (err) {
+                return err;
+            }
+            if (header[0] > kHAPLogType_Fault) {
+                return kHAPError_InvalidData;
+            }
+            record->type = (HAPLogType) header[0];
+            uint8_t flags = header[1];
+
+            if (flags & kHAPLogBinaryRecordFlags_Subsystem) {
+                int64_t offset;
+                err = ReadSignedVarint(&reader, &offset);
+                if (err) {
+                    return err;
+                }
+                record->subsystem = resolveString(context, offset);
+                if (!record->subsystem) {
+                    return kHAPError_InvalidData;
+                }
+            }
+            if (flags & kHAPLogBinaryRecordFlags_Category) {
+                int64_t offset;
+                err = ReadSignedVarint(&reader, &offset);
+                if (err) {
+                    return err;
+                }
+                record->category = resolveString(context, offset);
+                if (!record->category) {
+                    return kHAPError_InvalidData;
+                }
+            }
+
+            uint64_t formatOffset;
+            err = ReadVarint(&reader, &formatOffset);
+            if (err) {
+                return err;
+            }
+            if (formatOffset > INT64_MAX) {
+                return kHAPError_InvalidData;
+            }
+            const char* _Nullable format = resolveString(context, (int64_t) formatOffset);
+            if (!format) {
+                return kHAPError_InvalidData;
+            }
+            err = FormatMessage(&reader, HAPNonnull(format), messageBytes, maxMessageBytes);
+            if (err) {
+                return err;
+            }
+            record->message = messageBytes;
+
+            if (flags & kHAPLogBinaryRecordFlags_Buffer) {
+                uint64_t numBufferBytes;
+                err = ReadVarint(&reader, &numBufferBytes);
+                if (err) {
+                    return err;
+                }
+                uint64_t numStoredBytes;
+                err = ReadVarint(&reader, &numStoredBytes);
+                if (err) {
+                    return err;
+                }
+                if (numStoredBytes > numBufferBytes || numStoredBytes > reader.numBytes - reader.offset) {
+                    return kHAPError_InvalidData;
+                }
+                const uint8_t* bufferBytes;
+                err = ReadBytes(&reader, &bufferBytes, (size_t) numStoredBytes);
+                HAPAssert(!err);
+                record->bufferBytes = bufferBytes;
+                record->numBufferBytes = (size_t) numStoredBytes;
+                record->numTruncatedBufferBytes = (size_t)(numBufferBytes - numStoredBytes);
+            }
+        } break;
+        case kHAPLogBinaryRecordType_Dropped: {
+            record->recordType = kHAPLogBinaryRecordType_Dropped;
+            err = ReadVarint(&reader, &record->numDroppedMessages);
+            if (err) {
+                return err;
+            }
+        } break;
+        default: {
+            return kHAPError_InvalidData;
+        }
+    }
+    if (reader.offset != reader.numBytes) {
+        return kHAPError_InvalidData;
+    }
+    return kHAPError_None;
+}
@@ -37,6 +37,19 @@ extern "C" {
 #error "Invalid HAP_LOG_SENSITIVE."
 #endif
 
+// Validate flag for binary logging.
+// 0 - Log messages are formatted when they are logged. Default.
+// 1 - Log messages are captured as binary records that reference their format string. See HAPLogBinaryDecodeRecord.
+#ifndef HAP_LOG_BINARY
+#define HAP_LOG_BINARY (0)
+#endif
+#if HAP_LOG_BINARY < 0 || HAP_LOG_BINARY > 1
+#error "Invalid HAP_LOG_BINARY."
+#endif
+#if HAP_LOG_BINARY && !defined(__ELF__)
+#error "HAP_LOG_BINARY requires an ELF target."
+#endif
+
 /**
  * Log object.
  */
@@ -534,10 +547,230 @@ HAP_ENUM_BEGIN(uint8_t, HAPLogType) {
         } \
     } while (0)
 
+//----------------------------------------------------------------------------------------------------------------------
+// Binary logging.
+//
+// When HAP_LOG_BINARY is set, log messages are not formatted when they are logged. Instead, a binary record is passed
+// to HAPPlatformLogCaptureBinary that contains the log object, the log type, the raw format arguments and the logged
+// buffer. Format strings are placed into the kHAPLogBinaryFormatSection section of the executable and are referenced
+// by their offset into that section. Subsystem and category strings must be string literals and are referenced
+// relative to the same section. The records are decoded offline using the executable, for example by the
+// LogDecoder tool.
+//
+// Record layout. Integers are little-endian, varints use 7 bits per byte starting with the least significant bits,
+// and signed varints are zigzag encoded.
+//
+// - uint8      Record type. See HAPLogBinaryRecordType.
+// - uint16     Length of the record body.
+// - Record body.
+//
+// Body of kHAPLogBinaryRecordType_Message records:
+//
+// - varint     Time at which the message was logged, in milliseconds. See HAPPlatformClockGetCurrent.
+// - uint8      Log type.
+// - uint8      Flags. See HAPLogBinaryRecordFlags.
+// - svarint    Offset of the subsystem string. Only present if kHAPLogBinaryRecordFlags_Subsystem is set.
+// - svarint    Offset of the category string. Only present if kHAPLogBinaryRecordFlags_Category is set.
+// - varint     Offset of the format string.
+// - For each conversion of the format string:
+//   - %d, %i:          svarint
+//   - %u, %x, %X, %p:  varint
+//   - %c:              uint8
+//   - %g:              float64
+//   - %s:              varint length, followed by the string. Strings may be truncated.
+// - Only present if kHAPLogBinaryRecordFlags_Buffer is set:
+//   - varint   Length of the logged buffer.
+//   - varint   Number of buffer bytes that follow. Buffers may be truncated.
+//   - Buffer bytes.
+//
+// Body of kHAPLogBinaryRecordType_Dropped records:
+//
+// - varint     Number of log messages that have been dropped.
+
+/**
+ * Name of the executable section that contains binary log format strings.
+ */
+#define kHAPLogBinaryFormatSection "hap_log_formats"
+
+/**
+ * Maximum length of a binary log record.
+ */
+#define kHAPLogBinaryRecord_MaxBytes ((size_t) 1024)
+
+/**
+ * Binary log record type.
+ */
+HAP_ENUM_BEGIN(uint8_t, HAPLogBinaryRecordType) {
+    /** Log message. */
+    kHAPLogBinaryRecordType_Message = 1,
+
+    /** Number of log messages that have been dropped, for example because a log buffer was full. */
+    kHAPLogBinaryRecordType_Dropped
+} HAP_ENUM_END(uint8_t, HAPLogBinaryRecordType);
+
+/**
+ * Binary log message flags.
+ */
+HAP_OPTIONS_BEGIN(uint8_t, HAPLogBinaryRecordFlags) {
+    /** The log object has a subsystem. */
+    kHAPLogBinaryRecordFlags_Subsystem = 1U << 0U,
+
+    /** The log object has a category. */
+    kHAPLogBinaryRecordFlags_Category = 1U << 1U,
+
+    /** A buffer has been logged. */
+    kHAPLogBinaryRecordFlags_Buffer = 1U << 2U
+} HAP_OPTIONS_END(uint8_t, HAPLogBinaryRecordFlags);
+
+/**
+ * Returns a string that is referenced by a binary log record.
+ *
+ * @param      context              Context.
+ * @param      offset               Offset of the string relative to the start of the format string section.
+ *
+ * @return String, if it could be resolved. NULL otherwise.
+ */
+typedef const char* _Nullable (*HAPLogBinaryStringResolver)(void* _Nullable context, int64_t offset);
+
+/**
+ * Decoded binary log record.
+ */
+typedef struct {
+    /** Record type. */
+    HAPLogBinaryRecordType recordType;
+
+    /** Time at which the message was logged. Only valid for kHAPLogBinaryRecordType_Message records. */
+    HAPTime time;
+
+    /** Log type. Only valid for kHAPLogBinaryRecordType_Message records. */
+    HAPLogType type;
+
+    /** Subsystem of the log object. */
+    const char* _Nullable subsystem;
+
+    /** Category of the log object. */
+    const char* _Nullable category;
+
+    /** Formatted log message. NULL-terminated. Only valid for kHAPLogBinaryRecordType_Message records. */
+    const char* _Nullable message;
+
+    /** Logged buffer. Points into the record. */
+    const void* _Nullable bufferBytes;
+
+    /** Number of logged buffer bytes that are available. */
+    size_t numBufferBytes;
+
+    /** Number of logged buffer bytes that have been truncated. */
+    size_t numTruncatedBufferBytes;
+
+    /** Number of dropped log messages. Only valid for kHAPLogBinaryRecordType_Dropped records. */
+    uint64_t numDroppedMessages;
+} HAPLogBinaryRecord;
+
+/**
+ * Encodes a binary log record that reports dropped log messages.
+ *
+ * @param[out] bytes                Buffer to serialize the record into.
+ * @param      maxBytes             Capacity of the buffer.
+ * @param[out] numBytes             Length of the serialized record.
+ * @param      numDroppedMessages   Number of dropped log messages.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_OutOfResources If the buffer is not large enough.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPLogBinaryEncodeDroppedRecord(void* bytes, size_t maxBytes, size_t* numBytes, uint64_t numDroppedMessages);
+
+/**
+ * Decodes the next binary log record.
+ *
+ * @param      bytes                Binary log data.
+ * @param      numBytes             Length of the binary log data.
+ * @param[out] numRecordBytes       Length of the decoded record.
+ * @param      resolveString        Function that resolves format, subsystem and category strings.
+ * @param      context              Context that is passed to the string resolver.
+ * @param[out] messageBytes         Buffer to format the log message into.
+ * @param      maxMessageBytes      Capacity of the message buffer.
+ * @param[out] record               Decoded record.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidData    If the binary log data is malformed or a string could not be resolved.
+ * @return kHAPError_OutOfResources If the log data does not contain a complete record or the message buffer is not
+ *                                  large enough.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPLogBinaryDecodeRecord(
+        const void* bytes,
+        size_t numBytes,
+        size_t* numRecordBytes,
+        HAPLogBinaryStringResolver resolveString,
+        void* _Nullable context,
+        char* messageBytes,
+        size_t maxMessageBytes,
+        HAPLogBinaryRecord* record);
+
+#if defined(__ELF__)
+/**
+ * Encodes a binary log message record.
+ *
+ * @param[out] bytes                Buffer to serialize the record into.
+ * @param      maxBytes             Capacity of the buffer.
+ * @param[out] numBytes             Length of the serialized record.
+ * @param      time                 Time at which the message was logged.
+ * @param      log                  Log object.
+ * @param      type                 Log type.
+ * @param      bufferBytes          Optional buffer containing data to log.
+ * @param      numBufferBytes       Length of buffer.
+ * @param      format               Format string. Must be placed into the kHAPLogBinaryFormatSection section.
+ *                                  If it contains conversions other than the ones listed in the record layout,
+ *                                  the format string itself is encoded as text and the arguments are not logged.
+ * @param      arguments            Arguments for the format string.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_OutOfResources If the buffer is not large enough.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPLogBinaryEncodeRecordWithArguments(
+        void* bytes,
+        size_t maxBytes,
+        size_t* numBytes,
+        HAPTime time,
+        const HAPLogObject* log,
+        HAPLogType type,
+        const void* _Nullable bufferBytes,
+        size_t numBufferBytes,
+        const char* format,
+        va_list arguments);
+
+/**
+ * Resolves strings of binary log records that have been captured by the running executable.
+ *
+ * @param      context              Unused.
+ * @param      offset               Offset of the string relative to the start of the format string section.
+ *
+ * @return String.
+ */
+const char* _Nullable HAPLogBinaryGetString(void* _Nullable context, int64_t offset);
+
+/**
+ * Places a format string into the kHAPLogBinaryFormatSection section.
+ *
+ * @param      format               Format string literal.
+ *
+ * @return Format string in the kHAPLogBinaryFormatSection section.
+ */
+#define HAPLogBinaryFormat(format) \
+    __extension__({ \
+        static const char hapLogBinaryFormat[] __attribute__((section(kHAPLogBinaryFormatSection))) = format; \
+        &hapLogBinaryFormat[0]; \
+    })
+#endif
+
 //----------------------------------------------------------------------------------------------------------------------
 // Internal functions. Do not use directly.
 
 /**@cond */
+#if !HAP_LOG_BINARY
 HAP_PRINTFLIKE(4, 5)
 void HAPLogBufferInternal(
         const HAPLogObject* _Nullable log,
@@ -602,6 +835,42 @@ HAP_DISALLOW_USE(HAPLogErrorInternal)
 HAP_PRINTFLIKE(2, 3)
 void HAPLogFaultInternal(const HAPLogObject* _Nullable log, const char* format, ...);
 HAP_DISALLOW_USE(HAPLogFaultInternal)
+#else
+HAP_PRINTFLIKE(1, 2)
+static inline void HAPLogBinaryCheckFormat(const char* format HAP_UNUSED, ...) {
+}
+
+void HAPLogBinaryInternal(
+        const HAPLogObject* _Nullable log,
+        const void* _Nullable bufferBytes,
+        size_t numBufferBytes,
+        HAPLogType type,
+        const char* format,
+        ...);
+
+// The format string is only checked. The arguments are not evaluated.
+#define HAPLogBinaryCapture(log, bufferBytes, numBufferBytes, type, format, ...) \
+    do { \
+        (void) sizeof(HAPLogBinaryCheckFormat(format, ##__VA_ARGS__), 0); \
+        HAPLogBinaryInternal(log, bufferBytes, numBufferBytes, type, HAPLogBinaryFormat(format), ##__VA_ARGS__); \
+    } while (0)
+
+#define HAPLogBufferInternal(log, bufferBytes, numBufferBytes, ...) \
+    HAPLogBinaryCapture(log, bufferBytes, numBufferBytes, kHAPLogType_Default, __VA_ARGS__)
+#define HAPLogBufferInfoInternal(log, bufferBytes, numBufferBytes, ...) \
+    HAPLogBinaryCapture(log, bufferBytes, numBufferBytes, kHAPLogType_Info, __VA_ARGS__)
+#define HAPLogBufferDebugInternal(log, bufferBytes, numBufferBytes, ...) \
+    HAPLogBinaryCapture(log, bufferBytes, numBufferBytes, kHAPLogType_Debug, __VA_ARGS__)
+#define HAPLogBufferErrorInternal(log, bufferBytes, numBufferBytes, ...) \
+    HAPLogBinaryCapture(log, bufferBytes, numBufferBytes, kHAPLogType_Error, __VA_ARGS__)
+#define HAPLogBufferFaultInternal(log, bufferBytes, numBufferBytes, ...) \
+    HAPLogBinaryCapture(log, bufferBytes, numBufferBytes, kHAPLogType_Fault, __VA_ARGS__)
+#define HAPLogInternal(log, ...)      HAPLogBinaryCapture(log, NULL, 0, kHAPLogType_Default, __VA_ARGS__)
+#define HAPLogInfoInternal(log, ...)  HAPLogBinaryCapture(log, NULL, 0, kHAPLogType_Info, __VA_ARGS__)
+#define HAPLogDebugInternal(log, ...) HAPLogBinaryCapture(log, NULL, 0, kHAPLogType_Debug, __VA_ARGS__)
+#define HAPLogErrorInternal(log, ...) HAPLogBinaryCapture(log, NULL, 0, kHAPLogType_Error, __VA_ARGS__)
+#define HAPLogFaultInternal(log, ...) HAPLogBinaryCapture(log, NULL, 0, kHAPLogType_Fault, __VA_ARGS__)
+#endif
 /**@endcond */
 
 #if __has_feature(nullability)
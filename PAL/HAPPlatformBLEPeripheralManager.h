@@ -50,6 +50,14 @@ typedef uint16_t HAPPlatformBLEPeripheralManagerAttributeHandle;
  */
 #define kHAPPlatformBLEPeripheralManager_MaxAttributeBytes ((size_t) 512)
 
+/**
+ * ATT MTU that is used until a larger ATT MTU has been negotiated.
+ *
+ * @see Bluetooth Core Specification Version 5
+ *      Vol 3 Part G Section 5.2.1 ATT_MTU
+ */
+#define kHAPPlatformBLEPeripheralManager_DefaultMTU ((uint16_t) 23)
+
 /**
  * Delegate that is used to monitor read, write, and subscription requests from remote central devices.
  */
@@ -160,6 +168,28 @@ typedef struct {
             HAPPlatformBLEPeripheralManagerRef blePeripheralManager,
             HAPPlatformBLEPeripheralManagerConnectionHandle connectionHandle,
             void* _Nullable context);
+
+    /**
+     * Invoked when the ATT MTU of a connection that was reported to the handleConnectedCentral callback has been
+     * negotiated through an "Exchange MTU Request".
+     *
+     * - If this callback is not invoked, an ATT MTU of kHAPPlatformBLEPeripheralManager_DefaultMTU is assumed.
+     *
+     * - The ATT MTU is used to size response fragments so that they are transferred in whole
+     *   "Read Response" and "Read Blob Response" operations.
+     *
+     * - Updates for a connection that is no longer active are ignored.
+     *
+     * @param      blePeripheralManager BLE peripheral manager.
+     * @param      connectionHandle     Connection handle of the central.
+     * @param      mtu                  Negotiated ATT MTU. At least kHAPPlatformBLEPeripheralManager_DefaultMTU.
+     * @param      context              The context pointer of the BLE peripheral manager delegate structure.
+     */
+    void (*_Nullable handleUpdatedMTU)(
+            HAPPlatformBLEPeripheralManagerRef blePeripheralManager,
+            HAPPlatformBLEPeripheralManagerConnectionHandle connectionHandle,
+            uint16_t mtu,
+            void* _Nullable context);
 } HAPPlatformBLEPeripheralManagerDelegate;
 
 /**
@@ -82,6 +82,19 @@ void HAPPlatformLogCapture(
         const void* _Nullable bufferBytes,
         size_t numBufferBytes) HAP_DIAGNOSE_ERROR(!bufferBytes && numBufferBytes, "empty buffer cannot have a length");
 
+/**
+ * Logs a binary log record.
+ *
+ * - Only used if HAP_LOG_BINARY is set. Log messages are then not formatted but are captured as binary records.
+ *   The record format is described in file HAPLog.h.
+ *
+ * @param      log                  Log object.
+ * @param      type                 Logging level.
+ * @param      bytes                Binary log record.
+ * @param      numBytes             Length of binary log record.
+ */
+void HAPPlatformLogCaptureBinary(const HAPLogObject* log, HAPLogType type, const void* bytes, size_t numBytes);
+
 #if __has_feature(nullability)
 #pragma clang assume_nonnull end
 #endif
@@ -84,6 +84,45 @@ HAPError HAPPlatformMFiHWAuthRead(
         void* bytes,
         size_t numBytes);
 
+/**
+ * Attempts to write data to the Apple Authentication Coprocessor without waiting.
+ *
+ * - While the Apple Authentication Coprocessor is processing a request it does not acknowledge transfers.
+ *   In that case this function returns immediately so that the caller may retry later.
+ *
+ * @param      mfiHWAuth            Apple Authentication Coprocessor provider.
+ * @param      bytes                Buffer to write.
+ * @param      numBytes             Length of buffer. Minimum 1. Maximum 128.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_Busy           If the Apple Authentication Coprocessor did not acknowledge the write.
+ * @return kHAPError_Unknown        If communication with the Apple Authentication Coprocessor failed.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformMFiHWAuthTryWrite(HAPPlatformMFiHWAuthRef mfiHWAuth, const void* bytes, size_t numBytes);
+
+/**
+ * Attempts to read a register from the Apple Authentication Coprocessor without waiting.
+ *
+ * - While the Apple Authentication Coprocessor is processing a request it does not acknowledge transfers.
+ *   In that case this function returns immediately so that the caller may retry later.
+ *
+ * @param      mfiHWAuth            Apple Authentication Coprocessor provider.
+ * @param      registerAddress      Address of the Apple Authentication Coprocessor register to read.
+ * @param      bytes                Result buffer.
+ * @param      numBytes             Length of buffer. Minimum 1. Maximum 128.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_Busy           If the Apple Authentication Coprocessor did not acknowledge the read.
+ * @return kHAPError_Unknown        If communication with the Apple Authentication Coprocessor failed.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformMFiHWAuthTryRead(
+        HAPPlatformMFiHWAuthRef mfiHWAuth,
+        uint8_t registerAddress,
+        void* bytes,
+        size_t numBytes);
+
 #if __has_feature(nullability)
 #pragma clang assume_nonnull end
 #endif
@@ -80,9 +80,18 @@ struct HAPPlatformBLEPeripheralManager {
     uint8_t numScanResponseBytes;
     HAPBLEAdvertisingInterval advertisingInterval;
 
+    HAPPlatformBLEPeripheralManagerConnectionHandle connectionHandle;
+    HAPPlatformTimerRef disconnectTimer;
+    struct {
+        HAPPlatformBLEPeripheralManagerAttributeHandle valueHandle;
+        uint8_t bytes[kHAPPlatformBLEPeripheralManager_DefaultMTU - 3];
+        uint8_t numBytes;
+    } indication;
+
     bool isDeviceAddressSet : 1;
     bool didPublishAttributes : 1;
     bool isConnected : 1;
+    bool isIndicationPending : 1;
     /**@endcond */
 };
 
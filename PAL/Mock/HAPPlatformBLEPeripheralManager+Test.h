@@ -66,6 +66,160 @@ HAPError HAPPlatformBLEPeripheralManagerGetAdvertisingData(
         size_t maxScanResponseBytes,
         size_t* numScanResponseBytes);
 
+/**
+ * Connects a simulated central to the BLE peripheral manager.
+ *
+ * - The central must be disconnected using HAPPlatformBLEPeripheralManagerDisconnectCentral.
+ *
+ * @param      blePeripheralManager BLE peripheral manager.
+ * @param[out] connectionHandle     Connection handle of the connected central.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If a central is already connected, or if the BLE peripheral manager is not
+ *                                  advertising.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformBLEPeripheralManagerConnectCentral(
+        HAPPlatformBLEPeripheralManagerRef blePeripheralManager,
+        HAPPlatformBLEPeripheralManagerConnectionHandle* connectionHandle);
+
+/**
+ * Disconnects the simulated central from the BLE peripheral manager.
+ *
+ * @param      blePeripheralManager BLE peripheral manager.
+ */
+void HAPPlatformBLEPeripheralManagerDisconnectCentral(HAPPlatformBLEPeripheralManagerRef blePeripheralManager);
+
+/**
+ * Returns whether a simulated central is connected to the BLE peripheral manager.
+ *
+ * - Connections that are cancelled through HAPPlatformBLEPeripheralManagerCancelCentralConnection are disconnected
+ *   once the clock is advanced.
+ *
+ * @param      blePeripheralManager BLE peripheral manager.
+ *
+ * @return true                     If a central is connected.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+bool HAPPlatformBLEPeripheralManagerIsCentralConnected(HAPPlatformBLEPeripheralManagerRef blePeripheralManager);
+
+/**
+ * Negotiates the ATT MTU of the connection with the simulated central.
+ *
+ * @param      blePeripheralManager BLE peripheral manager.
+ * @param      mtu                  ATT MTU. At least kHAPPlatformBLEPeripheralManager_DefaultMTU.
+ */
+void HAPPlatformBLEPeripheralManagerCentralExchangeMTU(
+        HAPPlatformBLEPeripheralManagerRef blePeripheralManager,
+        uint16_t mtu);
+
+/**
+ * Reads the value of an attribute as the simulated central.
+ *
+ * - The value is read in full, as by a "Read Request" followed by "Read Blob Requests".
+ *
+ * @param      blePeripheralManager BLE peripheral manager.
+ * @param      attributeHandle      Attribute handle to read.
+ * @param[out] bytes                Buffer to fill the attribute value into.
+ * @param      maxBytes             Capacity of buffer.
+ * @param[out] numBytes             Length of attribute value.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If the read was rejected.
+ * @return kHAPError_OutOfResources If the buffer is not large enough.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformBLEPeripheralManagerCentralReadAttribute(
+        HAPPlatformBLEPeripheralManagerRef blePeripheralManager,
+        HAPPlatformBLEPeripheralManagerAttributeHandle attributeHandle,
+        void* bytes,
+        size_t maxBytes,
+        size_t* numBytes);
+
+/**
+ * Writes the value of an attribute as the simulated central.
+ *
+ * @param      blePeripheralManager BLE peripheral manager.
+ * @param      attributeHandle      Attribute handle to write.
+ * @param      bytes                Attribute value.
+ * @param      numBytes             Length of attribute value.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If the write was rejected.
+ * @return kHAPError_InvalidData    If the attribute value has an invalid format.
+ * @return kHAPError_OutOfResources If the attribute value is too long.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformBLEPeripheralManagerCentralWriteAttribute(
+        HAPPlatformBLEPeripheralManagerRef blePeripheralManager,
+        HAPPlatformBLEPeripheralManagerAttributeHandle attributeHandle,
+        const void* bytes,
+        size_t numBytes);
+
+/**
+ * Receives and confirms a pending Handle Value Indication as the simulated central.
+ *
+ * - Confirming the indication lets the BLE peripheral manager send the next one.
+ *
+ * @param      blePeripheralManager BLE peripheral manager.
+ * @param[out] valueHandle          Handle of the Characteristic Value declaration whose value changed.
+ * @param[out] bytes                Buffer to fill the indicated value into.
+ * @param      maxBytes             Capacity of buffer.
+ * @param[out] numBytes             Length of indicated value.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If no indication is pending.
+ * @return kHAPError_OutOfResources If the buffer is not large enough.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformBLEPeripheralManagerCentralConfirmIndication(
+        HAPPlatformBLEPeripheralManagerRef blePeripheralManager,
+        HAPPlatformBLEPeripheralManagerAttributeHandle* valueHandle,
+        void* _Nullable bytes,
+        size_t maxBytes,
+        size_t* numBytes);
+
+/**
+ * Looks up the attribute handles of a published characteristic.
+ *
+ * - If multiple services or characteristics match, the first one is returned.
+ *
+ * @param      blePeripheralManager BLE peripheral manager.
+ * @param      serviceType          Type of the service that contains the characteristic.
+ * @param      characteristicType   Type of the characteristic.
+ * @param[out] valueHandle          Attribute handle of the Characteristic Value declaration.
+ * @param[out] cccDescriptorHandle  Attribute handle of the Client Characteristic Configuration descriptor, or 0.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If no matching characteristic has been added.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformBLEPeripheralManagerFindCharacteristic(
+        HAPPlatformBLEPeripheralManagerRef blePeripheralManager,
+        const HAPPlatformBLEPeripheralManagerUUID* serviceType,
+        const HAPPlatformBLEPeripheralManagerUUID* characteristicType,
+        HAPPlatformBLEPeripheralManagerAttributeHandle* valueHandle,
+        HAPPlatformBLEPeripheralManagerAttributeHandle* cccDescriptorHandle);
+
+/**
+ * Looks up the attribute handle of a published descriptor.
+ *
+ * @param      blePeripheralManager BLE peripheral manager.
+ * @param      valueHandle          Attribute handle of the Characteristic Value declaration of the characteristic.
+ * @param      descriptorType       Type of the descriptor.
+ * @param[out] descriptorHandle     Attribute handle of the descriptor.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If no matching descriptor has been added.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformBLEPeripheralManagerFindDescriptor(
+        HAPPlatformBLEPeripheralManagerRef blePeripheralManager,
+        HAPPlatformBLEPeripheralManagerAttributeHandle valueHandle,
+        const HAPPlatformBLEPeripheralManagerUUID* descriptorType,
+        HAPPlatformBLEPeripheralManagerAttributeHandle* descriptorHandle);
+
 #if __has_feature(nullability)
 #pragma clang assume_nonnull end
 #endif
@@ -409,14 +409,59 @@ HAPError HAPPlatformBLEPeripheralManagerGetAdvertisingData(
     return kHAPError_None;
 }
 
+/**
+ * Disconnects the connected central and informs the delegate.
+ *
+ * @param      blePeripheralManager BLE peripheral manager.
+ */
+static void DisconnectCentral(HAPPlatformBLEPeripheralManagerRef _Nonnull blePeripheralManager) {
+    HAPPrecondition(blePeripheralManager);
+    HAPPrecondition(blePeripheralManager->isConnected);
+
+    if (blePeripheralManager->disconnectTimer) {
+        HAPPlatformTimerDeregister(blePeripheralManager->disconnectTimer);
+        blePeripheralManager->disconnectTimer = 0;
+    }
+    blePeripheralManager->isConnected = false;
+    blePeripheralManager->isIndicationPending = false;
+    HAPRawBufferZero(&blePeripheralManager->indication, sizeof blePeripheralManager->indication);
+
+    if (blePeripheralManager->delegate.handleDisconnectedCentral) {
+        blePeripheralManager->delegate.handleDisconnectedCentral(
+                blePeripheralManager, blePeripheralManager->connectionHandle, blePeripheralManager->delegate.context);
+    }
+}
+
+static void DisconnectTimerExpired(HAPPlatformTimerRef timer, void* _Nullable context) {
+    HAPPrecondition(context);
+    HAPPlatformBLEPeripheralManagerRef blePeripheralManager = context;
+    HAPPrecondition(timer == blePeripheralManager->disconnectTimer);
+    blePeripheralManager->disconnectTimer = 0;
+
+    DisconnectCentral(blePeripheralManager);
+}
+
 void HAPPlatformBLEPeripheralManagerCancelCentralConnection(
         HAPPlatformBLEPeripheralManagerRef _Nonnull blePeripheralManager,
         HAPPlatformBLEPeripheralManagerConnectionHandle connectionHandle) {
     HAPPrecondition(blePeripheralManager);
+    HAPPrecondition(blePeripheralManager->isConnected);
+    HAPPrecondition(connectionHandle == blePeripheralManager->connectionHandle);
+
+    HAPError err;
+
+    if (blePeripheralManager->disconnectTimer) {
+        return;
+    }
 
-    (void) connectionHandle;
-    HAPLogError(&logObject, "[NYI] %s.", __func__);
-    HAPFatalError();
+    // Like on a Bluetooth stack, the disconnect is reported asynchronously.
+    err = HAPPlatformTimerRegister(
+            &blePeripheralManager->disconnectTimer, /* deadline: */ 0, DisconnectTimerExpired, blePeripheralManager);
+    if (err) {
+        HAPAssert(err == kHAPError_OutOfResources);
+        HAPLogError(&logObject, "Not enough resources to schedule disconnect.");
+        HAPFatalError();
+    }
 }
 
 HAPError HAPPlatformBLEPeripheralManagerSendHandleValueIndication(
@@ -426,10 +471,293 @@ HAPError HAPPlatformBLEPeripheralManagerSendHandleValueIndication(
         const void* _Nullable bytes,
         size_t numBytes) HAP_DIAGNOSE_ERROR(!bytes && numBytes, "empty buffer cannot have a length") {
     HAPPrecondition(blePeripheralManager);
+    HAPPrecondition(blePeripheralManager->isConnected);
+    HAPPrecondition(connectionHandle == blePeripheralManager->connectionHandle);
     HAPPrecondition(valueHandle);
     HAPPrecondition(!numBytes || bytes);
 
-    (void) connectionHandle;
-    HAPLogError(&logObject, "[NYI] %s.", __func__);
-    HAPFatalError();
+    if (blePeripheralManager->isIndicationPending) {
+        HAPLogDebug(&logObject, "Previous indication has not been confirmed yet.");
+        return kHAPError_InvalidState;
+    }
+    if (numBytes > sizeof blePeripheralManager->indication.bytes) {
+        HAPLog(&logObject, "Indication value too long (%zu bytes).", numBytes);
+        return kHAPError_OutOfResources;
+    }
+
+    blePeripheralManager->indication.valueHandle = valueHandle;
+    if (numBytes) {
+        HAPRawBufferCopyBytes(blePeripheralManager->indication.bytes, HAPNonnullVoid(bytes), numBytes);
+    }
+    blePeripheralManager->indication.numBytes = (uint8_t) numBytes;
+    blePeripheralManager->isIndicationPending = true;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformBLEPeripheralManagerConnectCentral(
+        HAPPlatformBLEPeripheralManagerRef _Nonnull blePeripheralManager,
+        HAPPlatformBLEPeripheralManagerConnectionHandle* _Nonnull connectionHandle) {
+    HAPPrecondition(blePeripheralManager);
+    HAPPrecondition(connectionHandle);
+
+    if (blePeripheralManager->isConnected) {
+        HAPLog(&logObject, "A central is already connected.");
+        return kHAPError_InvalidState;
+    }
+    if (!HAPPlatformBLEPeripheralManagerIsAdvertising(blePeripheralManager)) {
+        HAPLog(&logObject, "Not advertising.");
+        return kHAPError_InvalidState;
+    }
+
+    blePeripheralManager->connectionHandle++;
+    if (!blePeripheralManager->connectionHandle) {
+        blePeripheralManager->connectionHandle++;
+    }
+    blePeripheralManager->isConnected = true;
+    *connectionHandle = blePeripheralManager->connectionHandle;
+
+    if (blePeripheralManager->delegate.handleConnectedCentral) {
+        blePeripheralManager->delegate.handleConnectedCentral(
+                blePeripheralManager, blePeripheralManager->connectionHandle, blePeripheralManager->delegate.context);
+    }
+    return kHAPError_None;
+}
+
+void HAPPlatformBLEPeripheralManagerDisconnectCentral(
+        HAPPlatformBLEPeripheralManagerRef _Nonnull blePeripheralManager) {
+    HAPPrecondition(blePeripheralManager);
+    HAPPrecondition(blePeripheralManager->isConnected);
+
+    DisconnectCentral(blePeripheralManager);
+}
+
+HAP_RESULT_USE_CHECK
+bool HAPPlatformBLEPeripheralManagerIsCentralConnected(
+        HAPPlatformBLEPeripheralManagerRef _Nonnull blePeripheralManager) {
+    HAPPrecondition(blePeripheralManager);
+
+    return blePeripheralManager->isConnected;
+}
+
+void HAPPlatformBLEPeripheralManagerCentralExchangeMTU(
+        HAPPlatformBLEPeripheralManagerRef _Nonnull blePeripheralManager,
+        uint16_t mtu) {
+    HAPPrecondition(blePeripheralManager);
+    HAPPrecondition(blePeripheralManager->isConnected);
+    HAPPrecondition(mtu >= kHAPPlatformBLEPeripheralManager_DefaultMTU);
+
+    if (blePeripheralManager->delegate.handleUpdatedMTU) {
+        blePeripheralManager->delegate.handleUpdatedMTU(
+                blePeripheralManager,
+                blePeripheralManager->connectionHandle,
+                mtu,
+                blePeripheralManager->delegate.context);
+    }
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformBLEPeripheralManagerCentralReadAttribute(
+        HAPPlatformBLEPeripheralManagerRef _Nonnull blePeripheralManager,
+        HAPPlatformBLEPeripheralManagerAttributeHandle attributeHandle,
+        void* _Nonnull bytes,
+        size_t maxBytes,
+        size_t* _Nonnull numBytes) {
+    HAPPrecondition(blePeripheralManager);
+    HAPPrecondition(blePeripheralManager->isConnected);
+    HAPPrecondition(attributeHandle);
+    HAPPrecondition(bytes);
+    HAPPrecondition(numBytes);
+
+    if (blePeripheralManager->disconnectTimer) {
+        HAPLog(&logObject, "Rejecting read: Connection is being cancelled.");
+        return kHAPError_InvalidState;
+    }
+    if (!blePeripheralManager->delegate.handleReadRequest) {
+        HAPLog(&logObject, "Rejecting read: No delegate.");
+        return kHAPError_InvalidState;
+    }
+
+    // Bluetooth stacks provide a buffer that can hold the longest attribute value.
+    uint8_t valueBytes[kHAPPlatformBLEPeripheralManager_MaxAttributeBytes];
+    size_t numValueBytes;
+    HAPError err = blePeripheralManager->delegate.handleReadRequest(
+            blePeripheralManager,
+            blePeripheralManager->connectionHandle,
+            attributeHandle,
+            valueBytes,
+            sizeof valueBytes,
+            &numValueBytes,
+            blePeripheralManager->delegate.context);
+    if (err) {
+        HAPAssert(err == kHAPError_InvalidState || err == kHAPError_OutOfResources);
+        return err;
+    }
+    HAPAssert(numValueBytes <= sizeof valueBytes);
+    if (numValueBytes > maxBytes) {
+        HAPLog(&logObject, "Not enough space to store attribute value (%zu / %zu bytes).", maxBytes, numValueBytes);
+        return kHAPError_OutOfResources;
+    }
+    HAPRawBufferCopyBytes(bytes, valueBytes, numValueBytes);
+    *numBytes = numValueBytes;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformBLEPeripheralManagerCentralWriteAttribute(
+        HAPPlatformBLEPeripheralManagerRef _Nonnull blePeripheralManager,
+        HAPPlatformBLEPeripheralManagerAttributeHandle attributeHandle,
+        const void* _Nonnull bytes,
+        size_t numBytes) {
+    HAPPrecondition(blePeripheralManager);
+    HAPPrecondition(blePeripheralManager->isConnected);
+    HAPPrecondition(attributeHandle);
+    HAPPrecondition(bytes);
+
+    if (blePeripheralManager->disconnectTimer) {
+        HAPLog(&logObject, "Rejecting write: Connection is being cancelled.");
+        return kHAPError_InvalidState;
+    }
+    if (!blePeripheralManager->delegate.handleWriteRequest) {
+        HAPLog(&logObject, "Rejecting write: No delegate.");
+        return kHAPError_InvalidState;
+    }
+
+    // The delegate may modify the written value in place.
+    uint8_t valueBytes[kHAPPlatformBLEPeripheralManager_MaxAttributeBytes];
+    if (numBytes > sizeof valueBytes) {
+        HAPLog(&logObject, "Attribute value too long (%zu bytes).", numBytes);
+        return kHAPError_OutOfResources;
+    }
+    HAPRawBufferCopyBytes(valueBytes, bytes, numBytes);
+    return blePeripheralManager->delegate.handleWriteRequest(
+            blePeripheralManager,
+            blePeripheralManager->connectionHandle,
+            attributeHandle,
+            valueBytes,
+            numBytes,
+            blePeripheralManager->delegate.context);
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformBLEPeripheralManagerCentralConfirmIndication(
+        HAPPlatformBLEPeripheralManagerRef _Nonnull blePeripheralManager,
+        HAPPlatformBLEPeripheralManagerAttributeHandle* _Nonnull valueHandle,
+        void* _Nullable bytes,
+        size_t maxBytes,
+        size_t* _Nonnull numBytes) {
+    HAPPrecondition(blePeripheralManager);
+    HAPPrecondition(blePeripheralManager->isConnected);
+    HAPPrecondition(valueHandle);
+    HAPPrecondition(!maxBytes || bytes);
+    HAPPrecondition(numBytes);
+
+    if (!blePeripheralManager->isIndicationPending) {
+        return kHAPError_InvalidState;
+    }
+    if (blePeripheralManager->indication.numBytes > maxBytes) {
+        HAPLog(&logObject,
+               "Not enough space to store indication value (%zu / %u bytes).",
+               maxBytes,
+               blePeripheralManager->indication.numBytes);
+        return kHAPError_OutOfResources;
+    }
+    *valueHandle = blePeripheralManager->indication.valueHandle;
+    if (blePeripheralManager->indication.numBytes) {
+        HAPRawBufferCopyBytes(
+                HAPNonnullVoid(bytes),
+                blePeripheralManager->indication.bytes,
+                blePeripheralManager->indication.numBytes);
+    }
+    *numBytes = blePeripheralManager->indication.numBytes;
+    HAPRawBufferZero(&blePeripheralManager->indication, sizeof blePeripheralManager->indication);
+    blePeripheralManager->isIndicationPending = false;
+
+    // Handle Value Confirmation received.
+    if (blePeripheralManager->delegate.handleReadyToUpdateSubscribers) {
+        blePeripheralManager->delegate.handleReadyToUpdateSubscribers(
+                blePeripheralManager, blePeripheralManager->connectionHandle, blePeripheralManager->delegate.context);
+    }
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformBLEPeripheralManagerFindCharacteristic(
+        HAPPlatformBLEPeripheralManagerRef _Nonnull blePeripheralManager,
+        const HAPPlatformBLEPeripheralManagerUUID* _Nonnull serviceType,
+        const HAPPlatformBLEPeripheralManagerUUID* _Nonnull characteristicType,
+        HAPPlatformBLEPeripheralManagerAttributeHandle* _Nonnull valueHandle,
+        HAPPlatformBLEPeripheralManagerAttributeHandle* _Nonnull cccDescriptorHandle) {
+    HAPPrecondition(blePeripheralManager);
+    HAPPrecondition(serviceType);
+    HAPPrecondition(characteristicType);
+    HAPPrecondition(valueHandle);
+    HAPPrecondition(cccDescriptorHandle);
+
+    bool inMatchingService = false;
+    for (size_t i = 0; i < blePeripheralManager->numAttributes; i++) {
+        const HAPPlatformBLEPeripheralManagerAttribute* attribute = &blePeripheralManager->attributes[i];
+
+        switch (attribute->type) {
+            case kHAPPlatformBLEPeripheralManagerAttributeType_None: {
+            }
+                return kHAPError_InvalidState;
+            case kHAPPlatformBLEPeripheralManagerAttributeType_Service: {
+                inMatchingService = HAPRawBufferAreEqual(
+                        attribute->_.service.type.bytes, serviceType->bytes, sizeof serviceType->bytes);
+            } break;
+            case kHAPPlatformBLEPeripheralManagerAttributeType_Characteristic: {
+                if (inMatchingService &&
+                    HAPRawBufferAreEqual(
+                            attribute->_.characteristic.type.bytes,
+                            characteristicType->bytes,
+                            sizeof characteristicType->bytes)) {
+                    *valueHandle = attribute->_.characteristic.valueHandle;
+                    *cccDescriptorHandle = attribute->_.characteristic.cccDescriptorHandle;
+                    return kHAPError_None;
+                }
+            } break;
+            case kHAPPlatformBLEPeripheralManagerAttributeType_Descriptor: {
+            } break;
+        }
+    }
+    return kHAPError_InvalidState;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformBLEPeripheralManagerFindDescriptor(
+        HAPPlatformBLEPeripheralManagerRef _Nonnull blePeripheralManager,
+        HAPPlatformBLEPeripheralManagerAttributeHandle valueHandle,
+        const HAPPlatformBLEPeripheralManagerUUID* _Nonnull descriptorType,
+        HAPPlatformBLEPeripheralManagerAttributeHandle* _Nonnull descriptorHandle) {
+    HAPPrecondition(blePeripheralManager);
+    HAPPrecondition(valueHandle);
+    HAPPrecondition(descriptorType);
+    HAPPrecondition(descriptorHandle);
+
+    bool inMatchingCharacteristic = false;
+    for (size_t i = 0; i < blePeripheralManager->numAttributes; i++) {
+        const HAPPlatformBLEPeripheralManagerAttribute* attribute = &blePeripheralManager->attributes[i];
+
+        switch (attribute->type) {
+            case kHAPPlatformBLEPeripheralManagerAttributeType_None: {
+            }
+                return kHAPError_InvalidState;
+            case kHAPPlatformBLEPeripheralManagerAttributeType_Service: {
+                inMatchingCharacteristic = false;
+            } break;
+            case kHAPPlatformBLEPeripheralManagerAttributeType_Characteristic: {
+                inMatchingCharacteristic = attribute->_.characteristic.valueHandle == valueHandle;
+            } break;
+            case kHAPPlatformBLEPeripheralManagerAttributeType_Descriptor: {
+                if (inMatchingCharacteristic &&
+                    HAPRawBufferAreEqual(
+                            attribute->_.descriptor.type.bytes, descriptorType->bytes, sizeof descriptorType->bytes)) {
+                    *descriptorHandle = attribute->_.descriptor.handle;
+                    return kHAPError_None;
+                }
+            } break;
+        }
+    }
+    return kHAPError_InvalidState;
 }
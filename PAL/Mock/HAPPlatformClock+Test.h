@@ -24,6 +24,16 @@ extern "C" {
  */
 void HAPPlatformClockAdvance(HAPTime delta);
 
+/**
+ * Advances the clock by a given delta without processing expired timers.
+ *
+ * - Simulates code that blocks the run loop, e.g., a slow characteristic handler. May be called from callbacks.
+ *   Expired timers are processed by the next call to HAPPlatformClockAdvance.
+ *
+ * @param      delta                Delta to advance the clock by.
+ */
+void HAPPlatformClockAdvanceWithoutTimers(HAPTime delta);
+
 #if __has_feature(nullability)
 #pragma clang assume_nonnull end
 #endif
@@ -31,3 +31,12 @@ void HAPPlatformClockAdvance(HAPTime delta) {
 
     HAPPlatformTimerProcessExpiredTimers();
 }
+
+void HAPPlatformClockAdvanceWithoutTimers(HAPTime delta) {
+    now += delta;
+    HAPLogInfo(
+            &logObject,
+            "Clock advanced to %8llu.%03llu (timers not processed)",
+            (unsigned long long) (now / HAPSecond),
+            (unsigned long long) (now % HAPSecond));
+}
@@ -130,3 +130,22 @@ void HAPPlatformLogCapture(
     // Finish log.
     (void) fflush(stderr);
 }
+
+#if HAP_LOG_BINARY
+void HAPPlatformLogCaptureBinary(const HAPLogObject* log, HAPLogType type, const void* bytes, size_t numBytes) {
+    HAPPrecondition(log);
+    HAPPrecondition(bytes);
+
+    // Decode the record in-process so that test logs stay readable.
+    char message[2 * 1024];
+    size_t numRecordBytes;
+    HAPLogBinaryRecord record;
+    HAPError err = HAPLogBinaryDecodeRecord(
+            bytes, numBytes, &numRecordBytes, HAPLogBinaryGetString, NULL, message, sizeof message, &record);
+    if (err || numRecordBytes != numBytes || record.recordType != kHAPLogBinaryRecordType_Message) {
+        HAPPlatformLogCapture(log, kHAPLogType_Error, "<Malformed binary log record>", bytes, numBytes);
+        return;
+    }
+    HAPPlatformLogCapture(log, type, HAPNonnull(record.message), record.bufferBytes, record.numBufferBytes);
+}
+#endif
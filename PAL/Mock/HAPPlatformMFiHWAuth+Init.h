@@ -24,6 +24,15 @@ struct HAPPlatformMFiHWAuth {
     // Opaque type. Do not access the instance fields directly.
     /**@cond */
     bool poweredOn;
+
+    /** Time that the simulated coprocessor takes to generate a challenge response. */
+    HAPTime latency;
+
+    /** Time until which the simulated coprocessor does not acknowledge transfers. */
+    HAPTime busyUntil;
+
+    /** Authentication Control and Status register. */
+    uint8_t authenticationStatus;
     /**@endcond */
 };
 
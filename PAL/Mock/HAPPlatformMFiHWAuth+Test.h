@@ -0,0 +1,39 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#ifndef HAP_PLATFORM_MFI_HW_AUTH_TEST_H
+#define HAP_PLATFORM_MFI_HW_AUTH_TEST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "HAP.h"
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull begin
+#endif
+
+/**
+ * Sets the time that the simulated Apple Authentication Coprocessor takes to generate a challenge response.
+ *
+ * - While a challenge response is being generated, HAPPlatformMFiHWAuthTryRead and HAPPlatformMFiHWAuthTryWrite
+ *   report kHAPError_Busy. HAPPlatformMFiHWAuthRead and HAPPlatformMFiHWAuthWrite do not wait for the latency.
+ *
+ * @param      mfiHWAuth            Apple Authentication Coprocessor provider.
+ * @param      latency              Challenge response generation latency.
+ */
+void HAPPlatformMFiHWAuthSetLatency(HAPPlatformMFiHWAuthRef mfiHWAuth, HAPTime latency);
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull end
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
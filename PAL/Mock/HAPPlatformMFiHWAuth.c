@@ -6,6 +6,7 @@
 
 #include "HAP+Internal.h"
 #include "HAPPlatformMFiHWAuth+Init.h"
+#include "HAPPlatformMFiHWAuth+Test.h"
 
 static const HAPLogObject logObject = { .subsystem = kHAPPlatform_LogSubsystem, .category = "MFiHWAuth" };
 
@@ -19,6 +20,12 @@ void HAPPlatformMFiHWAuthRelease(HAPPlatformMFiHWAuthRef mfiHWAuth) {
     HAPPrecondition(mfiHWAuth);
 }
 
+void HAPPlatformMFiHWAuthSetLatency(HAPPlatformMFiHWAuthRef mfiHWAuth, HAPTime latency) {
+    HAPPrecondition(mfiHWAuth);
+
+    mfiHWAuth->latency = latency;
+}
+
 HAP_RESULT_USE_CHECK
 bool HAPPlatformMFiHWAuthIsPoweredOn(HAPPlatformMFiHWAuthRef mfiHWAuth) {
     HAPPrecondition(mfiHWAuth);
@@ -55,6 +62,21 @@ HAPError HAPPlatformMFiHWAuthWrite(HAPPlatformMFiHWAuthRef mfiHWAuth, const void
             }
             return kHAPError_None;
         }
+        case kHAPMFiHWAuthRegister_ChallengeData: {
+            HAPPrecondition(numBytes == 1 + SHA256_BYTES);
+            return kHAPError_None;
+        }
+        case kHAPMFiHWAuthRegister_AuthenticationControlAndStatus: {
+            HAPPrecondition(numBytes == 2);
+            if (b[1] != 1) {
+                HAPLog(&logObject, "Unsupported authentication control: %u.", b[1]);
+                return kHAPError_Unknown;
+            }
+            // Start challenge response generation.
+            mfiHWAuth->authenticationStatus = 1 << 4;
+            mfiHWAuth->busyUntil = HAPPlatformClockGetCurrent() + mfiHWAuth->latency;
+            return kHAPError_None;
+        }
         default: {
             HAPLog(&logObject, "Unknown register.");
             return kHAPError_Unknown;
@@ -118,9 +140,69 @@ HAPError HAPPlatformMFiHWAuthRead(
             HAPLogBufferDebug(&logObject, bytes, numBytes, "MFi < %02x", registerAddress);
             return kHAPError_None;
         }
+        case kHAPMFiHWAuthRegister_AuthenticationControlAndStatus: {
+            HAPPrecondition(numBytes == 1);
+            b[o++] = mfiHWAuth->authenticationStatus;
+            HAPAssert(o == numBytes);
+            HAPLogBufferDebug(&logObject, bytes, numBytes, "MFi < %02x", registerAddress);
+            return kHAPError_None;
+        }
+        case kHAPMFiHWAuthRegister_ChallengeResponseDataLength: {
+            HAPPrecondition(numBytes == 2);
+            HAPWriteBigUInt16(&b[o], 64);
+            o += 2;
+            HAPAssert(o == numBytes);
+            HAPLogBufferDebug(&logObject, bytes, numBytes, "MFi < %02x", registerAddress);
+            return kHAPError_None;
+        }
+        case kHAPMFiHWAuthRegister_AccessoryCertificateDataLength: {
+            HAPPrecondition(numBytes == 2);
+            HAPWriteBigUInt16(&b[o], 608);
+            o += 2;
+            HAPAssert(o == numBytes);
+            HAPLogBufferDebug(&logObject, bytes, numBytes, "MFi < %02x", registerAddress);
+            return kHAPError_None;
+        }
+        case kHAPMFiHWAuthRegister_ChallengeResponseData:
+        case kHAPMFiHWAuthRegister_AccessoryCertificateDataPart1:
+        case kHAPMFiHWAuthRegister_AccessoryCertificateDataPart2:
+        case kHAPMFiHWAuthRegister_AccessoryCertificateDataPart3:
+        case kHAPMFiHWAuthRegister_AccessoryCertificateDataPart4:
+        case kHAPMFiHWAuthRegister_AccessoryCertificateDataPart5: {
+            // Fake signature and certificate data.
+            for (; o < numBytes; o++) {
+                b[o] = registerAddress;
+            }
+            HAPLogBufferDebug(&logObject, bytes, numBytes, "MFi < %02x", registerAddress);
+            return kHAPError_None;
+        }
         default: {
             HAPLog(&logObject, "MFi < %02x (unexpected register)", registerAddress);
             return kHAPError_Unknown;
         }
     }
 }
+
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformMFiHWAuthTryWrite(HAPPlatformMFiHWAuthRef mfiHWAuth, const void* bytes, size_t numBytes) {
+    HAPPrecondition(mfiHWAuth);
+
+    if (HAPPlatformClockGetCurrent() < mfiHWAuth->busyUntil) {
+        return kHAPError_Busy;
+    }
+    return HAPPlatformMFiHWAuthWrite(mfiHWAuth, bytes, numBytes);
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformMFiHWAuthTryRead(
+        HAPPlatformMFiHWAuthRef mfiHWAuth,
+        uint8_t registerAddress,
+        void* bytes,
+        size_t numBytes) {
+    HAPPrecondition(mfiHWAuth);
+
+    if (HAPPlatformClockGetCurrent() < mfiHWAuth->busyUntil) {
+        return kHAPError_Busy;
+    }
+    return HAPPlatformMFiHWAuthRead(mfiHWAuth, registerAddress, bytes, numBytes);
+}
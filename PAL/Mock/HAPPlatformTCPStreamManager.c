@@ -147,6 +147,9 @@ static void Invalidate(HAPPlatformTCPStreamManagerRef tcpStreamManager, HAPPlatf
     free(tcpStream->rx.bytes);
     free(tcpStream->tx.bytes);
     HAPRawBufferZero(tcpStream, sizeof *tcpStream);
+
+    // Keep the TCP stream usable for subsequent connections.
+    tcpStream->tcpStreamManager = tcpStreamManager;
 }
 
 void HAPPlatformTCPStreamCloseOutput(
@@ -278,7 +281,8 @@ HAPError HAPPlatformTCPStreamRead(
             tcpStream->rx.numBytes - *numBytes);
     tcpStream->rx.numBytes -= *numBytes;
 
-    if (!*numBytes && !tcpStream->rx.isClosed) {
+    // Once the client closed the connection, reading 0 bytes indicates the end of the stream.
+    if (!*numBytes && !tcpStream->rx.isClosed && !tcpStream->rx.isClientClosed) {
         return kHAPError_Busy;
     }
     return kHAPError_None;
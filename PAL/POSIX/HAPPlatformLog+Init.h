@@ -17,6 +17,23 @@ extern "C" {
 #pragma clang assume_nonnull begin
 #endif
 
+/**
+ * Maximum number of message and buffer bytes that are stored per queued log message.
+ *
+ * - Log messages are copied into a fixed-size queue when they are logged and are written by a background thread.
+ *   Logged buffers that do not fit are truncated, and the number of truncated bytes is written instead.
+ *   Log messages themselves always fit, as HAPLog limits them to 2 KB.
+ *
+ * - May be overridden at build time to log larger buffers completely, e.g. with
+ *   -DHAP_PLATFORM_LOG_RECORD_MAX_BYTES=16384. The log queue holds 128 records of this size.
+ */
+#ifndef HAP_PLATFORM_LOG_RECORD_MAX_BYTES
+#define HAP_PLATFORM_LOG_RECORD_MAX_BYTES (2 * 1024)
+#endif
+#if HAP_PLATFORM_LOG_RECORD_MAX_BYTES < 2 * 1024
+#error "Invalid HAP_PLATFORM_LOG_RECORD_MAX_BYTES."
+#endif
+
 /**
  * Logs a POSIX error, for example fetched from errno.
  *
@@ -37,6 +54,22 @@ void HAPPlatformLogPOSIXError(
         const char* file,
         int line);
 
+/**
+ * Writes all queued log messages to stderr.
+ *
+ * - Log messages are queued by the logging thread and are formatted and written by a background thread.
+ *   Faults are written synchronously, and queued log messages are flushed when the process exits.
+ */
+void HAPPlatformLogFlush(void);
+
+/**
+ * Returns the number of log messages that have been dropped because the log queue was full.
+ *
+ * @return Number of dropped log messages.
+ */
+HAP_RESULT_USE_CHECK
+uint64_t HAPPlatformLogGetNumDroppedMessages(void);
+
 #if __has_feature(nullability)
 #pragma clang assume_nonnull end
 #endif
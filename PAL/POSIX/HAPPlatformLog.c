@@ -5,14 +5,15 @@
 // See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
 
 #include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <stdarg.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
-#include <time.h>
-#ifdef _WIN32
-#include <Windows.h>
-#else
 #include <sys/time.h>
-#endif
+#include <time.h>
 
 #include "HAP.h"
 #include "HAPPlatformLog+Init.h"
@@ -78,154 +79,497 @@ HAPPlatformLogEnabledTypes HAPPlatformLogGetEnabledTypes(const HAPLogObject* _No
     }
 }
 
-void HAPPlatformLogCapture(
-        const HAPLogObject* _Nonnull log,
+/**
+ * Number of log records that may be queued before log messages are dropped. Must be a power of two.
+ */
+#define kHAPPlatformLog_NumRecords ((size_t) 128)
+
+/**
+ * Maximum number of message and buffer bytes that are stored per log record. Longer buffers are truncated.
+ * See HAP_PLATFORM_LOG_RECORD_MAX_BYTES.
+ */
+#define kHAPPlatformLogRecord_MaxBytes ((size_t) HAP_PLATFORM_LOG_RECORD_MAX_BYTES)
+
+/**
+ * Size of the buffer in which formatted log records are collected before they are written to stderr.
+ */
+#define kHAPPlatformLog_MaxOutputBytes ((size_t)(8 * 1024))
+
+/**
+ * Captured log message.
+ *
+ * Log messages are captured on the thread that logs them and are formatted on the log thread.
+ */
+typedef struct {
+    /**
+     * Sequence number used to hand over the record between threads.
+     *
+     * - Equal to the enqueue position while the record is free.
+     * - Equal to the enqueue position + 1 once the record contains a log message.
+     */
+    uint32_t sequenceNumber;
+
+    /** Time at which the log message was captured. */
+    struct timeval time;
+
+    /** Log object. */
+    const HAPLogObject* log;
+
+    /** Log type. */
+    HAPLogType type;
+
+    /** Length of the log message. */
+    size_t numMessageBytes;
+
+    /** Number of buffer bytes that are stored after the log message. */
+    size_t numBufferBytes;
+
+    /** Number of buffer bytes that did not fit into the record. */
+    size_t numTruncatedBufferBytes;
+
+    /** Whether a buffer has been logged. */
+    bool hasBuffer : 1;
+
+    /** Whether the record contains a binary log record instead of a log message. See HAPPlatformLogCaptureBinary. */
+    bool isBinary : 1;
+
+    /** Log message, followed by the logged buffer. */
+    char bytes[kHAPPlatformLogRecord_MaxBytes];
+} HAPPlatformLogRecord;
+
+/**
+ * Logger state.
+ *
+ * - Log records are enqueued without taking a lock. When the queue is full the log message is dropped.
+ *
+ * - Log records are dequeued by the log thread, or by the thread that flushes the log, while holding the mutex.
+ */
+static struct {
+    pthread_once_t once;
+    pthread_mutex_t mutex;
+    sem_t semaphore;
+    bool isThreadRunning;
+
+    uint32_t enqueuePosition;
+    uint32_t dequeuePosition;
+    uint64_t numDroppedMessages;
+    uint64_t numReportedDroppedMessages;
+    HAPPlatformLogRecord records[kHAPPlatformLog_NumRecords];
+
+    struct {
+        char bytes[kHAPPlatformLog_MaxOutputBytes];
+        size_t numBytes;
+    } output;
+} logger = { .once = PTHREAD_ONCE_INIT, .mutex = PTHREAD_MUTEX_INITIALIZER };
+
+/**
+ * Writes the collected output to stderr. Must be called while holding the mutex.
+ */
+static void FlushOutput(void) {
+    if (logger.output.numBytes) {
+        (void) fwrite(logger.output.bytes, 1, logger.output.numBytes, stderr);
+        logger.output.numBytes = 0;
+    }
+    (void) fflush(stderr);
+}
+
+/**
+ * Appends formatted text to the output. Must be called while holding the mutex.
+ *
+ * @param      format               A format string.
+ * @param      ...                  Arguments for the format string.
+ */
+HAP_PRINTFLIKE(1, 2)
+static void AppendOutput(const char* format, ...) {
+    for (;;) {
+        size_t maxBytes = sizeof logger.output.bytes - logger.output.numBytes;
+        va_list args;
+        va_start(args, format);
+        int numBytes = vsnprintf(&logger.output.bytes[logger.output.numBytes], maxBytes, format, args);
+        va_end(args);
+        if (numBytes < 0) {
+            return;
+        }
+        if ((size_t) numBytes < maxBytes) {
+            logger.output.numBytes += (size_t) numBytes;
+            return;
+        }
+        if (!logger.output.numBytes) {
+            // Text does not fit into an empty output buffer. Keep the truncated text.
+            logger.output.numBytes = sizeof logger.output.bytes - 1;
+            return;
+        }
+        FlushOutput();
+    }
+}
+
+/**
+ * Appends raw bytes to the output. Must be called while holding the mutex.
+ *
+ * @param      bytes                Bytes to append.
+ * @param      numBytes             Number of bytes. Must not exceed kHAPPlatformLog_MaxOutputBytes.
+ */
+static void AppendRawOutput(const void* bytes, size_t numBytes) {
+    HAPPrecondition(bytes);
+    HAPPrecondition(numBytes <= sizeof logger.output.bytes);
+
+    if (numBytes > sizeof logger.output.bytes - logger.output.numBytes) {
+        FlushOutput();
+    }
+    HAPRawBufferCopyBytes(&logger.output.bytes[logger.output.numBytes], bytes, numBytes);
+    logger.output.numBytes += numBytes;
+}
+
+/**
+ * Captures a log message into a log record.
+ *
+ * @param[out] record               Log record.
+ * @param      log                  Log object.
+ * @param      type                 A log type constant, indicating the level of logging to perform.
+ * @param      message              The log message, or a binary log record.
+ * @param      numMessageBytes      Length of the log message.
+ * @param      bufferBytes          Optional buffer containing data to log.
+ * @param      numBufferBytes       Length of buffer.
+ * @param      isBinary             Whether the message is a binary log record.
+ */
+static void CaptureRecord(
+        HAPPlatformLogRecord* record,
+        const HAPLogObject* log,
         HAPLogType type,
-        const char* _Nonnull message,
+        const void* message,
+        size_t numMessageBytes,
         const void* _Nullable bufferBytes,
-        size_t numBufferBytes) HAP_DIAGNOSE_ERROR(!bufferBytes && numBufferBytes, "empty buffer cannot have a length") {
+        size_t numBufferBytes,
+        bool isBinary) {
+    HAPPrecondition(record);
     HAPPrecondition(log);
     HAPPrecondition(message);
-    HAPPrecondition(!numBufferBytes || bufferBytes);
 
-    static volatile bool captureLock = 0;
-    while (__atomic_test_and_set(&captureLock, __ATOMIC_SEQ_CST))
-        ;
-
-    // Format log message.
-    bool logHandled = false;
-
-    // Perform regular logging.
-    if (!logHandled) {
-        // Color.
-        switch (type) {
-            case kHAPLogType_Debug: {
-                fprintf(stderr, "\x1B[0m");
-            } break;
-            case kHAPLogType_Info: {
-                fprintf(stderr, "\x1B[32m");
-            } break;
-            case kHAPLogType_Default: {
-                fprintf(stderr, "\x1B[35m");
-            } break;
-            case kHAPLogType_Error: {
-                fprintf(stderr, "\x1B[31m");
-            } break;
-            case kHAPLogType_Fault: {
-                fprintf(stderr, "\x1B[1m\x1B[31m");
-            } break;
-        }
+    if (gettimeofday(&record->time, NULL)) {
+        HAPRawBufferZero(&record->time, sizeof record->time);
+    }
+    record->log = log;
+    record->type = type;
+    record->isBinary = isBinary;
+
+    if (numMessageBytes > sizeof record->bytes) {
+        numMessageBytes = sizeof record->bytes;
+    }
+    HAPRawBufferCopyBytes(record->bytes, message, numMessageBytes);
+    record->numMessageBytes = numMessageBytes;
+
+    record->hasBuffer = bufferBytes != NULL;
+    record->numBufferBytes = 0;
+    record->numTruncatedBufferBytes = 0;
+    if (bufferBytes) {
+        size_t maxBufferBytes = sizeof record->bytes - numMessageBytes;
+        record->numBufferBytes = numBufferBytes < maxBufferBytes ? numBufferBytes : maxBufferBytes;
+        record->numTruncatedBufferBytes = numBufferBytes - record->numBufferBytes;
+        HAPRawBufferCopyBytes(&record->bytes[numMessageBytes], HAPNonnullVoid(bufferBytes), record->numBufferBytes);
+    }
+}
 
-// Time.
-#ifdef _WIN32
-        SYSTEMTIME now;
-        GetSystemTime(&now);
-        (void) fprintf(
-                stderr,
+/**
+ * Formats a log record into the output. Must be called while holding the mutex.
+ *
+ * @param      record               Log record.
+ */
+static void FormatRecord(const HAPPlatformLogRecord* record) {
+    HAPPrecondition(record);
+
+    if (record->isBinary) {
+        AppendRawOutput(record->bytes, record->numMessageBytes);
+        return;
+    }
+
+    // Color.
+    switch (record->type) {
+        case kHAPLogType_Debug: {
+            AppendOutput("\x1B[0m");
+        } break;
+        case kHAPLogType_Info: {
+            AppendOutput("\x1B[32m");
+        } break;
+        case kHAPLogType_Default: {
+            AppendOutput("\x1B[35m");
+        } break;
+        case kHAPLogType_Error: {
+            AppendOutput("\x1B[31m");
+        } break;
+        case kHAPLogType_Fault: {
+            AppendOutput("\x1B[1m\x1B[31m");
+        } break;
+    }
+
+    // Time.
+    struct tm g;
+    struct tm* gmt = gmtime_r(&record->time.tv_sec, &g);
+    if (gmt) {
+        AppendOutput(
                 "%04d-%02d-%02d'T'%02d:%02d:%02d'Z'",
-                now.wYear,
-                now.wMonth,
-                now.wDay,
-                now.wHour,
-                now.wMinute,
-                now.wSecond);
-#else
-        struct timeval now;
-        int err = gettimeofday(&now, NULL);
-        if (!err) {
-            struct tm g;
-            struct tm* gmt = gmtime_r(&now.tv_sec, &g);
-            if (gmt) {
-                (void) fprintf(
-                        stderr,
-                        "%04d-%02d-%02d'T'%02d:%02d:%02d'Z'",
-                        1900 + gmt->tm_year,
-                        1 + gmt->tm_mon,
-                        gmt->tm_mday,
-                        gmt->tm_hour,
-                        gmt->tm_min,
-                        gmt->tm_sec);
-            }
+                1900 + gmt->tm_year,
+                1 + gmt->tm_mon,
+                gmt->tm_mday,
+                gmt->tm_hour,
+                gmt->tm_min,
+                gmt->tm_sec);
+    }
+    AppendOutput("\t");
+
+    // Type.
+    switch (record->type) {
+        case kHAPLogType_Debug: {
+            AppendOutput("Debug");
+        } break;
+        case kHAPLogType_Info: {
+            AppendOutput("Info");
+        } break;
+        case kHAPLogType_Default: {
+            AppendOutput("Default");
+        } break;
+        case kHAPLogType_Error: {
+            AppendOutput("Error");
+        } break;
+        case kHAPLogType_Fault: {
+            AppendOutput("Fault");
+        } break;
+    }
+    AppendOutput("\t");
+
+    // Subsystem / Category.
+    if (record->log->subsystem) {
+        AppendOutput("[%s", record->log->subsystem);
+        if (record->log->category) {
+            AppendOutput(":%s", record->log->category);
         }
-#endif
-        (void) fprintf(stderr, "\t");
-
-        // Type.
-        switch (type) {
-            case kHAPLogType_Debug: {
-                (void) fprintf(stderr, "Debug");
-            } break;
-            case kHAPLogType_Info: {
-                (void) fprintf(stderr, "Info");
-            } break;
-            case kHAPLogType_Default: {
-                (void) fprintf(stderr, "Default");
-            } break;
-            case kHAPLogType_Error: {
-                (void) fprintf(stderr, "Error");
-            } break;
-            case kHAPLogType_Fault: {
-                (void) fprintf(stderr, "Fault");
-            } break;
+        AppendOutput("] ");
+    }
+
+    // Message.
+    AppendOutput("%.*s\n", (int) record->numMessageBytes, record->bytes);
+
+    // Buffer.
+    if (record->hasBuffer) {
+        const uint8_t* b = (const uint8_t*) &record->bytes[record->numMessageBytes];
+        size_t length = record->numBufferBytes;
+        if (length == 0) {
+            AppendOutput("\n");
+        } else {
+            size_t i = 0;
+            do {
+                char line[128];
+                size_t o = 0;
+                o += (size_t) snprintf(&line[o], sizeof line - o, "    %04zx ", i);
+                for (size_t n = 0; n != 8 * 4; n++) {
+                    if (n % 4 == 0) {
+                        line[o++] = ' ';
+                    }
+                    if ((n <= length) && (i < length - n)) {
+                        line[o++] = "0123456789abcdef"[b[i + n] >> 4];
+                        line[o++] = "0123456789abcdef"[b[i + n] & 0xF];
+                    } else {
+                        line[o++] = ' ';
+                        line[o++] = ' ';
+                    }
+                }
+                line[o++] = ' ';
+                line[o++] = ' ';
+                line[o++] = ' ';
+                line[o++] = ' ';
+                for (size_t n = 0; n != 8 * 4; n++) {
+                    if (i != length) {
+                        line[o++] = (32 <= b[i]) && (b[i] < 127) ? (char) b[i] : '.';
+                        i++;
+                    }
+                }
+                AppendOutput("%.*s\n", (int) o, line);
+            } while (i != length);
         }
-        (void) fprintf(stderr, "\t");
+        if (record->numTruncatedBufferBytes) {
+            AppendOutput("    <%zu bytes truncated>\n", record->numTruncatedBufferBytes);
+        }
+    }
 
-        // Subsystem / Category.
-        if (log->subsystem) {
-            (void) fprintf(stderr, "[%s", log->subsystem);
-            if (log->category) {
-                (void) fprintf(stderr, ":%s", log->category);
-            }
-            (void) fprintf(stderr, "] ");
+    // Reset color.
+    AppendOutput("\x1B[0m");
+}
+
+/**
+ * Formats all queued log records and writes them to stderr. Must be called while holding the mutex.
+ */
+static void DrainRecords(void) {
+    for (;;) {
+        HAPPlatformLogRecord* record = &logger.records[logger.dequeuePosition % kHAPPlatformLog_NumRecords];
+        uint32_t sequenceNumber = __atomic_load_n(&record->sequenceNumber, __ATOMIC_ACQUIRE);
+        if (sequenceNumber != logger.dequeuePosition + 1) {
+            break;
+        }
+        FormatRecord(record);
+        __atomic_store_n(
+                &record->sequenceNumber,
+                logger.dequeuePosition + (uint32_t) kHAPPlatformLog_NumRecords,
+                __ATOMIC_RELEASE);
+        logger.dequeuePosition++;
+    }
+
+    uint64_t numDroppedMessages = __atomic_load_n(&logger.numDroppedMessages, __ATOMIC_RELAXED);
+    if (numDroppedMessages != logger.numReportedDroppedMessages) {
+#if HAP_LOG_BINARY
+        uint8_t bytes[16];
+        size_t numBytes;
+        HAPError err = HAPLogBinaryEncodeDroppedRecord(
+                bytes, sizeof bytes, &numBytes, numDroppedMessages - logger.numReportedDroppedMessages);
+        HAPAssert(!err);
+        AppendRawOutput(bytes, numBytes);
+#else
+        AppendOutput(
+                "\x1B[31m<%llu log messages dropped>\x1B[0m\n",
+                (unsigned long long) (numDroppedMessages - logger.numReportedDroppedMessages));
+#endif
+        logger.numReportedDroppedMessages = numDroppedMessages;
+    }
+
+    FlushOutput();
+}
+
+static void* _Nullable LogThreadMain(void* _Nullable context HAP_UNUSED) {
+    // Signals are handled by the run loop thread.
+    sigset_t signals;
+    (void) sigfillset(&signals);
+    (void) pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+    for (;;) {
+        if (sem_wait(&logger.semaphore)) {
+            continue;
         }
 
-        // Message.
-        (void) fprintf(stderr, "%s", message);
-        (void) fprintf(stderr, "\n");
-
-        // Buffer.
-        if (bufferBytes) {
-            size_t i, n;
-            const uint8_t* b = bufferBytes;
-            size_t length = numBufferBytes;
-            if (length == 0) {
-                (void) fprintf(stderr, "\n");
+        // Log records that have been signalled so far are formatted in the same batch.
+        while (!sem_trywait(&logger.semaphore))
+            ;
+
+        (void) pthread_mutex_lock(&logger.mutex);
+        DrainRecords();
+        (void) pthread_mutex_unlock(&logger.mutex);
+    }
+    return NULL;
+}
+
+static void FlushAtExit(void) {
+    HAPPlatformLogFlush();
+}
+
+static void InitializeLogger(void) {
+    for (size_t i = 0; i < kHAPPlatformLog_NumRecords; i++) {
+        logger.records[i].sequenceNumber = (uint32_t) i;
+    }
+
+    // If the log thread cannot be started, log messages are written synchronously.
+    if (sem_init(&logger.semaphore, /* pshared: */ 0, /* value: */ 0)) {
+        return;
+    }
+    pthread_t thread;
+    if (pthread_create(&thread, /* attr: */ NULL, LogThreadMain, /* arg: */ NULL)) {
+        (void) sem_destroy(&logger.semaphore);
+        return;
+    }
+    (void) pthread_detach(thread);
+    (void) atexit(FlushAtExit);
+    logger.isThreadRunning = true;
+}
+
+void HAPPlatformLogFlush(void) {
+    (void) pthread_once(&logger.once, InitializeLogger);
+
+    (void) pthread_mutex_lock(&logger.mutex);
+    DrainRecords();
+    (void) pthread_mutex_unlock(&logger.mutex);
+}
+
+HAP_RESULT_USE_CHECK
+uint64_t HAPPlatformLogGetNumDroppedMessages(void) {
+    return __atomic_load_n(&logger.numDroppedMessages, __ATOMIC_RELAXED);
+}
+
+/**
+ * Queues a log message for the log thread, or writes it synchronously.
+ *
+ * @param      log                  Log object.
+ * @param      type                 A log type constant, indicating the level of logging to perform.
+ * @param      message              The log message, or a binary log record.
+ * @param      numMessageBytes      Length of the log message.
+ * @param      bufferBytes          Optional buffer containing data to log.
+ * @param      numBufferBytes       Length of buffer.
+ * @param      isBinary             Whether the message is a binary log record.
+ */
+static void Capture(
+        const HAPLogObject* log,
+        HAPLogType type,
+        const void* message,
+        size_t numMessageBytes,
+        const void* _Nullable bufferBytes,
+        size_t numBufferBytes,
+        bool isBinary) {
+    HAPPrecondition(log);
+    HAPPrecondition(message);
+
+    (void) pthread_once(&logger.once, InitializeLogger);
+
+    // Faults usually precede an abort and are written synchronously, after all queued log messages.
+    if (type != kHAPLogType_Fault && logger.isThreadRunning) {
+        uint32_t position = __atomic_load_n(&logger.enqueuePosition, __ATOMIC_RELAXED);
+        for (;;) {
+            HAPPlatformLogRecord* record = &logger.records[position % kHAPPlatformLog_NumRecords];
+            uint32_t sequenceNumber = __atomic_load_n(&record->sequenceNumber, __ATOMIC_ACQUIRE);
+            int32_t difference = (int32_t)(sequenceNumber - position);
+            if (difference == 0) {
+                if (__atomic_compare_exchange_n(
+                            &logger.enqueuePosition,
+                            &position,
+                            position + 1,
+                            /* weak: */ true,
+                            __ATOMIC_RELAXED,
+                            __ATOMIC_RELAXED)) {
+                    CaptureRecord(record, log, type, message, numMessageBytes, bufferBytes, numBufferBytes, isBinary);
+                    __atomic_store_n(&record->sequenceNumber, position + 1, __ATOMIC_RELEASE);
+                    (void) sem_post(&logger.semaphore);
+                    return;
+                }
+            } else if (difference < 0) {
+                // Queue is full.
+                __atomic_add_fetch(&logger.numDroppedMessages, 1, __ATOMIC_RELAXED);
+                return;
             } else {
-                i = 0;
-                do {
-                    (void) fprintf(stderr, "    %04zx ", i);
-                    for (n = 0; n != 8 * 4; n++) {
-                        if (n % 4 == 0) {
-                            (void) fprintf(stderr, " ");
-                        }
-                        if ((n <= length) && (i < length - n)) {
-                            (void) fprintf(stderr, "%02x", b[i + n] & 0xff);
-                        } else {
-                            (void) fprintf(stderr, "  ");
-                        }
-                    };
-                    (void) fprintf(stderr, "    ");
-                    for (n = 0; n != 8 * 4; n++) {
-                        if (i != length) {
-                            if ((32 <= b[i]) && (b[i] < 127)) {
-                                (void) fprintf(stderr, "%c", b[i]);
-                            } else {
-                                (void) fprintf(stderr, ".");
-                            }
-                            i++;
-                        }
-                    }
-                    (void) fprintf(stderr, "\n");
-                } while (i != length);
+                position = __atomic_load_n(&logger.enqueuePosition, __ATOMIC_RELAXED);
             }
         }
-
-        // Reset color.
-        fprintf(stderr, "\x1B[0m");
     }
 
-    // Finish log.
-    (void) fflush(stderr);
+    HAPPlatformLogRecord record;
+    CaptureRecord(&record, log, type, message, numMessageBytes, bufferBytes, numBufferBytes, isBinary);
+
+    (void) pthread_mutex_lock(&logger.mutex);
+    DrainRecords();
+    FormatRecord(&record);
+    FlushOutput();
+    (void) pthread_mutex_unlock(&logger.mutex);
+}
+
+void HAPPlatformLogCapture(
+        const HAPLogObject* _Nonnull log,
+        HAPLogType type,
+        const char* _Nonnull message,
+        const void* _Nullable bufferBytes,
+        size_t numBufferBytes) HAP_DIAGNOSE_ERROR(!bufferBytes && numBufferBytes, "empty buffer cannot have a length") {
+    HAPPrecondition(log);
+    HAPPrecondition(message);
+    HAPPrecondition(!numBufferBytes || bufferBytes);
+
+    Capture(log, type, message, HAPStringGetNumBytes(message), bufferBytes, numBufferBytes, /* isBinary: */ false);
+}
+
+void HAPPlatformLogCaptureBinary(const HAPLogObject* log, HAPLogType type, const void* bytes, size_t numBytes) {
+    HAPPrecondition(log);
+    HAPPrecondition(bytes);
 
-    __atomic_clear(&captureLock, __ATOMIC_SEQ_CST);
+    Capture(log, type, bytes, numBytes, /* bufferBytes: */ NULL, /* numBufferBytes: */ 0, /* isBinary: */ true);
 }
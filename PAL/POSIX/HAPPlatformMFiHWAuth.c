@@ -158,3 +158,67 @@ HAPError HAPPlatformMFiHWAuthRead(
     HAPLog(&logObject, "I2C read timed out.");
     return kHAPError_Unknown;
 }
+
+/**
+ * Maps the result of a failed I2C transfer to an error code.
+ *
+ * - The coprocessor does not acknowledge its address while it is processing a request.
+ *   Depending on the I2C bus driver this is reported as ENXIO, EREMOTEIO, or EAGAIN.
+ *
+ * @param      n                    Result of the read or write call.
+ *
+ * @return kHAPError_Busy           If the coprocessor did not acknowledge the transfer.
+ * @return kHAPError_Unknown        If an I/O error occurred.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError GetTransferError(ssize_t n) {
+    if (n >= 0) {
+        // Short transfers are not retried at the byte level. The transfer is repeated entirely.
+        return kHAPError_Busy;
+    }
+    int _errno = errno;
+    if (_errno == ENXIO || _errno == EREMOTEIO || _errno == EAGAIN || _errno == EINTR) {
+        return kHAPError_Busy;
+    }
+    HAPLogError(&logObject, "I2C transfer failed: %d.", _errno);
+    return kHAPError_Unknown;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformMFiHWAuthTryWrite(HAPPlatformMFiHWAuthRef mfiHWAuth, const void* bytes, size_t numBytes) {
+    HAPPrecondition(mfiHWAuth);
+    HAPPrecondition(bytes);
+    HAPPrecondition(numBytes);
+
+    ssize_t n = write(mfiHWAuth->i2cFile, bytes, numBytes);
+    if (n != (ssize_t) numBytes) {
+        return GetTransferError(n);
+    }
+    HAPLogBufferDebug(&logObject, bytes, numBytes, "MFi >");
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformMFiHWAuthTryRead(
+        HAPPlatformMFiHWAuthRef mfiHWAuth,
+        uint8_t registerAddress,
+        void* bytes,
+        size_t numBytes) {
+    HAPPrecondition(mfiHWAuth);
+    HAPPrecondition(bytes);
+    HAPPrecondition(numBytes >= 1 && numBytes <= 128);
+
+    // Send register ID to read.
+    ssize_t n = write(mfiHWAuth->i2cFile, &registerAddress, 1);
+    if (n != 1) {
+        return GetTransferError(n);
+    }
+
+    // Send read request. On failure the register ID is sent again by the next attempt.
+    n = read(mfiHWAuth->i2cFile, bytes, numBytes);
+    if (n != (ssize_t) numBytes) {
+        return GetTransferError(n);
+    }
+    HAPLogBufferDebug(&logObject, bytes, numBytes, "MFi < %02x", registerAddress);
+    return kHAPError_None;
+}
@@ -71,6 +71,20 @@ typedef struct {
      * Maximum number of concurrent TCP streams.
      */
     size_t maxConcurrentTCPStreams;
+
+    /**
+     * Whether new TCP streams are only reported once the controller has sent its first request bytes.
+     *
+     * - Ignored on platforms without support for the socket option TCP_DEFER_ACCEPT.
+     */
+    bool deferAccept;
+
+    /**
+     * Maximum number of pending TCP Fast Open requests. A value of 0 disables TCP Fast Open.
+     *
+     * - Ignored on platforms without support for the socket option TCP_FASTOPEN.
+     */
+    size_t fastOpenQueueLength;
 } HAPPlatformTCPStreamManagerOptions;
 
 // Opaque type. Do not use directly.
@@ -85,6 +99,8 @@ typedef struct {
     HAPPlatformFileHandleRef fileHandle;
     HAPPlatformTCPStreamListenerCallback _Nullable callback;
     void* _Nullable context;
+
+    size_t numAcceptedTCPStreams;
 } HAPPlatformTCPStreamListener;
 /**@endcond */
 
@@ -113,6 +129,8 @@ struct HAPPlatformTCPStreamManager {
     struct {
         char interfaceName[IFNAMSIZ];
         HAPNetworkPort port;
+        bool deferAccept;
+        size_t fastOpenQueueLength;
     } tcpStreamListenerConfiguration;
 
     HAPPlatformTCPStreamListener tcpStreamListener;
@@ -4,6 +4,11 @@
 // you may not use this file except in compliance with the License.
 // See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
 
+// accept4 is a GNU extension on Linux.
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE 1
+#endif
+
 #include <errno.h>
 #include <fcntl.h>
 #include <net/if.h>
@@ -19,6 +24,21 @@
 
 static const HAPLogObject logObject = { .subsystem = kHAPPlatform_LogSubsystem, .category = "TCPStreamManager" };
 
+/**
+ * Whether accept4 is available to accept sockets that are non-blocking and close-on-exec in a single system call.
+ */
+#if defined(__linux__) && defined(SOCK_NONBLOCK) && defined(SOCK_CLOEXEC)
+#define HAVE_ACCEPT4 1
+#else
+#define HAVE_ACCEPT4 0
+#endif
+
+/**
+ * Number of seconds for which the kernel waits for the first request bytes of a TCP stream when TCP_DEFER_ACCEPT
+ * is enabled.
+ */
+#define kDeferAcceptTimeout ((int) 10)
+
 /**
  * Sets all fields of a TCP stream listener to their initial values.
  *
@@ -34,6 +54,7 @@ static void InitializeTCPStreamListener(HAPPlatformTCPStreamListener* tcpStreamL
     tcpStreamListener->fileHandle = 0;
     tcpStreamListener->callback = NULL;
     tcpStreamListener->context = NULL;
+    tcpStreamListener->numAcceptedTCPStreams = 0;
 }
 
 /**
@@ -115,6 +136,116 @@ static HAPError SetNodelay(int fileDescriptor) {
     return kHAPError_None;
 }
 
+/**
+ * Accepts a pending connection on a TCP stream listener socket.
+ *
+ * - Where available, accept4 returns a socket that is already non-blocking and close-on-exec.
+ *
+ * @param      listenerFileDescriptor TCP stream listener socket file descriptor.
+ *
+ * @return Socket file descriptor of the accepted connection, or -1 with errno set if accepting failed.
+ */
+HAP_RESULT_USE_CHECK
+static int AcceptSocket(int listenerFileDescriptor) {
+#if HAVE_ACCEPT4
+    HAPLogDebug(&logObject, "accept4(%d, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);", listenerFileDescriptor);
+    return accept4(listenerFileDescriptor, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+#else
+    HAPLogDebug(&logObject, "accept(%d, NULL, NULL);", listenerFileDescriptor);
+    return accept(listenerFileDescriptor, NULL, NULL);
+#endif
+}
+
+/**
+ * Applies the socket options of a TCP stream socket.
+ *
+ * - The socket is made non-blocking and close-on-exec unless AcceptSocket already did so.
+ * - Coalescing of small segments is disabled.
+ *
+ * @param      fileDescriptor       Socket file descriptor.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_Unknown        If a socket option could not be applied.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError ConfigureTCPStreamSocket(int fileDescriptor) {
+    HAPError err;
+
+#if !HAVE_ACCEPT4
+    err = SetNonblocking(fileDescriptor);
+    if (err) {
+        return err;
+    }
+    int e = fcntl(fileDescriptor, F_SETFD, FD_CLOEXEC);
+    if (e == -1) {
+        HAPPlatformLogPOSIXError(
+                kHAPLogType_Error,
+                "System call 'fcntl' to set file descriptor flags to 'close-on-exec' failed.",
+                errno,
+                __func__,
+                HAP_FILE,
+                __LINE__);
+        return kHAPError_Unknown;
+    }
+#endif
+
+    err = SetNodelay(fileDescriptor);
+    if (err) {
+        return err;
+    }
+    return kHAPError_None;
+}
+
+/**
+ * Applies the optional socket options of a TCP stream listener socket.
+ *
+ * - Options that are not supported by the platform are ignored. Failures are logged but not fatal.
+ *
+ * @param      tcpStreamManager     TCP stream manager.
+ * @param      fileDescriptor       TCP stream listener socket file descriptor.
+ */
+static void ConfigureTCPStreamListenerSocket(HAPPlatformTCPStreamManagerRef tcpStreamManager, int fileDescriptor) {
+    HAPPrecondition(tcpStreamManager);
+
+    if (tcpStreamManager->tcpStreamListenerConfiguration.deferAccept) {
+#if defined(TCP_DEFER_ACCEPT)
+        int v = kDeferAcceptTimeout;
+        HAPLogDebug(&logObject, "setsockopt(%d, IPPROTO_TCP, TCP_DEFER_ACCEPT, %d);", fileDescriptor, v);
+        int e = setsockopt(fileDescriptor, IPPROTO_TCP, TCP_DEFER_ACCEPT, &v, sizeof v);
+        if (e != 0) {
+            HAPPlatformLogPOSIXError(
+                    kHAPLogType_Error,
+                    "System call 'setsockopt' with option 'TCP_DEFER_ACCEPT' on TCP stream listener socket failed.",
+                    errno,
+                    __func__,
+                    HAP_FILE,
+                    __LINE__);
+        }
+#else
+        HAPLog(&logObject, "Ignoring deferred accept option of the TCP stream manager.");
+#endif
+    }
+
+    if (tcpStreamManager->tcpStreamListenerConfiguration.fastOpenQueueLength) {
+#if defined(TCP_FASTOPEN)
+        int v = (int) HAPMin(tcpStreamManager->tcpStreamListenerConfiguration.fastOpenQueueLength, (size_t) INT_MAX);
+        HAPLogDebug(&logObject, "setsockopt(%d, IPPROTO_TCP, TCP_FASTOPEN, %d);", fileDescriptor, v);
+        int e = setsockopt(fileDescriptor, IPPROTO_TCP, TCP_FASTOPEN, &v, sizeof v);
+        if (e != 0) {
+            HAPPlatformLogPOSIXError(
+                    kHAPLogType_Error,
+                    "System call 'setsockopt' with option 'TCP_FASTOPEN' on TCP stream listener socket failed.",
+                    errno,
+                    __func__,
+                    HAP_FILE,
+                    __LINE__);
+        }
+#else
+        HAPLog(&logObject, "Ignoring TCP Fast Open option of the TCP stream manager.");
+#endif
+    }
+}
+
 void HAPPlatformTCPStreamManagerCreate(
         HAPPlatformTCPStreamManagerRef tcpStreamManager,
         const HAPPlatformTCPStreamManagerOptions* options) {
@@ -137,6 +268,8 @@ void HAPPlatformTCPStreamManagerCreate(
                 numInterfaceNameBytes);
     }
     tcpStreamManager->tcpStreamListenerConfiguration.port = options->port;
+    tcpStreamManager->tcpStreamListenerConfiguration.deferAccept = options->deferAccept;
+    tcpStreamManager->tcpStreamListenerConfiguration.fastOpenQueueLength = options->fastOpenQueueLength;
 
     tcpStreamManager->numTCPStreams = 0;
     tcpStreamManager->maxTCPStreams = options->maxConcurrentTCPStreams;
@@ -235,6 +368,13 @@ void HAPPlatformTCPStreamManagerOpenListener(
         HAPFatalError();
     }
 
+    // The listener is drained until accepting fails with EAGAIN, so it must not block.
+    err = SetNonblocking(fileDescriptor);
+    if (err) {
+        HAPLogError(&logObject, "Failed to configure TCP stream listener socket as non-blocking.");
+        HAPFatalError();
+    }
+
     int v = 1;
     HAPLogBufferDebug(&logObject, &v, sizeof v, "setsockopt(%d, SOL_SOCKET, SO_REUSEADDR, <buffer>);", fileDescriptor);
     e = setsockopt(fileDescriptor, SOL_SOCKET, SO_REUSEADDR, &v, sizeof v);
@@ -342,6 +482,8 @@ void HAPPlatformTCPStreamManagerOpenListener(
         HAPFatalError();
     }
 
+    ConfigureTCPStreamListenerSocket(tcpStreamManager, fileDescriptor);
+
     HAPPlatformFileHandleRef fileHandle;
     err = HAPPlatformFileHandleRegister(
             &fileHandle,
@@ -447,8 +589,7 @@ HAPError HAPPlatformTCPStreamManagerAcceptTCPStream(
     HAPAssert(tcpStream->fileDescriptor == -1);
     HAPAssert(!tcpStream->fileHandle);
 
-    HAPLogDebug(&logObject, "accept(%d, NULL, NULL);", tcpStreamManager->tcpStreamListener.fileDescriptor);
-    int fileDescriptor = accept(tcpStreamManager->tcpStreamListener.fileDescriptor, NULL, NULL);
+    int fileDescriptor = AcceptSocket(tcpStreamManager->tcpStreamListener.fileDescriptor);
     if (fileDescriptor == -1) {
         if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR && errno != ECONNABORTED && errno != EPROTO) {
             HAPPlatformLogPOSIXError(
@@ -468,14 +609,9 @@ HAPError HAPPlatformTCPStreamManagerAcceptTCPStream(
     }
 
     // Configure socket.
-    int e = SetNonblocking(fileDescriptor);
-    if (e != 0) {
-        HAPLogError(&logObject, "Failed to configure TCP stream socket as non-blocking.");
-        HAPFatalError();
-    }
-    e = SetNodelay(fileDescriptor);
-    if (e != 0) {
-        HAPLogError(&logObject, "Failed to disable Nagle's algorithm for TCP stream socket.");
+    err = ConfigureTCPStreamSocket(fileDescriptor);
+    if (err) {
+        HAPLogError(&logObject, "Failed to configure TCP stream socket.");
         HAPFatalError();
     }
 
@@ -504,6 +640,7 @@ HAPError HAPPlatformTCPStreamManagerAcceptTCPStream(
     *tcpStream_ = (HAPPlatformTCPStreamRef) tcpStream;
 
     tcpStreamManager->numTCPStreams++;
+    tcpStreamManager->tcpStreamListener.numAcceptedTCPStreams++;
 
     if (tcpStreamManager->maxTCPStreams - tcpStreamManager->numTCPStreams == 0) {
         HAPLogInfo(&logObject, "Suspending accepting new TCP streams on TCP stream listener socket.");
@@ -756,7 +893,17 @@ static void HandleTCPStreamListenerFileHandleCallback(
 
     HAPAssert(fileHandleEvents.isReadyForReading);
 
-    listener->callback(listener->tcpStreamManager, listener->context);
+    // Drain the listen backlog so that connections that arrive in a burst are accepted within a single wakeup.
+    // The callback is invoked again as long as it accepts a TCP stream and more TCP streams can be accepted.
+    HAPPlatformTCPStreamManagerRef tcpStreamManager = HAPNonnull(listener->tcpStreamManager);
+    for (size_t i = 0; i < tcpStreamManager->maxTCPStreams; i++) {
+        size_t numAcceptedTCPStreams = listener->numAcceptedTCPStreams;
+        HAPNonnull(listener->callback)(tcpStreamManager, listener->context);
+        if (listener->fileDescriptor == -1 || listener->numAcceptedTCPStreams == numAcceptedTCPStreams ||
+            tcpStreamManager->numTCPStreams == tcpStreamManager->maxTCPStreams) {
+            break;
+        }
+    }
 }
 
 static void HandleTCPStreamFileHandleCallback(
@@ -73,3 +73,17 @@ HAPError HAPPlatformMFiHWAuthRead(
     HAPLogError(&logObject, "MFi HW Auth read failed: Not supported on Windows.");
     return kHAPError_Unknown;
 }
+
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformMFiHWAuthTryWrite(HAPPlatformMFiHWAuthRef mfiHWAuth, const void* bytes, size_t numBytes) {
+    return HAPPlatformMFiHWAuthWrite(mfiHWAuth, bytes, numBytes);
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformMFiHWAuthTryRead(
+        HAPPlatformMFiHWAuthRef mfiHWAuth,
+        uint8_t registerAddress,
+        void* bytes,
+        size_t numBytes) {
+    return HAPPlatformMFiHWAuthRead(mfiHWAuth, registerAddress, bytes, numBytes);
+}
@@ -0,0 +1,613 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+// Measures how the cost of the accessory server scales with the size of the accessory database, using synthetic
+// databases with characteristics of every format:
+//
+// - HAP-IP: cold start, GET /accessories, GET /characteristics and event notifications of a bridge, as a function of
+//   the number of bridged accessories. Requests are sent by a simulated controller over a HAP session.
+// - HAP-BLE: start and stop including GATT table setup of a standalone accessory, as a function of the number of
+//   services. HAP-BLE does not support bridges.
+//
+// Costs are normalized per unit of work (characteristic, read or event). The benchmark fails if the normalized cost
+// for the largest database exceeds the normalized cost for the smallest database by more than kMaxGrowthFactor,
+// i.e. if the cost grows superlinearly.
+
+#include <time.h>
+
+#include "HAP+Internal.h"
+#include "HAPPlatform+Init.h"
+#include "HAPPlatformBLEPeripheralManager+Init.h"
+
+#include "../Harness/HAPIPController.c"
+#include "../Harness/SyntheticDB.c"
+#include "../Harness/TemplateDB.c"
+
+/**
+ * Number of iterations per measurement.
+ */
+#define kNumIterations ((size_t) 20)
+
+/**
+ * Number of repetitions per measurement. The fastest repetition is reported to reduce noise.
+ */
+#define kNumRepetitions ((size_t) 3)
+
+/**
+ * Maximum factor by which the normalized cost may grow from the smallest to the largest database.
+ */
+#define kMaxGrowthFactor ((uint64_t) 2)
+
+/**
+ * Number of synthetic services per bridged accessory.
+ */
+#define kNumServices ((size_t) 2)
+
+/**
+ * Number of characteristics per synthetic service.
+ */
+#define kNumCharacteristics kSyntheticDB_NumFormats
+
+/**
+ * Maximum number of characteristics of the bridge, including the bridged accessories.
+ */
+#define kMaxCharacteristics ((size_t) 4500)
+
+/**
+ * Maximum number of GATT attributes of the standalone accessory.
+ */
+#define kMaxBLEAttributes ((size_t) 4096)
+
+/**
+ * Numbers of bridged accessories of the HAP-IP measurements.
+ */
+static const size_t kNumBridgedAccessories[] = { 25, 50, 100, kHAPAccessoryServerMaxBridgedAccessories };
+
+/**
+ * Numbers of synthetic services of the HAP-BLE measurements.
+ */
+static const size_t kNumBLEServices[] = { 2, 4, 8, kSyntheticDB_MaxServices };
+HAP_STATIC_ASSERT(HAPArrayCount(kNumBLEServices) == HAPArrayCount(kNumBridgedAccessories), NumBLEServices);
+
+static const HAPLogObject logObject = { .subsystem = kHAP_LogSubsystem, .category = "ScalingBenchmark" };
+
+static bool isIdle;
+
+static void HandleUpdatedAccessoryServerState(HAPAccessoryServerRef* server, void* _Nullable context HAP_UNUSED) {
+    HAPPrecondition(server);
+
+    isIdle = HAPAccessoryServerGetState(server) == kHAPAccessoryServerState_Idle;
+}
+
+/**
+ * Measurement in progress.
+ */
+typedef struct {
+    clock_t startTime;
+    clock_t elapsedTime;
+} Measurement;
+
+static void BeginMeasurement(Measurement* measurement) {
+    HAPPrecondition(measurement);
+
+    measurement->startTime = clock();
+}
+
+static void PauseMeasurement(Measurement* measurement) {
+    HAPPrecondition(measurement);
+
+    measurement->elapsedTime += clock() - measurement->startTime;
+}
+
+/**
+ * Returns the CPU time per operation of a paused measurement.
+ *
+ * @param      measurement          Measurement.
+ * @param      numOperations        Number of operations.
+ *
+ * @return CPU time per operation in nanoseconds.
+ */
+HAP_RESULT_USE_CHECK
+static uint64_t GetNanosecondsPerOperation(const Measurement* measurement, size_t numOperations) {
+    HAPPrecondition(measurement);
+    HAPPrecondition(numOperations);
+
+    return (uint64_t) measurement->elapsedTime * 1000000000 / CLOCKS_PER_SEC / numOperations;
+}
+
+/**
+ * Scaling of a measured operation.
+ */
+typedef struct {
+    /** Name of the operation. */
+    const char* name;
+
+    /** Unit of work that the cost is normalized to. */
+    const char* unit;
+
+    /** Name of the parameter that the database size is varied with. */
+    const char* parameter;
+
+    /** Values of the parameter. */
+    const size_t* parameterValues;
+
+    /** Normalized cost in nanoseconds, indexed like parameterValues. */
+    uint64_t costs[HAPArrayCount(kNumBridgedAccessories)];
+} Scaling;
+
+/**
+ * Logs the normalized costs of an operation and checks that they do not grow superlinearly.
+ *
+ * @param      scaling              Scaling of the operation.
+ *
+ * @return true                     If the normalized cost grows at most by kMaxGrowthFactor.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool CheckScaling(const Scaling* scaling) {
+    HAPPrecondition(scaling);
+
+    for (size_t i = 0; i < HAPArrayCount(scaling->costs); i++) {
+        HAPLog(&logObject,
+               "%s (%zu %s): %llu ns CPU/%s.",
+               scaling->name,
+               scaling->parameterValues[i],
+               scaling->parameter,
+               (unsigned long long) scaling->costs[i],
+               scaling->unit);
+    }
+    uint64_t smallestCost = HAPMax(scaling->costs[0], 1);
+    uint64_t largestCost = scaling->costs[HAPArrayCount(scaling->costs) - 1];
+    if (largestCost > kMaxGrowthFactor * smallestCost) {
+        HAPLogError(
+                &logObject,
+                "%s: cost per %s grows superlinearly (%llu ns -> %llu ns).",
+                scaling->name,
+                scaling->unit,
+                (unsigned long long) smallestCost,
+                (unsigned long long) largestCost);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Builds the requests that address one characteristic of every bridged accessory, cycling through all formats.
+ *
+ * @param      db                   Synthetic accessory database.
+ * @param[out] uri                  GET /characteristics request URI.
+ * @param      maxURIBytes          Capacity of request URI buffer.
+ * @param[out] requestBytes         PUT /characteristics request body that subscribes to the characteristics.
+ * @param      maxRequestBytes      Capacity of request body buffer.
+ */
+static void BuildCharacteristicRequests(
+        const SyntheticDB* db,
+        char* uri,
+        size_t maxURIBytes,
+        char* requestBytes,
+        size_t maxRequestBytes) {
+    HAPPrecondition(db);
+    HAPPrecondition(db->bridgedAccessories);
+    HAPPrecondition(uri);
+    HAPPrecondition(requestBytes);
+
+    HAPError err;
+
+    err = HAPStringWithFormat(uri, maxURIBytes, "/characteristics?id=");
+    HAPAssert(!err);
+    err = HAPStringWithFormat(requestBytes, maxRequestBytes, "{\"characteristics\":[");
+    HAPAssert(!err);
+    for (size_t i = 0; i < db->numBridgedAccessories; i++) {
+        const HAPAccessory* accessory = HAPNonnull(HAPNonnull(db->bridgedAccessories)[i]);
+        const HAPCharacteristic* characteristic =
+                SyntheticDBGetCharacteristic(db, i % db->numServices, i % db->numCharacteristics);
+        uint64_t iid = ((const HAPBaseCharacteristic*) characteristic)->iid;
+
+        size_t numURIBytes = HAPStringGetNumBytes(uri);
+        err = HAPStringWithFormat(
+                &uri[numURIBytes],
+                maxURIBytes - numURIBytes,
+                "%s%llu.%llu",
+                i ? "," : "",
+                (unsigned long long) accessory->aid,
+                (unsigned long long) iid);
+        HAPAssert(!err);
+        size_t numRequestBytes = HAPStringGetNumBytes(requestBytes);
+        err = HAPStringWithFormat(
+                &requestBytes[numRequestBytes],
+                maxRequestBytes - numRequestBytes,
+                "%s{\"aid\":%llu,\"iid\":%llu,\"ev\":true}",
+                i ? "," : "",
+                (unsigned long long) accessory->aid,
+                (unsigned long long) iid);
+        HAPAssert(!err);
+    }
+    size_t numRequestBytes = HAPStringGetNumBytes(requestBytes);
+    err = HAPStringWithFormat(&requestBytes[numRequestBytes], maxRequestBytes - numRequestBytes, "]}");
+    HAPAssert(!err);
+}
+
+/**
+ * Starts the accessory server and waits until it is running.
+ *
+ * @param      server               Accessory server.
+ * @param      db                   Synthetic accessory database.
+ */
+static void StartAccessoryServer(HAPAccessoryServerRef* server, const SyntheticDB* db) {
+    HAPPrecondition(server);
+    HAPPrecondition(db);
+
+    if (db->bridgedAccessories) {
+        HAPAccessoryServerStartBridge(
+                server,
+                db->primaryAccessory,
+                HAPNonnullVoid(db->bridgedAccessories),
+                /* configurationChanged: */ false);
+    } else {
+        HAPAccessoryServerStart(server, db->primaryAccessory);
+    }
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(server) == kHAPAccessoryServerState_Running);
+    isIdle = false;
+}
+
+/**
+ * Stops the accessory server and waits until it is idle.
+ *
+ * @param      server               Accessory server.
+ */
+static void StopAccessoryServer(HAPAccessoryServerRef* server) {
+    HAPPrecondition(server);
+
+    HAPAccessoryServerStop(server);
+    while (!isIdle) {
+        HAPPlatformClockAdvance(0);
+    }
+}
+
+/**
+ * Removes the fingerprint of the last validated accessory definitions so that the next start validates them.
+ */
+static void ForgetValidatedAccessoryDefinitions(void) {
+    HAPError err = HAPPlatformKeyValueStoreRemove(
+            platform.keyValueStore,
+            kHAPKeyValueStoreDomain_Configuration,
+            kHAPKeyValueStoreKey_Configuration_ValidationFingerprint);
+    HAPAssert(!err);
+}
+
+int main() {
+    HAPError err;
+    HAPPlatformCreate();
+
+    // Provision accessory server and a paired controller.
+    static const HAPAccessoryServerDeviceID deviceID = { { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 } };
+    err = HAPLegacyImportDeviceID(platform.keyValueStore, &deviceID);
+    HAPAssert(!err);
+    HAPAccessoryServerLongTermSecretKey accessoryLTSK;
+    HAPPlatformRandomNumberFill(accessoryLTSK.bytes, sizeof accessoryLTSK.bytes);
+    err = HAPLegacyImportLongTermSecretKey(platform.keyValueStore, &accessoryLTSK);
+    HAPAssert(!err);
+    uint8_t accessoryLTPK[ED25519_PUBLIC_KEY_BYTES];
+    HAP_ed25519_public_key(accessoryLTPK, accessoryLTSK.bytes);
+
+    static const HAPControllerPairingIdentifier pairingIdentifier = {
+        .bytes = "4E5D4B2F-6A3B-4C1D-9E8F-0A1B2C3D4E5F", .numBytes = 36
+    };
+    uint8_t controllerLTSK[ED25519_SECRET_KEY_BYTES];
+    HAPPlatformRandomNumberFill(controllerLTSK, sizeof controllerLTSK);
+    HAPControllerPublicKey controllerLTPK;
+    HAP_ed25519_public_key(controllerLTPK.bytes, controllerLTSK);
+    err = HAPLegacyImportControllerPairing(
+            platform.keyValueStore, 0, &pairingIdentifier, &controllerLTPK, /* isAdmin: */ true);
+    HAPAssert(!err);
+
+    bool isScalingAcceptable = true;
+
+    // HAP-IP.
+    {
+        // Prepare accessory server storage.
+        static HAPIPSession ipSessions[kHAPIPSessionStorage_DefaultNumElements];
+        static uint8_t ipInboundBuffers[HAPArrayCount(ipSessions)][kHAPIPSession_DefaultInboundBufferSize];
+        static uint8_t ipOutboundBuffers[HAPArrayCount(ipSessions)][kHAPIPSession_DefaultOutboundBufferSize];
+        static HAPIPEventNotificationRef
+                ipEventNotifications[HAPArrayCount(ipSessions)]
+                                    [HAPIPSessionGetNumEventNotifications(kMaxCharacteristics, 0)];
+        for (size_t i = 0; i < HAPArrayCount(ipSessions); i++) {
+            ipSessions[i].inboundBuffer.bytes = ipInboundBuffers[i];
+            ipSessions[i].inboundBuffer.numBytes = sizeof ipInboundBuffers[i];
+            ipSessions[i].outboundBuffer.bytes = ipOutboundBuffers[i];
+            ipSessions[i].outboundBuffer.numBytes = sizeof ipOutboundBuffers[i];
+            ipSessions[i].eventNotifications = ipEventNotifications[i];
+            ipSessions[i].numEventNotifications = HAPArrayCount(ipEventNotifications[i]);
+        }
+        static HAPIPReadContextRef ipReadContexts[kMaxCharacteristics];
+        static HAPIPWriteContextRef ipWriteContexts[kMaxCharacteristics];
+        static HAPIPCharacteristicIndexElementRef ipCharacteristicIndexElements[kMaxCharacteristics];
+        static uint8_t ipScratchBuffer[kHAPIPSession_DefaultScratchBufferSize];
+        static HAPIPAccessoryServerStorage ipAccessoryServerStorage = {
+            .sessions = ipSessions,
+            .numSessions = HAPArrayCount(ipSessions),
+            .readContexts = ipReadContexts,
+            .numReadContexts = HAPArrayCount(ipReadContexts),
+            .writeContexts = ipWriteContexts,
+            .numWriteContexts = HAPArrayCount(ipWriteContexts),
+            .characteristicIndexElements = ipCharacteristicIndexElements,
+            .numCharacteristicIndexElements = HAPArrayCount(ipCharacteristicIndexElements),
+            .scratchBuffer = { .bytes = ipScratchBuffer, .numBytes = sizeof ipScratchBuffer }
+        };
+
+        // Initialize accessory server.
+        static HAPAccessoryServerRef accessoryServer;
+        HAPAccessoryServerCreate(
+                &accessoryServer,
+                &(const HAPAccessoryServerOptions) {
+                        .maxPairings = kHAPPairingStorage_MinElements,
+                        .ip = { .transport = &kHAPAccessoryServerTransport_IP,
+                                .accessoryServerStorage = &ipAccessoryServerStorage } },
+                &platform,
+                &(const HAPAccessoryServerCallbacks) { .handleUpdatedState = HandleUpdatedAccessoryServerState },
+                /* context: */ NULL);
+
+        Scaling startScaling = { .name = "Start (cold)",
+                                 .unit = "characteristic",
+                                 .parameter = "bridged accessories",
+                                 .parameterValues = kNumBridgedAccessories };
+        Scaling accessoriesScaling = { .name = "GET /accessories",
+                                       .unit = "characteristic",
+                                       .parameter = "bridged accessories",
+                                       .parameterValues = kNumBridgedAccessories };
+        Scaling characteristicsScaling = { .name = "GET /characteristics",
+                                           .unit = "read",
+                                           .parameter = "bridged accessories",
+                                           .parameterValues = kNumBridgedAccessories };
+        Scaling eventScaling = { .name = "Event notification",
+                                 .unit = "event",
+                                 .parameter = "bridged accessories",
+                                 .parameterValues = kNumBridgedAccessories };
+
+        for (size_t i = 0; i < HAPArrayCount(kNumBridgedAccessories); i++) {
+            SyntheticDB db;
+            SyntheticDBCreate(
+                    &db,
+                    &(const SyntheticDBOptions) { .numBridgedAccessories = kNumBridgedAccessories[i],
+                                                  .numServices = kNumServices,
+                                                  .numCharacteristics = kNumCharacteristics });
+            HAPAccessoryServerStorageUsage requirements;
+            HAPAccessoryServerGetStorageRequirements(db.primaryAccessory, db.bridgedAccessories, &requirements);
+            HAPAssert(requirements.ip.numCharacteristicIndexElements <= kMaxCharacteristics);
+            size_t numCharacteristics = requirements.ip.numCharacteristicIndexElements;
+
+            // Cold start.
+            uint64_t cost = UINT64_MAX;
+            for (size_t j = 0; j < kNumRepetitions; j++) {
+                Measurement measurement = { 0 };
+                for (size_t k = 0; k < kNumIterations; k++) {
+                    ForgetValidatedAccessoryDefinitions();
+                    BeginMeasurement(&measurement);
+                    StartAccessoryServer(&accessoryServer, &db);
+                    PauseMeasurement(&measurement);
+                    StopAccessoryServer(&accessoryServer);
+                }
+                cost = HAPMin(cost, GetNanosecondsPerOperation(&measurement, kNumIterations * numCharacteristics));
+            }
+            startScaling.costs[i] = cost;
+
+            // Connect and establish a HAP session.
+            StartAccessoryServer(&accessoryServer, &db);
+            static HAPIPController controller;
+            HAPIPControllerCreate(
+                    &controller,
+                    &(const HAPIPControllerOptions) { .tcpStreamManager = HAPNonnull(platform.ip.tcpStreamManager),
+                                                      .pairingIdentifier = &pairingIdentifier,
+                                                      .longTermSecretKey = controllerLTSK,
+                                                      .accessoryLongTermPublicKey = accessoryLTPK });
+            err = HAPIPControllerConnect(&controller);
+            HAPAssert(!err);
+            err = HAPIPControllerPairVerify(&controller);
+            HAPAssert(!err);
+
+            // GET /accessories.
+            unsigned int status;
+            size_t numResponseBytes;
+            cost = UINT64_MAX;
+            for (size_t j = 0; j < kNumRepetitions; j++) {
+                Measurement measurement = { 0 };
+                BeginMeasurement(&measurement);
+                for (size_t k = 0; k < kNumIterations; k++) {
+                    err = HAPIPControllerPerformRequest(
+                            &controller,
+                            "GET",
+                            "/accessories",
+                            /* contentType: */ NULL,
+                            /* requestBodyBytes: */ NULL,
+                            0,
+                            &status,
+                            /* responseBodyBytes: */ NULL,
+                            0,
+                            &numResponseBytes);
+                    HAPAssert(!err);
+                    HAPAssert(status == 200);
+                }
+                PauseMeasurement(&measurement);
+                cost = HAPMin(cost, GetNanosecondsPerOperation(&measurement, kNumIterations * numCharacteristics));
+            }
+            accessoriesScaling.costs[i] = cost;
+
+            // GET /characteristics.
+            static char uri[kHAPIPSession_DefaultInboundBufferSize / 2];
+            static char requestBytes[kHAPIPSession_DefaultInboundBufferSize / 2];
+            BuildCharacteristicRequests(&db, uri, sizeof uri, requestBytes, sizeof requestBytes);
+            cost = UINT64_MAX;
+            for (size_t j = 0; j < kNumRepetitions; j++) {
+                Measurement measurement = { 0 };
+                BeginMeasurement(&measurement);
+                for (size_t k = 0; k < kNumIterations; k++) {
+                    size_t numCallbacks = SyntheticDBGetNumCallbacks();
+                    err = HAPIPControllerPerformRequest(
+                            &controller,
+                            "GET",
+                            uri,
+                            /* contentType: */ NULL,
+                            /* requestBodyBytes: */ NULL,
+                            0,
+                            &status,
+                            /* responseBodyBytes: */ NULL,
+                            0,
+                            &numResponseBytes);
+                    HAPAssert(!err);
+                    HAPAssert(status == 200);
+                    HAPAssert(SyntheticDBGetNumCallbacks() - numCallbacks == db.numBridgedAccessories);
+                }
+                PauseMeasurement(&measurement);
+                cost = HAPMin(
+                        cost, GetNanosecondsPerOperation(&measurement, kNumIterations * db.numBridgedAccessories));
+            }
+            characteristicsScaling.costs[i] = cost;
+
+            // Event notifications.
+            err = HAPIPControllerPerformRequest(
+                    &controller,
+                    "PUT",
+                    "/characteristics",
+                    "application/hap+json",
+                    requestBytes,
+                    HAPStringGetNumBytes(requestBytes),
+                    &status,
+                    /* responseBodyBytes: */ NULL,
+                    0,
+                    &numResponseBytes);
+            HAPAssert(!err);
+            HAPAssert(status == 204);
+            cost = UINT64_MAX;
+            for (size_t j = 0; j < kNumRepetitions; j++) {
+                Measurement measurement = { 0 };
+                BeginMeasurement(&measurement);
+                for (size_t k = 0; k < kNumIterations; k++) {
+                    for (size_t l = 0; l < db.numBridgedAccessories; l++) {
+                        HAPAccessoryServerRaiseEvent(
+                                &accessoryServer,
+                                SyntheticDBGetCharacteristic(&db, l % kNumServices, l % kNumCharacteristics),
+                                db.services[l % kNumServices],
+                                HAPNonnull(HAPNonnull(db.bridgedAccessories)[l]));
+                    }
+                    HAPPlatformClockAdvance(1 * HAPSecond);
+                    size_t numEvents = 0;
+                    for (;;) {
+                        static char eventBytes[kHAPIPSession_DefaultOutboundBufferSize];
+                        size_t numEventBytes;
+                        err = HAPIPControllerReceiveEvent(&controller, eventBytes, sizeof eventBytes, &numEventBytes);
+                        if (err) {
+                            HAPAssert(err == kHAPError_InvalidState);
+                            break;
+                        }
+                        for (size_t m = 0; m + sizeof "\"aid\":" - 1 <= numEventBytes; m++) {
+                            if (HAPRawBufferAreEqual(&eventBytes[m], "\"aid\":", sizeof "\"aid\":" - 1)) {
+                                numEvents++;
+                            }
+                        }
+                    }
+                    HAPAssert(numEvents == db.numBridgedAccessories);
+                }
+                PauseMeasurement(&measurement);
+                cost = HAPMin(
+                        cost, GetNanosecondsPerOperation(&measurement, kNumIterations * db.numBridgedAccessories));
+            }
+            eventScaling.costs[i] = cost;
+
+            HAPIPControllerDisconnect(&controller);
+            StopAccessoryServer(&accessoryServer);
+        }
+        HAPAccessoryServerRelease(&accessoryServer);
+
+        isScalingAcceptable &= CheckScaling(&startScaling);
+        isScalingAcceptable &= CheckScaling(&accessoriesScaling);
+        isScalingAcceptable &= CheckScaling(&characteristicsScaling);
+        isScalingAcceptable &= CheckScaling(&eventScaling);
+    }
+
+    // HAP-BLE.
+    {
+        // The GATT table of the largest standalone accessory does not fit into the default BLE peripheral manager.
+        static HAPPlatformBLEPeripheralManagerAttribute attributes[kMaxBLEAttributes];
+        HAPPlatformBLEPeripheralManagerCreate(
+                HAPNonnull(platform.ble.blePeripheralManager),
+                &(const HAPPlatformBLEPeripheralManagerOptions) { .attributes = attributes,
+                                                                  .numAttributes = HAPArrayCount(attributes) });
+
+        // Prepare accessory server storage.
+        static HAPBLEGATTTableElementRef gattTableElements[kSyntheticDB_MaxServices * (1 + kNumCharacteristics) + 32];
+        static HAPBLESessionCacheElementRef sessionCacheElements[kHAPBLESessionCache_MinElements];
+        static HAPSessionRef session;
+        static uint8_t procedureBytes[2048];
+        static HAPBLEProcedureRef procedures[1];
+        static HAPBLEAccessoryServerStorage bleAccessoryServerStorage = {
+            .gattTableElements = gattTableElements,
+            .numGATTTableElements = HAPArrayCount(gattTableElements),
+            .sessionCacheElements = sessionCacheElements,
+            .numSessionCacheElements = HAPArrayCount(sessionCacheElements),
+            .session = &session,
+            .procedures = procedures,
+            .numProcedures = HAPArrayCount(procedures),
+            .procedureBuffer = { .bytes = procedureBytes, .numBytes = sizeof procedureBytes },
+        };
+
+        // Initialize accessory server.
+        static HAPAccessoryServerRef accessoryServer;
+        HAPAccessoryServerCreate(
+                &accessoryServer,
+                &(const HAPAccessoryServerOptions) {
+                        .maxPairings = kHAPPairingStorage_MinElements,
+                        .ble = { .transport = &kHAPAccessoryServerTransport_BLE,
+                                 .accessoryServerStorage = &bleAccessoryServerStorage,
+                                 .preferredAdvertisingInterval = kHAPBLEAdvertisingInterval_Minimum,
+                                 .preferredNotificationDuration = kHAPBLENotification_MinDuration } },
+                &platform,
+                &(const HAPAccessoryServerCallbacks) { .handleUpdatedState = HandleUpdatedAccessoryServerState },
+                /* context: */ NULL);
+
+        Scaling startScaling = { .name = "Start and stop (BLE)",
+                                 .unit = "GATT table element",
+                                 .parameter = "services",
+                                 .parameterValues = kNumBLEServices };
+
+        for (size_t i = 0; i < HAPArrayCount(kNumBLEServices); i++) {
+            SyntheticDB db;
+            SyntheticDBCreate(
+                    &db,
+                    &(const SyntheticDBOptions) { .numBridgedAccessories = 0,
+                                                  .numServices = kNumBLEServices[i],
+                                                  .numCharacteristics = kNumCharacteristics });
+            HAPAccessoryServerStorageUsage requirements;
+            HAPAccessoryServerGetStorageRequirements(db.primaryAccessory, db.bridgedAccessories, &requirements);
+            HAPAssert(requirements.ble.numGATTTableElements <= HAPArrayCount(gattTableElements));
+            size_t numGATTTableElements = requirements.ble.numGATTTableElements;
+
+            uint64_t cost = UINT64_MAX;
+            for (size_t j = 0; j < kNumRepetitions; j++) {
+                Measurement measurement = { 0 };
+                BeginMeasurement(&measurement);
+                for (size_t k = 0; k < kNumIterations; k++) {
+                    ForgetValidatedAccessoryDefinitions();
+                    StartAccessoryServer(&accessoryServer, &db);
+                    StopAccessoryServer(&accessoryServer);
+                }
+                PauseMeasurement(&measurement);
+                cost = HAPMin(cost, GetNanosecondsPerOperation(&measurement, kNumIterations * numGATTTableElements));
+            }
+            startScaling.costs[i] = cost;
+        }
+        HAPAccessoryServerRelease(&accessoryServer);
+
+        isScalingAcceptable &= CheckScaling(&startScaling);
+    }
+
+    if (!isScalingAcceptable) {
+        HAPLogError(&logObject, "Superlinear scaling detected.");
+        return 1;
+    }
+    return 0;
+}
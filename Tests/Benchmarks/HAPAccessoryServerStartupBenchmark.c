@@ -0,0 +1,282 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+// Measures the start of a HAP-IP bridge with the maximum number of bridged accessories, broken down into phases:
+// validation of the accessory definitions, fingerprinting, a cold start that validates the accessory definitions,
+// a warm start that skips validation of the unchanged accessory definitions, and stopping the accessory server.
+
+#include <time.h>
+
+#include "HAP+Internal.h"
+#include "HAPPlatform+Init.h"
+
+#include "../Harness/TemplateDB.c"
+
+#define kIID_LightBulb   ((uint64_t) 0x0030)
+#define kIID_LightBulbOn ((uint64_t) 0x0031)
+
+/**
+ * Number of iterations per measurement.
+ */
+#define kNumIterations ((size_t) 100)
+
+/**
+ * Maximum number of characteristics of the bridge, including the bridged accessories.
+ */
+#define kMaxCharacteristics ((size_t) 1400)
+
+static const HAPLogObject logObject = { .subsystem = kHAP_LogSubsystem, .category = "StartupBenchmark" };
+
+static bool isIdle;
+
+static void HandleUpdatedAccessoryServerState(HAPAccessoryServerRef* server, void* _Nullable context HAP_UNUSED) {
+    HAPPrecondition(server);
+
+    isIdle = HAPAccessoryServerGetState(server) == kHAPAccessoryServerState_Idle;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError IdentifyAccessory(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPAccessoryIdentifyRequest* request HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleLightBulbOnRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPBoolCharacteristicReadRequest* request HAP_UNUSED,
+        bool* value,
+        void* _Nullable context HAP_UNUSED) {
+    *value = false;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleLightBulbOnWrite(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPBoolCharacteristicWriteRequest* request HAP_UNUSED,
+        bool value HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    return kHAPError_None;
+}
+
+static const HAPBoolCharacteristic lightBulbOnCharacteristic = {
+    .format = kHAPCharacteristicFormat_Bool,
+    .iid = kIID_LightBulbOn,
+    .characteristicType = &kHAPCharacteristicType_On,
+    .debugDescription = kHAPCharacteristicDebugDescription_On,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = true,
+                    .supportsEventNotification = true,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false, .supportsWriteResponse = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .callbacks = { .handleRead = HandleLightBulbOnRead, .handleWrite = HandleLightBulbOnWrite }
+};
+
+static const HAPService lightBulbService = {
+    .iid = kIID_LightBulb,
+    .serviceType = &kHAPServiceType_LightBulb,
+    .debugDescription = kHAPServiceDebugDescription_LightBulb,
+    .name = NULL,
+    .properties = { .primaryService = true, .hidden = false, .ble = { .supportsConfiguration = false } },
+    .linkedServices = NULL,
+    .characteristics = (const HAPCharacteristic* const[]) { &lightBulbOnCharacteristic, NULL }
+};
+
+static const HAPAccessory bridgeAccessory = { .aid = 1,
+                                              .category = kHAPAccessoryCategory_Bridges,
+                                              .name = "Acme Bridge",
+                                              .manufacturer = "Acme",
+                                              .model = "Bridge1,1",
+                                              .serialNumber = "099DB48E9E28",
+                                              .firmwareVersion = "1",
+                                              .hardwareVersion = "1",
+                                              .services = (const HAPService* const[]) { &accessoryInformationService,
+                                                                                        &hapProtocolInformationService,
+                                                                                        &pairingService,
+                                                                                        NULL },
+                                              .callbacks = { .identify = IdentifyAccessory } };
+
+/**
+ * Measurement in progress.
+ */
+typedef struct {
+    clock_t startTime;
+} Measurement;
+
+static void BeginMeasurement(Measurement* measurement) {
+    HAPPrecondition(measurement);
+
+    measurement->startTime = clock();
+}
+
+static void EndMeasurement(const Measurement* measurement, const char* name, size_t numOperations) {
+    HAPPrecondition(measurement);
+    HAPPrecondition(name);
+    HAPPrecondition(numOperations);
+
+    uint64_t cpuNanoseconds = (uint64_t)(clock() - measurement->startTime) * 1000000000 / CLOCKS_PER_SEC;
+    HAPLog(&logObject, "%s: %llu ns CPU/op.", name, (unsigned long long) (cpuNanoseconds / numOperations));
+}
+
+int main() {
+    HAPPlatformCreate();
+
+    // Bridged accessories.
+    static const HAPService* const bridgedAccessoryServices[] = { &accessoryInformationService,
+                                                                  &lightBulbService,
+                                                                  NULL };
+    static HAPAccessory bridgedAccessories[kHAPAccessoryServerMaxBridgedAccessories];
+    static const HAPAccessory* _Nullable bridgedAccessoryList[HAPArrayCount(bridgedAccessories) + 1];
+    for (size_t i = 0; i < HAPArrayCount(bridgedAccessories); i++) {
+        bridgedAccessories[i] = (HAPAccessory) {
+            .aid = 2 + i,
+            .category = kHAPAccessoryCategory_BridgedAccessory,
+            .name = "Acme Light Bulb",
+            .manufacturer = "Acme",
+            .model = "LightBulb1,1",
+            .serialNumber = "099DB48E9E28",
+            .firmwareVersion = "1",
+            .services = bridgedAccessoryServices,
+            .callbacks = { .identify = IdentifyAccessory }
+        };
+        bridgedAccessoryList[i] = &bridgedAccessories[i];
+    }
+
+    HAPAccessoryServerStorageUsage requirements;
+    HAPAccessoryServerGetStorageRequirements(&bridgeAccessory, bridgedAccessoryList, &requirements);
+    HAPPrecondition(requirements.ip.numCharacteristicIndexElements <= kMaxCharacteristics);
+
+    // Prepare accessory server storage.
+    static HAPIPSession ipSessions[kHAPIPSessionStorage_DefaultNumElements];
+    static uint8_t ipInboundBuffers[HAPArrayCount(ipSessions)][kHAPIPSession_DefaultInboundBufferSize];
+    static uint8_t ipOutboundBuffers[HAPArrayCount(ipSessions)][kHAPIPSession_DefaultOutboundBufferSize];
+    static HAPIPEventNotificationRef ipEventNotifications[HAPArrayCount(ipSessions)]
+                                                         [HAPIPSessionGetNumEventNotifications(kMaxCharacteristics, 0)];
+    for (size_t i = 0; i < HAPArrayCount(ipSessions); i++) {
+        ipSessions[i].inboundBuffer.bytes = ipInboundBuffers[i];
+        ipSessions[i].inboundBuffer.numBytes = sizeof ipInboundBuffers[i];
+        ipSessions[i].outboundBuffer.bytes = ipOutboundBuffers[i];
+        ipSessions[i].outboundBuffer.numBytes = sizeof ipOutboundBuffers[i];
+        ipSessions[i].eventNotifications = ipEventNotifications[i];
+        ipSessions[i].numEventNotifications = HAPArrayCount(ipEventNotifications[i]);
+    }
+    static HAPIPReadContextRef ipReadContexts[kMaxCharacteristics];
+    static HAPIPWriteContextRef ipWriteContexts[kMaxCharacteristics];
+    static HAPIPCharacteristicIndexElementRef ipCharacteristicIndexElements[kMaxCharacteristics];
+    static uint8_t ipScratchBuffer[kHAPIPSession_DefaultScratchBufferSize];
+    static HAPIPAccessoryServerStorage ipAccessoryServerStorage = {
+        .sessions = ipSessions,
+        .numSessions = HAPArrayCount(ipSessions),
+        .readContexts = ipReadContexts,
+        .numReadContexts = HAPArrayCount(ipReadContexts),
+        .writeContexts = ipWriteContexts,
+        .numWriteContexts = HAPArrayCount(ipWriteContexts),
+        .characteristicIndexElements = ipCharacteristicIndexElements,
+        .numCharacteristicIndexElements = HAPArrayCount(ipCharacteristicIndexElements),
+        .scratchBuffer = { .bytes = ipScratchBuffer, .numBytes = sizeof ipScratchBuffer }
+    };
+
+    // Initialize accessory server.
+    static HAPAccessoryServerRef accessoryServer;
+    HAPAccessoryServerCreate(
+            &accessoryServer,
+            &(const HAPAccessoryServerOptions) {
+                    .maxPairings = kHAPPairingStorage_MinElements,
+                    .skipUnchangedAccessoryValidation = true,
+                    .ip = { .transport = &kHAPAccessoryServerTransport_IP,
+                            .accessoryServerStorage = &ipAccessoryServerStorage } },
+            &platform,
+            &(const HAPAccessoryServerCallbacks) { .handleUpdatedState = HandleUpdatedAccessoryServerState },
+            /* context: */ NULL);
+
+    HAPLog(&logObject,
+           "Bridge with %zu bridged accessories, %zu characteristics.",
+           HAPArrayCount(bridgedAccessories),
+           requirements.ip.numCharacteristicIndexElements);
+
+    Measurement measurement;
+    BeginMeasurement(&measurement);
+    for (size_t i = 0; i < kNumIterations; i++) {
+        HAPAssert(HAPRegularAccessoryIsValid(&accessoryServer, &bridgeAccessory));
+        HAPAssert(HAPBridgedAccessoriesAreValid(bridgedAccessoryList));
+    }
+    EndMeasurement(&measurement, "Validation", kNumIterations);
+
+    uint64_t fingerprint = HAPAccessoryValidationGetFingerprint(&bridgeAccessory, bridgedAccessoryList);
+    BeginMeasurement(&measurement);
+    for (size_t i = 0; i < kNumIterations; i++) {
+        HAPAssert(HAPAccessoryValidationGetFingerprint(&bridgeAccessory, bridgedAccessoryList) == fingerprint);
+    }
+    EndMeasurement(&measurement, "Fingerprint", kNumIterations);
+
+    // Cold start: the fingerprint of the last validated accessory definitions is not available.
+    clock_t startTime = 0;
+    clock_t stopTime = 0;
+    for (size_t i = 0; i < kNumIterations; i++) {
+        HAPError err = HAPPlatformKeyValueStoreRemove(
+                platform.keyValueStore,
+                kHAPKeyValueStoreDomain_Configuration,
+                kHAPKeyValueStoreKey_Configuration_ValidationFingerprint);
+        HAPAssert(!err);
+
+        clock_t time = clock();
+        HAPAccessoryServerStartBridge(
+                &accessoryServer, &bridgeAccessory, bridgedAccessoryList, /* configurationChanged: */ false);
+        HAPPlatformClockAdvance(0);
+        startTime += clock() - time;
+        HAPAssert(!isIdle);
+
+        time = clock();
+        HAPAccessoryServerStop(&accessoryServer);
+        while (!isIdle) {
+            HAPPlatformClockAdvance(0);
+        }
+        stopTime += clock() - time;
+    }
+    HAPLog(&logObject,
+           "%s: %llu ns CPU/op.",
+           "Start (cold)",
+           (unsigned long long) ((uint64_t) startTime * 1000000000 / CLOCKS_PER_SEC / kNumIterations));
+
+    // Warm start: validation of the unchanged accessory definitions is skipped.
+    startTime = 0;
+    for (size_t i = 0; i < kNumIterations; i++) {
+        clock_t time = clock();
+        HAPAccessoryServerStartBridge(
+                &accessoryServer, &bridgeAccessory, bridgedAccessoryList, /* configurationChanged: */ false);
+        HAPPlatformClockAdvance(0);
+        startTime += clock() - time;
+        HAPAssert(!isIdle);
+
+        time = clock();
+        HAPAccessoryServerStop(&accessoryServer);
+        while (!isIdle) {
+            HAPPlatformClockAdvance(0);
+        }
+        stopTime += clock() - time;
+    }
+    HAPLog(&logObject,
+           "%s: %llu ns CPU/op.",
+           "Start (warm)",
+           (unsigned long long) ((uint64_t) startTime * 1000000000 / CLOCKS_PER_SEC / kNumIterations));
+    HAPLog(&logObject,
+           "%s: %llu ns CPU/op.",
+           "Stop",
+           (unsigned long long) ((uint64_t) stopTime * 1000000000 / CLOCKS_PER_SEC / (2 * kNumIterations)));
+
+    HAPAccessoryServerRelease(&accessoryServer);
+    return 0;
+}
@@ -0,0 +1,317 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+// Measures HAP-BLE procedure throughput of a TemplateDB accessory with the simulated central: transactions per second,
+// CPU time per transaction and event indication latency, at the default and at a large ATT MTU.
+//
+// - CPU time covers both the accessory server and the simulated central, including encryption on both sides.
+// - ATT round trips are reported separately because they dominate the latency over the air.
+
+#include <time.h>
+
+#include "HAP+Internal.h"
+#include "HAPPlatform+Init.h"
+
+#include "../Harness/HAPBLECentral.c"
+#include "../Harness/TemplateDB.c"
+
+#define kIID_LightBulb   ((uint64_t) 0x0030)
+#define kIID_LightBulbOn ((uint64_t) 0x0031)
+
+/**
+ * Number of iterations per measurement.
+ */
+#define kNumIterations ((size_t) 2000)
+
+static const HAPLogObject logObject = { .subsystem = kHAP_LogSubsystem, .category = "BLEThroughputBenchmark" };
+
+static bool lightBulbOn;
+
+static void HandleUpdatedAccessoryServerState(HAPAccessoryServerRef* server, void* _Nullable context HAP_UNUSED) {
+    HAPPrecondition(server);
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError IdentifyAccessory(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPAccessoryIdentifyRequest* request HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleLightBulbOnRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPBoolCharacteristicReadRequest* request HAP_UNUSED,
+        bool* value,
+        void* _Nullable context HAP_UNUSED) {
+    *value = lightBulbOn;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleLightBulbOnWrite(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPBoolCharacteristicWriteRequest* request HAP_UNUSED,
+        bool value,
+        void* _Nullable context HAP_UNUSED) {
+    lightBulbOn = value;
+    return kHAPError_None;
+}
+
+static const HAPBoolCharacteristic lightBulbOnCharacteristic = {
+    .format = kHAPCharacteristicFormat_Bool,
+    .iid = kIID_LightBulbOn,
+    .characteristicType = &kHAPCharacteristicType_On,
+    .debugDescription = kHAPCharacteristicDebugDescription_On,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = true,
+                    .supportsEventNotification = true,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false, .supportsWriteResponse = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .callbacks = { .handleRead = HandleLightBulbOnRead, .handleWrite = HandleLightBulbOnWrite }
+};
+
+static const HAPService lightBulbService = {
+    .iid = kIID_LightBulb,
+    .serviceType = &kHAPServiceType_LightBulb,
+    .debugDescription = kHAPServiceDebugDescription_LightBulb,
+    .name = NULL,
+    .properties = { .primaryService = true, .hidden = false, .ble = { .supportsConfiguration = false } },
+    .linkedServices = NULL,
+    .characteristics = (const HAPCharacteristic* const[]) { &lightBulbOnCharacteristic, NULL }
+};
+
+static const HAPAccessory accessory = { .aid = 1,
+                                        .category = kHAPAccessoryCategory_Lighting,
+                                        .name = "Acme Test",
+                                        .manufacturer = "Acme",
+                                        .model = "Test1,1",
+                                        .serialNumber = "099DB48E9E28",
+                                        .firmwareVersion = "1",
+                                        .hardwareVersion = "1",
+                                        .services = (const HAPService* const[]) { &accessoryInformationService,
+                                                                                  &hapProtocolInformationService,
+                                                                                  &pairingService,
+                                                                                  &lightBulbService,
+                                                                                  NULL },
+                                        .callbacks = { .identify = IdentifyAccessory } };
+
+/**
+ * Measurement in progress.
+ */
+typedef struct {
+    clock_t startTime;
+    HAPBLECentralStatistics startStatistics;
+} Measurement;
+
+static void BeginMeasurement(const HAPBLECentral* central, Measurement* measurement) {
+    HAPPrecondition(central);
+    HAPPrecondition(measurement);
+
+    HAPBLECentralGetStatistics(central, &measurement->startStatistics);
+    measurement->startTime = clock();
+}
+
+static void EndMeasurement(
+        const HAPBLECentral* central,
+        const Measurement* measurement,
+        const char* name,
+        uint16_t mtu,
+        size_t numOperations) {
+    HAPPrecondition(central);
+    HAPPrecondition(measurement);
+    HAPPrecondition(name);
+    HAPPrecondition(numOperations);
+
+    uint64_t cpuNanoseconds = (uint64_t)(clock() - measurement->startTime) * 1000000000 / CLOCKS_PER_SEC;
+    HAPBLECentralStatistics statistics;
+    HAPBLECentralGetStatistics(central, &statistics);
+    size_t numRoundTrips = statistics.numRoundTrips - measurement->startStatistics.numRoundTrips;
+    size_t numGATTValues = statistics.numGATTWrites - measurement->startStatistics.numGATTWrites +
+                           statistics.numGATTReads - measurement->startStatistics.numGATTReads;
+
+    // The log formatter does not support fixed-point types, so fractions are printed as hundredths.
+    HAPLog(&logObject,
+           "ATT MTU %3u: %8llu ops/s, %9llu ns CPU/op, %3zu.%02zu ATT round trips/op, %3zu.%02zu GATT values/op (%s).",
+           mtu,
+           (unsigned long long) (cpuNanoseconds ? numOperations * 1000000000 / cpuNanoseconds : 0),
+           (unsigned long long) (cpuNanoseconds / numOperations),
+           numRoundTrips / numOperations,
+           numRoundTrips * 100 / numOperations % 100,
+           numGATTValues / numOperations,
+           numGATTValues * 100 / numOperations % 100,
+           name);
+}
+
+int main() {
+    HAPError err;
+    HAPPlatformCreate();
+
+    // Provision accessory server and a paired controller.
+    static const HAPAccessoryServerDeviceID deviceID = { { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 } };
+    err = HAPLegacyImportDeviceID(platform.keyValueStore, &deviceID);
+    HAPAssert(!err);
+    HAPAccessoryServerLongTermSecretKey accessoryLTSK;
+    HAPPlatformRandomNumberFill(accessoryLTSK.bytes, sizeof accessoryLTSK.bytes);
+    err = HAPLegacyImportLongTermSecretKey(platform.keyValueStore, &accessoryLTSK);
+    HAPAssert(!err);
+    uint8_t accessoryLTPK[ED25519_PUBLIC_KEY_BYTES];
+    HAP_ed25519_public_key(accessoryLTPK, accessoryLTSK.bytes);
+
+    static const HAPControllerPairingIdentifier pairingIdentifier = {
+        .bytes = "4E5D4B2F-6A3B-4C1D-9E8F-0A1B2C3D4E5F", .numBytes = 36
+    };
+    uint8_t controllerLTSK[ED25519_SECRET_KEY_BYTES];
+    HAPPlatformRandomNumberFill(controllerLTSK, sizeof controllerLTSK);
+    HAPControllerPublicKey controllerLTPK;
+    HAP_ed25519_public_key(controllerLTPK.bytes, controllerLTSK);
+    err = HAPLegacyImportControllerPairing(
+            platform.keyValueStore, 0, &pairingIdentifier, &controllerLTPK, /* isAdmin: */ true);
+    HAPAssert(!err);
+
+    // Prepare accessory server storage.
+    static HAPBLEGATTTableElementRef gattTableElements[kAttributeCount + 2];
+    static HAPBLESessionCacheElementRef sessionCacheElements[kHAPBLESessionCache_MinElements];
+    static HAPSessionRef session;
+    static uint8_t procedureBytes[2048];
+    static HAPBLEProcedureRef procedures[1];
+    static HAPBLEAccessoryServerStorage bleAccessoryServerStorage = {
+        .gattTableElements = gattTableElements,
+        .numGATTTableElements = HAPArrayCount(gattTableElements),
+        .sessionCacheElements = sessionCacheElements,
+        .numSessionCacheElements = HAPArrayCount(sessionCacheElements),
+        .session = &session,
+        .procedures = procedures,
+        .numProcedures = HAPArrayCount(procedures),
+        .procedureBuffer = { .bytes = procedureBytes, .numBytes = sizeof procedureBytes },
+    };
+
+    // Initialize and start accessory server.
+    static HAPAccessoryServerRef accessoryServer;
+    HAPAccessoryServerCreate(
+            &accessoryServer,
+            &(const HAPAccessoryServerOptions) {
+                    .maxPairings = kHAPPairingStorage_MinElements,
+                    .ble = { .transport = &kHAPAccessoryServerTransport_BLE,
+                             .accessoryServerStorage = &bleAccessoryServerStorage,
+                             .preferredAdvertisingInterval = kHAPBLEAdvertisingInterval_Minimum,
+                             .preferredNotificationDuration = kHAPBLENotification_MinDuration } },
+            &platform,
+            &(const HAPAccessoryServerCallbacks) { .handleUpdatedState = HandleUpdatedAccessoryServerState },
+            /* context: */ NULL);
+    HAPAccessoryServerStart(&accessoryServer, &accessory);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Running);
+
+    static const uint16_t mtus[] = { kHAPPlatformBLEPeripheralManager_DefaultMTU, 247 };
+    for (size_t i = 0; i < HAPArrayCount(mtus); i++) {
+        HAPBLECentral central;
+        HAPBLECentralCreate(
+                &central,
+                &(const HAPBLECentralOptions) { .blePeripheralManager = HAPNonnull(platform.ble.blePeripheralManager),
+                                                .pairingIdentifier = &pairingIdentifier,
+                                                .longTermSecretKey = controllerLTSK,
+                                                .accessoryLongTermPublicKey = accessoryLTPK });
+        err = HAPBLECentralConnect(&central, mtus[i]);
+        HAPAssert(!err);
+
+        HAPBLECentralCharacteristic on;
+        err = HAPBLECentralDiscoverCharacteristic(
+                &central, &kHAPServiceType_LightBulb, &kHAPCharacteristicType_On, &on);
+        HAPAssert(!err);
+        HAPBLECentralCharacteristic name;
+        err = HAPBLECentralDiscoverCharacteristic(
+                &central, &kHAPServiceType_AccessoryInformation, &kHAPCharacteristicType_Name, &name);
+        HAPAssert(!err);
+
+        Measurement measurement;
+        BeginMeasurement(&central, &measurement);
+        err = HAPBLECentralPairVerify(&central);
+        HAPAssert(!err);
+        EndMeasurement(&central, &measurement, "Pair Verify", mtus[i], 1);
+
+        // Characteristic reads.
+        BeginMeasurement(&central, &measurement);
+        for (size_t j = 0; j < kNumIterations; j++) {
+            uint8_t value;
+            size_t numValueBytes;
+            err = HAPBLECentralReadCharacteristic(&central, &on, &value, sizeof value, &numValueBytes);
+            HAPAssert(!err);
+        }
+        EndMeasurement(&central, &measurement, "Read bool", mtus[i], kNumIterations);
+
+        BeginMeasurement(&central, &measurement);
+        for (size_t j = 0; j < kNumIterations; j++) {
+            char value[64];
+            size_t numValueBytes;
+            err = HAPBLECentralReadCharacteristic(&central, &name, value, sizeof value, &numValueBytes);
+            HAPAssert(!err);
+        }
+        EndMeasurement(&central, &measurement, "Read string", mtus[i], kNumIterations);
+
+        // Characteristic writes.
+        BeginMeasurement(&central, &measurement);
+        for (size_t j = 0; j < kNumIterations; j++) {
+            uint8_t value = (uint8_t)(j & 1);
+            err = HAPBLECentralWriteCharacteristic(&central, &on, &value, sizeof value);
+            HAPAssert(!err);
+        }
+        EndMeasurement(&central, &measurement, "Write bool", mtus[i], kNumIterations);
+
+        // Signature reads. Multiple fragments at the default ATT MTU.
+        BeginMeasurement(&central, &measurement);
+        for (size_t j = 0; j < kNumIterations; j++) {
+            static uint8_t bodyBytes[UINT16_MAX];
+            HAPBLEPDUStatus status;
+            size_t numBodyBytes;
+            err = HAPBLECentralPerformTransaction(
+                    &central,
+                    &on,
+                    kHAPPDUOpcode_CharacteristicSignatureRead,
+                    /* requestBodyBytes: */ NULL,
+                    /* numRequestBodyBytes: */ 0,
+                    &status,
+                    bodyBytes,
+                    sizeof bodyBytes,
+                    &numBodyBytes);
+            HAPAssert(!err);
+            HAPAssert(status == kHAPBLEPDUStatus_Success);
+        }
+        EndMeasurement(&central, &measurement, "Signature", mtus[i], kNumIterations);
+
+        // Event indication latency: raise the event, confirm the indication and read the updated value.
+        err = HAPBLECentralSetIndicationsEnabled(&central, &on, true);
+        HAPAssert(!err);
+        BeginMeasurement(&central, &measurement);
+        for (size_t j = 0; j < kNumIterations; j++) {
+            lightBulbOn = !lightBulbOn;
+            HAPAccessoryServerRaiseEvent(&accessoryServer, &lightBulbOnCharacteristic, &lightBulbService, &accessory);
+            HAPPlatformBLEPeripheralManagerAttributeHandle valueHandle;
+            err = HAPBLECentralReceiveIndication(&central, &valueHandle);
+            HAPAssert(!err);
+            HAPAssert(valueHandle == on.valueHandle);
+            uint8_t value;
+            size_t numValueBytes;
+            err = HAPBLECentralReadCharacteristic(&central, &on, &value, sizeof value, &numValueBytes);
+            HAPAssert(!err);
+            HAPAssert(value == lightBulbOn);
+        }
+        EndMeasurement(&central, &measurement, "Event", mtus[i], kNumIterations);
+
+        HAPBLECentralDisconnect(&central);
+        HAPPlatformClockAdvance(0);
+    }
+
+    return 0;
+}
@@ -0,0 +1,703 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+// Generated by AccessoryDatabaseGenerator from HAPAccessoryDatabaseGeneratorTest+Database.json. Do not edit.
+//
+// Include in one translation unit after the callbacks referenced by the database have been declared.
+
+/** Total number of services and characteristics of all accessories. */
+#define kGeneratedDB_AttributeCount ((size_t) 46)
+
+/** Number of IP read contexts, write contexts and characteristic index elements. */
+#define kGeneratedDB_NumIPCharacteristicIndexElements ((size_t) 32)
+
+/** Number of event notification elements per IP session. */
+#define kGeneratedDB_NumIPEventNotifications ((size_t) 4)
+
+/** Number of IP characteristic value cache elements. */
+#define kGeneratedDB_NumIPValueCacheElements ((size_t) 1)
+
+/** Number of BLE GATT table elements. */
+#define kGeneratedDB_NumBLEGATTTableElements ((size_t) 17)
+
+const HAPBoolCharacteristic accessoryInformationIdentifyCharacteristic = {
+    .format = kHAPCharacteristicFormat_Bool,
+    .iid = 0x0002,
+    .characteristicType = &kHAPCharacteristicType_Identify,
+    .debugDescription = kHAPCharacteristicDebugDescription_Identify,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = false,
+                    .writable = true,
+                    .supportsEventNotification = false,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false,
+                            .supportsWriteResponse = false,
+                            .suppressUnchangedEventNotifications = false,
+                            .cacheable = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .callbacks = { .handleRead = NULL, .handleWrite = HAPHandleAccessoryInformationIdentifyWrite }
+};
+
+const HAPStringCharacteristic accessoryInformationManufacturerCharacteristic = {
+    .format = kHAPCharacteristicFormat_String,
+    .iid = 0x0003,
+    .characteristicType = &kHAPCharacteristicType_Manufacturer,
+    .debugDescription = kHAPCharacteristicDebugDescription_Manufacturer,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = false,
+                    .supportsEventNotification = false,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false,
+                            .supportsWriteResponse = false,
+                            .suppressUnchangedEventNotifications = false,
+                            .cacheable = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .constraints = { .maxLength = 64 },
+    .callbacks = { .handleRead = HAPHandleAccessoryInformationManufacturerRead, .handleWrite = NULL }
+};
+
+const HAPStringCharacteristic accessoryInformationModelCharacteristic = {
+    .format = kHAPCharacteristicFormat_String,
+    .iid = 0x0004,
+    .characteristicType = &kHAPCharacteristicType_Model,
+    .debugDescription = kHAPCharacteristicDebugDescription_Model,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = false,
+                    .supportsEventNotification = false,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false,
+                            .supportsWriteResponse = false,
+                            .suppressUnchangedEventNotifications = false,
+                            .cacheable = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .constraints = { .maxLength = 64 },
+    .callbacks = { .handleRead = HAPHandleAccessoryInformationModelRead, .handleWrite = NULL }
+};
+
+const HAPStringCharacteristic accessoryInformationNameCharacteristic = {
+    .format = kHAPCharacteristicFormat_String,
+    .iid = 0x0005,
+    .characteristicType = &kHAPCharacteristicType_Name,
+    .debugDescription = kHAPCharacteristicDebugDescription_Name,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = false,
+                    .supportsEventNotification = false,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false,
+                            .supportsWriteResponse = false,
+                            .suppressUnchangedEventNotifications = false,
+                            .cacheable = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .constraints = { .maxLength = 64 },
+    .callbacks = { .handleRead = HAPHandleAccessoryInformationNameRead, .handleWrite = NULL }
+};
+
+const HAPStringCharacteristic accessoryInformationSerialNumberCharacteristic = {
+    .format = kHAPCharacteristicFormat_String,
+    .iid = 0x0006,
+    .characteristicType = &kHAPCharacteristicType_SerialNumber,
+    .debugDescription = kHAPCharacteristicDebugDescription_SerialNumber,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = false,
+                    .supportsEventNotification = false,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false,
+                            .supportsWriteResponse = false,
+                            .suppressUnchangedEventNotifications = false,
+                            .cacheable = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .constraints = { .maxLength = 64 },
+    .callbacks = { .handleRead = HAPHandleAccessoryInformationSerialNumberRead, .handleWrite = NULL }
+};
+
+const HAPStringCharacteristic accessoryInformationFirmwareRevisionCharacteristic = {
+    .format = kHAPCharacteristicFormat_String,
+    .iid = 0x0007,
+    .characteristicType = &kHAPCharacteristicType_FirmwareRevision,
+    .debugDescription = kHAPCharacteristicDebugDescription_FirmwareRevision,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = false,
+                    .supportsEventNotification = false,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false,
+                            .supportsWriteResponse = false,
+                            .suppressUnchangedEventNotifications = false,
+                            .cacheable = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .constraints = { .maxLength = 64 },
+    .callbacks = { .handleRead = HAPHandleAccessoryInformationFirmwareRevisionRead, .handleWrite = NULL }
+};
+
+const HAPStringCharacteristic accessoryInformationHardwareRevisionCharacteristic = {
+    .format = kHAPCharacteristicFormat_String,
+    .iid = 0x0008,
+    .characteristicType = &kHAPCharacteristicType_HardwareRevision,
+    .debugDescription = kHAPCharacteristicDebugDescription_HardwareRevision,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = false,
+                    .supportsEventNotification = false,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false,
+                            .supportsWriteResponse = false,
+                            .suppressUnchangedEventNotifications = false,
+                            .cacheable = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .constraints = { .maxLength = 64 },
+    .callbacks = { .handleRead = HAPHandleAccessoryInformationHardwareRevisionRead, .handleWrite = NULL }
+};
+
+const HAPStringCharacteristic accessoryInformationADKVersionCharacteristic = {
+    .format = kHAPCharacteristicFormat_String,
+    .iid = 0x0009,
+    .characteristicType = &kHAPCharacteristicType_ADKVersion,
+    .debugDescription = kHAPCharacteristicDebugDescription_ADKVersion,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = false,
+                    .supportsEventNotification = false,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false,
+                            .supportsWriteResponse = false,
+                            .suppressUnchangedEventNotifications = false,
+                            .cacheable = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .constraints = { .maxLength = 64 },
+    .callbacks = { .handleRead = HAPHandleAccessoryInformationADKVersionRead, .handleWrite = NULL }
+};
+
+const HAPDataCharacteristic hapProtocolInformationServiceSignatureCharacteristic = {
+    .format = kHAPCharacteristicFormat_Data,
+    .iid = 0x0011,
+    .characteristicType = &kHAPCharacteristicType_ServiceSignature,
+    .debugDescription = kHAPCharacteristicDebugDescription_ServiceSignature,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = false,
+                    .supportsEventNotification = false,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = true,
+                            .supportsWriteResponse = false,
+                            .suppressUnchangedEventNotifications = false,
+                            .cacheable = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .constraints = { .maxLength = 2097152 },
+    .callbacks = { .handleRead = HAPHandleServiceSignatureRead, .handleWrite = NULL }
+};
+
+const HAPStringCharacteristic hapProtocolInformationVersionCharacteristic = {
+    .format = kHAPCharacteristicFormat_String,
+    .iid = 0x0012,
+    .characteristicType = &kHAPCharacteristicType_Version,
+    .debugDescription = kHAPCharacteristicDebugDescription_Version,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = false,
+                    .supportsEventNotification = false,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false,
+                            .supportsWriteResponse = false,
+                            .suppressUnchangedEventNotifications = false,
+                            .cacheable = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .constraints = { .maxLength = 64 },
+    .callbacks = { .handleRead = HAPHandleHAPProtocolInformationVersionRead, .handleWrite = NULL }
+};
+
+const HAPTLV8Characteristic pairingPairSetupCharacteristic = {
+    .format = kHAPCharacteristicFormat_TLV8,
+    .iid = 0x0022,
+    .characteristicType = &kHAPCharacteristicType_PairSetup,
+    .debugDescription = kHAPCharacteristicDebugDescription_PairSetup,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = false,
+                    .writable = false,
+                    .supportsEventNotification = false,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = true,
+                            .supportsWriteResponse = false,
+                            .suppressUnchangedEventNotifications = false,
+                            .cacheable = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = true,
+                             .writableWithoutSecurity = true } },
+    .callbacks = { .handleRead = HAPHandlePairingPairSetupRead, .handleWrite = HAPHandlePairingPairSetupWrite }
+};
+
+const HAPTLV8Characteristic pairingPairVerifyCharacteristic = {
+    .format = kHAPCharacteristicFormat_TLV8,
+    .iid = 0x0023,
+    .characteristicType = &kHAPCharacteristicType_PairVerify,
+    .debugDescription = kHAPCharacteristicDebugDescription_PairVerify,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = false,
+                    .writable = false,
+                    .supportsEventNotification = false,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = true,
+                            .supportsWriteResponse = false,
+                            .suppressUnchangedEventNotifications = false,
+                            .cacheable = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = true,
+                             .writableWithoutSecurity = true } },
+    .callbacks = { .handleRead = HAPHandlePairingPairVerifyRead, .handleWrite = HAPHandlePairingPairVerifyWrite }
+};
+
+const HAPUInt8Characteristic pairingPairingFeaturesCharacteristic = {
+    .format = kHAPCharacteristicFormat_UInt8,
+    .iid = 0x0024,
+    .characteristicType = &kHAPCharacteristicType_PairingFeatures,
+    .debugDescription = kHAPCharacteristicDebugDescription_PairingFeatures,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = false,
+                    .writable = false,
+                    .supportsEventNotification = false,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false,
+                            .supportsWriteResponse = false,
+                            .suppressUnchangedEventNotifications = false,
+                            .cacheable = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = true,
+                             .writableWithoutSecurity = false } },
+    .units = kHAPCharacteristicUnits_None,
+    .constraints = { .minimumValue = 0,
+                     .maximumValue = UINT8_MAX,
+                     .stepValue = 0,
+                     .validValues = NULL,
+                     .validValuesRanges = NULL },
+    .callbacks = { .handleRead = HAPHandlePairingPairingFeaturesRead, .handleWrite = NULL }
+};
+
+const HAPTLV8Characteristic pairingPairingPairingsCharacteristic = {
+    .format = kHAPCharacteristicFormat_TLV8,
+    .iid = 0x0025,
+    .characteristicType = &kHAPCharacteristicType_PairingPairings,
+    .debugDescription = kHAPCharacteristicDebugDescription_PairingPairings,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = true,
+                    .supportsEventNotification = false,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = true,
+                            .supportsWriteResponse = false,
+                            .suppressUnchangedEventNotifications = false,
+                            .cacheable = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .callbacks = { .handleRead = HAPHandlePairingPairingPairingsRead,
+                   .handleWrite = HAPHandlePairingPairingPairingsWrite }
+};
+
+const HAPUInt8Characteristic batteryLevelCharacteristic = {
+    .format = kHAPCharacteristicFormat_UInt8,
+    .iid = 0x0051,
+    .characteristicType = &kHAPCharacteristicType_BatteryLevel,
+    .debugDescription = kHAPCharacteristicDebugDescription_BatteryLevel,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = false,
+                    .supportsEventNotification = true,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false,
+                            .supportsWriteResponse = false,
+                            .suppressUnchangedEventNotifications = false,
+                            .cacheable = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .units = kHAPCharacteristicUnits_Percentage,
+    .constraints = { .minimumValue = 0,
+                     .maximumValue = 100,
+                     .stepValue = 1,
+                     .validValues = NULL,
+                     .validValuesRanges = NULL },
+    .callbacks = { .handleRead = HandleBatteryRead, .handleWrite = NULL }
+};
+
+const HAPUInt8Characteristic batteryChargingStateCharacteristic = {
+    .format = kHAPCharacteristicFormat_UInt8,
+    .iid = 0x0052,
+    .characteristicType = &kHAPCharacteristicType_ChargingState,
+    .debugDescription = kHAPCharacteristicDebugDescription_ChargingState,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = false,
+                    .supportsEventNotification = true,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false,
+                            .supportsWriteResponse = false,
+                            .suppressUnchangedEventNotifications = false,
+                            .cacheable = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .units = kHAPCharacteristicUnits_None,
+    .constraints = { .minimumValue = 0,
+                     .maximumValue = 2,
+                     .stepValue = 1,
+                     .validValues = NULL,
+                     .validValuesRanges = NULL },
+    .callbacks = { .handleRead = HandleBatteryRead, .handleWrite = NULL }
+};
+
+const HAPUInt8Characteristic batteryStatusLowBatteryCharacteristic = {
+    .format = kHAPCharacteristicFormat_UInt8,
+    .iid = 0x0053,
+    .characteristicType = &kHAPCharacteristicType_StatusLowBattery,
+    .debugDescription = kHAPCharacteristicDebugDescription_StatusLowBattery,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = false,
+                    .supportsEventNotification = true,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false,
+                            .supportsWriteResponse = false,
+                            .suppressUnchangedEventNotifications = false,
+                            .cacheable = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .units = kHAPCharacteristicUnits_None,
+    .constraints = { .minimumValue = 0,
+                     .maximumValue = 1,
+                     .stepValue = 1,
+                     .validValues = NULL,
+                     .validValuesRanges = NULL },
+    .callbacks = { .handleRead = HandleBatteryRead, .handleWrite = NULL }
+};
+
+const HAPFloatCharacteristic temperatureSensorCurrentTemperatureCharacteristic = {
+    .format = kHAPCharacteristicFormat_Float,
+    .iid = 0x0042,
+    .characteristicType = &kHAPCharacteristicType_CurrentTemperature,
+    .debugDescription = kHAPCharacteristicDebugDescription_CurrentTemperature,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = false,
+                    .supportsEventNotification = true,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false,
+                            .supportsWriteResponse = false,
+                            .suppressUnchangedEventNotifications = true,
+                            .cacheable = true },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .units = kHAPCharacteristicUnits_Celsius,
+    .constraints = { .minimumValue = -270.0F,
+                     .maximumValue = 100.0F,
+                     .stepValue = 0.1F },
+    .callbacks = { .handleRead = HandleCurrentTemperatureRead, .handleWrite = NULL }
+};
+
+const HAPStringCharacteristic temperatureSensorNameCharacteristic = {
+    .format = kHAPCharacteristicFormat_String,
+    .iid = 0x0041,
+    .characteristicType = &kHAPCharacteristicType_Name,
+    .debugDescription = kHAPCharacteristicDebugDescription_Name,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = false,
+                    .supportsEventNotification = false,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false,
+                            .supportsWriteResponse = false,
+                            .suppressUnchangedEventNotifications = false,
+                            .cacheable = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .constraints = { .maxLength = 64 },
+    .callbacks = { .handleRead = HAPHandleNameRead, .handleWrite = NULL }
+};
+
+const HAPDataCharacteristic lightBulbServiceSignatureCharacteristic = {
+    .format = kHAPCharacteristicFormat_Data,
+    .iid = 0x0031,
+    .characteristicType = &kHAPCharacteristicType_ServiceSignature,
+    .debugDescription = kHAPCharacteristicDebugDescription_ServiceSignature,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = false,
+                    .supportsEventNotification = false,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = true,
+                            .supportsWriteResponse = false,
+                            .suppressUnchangedEventNotifications = false,
+                            .cacheable = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .constraints = { .maxLength = 2097152 },
+    .callbacks = { .handleRead = HAPHandleServiceSignatureRead, .handleWrite = NULL }
+};
+
+const HAPBoolCharacteristic lightBulbOnCharacteristic = {
+    .format = kHAPCharacteristicFormat_Bool,
+    .iid = 0x0033,
+    .characteristicType = &kHAPCharacteristicType_On,
+    .debugDescription = kHAPCharacteristicDebugDescription_On,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = true,
+                    .supportsEventNotification = true,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false,
+                            .supportsWriteResponse = false,
+                            .suppressUnchangedEventNotifications = false,
+                            .cacheable = false },
+                    .ble = { .supportsBroadcastNotification = true,
+                             .supportsDisconnectedNotification = true,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .callbacks = { .handleRead = HandleLightBulbOnRead, .handleWrite = HandleLightBulbOnWrite }
+};
+
+const HAPIntCharacteristic lightBulbBrightnessCharacteristic = {
+    .format = kHAPCharacteristicFormat_Int,
+    .iid = 0x0034,
+    .characteristicType = &kHAPCharacteristicType_Brightness,
+    .debugDescription = kHAPCharacteristicDebugDescription_Brightness,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = true,
+                    .supportsEventNotification = true,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false,
+                            .supportsWriteResponse = false,
+                            .suppressUnchangedEventNotifications = false,
+                            .cacheable = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .units = kHAPCharacteristicUnits_Percentage,
+    .constraints = { .minimumValue = 0,
+                     .maximumValue = 100,
+                     .stepValue = 1 },
+    .callbacks = { .handleRead = HandleLightBulbBrightnessRead, .handleWrite = HandleLightBulbBrightnessWrite }
+};
+
+const HAPService accessoryInformationService = {
+    .iid = 0x0001,
+    .serviceType = &kHAPServiceType_AccessoryInformation,
+    .debugDescription = kHAPServiceDebugDescription_AccessoryInformation,
+    .name = NULL,
+    .properties = { .primaryService = false, .hidden = false, .ble = { .supportsConfiguration = false } },
+    .linkedServices = NULL,
+    .characteristics = (const HAPCharacteristic* const[]) { &accessoryInformationIdentifyCharacteristic,
+                                                            &accessoryInformationManufacturerCharacteristic,
+                                                            &accessoryInformationModelCharacteristic,
+                                                            &accessoryInformationNameCharacteristic,
+                                                            &accessoryInformationSerialNumberCharacteristic,
+                                                            &accessoryInformationFirmwareRevisionCharacteristic,
+                                                            &accessoryInformationHardwareRevisionCharacteristic,
+                                                            &accessoryInformationADKVersionCharacteristic,
+                                                            NULL }
+};
+
+const HAPService hapProtocolInformationService = {
+    .iid = 0x0010,
+    .serviceType = &kHAPServiceType_HAPProtocolInformation,
+    .debugDescription = kHAPServiceDebugDescription_HAPProtocolInformation,
+    .name = NULL,
+    .properties = { .primaryService = false, .hidden = false, .ble = { .supportsConfiguration = true } },
+    .linkedServices = NULL,
+    .characteristics = (const HAPCharacteristic* const[]) { &hapProtocolInformationServiceSignatureCharacteristic,
+                                                            &hapProtocolInformationVersionCharacteristic,
+                                                            NULL }
+};
+
+const HAPService pairingService = {
+    .iid = 0x0020,
+    .serviceType = &kHAPServiceType_Pairing,
+    .debugDescription = kHAPServiceDebugDescription_Pairing,
+    .name = NULL,
+    .properties = { .primaryService = false, .hidden = false, .ble = { .supportsConfiguration = false } },
+    .linkedServices = NULL,
+    .characteristics = (const HAPCharacteristic* const[]) { &pairingPairSetupCharacteristic,
+                                                            &pairingPairVerifyCharacteristic,
+                                                            &pairingPairingFeaturesCharacteristic,
+                                                            &pairingPairingPairingsCharacteristic,
+                                                            NULL }
+};
+
+const HAPService batteryService = {
+    .iid = 0x0050,
+    .serviceType = &kHAPServiceType_BatteryService,
+    .debugDescription = kHAPServiceDebugDescription_BatteryService,
+    .name = "Battery",
+    .properties = { .primaryService = false, .hidden = false, .ble = { .supportsConfiguration = false } },
+    .linkedServices = NULL,
+    .characteristics = (const HAPCharacteristic* const[]) { &batteryLevelCharacteristic,
+                                                            &batteryChargingStateCharacteristic,
+                                                            &batteryStatusLowBatteryCharacteristic,
+                                                            NULL }
+};
+
+const HAPService temperatureSensorService = {
+    .iid = 0x0040,
+    .serviceType = &kHAPServiceType_TemperatureSensor,
+    .debugDescription = kHAPServiceDebugDescription_TemperatureSensor,
+    .name = NULL,
+    .properties = { .primaryService = true, .hidden = false, .ble = { .supportsConfiguration = false } },
+    .linkedServices = (const uint16_t[]) { 0x0050, 0 },
+    .characteristics = (const HAPCharacteristic* const[]) { &temperatureSensorNameCharacteristic,
+                                                            &temperatureSensorCurrentTemperatureCharacteristic,
+                                                            NULL }
+};
+
+const HAPService lightBulbService = {
+    .iid = 0x0030,
+    .serviceType = &kHAPServiceType_LightBulb,
+    .debugDescription = kHAPServiceDebugDescription_LightBulb,
+    .name = "Light Bulb",
+    .properties = { .primaryService = true, .hidden = false, .ble = { .supportsConfiguration = false } },
+    .linkedServices = NULL,
+    .characteristics = (const HAPCharacteristic* const[]) { &lightBulbServiceSignatureCharacteristic,
+                                                            &lightBulbOnCharacteristic,
+                                                            &lightBulbBrightnessCharacteristic,
+                                                            NULL }
+};
+
+const HAPAccessory bridgeAccessory = {
+    .aid = 1,
+    .category = kHAPAccessoryCategory_Bridges,
+    .name = "Acme Bridge",
+    .manufacturer = "Acme",
+    .model = "Bridge1,1",
+    .serialNumber = "099DB48E9E28",
+    .firmwareVersion = "1",
+    .hardwareVersion = "1",
+    .services = (const HAPService* const[]) { &accessoryInformationService,
+                                              &hapProtocolInformationService,
+                                              &pairingService,
+                                              NULL },
+    .callbacks = { .identify = IdentifyAccessory }
+};
+
+const HAPAccessory lightBulbAccessory = {
+    .aid = 2,
+    .category = kHAPAccessoryCategory_BridgedAccessory,
+    .name = "Acme Light Bulb",
+    .manufacturer = "Acme",
+    .model = "LightBulb1,1",
+    .serialNumber = "099DB48E9E29",
+    .firmwareVersion = "1",
+    .hardwareVersion = NULL,
+    .services = (const HAPService* const[]) { &accessoryInformationService, &lightBulbService, NULL },
+    .callbacks = { .identify = IdentifyAccessory }
+};
+
+const HAPAccessory temperatureSensorAccessory = {
+    .aid = 3,
+    .category = kHAPAccessoryCategory_BridgedAccessory,
+    .name = "Acme Temperature Sensor",
+    .manufacturer = "Acme",
+    .model = "TemperatureSensor1,1",
+    .serialNumber = "099DB48E9E2A",
+    .firmwareVersion = "1",
+    .hardwareVersion = NULL,
+    .services = (const HAPService* const[]) { &accessoryInformationService,
+                                              &temperatureSensorService,
+                                              &batteryService,
+                                              NULL },
+    .callbacks = { .identify = IdentifyAccessory }
+};
+
+const HAPAccessory* _Nullable const bridgedAccessories[] = { &lightBulbAccessory, &temperatureSensorAccessory, NULL };
@@ -0,0 +1,158 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+// Checks that the accessory database generated by AccessoryDatabaseGenerator from
+// HAPAccessoryDatabaseGeneratorTest+Database.json is accepted by the accessory server
+// when its storage is sized with the generated constants.
+
+#include "HAP+Internal.h"
+#include "HAPPlatform+Init.h"
+
+static bool isIdle;
+
+static void HandleUpdatedAccessoryServerState(HAPAccessoryServerRef* server, void* _Nullable context HAP_UNUSED) {
+    HAPPrecondition(server);
+
+    isIdle = HAPAccessoryServerGetState(server) == kHAPAccessoryServerState_Idle;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError IdentifyAccessory(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPAccessoryIdentifyRequest* request HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    HAPFatalError();
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleLightBulbOnRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPBoolCharacteristicReadRequest* request HAP_UNUSED,
+        bool* value HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    HAPFatalError();
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleLightBulbOnWrite(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPBoolCharacteristicWriteRequest* request HAP_UNUSED,
+        bool value HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    HAPFatalError();
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleLightBulbBrightnessRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPIntCharacteristicReadRequest* request HAP_UNUSED,
+        int32_t* value HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    HAPFatalError();
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleLightBulbBrightnessWrite(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPIntCharacteristicWriteRequest* request HAP_UNUSED,
+        int32_t value HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    HAPFatalError();
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleCurrentTemperatureRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPFloatCharacteristicReadRequest* request HAP_UNUSED,
+        float* value HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    HAPFatalError();
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleBatteryRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPUInt8CharacteristicReadRequest* request HAP_UNUSED,
+        uint8_t* value HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    HAPFatalError();
+}
+
+#include "HAPAccessoryDatabaseGeneratorTest+Generated.h"
+
+int main() {
+    HAPPlatformCreate();
+
+    // The generated constants agree with the storage requirements computed at runtime.
+    HAPAccessoryServerStorageUsage requirements;
+    HAPAccessoryServerGetStorageRequirements(&bridgeAccessory, bridgedAccessories, &requirements);
+    HAPAssert(requirements.ip.numCharacteristicIndexElements == kGeneratedDB_NumIPCharacteristicIndexElements);
+    HAPAssert(requirements.ip.numEventNotifications == kGeneratedDB_NumIPEventNotifications);
+    HAPAssert(requirements.ip.numValueCacheElements == kGeneratedDB_NumIPValueCacheElements);
+    HAPAssert(requirements.ble.numGATTTableElements == kGeneratedDB_NumBLEGATTTableElements);
+
+    // Bridged accessories are sorted by accessory instance ID.
+    HAPAssert(bridgedAccessories[0]->aid == 2);
+    HAPAssert(bridgedAccessories[1]->aid == 3);
+    HAPAssert(!bridgedAccessories[2]);
+
+    // Prepare accessory server storage with the generated constants.
+    static HAPIPSession ipSessions[kHAPIPSessionStorage_DefaultNumElements];
+    static uint8_t ipInboundBuffers[HAPArrayCount(ipSessions)][kHAPIPSession_DefaultInboundBufferSize];
+    static uint8_t ipOutboundBuffers[HAPArrayCount(ipSessions)][kHAPIPSession_DefaultOutboundBufferSize];
+    static HAPIPEventNotificationRef ipEventNotifications[HAPArrayCount(ipSessions)]
+                                                         [kGeneratedDB_NumIPEventNotifications];
+    for (size_t i = 0; i < HAPArrayCount(ipSessions); i++) {
+        ipSessions[i].inboundBuffer.bytes = ipInboundBuffers[i];
+        ipSessions[i].inboundBuffer.numBytes = sizeof ipInboundBuffers[i];
+        ipSessions[i].outboundBuffer.bytes = ipOutboundBuffers[i];
+        ipSessions[i].outboundBuffer.numBytes = sizeof ipOutboundBuffers[i];
+        ipSessions[i].eventNotifications = ipEventNotifications[i];
+        ipSessions[i].numEventNotifications = HAPArrayCount(ipEventNotifications[i]);
+    }
+    static HAPIPReadContextRef ipReadContexts[kGeneratedDB_NumIPCharacteristicIndexElements];
+    static HAPIPWriteContextRef ipWriteContexts[kGeneratedDB_NumIPCharacteristicIndexElements];
+    static HAPIPCharacteristicIndexElementRef
+            ipCharacteristicIndexElements[kGeneratedDB_NumIPCharacteristicIndexElements];
+    static uint8_t ipScratchBuffer[kHAPIPSession_DefaultScratchBufferSize];
+    static HAPIPAccessoryServerStorage ipAccessoryServerStorage = {
+        .sessions = ipSessions,
+        .numSessions = HAPArrayCount(ipSessions),
+        .readContexts = ipReadContexts,
+        .numReadContexts = HAPArrayCount(ipReadContexts),
+        .writeContexts = ipWriteContexts,
+        .numWriteContexts = HAPArrayCount(ipWriteContexts),
+        .characteristicIndexElements = ipCharacteristicIndexElements,
+        .numCharacteristicIndexElements = HAPArrayCount(ipCharacteristicIndexElements),
+        .scratchBuffer = { .bytes = ipScratchBuffer, .numBytes = sizeof ipScratchBuffer }
+    };
+
+    // Initialize accessory server.
+    static HAPAccessoryServerRef accessoryServer;
+    HAPAccessoryServerCreate(
+            &accessoryServer,
+            &(const HAPAccessoryServerOptions) {
+                    .maxPairings = kHAPPairingStorage_MinElements,
+                    .ip = { .transport = &kHAPAccessoryServerTransport_IP,
+                            .accessoryServerStorage = &ipAccessoryServerStorage } },
+            &platform,
+            &(const HAPAccessoryServerCallbacks) { .handleUpdatedState = HandleUpdatedAccessoryServerState },
+            /* context: */ NULL);
+
+    // The generated database passes validation.
+    HAPAccessoryServerStartBridge(
+            &accessoryServer, &bridgeAccessory, bridgedAccessories, /* configurationChanged: */ false);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Running);
+
+    HAPAccessoryServerStop(&accessoryServer);
+    while (!isIdle) {
+        HAPPlatformClockAdvance(0);
+    }
+    HAPAccessoryServerRelease(&accessoryServer);
+
+    return 0;
+}
@@ -0,0 +1,232 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAP+Internal.h"
+#include "HAPPlatform+Init.h"
+#include "HAPPlatformServiceDiscovery+Test.h"
+
+#include "Harness/HAPIPTestStorage.c"
+#include "Harness/LightBulbDB.c"
+#include "Harness/TemplateDB.c"
+
+/**
+ * Maximum number of characteristics of the bridge, including the bridged accessories.
+ */
+#define kMaxCharacteristics ((size_t) 64)
+
+static bool isIdle;
+
+static void HandleUpdatedAccessoryServerState(HAPAccessoryServerRef* server, void* _Nullable context HAP_UNUSED) {
+    HAPPrecondition(server);
+
+    isIdle = HAPAccessoryServerGetState(server) == kHAPAccessoryServerState_Idle;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError IdentifyAccessory(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPAccessoryIdentifyRequest* request HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    HAPFatalError();
+}
+
+static const HAPService hiddenLightBulbService = {
+    .iid = kIID_LightBulb,
+    .serviceType = &kHAPServiceType_LightBulb,
+    .debugDescription = kHAPServiceDebugDescription_LightBulb,
+    .name = NULL,
+    .properties = { .primaryService = true, .hidden = true, .ble = { .supportsConfiguration = false } },
+    .linkedServices = NULL,
+    .characteristics = (const HAPCharacteristic* const[]) { &lightBulbOnCharacteristic, NULL }
+};
+
+static const HAPAccessory renamedLightBulbAccessory = {
+    .aid = 2,
+    .category = kHAPAccessoryCategory_BridgedAccessory,
+    .name = "Acme Kitchen Light Bulb",
+    .manufacturer = "Acme",
+    .model = "LightBulb1,1",
+    .serialNumber = "099DB48E9E29",
+    .firmwareVersion = "1",
+    .services = (const HAPService* const[]) { &accessoryInformationService, &lightBulbService, NULL },
+    .callbacks = { .identify = IdentifyAccessory }
+};
+
+static const HAPAccessory hiddenLightBulbAccessory = {
+    .aid = 2,
+    .category = kHAPAccessoryCategory_BridgedAccessory,
+    .name = "Acme Light Bulb",
+    .manufacturer = "Acme",
+    .model = "LightBulb1,1",
+    .serialNumber = "099DB48E9E29",
+    .firmwareVersion = "1",
+    .services = (const HAPService* const[]) { &accessoryInformationService, &hiddenLightBulbService, NULL },
+    .callbacks = { .identify = IdentifyAccessory }
+};
+
+/**
+ * Starts and stops the bridge and returns the configuration number that was in effect while it was running.
+ *
+ * @param      server               Accessory server.
+ * @param      bridgedAccessories   NULL-terminated array of bridged accessories.
+ * @param      configurationChanged Whether or not the bridge configuration changed since the last start.
+ *
+ * @return Configuration number.
+ */
+HAP_RESULT_USE_CHECK
+static uint16_t StartBridge(
+        HAPAccessoryServerRef* server,
+        const HAPAccessory* _Nullable const* bridgedAccessories,
+        bool configurationChanged) {
+    HAPPrecondition(server);
+    HAPPrecondition(bridgedAccessories);
+
+    HAPAccessoryServerStartBridge(server, &bridgeAccessory, bridgedAccessories, configurationChanged);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(server) == kHAPAccessoryServerState_Running);
+
+    uint16_t cn;
+    HAPError err = HAPAccessoryServerGetCN(platform.keyValueStore, &cn);
+    HAPAssert(!err);
+
+    HAPAccessoryServerStop(server);
+    while (!isIdle) {
+        HAPPlatformClockAdvance(0);
+    }
+    return cn;
+}
+
+static void FindConfigurationNumberTXTRecord(
+        void* _Nullable context,
+        HAPPlatformServiceDiscoveryRef serviceDiscovery HAP_UNUSED,
+        const char* key,
+        const void* valueBytes,
+        size_t numValueBytes HAP_UNUSED,
+        bool* shouldContinue) {
+    HAPPrecondition(context);
+    const char** configurationNumberBytes = context;
+    HAPPrecondition(key);
+    HAPPrecondition(valueBytes);
+    HAPPrecondition(shouldContinue);
+
+    if (HAPStringAreEqual(key, "c#")) {
+        *configurationNumberBytes = valueBytes;
+        *shouldContinue = false;
+    }
+}
+
+/**
+ * Returns the configuration number that is advertised in the Bonjour TXT records.
+ *
+ * @return Advertised configuration number. NULL-terminated.
+ */
+HAP_RESULT_USE_CHECK
+static const char* GetAdvertisedConfigurationNumber(void) {
+    const char* _Nullable configurationNumberBytes = NULL;
+    HAPPlatformServiceDiscoveryEnumerateTXTRecords(
+            HAPNonnull(platform.ip.serviceDiscovery), FindConfigurationNumberTXTRecord, &configurationNumberBytes);
+    HAPAssert(configurationNumberBytes);
+    return HAPNonnull(configurationNumberBytes);
+}
+
+int main() {
+    HAPPlatformCreate();
+
+    // Prepare accessory server storage.
+    static HAPIPAccessoryServerStorage ipAccessoryServerStorage;
+    HAPIPTestStorageCreate(
+            &ipAccessoryServerStorage,
+            &(const HAPIPTestStorageOptions) { .numSessions = kHAPIPSessionStorage_DefaultNumElements,
+                                               .maxCharacteristics = kMaxCharacteristics });
+
+    // Initialize accessory server.
+    static HAPAccessoryServerRef accessoryServer;
+    HAPAccessoryServerCreate(
+            &accessoryServer,
+            &(const HAPAccessoryServerOptions) {
+                    .maxPairings = kHAPPairingStorage_MinElements,
+                    .ip = { .transport = &kHAPAccessoryServerTransport_IP,
+                            .accessoryServerStorage = &ipAccessoryServerStorage } },
+            &platform,
+            &(const HAPAccessoryServerCallbacks) { .handleUpdatedState = HandleUpdatedAccessoryServerState },
+            /* context: */ NULL);
+
+    // First start keeps the initial configuration number.
+    const HAPAccessory* _Nullable oneLightBulb[] = { &bridgedLightBulbAccessory, NULL };
+    HAPAssert(StartBridge(&accessoryServer, oneLightBulb, /* configurationChanged: */ false) == 1);
+
+    // Unchanged configuration keeps the configuration number.
+    HAPAssert(StartBridge(&accessoryServer, oneLightBulb, /* configurationChanged: */ false) == 1);
+
+    // Adding a bridged accessory increments the configuration number once.
+    const HAPAccessory* _Nullable twoLightBulbs[] = { &bridgedLightBulbAccessory,
+                                                      &secondBridgedLightBulbAccessory,
+                                                      NULL };
+    HAPAssert(StartBridge(&accessoryServer, twoLightBulbs, /* configurationChanged: */ false) == 2);
+    HAPAssert(StartBridge(&accessoryServer, twoLightBulbs, /* configurationChanged: */ false) == 2);
+
+    // Characteristic values are not part of the configuration.
+    const HAPAccessory* _Nullable renamedLightBulbs[] = { &renamedLightBulbAccessory,
+                                                          &secondBridgedLightBulbAccessory,
+                                                          NULL };
+    HAPAssert(StartBridge(&accessoryServer, renamedLightBulbs, /* configurationChanged: */ false) == 2);
+
+    // Service properties are part of the configuration.
+    const HAPAccessory* _Nullable hiddenLightBulbs[] = { &hiddenLightBulbAccessory,
+                                                         &secondBridgedLightBulbAccessory,
+                                                         NULL };
+    HAPAssert(StartBridge(&accessoryServer, hiddenLightBulbs, /* configurationChanged: */ false) == 3);
+
+    // Configuration number may still be incremented explicitly.
+    HAPAssert(StartBridge(&accessoryServer, hiddenLightBulbs, /* configurationChanged: */ true) == 4);
+    HAPAssert(StartBridge(&accessoryServer, hiddenLightBulbs, /* configurationChanged: */ false) == 4);
+
+    // Removing a bridged accessory increments the configuration number.
+    HAPAssert(StartBridge(&accessoryServer, oneLightBulb, /* configurationChanged: */ false) == 5);
+
+    // Bridged accessories may be replaced while running. The advertised configuration number is updated.
+    HAPError err;
+    uint16_t cn;
+    HAPAccessoryServerStartBridge(&accessoryServer, &bridgeAccessory, oneLightBulb, /* configurationChanged: */ false);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPStringAreEqual(GetAdvertisedConfigurationNumber(), "5"));
+    err = HAPAccessoryServerUpdateBridgedAccessories(&accessoryServer, twoLightBulbs);
+    HAPAssert(!err);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Running);
+    err = HAPAccessoryServerGetCN(platform.keyValueStore, &cn);
+    HAPAssert(!err);
+    HAPAssert(cn == 6);
+    HAPAssert(HAPStringAreEqual(GetAdvertisedConfigurationNumber(), "6"));
+
+    // Replacing bridged accessories without changes keeps the configuration number.
+    err = HAPAccessoryServerUpdateBridgedAccessories(&accessoryServer, twoLightBulbs);
+    HAPAssert(!err);
+    err = HAPAccessoryServerGetCN(platform.keyValueStore, &cn);
+    HAPAssert(!err);
+    HAPAssert(cn == 6);
+
+    // Bridged accessories that do not fit into the accessory server storage are rejected.
+    static HAPAccessory manyLightBulbAccessories[16];
+    static const HAPAccessory* _Nullable manyLightBulbs[HAPArrayCount(manyLightBulbAccessories) + 1];
+    for (size_t i = 0; i < HAPArrayCount(manyLightBulbAccessories); i++) {
+        manyLightBulbAccessories[i] = bridgedLightBulbAccessory;
+        manyLightBulbAccessories[i].aid = 2 + i;
+        manyLightBulbs[i] = &manyLightBulbAccessories[i];
+    }
+    err = HAPAccessoryServerUpdateBridgedAccessories(&accessoryServer, manyLightBulbs);
+    HAPAssert(err == kHAPError_OutOfResources);
+    err = HAPAccessoryServerGetCN(platform.keyValueStore, &cn);
+    HAPAssert(!err);
+    HAPAssert(cn == 6);
+
+    HAPAccessoryServerStop(&accessoryServer);
+    while (!isIdle) {
+        HAPPlatformClockAdvance(0);
+    }
+
+    HAPAccessoryServerRelease(&accessoryServer);
+    return 0;
+}
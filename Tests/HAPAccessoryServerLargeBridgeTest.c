@@ -0,0 +1,267 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+// Checks that a HAP-IP bridge with the maximum number of bridged accessories, each providing characteristics of
+// every format, serves GET /accessories, GET /characteristics and event notifications to a paired controller.
+
+#include "HAP+Internal.h"
+#include "HAPPlatform+Init.h"
+
+#include "Harness/HAPIPController.c"
+#include "Harness/HAPIPTestStorage.c"
+#include "Harness/SyntheticDB.c"
+#include "Harness/TemplateDB.c"
+
+/**
+ * Number of synthetic services per bridged accessory.
+ */
+#define kNumServices ((size_t) 2)
+
+/**
+ * Number of characteristics per synthetic service.
+ */
+#define kNumCharacteristics kSyntheticDB_NumFormats
+
+/**
+ * Maximum number of characteristics of the bridge, including the bridged accessories.
+ */
+#define kMaxCharacteristics ((size_t) 4500)
+
+static bool isIdle;
+
+static void HandleUpdatedAccessoryServerState(HAPAccessoryServerRef* server, void* _Nullable context HAP_UNUSED) {
+    HAPPrecondition(server);
+
+    isIdle = HAPAccessoryServerGetState(server) == kHAPAccessoryServerState_Idle;
+}
+
+/**
+ * Counts the occurrences of a string in a buffer.
+ *
+ * @param      bytes                Buffer.
+ * @param      numBytes             Length of buffer.
+ * @param      string               String to count.
+ *
+ * @return Number of occurrences.
+ */
+HAP_RESULT_USE_CHECK
+static size_t CountOccurrences(const void* bytes, size_t numBytes, const char* string) {
+    HAPPrecondition(bytes);
+    HAPPrecondition(string);
+
+    size_t numStringBytes = HAPStringGetNumBytes(string);
+    size_t n = 0;
+    for (size_t i = 0; i + numStringBytes <= numBytes; i++) {
+        if (HAPRawBufferAreEqual(&((const uint8_t*) bytes)[i], string, numStringBytes)) {
+            n++;
+        }
+    }
+    return n;
+}
+
+int main() {
+    HAPError err;
+    HAPPlatformCreate();
+
+    SyntheticDB db;
+    SyntheticDBCreate(
+            &db,
+            &(const SyntheticDBOptions) { .numBridgedAccessories = kHAPAccessoryServerMaxBridgedAccessories,
+                                          .numServices = kNumServices,
+                                          .numCharacteristics = kNumCharacteristics });
+
+    HAPAccessoryServerStorageUsage requirements;
+    HAPAccessoryServerGetStorageRequirements(db.primaryAccessory, db.bridgedAccessories, &requirements);
+    HAPAssert(requirements.ip.numCharacteristicIndexElements <= kMaxCharacteristics);
+    HAPAssert(requirements.ip.numCharacteristicIndexElements >
+              db.numBridgedAccessories * kNumServices * kNumCharacteristics);
+
+    // Provision accessory server and a paired controller.
+    static const HAPAccessoryServerDeviceID deviceID = { { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 } };
+    err = HAPLegacyImportDeviceID(platform.keyValueStore, &deviceID);
+    HAPAssert(!err);
+    HAPAccessoryServerLongTermSecretKey accessoryLTSK;
+    HAPPlatformRandomNumberFill(accessoryLTSK.bytes, sizeof accessoryLTSK.bytes);
+    err = HAPLegacyImportLongTermSecretKey(platform.keyValueStore, &accessoryLTSK);
+    HAPAssert(!err);
+    uint8_t accessoryLTPK[ED25519_PUBLIC_KEY_BYTES];
+    HAP_ed25519_public_key(accessoryLTPK, accessoryLTSK.bytes);
+
+    static const HAPControllerPairingIdentifier pairingIdentifier = {
+        .bytes = "4E5D4B2F-6A3B-4C1D-9E8F-0A1B2C3D4E5F", .numBytes = 36
+    };
+    uint8_t controllerLTSK[ED25519_SECRET_KEY_BYTES];
+    HAPPlatformRandomNumberFill(controllerLTSK, sizeof controllerLTSK);
+    HAPControllerPublicKey controllerLTPK;
+    HAP_ed25519_public_key(controllerLTPK.bytes, controllerLTSK);
+    err = HAPLegacyImportControllerPairing(
+            platform.keyValueStore, 0, &pairingIdentifier, &controllerLTPK, /* isAdmin: */ true);
+    HAPAssert(!err);
+
+    // Prepare accessory server storage.
+    static HAPIPAccessoryServerStorage ipAccessoryServerStorage;
+    HAPIPTestStorageCreate(
+            &ipAccessoryServerStorage,
+            &(const HAPIPTestStorageOptions) { .numSessions = kHAPIPSessionStorage_DefaultNumElements,
+                                               .maxCharacteristics = kMaxCharacteristics });
+
+    // Initialize and start accessory server.
+    static HAPAccessoryServerRef accessoryServer;
+    HAPAccessoryServerCreate(
+            &accessoryServer,
+            &(const HAPAccessoryServerOptions) {
+                    .maxPairings = kHAPPairingStorage_MinElements,
+                    .ip = { .transport = &kHAPAccessoryServerTransport_IP,
+                            .accessoryServerStorage = &ipAccessoryServerStorage } },
+            &platform,
+            &(const HAPAccessoryServerCallbacks) { .handleUpdatedState = HandleUpdatedAccessoryServerState },
+            /* context: */ NULL);
+    HAPAccessoryServerStartBridge(
+            &accessoryServer,
+            db.primaryAccessory,
+            HAPNonnullVoid(db.bridgedAccessories),
+            /* configurationChanged: */ false);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Running);
+
+    // Connect and establish a HAP session.
+    static HAPIPController controller;
+    HAPIPControllerCreate(
+            &controller,
+            &(const HAPIPControllerOptions) { .tcpStreamManager = HAPNonnull(platform.ip.tcpStreamManager),
+                                              .pairingIdentifier = &pairingIdentifier,
+                                              .longTermSecretKey = controllerLTSK,
+                                              .accessoryLongTermPublicKey = accessoryLTPK });
+    err = HAPIPControllerConnect(&controller);
+    HAPAssert(!err);
+    err = HAPIPControllerPairVerify(&controller);
+    HAPAssert(!err);
+
+    // GET /accessories lists every accessory and every characteristic.
+    static char responseBytes[2 * 1024 * 1024];
+    unsigned int status;
+    size_t numResponseBytes;
+    err = HAPIPControllerPerformRequest(
+            &controller,
+            "GET",
+            "/accessories",
+            /* contentType: */ NULL,
+            /* requestBodyBytes: */ NULL,
+            0,
+            &status,
+            responseBytes,
+            sizeof responseBytes,
+            &numResponseBytes);
+    HAPAssert(!err);
+    HAPAssert(status == 200);
+    HAPAssert(CountOccurrences(responseBytes, numResponseBytes, "\"aid\":") == 1 + db.numBridgedAccessories);
+    HAPAssert(
+            CountOccurrences(responseBytes, numResponseBytes, "\"format\":") ==
+            requirements.ip.numCharacteristicIndexElements);
+    HAPAssert(CountOccurrences(responseBytes, numResponseBytes, "\"format\":\"tlv8\"") ==
+              db.numBridgedAccessories * kNumServices * kNumCharacteristics / kSyntheticDB_NumFormats);
+
+    // GET /characteristics reads one characteristic of every bridged accessory, cycling through all formats.
+    static char uri[kHAPIPSession_DefaultInboundBufferSize / 2];
+    static char requestBytes[kHAPIPSession_DefaultInboundBufferSize / 2];
+    {
+        size_t numURIBytes = 0;
+        size_t numRequestBytes = 0;
+        err = HAPStringWithFormat(uri, sizeof uri, "/characteristics?id=");
+        HAPAssert(!err);
+        err = HAPStringWithFormat(requestBytes, sizeof requestBytes, "{\"characteristics\":[");
+        HAPAssert(!err);
+        for (size_t i = 0; i < db.numBridgedAccessories; i++) {
+            const HAPAccessory* accessory = HAPNonnull(db.bridgedAccessories[i]);
+            const HAPCharacteristic* characteristic =
+                    SyntheticDBGetCharacteristic(&db, i % kNumServices, i % kNumCharacteristics);
+            uint64_t iid = ((const HAPBaseCharacteristic*) characteristic)->iid;
+
+            numURIBytes = HAPStringGetNumBytes(uri);
+            err = HAPStringWithFormat(
+                    &uri[numURIBytes],
+                    sizeof uri - numURIBytes,
+                    "%s%llu.%llu",
+                    i ? "," : "",
+                    (unsigned long long) accessory->aid,
+                    (unsigned long long) iid);
+            HAPAssert(!err);
+            numRequestBytes = HAPStringGetNumBytes(requestBytes);
+            err = HAPStringWithFormat(
+                    &requestBytes[numRequestBytes],
+                    sizeof requestBytes - numRequestBytes,
+                    "%s{\"aid\":%llu,\"iid\":%llu,\"ev\":true}",
+                    i ? "," : "",
+                    (unsigned long long) accessory->aid,
+                    (unsigned long long) iid);
+            HAPAssert(!err);
+        }
+        numRequestBytes = HAPStringGetNumBytes(requestBytes);
+        err = HAPStringWithFormat(&requestBytes[numRequestBytes], sizeof requestBytes - numRequestBytes, "]}");
+        HAPAssert(!err);
+    }
+    size_t numCallbacks = SyntheticDBGetNumCallbacks();
+    err = HAPIPControllerPerformRequest(
+            &controller,
+            "GET",
+            uri,
+            /* contentType: */ NULL,
+            /* requestBodyBytes: */ NULL,
+            0,
+            &status,
+            responseBytes,
+            sizeof responseBytes,
+            &numResponseBytes);
+    HAPAssert(!err);
+    HAPAssert(status == 200);
+    HAPAssert(SyntheticDBGetNumCallbacks() - numCallbacks == db.numBridgedAccessories);
+    HAPAssert(CountOccurrences(responseBytes, numResponseBytes, "\"value\":") == db.numBridgedAccessories);
+
+    // PUT /characteristics subscribes to the same characteristics.
+    err = HAPIPControllerPerformRequest(
+            &controller,
+            "PUT",
+            "/characteristics",
+            "application/hap+json",
+            requestBytes,
+            HAPStringGetNumBytes(requestBytes),
+            &status,
+            /* responseBodyBytes: */ NULL,
+            0,
+            &numResponseBytes);
+    HAPAssert(!err);
+    HAPAssert(status == 204);
+
+    // Raised events are delivered for every bridged accessory once the event notification delay elapsed.
+    for (size_t i = 0; i < db.numBridgedAccessories; i++) {
+        HAPAccessoryServerRaiseEvent(
+                &accessoryServer,
+                SyntheticDBGetCharacteristic(&db, i % kNumServices, i % kNumCharacteristics),
+                db.services[i % kNumServices],
+                HAPNonnull(db.bridgedAccessories[i]));
+    }
+    HAPPlatformClockAdvance(1 * HAPSecond);
+    size_t numEvents = 0;
+    for (;;) {
+        err = HAPIPControllerReceiveEvent(&controller, responseBytes, sizeof responseBytes, &numResponseBytes);
+        if (err) {
+            HAPAssert(err == kHAPError_InvalidState);
+            break;
+        }
+        numEvents += CountOccurrences(responseBytes, numResponseBytes, "\"aid\":");
+    }
+    HAPAssert(numEvents == db.numBridgedAccessories);
+
+    // Stop accessory server.
+    HAPIPControllerDisconnect(&controller);
+    HAPAccessoryServerStop(&accessoryServer);
+    while (!isIdle) {
+        HAPPlatformClockAdvance(0);
+    }
+    HAPAccessoryServerRelease(&accessoryServer);
+
+    return 0;
+}
@@ -0,0 +1,212 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+// Checks that skipUnchangedAccessoryValidation only skips validation of accessory definitions whose fingerprint
+// matches the stored one, and that changing a single characteristic constraint makes validation run again.
+
+#include "HAP+Internal.h"
+#include "HAPPlatform+Init.h"
+
+#include "Harness/HAPIPTestStorage.c"
+#include "Harness/TemplateDB.c"
+
+#define kIID_LightBulb           ((uint64_t) 0x0030)
+#define kIID_LightBulbBrightness ((uint64_t) 0x0031)
+
+/**
+ * Maximum number of characteristics of the accessory.
+ */
+#define kMaxCharacteristics ((size_t) 32)
+
+static bool isIdle;
+
+static void HandleUpdatedAccessoryServerState(HAPAccessoryServerRef* server, void* _Nullable context HAP_UNUSED) {
+    HAPPrecondition(server);
+
+    isIdle = HAPAccessoryServerGetState(server) == kHAPAccessoryServerState_Idle;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError IdentifyAccessory(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPAccessoryIdentifyRequest* request HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleBrightnessRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPIntCharacteristicReadRequest* request HAP_UNUSED,
+        int32_t* value,
+        void* _Nullable context HAP_UNUSED) {
+    *value = 50;
+    return kHAPError_None;
+}
+
+/**
+ * Brightness characteristic. Not const so that its constraints may be changed between starts.
+ */
+static HAPIntCharacteristic lightBulbBrightnessCharacteristic = {
+    .format = kHAPCharacteristicFormat_Int,
+    .iid = kIID_LightBulbBrightness,
+    .characteristicType = &kHAPCharacteristicType_Brightness,
+    .debugDescription = kHAPCharacteristicDebugDescription_Brightness,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = false,
+                    .supportsEventNotification = true,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false, .supportsWriteResponse = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .units = kHAPCharacteristicUnits_Percentage,
+    .constraints = { .minimumValue = 0, .maximumValue = 100, .stepValue = 1 },
+    .callbacks = { .handleRead = HandleBrightnessRead, .handleWrite = NULL }
+};
+
+static const HAPService lightBulbService = {
+    .iid = kIID_LightBulb,
+    .serviceType = &kHAPServiceType_LightBulb,
+    .debugDescription = kHAPServiceDebugDescription_LightBulb,
+    .name = NULL,
+    .properties = { .primaryService = true, .hidden = false, .ble = { .supportsConfiguration = false } },
+    .linkedServices = NULL,
+    .characteristics = (const HAPCharacteristic* const[]) { &lightBulbBrightnessCharacteristic, NULL }
+};
+
+static const HAPAccessory accessory = {
+    .aid = 1,
+    .category = kHAPAccessoryCategory_Lighting,
+    .name = "Acme Light Bulb",
+    .manufacturer = "Acme",
+    .model = "LightBulb1,1",
+    .serialNumber = "099DB48E9E28",
+    .firmwareVersion = "1",
+    .hardwareVersion = "1",
+    .services = (const HAPService* const[]) { &accessoryInformationService,
+                                              &hapProtocolInformationService,
+                                              &pairingService,
+                                              &lightBulbService,
+                                              NULL },
+    .callbacks = { .identify = IdentifyAccessory }
+};
+
+/**
+ * Returns the validation fingerprint that is stored in the key-value store.
+ *
+ * @return Stored validation fingerprint.
+ */
+HAP_RESULT_USE_CHECK
+static uint64_t GetStoredFingerprint(void) {
+    uint8_t bytes[sizeof(uint64_t)];
+    bool found;
+    size_t numBytes;
+    HAPError err = HAPPlatformKeyValueStoreGet(
+            platform.keyValueStore,
+            kHAPKeyValueStoreDomain_Configuration,
+            kHAPKeyValueStoreKey_Configuration_ValidationFingerprint,
+            bytes,
+            sizeof bytes,
+            &numBytes,
+            &found);
+    HAPAssert(!err);
+    HAPAssert(found);
+    HAPAssert(numBytes == sizeof bytes);
+    return HAPReadLittleUInt64(bytes);
+}
+
+/**
+ * Stores a validation fingerprint in the key-value store.
+ *
+ * @param      fingerprint          Validation fingerprint.
+ */
+static void SetStoredFingerprint(uint64_t fingerprint) {
+    uint8_t bytes[sizeof(uint64_t)];
+    HAPWriteLittleUInt64(bytes, fingerprint);
+    HAPError err = HAPPlatformKeyValueStoreSet(
+            platform.keyValueStore,
+            kHAPKeyValueStoreDomain_Configuration,
+            kHAPKeyValueStoreKey_Configuration_ValidationFingerprint,
+            bytes,
+            sizeof bytes);
+    HAPAssert(!err);
+}
+
+/**
+ * Starts and stops the accessory server.
+ *
+ * @param      server               Accessory server.
+ */
+static void StartAccessory(HAPAccessoryServerRef* server) {
+    HAPPrecondition(server);
+
+    HAPAccessoryServerStart(server, &accessory);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(server) == kHAPAccessoryServerState_Running);
+
+    HAPAccessoryServerStop(server);
+    while (!isIdle) {
+        HAPPlatformClockAdvance(0);
+    }
+}
+
+int main() {
+    HAPPlatformCreate();
+
+    // Prepare accessory server storage.
+    static HAPIPAccessoryServerStorage ipAccessoryServerStorage;
+    HAPIPTestStorageCreate(
+            &ipAccessoryServerStorage,
+            &(const HAPIPTestStorageOptions) { .numSessions = kHAPIPSessionStorage_DefaultNumElements,
+                                               .maxCharacteristics = kMaxCharacteristics });
+
+    // Initialize accessory server.
+    static HAPAccessoryServerRef accessoryServer;
+    HAPAccessoryServerCreate(
+            &accessoryServer,
+            &(const HAPAccessoryServerOptions) {
+                    .maxPairings = kHAPPairingStorage_MinElements,
+                    .skipUnchangedAccessoryValidation = true,
+                    .ip = { .transport = &kHAPAccessoryServerTransport_IP,
+                            .accessoryServerStorage = &ipAccessoryServerStorage } },
+            &platform,
+            &(const HAPAccessoryServerCallbacks) { .handleUpdatedState = HandleUpdatedAccessoryServerState },
+            /* context: */ NULL);
+
+    // First start validates the accessory definition and stores its fingerprint.
+    uint64_t fingerprint = HAPAccessoryValidationGetFingerprint(&accessory, /* bridgedAccessories: */ NULL);
+    StartAccessory(&accessoryServer);
+    HAPAssert(GetStoredFingerprint() == fingerprint);
+
+    // Unchanged accessory definition keeps the stored fingerprint.
+    StartAccessory(&accessoryServer);
+    HAPAssert(GetStoredFingerprint() == fingerprint);
+
+    // A stale fingerprint does not skip validation and is replaced after successful validation.
+    SetStoredFingerprint(~fingerprint);
+    StartAccessory(&accessoryServer);
+    HAPAssert(GetStoredFingerprint() == fingerprint);
+
+    // Changing a single characteristic constraint changes the fingerprint, so validation runs again.
+    lightBulbBrightnessCharacteristic.constraints.maximumValue = 50;
+    uint64_t changedFingerprint = HAPAccessoryValidationGetFingerprint(&accessory, /* bridgedAccessories: */ NULL);
+    HAPAssert(changedFingerprint != fingerprint);
+    StartAccessory(&accessoryServer);
+    HAPAssert(GetStoredFingerprint() == changedFingerprint);
+
+    // Reverting the constraint validates the original accessory definition again.
+    lightBulbBrightnessCharacteristic.constraints.maximumValue = 100;
+    StartAccessory(&accessoryServer);
+    HAPAssert(GetStoredFingerprint() == fingerprint);
+
+    HAPAccessoryServerRelease(&accessoryServer);
+    return 0;
+}
@@ -105,5 +105,13 @@ int main() {
     HAPAssert(!err);
     HAPAssert(serverInfo.statusFlags.isNotPaired);
 
+    // Storage high-water marks match the storage requirements of the accessory.
+    HAPAccessoryServerStorageUsage requirements;
+    HAPAccessoryServerGetStorageRequirements(&accessory, /* bridgedAccessories: */ NULL, &requirements);
+    HAPAccessoryServerStorageUsage highWaterMarks;
+    HAPAccessoryServerGetStorageHighWaterMarks(&accessoryServer, &highWaterMarks);
+    HAPAssert(highWaterMarks.ble.numGATTTableElements == requirements.ble.numGATTTableElements);
+    HAPAssert(highWaterMarks.ble.numGATTTableElements <= HAPArrayCount(gattTableElements));
+
     // TODO Pair, discover, test events... [NYI]
 }
@@ -0,0 +1,454 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+// Checks that the GSN is persisted in reserved ranges: a clean stop persists the exact GSN, recovering from the end
+// of a reserved range never moves the GSN backwards, and a broadcast encryption key that would have expired within
+// the skipped range of GSN values is expired.
+
+#include "HAP+Internal.h"
+#include "HAPPlatform+Init.h"
+
+#include "Harness/TemplateDB.c"
+
+#define kIID_LightBulb                 ((uint64_t) 0x0030)
+#define kIID_LightBulbServiceSignature ((uint64_t) 0x0031)
+#define kIID_LightBulbOn               ((uint64_t) 0x0032)
+
+/**
+ * GSN state flag: GSN has been incremented in the current connect / disconnect cycle.
+ * See HAPBLEAccessoryServer+Advertising.c.
+ */
+#define kGSNFlags_DidIncrement ((uint8_t) 0x01U)
+
+/**
+ * GSN state flag: The persisted GSN is the end of a reserved range.
+ * See HAPBLEAccessoryServer+Advertising.c.
+ */
+#define kGSNFlags_IsReserved ((uint8_t) 0x02U)
+
+static void HandleUpdatedAccessoryServerState(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError IdentifyAccessory(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPAccessoryIdentifyRequest* request HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleOnRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPBoolCharacteristicReadRequest* request HAP_UNUSED,
+        bool* value,
+        void* _Nullable context HAP_UNUSED) {
+    *value = true;
+    return kHAPError_None;
+}
+
+static const HAPDataCharacteristic lightBulbServiceSignatureCharacteristic = {
+    .format = kHAPCharacteristicFormat_Data,
+    .iid = kIID_LightBulbServiceSignature,
+    .characteristicType = &kHAPCharacteristicType_ServiceSignature,
+    .debugDescription = kHAPCharacteristicDebugDescription_ServiceSignature,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = false,
+                    .supportsEventNotification = false,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = true },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .constraints = { .maxLength = 2097152 },
+    .callbacks = { .handleRead = HAPHandleServiceSignatureRead, .handleWrite = NULL }
+};
+
+static const HAPBoolCharacteristic lightBulbOnCharacteristic = {
+    .format = kHAPCharacteristicFormat_Bool,
+    .iid = kIID_LightBulbOn,
+    .characteristicType = &kHAPCharacteristicType_On,
+    .debugDescription = kHAPCharacteristicDebugDescription_On,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = false,
+                    .supportsEventNotification = true,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false, .supportsWriteResponse = false },
+                    .ble = { .supportsBroadcastNotification = true,
+                             .supportsDisconnectedNotification = true,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .callbacks = { .handleRead = HandleOnRead, .handleWrite = NULL }
+};
+
+static const HAPService lightBulbService = {
+    .iid = kIID_LightBulb,
+    .serviceType = &kHAPServiceType_LightBulb,
+    .debugDescription = kHAPServiceDebugDescription_LightBulb,
+    .name = NULL,
+    .properties = { .primaryService = true, .hidden = false, .ble = { .supportsConfiguration = false } },
+    .linkedServices = NULL,
+    .characteristics = (const HAPCharacteristic* const[]) { &lightBulbServiceSignatureCharacteristic,
+                                                            &lightBulbOnCharacteristic,
+                                                            NULL }
+};
+
+static const HAPAccessory accessory = { .aid = 1,
+                                        .category = kHAPAccessoryCategory_Lighting,
+                                        .name = "Acme Light Bulb",
+                                        .manufacturer = "Acme",
+                                        .model = "LightBulb1,1",
+                                        .serialNumber = "099DB48E9E28",
+                                        .firmwareVersion = "1",
+                                        .hardwareVersion = "1",
+                                        .services = (const HAPService* const[]) { &accessoryInformationService,
+                                                                                  &hapProtocolInformationService,
+                                                                                  &pairingService,
+                                                                                  &lightBulbService,
+                                                                                  NULL },
+                                        .callbacks = { .identify = IdentifyAccessory } };
+
+static HAPAccessoryServerRef accessoryServer;
+
+/**
+ * Reads the persisted GSN state.
+ *
+ * @param[out] gsn                  Persisted GSN.
+ * @param[out] flags                Persisted GSN state flags.
+ */
+static void GetPersistedGSN(uint16_t* gsn, uint8_t* flags) {
+    HAPPrecondition(gsn);
+    HAPPrecondition(flags);
+
+    HAPError err;
+
+    bool found;
+    size_t numBytes;
+    uint8_t gsnBytes[sizeof(uint16_t) + sizeof(uint8_t)];
+    err = HAPPlatformKeyValueStoreGet(
+            platform.keyValueStore,
+            kHAPKeyValueStoreDomain_Configuration,
+            kHAPKeyValueStoreKey_Configuration_BLEGSN,
+            gsnBytes,
+            sizeof gsnBytes,
+            &numBytes,
+            &found);
+    HAPAssert(!err);
+    HAPAssert(found);
+    HAPAssert(numBytes == sizeof gsnBytes);
+    *gsn = HAPReadLittleUInt16(&gsnBytes[0]);
+    *flags = gsnBytes[2];
+}
+
+/**
+ * Overwrites the persisted GSN state, e.g., to simulate a power loss before the accessory server was stopped.
+ *
+ * @param      gsn                  GSN to persist.
+ * @param      flags                GSN state flags to persist.
+ */
+static void SetPersistedGSN(uint16_t gsn, uint8_t flags) {
+    HAPError err;
+
+    uint8_t gsnBytes[] = { HAPExpandLittleUInt16(gsn), flags };
+    err = HAPPlatformKeyValueStoreSet(
+            platform.keyValueStore,
+            kHAPKeyValueStoreDomain_Configuration,
+            kHAPKeyValueStoreKey_Configuration_BLEGSN,
+            gsnBytes,
+            sizeof gsnBytes);
+    HAPAssert(!err);
+}
+
+/**
+ * Persists a broadcast encryption key.
+ *
+ * @param      keyExpirationGSN     GSN at which the broadcast encryption key expires.
+ */
+static void SetPersistedBroadcastKey(uint16_t keyExpirationGSN) {
+    HAPError err;
+
+    uint8_t parametersBytes
+            [sizeof(uint16_t) + sizeof(HAPBLEAccessoryServerBroadcastEncryptionKey) + sizeof(uint8_t) +
+             sizeof(HAPDeviceID)];
+    HAPRawBufferZero(parametersBytes, sizeof parametersBytes);
+    HAPWriteLittleUInt16(&parametersBytes[0], keyExpirationGSN);
+    for (size_t i = 0; i < sizeof(HAPBLEAccessoryServerBroadcastEncryptionKey); i++) {
+        parametersBytes[2 + i] = 0xAA;
+    }
+    err = HAPPlatformKeyValueStoreSet(
+            platform.keyValueStore,
+            kHAPKeyValueStoreDomain_Configuration,
+            kHAPKeyValueStoreKey_Configuration_BLEBroadcastParameters,
+            parametersBytes,
+            sizeof parametersBytes);
+    HAPAssert(!err);
+}
+
+/**
+ * Returns the expiration GSN of the broadcast encryption key.
+ *
+ * @return Expiration GSN of the broadcast encryption key. 0 if the broadcast encryption key is expired.
+ */
+HAP_RESULT_USE_CHECK
+static uint16_t GetKeyExpirationGSN(void) {
+    HAPError err;
+
+    uint16_t keyExpirationGSN;
+    err = HAPBLEAccessoryServerBroadcastGetParameters(&accessoryServer, &keyExpirationGSN, NULL, NULL);
+    HAPAssert(!err);
+    return keyExpirationGSN;
+}
+
+/**
+ * Returns the current GSN state of the accessory server.
+ *
+ * @return GSN state.
+ */
+HAP_RESULT_USE_CHECK
+static HAPBLEAccessoryServerGSN GetGSN(void) {
+    HAPError err;
+
+    HAPBLEAccessoryServerGSN gsn;
+    err = HAPBLEAccessoryServerGetGSN(&accessoryServer, &gsn);
+    HAPAssert(!err);
+    return gsn;
+}
+
+/**
+ * Raises a disconnected event to increment the GSN and checks that the persisted GSN is not behind the new GSN.
+ *
+ * @return New GSN.
+ */
+static uint16_t IncrementGSN(void) {
+    uint16_t gsn = GetGSN().gsn;
+
+    // The GSN only increments once per connect / disconnect cycle. Start a new cycle.
+    ((HAPAccessoryServer*) &accessoryServer)->ble.gsn.state.didIncrement = false;
+    HAPAccessoryServerRaiseEvent(&accessoryServer, &lightBulbOnCharacteristic, &lightBulbService, &accessory);
+
+    // Complete the advertising period of the disconnected event.
+    HAPPlatformClockAdvance(10 * HAPSecond);
+
+    HAPBLEAccessoryServerGSN newGSN = GetGSN();
+    HAPAssert(newGSN.gsn == (gsn == UINT16_MAX ? 1 : gsn + 1));
+    HAPAssert(newGSN.didIncrement);
+
+    // The persisted GSN is the end of a reserved range that contains the new GSN.
+    uint16_t persistedGSN;
+    uint8_t persistedFlags;
+    GetPersistedGSN(&persistedGSN, &persistedFlags);
+    HAPAssert(persistedFlags == (kGSNFlags_DidIncrement | kGSNFlags_IsReserved));
+    uint16_t numReservedGSNs = (uint16_t)(((uint32_t) persistedGSN + UINT16_MAX - newGSN.gsn) % UINT16_MAX);
+    HAPAssert(numReservedGSNs < kHAPBLEAccessoryServer_NumReservedGSNs);
+
+    return newGSN.gsn;
+}
+
+static void StartAccessoryServer(void) {
+    HAPAccessoryServerStart(&accessoryServer, &accessory);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Running);
+}
+
+static void StopAccessoryServer(void) {
+    HAPAccessoryServerStop(&accessoryServer);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Idle);
+}
+
+int main() {
+    HAPError err;
+    HAPPlatformCreate();
+
+    // Provision an admin pairing. Otherwise, the broadcast encryption key is removed when the accessory server starts.
+    HAPAccessoryServerLongTermSecretKey accessoryLTSK;
+    HAPPlatformRandomNumberFill(accessoryLTSK.bytes, sizeof accessoryLTSK.bytes);
+    err = HAPLegacyImportLongTermSecretKey(platform.keyValueStore, &accessoryLTSK);
+    HAPAssert(!err);
+    static const HAPControllerPairingIdentifier pairingIdentifier = { .bytes = "4E5D4B2F-6A3B-4C1D-9E8F-0A1B2C3D4E5F",
+                                                                      .numBytes = 36 };
+    HAPControllerPublicKey controllerLTPK;
+    HAPPlatformRandomNumberFill(controllerLTPK.bytes, sizeof controllerLTPK.bytes);
+    err = HAPLegacyImportControllerPairing(
+            platform.keyValueStore, 0, &pairingIdentifier, &controllerLTPK, /* isAdmin: */ true);
+    HAPAssert(!err);
+
+    // Prepare accessory server storage.
+    static HAPBLEGATTTableElementRef gattTableElements[kAttributeCount + 3];
+    static HAPBLESessionCacheElementRef sessionCacheElements[kHAPBLESessionCache_MinElements];
+    static HAPSessionRef session;
+    static uint8_t procedureBytes[2048];
+    static HAPBLEProcedureRef procedures[1];
+    static HAPBLEAccessoryServerStorage bleAccessoryServerStorage = {
+        .gattTableElements = gattTableElements,
+        .numGATTTableElements = HAPArrayCount(gattTableElements),
+        .sessionCacheElements = sessionCacheElements,
+        .numSessionCacheElements = HAPArrayCount(sessionCacheElements),
+        .session = &session,
+        .procedures = procedures,
+        .numProcedures = HAPArrayCount(procedures),
+        .procedureBuffer = { .bytes = procedureBytes, .numBytes = sizeof procedureBytes },
+    };
+
+    // Initialize accessory server.
+    HAPAccessoryServerCreate(
+            &accessoryServer,
+            &(const HAPAccessoryServerOptions) {
+                    .maxPairings = kHAPPairingStorage_MinElements,
+                    .ble = { .transport = &kHAPAccessoryServerTransport_BLE,
+                             .accessoryServerStorage = &bleAccessoryServerStorage,
+                             .preferredAdvertisingInterval = kHAPBLEAdvertisingInterval_Minimum,
+                             .preferredNotificationDuration = kHAPBLENotification_MinDuration } },
+            &platform,
+            &(const HAPAccessoryServerCallbacks) { .handleUpdatedState = HandleUpdatedAccessoryServerState },
+            /* context: */ NULL);
+
+    uint16_t persistedGSN;
+    uint8_t persistedFlags;
+
+    // A clean stop persists the exact GSN.
+    {
+        StartAccessoryServer();
+        HAPAssert(GetGSN().gsn == 1);
+        for (size_t i = 0; i < 3; i++) {
+            (void) IncrementGSN();
+        }
+        HAPAssert(GetGSN().gsn == 4);
+        GetPersistedGSN(&persistedGSN, &persistedFlags);
+        HAPAssert(persistedGSN == 1 + kHAPBLEAccessoryServer_NumReservedGSNs);
+
+        StopAccessoryServer();
+        GetPersistedGSN(&persistedGSN, &persistedFlags);
+        HAPAssert(persistedGSN == 4);
+        HAPAssert(persistedFlags == kGSNFlags_DidIncrement);
+
+        StartAccessoryServer();
+        HAPBLEAccessoryServerGSN gsn = GetGSN();
+        HAPAssert(gsn.gsn == 4);
+        HAPAssert(gsn.didIncrement);
+    }
+
+    // Recovery from the end of a reserved range never goes backwards.
+    {
+        uint16_t gsn = 0;
+        for (size_t i = 0; i < 3; i++) {
+            gsn = IncrementGSN();
+        }
+        HAPAssert(gsn == 7);
+
+        // Simulate a power loss: the GSN is not persisted when the accessory server stops.
+        uint16_t reservedGSN;
+        uint8_t reservedFlags;
+        GetPersistedGSN(&reservedGSN, &reservedFlags);
+        StopAccessoryServer();
+        SetPersistedGSN(reservedGSN, reservedFlags);
+
+        StartAccessoryServer();
+        HAPBLEAccessoryServerGSN recoveredGSN = GetGSN();
+        HAPAssert(recoveredGSN.gsn == 4 + kHAPBLEAccessoryServer_NumReservedGSNs);
+        HAPAssert(recoveredGSN.gsn > gsn);
+        HAPAssert(!recoveredGSN.didIncrement);
+
+        // Keep incrementing across several reserved ranges.
+        gsn = recoveredGSN.gsn;
+        for (size_t i = 0; i < 3 * kHAPBLEAccessoryServer_NumReservedGSNs; i++) {
+            uint16_t newGSN = IncrementGSN();
+            HAPAssert(newGSN > gsn);
+            gsn = newGSN;
+        }
+        StopAccessoryServer();
+    }
+
+    // Recovery wraps around from 65535 to 1.
+    {
+        SetPersistedGSN(UINT16_MAX - 1, kGSNFlags_DidIncrement | kGSNFlags_IsReserved);
+        StartAccessoryServer();
+        HAPAssert(GetGSN().gsn == UINT16_MAX - 1);
+        HAPAssert(IncrementGSN() == UINT16_MAX);
+        GetPersistedGSN(&persistedGSN, &persistedFlags);
+        HAPAssert(persistedGSN == kHAPBLEAccessoryServer_NumReservedGSNs - 1);
+        HAPAssert(IncrementGSN() == 1);
+        StopAccessoryServer();
+    }
+
+    // A broadcast encryption key whose expiration GSN falls in the skipped range is expired.
+    {
+        const struct {
+            uint16_t persistedGSN;
+            uint16_t keyExpirationGSN;
+            bool isExpired;
+        } testCases[] = {
+            { 100, 100 - kHAPBLEAccessoryServer_NumReservedGSNs + 1, true },
+            { 100, 90, true },
+            { 100, 99, true },
+            { 10, UINT16_MAX - 5, true },
+            // Expires on the next increment.
+            { 100, 100, false },
+            { 100, 101, false },
+            { 100, 100 - kHAPBLEAccessoryServer_NumReservedGSNs, false },
+        };
+        for (size_t i = 0; i < HAPArrayCount(testCases); i++) {
+            SetPersistedGSN(testCases[i].persistedGSN, kGSNFlags_DidIncrement | kGSNFlags_IsReserved);
+            SetPersistedBroadcastKey(testCases[i].keyExpirationGSN);
+
+            StartAccessoryServer();
+            HAPAssert(GetGSN().gsn == testCases[i].persistedGSN);
+            HAPAssert(GetKeyExpirationGSN() == (testCases[i].isExpired ? 0 : testCases[i].keyExpirationGSN));
+            StopAccessoryServer();
+        }
+
+        // A broadcast encryption key is not expired when the GSN was persisted by a clean stop.
+        SetPersistedGSN(100, kGSNFlags_DidIncrement);
+        SetPersistedBroadcastKey(90);
+        StartAccessoryServer();
+        HAPAssert(GetGSN().gsn == 100);
+        HAPAssert(GetKeyExpirationGSN() == 90);
+
+        // The broadcast encryption key expires when incrementing from its expiration GSN.
+        StopAccessoryServer();
+        SetPersistedBroadcastKey(100);
+        StartAccessoryServer();
+        HAPAssert(GetKeyExpirationGSN() == 100);
+        HAPAssert(IncrementGSN() == 101);
+        HAPAssert(!GetKeyExpirationGSN());
+        StopAccessoryServer();
+    }
+
+    // A connect / disconnect cycle without GSN increments is persisted by a clean stop.
+    {
+        SetPersistedGSN(200, kGSNFlags_DidIncrement);
+        StartAccessoryServer();
+        HAPAssert(GetGSN().didIncrement);
+        err = HAPBLEAccessoryServerDidConnect(&accessoryServer);
+        HAPAssert(!err);
+        err = HAPBLEAccessoryServerDidDisconnect(&accessoryServer);
+        HAPAssert(!err);
+        HAPAssert(!GetGSN().didIncrement);
+
+        StopAccessoryServer();
+        GetPersistedGSN(&persistedGSN, &persistedFlags);
+        HAPAssert(persistedGSN == 200);
+        HAPAssert(!persistedFlags);
+
+        // The first event after the restart increments the GSN.
+        StartAccessoryServer();
+        HAPBLEAccessoryServerGSN gsn = GetGSN();
+        HAPAssert(gsn.gsn == 200);
+        HAPAssert(!gsn.didIncrement);
+        StopAccessoryServer();
+    }
+
+    return 0;
+}
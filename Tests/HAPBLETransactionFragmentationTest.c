@@ -0,0 +1,294 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+// Writes and reads characteristic values of various lengths with the simulated central at the default and at a large
+// ATT MTU, and counts the ATT round trips that are needed to read the responses. Fragments that do not complete
+// a response must be sized so that they are transferred in whole "Read Response" and "Read Blob Response" operations.
+
+#include "HAP+Internal.h"
+#include "HAPPlatform+Init.h"
+#include "HAPPlatformBLEPeripheralManager+Init.h"
+
+#include "Harness/HAPBLECentral.c"
+#include "Harness/TemplateDB.c"
+
+#define kIID_LightBulb     ((uint64_t) 0x0030)
+#define kIID_LightBulbBlob ((uint64_t) 0x0031)
+
+static const HAPLogObject logObject = { .subsystem = kHAP_LogSubsystem, .category = "BLETransactionFragmentation" };
+
+/**
+ * Maximum length of the blob characteristic value.
+ */
+#define kMaxBlobBytes ((size_t) 4096)
+
+static struct {
+    uint8_t bytes[kMaxBlobBytes];
+    size_t numBytes;
+} blob;
+
+static void HandleUpdatedAccessoryServerState(HAPAccessoryServerRef* server, void* _Nullable context HAP_UNUSED) {
+    HAPPrecondition(server);
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError IdentifyAccessory(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPAccessoryIdentifyRequest* request HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleBlobRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPDataCharacteristicReadRequest* request HAP_UNUSED,
+        void* valueBytes,
+        size_t maxValueBytes,
+        size_t* numValueBytes,
+        void* _Nullable context HAP_UNUSED) {
+    HAPAssert(blob.numBytes <= maxValueBytes);
+    HAPRawBufferCopyBytes(valueBytes, blob.bytes, blob.numBytes);
+    *numValueBytes = blob.numBytes;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleBlobWrite(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPDataCharacteristicWriteRequest* request HAP_UNUSED,
+        const void* valueBytes,
+        size_t numValueBytes,
+        void* _Nullable context HAP_UNUSED) {
+    HAPAssert(numValueBytes <= sizeof blob.bytes);
+    HAPRawBufferCopyBytes(blob.bytes, valueBytes, numValueBytes);
+    blob.numBytes = numValueBytes;
+    return kHAPError_None;
+}
+
+/**
+ * Vendor-specific characteristic type of the blob characteristic.
+ */
+static const HAPUUID kCharacteristicType_Blob = {
+    { 0x00, 0x42, 0x4F, 0x4C, 0x42, 0x42, 0x4F, 0x4C, 0x42, 0x42, 0x4F, 0x4C, 0x01, 0x00, 0x00, 0x00 }
+};
+
+static const HAPDataCharacteristic lightBulbBlobCharacteristic = {
+    .format = kHAPCharacteristicFormat_Data,
+    .iid = kIID_LightBulbBlob,
+    .characteristicType = &kCharacteristicType_Blob,
+    .debugDescription = "blob",
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = true,
+                    .supportsEventNotification = false,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false, .supportsWriteResponse = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .constraints = { .maxLength = kMaxBlobBytes },
+    .callbacks = { .handleRead = HandleBlobRead, .handleWrite = HandleBlobWrite }
+};
+
+static const HAPService lightBulbService = {
+    .iid = kIID_LightBulb,
+    .serviceType = &kHAPServiceType_LightBulb,
+    .debugDescription = kHAPServiceDebugDescription_LightBulb,
+    .name = NULL,
+    .properties = { .primaryService = true, .hidden = false, .ble = { .supportsConfiguration = false } },
+    .linkedServices = NULL,
+    .characteristics = (const HAPCharacteristic* const[]) { &lightBulbBlobCharacteristic, NULL }
+};
+
+static const HAPAccessory accessory = { .aid = 1,
+                                        .category = kHAPAccessoryCategory_Lighting,
+                                        .name = "Acme Test",
+                                        .manufacturer = "Acme",
+                                        .model = "Test1,1",
+                                        .serialNumber = "099DB48E9E28",
+                                        .firmwareVersion = "1",
+                                        .hardwareVersion = "1",
+                                        .services = (const HAPService* const[]) { &accessoryInformationService,
+                                                                                  &hapProtocolInformationService,
+                                                                                  &pairingService,
+                                                                                  &lightBulbService,
+                                                                                  NULL },
+                                        .callbacks = { .identify = IdentifyAccessory } };
+
+int main() {
+    HAPError err;
+    HAPPlatformCreate();
+
+    HAPAssert(HAPBLEPDUGetMaxFragmentBytes(512, 23) == 505);
+    HAPAssert(HAPBLEPDUGetMaxFragmentBytes(512, 247) == 491);
+    HAPAssert(HAPBLEPDUGetMaxFragmentBytes(512, 517) == 512);
+    HAPAssert(HAPBLEPDUGetMaxFragmentBytes(20, 23) == 20);
+
+    // Provision accessory server and a paired controller.
+    static const HAPAccessoryServerDeviceID deviceID = { { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 } };
+    err = HAPLegacyImportDeviceID(platform.keyValueStore, &deviceID);
+    HAPAssert(!err);
+    HAPAccessoryServerLongTermSecretKey accessoryLTSK;
+    HAPPlatformRandomNumberFill(accessoryLTSK.bytes, sizeof accessoryLTSK.bytes);
+    err = HAPLegacyImportLongTermSecretKey(platform.keyValueStore, &accessoryLTSK);
+    HAPAssert(!err);
+    uint8_t accessoryLTPK[ED25519_PUBLIC_KEY_BYTES];
+    HAP_ed25519_public_key(accessoryLTPK, accessoryLTSK.bytes);
+
+    static const HAPControllerPairingIdentifier pairingIdentifier = {
+        .bytes = "4E5D4B2F-6A3B-4C1D-9E8F-0A1B2C3D4E5F", .numBytes = 36
+    };
+    uint8_t controllerLTSK[ED25519_SECRET_KEY_BYTES];
+    HAPPlatformRandomNumberFill(controllerLTSK, sizeof controllerLTSK);
+    HAPControllerPublicKey controllerLTPK;
+    HAP_ed25519_public_key(controllerLTPK.bytes, controllerLTSK);
+    err = HAPLegacyImportControllerPairing(
+            platform.keyValueStore, 0, &pairingIdentifier, &controllerLTPK, /* isAdmin: */ true);
+    HAPAssert(!err);
+
+    // Prepare accessory server storage. The procedure buffer holds the longest request and response bodies.
+    static HAPBLEGATTTableElementRef gattTableElements[kAttributeCount + 2];
+    static HAPBLESessionCacheElementRef sessionCacheElements[kHAPBLESessionCache_MinElements];
+    static HAPSessionRef session;
+    static uint8_t procedureBytes[2 * kMaxBlobBytes];
+    static HAPBLEProcedureRef procedures[1];
+    static HAPBLEAccessoryServerStorage bleAccessoryServerStorage = {
+        .gattTableElements = gattTableElements,
+        .numGATTTableElements = HAPArrayCount(gattTableElements),
+        .sessionCacheElements = sessionCacheElements,
+        .numSessionCacheElements = HAPArrayCount(sessionCacheElements),
+        .session = &session,
+        .procedures = procedures,
+        .numProcedures = HAPArrayCount(procedures),
+        .procedureBuffer = { .bytes = procedureBytes, .numBytes = sizeof procedureBytes },
+    };
+
+    // Initialize and start accessory server.
+    static HAPAccessoryServerRef accessoryServer;
+    HAPAccessoryServerCreate(
+            &accessoryServer,
+            &(const HAPAccessoryServerOptions) {
+                    .maxPairings = kHAPPairingStorage_MinElements,
+                    .ble = { .transport = &kHAPAccessoryServerTransport_BLE,
+                             .accessoryServerStorage = &bleAccessoryServerStorage,
+                             .preferredAdvertisingInterval = kHAPBLEAdvertisingInterval_Minimum,
+                             .preferredNotificationDuration = kHAPBLENotification_MinDuration } },
+            &platform,
+            &(const HAPAccessoryServerCallbacks) { .handleUpdatedState = HandleUpdatedAccessoryServerState },
+            /* context: */ NULL);
+    HAPAccessoryServerStart(&accessoryServer, &accessory);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Running);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) &accessoryServer;
+
+    static const uint16_t mtus[] = { kHAPPlatformBLEPeripheralManager_DefaultMTU, 247 };
+    static const size_t valueLengths[] = { 1, 100, 491, 512, 1000, kMaxBlobBytes };
+
+    size_t numTotalRoundTrips[HAPArrayCount(mtus)] = { 0 };
+    for (size_t i = 0; i < HAPArrayCount(mtus); i++) {
+        HAPBLECentral central;
+        HAPBLECentralCreate(
+                &central,
+                &(const HAPBLECentralOptions) { .blePeripheralManager = HAPNonnull(platform.ble.blePeripheralManager),
+                                                .pairingIdentifier = &pairingIdentifier,
+                                                .longTermSecretKey = controllerLTSK,
+                                                .accessoryLongTermPublicKey = accessoryLTPK });
+        err = HAPBLECentralConnect(&central, mtus[i]);
+        HAPAssert(!err);
+        HAPAssert(server->ble.connection.mtu == mtus[i]);
+
+        HAPBLECentralCharacteristic blobCharacteristic;
+        err = HAPBLECentralDiscoverCharacteristic(
+                &central, &kHAPServiceType_LightBulb, &kCharacteristicType_Blob, &blobCharacteristic);
+        HAPAssert(!err);
+        HAPAssert(blobCharacteristic.iid == kIID_LightBulbBlob);
+        err = HAPBLECentralPairVerify(&central);
+        HAPAssert(!err);
+
+        for (size_t j = 0; j < HAPArrayCount(valueLengths); j++) {
+            // Write a value. Requests are fragmented by the central and reassembled by the accessory server.
+            static uint8_t valueBytes[kMaxBlobBytes];
+            for (size_t k = 0; k < valueLengths[j]; k++) {
+                valueBytes[k] = (uint8_t)(i + j + k);
+            }
+            err = HAPBLECentralWriteCharacteristic(&central, &blobCharacteristic, valueBytes, valueLengths[j]);
+            HAPAssert(!err);
+            HAPAssert(blob.numBytes == valueLengths[j]);
+            HAPAssert(HAPRawBufferAreEqual(blob.bytes, valueBytes, valueLengths[j]));
+
+            // Read the value back.
+            HAPBLECentralStatistics before;
+            HAPBLECentralGetStatistics(&central, &before);
+            static uint8_t readBytes[kMaxBlobBytes];
+            size_t numReadBytes;
+            err = HAPBLECentralReadCharacteristic(
+                    &central, &blobCharacteristic, readBytes, sizeof readBytes, &numReadBytes);
+            HAPAssert(!err);
+            HAPAssert(numReadBytes == valueLengths[j]);
+            HAPAssert(HAPRawBufferAreEqual(readBytes, valueBytes, valueLengths[j]));
+            HAPBLECentralStatistics after;
+            HAPBLECentralGetStatistics(&central, &after);
+
+            size_t numFragments = after.numGATTReads - before.numGATTReads;
+            size_t numResponseBytes = after.numResponseBytes - before.numResponseBytes;
+            size_t numRoundTrips = after.numReadRoundTrips - before.numReadRoundTrips;
+            HAPLog(&logObject,
+                   "ATT MTU %3u, %4zu value bytes: %4zu response bytes in %2zu fragments, %3zu round trips.",
+                   mtus[i],
+                   valueLengths[j],
+                   numResponseBytes,
+                   numFragments,
+                   numRoundTrips);
+
+            // A fragment of k * (ATT_MTU - 1) - 1 bytes is read in k round trips. Only the final fragment may
+            // need one more round trip than its length requires.
+            size_t numATTValueBytes = (size_t)(mtus[i] - 1);
+            HAPAssert(numRoundTrips * numATTValueBytes <= numResponseBytes + numFragments + numATTValueBytes);
+            numTotalRoundTrips[i] += numRoundTrips;
+        }
+
+        HAPBLECentralDisconnect(&central);
+        HAPPlatformClockAdvance(0);
+    }
+
+    // A large ATT MTU must need substantially fewer round trips.
+    HAPAssert(numTotalRoundTrips[1] * 8 < numTotalRoundTrips[0]);
+
+    // ATT MTU updates that are reported after the central disconnected are ignored.
+    {
+        HAPBLECentral central;
+        HAPBLECentralCreate(
+                &central,
+                &(const HAPBLECentralOptions) { .blePeripheralManager = HAPNonnull(platform.ble.blePeripheralManager),
+                                                .pairingIdentifier = &pairingIdentifier,
+                                                .longTermSecretKey = controllerLTSK,
+                                                .accessoryLongTermPublicKey = accessoryLTPK });
+        err = HAPBLECentralConnect(&central, kHAPPlatformBLEPeripheralManager_DefaultMTU);
+        HAPAssert(!err);
+        HAPPlatformBLEPeripheralManagerConnectionHandle connectionHandle = server->ble.connection.connectionHandle;
+        HAPBLECentralDisconnect(&central);
+        HAPPlatformClockAdvance(0);
+        HAPAssert(!server->ble.connection.connected);
+
+        HAPPlatformBLEPeripheralManagerRef blePeripheralManager = HAPNonnull(platform.ble.blePeripheralManager);
+        HAPAssert(blePeripheralManager->delegate.handleUpdatedMTU);
+        blePeripheralManager->delegate.handleUpdatedMTU(
+                blePeripheralManager, connectionHandle, 247, blePeripheralManager->delegate.context);
+        HAPAssert(!server->ble.connection.connected);
+
+        err = HAPBLECentralConnect(&central, kHAPPlatformBLEPeripheralManager_DefaultMTU);
+        HAPAssert(!err);
+        HAPAssert(server->ble.connection.mtu == kHAPPlatformBLEPeripheralManager_DefaultMTU);
+        HAPBLECentralDisconnect(&central);
+        HAPPlatformClockAdvance(0);
+    }
+
+    return 0;
+}
@@ -0,0 +1,66 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAP+Internal.h"
+
+int main() {
+    // Fixed-size bit set.
+    {
+        uint8_t bitSet[HAPBitSetGetNumBytes(20)];
+        HAPRawBufferZero(bitSet, sizeof bitSet);
+        HAPAssert(sizeof bitSet == 3);
+
+        HAPBitSetInsert(bitSet, 0);
+        HAPBitSetInsert(bitSet, 19);
+        HAPAssert(HAPBitSetContains(bitSet, 0));
+        HAPAssert(!HAPBitSetContains(bitSet, 1));
+        HAPAssert(HAPBitSetContains(bitSet, 19));
+        HAPAssert(bitSet[0] == 0x01 && bitSet[2] == 0x08);
+
+        HAPBitSetRemove(bitSet, 0);
+        HAPAssert(!HAPBitSetContains(bitSet, 0));
+        HAPAssert(HAPBitSetGetCount(bitSet, sizeof bitSet) == 1);
+    }
+
+    // Large bit set, scanned across word boundaries.
+    {
+        static const size_t bitIndexes[] = { 3, 63, 64, 65, 200, 511, 512, 1000, 2047, 2049 };
+        uint8_t bitSet[HAPBitSetGetNumBytes(2050)];
+        HAPRawBufferZero(bitSet, sizeof bitSet);
+
+        size_t bitIndex = 0;
+        HAPAssert(!HAPBitSetFindNext(bitSet, sizeof bitSet, &bitIndex));
+        HAPAssert(HAPBitSetGetCount(bitSet, sizeof bitSet) == 0);
+
+        for (size_t i = 0; i < HAPArrayCount(bitIndexes); i++) {
+            HAPBitSetInsertBit(bitSet, sizeof bitSet, bitIndexes[i]);
+        }
+        HAPAssert(HAPBitSetGetCount(bitSet, sizeof bitSet) == HAPArrayCount(bitIndexes));
+
+        size_t i = 0;
+        for (bitIndex = 0; HAPBitSetFindNext(bitSet, sizeof bitSet, &bitIndex); bitIndex++) {
+            HAPAssert(i < HAPArrayCount(bitIndexes));
+            HAPAssert(bitIndex == bitIndexes[i]);
+            HAPAssert(HAPBitSetContainsBit(bitSet, sizeof bitSet, bitIndex));
+            i++;
+        }
+        HAPAssert(i == HAPArrayCount(bitIndexes));
+
+        // Search starting in the middle of a byte.
+        bitIndex = 66;
+        HAPAssert(HAPBitSetFindNext(bitSet, sizeof bitSet, &bitIndex));
+        HAPAssert(bitIndex == 200);
+        bitIndex = 2050;
+        HAPAssert(!HAPBitSetFindNext(bitSet, sizeof bitSet, &bitIndex));
+
+        HAPBitSetRemoveBit(bitSet, sizeof bitSet, 2049);
+        bitIndex = 2048;
+        HAPAssert(!HAPBitSetFindNext(bitSet, sizeof bitSet, &bitIndex));
+        HAPAssert(HAPBitSetGetCount(bitSet, sizeof bitSet) == HAPArrayCount(bitIndexes) - 1);
+    }
+
+    return 0;
+}
@@ -42,8 +42,21 @@ static const uint8_t ed25519_sig[] = {
         uint8_t s[ED25519_BYTES]; \
         HAP_ed25519_sign(s, m, sizeof m, sk, pk); \
         HAPAssert(!memcmp(s, sig, ED25519_BYTES)); \
+        HAP_ed25519_sign_ctx ctx; \
+        HAP_ed25519_sign_init(&ctx, sk, pk); \
+        for (int i = 0; i < 2; i++) { \
+            HAPRawBufferZero(s, sizeof s); \
+            HAP_ed25519_sign_with_ctx(s, &ctx, m, sizeof m); \
+            HAPAssert(!memcmp(s, sig, ED25519_BYTES)); \
+        } \
+        HAP_ed25519_sign_done(&ctx); \
         HAPAssert(!HAP_ed25519_verify(sig, m, sizeof m, pk)); \
+        HAP_ed25519_verify_ctx verifyCtx; \
+        HAPAssert(!HAP_ed25519_verify_init(&verifyCtx, pk)); \
+        HAPAssert(!HAP_ed25519_verify_with_ctx(sig, m, sizeof m, &verifyCtx)); \
         s[0] ^= 1; \
+        HAPAssert(HAP_ed25519_verify_with_ctx(s, m, sizeof m, &verifyCtx) == -1); \
+        HAP_ed25519_verify_done(&verifyCtx); \
         HAPAssert(HAP_ed25519_verify(s, m, sizeof m, pk) == -1); \
         p[0] ^= 1; \
         HAPAssert(HAP_ed25519_verify(s, m, sizeof m, p) == -1); \
@@ -122,6 +135,26 @@ static const uint8_t chacha20_poly1305_ct[] = {
     0xbc, 0x3f, 0xf4, 0xde, 0xf0, 0x8e, 0x4b, 0x7a, 0x9d, 0xe5, 0x76, 0xd2, 0x65, 0x86, 0xce, 0xc6, 0x4b, 0x61, 0x16,
 };
 
+// Same key, AAD and plaintext with a 64-bit nonce, as used by HAP sessions.
+// The nonce is equivalent to the 96-bit nonce 00 00 00 00 40 41 42 43 44 45 46 47.
+
+static const uint8_t chacha20_poly1305_short_nonce[] = {
+    0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47,
+};
+
+static const uint8_t chacha20_poly1305_short_nonce_tag[] = {
+    0x2d, 0xbf, 0x18, 0x9b, 0x66, 0x8b, 0xd4, 0x30, 0xae, 0xf9, 0x14, 0x7e, 0x99, 0xcb, 0x6c, 0x89,
+};
+
+static const uint8_t chacha20_poly1305_short_nonce_ct[] = {
+    0xa4, 0x79, 0xcb, 0x54, 0x62, 0x89, 0x46, 0xd6, 0xf4, 0x04, 0x2a, 0x8e, 0x38, 0x4e, 0xf4, 0xbd, 0x2f, 0xbc, 0x73,
+    0x30, 0xb8, 0xbe, 0x55, 0xeb, 0x2d, 0x8d, 0xc1, 0x8a, 0xaa, 0x51, 0xd6, 0x6a, 0x8e, 0xc1, 0xf8, 0xd3, 0x61, 0x9a,
+    0x25, 0x8d, 0xb0, 0xac, 0x56, 0x95, 0x60, 0x15, 0xb7, 0xb4, 0x93, 0x7e, 0x9b, 0x8e, 0x6a, 0xa9, 0x57, 0xb3, 0xdc,
+    0x02, 0x14, 0xd8, 0x03, 0xd7, 0x76, 0x60, 0xaa, 0xbc, 0x91, 0x30, 0x92, 0x97, 0x1d, 0xa8, 0xf2, 0x07, 0x17, 0x1c,
+    0xe7, 0x84, 0x36, 0x08, 0x16, 0x2e, 0x2e, 0x75, 0x9d, 0x8e, 0xfc, 0x25, 0xd8, 0xd0, 0x93, 0x69, 0x90, 0xaf, 0x63,
+    0xc8, 0x20, 0xba, 0x87, 0xe8, 0xa9, 0x55, 0xb5, 0xc8, 0x27, 0x4e, 0xf7, 0xd1, 0x0f, 0x6f, 0xaf, 0xd0, 0x46, 0x47,
+};
+
 #define test_chacha20_poly1305(key, nonce, pt, aad, tag, ct) \
     { \
         uint8_t t[CHACHA20_POLY1305_TAG_BYTES]; \
@@ -494,6 +527,13 @@ int main() {
             chacha20_poly1305_aad,
             chacha20_poly1305_tag,
             chacha20_poly1305_ct);
+    test_chacha20_poly1305(
+            chacha20_poly1305_key,
+            chacha20_poly1305_short_nonce,
+            chacha20_poly1305_pt,
+            chacha20_poly1305_aad,
+            chacha20_poly1305_short_nonce_tag,
+            chacha20_poly1305_short_nonce_ct);
 #if HAP_IP
     test_chacha20_poly1305_inc(
             chacha20_poly1305_key,
@@ -502,6 +542,13 @@ int main() {
             chacha20_poly1305_aad,
             chacha20_poly1305_tag,
             chacha20_poly1305_ct);
+    test_chacha20_poly1305_inc(
+            chacha20_poly1305_key,
+            chacha20_poly1305_short_nonce,
+            chacha20_poly1305_pt,
+            chacha20_poly1305_aad,
+            chacha20_poly1305_short_nonce_tag,
+            chacha20_poly1305_short_nonce_ct);
 #endif
     test_srp(srp_salt, srp_user, srp_pass, srp_v, srp_A, srp_b, srp_B, srp_u, srp_S, srp_k, srp_m1, srp_m2);
     test_hash(HAP_sha1, sha_text, sha1_hash);
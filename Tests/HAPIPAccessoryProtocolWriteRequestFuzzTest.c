@@ -0,0 +1,200 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+// Cross-checks the structural index based request parsers against the util_json_reader based reference parsers.
+
+#include "HAP+Internal.h"
+
+#define kNumIterations ((size_t) 200000)
+
+static const char* const kSeeds[] = {
+    "{\"characteristics\":[{\"aid\":2,\"iid\":6,\"value\":1},{\"aid\":2,\"iid\":7,\"value\":3}],\"pid\":11122333}",
+    "{ \"characteristics\" : [ { \"aid\" : 1 , \"iid\" : 9 , \"ev\" : true } ] }\n",
+    "{\"characteristics\":[{\"aid\":1,\"iid\":9,\"value\":-12.5e-3,\"r\":1,\"remote\":false}]}",
+    "{\"characteristics\":[{\"aid\":1,\"iid\":9,\"value\":\"a\\\"b\\\\c\\u00e4\",\"authData\":\"x\\/y\"}]}",
+    "{\"characteristics\":[{\"aid\":18446744073709551615,\"iid\":1,\"value\":-2147483648,\"ev\":0}]}",
+    "{\"x\":{\"y\":[1,{\"z\":null},[true,false]]},\"characteristics\":[{\"aid\":1,\"iid\":2,\"q\":[[]]}]}",
+    "{\"ttl\":2500,\"pid\":11122333}",
+    "{ \"pid\" : 1 , \"other\" : { \"a\" : [ 1 , 2 ] } , \"ttl\" : 9007199254740991 }",
+};
+
+static const char kInterestingBytes[] = "{}[]:,\"\\ \t\r\n0123456789-+.eEtruefalsn\x01\x7F\xC3\xA4";
+
+static uint64_t randomState = 0x853C49E6748FEA9BULL;
+
+static uint32_t GetRandomNumber(uint32_t bound) {
+    HAPPrecondition(bound);
+
+    // xorshift64*.
+    randomState ^= randomState >> 12;
+    randomState ^= randomState << 25;
+    randomState ^= randomState >> 27;
+    return (uint32_t)((randomState * 0x2545F4914F6CDD1DULL) >> 32) % bound;
+}
+
+/**
+ * Mutates a request in place.
+ *
+ * @return Length of the mutated request.
+ */
+static size_t MutateRequest(char* bytes, size_t numBytes, size_t maxBytes) {
+    HAPPrecondition(bytes);
+    HAPPrecondition(numBytes <= maxBytes);
+
+    size_t numMutations = 1 + GetRandomNumber(4);
+    for (size_t i = 0; i < numMutations; i++) {
+        char byte = kInterestingBytes[GetRandomNumber(sizeof kInterestingBytes - 1)];
+        size_t position = numBytes ? GetRandomNumber((uint32_t) numBytes) : 0;
+        switch (GetRandomNumber(5)) {
+            case 0: {
+                // Replace.
+                if (numBytes) {
+                    bytes[position] = byte;
+                }
+            } break;
+            case 1: {
+                // Insert.
+                if (numBytes < maxBytes) {
+                    HAPRawBufferCopyBytes(&bytes[position + 1], &bytes[position], numBytes - position);
+                    bytes[position] = byte;
+                    numBytes++;
+                }
+            } break;
+            case 2: {
+                // Delete.
+                if (numBytes) {
+                    HAPRawBufferCopyBytes(&bytes[position], &bytes[position + 1], numBytes - position - 1);
+                    numBytes--;
+                }
+            } break;
+            case 3: {
+                // Truncate.
+                numBytes = position;
+            } break;
+            case 4: {
+                // Duplicate a chunk.
+                size_t numChunkBytes = GetRandomNumber(16);
+                if (numChunkBytes > numBytes - position) {
+                    numChunkBytes = numBytes - position;
+                }
+                if (numBytes + numChunkBytes <= maxBytes) {
+                    HAPRawBufferCopyBytes(&bytes[position + numChunkBytes], &bytes[position], numBytes - position);
+                    numBytes += numChunkBytes;
+                }
+            } break;
+        }
+    }
+    return numBytes;
+}
+
+static void CompareWriteRequests(const char* request, size_t numRequestBytes, size_t maxWriteContexts) {
+    HAPPrecondition(request);
+
+    char bytes[2][512];
+    HAPPrecondition(numRequestBytes <= sizeof bytes[0]);
+    HAPIPWriteContextRef writeContexts[2][8];
+    HAPPrecondition(maxWriteContexts <= HAPArrayCount(writeContexts[0]));
+    size_t numWriteContexts[2];
+    bool hasPID[2];
+    uint64_t pid[2];
+    HAPError err[2];
+
+    HAPRawBufferCopyBytes(bytes[0], request, numRequestBytes);
+    HAPRawBufferCopyBytes(bytes[1], request, numRequestBytes);
+    err[0] = HAPIPAccessoryProtocolGetCharacteristicWriteRequests(
+            bytes[0], numRequestBytes, writeContexts[0], maxWriteContexts, &numWriteContexts[0], &hasPID[0], &pid[0]);
+    err[1] = HAPIPAccessoryProtocolGetCharacteristicWriteRequestsWithJSONReader(
+            bytes[1], numRequestBytes, writeContexts[1], maxWriteContexts, &numWriteContexts[1], &hasPID[1], &pid[1]);
+    if (err[0] != err[1]) {
+        HAPLogBufferError(&kHAPLog_Default, request, numRequestBytes, "Result mismatch: %u != %u.", err[0], err[1]);
+        HAPFatalError();
+    }
+    if (err[0]) {
+        return;
+    }
+    HAPAssert(numWriteContexts[0] == numWriteContexts[1]);
+    HAPAssert(hasPID[0] == hasPID[1]);
+    HAPAssert(pid[0] == pid[1]);
+    for (size_t i = 0; i < numWriteContexts[0]; i++) {
+        const HAPIPWriteContext* a = (const HAPIPWriteContext*) &writeContexts[0][i];
+        const HAPIPWriteContext* b = (const HAPIPWriteContext*) &writeContexts[1][i];
+        HAPAssert(a->aid == b->aid);
+        HAPAssert(a->iid == b->iid);
+        HAPAssert(a->type == b->type);
+        switch (a->type) {
+            case kHAPIPWriteValueType_None: {
+            } break;
+            case kHAPIPWriteValueType_Int: {
+                HAPAssert(a->value.intValue == b->value.intValue);
+            } break;
+            case kHAPIPWriteValueType_UInt: {
+                HAPAssert(a->value.unsignedIntValue == b->value.unsignedIntValue);
+            } break;
+            case kHAPIPWriteValueType_Float: {
+                HAPAssert(HAPFloatGetBitPattern(a->value.floatValue) == HAPFloatGetBitPattern(b->value.floatValue));
+            } break;
+            case kHAPIPWriteValueType_String: {
+                HAPAssert(a->value.stringValue.bytes - bytes[0] == b->value.stringValue.bytes - bytes[1]);
+                HAPAssert(a->value.stringValue.numBytes == b->value.stringValue.numBytes);
+                HAPAssert(HAPRawBufferAreEqual(
+                        HAPNonnull(a->value.stringValue.bytes),
+                        HAPNonnull(b->value.stringValue.bytes),
+                        a->value.stringValue.numBytes));
+            } break;
+        }
+        HAPAssert(!a->authorizationData.bytes == !b->authorizationData.bytes);
+        if (a->authorizationData.bytes) {
+            HAPAssert(a->authorizationData.bytes - bytes[0] == b->authorizationData.bytes - bytes[1]);
+            HAPAssert(a->authorizationData.numBytes == b->authorizationData.numBytes);
+            HAPAssert(HAPRawBufferAreEqual(
+                    HAPNonnull(a->authorizationData.bytes),
+                    HAPNonnull(b->authorizationData.bytes),
+                    a->authorizationData.numBytes));
+        }
+        HAPAssert(a->ev == b->ev);
+        HAPAssert(a->remote == b->remote);
+        HAPAssert(a->response == b->response);
+    }
+}
+
+static void CompareWritePreparations(const char* request, size_t numRequestBytes) {
+    HAPPrecondition(request);
+
+    uint64_t ttl[2];
+    uint64_t pid[2];
+    HAPError err[2];
+
+    err[0] = HAPIPAccessoryProtocolGetCharacteristicWritePreparation(request, numRequestBytes, &ttl[0], &pid[0]);
+    err[1] = HAPIPAccessoryProtocolGetCharacteristicWritePreparationWithJSONReader(
+            request, numRequestBytes, &ttl[1], &pid[1]);
+    if (err[0] != err[1]) {
+        HAPLogBufferError(&kHAPLog_Default, request, numRequestBytes, "Result mismatch: %u != %u.", err[0], err[1]);
+        HAPFatalError();
+    }
+    if (!err[0]) {
+        HAPAssert(ttl[0] == ttl[1]);
+        HAPAssert(pid[0] == pid[1]);
+    }
+}
+
+int main() {
+    char request[512];
+
+    for (size_t i = 0; i < kNumIterations; i++) {
+        const char* seed = kSeeds[i % HAPArrayCount(kSeeds)];
+        size_t numRequestBytes = HAPStringGetNumBytes(seed);
+        HAPAssert(numRequestBytes <= sizeof request);
+        HAPRawBufferCopyBytes(request, seed, numRequestBytes);
+        if (i >= HAPArrayCount(kSeeds)) {
+            numRequestBytes = MutateRequest(request, numRequestBytes, sizeof request);
+        }
+
+        CompareWriteRequests(request, numRequestBytes, 1 + i % 3);
+        CompareWritePreparations(request, numRequestBytes);
+    }
+
+    return 0;
+}
@@ -0,0 +1,311 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+// Checks that open IP sessions survive replacing the bridged accessories of a running bridge.
+// Event notification subscriptions and pending event notifications of kept accessories are preserved,
+// subscriptions of removed accessories are ended, and the session activity lists stay ordered.
+
+#include "HAP+Internal.h"
+#include "HAPPlatform+Init.h"
+
+#include "Harness/HAPIPController.c"
+#include "Harness/HAPIPTestStorage.c"
+#include "Harness/LightBulbDB.c"
+#include "Harness/TemplateDB.c"
+
+/**
+ * Maximum number of characteristics of the bridge, including the bridged accessories.
+ */
+#define kMaxCharacteristics ((size_t) 64)
+
+static bool isIdle;
+
+static void HandleUpdatedAccessoryServerState(HAPAccessoryServerRef* server, void* _Nullable context HAP_UNUSED) {
+    HAPPrecondition(server);
+
+    isIdle = HAPAccessoryServerGetState(server) == kHAPAccessoryServerState_Idle;
+}
+
+static HAPAccessoryServerRef accessoryServer;
+
+static const HAPControllerPairingIdentifier pairingIdentifier = { .bytes = "4E5D4B2F-6A3B-4C1D-9E8F-0A1B2C3D4E5F",
+                                                                  .numBytes = 36 };
+static uint8_t controllerLTSK[ED25519_SECRET_KEY_BYTES];
+static uint8_t accessoryLTPK[ED25519_PUBLIC_KEY_BYTES];
+
+static char responseBytes[1024];
+static size_t numResponseBytes;
+
+/**
+ * Connects a simulated controller to the accessory server and verifies the pairing.
+ *
+ * @param[out] controller           Simulated controller.
+ */
+static void Connect(HAPIPController* controller) {
+    HAPPrecondition(controller);
+
+    HAPError err;
+
+    HAPIPControllerCreate(
+            controller,
+            &(const HAPIPControllerOptions) { .tcpStreamManager = HAPNonnull(platform.ip.tcpStreamManager),
+                                              .pairingIdentifier = &pairingIdentifier,
+                                              .longTermSecretKey = controllerLTSK,
+                                              .accessoryLongTermPublicKey = accessoryLTPK });
+    err = HAPIPControllerConnect(controller);
+    HAPAssert(!err);
+    err = HAPIPControllerPairVerify(controller);
+    HAPAssert(!err);
+}
+
+/**
+ * Reads the On characteristic of the primary light bulb.
+ *
+ * @param      controller           Simulated controller.
+ */
+static void ReadOn(HAPIPController* controller) {
+    HAPPrecondition(controller);
+
+    HAPError err;
+
+    unsigned int status;
+    err = HAPIPControllerPerformRequest(
+            controller,
+            "GET",
+            "/characteristics?id=2.49",
+            /* contentType: */ NULL,
+            /* requestBodyBytes: */ NULL,
+            0,
+            &status,
+            responseBytes,
+            sizeof responseBytes,
+            &numResponseBytes);
+    HAPAssert(!err);
+    HAPAssert(status == 200);
+}
+
+/**
+ * Writes characteristics with PUT /characteristics.
+ *
+ * @param      controller           Simulated controller.
+ * @param      requestBody          Request body.
+ */
+static void WriteCharacteristics(HAPIPController* controller, const char* requestBody) {
+    HAPPrecondition(controller);
+    HAPPrecondition(requestBody);
+
+    HAPError err;
+
+    unsigned int status;
+    err = HAPIPControllerPerformRequest(
+            controller,
+            "PUT",
+            "/characteristics",
+            "application/hap+json",
+            requestBody,
+            HAPStringGetNumBytes(requestBody),
+            &status,
+            responseBytes,
+            sizeof responseBytes,
+            &numResponseBytes);
+    HAPAssert(!err);
+    HAPAssert(status == 204);
+}
+
+/**
+ * Lets the accessory server deliver pending event notifications and receives the next one.
+ *
+ * @param      controller           Simulated controller.
+ *
+ * @return true                     If an event notification was received. Its body is stored in responseBytes.
+ * @return false                    If no event notification was sent.
+ */
+HAP_RESULT_USE_CHECK
+static bool ReceiveEvent(HAPIPController* controller) {
+    HAPPrecondition(controller);
+
+    HAPError err;
+
+    HAPPlatformClockAdvance(1 * HAPSecond);
+    err = HAPIPControllerReceiveEvent(controller, responseBytes, sizeof responseBytes, &numResponseBytes);
+    if (err) {
+        HAPAssert(err == kHAPError_InvalidState);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Checks whether the last received body contains a string.
+ *
+ * @param      string               String to search for.
+ *
+ * @return true                     If the last received body contains the string.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool ResponseContainsString(const char* string) {
+    HAPPrecondition(string);
+
+    size_t numStringBytes = HAPStringGetNumBytes(string);
+    for (size_t i = 0; i + numStringBytes <= numResponseBytes; i++) {
+        if (HAPRawBufferAreEqual(&responseBytes[i], string, numStringBytes)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Checks that a session activity list is consistent and contains the sessions of the given controllers,
+ * ordered from least recently active to most recently active.
+ *
+ * @param      list                 Session activity list.
+ * @param      controllers          Simulated controllers in expected order, terminated by NULL.
+ */
+static void ExpectActivityList(const HAPIPSessionActivityList* list, HAPIPController* _Nullable const* controllers) {
+    HAPPrecondition(list);
+    HAPPrecondition(controllers);
+
+    const HAPIPSession* _Nullable prevSession = NULL;
+    HAPTime prevStamp = 0;
+    const HAPIPSession* _Nullable ipSession = list->head;
+    size_t i;
+    for (i = 0; controllers[i]; i++) {
+        HAPAssert(ipSession);
+        const HAPIPSessionDescriptor* session = (const HAPIPSessionDescriptor*) &HAPNonnull(ipSession)->descriptor;
+        HAPAssert(session->server == &accessoryServer);
+        HAPAssert(session->tcpStream == HAPIPControllerGetTCPStream(HAPNonnull(controllers[i])));
+        HAPAssert(session->prevActiveSession == prevSession);
+        HAPAssert(session->stamp >= prevStamp);
+        prevSession = ipSession;
+        prevStamp = session->stamp;
+        ipSession = session->nextActiveSession;
+    }
+    HAPAssert(!ipSession);
+    HAPAssert(list->tail == prevSession);
+}
+
+int main() {
+    HAPError err;
+    HAPPlatformCreate();
+
+    // Provision accessory server and a controller. All simulated controllers share the same pairing.
+    static const HAPAccessoryServerDeviceID deviceID = { { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 } };
+    err = HAPLegacyImportDeviceID(platform.keyValueStore, &deviceID);
+    HAPAssert(!err);
+    HAPAccessoryServerLongTermSecretKey accessoryLTSK;
+    HAPPlatformRandomNumberFill(accessoryLTSK.bytes, sizeof accessoryLTSK.bytes);
+    err = HAPLegacyImportLongTermSecretKey(platform.keyValueStore, &accessoryLTSK);
+    HAPAssert(!err);
+    HAP_ed25519_public_key(accessoryLTPK, accessoryLTSK.bytes);
+    HAPPlatformRandomNumberFill(controllerLTSK, sizeof controllerLTSK);
+    HAPControllerPublicKey controllerLTPK;
+    HAP_ed25519_public_key(controllerLTPK.bytes, controllerLTSK);
+    err = HAPLegacyImportControllerPairing(
+            platform.keyValueStore, 0, &pairingIdentifier, &controllerLTPK, /* isAdmin: */ true);
+    HAPAssert(!err);
+
+    // Prepare accessory server storage.
+    static HAPIPAccessoryServerStorage ipAccessoryServerStorage;
+    HAPIPTestStorageCreate(
+            &ipAccessoryServerStorage,
+            &(const HAPIPTestStorageOptions) { .numSessions = kHAPIPSessionStorage_DefaultNumElements,
+                                               .maxCharacteristics = kMaxCharacteristics });
+
+    // Initialize and start accessory server with two bridged light bulbs.
+    HAPAccessoryServerCreate(
+            &accessoryServer,
+            &(const HAPAccessoryServerOptions) {
+                    .maxPairings = kHAPPairingStorage_MinElements,
+                    .ip = { .transport = &kHAPAccessoryServerTransport_IP,
+                            .accessoryServerStorage = &ipAccessoryServerStorage } },
+            &platform,
+            &(const HAPAccessoryServerCallbacks) { .handleUpdatedState = HandleUpdatedAccessoryServerState },
+            /* context: */ NULL);
+    const HAPAccessory* _Nullable oneLightBulb[] = { &bridgedLightBulbAccessory, NULL };
+    const HAPAccessory* _Nullable twoLightBulbs[] = { &bridgedLightBulbAccessory,
+                                                      &secondBridgedLightBulbAccessory,
+                                                      NULL };
+    HAPAccessoryServerStartBridge(&accessoryServer, &bridgeAccessory, twoLightBulbs, /* configurationChanged: */ false);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Running);
+    const HAPAccessoryServer* server = (const HAPAccessoryServer*) &accessoryServer;
+
+    // Controller a subscribes only to the second light bulb, controller b subscribes to both light bulbs,
+    // and controller c, which was active most recently, has no subscriptions.
+    static HAPIPController a, b, c;
+    Connect(&a);
+    WriteCharacteristics(&a, "{\"characteristics\":[{\"aid\":3,\"iid\":49,\"ev\":true}]}");
+    HAPPlatformClockAdvance(1 * HAPSecond);
+    Connect(&b);
+    WriteCharacteristics(
+            &b,
+            "{\"characteristics\":["
+            "{\"aid\":2,\"iid\":49,\"ev\":true},"
+            "{\"aid\":3,\"iid\":49,\"ev\":true}]}");
+    HAPPlatformClockAdvance(1 * HAPSecond);
+    Connect(&c);
+    ReadOn(&c);
+    ExpectActivityList(&server->ip.unsubscribedSessions, (HAPIPController* const[]) { &c, NULL });
+    ExpectActivityList(&server->ip.subscribedSessions, (HAPIPController* const[]) { &a, &b, NULL });
+
+    // Raise events on both light bulbs but replace the bridged accessories before they are delivered.
+    HAPAccessoryServerRaiseEvent(
+            &accessoryServer, &lightBulbOnCharacteristic, &lightBulbService, &bridgedLightBulbAccessory);
+    HAPAccessoryServerRaiseEvent(
+            &accessoryServer, &lightBulbOnCharacteristic, &lightBulbService, &secondBridgedLightBulbAccessory);
+    err = HAPAccessoryServerUpdateBridgedAccessories(&accessoryServer, oneLightBulb);
+    HAPAssert(!err);
+
+    // Controller a lost its only subscription. Its session moves to the unsubscribed sessions
+    // and is ordered by its last activity, i.e., before the more recently active session of controller c.
+    ExpectActivityList(&server->ip.unsubscribedSessions, (HAPIPController* const[]) { &a, &c, NULL });
+    ExpectActivityList(&server->ip.subscribedSessions, (HAPIPController* const[]) { &b, NULL });
+
+    // The pending event of the kept light bulb is delivered. The one of the removed light bulb is dropped.
+    HAPAssert(ReceiveEvent(&b));
+    HAPAssert(ResponseContainsString("{\"aid\":2,\"iid\":49,\"value\":1}"));
+    HAPAssert(!ResponseContainsString("\"aid\":3"));
+    HAPAssert(!ReceiveEvent(&b));
+    HAPAssert(!ReceiveEvent(&a));
+    HAPAssert(!ReceiveEvent(&c));
+
+    // Subscriptions to the kept light bulb survive.
+    HAPAccessoryServerRaiseEvent(
+            &accessoryServer, &lightBulbOnCharacteristic, &lightBulbService, &bridgedLightBulbAccessory);
+    HAPAssert(ReceiveEvent(&b));
+    HAPAssert(ResponseContainsString("{\"aid\":2,\"iid\":49,\"value\":1}"));
+    HAPAssert(!ReceiveEvent(&a));
+
+    // Subscriptions to the removed light bulb are not restored when it is added again.
+    err = HAPAccessoryServerUpdateBridgedAccessories(&accessoryServer, twoLightBulbs);
+    HAPAssert(!err);
+    HAPAccessoryServerRaiseEvent(
+            &accessoryServer, &lightBulbOnCharacteristic, &lightBulbService, &secondBridgedLightBulbAccessory);
+    HAPAssert(!ReceiveEvent(&a));
+    HAPAssert(!ReceiveEvent(&b));
+    ExpectActivityList(&server->ip.subscribedSessions, (HAPIPController* const[]) { &b, NULL });
+
+    // All sessions stay open.
+    ReadOn(&a);
+    ReadOn(&b);
+    ReadOn(&c);
+    ExpectActivityList(&server->ip.unsubscribedSessions, (HAPIPController* const[]) { &a, &c, NULL });
+    ExpectActivityList(&server->ip.subscribedSessions, (HAPIPController* const[]) { &b, NULL });
+
+    // Stop accessory server.
+    HAPIPControllerDisconnect(&a);
+    HAPIPControllerDisconnect(&b);
+    HAPIPControllerDisconnect(&c);
+    HAPAccessoryServerStop(&accessoryServer);
+    while (!isIdle) {
+        HAPPlatformClockAdvance(0);
+    }
+    HAPAccessoryServerRelease(&accessoryServer);
+
+    return 0;
+}
@@ -0,0 +1,617 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+// Checks that reads of characteristics with the ip.cacheable property are served from the value cache,
+// that writes and raised events invalidate or update the cached value, and that read permissions are still enforced.
+
+#include "HAP+Internal.h"
+#include "HAPPlatform+Init.h"
+
+#include "Harness/HAPIPController.c"
+#include "Harness/HAPIPTestStorage.c"
+#include "Harness/TemplateDB.c"
+
+#define kIID_LightBulb           ((uint64_t) 0x0030)
+#define kIID_LightBulbOn         ((uint64_t) 0x0031)
+#define kIID_LightBulbBrightness ((uint64_t) 0x0032)
+#define kIID_LightBulbName       ((uint64_t) 0x0033)
+#define kIID_LightBulbToken      ((uint64_t) 0x0034)
+#define kIID_LightBulbHue        ((uint64_t) 0x0035)
+
+/**
+ * Maximum number of characteristics of the accessory.
+ */
+#define kMaxCharacteristics ((size_t) 32)
+
+static bool isIdle;
+
+static void HandleUpdatedAccessoryServerState(HAPAccessoryServerRef* server, void* _Nullable context HAP_UNUSED) {
+    HAPPrecondition(server);
+
+    isIdle = HAPAccessoryServerGetState(server) == kHAPAccessoryServerState_Idle;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError IdentifyAccessory(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPAccessoryIdentifyRequest* request HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    return kHAPError_None;
+}
+
+/**
+ * State of the light bulb, and number of read handler invocations.
+ */
+static struct {
+    bool on;
+    int32_t brightness;
+    float hue;
+    const char* name;
+    uint8_t token[4];
+
+    size_t numReads;
+    size_t numWrites;
+} state = { .on = true, .brightness = 50, .hue = 120, .name = "Kitchen", .token = { 0x01, 0x02, 0x03, 0x04 } };
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleOnRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPBoolCharacteristicReadRequest* request HAP_UNUSED,
+        bool* value,
+        void* _Nullable context HAP_UNUSED) {
+    *value = state.on;
+    state.numReads++;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleOnWrite(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPBoolCharacteristicWriteRequest* request HAP_UNUSED,
+        bool value,
+        void* _Nullable context HAP_UNUSED) {
+    state.on = value;
+    state.numWrites++;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleBrightnessRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPIntCharacteristicReadRequest* request HAP_UNUSED,
+        int32_t* value,
+        void* _Nullable context HAP_UNUSED) {
+    *value = state.brightness;
+    state.numReads++;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleBrightnessWrite(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPIntCharacteristicWriteRequest* request HAP_UNUSED,
+        int32_t value,
+        void* _Nullable context HAP_UNUSED) {
+    state.brightness = value;
+    state.numWrites++;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleNameRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPStringCharacteristicReadRequest* request HAP_UNUSED,
+        char* value,
+        size_t maxValueBytes,
+        void* _Nullable context HAP_UNUSED) {
+    size_t numBytes = HAPStringGetNumBytes(state.name);
+    if (numBytes >= maxValueBytes) {
+        return kHAPError_OutOfResources;
+    }
+    HAPRawBufferCopyBytes(value, state.name, numBytes + 1);
+    state.numReads++;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleTokenRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPDataCharacteristicReadRequest* request HAP_UNUSED,
+        void* valueBytes,
+        size_t maxValueBytes,
+        size_t* numValueBytes,
+        void* _Nullable context HAP_UNUSED) {
+    if (sizeof state.token > maxValueBytes) {
+        return kHAPError_OutOfResources;
+    }
+    HAPRawBufferCopyBytes(valueBytes, state.token, sizeof state.token);
+    *numValueBytes = sizeof state.token;
+    state.numReads++;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleHueRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPFloatCharacteristicReadRequest* request HAP_UNUSED,
+        float* value,
+        void* _Nullable context HAP_UNUSED) {
+    *value = state.hue;
+    state.numReads++;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleHueWrite(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPFloatCharacteristicWriteRequest* request HAP_UNUSED,
+        float value,
+        void* _Nullable context HAP_UNUSED) {
+    state.hue = value;
+    state.numWrites++;
+    return kHAPError_None;
+}
+
+static const HAPBoolCharacteristic lightBulbOnCharacteristic = {
+    .format = kHAPCharacteristicFormat_Bool,
+    .iid = kIID_LightBulbOn,
+    .characteristicType = &kHAPCharacteristicType_On,
+    .debugDescription = kHAPCharacteristicDebugDescription_On,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = true,
+                    .supportsEventNotification = true,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false, .supportsWriteResponse = false, .cacheable = true },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .callbacks = { .handleRead = HandleOnRead, .handleWrite = HandleOnWrite }
+};
+
+static const HAPIntCharacteristic lightBulbBrightnessCharacteristic = {
+    .format = kHAPCharacteristicFormat_Int,
+    .iid = kIID_LightBulbBrightness,
+    .characteristicType = &kHAPCharacteristicType_Brightness,
+    .debugDescription = kHAPCharacteristicDebugDescription_Brightness,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = true,
+                    .supportsEventNotification = true,
+                    .hidden = false,
+                    .readRequiresAdminPermissions = true,
+                    .writeRequiresAdminPermissions = true,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false, .supportsWriteResponse = false, .cacheable = true },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .units = kHAPCharacteristicUnits_Percentage,
+    .constraints = { .minimumValue = 0, .maximumValue = 100, .stepValue = 1 },
+    .callbacks = { .handleRead = HandleBrightnessRead, .handleWrite = HandleBrightnessWrite }
+};
+
+static const HAPStringCharacteristic lightBulbNameCharacteristic = {
+    .format = kHAPCharacteristicFormat_String,
+    .iid = kIID_LightBulbName,
+    .characteristicType = &kHAPCharacteristicType_Name,
+    .debugDescription = kHAPCharacteristicDebugDescription_Name,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = false,
+                    .supportsEventNotification = false,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false, .supportsWriteResponse = false, .cacheable = true },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .constraints = { .maxLength = 64 },
+    .callbacks = { .handleRead = HandleNameRead, .handleWrite = NULL }
+};
+
+/**
+ * Vendor-specific characteristic type of the token characteristic.
+ */
+static const HAPUUID kCharacteristicType_Token = {
+    { 0x00, 0x54, 0x4B, 0x4E, 0x45, 0x4B, 0x4F, 0x54, 0x54, 0x4B, 0x4E, 0x45, 0x01, 0x00, 0x00, 0x00 }
+};
+
+static const HAPDataCharacteristic lightBulbTokenCharacteristic = {
+    .format = kHAPCharacteristicFormat_Data,
+    .iid = kIID_LightBulbToken,
+    .characteristicType = &kCharacteristicType_Token,
+    .debugDescription = "token",
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = false,
+                    .supportsEventNotification = true,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false, .supportsWriteResponse = false, .cacheable = true },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .constraints = { .maxLength = 64 },
+    .callbacks = { .handleRead = HandleTokenRead, .handleWrite = NULL }
+};
+
+static const HAPFloatCharacteristic lightBulbHueCharacteristic = {
+    .format = kHAPCharacteristicFormat_Float,
+    .iid = kIID_LightBulbHue,
+    .characteristicType = &kHAPCharacteristicType_Hue,
+    .debugDescription = kHAPCharacteristicDebugDescription_Hue,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = true,
+                    .supportsEventNotification = true,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false, .supportsWriteResponse = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .units = kHAPCharacteristicUnits_ArcDegrees,
+    .constraints = { .minimumValue = 0, .maximumValue = 360, .stepValue = 1 },
+    .callbacks = { .handleRead = HandleHueRead, .handleWrite = HandleHueWrite }
+};
+
+static const HAPService lightBulbService = {
+    .iid = kIID_LightBulb,
+    .serviceType = &kHAPServiceType_LightBulb,
+    .debugDescription = kHAPServiceDebugDescription_LightBulb,
+    .name = NULL,
+    .properties = { .primaryService = true, .hidden = false, .ble = { .supportsConfiguration = false } },
+    .linkedServices = NULL,
+    .characteristics = (const HAPCharacteristic* const[]) { &lightBulbOnCharacteristic,
+                                                            &lightBulbBrightnessCharacteristic,
+                                                            &lightBulbNameCharacteristic,
+                                                            &lightBulbTokenCharacteristic,
+                                                            &lightBulbHueCharacteristic,
+                                                            NULL }
+};
+
+static const HAPAccessory lightBulbAccessory = {
+    .aid = 1,
+    .category = kHAPAccessoryCategory_Lighting,
+    .name = "Acme Light Bulb",
+    .manufacturer = "Acme",
+    .model = "LightBulb1,1",
+    .serialNumber = "099DB48E9E28",
+    .firmwareVersion = "1",
+    .hardwareVersion = "1",
+    .services = (const HAPService* const[]) { &accessoryInformationService,
+                                              &hapProtocolInformationService,
+                                              &pairingService,
+                                              &lightBulbService,
+                                              NULL },
+    .callbacks = { .identify = IdentifyAccessory }
+};
+
+/**
+ * Checks whether a buffer contains a string.
+ *
+ * @param      bytes                Buffer.
+ * @param      numBytes             Length of buffer.
+ * @param      string               String to search for.
+ *
+ * @return true                     If the buffer contains the string.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool ContainsString(const void* bytes, size_t numBytes, const char* string) {
+    HAPPrecondition(bytes);
+    HAPPrecondition(string);
+
+    size_t numStringBytes = HAPStringGetNumBytes(string);
+    for (size_t i = 0; i + numStringBytes <= numBytes; i++) {
+        if (HAPRawBufferAreEqual(&((const uint8_t*) bytes)[i], string, numStringBytes)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static char responseBytes[16 * 1024];
+static size_t numResponseBytes;
+
+/**
+ * Reads a characteristic of the light bulb with GET /characteristics.
+ *
+ * @param      controller           Simulated controller.
+ * @param      iid                  Characteristic instance ID.
+ *
+ * @return HTTP status code of the response. The response body is stored in responseBytes.
+ */
+HAP_RESULT_USE_CHECK
+static unsigned int ReadCharacteristic(HAPIPController* controller, uint64_t iid) {
+    HAPPrecondition(controller);
+
+    HAPError err;
+
+    char uri[64];
+    err = HAPStringWithFormat(uri, sizeof uri, "/characteristics?id=1.%llu", (unsigned long long) iid);
+    HAPAssert(!err);
+    unsigned int status;
+    err = HAPIPControllerPerformRequest(
+            controller,
+            "GET",
+            uri,
+            /* contentType: */ NULL,
+            /* requestBodyBytes: */ NULL,
+            0,
+            &status,
+            responseBytes,
+            sizeof responseBytes - 1,
+            &numResponseBytes);
+    HAPAssert(!err);
+    responseBytes[numResponseBytes] = '\0';
+    return status;
+}
+
+/**
+ * Writes characteristics of the light bulb with PUT /characteristics.
+ *
+ * @param      controller           Simulated controller.
+ * @param      requestBody          Request body.
+ *
+ * @return HTTP status code of the response.
+ */
+HAP_RESULT_USE_CHECK
+static unsigned int WriteCharacteristics(HAPIPController* controller, const char* requestBody) {
+    HAPPrecondition(controller);
+    HAPPrecondition(requestBody);
+
+    HAPError err;
+
+    unsigned int status;
+    err = HAPIPControllerPerformRequest(
+            controller,
+            "PUT",
+            "/characteristics",
+            "application/hap+json",
+            requestBody,
+            HAPStringGetNumBytes(requestBody),
+            &status,
+            responseBytes,
+            sizeof responseBytes - 1,
+            &numResponseBytes);
+    HAPAssert(!err);
+    return status;
+}
+
+int main() {
+    HAPError err;
+    HAPPlatformCreate();
+
+    HAPAccessoryServerStorageUsage requirements;
+    HAPAccessoryServerGetStorageRequirements(&lightBulbAccessory, /* bridgedAccessories: */ NULL, &requirements);
+    HAPAssert(requirements.ip.numCharacteristicIndexElements <= kMaxCharacteristics);
+    HAPAssert(requirements.ip.numValueCacheElements == 4);
+
+    // Provision accessory server, an admin controller and a regular controller.
+    static const HAPAccessoryServerDeviceID deviceID = { { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 } };
+    err = HAPLegacyImportDeviceID(platform.keyValueStore, &deviceID);
+    HAPAssert(!err);
+    HAPAccessoryServerLongTermSecretKey accessoryLTSK;
+    HAPPlatformRandomNumberFill(accessoryLTSK.bytes, sizeof accessoryLTSK.bytes);
+    err = HAPLegacyImportLongTermSecretKey(platform.keyValueStore, &accessoryLTSK);
+    HAPAssert(!err);
+    uint8_t accessoryLTPK[ED25519_PUBLIC_KEY_BYTES];
+    HAP_ed25519_public_key(accessoryLTPK, accessoryLTSK.bytes);
+
+    static const HAPControllerPairingIdentifier adminPairingIdentifier = {
+        .bytes = "4E5D4B2F-6A3B-4C1D-9E8F-0A1B2C3D4E5F", .numBytes = 36
+    };
+    uint8_t adminLTSK[ED25519_SECRET_KEY_BYTES];
+    HAPPlatformRandomNumberFill(adminLTSK, sizeof adminLTSK);
+    HAPControllerPublicKey adminLTPK;
+    HAP_ed25519_public_key(adminLTPK.bytes, adminLTSK);
+    err = HAPLegacyImportControllerPairing(
+            platform.keyValueStore, 0, &adminPairingIdentifier, &adminLTPK, /* isAdmin: */ true);
+    HAPAssert(!err);
+
+    static const HAPControllerPairingIdentifier userPairingIdentifier = {
+        .bytes = "9A8B7C6D-5E4F-4A3B-8C2D-1E0F9A8B7C6D", .numBytes = 36
+    };
+    uint8_t userLTSK[ED25519_SECRET_KEY_BYTES];
+    HAPPlatformRandomNumberFill(userLTSK, sizeof userLTSK);
+    HAPControllerPublicKey userLTPK;
+    HAP_ed25519_public_key(userLTPK.bytes, userLTSK);
+    err = HAPLegacyImportControllerPairing(
+            platform.keyValueStore, 1, &userPairingIdentifier, &userLTPK, /* isAdmin: */ false);
+    HAPAssert(!err);
+
+    // Prepare accessory server storage.
+    static HAPIPAccessoryServerStorage ipAccessoryServerStorage;
+    HAPIPTestStorageCreate(
+            &ipAccessoryServerStorage,
+            &(const HAPIPTestStorageOptions) { .numSessions = kHAPIPSessionStorage_DefaultNumElements,
+                                               .maxCharacteristics = kMaxCharacteristics,
+                                               .numValueCacheElements = kMaxCharacteristics });
+
+    // Initialize and start accessory server.
+    static HAPAccessoryServerRef accessoryServer;
+    HAPAccessoryServerCreate(
+            &accessoryServer,
+            &(const HAPAccessoryServerOptions) {
+                    .maxPairings = kHAPPairingStorage_MinElements,
+                    .ip = { .transport = &kHAPAccessoryServerTransport_IP,
+                            .accessoryServerStorage = &ipAccessoryServerStorage } },
+            &platform,
+            &(const HAPAccessoryServerCallbacks) { .handleUpdatedState = HandleUpdatedAccessoryServerState },
+            /* context: */ NULL);
+    HAPAccessoryServerStart(&accessoryServer, &lightBulbAccessory);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Running);
+
+    HAPAccessoryServerStorageUsage highWaterMarks;
+    HAPAccessoryServerGetStorageHighWaterMarks(&accessoryServer, &highWaterMarks);
+    HAPAssert(highWaterMarks.ip.numValueCacheElements == requirements.ip.numValueCacheElements);
+
+    // Connect both controllers and establish HAP sessions.
+    static HAPIPController adminController;
+    HAPIPControllerCreate(
+            &adminController,
+            &(const HAPIPControllerOptions) { .tcpStreamManager = HAPNonnull(platform.ip.tcpStreamManager),
+                                              .pairingIdentifier = &adminPairingIdentifier,
+                                              .longTermSecretKey = adminLTSK,
+                                              .accessoryLongTermPublicKey = accessoryLTPK });
+    err = HAPIPControllerConnect(&adminController);
+    HAPAssert(!err);
+    err = HAPIPControllerPairVerify(&adminController);
+    HAPAssert(!err);
+    static HAPIPController userController;
+    HAPIPControllerCreate(
+            &userController,
+            &(const HAPIPControllerOptions) { .tcpStreamManager = HAPNonnull(platform.ip.tcpStreamManager),
+                                              .pairingIdentifier = &userPairingIdentifier,
+                                              .longTermSecretKey = userLTSK,
+                                              .accessoryLongTermPublicKey = accessoryLTPK });
+    err = HAPIPControllerConnect(&userController);
+    HAPAssert(!err);
+    err = HAPIPControllerPairVerify(&userController);
+    HAPAssert(!err);
+
+    // GET /accessories fills the value cache. Subsequent reads do not invoke the read handlers.
+    unsigned int status;
+    err = HAPIPControllerPerformRequest(
+            &adminController,
+            "GET",
+            "/accessories",
+            /* contentType: */ NULL,
+            /* requestBodyBytes: */ NULL,
+            0,
+            &status,
+            responseBytes,
+            sizeof responseBytes,
+            &numResponseBytes);
+    HAPAssert(!err);
+    HAPAssert(status == 200);
+    size_t numReads = state.numReads;
+    HAPAssert(ReadCharacteristic(&adminController, kIID_LightBulbOn) == 200);
+    HAPAssert(ContainsString(responseBytes, numResponseBytes, "\"value\":1"));
+    HAPAssert(ReadCharacteristic(&adminController, kIID_LightBulbName) == 200);
+    HAPAssert(ContainsString(responseBytes, numResponseBytes, "\"value\":\"Kitchen\""));
+    HAPAssert(ReadCharacteristic(&adminController, kIID_LightBulbToken) == 200);
+    HAPAssert(ContainsString(responseBytes, numResponseBytes, "\"value\":\"AQIDBA==\""));
+    HAPAssert(ReadCharacteristic(&adminController, kIID_LightBulbBrightness) == 200);
+    HAPAssert(ContainsString(responseBytes, numResponseBytes, "\"value\":50"));
+    HAPAssert(state.numReads == numReads);
+
+    // Characteristics without the ip.cacheable property are always read from the application.
+    HAPAssert(ReadCharacteristic(&adminController, kIID_LightBulbHue) == 200);
+    HAPAssert(state.numReads == numReads + 1);
+    numReads = state.numReads;
+
+    // Read permissions are checked before the value cache is consulted.
+    HAPAssert(ReadCharacteristic(&userController, kIID_LightBulbBrightness) != 200);
+    HAPAssert(ContainsString(responseBytes, numResponseBytes, "\"status\":-70401"));
+    HAPAssert(!ContainsString(responseBytes, numResponseBytes, "\"value\""));
+    HAPAssert(ReadCharacteristic(&userController, kIID_LightBulbOn) == 200);
+    HAPAssert(ContainsString(responseBytes, numResponseBytes, "\"value\":1"));
+    HAPAssert(state.numReads == numReads);
+
+    // A write discards the cached value.
+    HAPAssert(
+            WriteCharacteristics(&adminController, "{\"characteristics\":[{\"aid\":1,\"iid\":49,\"value\":false}]}") ==
+            204);
+    HAPAssert(state.numWrites == 1);
+    HAPAssert(!state.on);
+    HAPAssert(ReadCharacteristic(&userController, kIID_LightBulbOn) == 200);
+    HAPAssert(ContainsString(responseBytes, numResponseBytes, "\"value\":0"));
+    HAPAssert(state.numReads == numReads + 1);
+    HAPAssert(ReadCharacteristic(&adminController, kIID_LightBulbOn) == 200);
+    HAPAssert(state.numReads == numReads + 1);
+    numReads = state.numReads;
+
+    // A raised event without value discards the cached value.
+    state.name = "Living Room";
+    HAPAccessoryServerRaiseEvent(
+            &accessoryServer, &lightBulbNameCharacteristic, &lightBulbService, &lightBulbAccessory);
+    HAPAssert(ReadCharacteristic(&adminController, kIID_LightBulbName) == 200);
+    HAPAssert(ContainsString(responseBytes, numResponseBytes, "\"value\":\"Living Room\""));
+    HAPAssert(state.numReads == numReads + 1);
+    numReads = state.numReads;
+
+    // A raised event with value updates the cached value. Event notifications are served from the value cache.
+    HAPAssert(
+            WriteCharacteristics(
+                    &adminController,
+                    "{\"characteristics\":[{\"aid\":1,\"iid\":49,\"ev\":true},{\"aid\":1,\"iid\":52,\"ev\":true}]}") ==
+            204);
+    state.on = true;
+    HAPAccessoryServerRaiseEventWithValue(
+            &accessoryServer,
+            &lightBulbOnCharacteristic,
+            &lightBulbService,
+            &lightBulbAccessory,
+            &state.on,
+            sizeof state.on);
+    static const uint8_t token[] = { 0xFF, 0xFE, 0xFD };
+    HAPRawBufferCopyBytes(state.token, token, sizeof token);
+    HAPAccessoryServerRaiseEventWithValue(
+            &accessoryServer,
+            &lightBulbTokenCharacteristic,
+            &lightBulbService,
+            &lightBulbAccessory,
+            token,
+            sizeof token);
+    HAPPlatformClockAdvance(1 * HAPSecond);
+    err = HAPIPControllerReceiveEvent(&adminController, responseBytes, sizeof responseBytes, &numResponseBytes);
+    HAPAssert(!err);
+    HAPAssert(ContainsString(responseBytes, numResponseBytes, "\"iid\":49,\"value\":1"));
+    HAPAssert(ContainsString(responseBytes, numResponseBytes, "\"iid\":52,\"value\":\"//79\""));
+    HAPAssert(ReadCharacteristic(&userController, kIID_LightBulbOn) == 200);
+    HAPAssert(ContainsString(responseBytes, numResponseBytes, "\"value\":1"));
+    HAPAssert(state.numReads == numReads);
+
+    // Values that do not satisfy the characteristic constraints are not cached.
+    static const int32_t invalidBrightness = 150;
+    HAPAccessoryServerRaiseEventWithValue(
+            &accessoryServer,
+            &lightBulbBrightnessCharacteristic,
+            &lightBulbService,
+            &lightBulbAccessory,
+            &invalidBrightness,
+            sizeof invalidBrightness);
+    HAPAssert(ReadCharacteristic(&adminController, kIID_LightBulbBrightness) == 200);
+    HAPAssert(ContainsString(responseBytes, numResponseBytes, "\"value\":50"));
+    HAPAssert(state.numReads == numReads + 1);
+    static const char invalidName[] = "0123456789012345678901234567890123456789012345678901234567890123456789";
+    HAPAccessoryServerRaiseEventWithValue(
+            &accessoryServer,
+            &lightBulbNameCharacteristic,
+            &lightBulbService,
+            &lightBulbAccessory,
+            invalidName,
+            sizeof invalidName - 1);
+    HAPAssert(ReadCharacteristic(&adminController, kIID_LightBulbName) == 200);
+    HAPAssert(ContainsString(responseBytes, numResponseBytes, "\"value\":\"Living Room\""));
+    HAPAssert(state.numReads == numReads + 2);
+
+    // Stop accessory server.
+    HAPIPControllerDisconnect(&userController);
+    HAPIPControllerDisconnect(&adminController);
+    HAPAccessoryServerStop(&accessoryServer);
+    while (!isIdle) {
+        HAPPlatformClockAdvance(0);
+    }
+    HAPAccessoryServerRelease(&accessoryServer);
+
+    return 0;
+}
@@ -0,0 +1,474 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+// Checks that IP event notifications of characteristics with the ip.suppressUnchangedEventNotifications property
+// are only delivered when the value changed since it was last delivered on a session,
+// and that Programmable Switch Event notifications are never suppressed.
+
+#include "HAP+Internal.h"
+#include "HAPPlatform+Init.h"
+
+#include "Harness/HAPIPController.c"
+#include "Harness/HAPIPTestStorage.c"
+#include "Harness/TemplateDB.c"
+
+#define kIID_LightBulb           ((uint64_t) 0x0030)
+#define kIID_LightBulbOn         ((uint64_t) 0x0031)
+#define kIID_LightBulbBrightness ((uint64_t) 0x0032)
+#define kIID_LightBulbName       ((uint64_t) 0x0033)
+#define kIID_Switch              ((uint64_t) 0x0040)
+#define kIID_SwitchEvent         ((uint64_t) 0x0041)
+
+/**
+ * Maximum number of characteristics of the accessory.
+ */
+#define kMaxCharacteristics ((size_t) 32)
+
+static bool isIdle;
+
+static void HandleUpdatedAccessoryServerState(HAPAccessoryServerRef* server, void* _Nullable context HAP_UNUSED) {
+    HAPPrecondition(server);
+
+    isIdle = HAPAccessoryServerGetState(server) == kHAPAccessoryServerState_Idle;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError IdentifyAccessory(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPAccessoryIdentifyRequest* request HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    return kHAPError_None;
+}
+
+/**
+ * State of the accessory, and number of read handler invocations.
+ */
+static struct {
+    bool on;
+    int32_t brightness;
+    const char* name;
+    uint8_t switchEvent;
+
+    size_t numReads;
+} state = { .on = true, .brightness = 50, .name = "Kitchen", .switchEvent = 0 };
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleOnRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPBoolCharacteristicReadRequest* request HAP_UNUSED,
+        bool* value,
+        void* _Nullable context HAP_UNUSED) {
+    *value = state.on;
+    state.numReads++;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleBrightnessRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPIntCharacteristicReadRequest* request HAP_UNUSED,
+        int32_t* value,
+        void* _Nullable context HAP_UNUSED) {
+    *value = state.brightness;
+    state.numReads++;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleNameRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPStringCharacteristicReadRequest* request HAP_UNUSED,
+        char* value,
+        size_t maxValueBytes,
+        void* _Nullable context HAP_UNUSED) {
+    size_t numBytes = HAPStringGetNumBytes(state.name);
+    if (numBytes >= maxValueBytes) {
+        return kHAPError_OutOfResources;
+    }
+    HAPRawBufferCopyBytes(value, state.name, numBytes + 1);
+    state.numReads++;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleSwitchEventRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPUInt8CharacteristicReadRequest* request HAP_UNUSED,
+        uint8_t* value,
+        void* _Nullable context HAP_UNUSED) {
+    *value = state.switchEvent;
+    state.numReads++;
+    return kHAPError_None;
+}
+
+static const HAPBoolCharacteristic lightBulbOnCharacteristic = {
+    .format = kHAPCharacteristicFormat_Bool,
+    .iid = kIID_LightBulbOn,
+    .characteristicType = &kHAPCharacteristicType_On,
+    .debugDescription = kHAPCharacteristicDebugDescription_On,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = false,
+                    .supportsEventNotification = true,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false,
+                            .supportsWriteResponse = false,
+                            .suppressUnchangedEventNotifications = true },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .callbacks = { .handleRead = HandleOnRead, .handleWrite = NULL }
+};
+
+static const HAPIntCharacteristic lightBulbBrightnessCharacteristic = {
+    .format = kHAPCharacteristicFormat_Int,
+    .iid = kIID_LightBulbBrightness,
+    .characteristicType = &kHAPCharacteristicType_Brightness,
+    .debugDescription = kHAPCharacteristicDebugDescription_Brightness,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = false,
+                    .supportsEventNotification = true,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false,
+                            .supportsWriteResponse = false,
+                            .suppressUnchangedEventNotifications = true },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .units = kHAPCharacteristicUnits_Percentage,
+    .constraints = { .minimumValue = 0, .maximumValue = 100, .stepValue = 1 },
+    .callbacks = { .handleRead = HandleBrightnessRead, .handleWrite = NULL }
+};
+
+static const HAPStringCharacteristic lightBulbNameCharacteristic = {
+    .format = kHAPCharacteristicFormat_String,
+    .iid = kIID_LightBulbName,
+    .characteristicType = &kHAPCharacteristicType_Name,
+    .debugDescription = kHAPCharacteristicDebugDescription_Name,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = false,
+                    .supportsEventNotification = true,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false,
+                            .supportsWriteResponse = false,
+                            .suppressUnchangedEventNotifications = true },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .constraints = { .maxLength = 64 },
+    .callbacks = { .handleRead = HandleNameRead, .handleWrite = NULL }
+};
+
+static const HAPService lightBulbService = {
+    .iid = kIID_LightBulb,
+    .serviceType = &kHAPServiceType_LightBulb,
+    .debugDescription = kHAPServiceDebugDescription_LightBulb,
+    .name = NULL,
+    .properties = { .primaryService = true, .hidden = false, .ble = { .supportsConfiguration = false } },
+    .linkedServices = NULL,
+    .characteristics = (const HAPCharacteristic* const[]) { &lightBulbOnCharacteristic,
+                                                            &lightBulbBrightnessCharacteristic,
+                                                            &lightBulbNameCharacteristic,
+                                                            NULL }
+};
+
+static const HAPUInt8Characteristic switchEventCharacteristic = {
+    .format = kHAPCharacteristicFormat_UInt8,
+    .iid = kIID_SwitchEvent,
+    .characteristicType = &kHAPCharacteristicType_ProgrammableSwitchEvent,
+    .debugDescription = kHAPCharacteristicDebugDescription_ProgrammableSwitchEvent,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = false,
+                    .supportsEventNotification = true,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false,
+                            .supportsWriteResponse = false,
+                            .suppressUnchangedEventNotifications = true },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .units = kHAPCharacteristicUnits_None,
+    .constraints = { .minimumValue = 0, .maximumValue = 2, .stepValue = 1 },
+    .callbacks = { .handleRead = HandleSwitchEventRead, .handleWrite = NULL }
+};
+
+static const HAPService switchService = {
+    .iid = kIID_Switch,
+    .serviceType = &kHAPServiceType_StatelessProgrammableSwitch,
+    .debugDescription = kHAPServiceDebugDescription_StatelessProgrammableSwitch,
+    .name = NULL,
+    .properties = { .primaryService = false, .hidden = false, .ble = { .supportsConfiguration = false } },
+    .linkedServices = NULL,
+    .characteristics = (const HAPCharacteristic* const[]) { &switchEventCharacteristic, NULL }
+};
+
+static const HAPAccessory accessory = {
+    .aid = 1,
+    .category = kHAPAccessoryCategory_Lighting,
+    .name = "Acme Light Bulb",
+    .manufacturer = "Acme",
+    .model = "LightBulb1,1",
+    .serialNumber = "099DB48E9E28",
+    .firmwareVersion = "1",
+    .hardwareVersion = "1",
+    .services = (const HAPService* const[]) { &accessoryInformationService,
+                                              &hapProtocolInformationService,
+                                              &pairingService,
+                                              &lightBulbService,
+                                              &switchService,
+                                              NULL },
+    .callbacks = { .identify = IdentifyAccessory }
+};
+
+/**
+ * Checks whether a buffer contains a string.
+ *
+ * @param      bytes                Buffer.
+ * @param      numBytes             Length of buffer.
+ * @param      string               String to search for.
+ *
+ * @return true                     If the buffer contains the string.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool ContainsString(const void* bytes, size_t numBytes, const char* string) {
+    HAPPrecondition(bytes);
+    HAPPrecondition(string);
+
+    size_t numStringBytes = HAPStringGetNumBytes(string);
+    for (size_t i = 0; i + numStringBytes <= numBytes; i++) {
+        if (HAPRawBufferAreEqual(&((const uint8_t*) bytes)[i], string, numStringBytes)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static char responseBytes[16 * 1024];
+static size_t numResponseBytes;
+
+/**
+ * Writes characteristics with PUT /characteristics.
+ *
+ * @param      controller           Simulated controller.
+ * @param      requestBody          Request body.
+ *
+ * @return HTTP status code of the response.
+ */
+HAP_RESULT_USE_CHECK
+static unsigned int WriteCharacteristics(HAPIPController* controller, const char* requestBody) {
+    HAPPrecondition(controller);
+    HAPPrecondition(requestBody);
+
+    HAPError err;
+
+    unsigned int status;
+    err = HAPIPControllerPerformRequest(
+            controller,
+            "PUT",
+            "/characteristics",
+            "application/hap+json",
+            requestBody,
+            HAPStringGetNumBytes(requestBody),
+            &status,
+            responseBytes,
+            sizeof responseBytes,
+            &numResponseBytes);
+    HAPAssert(!err);
+    return status;
+}
+
+/**
+ * Lets the accessory server deliver pending event notifications and receives the next one.
+ *
+ * @param      controller           Simulated controller.
+ *
+ * @return true                     If an event notification was received. Its body is stored in responseBytes.
+ * @return false                    If no event notification was sent.
+ */
+HAP_RESULT_USE_CHECK
+static bool ReceiveEvent(HAPIPController* controller) {
+    HAPPrecondition(controller);
+
+    HAPError err;
+
+    HAPPlatformClockAdvance(1 * HAPSecond);
+    err = HAPIPControllerReceiveEvent(controller, responseBytes, sizeof responseBytes, &numResponseBytes);
+    if (err) {
+        HAPAssert(err == kHAPError_InvalidState);
+        return false;
+    }
+    return true;
+}
+
+int main() {
+    HAPError err;
+    HAPPlatformCreate();
+
+    HAPAccessoryServerStorageUsage requirements;
+    HAPAccessoryServerGetStorageRequirements(&accessory, /* bridgedAccessories: */ NULL, &requirements);
+    HAPAssert(requirements.ip.numCharacteristicIndexElements <= kMaxCharacteristics);
+
+    // Provision accessory server and an admin controller.
+    static const HAPAccessoryServerDeviceID deviceID = { { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 } };
+    err = HAPLegacyImportDeviceID(platform.keyValueStore, &deviceID);
+    HAPAssert(!err);
+    HAPAccessoryServerLongTermSecretKey accessoryLTSK;
+    HAPPlatformRandomNumberFill(accessoryLTSK.bytes, sizeof accessoryLTSK.bytes);
+    err = HAPLegacyImportLongTermSecretKey(platform.keyValueStore, &accessoryLTSK);
+    HAPAssert(!err);
+    uint8_t accessoryLTPK[ED25519_PUBLIC_KEY_BYTES];
+    HAP_ed25519_public_key(accessoryLTPK, accessoryLTSK.bytes);
+
+    static const HAPControllerPairingIdentifier pairingIdentifier = {
+        .bytes = "4E5D4B2F-6A3B-4C1D-9E8F-0A1B2C3D4E5F", .numBytes = 36
+    };
+    uint8_t controllerLTSK[ED25519_SECRET_KEY_BYTES];
+    HAPPlatformRandomNumberFill(controllerLTSK, sizeof controllerLTSK);
+    HAPControllerPublicKey controllerLTPK;
+    HAP_ed25519_public_key(controllerLTPK.bytes, controllerLTSK);
+    err = HAPLegacyImportControllerPairing(
+            platform.keyValueStore, 0, &pairingIdentifier, &controllerLTPK, /* isAdmin: */ true);
+    HAPAssert(!err);
+
+    // Prepare accessory server storage. Event notification storage has room for value digests.
+    static HAPIPAccessoryServerStorage ipAccessoryServerStorage;
+    HAPIPTestStorageCreate(
+            &ipAccessoryServerStorage,
+            &(const HAPIPTestStorageOptions) { .numSessions = kHAPIPSessionStorage_DefaultNumElements,
+                                               .maxCharacteristics = kMaxCharacteristics,
+                                               .numValueDigests = kMaxCharacteristics });
+    HAPAssert(
+            requirements.ip.numEventNotifications <= ipAccessoryServerStorage.sessions[0].numEventNotifications);
+
+    // Initialize and start accessory server.
+    static HAPAccessoryServerRef accessoryServer;
+    HAPAccessoryServerCreate(
+            &accessoryServer,
+            &(const HAPAccessoryServerOptions) {
+                    .maxPairings = kHAPPairingStorage_MinElements,
+                    .ip = { .transport = &kHAPAccessoryServerTransport_IP,
+                            .accessoryServerStorage = &ipAccessoryServerStorage } },
+            &platform,
+            &(const HAPAccessoryServerCallbacks) { .handleUpdatedState = HandleUpdatedAccessoryServerState },
+            /* context: */ NULL);
+    HAPAccessoryServerStart(&accessoryServer, &accessory);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Running);
+
+    // Connect controller, establish HAP session and subscribe to all characteristics.
+    static HAPIPController controller;
+    HAPIPControllerCreate(
+            &controller,
+            &(const HAPIPControllerOptions) { .tcpStreamManager = HAPNonnull(platform.ip.tcpStreamManager),
+                                              .pairingIdentifier = &pairingIdentifier,
+                                              .longTermSecretKey = controllerLTSK,
+                                              .accessoryLongTermPublicKey = accessoryLTPK });
+    err = HAPIPControllerConnect(&controller);
+    HAPAssert(!err);
+    err = HAPIPControllerPairVerify(&controller);
+    HAPAssert(!err);
+    HAPAssert(
+            WriteCharacteristics(
+                    &controller,
+                    "{\"characteristics\":["
+                    "{\"aid\":1,\"iid\":49,\"ev\":true},"
+                    "{\"aid\":1,\"iid\":50,\"ev\":true},"
+                    "{\"aid\":1,\"iid\":51,\"ev\":true},"
+                    "{\"aid\":1,\"iid\":65,\"ev\":true}]}") == 204);
+
+    // The first event notification after subscribing is always delivered.
+    HAPAccessoryServerRaiseEvent(&accessoryServer, &lightBulbOnCharacteristic, &lightBulbService, &accessory);
+    HAPAssert(ReceiveEvent(&controller));
+    HAPAssert(ContainsString(responseBytes, numResponseBytes, "\"iid\":49,\"value\":1"));
+
+    // An unchanged value is not re-sent.
+    size_t numReads = state.numReads;
+    HAPAccessoryServerRaiseEvent(&accessoryServer, &lightBulbOnCharacteristic, &lightBulbService, &accessory);
+    HAPAssert(!ReceiveEvent(&controller));
+    HAPAssert(state.numReads == numReads + 1);
+
+    // A changed value is sent.
+    state.on = false;
+    HAPAccessoryServerRaiseEvent(&accessoryServer, &lightBulbOnCharacteristic, &lightBulbService, &accessory);
+    HAPAssert(ReceiveEvent(&controller));
+    HAPAssert(ContainsString(responseBytes, numResponseBytes, "\"iid\":49,\"value\":0"));
+
+    // Only the changed values of coalesced event notifications are sent.
+    HAPAccessoryServerRaiseEvent(&accessoryServer, &lightBulbBrightnessCharacteristic, &lightBulbService, &accessory);
+    HAPAssert(ReceiveEvent(&controller));
+    HAPAssert(ContainsString(responseBytes, numResponseBytes, "\"iid\":50,\"value\":50"));
+    state.brightness = 75;
+    HAPAccessoryServerRaiseEvent(&accessoryServer, &lightBulbOnCharacteristic, &lightBulbService, &accessory);
+    HAPAccessoryServerRaiseEvent(&accessoryServer, &lightBulbBrightnessCharacteristic, &lightBulbService, &accessory);
+    HAPAssert(ReceiveEvent(&controller));
+    HAPAssert(ContainsString(responseBytes, numResponseBytes, "\"iid\":50,\"value\":75"));
+    HAPAssert(!ContainsString(responseBytes, numResponseBytes, "\"iid\":49"));
+    HAPAssert(!ReceiveEvent(&controller));
+
+    // Short values are compared verbatim. These names have the same 32-bit FNV-1a hash.
+    state.name = "vmXuqzvn";
+    HAPAccessoryServerRaiseEvent(&accessoryServer, &lightBulbNameCharacteristic, &lightBulbService, &accessory);
+    HAPAssert(ReceiveEvent(&controller));
+    HAPAssert(ContainsString(responseBytes, numResponseBytes, "\"iid\":51,\"value\":\"vmXuqzvn\""));
+    state.name = "prcxZS4u";
+    HAPAccessoryServerRaiseEvent(&accessoryServer, &lightBulbNameCharacteristic, &lightBulbService, &accessory);
+    HAPAssert(ReceiveEvent(&controller));
+    HAPAssert(ContainsString(responseBytes, numResponseBytes, "\"iid\":51,\"value\":\"prcxZS4u\""));
+    HAPAccessoryServerRaiseEvent(&accessoryServer, &lightBulbNameCharacteristic, &lightBulbService, &accessory);
+    HAPAssert(!ReceiveEvent(&controller));
+
+    // Long values are compared by length and hash.
+    state.name = "Living Room Ceiling";
+    HAPAccessoryServerRaiseEvent(&accessoryServer, &lightBulbNameCharacteristic, &lightBulbService, &accessory);
+    HAPAssert(ReceiveEvent(&controller));
+    HAPAssert(ContainsString(responseBytes, numResponseBytes, "\"iid\":51,\"value\":\"Living Room Ceiling\""));
+    state.name = "Living Room Ceiling 2";
+    HAPAccessoryServerRaiseEvent(&accessoryServer, &lightBulbNameCharacteristic, &lightBulbService, &accessory);
+    HAPAssert(ReceiveEvent(&controller));
+    HAPAssert(ContainsString(responseBytes, numResponseBytes, "\"iid\":51,\"value\":\"Living Room Ceiling 2\""));
+    HAPAccessoryServerRaiseEvent(&accessoryServer, &lightBulbNameCharacteristic, &lightBulbService, &accessory);
+    HAPAssert(!ReceiveEvent(&controller));
+
+    // Programmable Switch Event notifications are always sent, even if the value did not change.
+    for (size_t i = 0; i < 3; i++) {
+        HAPAccessoryServerRaiseEvent(&accessoryServer, &switchEventCharacteristic, &switchService, &accessory);
+        HAPAssert(ReceiveEvent(&controller));
+        HAPAssert(ContainsString(responseBytes, numResponseBytes, "\"iid\":65"));
+    }
+
+    // Subscribing again forgets the value that was last delivered.
+    HAPAssert(WriteCharacteristics(&controller, "{\"characteristics\":[{\"aid\":1,\"iid\":49,\"ev\":false}]}") == 204);
+    HAPAssert(WriteCharacteristics(&controller, "{\"characteristics\":[{\"aid\":1,\"iid\":49,\"ev\":true}]}") == 204);
+    HAPAccessoryServerRaiseEvent(&accessoryServer, &lightBulbOnCharacteristic, &lightBulbService, &accessory);
+    HAPAssert(ReceiveEvent(&controller));
+    HAPAssert(ContainsString(responseBytes, numResponseBytes, "\"iid\":49,\"value\":0"));
+
+    // Stop accessory server.
+    HAPIPControllerDisconnect(&controller);
+    HAPAccessoryServerStop(&accessoryServer);
+    while (!isIdle) {
+        HAPPlatformClockAdvance(0);
+    }
+    HAPAccessoryServerRelease(&accessoryServer);
+
+    return 0;
+}
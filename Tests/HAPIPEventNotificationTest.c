@@ -0,0 +1,332 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+// Checks that an IP session that is sized without value digests may subscribe to more characteristics than it has
+// event notification storage elements, and that pending event notifications of all of them are delivered.
+
+#include "HAP+Internal.h"
+#include "HAPPlatform+Init.h"
+
+#include "Harness/HAPIPController.c"
+#include "Harness/HAPIPTestStorage.c"
+#include "Harness/TemplateDB.c"
+
+#define kIID_LightBulb           ((uint64_t) 0x0030)
+#define kIID_LightBulbOn         ((uint64_t) 0x0031)
+#define kIID_LightBulbBrightness ((uint64_t) 0x0032)
+#define kIID_LightBulbHue        ((uint64_t) 0x0033)
+#define kIID_LightBulbSaturation ((uint64_t) 0x0034)
+
+/**
+ * Maximum number of characteristics of the accessory.
+ */
+#define kMaxCharacteristics ((size_t) 32)
+HAP_STATIC_ASSERT(HAPIPSessionGetNumEventNotifications(kMaxCharacteristics, 0) == 2, NumEventNotifications);
+
+static bool isIdle;
+
+static void HandleUpdatedAccessoryServerState(HAPAccessoryServerRef* server, void* _Nullable context HAP_UNUSED) {
+    HAPPrecondition(server);
+
+    isIdle = HAPAccessoryServerGetState(server) == kHAPAccessoryServerState_Idle;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError IdentifyAccessory(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPAccessoryIdentifyRequest* request HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleOnRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPBoolCharacteristicReadRequest* request HAP_UNUSED,
+        bool* value,
+        void* _Nullable context HAP_UNUSED) {
+    *value = true;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleBrightnessRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPIntCharacteristicReadRequest* request HAP_UNUSED,
+        int32_t* value,
+        void* _Nullable context HAP_UNUSED) {
+    *value = 50;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleHueRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPFloatCharacteristicReadRequest* request HAP_UNUSED,
+        float* value,
+        void* _Nullable context HAP_UNUSED) {
+    *value = 120;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleSaturationRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPFloatCharacteristicReadRequest* request HAP_UNUSED,
+        float* value,
+        void* _Nullable context HAP_UNUSED) {
+    *value = 80;
+    return kHAPError_None;
+}
+
+static const HAPBoolCharacteristic lightBulbOnCharacteristic = {
+    .format = kHAPCharacteristicFormat_Bool,
+    .iid = kIID_LightBulbOn,
+    .characteristicType = &kHAPCharacteristicType_On,
+    .debugDescription = kHAPCharacteristicDebugDescription_On,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = false,
+                    .supportsEventNotification = true,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false, .supportsWriteResponse = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .callbacks = { .handleRead = HandleOnRead, .handleWrite = NULL }
+};
+
+static const HAPIntCharacteristic lightBulbBrightnessCharacteristic = {
+    .format = kHAPCharacteristicFormat_Int,
+    .iid = kIID_LightBulbBrightness,
+    .characteristicType = &kHAPCharacteristicType_Brightness,
+    .debugDescription = kHAPCharacteristicDebugDescription_Brightness,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = false,
+                    .supportsEventNotification = true,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false, .supportsWriteResponse = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .units = kHAPCharacteristicUnits_Percentage,
+    .constraints = { .minimumValue = 0, .maximumValue = 100, .stepValue = 1 },
+    .callbacks = { .handleRead = HandleBrightnessRead, .handleWrite = NULL }
+};
+
+static const HAPFloatCharacteristic lightBulbHueCharacteristic = {
+    .format = kHAPCharacteristicFormat_Float,
+    .iid = kIID_LightBulbHue,
+    .characteristicType = &kHAPCharacteristicType_Hue,
+    .debugDescription = kHAPCharacteristicDebugDescription_Hue,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = false,
+                    .supportsEventNotification = true,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false, .supportsWriteResponse = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .units = kHAPCharacteristicUnits_ArcDegrees,
+    .constraints = { .minimumValue = 0, .maximumValue = 360, .stepValue = 1 },
+    .callbacks = { .handleRead = HandleHueRead, .handleWrite = NULL }
+};
+
+static const HAPFloatCharacteristic lightBulbSaturationCharacteristic = {
+    .format = kHAPCharacteristicFormat_Float,
+    .iid = kIID_LightBulbSaturation,
+    .characteristicType = &kHAPCharacteristicType_Saturation,
+    .debugDescription = kHAPCharacteristicDebugDescription_Saturation,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = false,
+                    .supportsEventNotification = true,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false, .supportsWriteResponse = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .units = kHAPCharacteristicUnits_Percentage,
+    .constraints = { .minimumValue = 0, .maximumValue = 100, .stepValue = 1 },
+    .callbacks = { .handleRead = HandleSaturationRead, .handleWrite = NULL }
+};
+
+static const HAPService lightBulbService = {
+    .iid = kIID_LightBulb,
+    .serviceType = &kHAPServiceType_LightBulb,
+    .debugDescription = kHAPServiceDebugDescription_LightBulb,
+    .name = NULL,
+    .properties = { .primaryService = true, .hidden = false, .ble = { .supportsConfiguration = false } },
+    .linkedServices = NULL,
+    .characteristics = (const HAPCharacteristic* const[]) { &lightBulbOnCharacteristic,
+                                                            &lightBulbBrightnessCharacteristic,
+                                                            &lightBulbHueCharacteristic,
+                                                            &lightBulbSaturationCharacteristic,
+                                                            NULL }
+};
+
+static const HAPAccessory accessory = {
+    .aid = 1,
+    .category = kHAPAccessoryCategory_Lighting,
+    .name = "Acme Light Bulb",
+    .manufacturer = "Acme",
+    .model = "LightBulb1,1",
+    .serialNumber = "099DB48E9E28",
+    .firmwareVersion = "1",
+    .hardwareVersion = "1",
+    .services = (const HAPService* const[]) { &accessoryInformationService,
+                                              &hapProtocolInformationService,
+                                              &pairingService,
+                                              &lightBulbService,
+                                              NULL },
+    .callbacks = { .identify = IdentifyAccessory }
+};
+
+/**
+ * Checks whether a buffer contains a string.
+ *
+ * @param      bytes                Buffer.
+ * @param      numBytes             Length of buffer.
+ * @param      string               String to search for.
+ *
+ * @return true                     If the buffer contains the string.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool ContainsString(const void* bytes, size_t numBytes, const char* string) {
+    HAPPrecondition(bytes);
+    HAPPrecondition(string);
+
+    size_t numStringBytes = HAPStringGetNumBytes(string);
+    for (size_t i = 0; i + numStringBytes <= numBytes; i++) {
+        if (HAPRawBufferAreEqual(&((const uint8_t*) bytes)[i], string, numStringBytes)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int main() {
+    HAPError err;
+    HAPPlatformCreate();
+
+    // Provision accessory server and an admin controller.
+    static const HAPAccessoryServerDeviceID deviceID = { { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 } };
+    err = HAPLegacyImportDeviceID(platform.keyValueStore, &deviceID);
+    HAPAssert(!err);
+    HAPAccessoryServerLongTermSecretKey accessoryLTSK;
+    HAPPlatformRandomNumberFill(accessoryLTSK.bytes, sizeof accessoryLTSK.bytes);
+    err = HAPLegacyImportLongTermSecretKey(platform.keyValueStore, &accessoryLTSK);
+    HAPAssert(!err);
+    uint8_t accessoryLTPK[ED25519_PUBLIC_KEY_BYTES];
+    HAP_ed25519_public_key(accessoryLTPK, accessoryLTSK.bytes);
+
+    static const HAPControllerPairingIdentifier pairingIdentifier = {
+        .bytes = "4E5D4B2F-6A3B-4C1D-9E8F-0A1B2C3D4E5F", .numBytes = 36
+    };
+    uint8_t controllerLTSK[ED25519_SECRET_KEY_BYTES];
+    HAPPlatformRandomNumberFill(controllerLTSK, sizeof controllerLTSK);
+    HAPControllerPublicKey controllerLTPK;
+    HAP_ed25519_public_key(controllerLTPK.bytes, controllerLTSK);
+    err = HAPLegacyImportControllerPairing(
+            platform.keyValueStore, 0, &pairingIdentifier, &controllerLTPK, /* isAdmin: */ true);
+    HAPAssert(!err);
+
+    // Prepare accessory server storage. Event notification storage only has room for the bit sets.
+    static HAPIPAccessoryServerStorage ipAccessoryServerStorage;
+    HAPIPTestStorageCreate(
+            &ipAccessoryServerStorage,
+            &(const HAPIPTestStorageOptions) { .numSessions = kHAPIPSessionStorage_DefaultNumElements,
+                                               .maxCharacteristics = kMaxCharacteristics });
+
+    // Initialize and start accessory server.
+    static HAPAccessoryServerRef accessoryServer;
+    HAPAccessoryServerCreate(
+            &accessoryServer,
+            &(const HAPAccessoryServerOptions) {
+                    .maxPairings = kHAPPairingStorage_MinElements,
+                    .ip = { .transport = &kHAPAccessoryServerTransport_IP,
+                            .accessoryServerStorage = &ipAccessoryServerStorage } },
+            &platform,
+            &(const HAPAccessoryServerCallbacks) { .handleUpdatedState = HandleUpdatedAccessoryServerState },
+            /* context: */ NULL);
+    HAPAccessoryServerStart(&accessoryServer, &accessory);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Running);
+
+    // Connect controller, establish HAP session and subscribe to more characteristics than there are
+    // event notification storage elements.
+    static HAPIPController controller;
+    HAPIPControllerCreate(
+            &controller,
+            &(const HAPIPControllerOptions) { .tcpStreamManager = HAPNonnull(platform.ip.tcpStreamManager),
+                                              .pairingIdentifier = &pairingIdentifier,
+                                              .longTermSecretKey = controllerLTSK,
+                                              .accessoryLongTermPublicKey = accessoryLTPK });
+    err = HAPIPControllerConnect(&controller);
+    HAPAssert(!err);
+    err = HAPIPControllerPairVerify(&controller);
+    HAPAssert(!err);
+    static const char subscribeRequest[] =
+            "{\"characteristics\":["
+            "{\"aid\":1,\"iid\":49,\"ev\":true},"
+            "{\"aid\":1,\"iid\":50,\"ev\":true},"
+            "{\"aid\":1,\"iid\":51,\"ev\":true},"
+            "{\"aid\":1,\"iid\":52,\"ev\":true}]}";
+    static char responseBytes[4 * 1024];
+    size_t numResponseBytes;
+    unsigned int status;
+    err = HAPIPControllerPerformRequest(
+            &controller,
+            "PUT",
+            "/characteristics",
+            "application/hap+json",
+            subscribeRequest,
+            sizeof subscribeRequest - 1,
+            &status,
+            responseBytes,
+            sizeof responseBytes,
+            &numResponseBytes);
+    HAPAssert(!err);
+    HAPAssert(status == 204);
+
+    // Event notifications of all subscribed characteristics are coalesced and delivered.
+    HAPAccessoryServerRaiseEvent(&accessoryServer, &lightBulbOnCharacteristic, &lightBulbService, &accessory);
+    HAPAccessoryServerRaiseEvent(&accessoryServer, &lightBulbBrightnessCharacteristic, &lightBulbService, &accessory);
+    HAPAccessoryServerRaiseEvent(&accessoryServer, &lightBulbHueCharacteristic, &lightBulbService, &accessory);
+    HAPAccessoryServerRaiseEvent(&accessoryServer, &lightBulbSaturationCharacteristic, &lightBulbService, &accessory);
+    HAPPlatformClockAdvance(1 * HAPSecond);
+    err = HAPIPControllerReceiveEvent(&controller, responseBytes, sizeof responseBytes, &numResponseBytes);
+    HAPAssert(!err);
+    HAPAssert(ContainsString(responseBytes, numResponseBytes, "\"iid\":49,\"value\":1"));
+    HAPAssert(ContainsString(responseBytes, numResponseBytes, "\"iid\":50,\"value\":50"));
+    HAPAssert(ContainsString(responseBytes, numResponseBytes, "\"iid\":51,\"value\":120"));
+    HAPAssert(ContainsString(responseBytes, numResponseBytes, "\"iid\":52,\"value\":80"));
+
+    // Stop accessory server.
+    HAPIPControllerDisconnect(&controller);
+    HAPAccessoryServerStop(&accessoryServer);
+    while (!isIdle) {
+        HAPPlatformClockAdvance(0);
+    }
+    HAPAccessoryServerRelease(&accessoryServer);
+
+    return 0;
+}
@@ -0,0 +1,307 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+// Checks that open IP sessions are kept in activity-ordered lists by security and subscription state, and that new
+// connections are only admitted at maximum capacity by evicting unsecured sessions first, then secured sessions that
+// have been idle long enough.
+// Sessions with event notification subscriptions are never evicted.
+//
+// The TCP stream manager accepts more concurrent connections than there are IP sessions,
+// as configured through maxConcurrentTCPStreams on POSIX platforms.
+
+#include "HAP+Internal.h"
+#include "HAPPlatform+Init.h"
+
+#include "Harness/HAPIPController.c"
+#include "Harness/HAPIPTestStorage.c"
+#include "Harness/LightBulbDB.c"
+#include "Harness/TemplateDB.c"
+
+/**
+ * Maximum number of characteristics of the accessory.
+ */
+#define kMaxCharacteristics ((size_t) 32)
+
+/**
+ * Number of IP sessions. Less than the number of TCP streams of the Mock TCP stream manager.
+ */
+#define kNumSessions ((size_t) 3)
+HAP_STATIC_ASSERT(kNumSessions < kHAPIPSessionStorage_DefaultNumElements, NumSessions);
+
+/**
+ * Minimum time a secured IP session must have been idle before it may be evicted.
+ *
+ * - Must match kHAPIPSession_MinIdleTimeBeforeEviction of the IP accessory server.
+ */
+#define kMinIdleTimeBeforeEviction ((HAPTime)(10 * HAPSecond))
+
+static bool isIdle;
+
+static void HandleUpdatedAccessoryServerState(HAPAccessoryServerRef* server, void* _Nullable context HAP_UNUSED) {
+    HAPPrecondition(server);
+
+    isIdle = HAPAccessoryServerGetState(server) == kHAPAccessoryServerState_Idle;
+}
+
+static HAPAccessoryServerRef accessoryServer;
+
+static const HAPControllerPairingIdentifier pairingIdentifier = { .bytes = "4E5D4B2F-6A3B-4C1D-9E8F-0A1B2C3D4E5F",
+                                                                  .numBytes = 36 };
+static uint8_t controllerLTSK[ED25519_SECRET_KEY_BYTES];
+static uint8_t accessoryLTPK[ED25519_PUBLIC_KEY_BYTES];
+
+/**
+ * Connects a simulated controller to the accessory server.
+ *
+ * @param[out] controller           Simulated controller.
+ */
+static void Connect(HAPIPController* controller) {
+    HAPPrecondition(controller);
+
+    HAPError err;
+
+    HAPIPControllerCreate(
+            controller,
+            &(const HAPIPControllerOptions) { .tcpStreamManager = HAPNonnull(platform.ip.tcpStreamManager),
+                                              .pairingIdentifier = &pairingIdentifier,
+                                              .longTermSecretKey = controllerLTSK,
+                                              .accessoryLongTermPublicKey = accessoryLTPK });
+    err = HAPIPControllerConnect(controller);
+    HAPAssert(!err);
+}
+
+/**
+ * Sends a request to read the On characteristic.
+ *
+ * @param      controller           Simulated controller.
+ *
+ * @return true                     If the request was served.
+ * @return false                    If the connection was closed by the accessory server.
+ */
+HAP_RESULT_USE_CHECK
+static bool ReadOn(HAPIPController* controller) {
+    HAPPrecondition(controller);
+
+    HAPError err;
+
+    static char responseBytes[1024];
+    size_t numResponseBytes;
+    unsigned int status;
+    err = HAPIPControllerPerformRequest(
+            controller,
+            "GET",
+            "/characteristics?id=1.49",
+            /* contentType: */ NULL,
+            /* requestBodyBytes: */ NULL,
+            0,
+            &status,
+            responseBytes,
+            sizeof responseBytes,
+            &numResponseBytes);
+    if (err) {
+        HAPAssert(err == kHAPError_InvalidState);
+        return false;
+    }
+    HAPAssert(status == 200);
+    return true;
+}
+
+/**
+ * Subscribes to the On characteristic.
+ *
+ * @param      controller           Simulated controller.
+ */
+static void Subscribe(HAPIPController* controller) {
+    HAPPrecondition(controller);
+
+    HAPError err;
+
+    static const char requestBody[] = "{\"characteristics\":[{\"aid\":1,\"iid\":49,\"ev\":true}]}";
+    size_t numResponseBytes;
+    unsigned int status;
+    err = HAPIPControllerPerformRequest(
+            controller,
+            "PUT",
+            "/characteristics",
+            "application/hap+json",
+            requestBody,
+            sizeof requestBody - 1,
+            &status,
+            /* responseBodyBytes: */ NULL,
+            0,
+            &numResponseBytes);
+    HAPAssert(!err);
+    HAPAssert(status == 204);
+}
+
+/**
+ * Checks that a session activity list is consistent and contains the sessions of the given controllers,
+ * ordered from least recently active to most recently active.
+ *
+ * @param      list                 Session activity list.
+ * @param      controllers          Simulated controllers in expected order, terminated by NULL.
+ */
+static void ExpectActivityList(const HAPIPSessionActivityList* list, HAPIPController* _Nullable const* controllers) {
+    HAPPrecondition(list);
+    HAPPrecondition(controllers);
+
+    const HAPIPSession* _Nullable prevSession = NULL;
+    HAPTime prevStamp = 0;
+    const HAPIPSession* _Nullable ipSession = list->head;
+    size_t i;
+    for (i = 0; controllers[i]; i++) {
+        HAPAssert(ipSession);
+        const HAPIPSessionDescriptor* session = (const HAPIPSessionDescriptor*) &HAPNonnull(ipSession)->descriptor;
+        HAPAssert(session->server == &accessoryServer);
+        HAPAssert(session->tcpStream == HAPIPControllerGetTCPStream(HAPNonnull(controllers[i])));
+        HAPAssert(session->prevActiveSession == prevSession);
+        HAPAssert(session->stamp >= prevStamp);
+        prevSession = ipSession;
+        prevStamp = session->stamp;
+        ipSession = session->nextActiveSession;
+    }
+    HAPAssert(!ipSession);
+    HAPAssert(list->tail == prevSession);
+}
+
+int main() {
+    HAPError err;
+    HAPPlatformCreate();
+
+    // Provision accessory server and a controller. All simulated controllers share the same pairing.
+    static const HAPAccessoryServerDeviceID deviceID = { { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 } };
+    err = HAPLegacyImportDeviceID(platform.keyValueStore, &deviceID);
+    HAPAssert(!err);
+    HAPAccessoryServerLongTermSecretKey accessoryLTSK;
+    HAPPlatformRandomNumberFill(accessoryLTSK.bytes, sizeof accessoryLTSK.bytes);
+    err = HAPLegacyImportLongTermSecretKey(platform.keyValueStore, &accessoryLTSK);
+    HAPAssert(!err);
+    HAP_ed25519_public_key(accessoryLTPK, accessoryLTSK.bytes);
+    HAPPlatformRandomNumberFill(controllerLTSK, sizeof controllerLTSK);
+    HAPControllerPublicKey controllerLTPK;
+    HAP_ed25519_public_key(controllerLTPK.bytes, controllerLTSK);
+    err = HAPLegacyImportControllerPairing(
+            platform.keyValueStore, 0, &pairingIdentifier, &controllerLTPK, /* isAdmin: */ true);
+    HAPAssert(!err);
+
+    // Prepare accessory server storage.
+    static HAPIPAccessoryServerStorage ipAccessoryServerStorage;
+    HAPIPTestStorageCreate(
+            &ipAccessoryServerStorage,
+            &(const HAPIPTestStorageOptions) { .numSessions = kNumSessions,
+                                               .maxCharacteristics = kMaxCharacteristics });
+
+    // Initialize and start accessory server.
+    HAPAccessoryServerCreate(
+            &accessoryServer,
+            &(const HAPAccessoryServerOptions) {
+                    .maxPairings = kHAPPairingStorage_MinElements,
+                    .ip = { .transport = &kHAPAccessoryServerTransport_IP,
+                            .accessoryServerStorage = &ipAccessoryServerStorage } },
+            &platform,
+            &(const HAPAccessoryServerCallbacks) { .handleUpdatedState = HandleUpdatedAccessoryServerState },
+            /* context: */ NULL);
+    HAPAccessoryServerStart(&accessoryServer, &lightBulbAccessory);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Running);
+    const HAPAccessoryServer* server = (const HAPAccessoryServer*) &accessoryServer;
+
+    // Sessions are ordered by time of last activity.
+    static HAPIPController a, b, c, d, e, f, g, h;
+    Connect(&a);
+    err = HAPIPControllerPairVerify(&a);
+    HAPAssert(!err);
+    HAPPlatformClockAdvance(1 * HAPSecond);
+    Connect(&b);
+    err = HAPIPControllerPairVerify(&b);
+    HAPAssert(!err);
+    HAPPlatformClockAdvance(1 * HAPSecond);
+    Connect(&c);
+    ExpectActivityList(&server->ip.unsecuredSessions, (HAPIPController* const[]) { &c, NULL });
+    ExpectActivityList(&server->ip.unsubscribedSessions, (HAPIPController* const[]) { &a, &b, NULL });
+    ExpectActivityList(&server->ip.subscribedSessions, (HAPIPController* const[]) { NULL });
+    HAPPlatformClockAdvance(1 * HAPSecond);
+    HAPAssert(ReadOn(&a));
+    ExpectActivityList(&server->ip.unsubscribedSessions, (HAPIPController* const[]) { &b, &a, NULL });
+
+    // At maximum capacity, unsecured sessions are evicted first, even if secured sessions were less recently active.
+    Connect(&d);
+    ExpectActivityList(&server->ip.unsecuredSessions, (HAPIPController* const[]) { &d, NULL });
+    ExpectActivityList(&server->ip.unsubscribedSessions, (HAPIPController* const[]) { &b, &a, NULL });
+    HAPAssert(!ReadOn(&c));
+    HAPIPControllerDisconnect(&c);
+    Connect(&e);
+    ExpectActivityList(&server->ip.unsecuredSessions, (HAPIPController* const[]) { &e, NULL });
+    ExpectActivityList(&server->ip.unsubscribedSessions, (HAPIPController* const[]) { &b, &a, NULL });
+    HAPAssert(!ReadOn(&d));
+    HAPIPControllerDisconnect(&d);
+
+    // Sessions move to the secured sessions once Pair Verify completes.
+    err = HAPIPControllerPairVerify(&e);
+    HAPAssert(!err);
+    ExpectActivityList(&server->ip.unsecuredSessions, (HAPIPController* const[]) { NULL });
+    ExpectActivityList(&server->ip.unsubscribedSessions, (HAPIPController* const[]) { &b, &a, &e, NULL });
+    HAPAssert(server->statistics.ip.numSessionsAccepted == 5);
+
+    // Secured sessions that were active recently are not evicted. The new connection is rejected instead.
+    HAPPlatformClockAdvance(kMinIdleTimeBeforeEviction - 3 * HAPSecond);
+    Connect(&f);
+    HAPAssert(!ReadOn(&f));
+    HAPIPControllerDisconnect(&f);
+    HAPAssert(server->statistics.ip.numSessionsAccepted == 5);
+    ExpectActivityList(&server->ip.unsubscribedSessions, (HAPIPController* const[]) { &b, &a, &e, NULL });
+
+    // Sessions with event notification subscriptions move to the subscribed list.
+    Subscribe(&a);
+    ExpectActivityList(&server->ip.unsubscribedSessions, (HAPIPController* const[]) { &b, &e, NULL });
+    ExpectActivityList(&server->ip.subscribedSessions, (HAPIPController* const[]) { &a, NULL });
+
+    // Once idle long enough, the least recently active secured session is evicted.
+    HAPPlatformClockAdvance(3 * HAPSecond);
+    Connect(&g);
+    ExpectActivityList(&server->ip.unsecuredSessions, (HAPIPController* const[]) { &g, NULL });
+    ExpectActivityList(&server->ip.unsubscribedSessions, (HAPIPController* const[]) { &e, NULL });
+    HAPAssert(!ReadOn(&b));
+    HAPIPControllerDisconnect(&b);
+    err = HAPIPControllerPairVerify(&g);
+    HAPAssert(!err);
+    Subscribe(&e);
+    Subscribe(&g);
+    ExpectActivityList(&server->ip.unsecuredSessions, (HAPIPController* const[]) { NULL });
+    ExpectActivityList(&server->ip.unsubscribedSessions, (HAPIPController* const[]) { NULL });
+    ExpectActivityList(&server->ip.subscribedSessions, (HAPIPController* const[]) { &a, &e, &g, NULL });
+
+    // Sessions with event notification subscriptions are never evicted.
+    HAPPlatformClockAdvance(kMinIdleTimeBeforeEviction);
+    Connect(&h);
+    HAPAssert(!ReadOn(&h));
+    HAPIPControllerDisconnect(&h);
+    ExpectActivityList(&server->ip.subscribedSessions, (HAPIPController* const[]) { &a, &e, &g, NULL });
+    HAPAssert(ReadOn(&a));
+    HAPAssert(ReadOn(&e));
+    HAPAssert(ReadOn(&g));
+    ExpectActivityList(&server->ip.subscribedSessions, (HAPIPController* const[]) { &a, &e, &g, NULL });
+
+    // Sessions that are closed by the controller free up storage without eviction.
+    HAPIPControllerDisconnect(&e);
+    HAPPlatformClockAdvance(0);
+    Connect(&c);
+    ExpectActivityList(&server->ip.unsecuredSessions, (HAPIPController* const[]) { &c, NULL });
+    ExpectActivityList(&server->ip.unsubscribedSessions, (HAPIPController* const[]) { NULL });
+    ExpectActivityList(&server->ip.subscribedSessions, (HAPIPController* const[]) { &a, &g, NULL });
+
+    // Stop accessory server.
+    HAPIPControllerDisconnect(&a);
+    HAPIPControllerDisconnect(&g);
+    HAPIPControllerDisconnect(&c);
+    HAPAccessoryServerStop(&accessoryServer);
+    while (!isIdle) {
+        HAPPlatformClockAdvance(0);
+    }
+    HAPAccessoryServerRelease(&accessoryServer);
+
+    return 0;
+}
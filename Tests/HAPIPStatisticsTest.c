@@ -0,0 +1,448 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+// Checks that the accessory server statistics count IP requests and record their latency into the expected histogram
+// buckets. Slow characteristic handlers are simulated by advancing the mock clock while a request is handled.
+
+#include "HAP+Internal.h"
+#include "HAPPlatform+Init.h"
+
+#include "Harness/HAPIPController.c"
+#include "Harness/HAPIPTestStorage.c"
+#include "Harness/TemplateDB.c"
+
+#define kIID_LightBulb           ((uint64_t) 0x0030)
+#define kIID_LightBulbOn         ((uint64_t) 0x0031)
+#define kIID_LightBulbBrightness ((uint64_t) 0x0032)
+
+/**
+ * Maximum number of characteristics of the accessory.
+ */
+#define kMaxCharacteristics ((size_t) 32)
+
+/**
+ * Number of IP sessions.
+ */
+#define kNumSessions ((size_t) 2)
+
+static bool isIdle;
+
+static void HandleUpdatedAccessoryServerState(HAPAccessoryServerRef* server, void* _Nullable context HAP_UNUSED) {
+    HAPPrecondition(server);
+
+    isIdle = HAPAccessoryServerGetState(server) == kHAPAccessoryServerState_Idle;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError IdentifyAccessory(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPAccessoryIdentifyRequest* request HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    return kHAPError_None;
+}
+
+/**
+ * State of the light bulb, and time that the read and write handlers take.
+ */
+static struct {
+    bool on;
+    int32_t brightness;
+
+    HAPTime readDuration;
+    HAPTime writeDuration;
+} state = { .on = true, .brightness = 50 };
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleOnRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPBoolCharacteristicReadRequest* request HAP_UNUSED,
+        bool* value,
+        void* _Nullable context HAP_UNUSED) {
+    HAPPlatformClockAdvanceWithoutTimers(state.readDuration);
+    *value = state.on;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleOnWrite(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPBoolCharacteristicWriteRequest* request HAP_UNUSED,
+        bool value,
+        void* _Nullable context HAP_UNUSED) {
+    HAPPlatformClockAdvanceWithoutTimers(state.writeDuration);
+    state.on = value;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleBrightnessRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPIntCharacteristicReadRequest* request HAP_UNUSED,
+        int32_t* value,
+        void* _Nullable context HAP_UNUSED) {
+    *value = state.brightness;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleBrightnessWrite(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPIntCharacteristicWriteRequest* request HAP_UNUSED,
+        int32_t value,
+        void* _Nullable context HAP_UNUSED) {
+    state.brightness = value;
+    return kHAPError_None;
+}
+
+static const HAPBoolCharacteristic lightBulbOnCharacteristic = {
+    .format = kHAPCharacteristicFormat_Bool,
+    .iid = kIID_LightBulbOn,
+    .characteristicType = &kHAPCharacteristicType_On,
+    .debugDescription = kHAPCharacteristicDebugDescription_On,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = true,
+                    .supportsEventNotification = true,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false, .supportsWriteResponse = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .callbacks = { .handleRead = HandleOnRead, .handleWrite = HandleOnWrite }
+};
+
+static const HAPIntCharacteristic lightBulbBrightnessCharacteristic = {
+    .format = kHAPCharacteristicFormat_Int,
+    .iid = kIID_LightBulbBrightness,
+    .characteristicType = &kHAPCharacteristicType_Brightness,
+    .debugDescription = kHAPCharacteristicDebugDescription_Brightness,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = true,
+                    .supportsEventNotification = true,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false, .supportsWriteResponse = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .units = kHAPCharacteristicUnits_Percentage,
+    .constraints = { .minimumValue = 0, .maximumValue = 100, .stepValue = 1 },
+    .callbacks = { .handleRead = HandleBrightnessRead, .handleWrite = HandleBrightnessWrite }
+};
+
+static const HAPService lightBulbService = {
+    .iid = kIID_LightBulb,
+    .serviceType = &kHAPServiceType_LightBulb,
+    .debugDescription = kHAPServiceDebugDescription_LightBulb,
+    .name = NULL,
+    .properties = { .primaryService = true, .hidden = false, .ble = { .supportsConfiguration = false } },
+    .linkedServices = NULL,
+    .characteristics = (const HAPCharacteristic* const[]) { &lightBulbOnCharacteristic,
+                                                            &lightBulbBrightnessCharacteristic,
+                                                            NULL }
+};
+
+static const HAPAccessory accessory = {
+    .aid = 1,
+    .category = kHAPAccessoryCategory_Lighting,
+    .name = "Acme Light Bulb",
+    .manufacturer = "Acme",
+    .model = "LightBulb1,1",
+    .serialNumber = "099DB48E9E28",
+    .firmwareVersion = "1",
+    .hardwareVersion = "1",
+    .services = (const HAPService* const[]) { &accessoryInformationService,
+                                              &hapProtocolInformationService,
+                                              &pairingService,
+                                              &lightBulbService,
+                                              NULL },
+    .callbacks = { .identify = IdentifyAccessory }
+};
+
+static HAPAccessoryServerRef accessoryServer;
+
+static const HAPControllerPairingIdentifier pairingIdentifier = { .bytes = "4E5D4B2F-6A3B-4C1D-9E8F-0A1B2C3D4E5F",
+                                                                  .numBytes = 36 };
+static uint8_t controllerLTSK[ED25519_SECRET_KEY_BYTES];
+static uint8_t accessoryLTPK[ED25519_PUBLIC_KEY_BYTES];
+
+/**
+ * Connects a simulated controller to the accessory server and establishes a HAP session.
+ *
+ * @param[out] controller           Simulated controller.
+ */
+static void Connect(HAPIPController* controller) {
+    HAPPrecondition(controller);
+
+    HAPError err;
+
+    HAPIPControllerCreate(
+            controller,
+            &(const HAPIPControllerOptions) { .tcpStreamManager = HAPNonnull(platform.ip.tcpStreamManager),
+                                              .pairingIdentifier = &pairingIdentifier,
+                                              .longTermSecretKey = controllerLTSK,
+                                              .accessoryLongTermPublicKey = accessoryLTPK });
+    err = HAPIPControllerConnect(controller);
+    HAPAssert(!err);
+    err = HAPIPControllerPairVerify(controller);
+    HAPAssert(!err);
+}
+
+/**
+ * Sends a request to the accessory server and checks the HTTP status code of the response.
+ *
+ * @param      controller           Simulated controller.
+ * @param      method               HTTP method.
+ * @param      uri                  Request URI.
+ * @param      requestBody          Request body in JSON format, or NULL if the request has no body.
+ * @param      expectedStatus       Expected HTTP status code.
+ */
+static void PerformRequest(
+        HAPIPController* controller,
+        const char* method,
+        const char* uri,
+        const char* _Nullable requestBody,
+        unsigned int expectedStatus) {
+    HAPPrecondition(controller);
+    HAPPrecondition(method);
+    HAPPrecondition(uri);
+
+    HAPError err;
+
+    static char responseBytes[4096];
+    size_t numResponseBytes;
+    unsigned int status;
+    err = HAPIPControllerPerformRequest(
+            controller,
+            method,
+            uri,
+            requestBody ? "application/hap+json" : NULL,
+            requestBody,
+            requestBody ? HAPStringGetNumBytes(HAPNonnull(requestBody)) : 0,
+            &status,
+            responseBytes,
+            sizeof responseBytes,
+            &numResponseBytes);
+    HAPAssert(!err);
+    HAPAssert(status == expectedStatus);
+}
+
+/**
+ * Checks the latency histogram of a request type.
+ *
+ * @param      requestType          Request type.
+ * @param      expectedBuckets      Expected number of recorded latencies per bucket.
+ * @param      maxLatency           Expected largest recorded latency in milliseconds.
+ * @param      totalLatency         Expected sum of all recorded latencies in milliseconds.
+ */
+static void ExpectHistogram(
+        HAPAccessoryServerRequestType requestType,
+        const uint32_t expectedBuckets[_Nonnull kHAPLatencyHistogram_NumBuckets],
+        uint32_t maxLatency,
+        uint64_t totalLatency) {
+    HAPPrecondition(expectedBuckets);
+
+    HAPAccessoryServerStatistics statistics;
+    HAPAccessoryServerGetStatistics(&accessoryServer, &statistics);
+    const HAPLatencyHistogram* histogram = &statistics.requests[requestType];
+    uint32_t numSamples = 0;
+    for (size_t i = 0; i < kHAPLatencyHistogram_NumBuckets; i++) {
+        HAPAssert(histogram->buckets[i] == expectedBuckets[i]);
+        numSamples += expectedBuckets[i];
+    }
+    HAPAssert(histogram->numSamples == numSamples);
+    HAPAssert(histogram->maxLatency == maxLatency);
+    HAPAssert(histogram->totalLatency == totalLatency);
+}
+
+/**
+ * Sums up the statistics of all open IP sessions.
+ */
+static void SumIPSessionStatistics(
+        void* _Nullable context,
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPIPSessionStatistics* statistics,
+        bool* shouldContinue) {
+    HAPPrecondition(context);
+    HAPIPSessionStatistics* sum = context;
+    HAPPrecondition(statistics);
+    HAPPrecondition(shouldContinue);
+
+    sum->numBytesReceived += statistics->numBytesReceived;
+    sum->numBytesSent += statistics->numBytesSent;
+}
+
+/**
+ * Gets the callback statistics of the On characteristic.
+ */
+static void GetOnCharacteristicStatistics(
+        void* _Nullable context,
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPCharacteristicStatistics* statistics,
+        bool* shouldContinue) {
+    HAPPrecondition(context);
+    HAPCharacteristicStatistics* onStatistics = context;
+    HAPPrecondition(statistics);
+    HAPPrecondition(shouldContinue);
+
+    if (statistics->characteristic == (const HAPCharacteristic*) &lightBulbOnCharacteristic) {
+        *onStatistics = *statistics;
+        *shouldContinue = false;
+    }
+}
+
+int main() {
+    HAPError err;
+    HAPPlatformCreate();
+
+    // Provision accessory server and a controller.
+    static const HAPAccessoryServerDeviceID deviceID = { { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 } };
+    err = HAPLegacyImportDeviceID(platform.keyValueStore, &deviceID);
+    HAPAssert(!err);
+    HAPAccessoryServerLongTermSecretKey accessoryLTSK;
+    HAPPlatformRandomNumberFill(accessoryLTSK.bytes, sizeof accessoryLTSK.bytes);
+    err = HAPLegacyImportLongTermSecretKey(platform.keyValueStore, &accessoryLTSK);
+    HAPAssert(!err);
+    HAP_ed25519_public_key(accessoryLTPK, accessoryLTSK.bytes);
+    HAPPlatformRandomNumberFill(controllerLTSK, sizeof controllerLTSK);
+    HAPControllerPublicKey controllerLTPK;
+    HAP_ed25519_public_key(controllerLTPK.bytes, controllerLTSK);
+    err = HAPLegacyImportControllerPairing(
+            platform.keyValueStore, 0, &pairingIdentifier, &controllerLTPK, /* isAdmin: */ true);
+    HAPAssert(!err);
+
+    // Prepare accessory server storage.
+    static HAPIPAccessoryServerStorage ipAccessoryServerStorage;
+    HAPIPTestStorageCreate(
+            &ipAccessoryServerStorage,
+            &(const HAPIPTestStorageOptions) { .numSessions = kNumSessions,
+                                               .maxCharacteristics = kMaxCharacteristics });
+
+    // Initialize and start accessory server.
+    HAPAccessoryServerCreate(
+            &accessoryServer,
+            &(const HAPAccessoryServerOptions) {
+                    .maxPairings = kHAPPairingStorage_MinElements,
+                    .ip = { .transport = &kHAPAccessoryServerTransport_IP,
+                            .accessoryServerStorage = &ipAccessoryServerStorage } },
+            &platform,
+            &(const HAPAccessoryServerCallbacks) { .handleUpdatedState = HandleUpdatedAccessoryServerState },
+            /* context: */ NULL);
+    HAPAccessoryServerStart(&accessoryServer, &accessory);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Running);
+
+    // No requests have been handled yet.
+    HAPAccessoryServerStatistics statistics;
+    HAPAccessoryServerGetStatistics(&accessoryServer, &statistics);
+    for (size_t i = 0; i < HAPArrayCount(statistics.requests); i++) {
+        HAPAssert(!statistics.requests[i].numSamples);
+    }
+    HAPAssert(!statistics.ip.numSessionsAccepted);
+
+    // Pair Verify is recorded as one request per message.
+    static HAPIPController a;
+    Connect(&a);
+    HAPAccessoryServerGetStatistics(&accessoryServer, &statistics);
+    HAPAssert(statistics.ip.numSessionsAccepted == 1);
+    HAPAssert(statistics.requests[kHAPAccessoryServerRequestType_PairVerify].numSamples == 2);
+    HAPAssert(statistics.ip.numBytesReceived);
+    HAPAssert(statistics.ip.numBytesSent);
+
+    // Resetting clears all statistics, including those of open sessions.
+    HAPAccessoryServerResetStatistics(&accessoryServer);
+    HAPAccessoryServerGetStatistics(&accessoryServer, &statistics);
+    HAPAssert(!statistics.requests[kHAPAccessoryServerRequestType_PairVerify].numSamples);
+    HAPAssert(!statistics.ip.numSessionsAccepted);
+    HAPAssert(!statistics.ip.numBytesReceived);
+    HAPAssert(!statistics.ip.numBytesSent);
+    HAPIPSessionStatistics sessionStatistics;
+    HAPRawBufferZero(&sessionStatistics, sizeof sessionStatistics);
+    HAPAccessoryServerEnumerateIPSessionStatistics(&accessoryServer, SumIPSessionStatistics, &sessionStatistics);
+    HAPAssert(!sessionStatistics.numBytesReceived);
+    HAPAssert(!sessionStatistics.numBytesSent);
+
+    // Latencies below 1 ms are recorded in bucket 0. Bucket i records latencies in [2^(i-1), 2^i) ms.
+    state.readDuration = 0;
+    PerformRequest(&a, "GET", "/characteristics?id=1.49", /* requestBody: */ NULL, 200);
+    state.readDuration = 1;
+    PerformRequest(&a, "GET", "/characteristics?id=1.49", /* requestBody: */ NULL, 200);
+    state.readDuration = 5;
+    PerformRequest(&a, "GET", "/characteristics?id=1.49", /* requestBody: */ NULL, 200);
+    state.readDuration = 8;
+    PerformRequest(&a, "GET", "/characteristics?id=1.49", /* requestBody: */ NULL, 200);
+    ExpectHistogram(
+            kHAPAccessoryServerRequestType_GetCharacteristics,
+            (const uint32_t[kHAPLatencyHistogram_NumBuckets]) { [0] = 1, [1] = 1, [3] = 1, [4] = 1 },
+            /* maxLatency: */ 8,
+            /* totalLatency: */ 14);
+
+    // Latencies that exceed the range of the last bucket are recorded in the last bucket.
+    static const char writeRequest[] = "{\"characteristics\":[{\"aid\":1,\"iid\":49,\"value\":false}]}";
+    state.writeDuration = 100;
+    PerformRequest(&a, "PUT", "/characteristics", writeRequest, 204);
+    state.writeDuration = 1 * HAPMinute;
+    PerformRequest(&a, "PUT", "/characteristics", writeRequest, 204);
+    ExpectHistogram(
+            kHAPAccessoryServerRequestType_PutCharacteristics,
+            (const uint32_t[kHAPLatencyHistogram_NumBuckets]) { [7] = 1, [kHAPLatencyHistogram_NumBuckets - 1] = 1 },
+            /* maxLatency: */ 1 * HAPMinute,
+            /* totalLatency: */ 100 + 1 * HAPMinute);
+    HAPAccessoryServerGetStatistics(&accessoryServer, &statistics);
+    HAPAssert(!statistics.requests[kHAPAccessoryServerRequestType_GetAccessories].numSamples);
+    HAPAssert(!statistics.requests[kHAPAccessoryServerRequestType_BLEProcedure].numSamples);
+
+    // Characteristic callbacks are timed separately.
+    HAPCharacteristicStatistics onStatistics;
+    HAPRawBufferZero(&onStatistics, sizeof onStatistics);
+    HAPAccessoryServerEnumerateCharacteristicStatistics(&accessoryServer, GetOnCharacteristicStatistics, &onStatistics);
+    HAPAssert(onStatistics.characteristic == (const HAPCharacteristic*) &lightBulbOnCharacteristic);
+    HAPAssert(onStatistics.read.numCalls == 4);
+    HAPAssert(onStatistics.read.maxDuration == 8);
+    HAPAssert(onStatistics.read.totalDuration == 14);
+    HAPAssert(onStatistics.write.numCalls == 2);
+    HAPAssert(onStatistics.write.maxDuration == 1 * HAPMinute);
+    HAPAssert(onStatistics.write.totalDuration == 100 + 1 * HAPMinute);
+
+    // Sent event notifications are counted.
+    state.writeDuration = 0;
+    PerformRequest(
+            &a, "PUT", "/characteristics", "{\"characteristics\":[{\"aid\":1,\"iid\":49,\"ev\":true}]}", 204);
+    state.on = true;
+    HAPAccessoryServerRaiseEvent(&accessoryServer, &lightBulbOnCharacteristic, &lightBulbService, &accessory);
+    HAPPlatformClockAdvance(1 * HAPSecond);
+    static uint8_t eventBytes[1024];
+    size_t numEventBytes;
+    err = HAPIPControllerReceiveEvent(&a, eventBytes, sizeof eventBytes, &numEventBytes);
+    HAPAssert(!err);
+    HAPAccessoryServerGetStatistics(&accessoryServer, &statistics);
+    HAPAssert(statistics.requests[kHAPAccessoryServerRequestType_EventNotification].numSamples == 1);
+    HAPAssert(statistics.requests[kHAPAccessoryServerRequestType_PutCharacteristics].numSamples == 3);
+
+    // Byte counters of the accessory server are the sum of those of the open sessions.
+    HAPRawBufferZero(&sessionStatistics, sizeof sessionStatistics);
+    HAPAccessoryServerEnumerateIPSessionStatistics(&accessoryServer, SumIPSessionStatistics, &sessionStatistics);
+    HAPAssert(statistics.ip.numBytesReceived);
+    HAPAssert(statistics.ip.numBytesSent);
+    HAPAssert(sessionStatistics.numBytesReceived == statistics.ip.numBytesReceived);
+    HAPAssert(sessionStatistics.numBytesSent == statistics.ip.numBytesSent);
+
+    // Stop accessory server.
+    HAPIPControllerDisconnect(&a);
+    HAPAccessoryServerStop(&accessoryServer);
+    while (!isIdle) {
+        HAPPlatformClockAdvance(0);
+    }
+    HAPAccessoryServerRelease(&accessoryServer);
+
+    return 0;
+}
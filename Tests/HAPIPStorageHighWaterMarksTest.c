@@ -0,0 +1,353 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+// Checks that the IP storage high-water marks track the storage that is used by sessions, read and write requests,
+// and that they never exceed the storage that is provided to the accessory server.
+
+#include "HAP+Internal.h"
+#include "HAPPlatform+Init.h"
+
+#include "Harness/HAPIPController.c"
+#include "Harness/HAPIPTestStorage.c"
+#include "Harness/TemplateDB.c"
+
+#define kIID_LightBulb           ((uint64_t) 0x0030)
+#define kIID_LightBulbOn         ((uint64_t) 0x0031)
+#define kIID_LightBulbBrightness ((uint64_t) 0x0032)
+
+/**
+ * Maximum number of characteristics of the accessory.
+ */
+#define kMaxCharacteristics ((size_t) 32)
+
+/**
+ * Number of IP sessions.
+ */
+#define kNumSessions ((size_t) 3)
+
+static bool isIdle;
+
+static void HandleUpdatedAccessoryServerState(HAPAccessoryServerRef* server, void* _Nullable context HAP_UNUSED) {
+    HAPPrecondition(server);
+
+    isIdle = HAPAccessoryServerGetState(server) == kHAPAccessoryServerState_Idle;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError IdentifyAccessory(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPAccessoryIdentifyRequest* request HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    return kHAPError_None;
+}
+
+/**
+ * State of the light bulb.
+ */
+static struct {
+    bool on;
+    int32_t brightness;
+} state = { .on = true, .brightness = 50 };
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleOnRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPBoolCharacteristicReadRequest* request HAP_UNUSED,
+        bool* value,
+        void* _Nullable context HAP_UNUSED) {
+    *value = state.on;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleOnWrite(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPBoolCharacteristicWriteRequest* request HAP_UNUSED,
+        bool value,
+        void* _Nullable context HAP_UNUSED) {
+    state.on = value;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleBrightnessRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPIntCharacteristicReadRequest* request HAP_UNUSED,
+        int32_t* value,
+        void* _Nullable context HAP_UNUSED) {
+    *value = state.brightness;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleBrightnessWrite(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPIntCharacteristicWriteRequest* request HAP_UNUSED,
+        int32_t value,
+        void* _Nullable context HAP_UNUSED) {
+    state.brightness = value;
+    return kHAPError_None;
+}
+
+static const HAPBoolCharacteristic lightBulbOnCharacteristic = {
+    .format = kHAPCharacteristicFormat_Bool,
+    .iid = kIID_LightBulbOn,
+    .characteristicType = &kHAPCharacteristicType_On,
+    .debugDescription = kHAPCharacteristicDebugDescription_On,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = true,
+                    .supportsEventNotification = true,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false, .supportsWriteResponse = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .callbacks = { .handleRead = HandleOnRead, .handleWrite = HandleOnWrite }
+};
+
+static const HAPIntCharacteristic lightBulbBrightnessCharacteristic = {
+    .format = kHAPCharacteristicFormat_Int,
+    .iid = kIID_LightBulbBrightness,
+    .characteristicType = &kHAPCharacteristicType_Brightness,
+    .debugDescription = kHAPCharacteristicDebugDescription_Brightness,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = true,
+                    .supportsEventNotification = true,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false, .supportsWriteResponse = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .units = kHAPCharacteristicUnits_Percentage,
+    .constraints = { .minimumValue = 0, .maximumValue = 100, .stepValue = 1 },
+    .callbacks = { .handleRead = HandleBrightnessRead, .handleWrite = HandleBrightnessWrite }
+};
+
+static const HAPService lightBulbService = {
+    .iid = kIID_LightBulb,
+    .serviceType = &kHAPServiceType_LightBulb,
+    .debugDescription = kHAPServiceDebugDescription_LightBulb,
+    .name = NULL,
+    .properties = { .primaryService = true, .hidden = false, .ble = { .supportsConfiguration = false } },
+    .linkedServices = NULL,
+    .characteristics = (const HAPCharacteristic* const[]) { &lightBulbOnCharacteristic,
+                                                            &lightBulbBrightnessCharacteristic,
+                                                            NULL }
+};
+
+static const HAPAccessory accessory = {
+    .aid = 1,
+    .category = kHAPAccessoryCategory_Lighting,
+    .name = "Acme Light Bulb",
+    .manufacturer = "Acme",
+    .model = "LightBulb1,1",
+    .serialNumber = "099DB48E9E28",
+    .firmwareVersion = "1",
+    .hardwareVersion = "1",
+    .services = (const HAPService* const[]) { &accessoryInformationService,
+                                              &hapProtocolInformationService,
+                                              &pairingService,
+                                              &lightBulbService,
+                                              NULL },
+    .callbacks = { .identify = IdentifyAccessory }
+};
+
+static HAPAccessoryServerRef accessoryServer;
+
+static const HAPControllerPairingIdentifier pairingIdentifier = { .bytes = "4E5D4B2F-6A3B-4C1D-9E8F-0A1B2C3D4E5F",
+                                                                  .numBytes = 36 };
+static uint8_t controllerLTSK[ED25519_SECRET_KEY_BYTES];
+static uint8_t accessoryLTPK[ED25519_PUBLIC_KEY_BYTES];
+
+/**
+ * Connects a simulated controller to the accessory server and establishes a HAP session.
+ *
+ * @param[out] controller           Simulated controller.
+ */
+static void Connect(HAPIPController* controller) {
+    HAPPrecondition(controller);
+
+    HAPError err;
+
+    HAPIPControllerCreate(
+            controller,
+            &(const HAPIPControllerOptions) { .tcpStreamManager = HAPNonnull(platform.ip.tcpStreamManager),
+                                              .pairingIdentifier = &pairingIdentifier,
+                                              .longTermSecretKey = controllerLTSK,
+                                              .accessoryLongTermPublicKey = accessoryLTPK });
+    err = HAPIPControllerConnect(controller);
+    HAPAssert(!err);
+    err = HAPIPControllerPairVerify(controller);
+    HAPAssert(!err);
+}
+
+/**
+ * Sends a request to the accessory server and checks the HTTP status code of the response.
+ *
+ * @param      controller           Simulated controller.
+ * @param      method               HTTP method.
+ * @param      uri                  Request URI.
+ * @param      requestBody          Request body in JSON format, or NULL if the request has no body.
+ * @param      expectedStatus       Expected HTTP status code.
+ */
+static void PerformRequest(
+        HAPIPController* controller,
+        const char* method,
+        const char* uri,
+        const char* _Nullable requestBody,
+        unsigned int expectedStatus) {
+    HAPPrecondition(controller);
+    HAPPrecondition(method);
+    HAPPrecondition(uri);
+
+    HAPError err;
+
+    static char responseBytes[4096];
+    size_t numResponseBytes;
+    unsigned int status;
+    err = HAPIPControllerPerformRequest(
+            controller,
+            method,
+            uri,
+            requestBody ? "application/hap+json" : NULL,
+            requestBody,
+            requestBody ? HAPStringGetNumBytes(HAPNonnull(requestBody)) : 0,
+            &status,
+            responseBytes,
+            sizeof responseBytes,
+            &numResponseBytes);
+    HAPAssert(!err);
+    HAPAssert(status == expectedStatus);
+}
+
+int main() {
+    HAPError err;
+    HAPPlatformCreate();
+
+    // Provision accessory server and a controller.
+    static const HAPAccessoryServerDeviceID deviceID = { { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 } };
+    err = HAPLegacyImportDeviceID(platform.keyValueStore, &deviceID);
+    HAPAssert(!err);
+    HAPAccessoryServerLongTermSecretKey accessoryLTSK;
+    HAPPlatformRandomNumberFill(accessoryLTSK.bytes, sizeof accessoryLTSK.bytes);
+    err = HAPLegacyImportLongTermSecretKey(platform.keyValueStore, &accessoryLTSK);
+    HAPAssert(!err);
+    HAP_ed25519_public_key(accessoryLTPK, accessoryLTSK.bytes);
+    HAPPlatformRandomNumberFill(controllerLTSK, sizeof controllerLTSK);
+    HAPControllerPublicKey controllerLTPK;
+    HAP_ed25519_public_key(controllerLTPK.bytes, controllerLTSK);
+    err = HAPLegacyImportControllerPairing(
+            platform.keyValueStore, 0, &pairingIdentifier, &controllerLTPK, /* isAdmin: */ true);
+    HAPAssert(!err);
+
+    // Prepare accessory server storage.
+    static HAPIPAccessoryServerStorage ipAccessoryServerStorage;
+    HAPIPTestStorageCreate(
+            &ipAccessoryServerStorage,
+            &(const HAPIPTestStorageOptions) { .numSessions = kNumSessions,
+                                               .maxCharacteristics = kMaxCharacteristics });
+
+    // Initialize and start accessory server.
+    HAPAccessoryServerCreate(
+            &accessoryServer,
+            &(const HAPAccessoryServerOptions) {
+                    .maxPairings = kHAPPairingStorage_MinElements,
+                    .ip = { .transport = &kHAPAccessoryServerTransport_IP,
+                            .accessoryServerStorage = &ipAccessoryServerStorage } },
+            &platform,
+            &(const HAPAccessoryServerCallbacks) { .handleUpdatedState = HandleUpdatedAccessoryServerState },
+            /* context: */ NULL);
+    HAPAccessoryServerStart(&accessoryServer, &accessory);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Running);
+
+    // Element counts that only depend on the accessory database are known once the accessory server is started.
+    HAPAccessoryServerStorageUsage requirements;
+    HAPAccessoryServerGetStorageRequirements(&accessory, /* bridgedAccessories: */ NULL, &requirements);
+    HAPAccessoryServerStorageUsage highWaterMarks;
+    HAPAccessoryServerGetStorageHighWaterMarks(&accessoryServer, &highWaterMarks);
+    HAPAssert(highWaterMarks.ip.numCharacteristicIndexElements == requirements.ip.numCharacteristicIndexElements);
+    HAPAssert(highWaterMarks.ip.numEventNotifications == requirements.ip.numEventNotifications);
+    HAPAssert(highWaterMarks.ip.numValueCacheElements == requirements.ip.numValueCacheElements);
+    HAPAssert(!highWaterMarks.ip.numSessions);
+    HAPAssert(!highWaterMarks.ip.numReadContexts);
+    HAPAssert(!highWaterMarks.ip.numWriteContexts);
+    HAPAssert(!highWaterMarks.ip.numInboundBufferBytes);
+    HAPAssert(!highWaterMarks.ip.numOutboundBufferBytes);
+
+    // Sessions are counted while they are open. The high-water mark is kept when sessions are closed.
+    static HAPIPController a, b;
+    Connect(&a);
+    HAPAccessoryServerGetStorageHighWaterMarks(&accessoryServer, &highWaterMarks);
+    HAPAssert(highWaterMarks.ip.numSessions == 1);
+    HAPAssert(highWaterMarks.ip.numInboundBufferBytes);
+    HAPAssert(highWaterMarks.ip.numOutboundBufferBytes);
+    Connect(&b);
+    HAPIPControllerDisconnect(&b);
+    HAPPlatformClockAdvance(0);
+    HAPAccessoryServerGetStorageHighWaterMarks(&accessoryServer, &highWaterMarks);
+    HAPAssert(highWaterMarks.ip.numSessions == 2);
+
+    // Reads use one read context per requested characteristic.
+    PerformRequest(&a, "GET", "/characteristics?id=1.49", /* requestBody: */ NULL, 200);
+    HAPAccessoryServerGetStorageHighWaterMarks(&accessoryServer, &highWaterMarks);
+    HAPAssert(highWaterMarks.ip.numReadContexts == 1);
+    PerformRequest(&a, "GET", "/characteristics?id=1.49,1.50", /* requestBody: */ NULL, 200);
+    HAPAccessoryServerGetStorageHighWaterMarks(&accessoryServer, &highWaterMarks);
+    HAPAssert(highWaterMarks.ip.numReadContexts == 2);
+    HAPAssert(!highWaterMarks.ip.numWriteContexts);
+    HAPAssert(highWaterMarks.ip.numScratchBufferBytes);
+
+    // Writes use one write context per written characteristic.
+    static const char writeRequest[] =
+            "{\"characteristics\":["
+            "{\"aid\":1,\"iid\":49,\"value\":false},"
+            "{\"aid\":1,\"iid\":50,\"value\":25}]}";
+    PerformRequest(&a, "PUT", "/characteristics", writeRequest, 204);
+    HAPAssert(!state.on);
+    HAPAssert(state.brightness == 25);
+    HAPAccessoryServerGetStorageHighWaterMarks(&accessoryServer, &highWaterMarks);
+    HAPAssert(highWaterMarks.ip.numWriteContexts == 2);
+    HAPAssert(highWaterMarks.ip.numReadContexts == 2);
+
+    // The inbound buffer held the complete write request, including HTTP headers and encryption overhead.
+    HAPAssert(highWaterMarks.ip.numInboundBufferBytes > sizeof writeRequest - 1);
+
+    // No high-water mark exceeds the provided storage.
+    HAPAssert(highWaterMarks.ip.numSessions <= ipAccessoryServerStorage.numSessions);
+    HAPAssert(highWaterMarks.ip.numReadContexts <= ipAccessoryServerStorage.numReadContexts);
+    HAPAssert(highWaterMarks.ip.numWriteContexts <= ipAccessoryServerStorage.numWriteContexts);
+    HAPAssert(
+            highWaterMarks.ip.numCharacteristicIndexElements <=
+            ipAccessoryServerStorage.numCharacteristicIndexElements);
+    const HAPIPSession* ipSession = &ipAccessoryServerStorage.sessions[0];
+    HAPAssert(highWaterMarks.ip.numEventNotifications <= ipSession->numEventNotifications);
+    HAPAssert(highWaterMarks.ip.numInboundBufferBytes <= ipSession->inboundBuffer.numBytes);
+    HAPAssert(highWaterMarks.ip.numOutboundBufferBytes <= ipSession->outboundBuffer.numBytes);
+    HAPAssert(highWaterMarks.ip.numScratchBufferBytes <= ipAccessoryServerStorage.scratchBuffer.numBytes);
+
+    // BLE storage is not used.
+    HAPAssert(!highWaterMarks.ble.numGATTTableElements);
+    HAPAssert(!highWaterMarks.ble.numProcedures);
+
+    // Stop accessory server.
+    HAPIPControllerDisconnect(&a);
+    HAPAccessoryServerStop(&accessoryServer);
+    while (!isIdle) {
+        HAPPlatformClockAdvance(0);
+    }
+    HAPAccessoryServerRelease(&accessoryServer);
+
+    return 0;
+}
@@ -0,0 +1,177 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAPPlatform+Init.h"
+
+#if defined(__ELF__)
+static const HAPLogObject logObject = { .subsystem = kHAPPlatform_LogSubsystem, .category = "LogBinaryTest" };
+
+HAP_RESULT_USE_CHECK
+static HAPError EncodeRecord(
+        void* bytes,
+        size_t maxBytes,
+        size_t* numBytes,
+        const void* _Nullable bufferBytes,
+        size_t numBufferBytes,
+        const char* format,
+        ...) {
+    va_list args;
+    va_start(args, format);
+    HAPError err = HAPLogBinaryEncodeRecordWithArguments(
+            bytes,
+            maxBytes,
+            numBytes,
+            /* time: */ 1234 * HAPSecond + 567,
+            &logObject,
+            kHAPLogType_Info,
+            bufferBytes,
+            numBufferBytes,
+            format,
+            args);
+    va_end(args);
+    return err;
+}
+
+/**
+ * Encodes a log message as binary record, decodes it, and compares the result to the formatted log message.
+ */
+#define TEST_ROUND_TRIP(format, ...) \
+    do { \
+        uint8_t bytes[kHAPLogBinaryRecord_MaxBytes]; \
+        size_t numBytes; \
+        err = EncodeRecord( \
+                bytes, sizeof bytes, &numBytes, NULL, 0, HAPLogBinaryFormat(format), __VA_ARGS__); \
+        HAPAssert(!err); \
+        char message[256]; \
+        size_t numRecordBytes; \
+        HAPLogBinaryRecord record; \
+        err = HAPLogBinaryDecodeRecord( \
+                bytes, numBytes, &numRecordBytes, HAPLogBinaryGetString, NULL, message, sizeof message, &record); \
+        HAPAssert(!err); \
+        HAPAssert(numRecordBytes == numBytes); \
+        char expectedMessage[256]; \
+        err = HAPStringWithFormat(expectedMessage, sizeof expectedMessage, format, __VA_ARGS__); \
+        HAPAssert(!err); \
+        HAPLogInfo(&kHAPLog_Default, "%s", message); \
+        HAPAssert(HAPStringAreEqual(HAPNonnull(record.message), expectedMessage)); \
+    } while (0)
+
+int main() {
+    HAPError err;
+    HAPPlatformCreate();
+
+    // Arguments are formatted the same way as by HAPStringWithFormat.
+    TEST_ROUND_TRIP("%d %i %u", -42, INT32_MIN, UINT32_MAX);
+    TEST_ROUND_TRIP(
+            "%ld %lu %lld %llu %zu", -1L, 2UL, (long long) INT64_MIN, (unsigned long long) UINT64_MAX, SIZE_MAX);
+    TEST_ROUND_TRIP("%x %X %016llX %02x", 0xABCDU, 0xABCDU, 0x123456789ABCULL, 7U);
+    TEST_ROUND_TRIP("%5d|%05u|%+d|% d", 42, 42U, 42, 42);
+    TEST_ROUND_TRIP("%p %c %%", (void*) &logObject, 'Z');
+    TEST_ROUND_TRIP("%g %g", 1.5, -0.25);
+    TEST_ROUND_TRIP("[%s] [%8s]", "Accessory", "x");
+
+    // Log object and buffer.
+    {
+        uint8_t buffer[2048];
+        for (size_t i = 0; i < sizeof buffer; i++) {
+            buffer[i] = (uint8_t) i;
+        }
+        uint8_t bytes[kHAPLogBinaryRecord_MaxBytes];
+        size_t numBytes;
+        err = EncodeRecord(bytes, sizeof bytes, &numBytes, buffer, sizeof buffer, HAPLogBinaryFormat("Buffer"));
+        HAPAssert(!err);
+        HAPAssert(numBytes <= sizeof bytes);
+
+        char message[256];
+        size_t numRecordBytes;
+        HAPLogBinaryRecord record;
+        err = HAPLogBinaryDecodeRecord(
+                bytes, numBytes, &numRecordBytes, HAPLogBinaryGetString, NULL, message, sizeof message, &record);
+        HAPAssert(!err);
+        HAPAssert(record.recordType == kHAPLogBinaryRecordType_Message);
+        HAPAssert(record.time == 1234 * HAPSecond + 567);
+        HAPAssert(record.type == kHAPLogType_Info);
+        HAPAssert(record.subsystem && HAPStringAreEqual(HAPNonnull(record.subsystem), kHAPPlatform_LogSubsystem));
+        HAPAssert(record.category && HAPStringAreEqual(HAPNonnull(record.category), "LogBinaryTest"));
+        HAPAssert(HAPStringAreEqual(HAPNonnull(record.message), "Buffer"));
+        HAPAssert(record.bufferBytes);
+        HAPAssert(record.numBufferBytes + record.numTruncatedBufferBytes == sizeof buffer);
+        HAPAssert(record.numTruncatedBufferBytes);
+        HAPAssert(HAPRawBufferAreEqual(HAPNonnullVoid(record.bufferBytes), buffer, record.numBufferBytes));
+
+        // Incomplete records.
+        err = HAPLogBinaryDecodeRecord(
+                bytes, numBytes - 1, &numRecordBytes, HAPLogBinaryGetString, NULL, message, sizeof message, &record);
+        HAPAssert(err == kHAPError_OutOfResources);
+
+        // Unknown record type.
+        bytes[0] = 0xFF;
+        err = HAPLogBinaryDecodeRecord(
+                bytes, numBytes, &numRecordBytes, HAPLogBinaryGetString, NULL, message, sizeof message, &record);
+        HAPAssert(err == kHAPError_InvalidData);
+    }
+
+    // Arguments that do not fit.
+    {
+        char string[200];
+        HAPRawBufferZero(string, sizeof string);
+        for (size_t i = 0; i < sizeof string - 1; i++) {
+            string[i] = 'a';
+        }
+        uint8_t bytes[64];
+        size_t numBytes;
+        err = EncodeRecord(bytes, sizeof bytes, &numBytes, NULL, 0, HAPLogBinaryFormat("%s"), string);
+        HAPAssert(err == kHAPError_OutOfResources);
+    }
+
+    // Conversions that cannot be encoded.
+    {
+        static const char* const formats[] = { "%u%%, %.2f", "%o", "%lu %123456789012345d", "%" };
+        for (size_t i = 0; i < HAPArrayCount(formats); i++) {
+            uint8_t bytes[kHAPLogBinaryRecord_MaxBytes];
+            size_t numBytes;
+            err = EncodeRecord(bytes, sizeof bytes, &numBytes, NULL, 0, formats[i], 42U, 1.5);
+            HAPAssert(!err);
+
+            char message[256];
+            size_t numRecordBytes;
+            HAPLogBinaryRecord record;
+            err = HAPLogBinaryDecodeRecord(
+                    bytes, numBytes, &numRecordBytes, HAPLogBinaryGetString, NULL, message, sizeof message, &record);
+            HAPAssert(!err);
+            char expectedMessage[256];
+            err = HAPStringWithFormat(
+                    expectedMessage, sizeof expectedMessage, "<Unsupported log format> %s", formats[i]);
+            HAPAssert(!err);
+            HAPAssert(HAPStringAreEqual(HAPNonnull(record.message), expectedMessage));
+        }
+    }
+
+    // Dropped log messages.
+    {
+        uint8_t bytes[16];
+        size_t numBytes;
+        err = HAPLogBinaryEncodeDroppedRecord(bytes, sizeof bytes, &numBytes, 300);
+        HAPAssert(!err);
+
+        char message[16];
+        size_t numRecordBytes;
+        HAPLogBinaryRecord record;
+        err = HAPLogBinaryDecodeRecord(
+                bytes, numBytes, &numRecordBytes, HAPLogBinaryGetString, NULL, message, sizeof message, &record);
+        HAPAssert(!err);
+        HAPAssert(numRecordBytes == numBytes);
+        HAPAssert(record.recordType == kHAPLogBinaryRecordType_Dropped);
+        HAPAssert(record.numDroppedMessages == 300);
+    }
+
+    return 0;
+}
+#else
+int main() {
+    return 0;
+}
+#endif
@@ -0,0 +1,247 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+// Exercises the asynchronous Apple Authentication Coprocessor request queue against the Mock coprocessor,
+// which does not acknowledge transfers while it is generating a signature.
+
+#include "HAP+Internal.h"
+#include "HAPPlatform+Init.h"
+#include "HAPPlatformClock+Test.h"
+#include "HAPPlatformMFiHWAuth+Test.h"
+
+#include "Harness/TemplateDB.c"
+
+typedef struct {
+    size_t numCompletions;
+    size_t sequenceNumber;
+    HAPError error;
+    size_t numBytes;
+} Completion;
+
+static size_t numCompletions;
+
+static void HandleUpdatedAccessoryServerState(HAPAccessoryServerRef* server, void* _Nullable context HAP_UNUSED) {
+    HAPPrecondition(server);
+}
+
+static void HandleRequestCompletion(
+        HAPAccessoryServerRef* server,
+        HAPMFiHWAuthRequest* request,
+        HAPError error,
+        size_t numBytes,
+        void* _Nullable context) {
+    HAPPrecondition(server);
+    HAPPrecondition(request);
+    HAPPrecondition(context);
+    Completion* completion = context;
+
+    completion->numCompletions++;
+    completion->sequenceNumber = ++numCompletions;
+    completion->error = error;
+    completion->numBytes = numBytes;
+}
+
+static bool didTimerFire;
+
+static void TimerExpired(HAPPlatformTimerRef timer HAP_UNUSED, void* _Nullable context HAP_UNUSED) {
+    didTimerFire = true;
+}
+
+int main() {
+    HAPError err;
+    HAPPlatformCreate();
+
+    // Prepare accessory server storage.
+    static HAPBLEGATTTableElementRef gattTableElements[kAttributeCount];
+    static HAPBLESessionCacheElementRef sessionCacheElements[kHAPBLESessionCache_MinElements];
+    static HAPSessionRef session;
+    static uint8_t procedureBytes[2048];
+    static HAPBLEProcedureRef procedures[1];
+    static HAPBLEAccessoryServerStorage bleAccessoryServerStorage = {
+        .gattTableElements = gattTableElements,
+        .numGATTTableElements = HAPArrayCount(gattTableElements),
+        .sessionCacheElements = sessionCacheElements,
+        .numSessionCacheElements = HAPArrayCount(sessionCacheElements),
+        .session = &session,
+        .procedures = procedures,
+        .numProcedures = HAPArrayCount(procedures),
+        .procedureBuffer = { .bytes = procedureBytes, .numBytes = sizeof procedureBytes },
+    };
+
+    // Initialize accessory server.
+    static HAPAccessoryServerRef accessoryServer;
+    HAPAccessoryServerCreate(
+            &accessoryServer,
+            &(const HAPAccessoryServerOptions) {
+                    .maxPairings = kHAPPairingStorage_MinElements,
+                    .ble = { .transport = &kHAPAccessoryServerTransport_BLE,
+                             .accessoryServerStorage = &bleAccessoryServerStorage,
+                             .preferredAdvertisingInterval = kHAPBLEAdvertisingInterval_Minimum,
+                             .preferredNotificationDuration = kHAPBLENotification_MinDuration } },
+            &platform,
+            &(const HAPAccessoryServerCallbacks) { .handleUpdatedState = HandleUpdatedAccessoryServerState },
+            /* context: */ NULL);
+
+    HAPPlatformMFiHWAuthRef mfiHWAuth = HAPNonnull(platform.authentication.mfiHWAuth);
+    HAPPlatformMFiHWAuthSetLatency(mfiHWAuth, 500 * HAPMillisecond);
+
+    uint8_t challenge[32];
+    HAPPlatformRandomNumberFill(challenge, sizeof challenge);
+
+    // Signature generation does not block the run loop.
+    {
+        uint8_t signature[128];
+        HAPMFiHWAuthRequest request;
+        Completion completion;
+        HAPRawBufferZero(&completion, sizeof completion);
+        err = HAPMFiHWAuthCreateSignatureAsync(
+                &accessoryServer,
+                &request,
+                challenge,
+                sizeof challenge,
+                signature,
+                sizeof signature,
+                HandleRequestCompletion,
+                &completion);
+        HAPAssert(!err);
+        HAPAssert(!completion.numCompletions);
+
+        HAPPlatformTimerRef timer;
+        err = HAPPlatformTimerRegister(
+                &timer, HAPPlatformClockGetCurrent() + 100 * HAPMillisecond, TimerExpired, /* context: */ NULL);
+        HAPAssert(!err);
+
+        HAPPlatformClockAdvance(0);
+        HAPAssert(!completion.numCompletions);
+        HAPPlatformClockAdvance(100 * HAPMillisecond);
+        HAPAssert(didTimerFire);
+        HAPAssert(!completion.numCompletions);
+        HAPPlatformClockAdvance(400 * HAPMillisecond);
+        HAPAssert(completion.numCompletions == 1);
+        HAPAssert(!completion.error);
+        HAPAssert(completion.numBytes == 64);
+        for (size_t i = 0; i < completion.numBytes; i++) {
+            HAPAssert(signature[i] == kHAPMFiHWAuthRegister_ChallengeResponseData);
+        }
+    }
+
+    // Requests complete in the order in which they are submitted.
+    {
+        uint8_t signature[128];
+        HAPMFiHWAuthRequest signatureRequest;
+        Completion signatureCompletion;
+        HAPRawBufferZero(&signatureCompletion, sizeof signatureCompletion);
+        err = HAPMFiHWAuthCreateSignatureAsync(
+                &accessoryServer,
+                &signatureRequest,
+                challenge,
+                sizeof challenge,
+                signature,
+                sizeof signature,
+                HandleRequestCompletion,
+                &signatureCompletion);
+        HAPAssert(!err);
+
+        uint8_t certificate[1280];
+        HAPMFiHWAuthRequest certificateRequest;
+        Completion certificateCompletion;
+        HAPRawBufferZero(&certificateCompletion, sizeof certificateCompletion);
+        err = HAPMFiHWAuthCopyCertificateAsync(
+                &accessoryServer,
+                &certificateRequest,
+                certificate,
+                sizeof certificate,
+                HandleRequestCompletion,
+                &certificateCompletion);
+        HAPAssert(!err);
+
+        HAPPlatformClockAdvance(0);
+        HAPAssert(!signatureCompletion.numCompletions);
+        HAPAssert(!certificateCompletion.numCompletions);
+        HAPPlatformClockAdvance(500 * HAPMillisecond);
+        HAPAssert(signatureCompletion.numCompletions == 1);
+        HAPAssert(certificateCompletion.numCompletions == 1);
+        HAPAssert(signatureCompletion.sequenceNumber < certificateCompletion.sequenceNumber);
+        HAPAssert(!certificateCompletion.error);
+        HAPAssert(certificateCompletion.numBytes == 608);
+    }
+
+    // Cancelled requests do not complete.
+    {
+        uint8_t signature[128];
+        HAPMFiHWAuthRequest request;
+        Completion completion;
+        HAPRawBufferZero(&completion, sizeof completion);
+        err = HAPMFiHWAuthCreateSignatureAsync(
+                &accessoryServer,
+                &request,
+                challenge,
+                sizeof challenge,
+                signature,
+                sizeof signature,
+                HandleRequestCompletion,
+                &completion);
+        HAPAssert(!err);
+        HAPPlatformClockAdvance(0);
+        HAPMFiHWAuthCancelRequest(&accessoryServer, &request);
+        HAPPlatformClockAdvance(500 * HAPMillisecond);
+        HAPAssert(!completion.numCompletions);
+    }
+
+    // A coprocessor that does not acknowledge transfers in time fails the request.
+    {
+        HAPPlatformMFiHWAuthSetLatency(mfiHWAuth, 2 * kHAPMFiHWAuth_BusyTimeout);
+
+        uint8_t signature[128];
+        HAPMFiHWAuthRequest request;
+        Completion completion;
+        HAPRawBufferZero(&completion, sizeof completion);
+        err = HAPMFiHWAuthCreateSignatureAsync(
+                &accessoryServer,
+                &request,
+                challenge,
+                sizeof challenge,
+                signature,
+                sizeof signature,
+                HandleRequestCompletion,
+                &completion);
+        HAPAssert(!err);
+        HAPPlatformClockAdvance(0);
+        for (HAPTime t = 0; t <= kHAPMFiHWAuth_BusyTimeout; t += 100 * HAPMillisecond) {
+            HAPPlatformClockAdvance(100 * HAPMillisecond);
+        }
+        HAPAssert(completion.numCompletions == 1);
+        HAPAssert(completion.error == kHAPError_Unknown);
+
+        HAPPlatformClockAdvance(2 * kHAPMFiHWAuth_BusyTimeout);
+        HAPPlatformMFiHWAuthSetLatency(mfiHWAuth, 500 * HAPMillisecond);
+    }
+
+    // Synchronous requests complete pending asynchronous requests first.
+    {
+        uint8_t certificate[1280];
+        HAPMFiHWAuthRequest request;
+        Completion completion;
+        HAPRawBufferZero(&completion, sizeof completion);
+        err = HAPMFiHWAuthCopyCertificateAsync(
+                &accessoryServer, &request, certificate, sizeof certificate, HandleRequestCompletion, &completion);
+        HAPAssert(!err);
+
+        uint8_t signature[128];
+        size_t numSignatureBytes;
+        err = HAPMFiHWAuthCreateSignature(
+                &accessoryServer, challenge, sizeof challenge, signature, sizeof signature, &numSignatureBytes);
+        HAPAssert(!err);
+        HAPAssert(numSignatureBytes == 64);
+        HAPAssert(completion.numCompletions == 1);
+        HAPAssert(!completion.error);
+        HAPAssert(completion.numBytes == 608);
+    }
+
+    HAPAccessoryServerRelease(&accessoryServer);
+
+    return 0;
+}
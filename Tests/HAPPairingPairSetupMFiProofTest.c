@@ -0,0 +1,327 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+// Checks that over IP the MFi proof of Pair Setup M4 is created without blocking the run loop,
+// and that the deferred M4 response is sent once the Apple Authentication Coprocessor has completed.
+//
+// The test does not implement the client side of SRP. Instead, it derives the SRP session key
+// from the private key b of the accessory server, which leads to the same result.
+
+#include "HAP+Internal.h"
+#include "HAPPlatform+Init.h"
+#include "HAPPlatformMFiHWAuth+Test.h"
+
+#include "Harness/HAPIPController.c"
+#include "Harness/HAPIPTestStorage.c"
+#include "Harness/TemplateDB.c"
+
+/**
+ * Maximum number of characteristics of the accessory.
+ */
+#define kMaxCharacteristics ((size_t) 32)
+
+static bool isIdle;
+
+static void HandleUpdatedAccessoryServerState(HAPAccessoryServerRef* server, void* _Nullable context HAP_UNUSED) {
+    HAPPrecondition(server);
+
+    isIdle = HAPAccessoryServerGetState(server) == kHAPAccessoryServerState_Idle;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError IdentifyAccessory(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPAccessoryIdentifyRequest* request HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    return kHAPError_None;
+}
+
+static const HAPAccessory accessory = {
+    .aid = 1,
+    .category = kHAPAccessoryCategory_Other,
+    .name = "Acme Test",
+    .manufacturer = "Acme",
+    .model = "Test1,1",
+    .serialNumber = "099DB48E9E28",
+    .firmwareVersion = "1",
+    .hardwareVersion = "1",
+    .services = (const HAPService* const[]) { &accessoryInformationService,
+                                              &hapProtocolInformationService,
+                                              &pairingService,
+                                              NULL },
+    .callbacks = { .identify = IdentifyAccessory }
+};
+
+static bool didTimerFire;
+
+static void TimerExpired(HAPPlatformTimerRef timer HAP_UNUSED, void* _Nullable context HAP_UNUSED) {
+    didTimerFire = true;
+}
+
+/**
+ * Serializes a Pair Setup request.
+ *
+ * @param      tlvs                 NULL-terminated array of TLVs.
+ * @param[out] bytes                Buffer to serialize into.
+ * @param      maxBytes             Capacity of buffer.
+ *
+ * @return Length of the request.
+ */
+HAP_RESULT_USE_CHECK
+static size_t SerializeRequest(const HAPTLV* const* tlvs, void* bytes, size_t maxBytes) {
+    HAPPrecondition(tlvs);
+    HAPPrecondition(bytes);
+
+    HAPError err;
+
+    HAPTLVWriterRef writer;
+    HAPTLVWriterCreate(&writer, bytes, maxBytes);
+    for (size_t i = 0; tlvs[i]; i++) {
+        err = HAPTLVWriterAppend(&writer, tlvs[i]);
+        HAPAssert(!err);
+    }
+    void* tlvBytes;
+    size_t numTLVBytes;
+    HAPTLVWriterGetBuffer(&writer, &tlvBytes, &numTLVBytes);
+    return numTLVBytes;
+}
+
+int main() {
+    HAPError err;
+    HAPPlatformCreate();
+
+    // Provision accessory server. It is not paired yet.
+    static const HAPAccessoryServerDeviceID deviceID = { { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 } };
+    err = HAPLegacyImportDeviceID(platform.keyValueStore, &deviceID);
+    HAPAssert(!err);
+    HAPAccessoryServerLongTermSecretKey accessoryLTSK;
+    HAPPlatformRandomNumberFill(accessoryLTSK.bytes, sizeof accessoryLTSK.bytes);
+    err = HAPLegacyImportLongTermSecretKey(platform.keyValueStore, &accessoryLTSK);
+    HAPAssert(!err);
+    uint8_t accessoryLTPK[ED25519_PUBLIC_KEY_BYTES];
+    HAP_ed25519_public_key(accessoryLTPK, accessoryLTSK.bytes);
+
+    // Prepare accessory server storage.
+    static HAPIPAccessoryServerStorage ipAccessoryServerStorage;
+    HAPIPTestStorageCreate(
+            &ipAccessoryServerStorage,
+            &(const HAPIPTestStorageOptions) { .numSessions = kHAPIPSessionStorage_DefaultNumElements,
+                                               .maxCharacteristics = kMaxCharacteristics });
+
+    // Initialize and start accessory server.
+    static HAPAccessoryServerRef accessoryServer;
+    HAPAccessoryServerCreate(
+            &accessoryServer,
+            &(const HAPAccessoryServerOptions) {
+                    .maxPairings = kHAPPairingStorage_MinElements,
+                    .ip = { .transport = &kHAPAccessoryServerTransport_IP,
+                            .accessoryServerStorage = &ipAccessoryServerStorage } },
+            &platform,
+            &(const HAPAccessoryServerCallbacks) { .handleUpdatedState = HandleUpdatedAccessoryServerState },
+            /* context: */ NULL);
+    HAPAccessoryServerStart(&accessoryServer, &accessory);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Running);
+    HAPAccessoryServer* server = (HAPAccessoryServer*) &accessoryServer;
+
+    HAPPlatformMFiHWAuthRef mfiHWAuth = HAPNonnull(platform.authentication.mfiHWAuth);
+    HAPPlatformMFiHWAuthSetLatency(mfiHWAuth, 500 * HAPMillisecond);
+
+    // Connect controller.
+    static const HAPControllerPairingIdentifier pairingIdentifier = {
+        .bytes = "4E5D4B2F-6A3B-4C1D-9E8F-0A1B2C3D4E5F", .numBytes = 36
+    };
+    uint8_t controllerLTSK[ED25519_SECRET_KEY_BYTES];
+    HAPPlatformRandomNumberFill(controllerLTSK, sizeof controllerLTSK);
+    static HAPIPController controller;
+    HAPIPControllerCreate(
+            &controller,
+            &(const HAPIPControllerOptions) { .tcpStreamManager = HAPNonnull(platform.ip.tcpStreamManager),
+                                              .pairingIdentifier = &pairingIdentifier,
+                                              .longTermSecretKey = controllerLTSK,
+                                              .accessoryLongTermPublicKey = accessoryLTPK });
+    err = HAPIPControllerConnect(&controller);
+    HAPAssert(!err);
+
+    static uint8_t requestBytes[1024];
+    size_t numRequestBytes;
+    static uint8_t responseBytes[2048];
+    size_t numResponseBytes;
+    unsigned int status;
+
+    // M1: SRP Start Request.
+    {
+        const uint8_t state = 1;
+        const uint8_t method = kHAPPairingMethod_PairSetupWithAuth;
+        numRequestBytes = SerializeRequest(
+                (const HAPTLV* const[]) {
+                        &(const HAPTLV) { .type = kHAPPairingTLVType_State,
+                                          .value = { .bytes = &state, .numBytes = sizeof state } },
+                        &(const HAPTLV) { .type = kHAPPairingTLVType_Method,
+                                          .value = { .bytes = &method, .numBytes = sizeof method } },
+                        NULL },
+                requestBytes,
+                sizeof requestBytes);
+        err = HAPIPControllerPerformRequest(
+                &controller,
+                "POST",
+                "/pair-setup",
+                "application/pairing+tlv8",
+                requestBytes,
+                numRequestBytes,
+                &status,
+                responseBytes,
+                sizeof responseBytes,
+                &numResponseBytes);
+        HAPAssert(!err);
+        HAPAssert(status == 200);
+    }
+
+    // M2: SRP Start Response.
+    uint8_t B[SRP_PUBLIC_KEY_BYTES];
+    uint8_t salt[SRP_SALT_BYTES];
+    {
+        HAPTLVReaderRef reader;
+        HAPTLVReaderCreate(&reader, responseBytes, numResponseBytes);
+        HAPTLV stateTLV, errorTLV, publicKeyTLV, saltTLV;
+        stateTLV.type = kHAPPairingTLVType_State;
+        errorTLV.type = kHAPPairingTLVType_Error;
+        publicKeyTLV.type = kHAPPairingTLVType_PublicKey;
+        saltTLV.type = kHAPPairingTLVType_Salt;
+        err = HAPTLVReaderGetAll(&reader, (HAPTLV* const[]) { &stateTLV, &errorTLV, &publicKeyTLV, &saltTLV, NULL });
+        HAPAssert(!err);
+        HAPAssert(stateTLV.value.bytes && stateTLV.value.numBytes == 1);
+        HAPAssert(((const uint8_t*) stateTLV.value.bytes)[0] == 2);
+        HAPAssert(!errorTLV.value.bytes);
+        HAPAssert(publicKeyTLV.value.bytes && publicKeyTLV.value.numBytes == sizeof B);
+        HAPRawBufferCopyBytes(B, HAPNonnullVoid(publicKeyTLV.value.bytes), sizeof B);
+        HAPAssert(saltTLV.value.bytes && saltTLV.value.numBytes == sizeof salt);
+        HAPRawBufferCopyBytes(salt, HAPNonnullVoid(saltTLV.value.bytes), sizeof salt);
+    }
+
+    // Derive the SRP session key. Any valid group element may be used as public key A.
+    uint8_t A[SRP_PUBLIC_KEY_BYTES];
+    uint8_t K[SRP_SESSION_KEY_BYTES];
+    uint8_t M1[SRP_PROOF_BYTES];
+    {
+        HAPSetupInfo* setupInfo =
+                HAPNonnull(HAPAccessorySetupInfoGetSetupInfo(&accessoryServer, /* restorePrevious: */ false));
+        uint8_t a[SRP_SECRET_KEY_BYTES];
+        HAPPlatformRandomNumberFill(a, sizeof a);
+        HAP_srp_public_key(A, a, setupInfo->verifier);
+        uint8_t u[SRP_SCRAMBLING_PARAMETER_BYTES];
+        HAP_srp_scrambling_parameter(u, A, B);
+        uint8_t S[SRP_PREMASTER_SECRET_BYTES];
+        int e = HAP_srp_premaster_secret(S, A, server->pairSetup.b, u, setupInfo->verifier);
+        HAPAssert(!e);
+        HAP_srp_session_key(K, S);
+        static const uint8_t userName[] = "Pair-Setup";
+        HAP_srp_proof_m1(M1, userName, sizeof userName - 1, salt, A, B, K);
+    }
+
+    // M3: SRP Verify Request.
+    {
+        const uint8_t state = 3;
+        numRequestBytes = SerializeRequest(
+                (const HAPTLV* const[]) {
+                        &(const HAPTLV) { .type = kHAPPairingTLVType_State,
+                                          .value = { .bytes = &state, .numBytes = sizeof state } },
+                        &(const HAPTLV) { .type = kHAPPairingTLVType_PublicKey,
+                                          .value = { .bytes = A, .numBytes = sizeof A } },
+                        &(const HAPTLV) { .type = kHAPPairingTLVType_Proof,
+                                          .value = { .bytes = M1, .numBytes = sizeof M1 } },
+                        NULL },
+                requestBytes,
+                sizeof requestBytes);
+        err = HAPIPControllerSendRequest(
+                &controller, "POST", "/pair-setup", "application/pairing+tlv8", requestBytes, numRequestBytes);
+        HAPAssert(!err);
+    }
+
+    // While the MFi proof is being created, the run loop keeps running and the M4 response is deferred.
+    HAPPlatformClockAdvance(0);
+    HAPAssert(server->pairSetup.mfiProof.isPending);
+    HAPPlatformTimerRef timer;
+    err = HAPPlatformTimerRegister(
+            &timer, HAPPlatformClockGetCurrent() + 100 * HAPMillisecond, TimerExpired, /* context: */ NULL);
+    HAPAssert(!err);
+    HAPPlatformClockAdvance(100 * HAPMillisecond);
+    HAPAssert(didTimerFire);
+    HAPAssert(server->pairSetup.mfiProof.isPending);
+    err = HAPIPControllerReceiveResponse(&controller, &status, responseBytes, sizeof responseBytes, &numResponseBytes);
+    HAPAssert(err == kHAPError_InvalidState);
+
+    // M4: SRP Verify Response.
+    HAPPlatformClockAdvance(400 * HAPMillisecond);
+    HAPAssert(!server->pairSetup.mfiProof.isPending);
+    err = HAPIPControllerReceiveResponse(&controller, &status, responseBytes, sizeof responseBytes, &numResponseBytes);
+    HAPAssert(!err);
+    HAPAssert(status == 200);
+    {
+        HAPTLVReaderRef reader;
+        HAPTLVReaderCreate(&reader, responseBytes, numResponseBytes);
+        HAPTLV stateTLV, errorTLV, proofTLV, encryptedDataTLV;
+        stateTLV.type = kHAPPairingTLVType_State;
+        errorTLV.type = kHAPPairingTLVType_Error;
+        proofTLV.type = kHAPPairingTLVType_Proof;
+        encryptedDataTLV.type = kHAPPairingTLVType_EncryptedData;
+        err = HAPTLVReaderGetAll(
+                &reader, (HAPTLV* const[]) { &stateTLV, &errorTLV, &proofTLV, &encryptedDataTLV, NULL });
+        HAPAssert(!err);
+        HAPAssert(stateTLV.value.bytes && stateTLV.value.numBytes == 1);
+        HAPAssert(((const uint8_t*) stateTLV.value.bytes)[0] == 4);
+        HAPAssert(!errorTLV.value.bytes);
+
+        uint8_t M2[SRP_PROOF_BYTES];
+        HAP_srp_proof_m2(M2, A, M1, K);
+        HAPAssert(proofTLV.value.bytes && proofTLV.value.numBytes == sizeof M2);
+        HAPAssert(HAPRawBufferAreEqual(HAPNonnullVoid(proofTLV.value.bytes), M2, sizeof M2));
+
+        // Decrypt the sub-TLV with the MFi proof and the Accessory Certificate.
+        uint8_t sessionKey[CHACHA20_POLY1305_KEY_BYTES];
+        static const uint8_t encryptSalt[] = "Pair-Setup-Encrypt-Salt";
+        static const uint8_t encryptInfo[] = "Pair-Setup-Encrypt-Info";
+        HAP_hkdf_sha512(
+                sessionKey,
+                sizeof sessionKey,
+                K,
+                sizeof K,
+                encryptSalt,
+                sizeof encryptSalt - 1,
+                encryptInfo,
+                sizeof encryptInfo - 1);
+        HAPAssert(encryptedDataTLV.value.bytes && encryptedDataTLV.value.numBytes > CHACHA20_POLY1305_TAG_BYTES);
+        uint8_t* bytes = (uint8_t*) (uintptr_t) encryptedDataTLV.value.bytes;
+        size_t numBytes = encryptedDataTLV.value.numBytes - CHACHA20_POLY1305_TAG_BYTES;
+        static const uint8_t nonce[] = "PS-Msg04";
+        int e = HAP_chacha20_poly1305_decrypt(
+                &bytes[numBytes], bytes, bytes, numBytes, nonce, sizeof nonce - 1, sessionKey);
+        HAPAssert(!e);
+
+        HAPTLVReaderRef subReader;
+        HAPTLVReaderCreate(&subReader, bytes, numBytes);
+        HAPTLV signatureTLV, certificateTLV;
+        signatureTLV.type = kHAPPairingTLVType_Signature;
+        certificateTLV.type = kHAPPairingTLVType_Certificate;
+        err = HAPTLVReaderGetAll(&subReader, (HAPTLV* const[]) { &signatureTLV, &certificateTLV, NULL });
+        HAPAssert(!err);
+        HAPAssert(signatureTLV.value.bytes && signatureTLV.value.numBytes == 64);
+        for (size_t i = 0; i < signatureTLV.value.numBytes; i++) {
+            HAPAssert(((const uint8_t*) signatureTLV.value.bytes)[i] == kHAPMFiHWAuthRegister_ChallengeResponseData);
+        }
+        HAPAssert(certificateTLV.value.bytes && certificateTLV.value.numBytes == 608);
+    }
+
+    // Stop accessory server.
+    HAPIPControllerDisconnect(&controller);
+    HAPAccessoryServerStop(&accessoryServer);
+    while (!isIdle) {
+        HAPPlatformClockAdvance(0);
+    }
+    HAPAccessoryServerRelease(&accessoryServer);
+
+    return 0;
+}
@@ -0,0 +1,340 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+// Checks the cache of controller long-term public keys that is used by Pair Verify: the least recently used key is
+// evicted, a cached key is not used once the public key of its pairing has changed, and removing or updating a pairing
+// invalidates its cached key.
+
+#include "HAP+Internal.h"
+#include "HAPPlatform+Init.h"
+
+#include "Harness/HAPIPController.c"
+#include "Harness/HAPIPTestStorage.c"
+#include "Harness/TemplateDB.c"
+
+/**
+ * Number of simulated controllers. Exceeds the number of cache entries.
+ */
+#define kNumControllers ((size_t)(kHAPPairingPublicKeyCache_NumEntries + 2))
+HAP_STATIC_ASSERT(kNumControllers <= kHAPPairingStorage_MinElements, kNumControllers);
+
+static void HandleUpdatedAccessoryServerState(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError IdentifyAccessory(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPAccessoryIdentifyRequest* request HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    return kHAPError_None;
+}
+
+static const HAPAccessory accessory = { .aid = 1,
+                                        .category = kHAPAccessoryCategory_Other,
+                                        .name = "Acme Test",
+                                        .manufacturer = "Acme",
+                                        .model = "Test1,1",
+                                        .serialNumber = "099DB48E9E28",
+                                        .firmwareVersion = "1",
+                                        .hardwareVersion = "1",
+                                        .services = (const HAPService* const[]) { &accessoryInformationService,
+                                                                                  &hapProtocolInformationService,
+                                                                                  &pairingService,
+                                                                                  NULL },
+                                        .callbacks = { .identify = IdentifyAccessory } };
+
+static HAPAccessoryServerRef accessoryServer;
+static uint8_t accessoryLTPK[ED25519_PUBLIC_KEY_BYTES];
+
+/**
+ * Simulated controllers. Controller 0 is the admin.
+ */
+static struct {
+    HAPControllerPairingIdentifier pairingIdentifier;
+    uint8_t ltsk[ED25519_SECRET_KEY_BYTES];
+    HAPControllerPublicKey ltpk;
+    HAPIPController controller;
+} controllers[kNumControllers];
+
+/**
+ * Connects a simulated controller to the accessory server and performs Pair Verify.
+ *
+ * @param      i                    Index of the simulated controller.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If Pair Verify failed.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError Connect(size_t i) {
+    HAPPrecondition(i < kNumControllers);
+
+    HAPError err;
+
+    HAPIPControllerCreate(
+            &controllers[i].controller,
+            &(const HAPIPControllerOptions) { .tcpStreamManager = HAPNonnull(platform.ip.tcpStreamManager),
+                                              .pairingIdentifier = &controllers[i].pairingIdentifier,
+                                              .longTermSecretKey = controllers[i].ltsk,
+                                              .accessoryLongTermPublicKey = accessoryLTPK });
+    err = HAPIPControllerConnect(&controllers[i].controller);
+    HAPAssert(!err);
+    err = HAPIPControllerPairVerify(&controllers[i].controller);
+    if (err) {
+        HAPAssert(err == kHAPError_InvalidState);
+        HAPIPControllerDisconnect(&controllers[i].controller);
+        return err;
+    }
+    return kHAPError_None;
+}
+
+/**
+ * Connects a simulated controller to the accessory server, performs Pair Verify, and disconnects again.
+ *
+ * @param      i                    Index of the simulated controller.
+ */
+static void Verify(size_t i) {
+    HAPError err;
+
+    err = Connect(i);
+    HAPAssert(!err);
+    HAPIPControllerDisconnect(&controllers[i].controller);
+    HAPPlatformClockAdvance(0);
+}
+
+/**
+ * Checks whether the public key of a pairing is cached.
+ *
+ * @param      pairingID            Pairing ID.
+ * @param      i                    Index of the simulated controller whose public key is expected.
+ *
+ * @return true                     If the public key of the simulated controller is cached for the pairing.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool IsCached(int pairingID, size_t i) {
+    HAPPrecondition(i < kNumControllers);
+
+    const HAPPairingPublicKeyCache* cache = &((const HAPAccessoryServer*) &accessoryServer)->pairingPublicKeyCache;
+    for (size_t j = 0; j < HAPArrayCount(cache->entries); j++) {
+        const HAPPairingPublicKeyCacheEntry* cacheEntry = &cache->entries[j];
+        if (cacheEntry->lastUsed && cacheEntry->pairingID == pairingID) {
+            return HAPRawBufferAreEqual(
+                    cacheEntry->publicKey.value, controllers[i].ltpk.bytes, sizeof cacheEntry->publicKey.value);
+        }
+    }
+    return false;
+}
+
+/**
+ * Adds, updates, or removes a pairing with POST /pairings from the admin controller.
+ *
+ * @param      method               kHAPPairingMethod_AddPairing or kHAPPairingMethod_RemovePairing.
+ * @param      i                    Index of the simulated controller whose pairing is modified.
+ * @param      permissions          Permissions of the pairing. Ignored for kHAPPairingMethod_RemovePairing.
+ */
+static void UpdatePairing(uint8_t method, size_t i, uint8_t permissions) {
+    HAPPrecondition(method == kHAPPairingMethod_AddPairing || method == kHAPPairingMethod_RemovePairing);
+    HAPPrecondition(i < kNumControllers);
+
+    HAPError err;
+
+    uint8_t requestBytes[128];
+    HAPTLVWriterRef writer;
+    HAPTLVWriterCreate(&writer, requestBytes, sizeof requestBytes);
+    const uint8_t state = 1;
+    err = HAPTLVWriterAppend(
+            &writer,
+            &(const HAPTLV) { .type = kHAPPairingTLVType_State,
+                              .value = { .bytes = &state, .numBytes = sizeof state } });
+    HAPAssert(!err);
+    err = HAPTLVWriterAppend(
+            &writer,
+            &(const HAPTLV) { .type = kHAPPairingTLVType_Method,
+                              .value = { .bytes = &method, .numBytes = sizeof method } });
+    HAPAssert(!err);
+    err = HAPTLVWriterAppend(
+            &writer,
+            &(const HAPTLV) { .type = kHAPPairingTLVType_Identifier,
+                              .value = { .bytes = controllers[i].pairingIdentifier.bytes,
+                                         .numBytes = controllers[i].pairingIdentifier.numBytes } });
+    HAPAssert(!err);
+    if (method == kHAPPairingMethod_AddPairing) {
+        err = HAPTLVWriterAppend(
+                &writer,
+                &(const HAPTLV) { .type = kHAPPairingTLVType_PublicKey,
+                                  .value = { .bytes = controllers[i].ltpk.bytes,
+                                             .numBytes = sizeof controllers[i].ltpk.bytes } });
+        HAPAssert(!err);
+        err = HAPTLVWriterAppend(
+                &writer,
+                &(const HAPTLV) { .type = kHAPPairingTLVType_Permissions,
+                                  .value = { .bytes = &permissions, .numBytes = sizeof permissions } });
+        HAPAssert(!err);
+    }
+    void* tlvBytes;
+    size_t numTLVBytes;
+    HAPTLVWriterGetBuffer(&writer, &tlvBytes, &numTLVBytes);
+
+    unsigned int status;
+    uint8_t responseBytes[64];
+    size_t numResponseBytes;
+    err = HAPIPControllerPerformRequest(
+            &controllers[0].controller,
+            "POST",
+            "/pairings",
+            "application/pairing+tlv8",
+            tlvBytes,
+            numTLVBytes,
+            &status,
+            responseBytes,
+            sizeof responseBytes,
+            &numResponseBytes);
+    HAPAssert(!err);
+    HAPAssert(status == 200);
+
+    HAPTLVReaderRef reader;
+    HAPTLVReaderCreate(&reader, responseBytes, numResponseBytes);
+    HAPTLV stateTLV, errorTLV;
+    stateTLV.type = kHAPPairingTLVType_State;
+    errorTLV.type = kHAPPairingTLVType_Error;
+    err = HAPTLVReaderGetAll(&reader, (HAPTLV* const[]) { &stateTLV, &errorTLV, NULL });
+    HAPAssert(!err);
+    HAPAssert(stateTLV.value.bytes && stateTLV.value.numBytes == 1);
+    HAPAssert(((const uint8_t*) stateTLV.value.bytes)[0] == 2);
+    HAPAssert(!errorTLV.value.bytes);
+    HAPPlatformClockAdvance(0);
+}
+
+int main() {
+    HAPError err;
+    HAPPlatformCreate();
+
+    // Provision accessory server and controllers. The pairing ID of each controller is its index.
+    static const HAPAccessoryServerDeviceID deviceID = { { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 } };
+    err = HAPLegacyImportDeviceID(platform.keyValueStore, &deviceID);
+    HAPAssert(!err);
+    HAPAccessoryServerLongTermSecretKey accessoryLTSK;
+    HAPPlatformRandomNumberFill(accessoryLTSK.bytes, sizeof accessoryLTSK.bytes);
+    err = HAPLegacyImportLongTermSecretKey(platform.keyValueStore, &accessoryLTSK);
+    HAPAssert(!err);
+    HAP_ed25519_public_key(accessoryLTPK, accessoryLTSK.bytes);
+    for (size_t i = 0; i < kNumControllers; i++) {
+        static const char pairingIdentifier[] = "4E5D4B2F-6A3B-4C1D-9E8F-0A1B2C3D4E50";
+        HAPAssert(sizeof controllers[i].pairingIdentifier.bytes == sizeof pairingIdentifier - 1);
+        HAPRawBufferCopyBytes(
+                controllers[i].pairingIdentifier.bytes, pairingIdentifier, sizeof pairingIdentifier - 1);
+        controllers[i].pairingIdentifier.bytes[sizeof pairingIdentifier - 2] += (uint8_t) i;
+        controllers[i].pairingIdentifier.numBytes = sizeof pairingIdentifier - 1;
+        HAPPlatformRandomNumberFill(controllers[i].ltsk, sizeof controllers[i].ltsk);
+        HAP_ed25519_public_key(controllers[i].ltpk.bytes, controllers[i].ltsk);
+    }
+    for (size_t i = 0; i < kNumControllers - 1; i++) {
+        err = HAPLegacyImportControllerPairing(
+                platform.keyValueStore,
+                (HAPPlatformKeyValueStoreKey) i,
+                &controllers[i].pairingIdentifier,
+                &controllers[i].ltpk,
+                /* isAdmin: */ i == 0);
+        HAPAssert(!err);
+    }
+
+    // Prepare accessory server storage.
+    static HAPIPAccessoryServerStorage ipAccessoryServerStorage;
+    HAPIPTestStorageCreate(
+            &ipAccessoryServerStorage,
+            &(const HAPIPTestStorageOptions) { .numSessions = kHAPIPSessionStorage_DefaultNumElements,
+                                               .maxCharacteristics = kAttributeCount });
+
+    // Initialize and start accessory server.
+    HAPAccessoryServerCreate(
+            &accessoryServer,
+            &(const HAPAccessoryServerOptions) {
+                    .maxPairings = kHAPPairingStorage_MinElements,
+                    .ip = { .transport = &kHAPAccessoryServerTransport_IP,
+                            .accessoryServerStorage = &ipAccessoryServerStorage } },
+            &platform,
+            &(const HAPAccessoryServerCallbacks) { .handleUpdatedState = HandleUpdatedAccessoryServerState },
+            /* context: */ NULL);
+    HAPAccessoryServerStart(&accessoryServer, &accessory);
+    HAPPlatformClockAdvance(0);
+    HAPAssert(HAPAccessoryServerGetState(&accessoryServer) == kHAPAccessoryServerState_Running);
+
+    // Fill the cache.
+    for (size_t i = 0; i < kHAPPairingPublicKeyCache_NumEntries; i++) {
+        Verify(i);
+    }
+    for (size_t i = 0; i < kHAPPairingPublicKeyCache_NumEntries; i++) {
+        HAPAssert(IsCached((int) i, i));
+    }
+
+    // The least recently used public key is evicted.
+    Verify(0);
+    Verify(4);
+    HAPAssert(IsCached(0, 0));
+    HAPAssert(!IsCached(1, 1));
+    HAPAssert(IsCached(2, 2));
+    HAPAssert(IsCached(3, 3));
+    HAPAssert(IsCached(4, 4));
+
+    // An evicted public key is prepared again.
+    Verify(1);
+    HAPAssert(IsCached(1, 1));
+    HAPAssert(!IsCached(2, 2));
+
+    // The admin controller stays connected to modify pairings.
+    err = Connect(0);
+    HAPAssert(!err);
+
+    // Updating the permissions of a pairing invalidates its cached public key.
+    UpdatePairing(kHAPPairingMethod_AddPairing, 1, /* permissions: */ 0x01);
+    HAPAssert(!IsCached(1, 1));
+    HAPAssert(IsCached(0, 0));
+    HAPAssert(IsCached(3, 3));
+    HAPAssert(IsCached(4, 4));
+
+    // The invalidated cache entry is reused before any other public key is evicted.
+    Verify(1);
+    HAPAssert(IsCached(1, 1));
+    HAPAssert(IsCached(0, 0));
+    HAPAssert(IsCached(3, 3));
+    HAPAssert(IsCached(4, 4));
+
+    // Removing a pairing invalidates its cached public key. The removed controller can no longer verify.
+    UpdatePairing(kHAPPairingMethod_RemovePairing, 3, /* permissions: */ 0x00);
+    HAPAssert(!IsCached(3, 3));
+    HAPAssert(IsCached(0, 0));
+    HAPAssert(IsCached(1, 1));
+    HAPAssert(IsCached(4, 4));
+    err = Connect(3);
+    HAPAssert(err == kHAPError_InvalidState);
+    HAPAssert(!IsCached(3, 3));
+
+    // A cached public key is not used if its pairing has been replaced without invalidating the cache,
+    // e.g., when the key-value store has been modified directly.
+    HAPAssert(IsCached(4, 4));
+    err = HAPPlatformKeyValueStoreRemove(platform.keyValueStore, kHAPKeyValueStoreDomain_Pairings, 4);
+    HAPAssert(!err);
+    size_t replacement = kNumControllers - 1;
+    err = HAPLegacyImportControllerPairing(
+            platform.keyValueStore,
+            4,
+            &controllers[replacement].pairingIdentifier,
+            &controllers[replacement].ltpk,
+            /* isAdmin: */ false);
+    HAPAssert(!err);
+    HAPAssert(IsCached(4, 4));
+    err = Connect(4);
+    HAPAssert(err == kHAPError_InvalidState);
+    Verify(replacement);
+    HAPAssert(!IsCached(4, 4));
+    HAPAssert(IsCached(4, replacement));
+
+    HAPIPControllerDisconnect(&controllers[0].controller);
+    HAPPlatformClockAdvance(0);
+    return 0;
+}
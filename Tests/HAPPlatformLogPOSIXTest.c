@@ -0,0 +1,244 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+// Checks the log queue of the POSIX PAL: log messages of concurrent threads are written completely and in order,
+// log messages that do not fit into the queue are dropped and reported, and large buffers are truncated.
+//
+// Unit tests are linked against the Mock PAL, so the POSIX implementation is compiled into this test.
+// Unnamed semaphores, which the log thread relies on, are not available on Darwin.
+// With HAP_LOG_BINARY, dropped log messages are reported as binary records in between the text output.
+
+#include "HAPPlatform+Init.h"
+
+#if defined(__linux__)
+#include <unistd.h>
+
+#include "POSIX/HAPPlatformLog.c"
+
+static const HAPLogObject testLogObject = { .subsystem = kHAPPlatform_LogSubsystem, .category = "LogPOSIXTest" };
+
+/**
+ * Number of threads that log concurrently.
+ */
+#define kNumThreads ((size_t) 4)
+
+/**
+ * Number of log messages per thread.
+ */
+#define kNumMessagesPerThread ((size_t) 20000)
+
+/**
+ * Captures a formatted log message.
+ *
+ * @param      format               A format string.
+ * @param      ...                  Arguments for the format string.
+ */
+HAP_PRINTFLIKE(1, 2)
+static void CaptureMessage(const char* format, ...) {
+    char message[64];
+    va_list args;
+    va_start(args, format);
+    int numBytes = vsnprintf(message, sizeof message, format, args);
+    va_end(args);
+    HAPAssert(numBytes > 0 && (size_t) numBytes < sizeof message);
+    HAPPlatformLogCapture(&testLogObject, kHAPLogType_Default, message, /* bufferBytes: */ NULL, 0);
+}
+
+static void* _Nullable LogMessages(void* _Nullable context) {
+    HAPPrecondition(context);
+    size_t threadIndex = *(const size_t*) context;
+
+    for (size_t i = 0; i < kNumMessagesPerThread; i++) {
+        CaptureMessage("thread %zu message %zu", threadIndex, i);
+    }
+    return NULL;
+}
+
+#if HAP_LOG_BINARY
+static const char* _Nullable ResolveNoString(void* _Nullable context HAP_UNUSED, int64_t offset HAP_UNUSED) {
+    return NULL;
+}
+
+/**
+ * Reads the next line of log output.
+ *
+ * Log messages are captured as text by this test, but dropped log messages are reported as binary records that may
+ * appear in the middle of a line. They are removed from the line, and their counts are accumulated.
+ *
+ * @param      file                 Log output.
+ * @param[out] line                 Line of log output. NULL-terminated.
+ * @param      maxBytes             Capacity of the line buffer.
+ * @param[in,out] numDroppedMessages Number of dropped log messages that have been reported.
+ *
+ * @return true                     If a line has been read.
+ * @return false                    If the end of the log output has been reached.
+ */
+static bool ReadLine(FILE* file, char* line, size_t maxBytes, uint64_t* numDroppedMessages) {
+    HAPPrecondition(file);
+    HAPPrecondition(line);
+    HAPPrecondition(maxBytes);
+    HAPPrecondition(numDroppedMessages);
+
+    size_t numBytes = 0;
+    int c;
+    while (numBytes < maxBytes - 1 && (c = getc(file)) != EOF) {
+        if (c == kHAPLogBinaryRecordType_Dropped) {
+            uint8_t bytes[16];
+            bytes[0] = (uint8_t) c;
+            HAPAssert(fread(&bytes[1], 1, 2, file) == 2);
+            size_t numBodyBytes = HAPReadLittleUInt16(&bytes[1]);
+            HAPAssert(numBodyBytes <= sizeof bytes - 3);
+            HAPAssert(fread(&bytes[3], 1, numBodyBytes, file) == numBodyBytes);
+
+            char message[1];
+            size_t numRecordBytes;
+            HAPLogBinaryRecord record;
+            HAPError err = HAPLogBinaryDecodeRecord(
+                    bytes, 3 + numBodyBytes, &numRecordBytes, ResolveNoString, NULL, message, sizeof message, &record);
+            HAPAssert(!err);
+            HAPAssert(record.recordType == kHAPLogBinaryRecordType_Dropped);
+            *numDroppedMessages += record.numDroppedMessages;
+            continue;
+        }
+        line[numBytes++] = (char) c;
+        if (c == '\n') {
+            break;
+        }
+    }
+    line[numBytes] = '\0';
+    return numBytes != 0;
+}
+#endif
+
+/**
+ * Summary of the log output.
+ */
+typedef struct {
+    /** Number of log messages per thread. */
+    size_t numMessages[kNumThreads];
+
+    /** Number of dropped log messages that have been reported. */
+    uint64_t numDroppedMessages;
+
+    /** Number of log messages of the queue test. See main. */
+    size_t numQueueMessages;
+
+    /** Number of truncated buffer bytes that have been reported. */
+    size_t numTruncatedBufferBytes;
+} LogOutputSummary;
+
+/**
+ * Parses the log output. Log messages of each thread must be written in the order in which they were logged.
+ *
+ * @param      file                 Log output.
+ * @param[out] summary              Summary of the log output.
+ */
+static void ParseLogOutput(FILE* file, LogOutputSummary* summary) {
+    HAPPrecondition(file);
+    HAPPrecondition(summary);
+
+    HAPRawBufferZero(summary, sizeof *summary);
+    size_t nextMessageIndex[kNumThreads] = { 0 };
+
+    char line[1024];
+#if HAP_LOG_BINARY
+    while (ReadLine(file, line, sizeof line, &summary->numDroppedMessages)) {
+#else
+    while (fgets(line, sizeof line, file)) {
+#endif
+        const char* s;
+        size_t threadIndex;
+        size_t messageIndex;
+        unsigned long long numDroppedMessages;
+        size_t numTruncatedBufferBytes;
+        if ((s = strstr(line, "] thread ")) &&
+            sscanf(s, "] thread %zu message %zu", &threadIndex, &messageIndex) == 2) {
+            HAPAssert(threadIndex < kNumThreads);
+            HAPAssert(messageIndex >= nextMessageIndex[threadIndex]);
+            nextMessageIndex[threadIndex] = messageIndex + 1;
+            summary->numMessages[threadIndex]++;
+        } else if ((s = strstr(line, "] queue ")) && sscanf(s, "] queue %zu", &messageIndex) == 1) {
+            HAPAssert(messageIndex == summary->numQueueMessages);
+            summary->numQueueMessages++;
+        } else if (strstr(line, " log messages dropped>") && (s = strstr(line, "<")) &&
+                   sscanf(s, "<%llu", &numDroppedMessages) == 1) {
+            summary->numDroppedMessages += numDroppedMessages;
+        } else if (strstr(line, " bytes truncated>") && (s = strstr(line, "<")) &&
+                   sscanf(s, "<%zu", &numTruncatedBufferBytes) == 1) {
+            summary->numTruncatedBufferBytes += numTruncatedBufferBytes;
+        }
+    }
+}
+
+int main() {
+    // Redirect stderr into a temporary file.
+    FILE* output = tmpfile();
+    HAPAssert(output);
+    (void) fflush(stderr);
+    int stderrFileDescriptor = dup(STDERR_FILENO);
+    HAPAssert(stderrFileDescriptor != -1);
+    HAPAssert(dup2(fileno(output), STDERR_FILENO) != -1);
+
+    // Log from multiple threads concurrently.
+    pthread_t threads[kNumThreads];
+    size_t threadIndices[kNumThreads];
+    for (size_t i = 0; i < kNumThreads; i++) {
+        threadIndices[i] = i;
+        int e = pthread_create(&threads[i], /* attr: */ NULL, LogMessages, &threadIndices[i]);
+        HAPAssert(!e);
+    }
+    for (size_t i = 0; i < kNumThreads; i++) {
+        int e = pthread_join(threads[i], /* retval: */ NULL);
+        HAPAssert(!e);
+    }
+    HAPPlatformLogFlush();
+    HAPAssert(logger.isThreadRunning);
+    uint64_t numConcurrentlyDroppedMessages = HAPPlatformLogGetNumDroppedMessages();
+
+    // While the log thread is blocked, the queue fills up and further log messages are dropped.
+    (void) pthread_mutex_lock(&logger.mutex);
+    for (size_t i = 0; i < kHAPPlatformLog_NumRecords + 10; i++) {
+        CaptureMessage("queue %zu", i);
+    }
+    HAPAssert(HAPPlatformLogGetNumDroppedMessages() == numConcurrentlyDroppedMessages + 10);
+    (void) pthread_mutex_unlock(&logger.mutex);
+    HAPPlatformLogFlush();
+
+    // Buffers that do not fit into a log record are truncated.
+    static uint8_t bufferBytes[kHAPPlatformLogRecord_MaxBytes + 100];
+    HAPPlatformLogCapture(&testLogObject, kHAPLogType_Default, "buffer", bufferBytes, sizeof bufferBytes);
+    HAPPlatformLogFlush();
+
+    // Restore stderr.
+    (void) fflush(stderr);
+    HAPAssert(dup2(stderrFileDescriptor, STDERR_FILENO) != -1);
+    (void) close(stderrFileDescriptor);
+
+    // Every log message has either been written or is reported as dropped.
+    LogOutputSummary summary;
+    rewind(output);
+    ParseLogOutput(output, &summary);
+    (void) fclose(output);
+    size_t numMessages = 0;
+    for (size_t i = 0; i < kNumThreads; i++) {
+        numMessages += summary.numMessages[i];
+    }
+    HAPAssert(numMessages + numConcurrentlyDroppedMessages == kNumThreads * kNumMessagesPerThread);
+    HAPAssert(summary.numQueueMessages == kHAPPlatformLog_NumRecords);
+    HAPAssert(summary.numDroppedMessages == HAPPlatformLogGetNumDroppedMessages());
+    HAPAssert(summary.numTruncatedBufferBytes == sizeof bufferBytes - (kHAPPlatformLogRecord_MaxBytes - 6));
+
+    HAPLog(&testLogObject,
+           "%zu log messages written, %llu dropped.",
+           numMessages,
+           (unsigned long long) summary.numDroppedMessages);
+    return 0;
+}
+#else
+int main() {
+    return 0;
+}
+#endif
@@ -0,0 +1,314 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+// TLV formats for HAPTLVCodeGeneratorTest.
+//
+// Tests/HAPTLVCodeGeneratorTest+Generated.h is generated from this file with:
+//     TLVCodeGenerator -o Tests/HAPTLVCodeGeneratorTest+Generated.h Tests/HAPTLVCodeGeneratorTest+Formats.h
+
+#ifndef HAP_TLV_CODE_GENERATOR_TEST_FORMATS_H
+#define HAP_TLV_CODE_GENERATOR_TEST_FORMATS_H
+
+#include "HAP+Internal.h"
+
+/**
+ * Pair Setup message, covering all pair setup states.
+ */
+typedef struct {
+    uint8_t method;
+    bool methodIsSet;
+    char* identifier;
+    bool identifierIsSet;
+    HAPDataTLVValue salt;
+    bool saltIsSet;
+    HAPDataTLVValue publicKey;
+    bool publicKeyIsSet;
+    HAPDataTLVValue proof;
+    bool proofIsSet;
+    HAPDataTLVValue encryptedData;
+    bool encryptedDataIsSet;
+    uint8_t state;
+    uint8_t error;
+    bool errorIsSet;
+    uint32_t flags;
+    bool flagsIsSet;
+} PairSetupMessage;
+
+/**
+ * Pairing, as listed by List Pairings.
+ */
+typedef struct {
+    char* identifier;
+    HAPDataTLVValue publicKey;
+    uint8_t permissions;
+} Pairing;
+
+/**
+ * Sequence of pairings.
+ */
+typedef struct {
+    HAP_RESULT_USE_CHECK
+    HAPError (*enumerate)(
+            HAPSequenceTLVDataSourceRef* dataSource,
+            HAPSequenceTLVEnumerateCallback callback,
+            void* _Nullable context);
+    HAPSequenceTLVDataSourceRef dataSource;
+    Pairing _;
+} PairingSequence;
+
+/**
+ * Sequence of 16-bit identifiers.
+ */
+typedef struct {
+    HAP_RESULT_USE_CHECK
+    HAPError (*enumerate)(
+            HAPSequenceTLVDataSourceRef* dataSource,
+            HAPSequenceTLVEnumerateCallback callback,
+            void* _Nullable context);
+    HAPSequenceTLVDataSourceRef dataSource;
+    uint16_t _;
+} IdentifierSequence;
+
+/**
+ * List Pairings response.
+ */
+typedef struct {
+    uint8_t state;
+    PairingSequence pairings;
+    IdentifierSequence identifiers;
+} ListPairingsResponse;
+
+HAP_RESULT_USE_CHECK
+static bool IsValidError(uint8_t value) {
+    return value >= 1 && value <= 7;
+}
+
+HAP_RESULT_USE_CHECK
+static const char* GetErrorDescription(uint8_t value) {
+    HAPPrecondition(IsValidError(value));
+
+    switch (value) {
+        case 1: {
+        }
+            return "kTLVError_Unknown";
+        case 2: {
+        }
+            return "kTLVError_Authentication";
+        case 3: {
+        }
+            return "kTLVError_Backoff";
+        case 4: {
+        }
+            return "kTLVError_MaxPeers";
+        case 5: {
+        }
+            return "kTLVError_MaxTries";
+        case 6: {
+        }
+            return "kTLVError_Unavailable";
+        case 7: {
+        }
+            return "kTLVError_Busy";
+    }
+    HAPFatalError();
+}
+
+HAP_RESULT_USE_CHECK
+static bool IsValidPairingIdentifier(const char* value) {
+    HAPPrecondition(value);
+
+    return HAPStringGetNumBytes(value) > 0;
+}
+
+HAP_RESULT_USE_CHECK
+static bool IsValidPairSetupMessage(HAPTLVValue* value_) {
+    HAPPrecondition(value_);
+    const PairSetupMessage* value = value_;
+
+    return !value->saltIsSet || value->state == 2;
+}
+
+static const HAPUInt8TLVFormat kMethodFormat = { .type = kHAPTLVFormatType_UInt8,
+                                                 .constraints = { .minimumValue = 0, .maximumValue = UINT8_MAX } };
+static const HAPUInt8TLVFormat kStateFormat = { .type = kHAPTLVFormatType_UInt8,
+                                                .constraints = { .minimumValue = 1, .maximumValue = 6 } };
+static const HAPEnumTLVFormat kErrorFormat = { .type = kHAPTLVFormatType_Enum,
+                                               .callbacks = { .isValid = IsValidError,
+                                                              .getDescription = GetErrorDescription } };
+static const HAPUInt32TLVFormat kFlagsFormat = { .type = kHAPTLVFormatType_UInt32,
+                                                 .constraints = { .minimumValue = 0, .maximumValue = UINT32_MAX } };
+static const HAPStringTLVFormat kIdentifierFormat = { .type = kHAPTLVFormatType_String,
+                                                      .constraints = { .minLength = 0, .maxLength = 36 },
+                                                      .callbacks = { .isValid = IsValidPairingIdentifier } };
+static const HAPDataTLVFormat kSaltFormat = { .type = kHAPTLVFormatType_Data,
+                                              .constraints = { .minLength = 16, .maxLength = 16 } };
+static const HAPDataTLVFormat kSRPPublicKeyFormat = { .type = kHAPTLVFormatType_Data,
+                                                      .constraints = { .minLength = 0, .maxLength = 384 } };
+static const HAPDataTLVFormat kProofFormat = { .type = kHAPTLVFormatType_Data,
+                                               .constraints = { .minLength = 0, .maxLength = 64 } };
+static const HAPDataTLVFormat kEncryptedDataFormat = { .type = kHAPTLVFormatType_Data,
+                                                       .constraints = { .minLength = 0, .maxLength = SIZE_MAX } };
+
+static const HAPStructTLVMember kPairSetupMessageMethodMember = {
+    .valueOffset = HAP_OFFSETOF(PairSetupMessage, method),
+    .isSetOffset = HAP_OFFSETOF(PairSetupMessage, methodIsSet),
+    .tlvType = 0x00,
+    .debugDescription = "kTLVType_Method",
+    .format = &kMethodFormat,
+    .isOptional = true
+};
+static const HAPStructTLVMember kPairSetupMessageIdentifierMember = {
+    .valueOffset = HAP_OFFSETOF(PairSetupMessage, identifier),
+    .isSetOffset = HAP_OFFSETOF(PairSetupMessage, identifierIsSet),
+    .tlvType = 0x01,
+    .debugDescription = "kTLVType_Identifier",
+    .format = &kIdentifierFormat,
+    .isOptional = true
+};
+static const HAPStructTLVMember kPairSetupMessageSaltMember = {
+    .valueOffset = HAP_OFFSETOF(PairSetupMessage, salt),
+    .isSetOffset = HAP_OFFSETOF(PairSetupMessage, saltIsSet),
+    .tlvType = 0x02,
+    .debugDescription = "kTLVType_Salt",
+    .format = &kSaltFormat,
+    .isOptional = true
+};
+static const HAPStructTLVMember kPairSetupMessagePublicKeyMember = {
+    .valueOffset = HAP_OFFSETOF(PairSetupMessage, publicKey),
+    .isSetOffset = HAP_OFFSETOF(PairSetupMessage, publicKeyIsSet),
+    .tlvType = 0x03,
+    .debugDescription = "kTLVType_PublicKey",
+    .format = &kSRPPublicKeyFormat,
+    .isOptional = true
+};
+static const HAPStructTLVMember kPairSetupMessageProofMember = {
+    .valueOffset = HAP_OFFSETOF(PairSetupMessage, proof),
+    .isSetOffset = HAP_OFFSETOF(PairSetupMessage, proofIsSet),
+    .tlvType = 0x04,
+    .debugDescription = "kTLVType_Proof",
+    .format = &kProofFormat,
+    .isOptional = true
+};
+static const HAPStructTLVMember kPairSetupMessageEncryptedDataMember = {
+    .valueOffset = HAP_OFFSETOF(PairSetupMessage, encryptedData),
+    .isSetOffset = HAP_OFFSETOF(PairSetupMessage, encryptedDataIsSet),
+    .tlvType = 0x05,
+    .debugDescription = "kTLVType_EncryptedData",
+    .format = &kEncryptedDataFormat,
+    .isOptional = true
+};
+static const HAPStructTLVMember kPairSetupMessageStateMember = { .valueOffset = HAP_OFFSETOF(PairSetupMessage, state),
+                                                                 .tlvType = 0x06,
+                                                                 .debugDescription = "kTLVType_State",
+                                                                 .format = &kStateFormat };
+static const HAPStructTLVMember kPairSetupMessageErrorMember = {
+    .valueOffset = HAP_OFFSETOF(PairSetupMessage, error),
+    .isSetOffset = HAP_OFFSETOF(PairSetupMessage, errorIsSet),
+    .tlvType = 0x07,
+    .debugDescription = "kTLVType_Error",
+    .format = &kErrorFormat,
+    .isOptional = true
+};
+static const HAPStructTLVMember kPairSetupMessageFlagsMember = {
+    .valueOffset = HAP_OFFSETOF(PairSetupMessage, flags),
+    .isSetOffset = HAP_OFFSETOF(PairSetupMessage, flagsIsSet),
+    .tlvType = 0x13,
+    .debugDescription = "kTLVType_Flags",
+    .format = &kFlagsFormat,
+    .isOptional = true
+};
+static const HAPStructTLVFormat kPairSetupMessageFormat = {
+    .type = kHAPTLVFormatType_Struct,
+    .members = (const HAPStructTLVMember* const[]) { &kPairSetupMessageMethodMember,
+                                                      &kPairSetupMessageIdentifierMember,
+                                                      &kPairSetupMessageSaltMember,
+                                                      &kPairSetupMessagePublicKeyMember,
+                                                      &kPairSetupMessageProofMember,
+                                                      &kPairSetupMessageEncryptedDataMember,
+                                                      &kPairSetupMessageStateMember,
+                                                      &kPairSetupMessageErrorMember,
+                                                      &kPairSetupMessageFlagsMember,
+                                                      NULL },
+    .callbacks = { .isValid = IsValidPairSetupMessage }
+};
+
+static const HAPUInt8TLVFormat kPermissionsFormat = { .type = kHAPTLVFormatType_UInt8,
+                                                      .constraints = { .minimumValue = 0, .maximumValue = 1 } };
+static const HAPDataTLVFormat kLTPKFormat = { .type = kHAPTLVFormatType_Data,
+                                              .constraints = { .minLength = 32, .maxLength = 32 } };
+
+static const HAPStructTLVMember kPairingIdentifierMember = { .valueOffset = HAP_OFFSETOF(Pairing, identifier),
+                                                             .tlvType = 0x01,
+                                                             .debugDescription = "kTLVType_Identifier",
+                                                             .format = &kIdentifierFormat };
+static const HAPStructTLVMember kPairingPublicKeyMember = { .valueOffset = HAP_OFFSETOF(Pairing, publicKey),
+                                                            .tlvType = 0x03,
+                                                            .debugDescription = "kTLVType_PublicKey",
+                                                            .format = &kLTPKFormat };
+static const HAPStructTLVMember kPairingPermissionsMember = { .valueOffset = HAP_OFFSETOF(Pairing, permissions),
+                                                              .tlvType = 0x0B,
+                                                              .debugDescription = "kTLVType_Permissions",
+                                                              .format = &kPermissionsFormat };
+static const HAPStructTLVFormat kPairingFormat = {
+    .type = kHAPTLVFormatType_Struct,
+    .members = (const HAPStructTLVMember* const[]) { &kPairingIdentifierMember,
+                                                      &kPairingPublicKeyMember,
+                                                      &kPairingPermissionsMember,
+                                                      NULL }
+};
+
+static const HAPSeparatorTLVFormat kSeparatorFormat = { .type = kHAPTLVFormatType_None };
+
+static const HAPSequenceTLVFormat kPairingSequenceFormat = {
+    .type = kHAPTLVFormatType_Sequence,
+    .item = { .valueOffset = HAP_OFFSETOF(PairingSequence, _),
+              .tlvType = 0x0C,
+              .debugDescription = "Pairing",
+              .format = &kPairingFormat },
+    .separator = { .tlvType = 0xFF, .debugDescription = "kTLVType_Separator", .format = &kSeparatorFormat }
+};
+
+static const HAPUInt16TLVFormat kShortIdentifierFormat = {
+    .type = kHAPTLVFormatType_UInt16,
+    .constraints = { .minimumValue = 1, .maximumValue = UINT16_MAX }
+};
+
+static const HAPSequenceTLVFormat kIdentifierSequenceFormat = {
+    .type = kHAPTLVFormatType_Sequence,
+    .item = { .valueOffset = HAP_OFFSETOF(IdentifierSequence, _),
+              .tlvType = 0x0D,
+              .debugDescription = "Identifier",
+              .format = &kShortIdentifierFormat },
+    .separator = { .tlvType = 0xFF, .debugDescription = "kTLVType_Separator", .format = &kSeparatorFormat }
+};
+
+static const HAPStructTLVMember kListPairingsResponseStateMember = {
+    .valueOffset = HAP_OFFSETOF(ListPairingsResponse, state),
+    .tlvType = 0x06,
+    .debugDescription = "kTLVType_State",
+    .format = &kStateFormat
+};
+static const HAPStructTLVMember kListPairingsResponsePairingsMember = {
+    .valueOffset = HAP_OFFSETOF(ListPairingsResponse, pairings),
+    .tlvType = 0x0E,
+    .debugDescription = "Pairings",
+    .format = &kPairingSequenceFormat
+};
+static const HAPStructTLVMember kListPairingsResponseIdentifiersMember = {
+    .valueOffset = HAP_OFFSETOF(ListPairingsResponse, identifiers),
+    .tlvType = 0x0F,
+    .debugDescription = "Identifiers",
+    .format = &kIdentifierSequenceFormat
+};
+static const HAPStructTLVFormat kListPairingsResponseFormat = {
+    .type = kHAPTLVFormatType_Struct,
+    .members = (const HAPStructTLVMember* const[]) { &kListPairingsResponseStateMember,
+                                                      &kListPairingsResponsePairingsMember,
+                                                      &kListPairingsResponseIdentifiersMember,
+                                                      NULL }
+};
+
+#endif
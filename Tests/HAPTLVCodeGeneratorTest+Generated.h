@@ -0,0 +1,1216 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+// Generated by TLVCodeGenerator from HAPTLVCodeGeneratorTest+Formats.h. Do not edit.
+//
+// Include after the value types and callbacks referenced by the formats have been declared.
+
+#ifndef HAP_TLV_GENERATED_CODE_SUPPORT
+#define HAP_TLV_GENERATED_CODE_SUPPORT
+static const HAPLogObject generatedTLVLogObject = { .subsystem = kHAP_LogSubsystem, .category = "TLVGenerated" };
+HAP_STATIC_ASSERT(sizeof(HAPTLVReaderRef) <= sizeof(HAPSequenceTLVDataSourceRef), HAPTLVGeneratedSequenceDataSource);
+#endif
+
+/** Maximum length of an encoded Pairing value. */
+#define kPairing_MaxBytes ((size_t) 75)
+
+HAP_DIAGNOSTIC_PUSH
+HAP_DIAGNOSTIC_IGNORED_CLANG("-Wunused-function")
+HAP_DIAGNOSTIC_IGNORED_GCC("-Wunused-function")
+
+HAP_RESULT_USE_CHECK
+static HAPError EncodePairSetupMessage(HAPTLVWriterRef* writer, PairSetupMessage* value);
+
+HAP_RESULT_USE_CHECK
+static HAPError DecodePairSetupMessage(HAPTLVReaderRef* reader, PairSetupMessage* value);
+
+HAP_RESULT_USE_CHECK
+static HAPError EncodePairing(HAPTLVWriterRef* writer, Pairing* value);
+
+HAP_RESULT_USE_CHECK
+static HAPError DecodePairing(HAPTLVReaderRef* reader, Pairing* value);
+
+HAP_RESULT_USE_CHECK
+static HAPError EncodePairingSequence(HAPTLVWriterRef* writer, PairingSequence* value);
+
+HAP_RESULT_USE_CHECK
+static HAPError DecodePairingSequence(HAPTLVReaderRef* reader, PairingSequence* value);
+
+HAP_RESULT_USE_CHECK
+static HAPError EncodeIdentifierSequence(HAPTLVWriterRef* writer, IdentifierSequence* value);
+
+HAP_RESULT_USE_CHECK
+static HAPError DecodeIdentifierSequence(HAPTLVReaderRef* reader, IdentifierSequence* value);
+
+HAP_RESULT_USE_CHECK
+static HAPError EncodeListPairingsResponse(HAPTLVWriterRef* writer, ListPairingsResponse* value);
+
+HAP_RESULT_USE_CHECK
+static HAPError DecodeListPairingsResponse(HAPTLVReaderRef* reader, ListPairingsResponse* value);
+
+HAP_RESULT_USE_CHECK
+static HAPError EncodePairSetupMessage(HAPTLVWriterRef* writer, PairSetupMessage* value) {
+    HAPPrecondition(writer);
+    HAPPrecondition(value);
+    HAPPrecondition(IsValidPairSetupMessage(value));
+
+    HAPError err;
+
+    // kTLVType_Method.
+    if (value->methodIsSet) {
+        void* bytes;
+        size_t maxBytes;
+        HAPTLVWriterGetScratchBytes(writer, &bytes, &maxBytes);
+
+        size_t numBytes;
+        if (maxBytes < sizeof(uint8_t)) {
+            HAPLogTLV(&generatedTLVLogObject, 0x00, "kTLVType_Method", "Not enough memory to encode integer value.");
+            return kHAPError_OutOfResources;
+        }
+        HAPWriteUInt8(bytes, (uint8_t) value->method);
+        numBytes = sizeof(uint8_t);
+
+        err = HAPTLVWriterAppend(
+                writer, &(const HAPTLV) { .type = 0x00, .value = { .bytes = bytes, .numBytes = numBytes } });
+        if (err) {
+            HAPAssert(err == kHAPError_OutOfResources);
+            return err;
+        }
+    }
+
+    // kTLVType_Identifier.
+    if (value->identifierIsSet) {
+        void* bytes;
+        size_t maxBytes;
+        HAPTLVWriterGetScratchBytes(writer, &bytes, &maxBytes);
+
+        size_t numBytes;
+        size_t numValueBytes = HAPStringGetNumBytes(value->identifier);
+        HAPPrecondition(IsValidPairingIdentifier(value->identifier));
+        HAPPrecondition(HAPUTF8IsValidData(value->identifier, numValueBytes));
+        HAPPrecondition(numValueBytes <= 36);
+        if (maxBytes < numValueBytes) {
+            HAPLogTLV(&generatedTLVLogObject, 0x01, "kTLVType_Identifier", "Not enough memory to encode string value.");
+            return kHAPError_OutOfResources;
+        }
+        HAPRawBufferCopyBytes(bytes, value->identifier, numValueBytes);
+        numBytes = numValueBytes;
+
+        err = HAPTLVWriterAppend(
+                writer, &(const HAPTLV) { .type = 0x01, .value = { .bytes = bytes, .numBytes = numBytes } });
+        if (err) {
+            HAPAssert(err == kHAPError_OutOfResources);
+            return err;
+        }
+    }
+
+    // kTLVType_Salt.
+    if (value->saltIsSet) {
+        void* bytes;
+        size_t maxBytes;
+        HAPTLVWriterGetScratchBytes(writer, &bytes, &maxBytes);
+
+        size_t numBytes;
+        HAPPrecondition(value->salt.numBytes >= 16);
+        HAPPrecondition(value->salt.numBytes <= 16);
+        if (maxBytes < value->salt.numBytes) {
+            HAPLogTLV(&generatedTLVLogObject, 0x02, "kTLVType_Salt", "Not enough memory to encode data value.");
+            return kHAPError_OutOfResources;
+        }
+        HAPRawBufferCopyBytes(bytes, value->salt.bytes, value->salt.numBytes);
+        numBytes = value->salt.numBytes;
+
+        err = HAPTLVWriterAppend(
+                writer, &(const HAPTLV) { .type = 0x02, .value = { .bytes = bytes, .numBytes = numBytes } });
+        if (err) {
+            HAPAssert(err == kHAPError_OutOfResources);
+            return err;
+        }
+    }
+
+    // kTLVType_PublicKey.
+    if (value->publicKeyIsSet) {
+        void* bytes;
+        size_t maxBytes;
+        HAPTLVWriterGetScratchBytes(writer, &bytes, &maxBytes);
+
+        size_t numBytes;
+        HAPPrecondition(value->publicKey.numBytes <= 384);
+        if (maxBytes < value->publicKey.numBytes) {
+            HAPLogTLV(&generatedTLVLogObject, 0x03, "kTLVType_PublicKey", "Not enough memory to encode data value.");
+            return kHAPError_OutOfResources;
+        }
+        HAPRawBufferCopyBytes(bytes, value->publicKey.bytes, value->publicKey.numBytes);
+        numBytes = value->publicKey.numBytes;
+
+        err = HAPTLVWriterAppend(
+                writer, &(const HAPTLV) { .type = 0x03, .value = { .bytes = bytes, .numBytes = numBytes } });
+        if (err) {
+            HAPAssert(err == kHAPError_OutOfResources);
+            return err;
+        }
+    }
+
+    // kTLVType_Proof.
+    if (value->proofIsSet) {
+        void* bytes;
+        size_t maxBytes;
+        HAPTLVWriterGetScratchBytes(writer, &bytes, &maxBytes);
+
+        size_t numBytes;
+        HAPPrecondition(value->proof.numBytes <= 64);
+        if (maxBytes < value->proof.numBytes) {
+            HAPLogTLV(&generatedTLVLogObject, 0x04, "kTLVType_Proof", "Not enough memory to encode data value.");
+            return kHAPError_OutOfResources;
+        }
+        HAPRawBufferCopyBytes(bytes, value->proof.bytes, value->proof.numBytes);
+        numBytes = value->proof.numBytes;
+
+        err = HAPTLVWriterAppend(
+                writer, &(const HAPTLV) { .type = 0x04, .value = { .bytes = bytes, .numBytes = numBytes } });
+        if (err) {
+            HAPAssert(err == kHAPError_OutOfResources);
+            return err;
+        }
+    }
+
+    // kTLVType_EncryptedData.
+    if (value->encryptedDataIsSet) {
+        void* bytes;
+        size_t maxBytes;
+        HAPTLVWriterGetScratchBytes(writer, &bytes, &maxBytes);
+
+        size_t numBytes;
+        if (maxBytes < value->encryptedData.numBytes) {
+            HAPLogTLV(
+                    &generatedTLVLogObject,
+                    0x05,
+                    "kTLVType_EncryptedData",
+                    "Not enough memory to encode data value.");
+            return kHAPError_OutOfResources;
+        }
+        HAPRawBufferCopyBytes(bytes, value->encryptedData.bytes, value->encryptedData.numBytes);
+        numBytes = value->encryptedData.numBytes;
+
+        err = HAPTLVWriterAppend(
+                writer, &(const HAPTLV) { .type = 0x05, .value = { .bytes = bytes, .numBytes = numBytes } });
+        if (err) {
+            HAPAssert(err == kHAPError_OutOfResources);
+            return err;
+        }
+    }
+
+    // kTLVType_State.
+    {
+        void* bytes;
+        size_t maxBytes;
+        HAPTLVWriterGetScratchBytes(writer, &bytes, &maxBytes);
+
+        size_t numBytes;
+        HAPPrecondition(value->state >= 1);
+        HAPPrecondition(value->state <= 6);
+        if (maxBytes < sizeof(uint8_t)) {
+            HAPLogTLV(&generatedTLVLogObject, 0x06, "kTLVType_State", "Not enough memory to encode integer value.");
+            return kHAPError_OutOfResources;
+        }
+        HAPWriteUInt8(bytes, (uint8_t) value->state);
+        numBytes = sizeof(uint8_t);
+
+        err = HAPTLVWriterAppend(
+                writer, &(const HAPTLV) { .type = 0x06, .value = { .bytes = bytes, .numBytes = numBytes } });
+        if (err) {
+            HAPAssert(err == kHAPError_OutOfResources);
+            return err;
+        }
+    }
+
+    // kTLVType_Error.
+    if (value->errorIsSet) {
+        void* bytes;
+        size_t maxBytes;
+        HAPTLVWriterGetScratchBytes(writer, &bytes, &maxBytes);
+
+        size_t numBytes;
+        HAPPrecondition(IsValidError(value->error));
+        if (maxBytes < sizeof(uint8_t)) {
+            HAPLogTLV(&generatedTLVLogObject, 0x07, "kTLVType_Error", "Not enough memory to encode enumeration value.");
+            return kHAPError_OutOfResources;
+        }
+        HAPWriteUInt8(bytes, (uint8_t) value->error);
+        numBytes = sizeof(uint8_t);
+
+        err = HAPTLVWriterAppend(
+                writer, &(const HAPTLV) { .type = 0x07, .value = { .bytes = bytes, .numBytes = numBytes } });
+        if (err) {
+            HAPAssert(err == kHAPError_OutOfResources);
+            return err;
+        }
+    }
+
+    // kTLVType_Flags.
+    if (value->flagsIsSet) {
+        void* bytes;
+        size_t maxBytes;
+        HAPTLVWriterGetScratchBytes(writer, &bytes, &maxBytes);
+
+        size_t numBytes;
+        if (maxBytes < sizeof(uint32_t)) {
+            HAPLogTLV(&generatedTLVLogObject, 0x13, "kTLVType_Flags", "Not enough memory to encode integer value.");
+            return kHAPError_OutOfResources;
+        }
+        HAPWriteLittleUInt32(bytes, value->flags);
+        numBytes = sizeof(uint32_t);
+
+        err = HAPTLVWriterAppend(
+                writer, &(const HAPTLV) { .type = 0x13, .value = { .bytes = bytes, .numBytes = numBytes } });
+        if (err) {
+            HAPAssert(err == kHAPError_OutOfResources);
+            return err;
+        }
+    }
+
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError DecodePairSetupMessage(HAPTLVReaderRef* reader, PairSetupMessage* value) {
+    HAPPrecondition(reader);
+    HAPPrecondition(value);
+
+    HAPError err;
+
+    bool isSet[9];
+    HAPRawBufferZero(isSet, sizeof isSet);
+    for (;;) {
+        HAPTLV tlv;
+        bool found;
+        err = HAPTLVReaderGetNext(reader, &found, &tlv);
+        if (err) {
+            HAPAssert(err == kHAPError_InvalidData);
+            return err;
+        }
+        if (!found) {
+            break;
+        }
+
+        switch (tlv.type) {
+            case 0x00: {
+                if (isSet[0]) {
+                    HAPLogTLV(&generatedTLVLogObject, 0x00, "kTLVType_Method", "Duplicate TLV.");
+                    return kHAPError_InvalidData;
+                }
+                isSet[0] = true;
+                if (tlv.value.numBytes > sizeof(uint8_t)) {
+                    HAPLogTLV(
+                            &generatedTLVLogObject,
+                            0x00,
+                            "kTLVType_Method",
+                            "Invalid integer length (%zu bytes).",
+                            tlv.value.numBytes);
+                    return kHAPError_InvalidData;
+                }
+                uint8_t integerValue = 0;
+                const uint8_t* integerBytes = tlv.value.bytes;
+                for (size_t i = 0; i < tlv.value.numBytes; i++) {
+                    integerValue |= (uint8_t)(((unsigned int) integerBytes[i]) << (i * CHAR_BIT));
+                }
+                value->method = integerValue;
+            } break;
+            case 0x01: {
+                if (isSet[1]) {
+                    HAPLogTLV(&generatedTLVLogObject, 0x01, "kTLVType_Identifier", "Duplicate TLV.");
+                    return kHAPError_InvalidData;
+                }
+                isSet[1] = true;
+                if (tlv.value.numBytes > 36) {
+                    HAPLogTLV(
+                            &generatedTLVLogObject,
+                            0x01,
+                            "kTLVType_Identifier",
+                            "Invalid length: %zu.",
+                            tlv.value.numBytes);
+                    return kHAPError_InvalidData;
+                }
+                if (HAPStringGetNumBytes(tlv.value.bytes) != tlv.value.numBytes) {
+                    HAPLogTLV(
+                            &generatedTLVLogObject,
+                            0x01,
+                            "kTLVType_Identifier",
+                            "Invalid string value: Contains NULL characters.");
+                    return kHAPError_InvalidData;
+                }
+                if (!HAPUTF8IsValidData(tlv.value.bytes, tlv.value.numBytes)) {
+                    HAPLogTLV(
+                            &generatedTLVLogObject,
+                            0x01,
+                            "kTLVType_Identifier",
+                            "Invalid string value: Not valid UTF-8.");
+                    return kHAPError_InvalidData;
+                }
+                if (!IsValidPairingIdentifier(tlv.value.bytes)) {
+                    HAPLogTLV(&generatedTLVLogObject, 0x01, "kTLVType_Identifier", "Invalid string value.");
+                    return kHAPError_InvalidData;
+                }
+                value->identifier = (char*) (uintptr_t) tlv.value.bytes;
+            } break;
+            case 0x02: {
+                if (isSet[2]) {
+                    HAPLogTLV(&generatedTLVLogObject, 0x02, "kTLVType_Salt", "Duplicate TLV.");
+                    return kHAPError_InvalidData;
+                }
+                isSet[2] = true;
+                if (tlv.value.numBytes < 16 || tlv.value.numBytes > 16) {
+                    HAPLogTLV(
+                            &generatedTLVLogObject,
+                            0x02,
+                            "kTLVType_Salt",
+                            "Invalid length: %zu.",
+                            tlv.value.numBytes);
+                    return kHAPError_InvalidData;
+                }
+                value->salt.bytes = (void*) (uintptr_t) tlv.value.bytes;
+                value->salt.numBytes = tlv.value.numBytes;
+            } break;
+            case 0x03: {
+                if (isSet[3]) {
+                    HAPLogTLV(&generatedTLVLogObject, 0x03, "kTLVType_PublicKey", "Duplicate TLV.");
+                    return kHAPError_InvalidData;
+                }
+                isSet[3] = true;
+                if (tlv.value.numBytes > 384) {
+                    HAPLogTLV(
+                            &generatedTLVLogObject,
+                            0x03,
+                            "kTLVType_PublicKey",
+                            "Invalid length: %zu.",
+                            tlv.value.numBytes);
+                    return kHAPError_InvalidData;
+                }
+                value->publicKey.bytes = (void*) (uintptr_t) tlv.value.bytes;
+                value->publicKey.numBytes = tlv.value.numBytes;
+            } break;
+            case 0x04: {
+                if (isSet[4]) {
+                    HAPLogTLV(&generatedTLVLogObject, 0x04, "kTLVType_Proof", "Duplicate TLV.");
+                    return kHAPError_InvalidData;
+                }
+                isSet[4] = true;
+                if (tlv.value.numBytes > 64) {
+                    HAPLogTLV(
+                            &generatedTLVLogObject,
+                            0x04,
+                            "kTLVType_Proof",
+                            "Invalid length: %zu.",
+                            tlv.value.numBytes);
+                    return kHAPError_InvalidData;
+                }
+                value->proof.bytes = (void*) (uintptr_t) tlv.value.bytes;
+                value->proof.numBytes = tlv.value.numBytes;
+            } break;
+            case 0x05: {
+                if (isSet[5]) {
+                    HAPLogTLV(&generatedTLVLogObject, 0x05, "kTLVType_EncryptedData", "Duplicate TLV.");
+                    return kHAPError_InvalidData;
+                }
+                isSet[5] = true;
+                value->encryptedData.bytes = (void*) (uintptr_t) tlv.value.bytes;
+                value->encryptedData.numBytes = tlv.value.numBytes;
+            } break;
+            case 0x06: {
+                if (isSet[6]) {
+                    HAPLogTLV(&generatedTLVLogObject, 0x06, "kTLVType_State", "Duplicate TLV.");
+                    return kHAPError_InvalidData;
+                }
+                isSet[6] = true;
+                if (tlv.value.numBytes > sizeof(uint8_t)) {
+                    HAPLogTLV(
+                            &generatedTLVLogObject,
+                            0x06,
+                            "kTLVType_State",
+                            "Invalid integer length (%zu bytes).",
+                            tlv.value.numBytes);
+                    return kHAPError_InvalidData;
+                }
+                uint8_t integerValue = 0;
+                const uint8_t* integerBytes = tlv.value.bytes;
+                for (size_t i = 0; i < tlv.value.numBytes; i++) {
+                    integerValue |= (uint8_t)(((unsigned int) integerBytes[i]) << (i * CHAR_BIT));
+                }
+                if (integerValue < 1 || integerValue > 6) {
+                    HAPLogTLV(&generatedTLVLogObject, 0x06, "kTLVType_State", "Invalid integer value.");
+                    return kHAPError_InvalidData;
+                }
+                value->state = integerValue;
+            } break;
+            case 0x07: {
+                if (isSet[7]) {
+                    HAPLogTLV(&generatedTLVLogObject, 0x07, "kTLVType_Error", "Duplicate TLV.");
+                    return kHAPError_InvalidData;
+                }
+                isSet[7] = true;
+                if (tlv.value.numBytes != sizeof(uint8_t)) {
+                    HAPLogTLV(
+                            &generatedTLVLogObject,
+                            0x07,
+                            "kTLVType_Error",
+                            "Invalid enumeration length (%zu bytes).",
+                            tlv.value.numBytes);
+                    return kHAPError_InvalidData;
+                }
+                uint8_t enumerationValue = HAPReadUInt8(tlv.value.bytes);
+                if (!IsValidError(enumerationValue)) {
+                    HAPLogTLV(
+                            &generatedTLVLogObject,
+                            0x07,
+                            "kTLVType_Error",
+                            "Invalid enumeration value: %u.",
+                            enumerationValue);
+                    return kHAPError_InvalidData;
+                }
+                value->error = enumerationValue;
+            } break;
+            case 0x13: {
+                if (isSet[8]) {
+                    HAPLogTLV(&generatedTLVLogObject, 0x13, "kTLVType_Flags", "Duplicate TLV.");
+                    return kHAPError_InvalidData;
+                }
+                isSet[8] = true;
+                if (tlv.value.numBytes > sizeof(uint32_t)) {
+                    HAPLogTLV(
+                            &generatedTLVLogObject,
+                            0x13,
+                            "kTLVType_Flags",
+                            "Invalid integer length (%zu bytes).",
+                            tlv.value.numBytes);
+                    return kHAPError_InvalidData;
+                }
+                uint32_t integerValue = 0;
+                const uint8_t* integerBytes = tlv.value.bytes;
+                for (size_t i = 0; i < tlv.value.numBytes; i++) {
+                    integerValue |= (uint32_t)(((unsigned long) integerBytes[i]) << (i * CHAR_BIT));
+                }
+                value->flags = integerValue;
+            } break;
+            default: {
+                HAPLogSensitiveBuffer(
+                        &generatedTLVLogObject,
+                        tlv.value.bytes,
+                        tlv.value.numBytes,
+                        "[%02x] Ignored TLV.",
+                        tlv.type);
+            } break;
+        }
+    }
+
+    value->methodIsSet = isSet[0];
+    value->identifierIsSet = isSet[1];
+    value->saltIsSet = isSet[2];
+    value->publicKeyIsSet = isSet[3];
+    value->proofIsSet = isSet[4];
+    value->encryptedDataIsSet = isSet[5];
+    if (!isSet[6]) {
+        HAPLogTLV(&generatedTLVLogObject, 0x06, "kTLVType_State", "TLV missing.");
+        return kHAPError_InvalidData;
+    }
+    value->errorIsSet = isSet[7];
+    value->flagsIsSet = isSet[8];
+    if (!IsValidPairSetupMessage(value)) {
+        return kHAPError_InvalidData;
+    }
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError EncodePairing(HAPTLVWriterRef* writer, Pairing* value) {
+    HAPPrecondition(writer);
+    HAPPrecondition(value);
+
+    HAPError err;
+
+    // kTLVType_Identifier.
+    {
+        void* bytes;
+        size_t maxBytes;
+        HAPTLVWriterGetScratchBytes(writer, &bytes, &maxBytes);
+
+        size_t numBytes;
+        size_t numValueBytes = HAPStringGetNumBytes(value->identifier);
+        HAPPrecondition(IsValidPairingIdentifier(value->identifier));
+        HAPPrecondition(HAPUTF8IsValidData(value->identifier, numValueBytes));
+        HAPPrecondition(numValueBytes <= 36);
+        if (maxBytes < numValueBytes) {
+            HAPLogTLV(&generatedTLVLogObject, 0x01, "kTLVType_Identifier", "Not enough memory to encode string value.");
+            return kHAPError_OutOfResources;
+        }
+        HAPRawBufferCopyBytes(bytes, value->identifier, numValueBytes);
+        numBytes = numValueBytes;
+
+        err = HAPTLVWriterAppend(
+                writer, &(const HAPTLV) { .type = 0x01, .value = { .bytes = bytes, .numBytes = numBytes } });
+        if (err) {
+            HAPAssert(err == kHAPError_OutOfResources);
+            return err;
+        }
+    }
+
+    // kTLVType_PublicKey.
+    {
+        void* bytes;
+        size_t maxBytes;
+        HAPTLVWriterGetScratchBytes(writer, &bytes, &maxBytes);
+
+        size_t numBytes;
+        HAPPrecondition(value->publicKey.numBytes >= 32);
+        HAPPrecondition(value->publicKey.numBytes <= 32);
+        if (maxBytes < value->publicKey.numBytes) {
+            HAPLogTLV(&generatedTLVLogObject, 0x03, "kTLVType_PublicKey", "Not enough memory to encode data value.");
+            return kHAPError_OutOfResources;
+        }
+        HAPRawBufferCopyBytes(bytes, value->publicKey.bytes, value->publicKey.numBytes);
+        numBytes = value->publicKey.numBytes;
+
+        err = HAPTLVWriterAppend(
+                writer, &(const HAPTLV) { .type = 0x03, .value = { .bytes = bytes, .numBytes = numBytes } });
+        if (err) {
+            HAPAssert(err == kHAPError_OutOfResources);
+            return err;
+        }
+    }
+
+    // kTLVType_Permissions.
+    {
+        void* bytes;
+        size_t maxBytes;
+        HAPTLVWriterGetScratchBytes(writer, &bytes, &maxBytes);
+
+        size_t numBytes;
+        HAPPrecondition(value->permissions <= 1);
+        if (maxBytes < sizeof(uint8_t)) {
+            HAPLogTLV(
+                    &generatedTLVLogObject,
+                    0x0B,
+                    "kTLVType_Permissions",
+                    "Not enough memory to encode integer value.");
+            return kHAPError_OutOfResources;
+        }
+        HAPWriteUInt8(bytes, (uint8_t) value->permissions);
+        numBytes = sizeof(uint8_t);
+
+        err = HAPTLVWriterAppend(
+                writer, &(const HAPTLV) { .type = 0x0B, .value = { .bytes = bytes, .numBytes = numBytes } });
+        if (err) {
+            HAPAssert(err == kHAPError_OutOfResources);
+            return err;
+        }
+    }
+
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError DecodePairing(HAPTLVReaderRef* reader, Pairing* value) {
+    HAPPrecondition(reader);
+    HAPPrecondition(value);
+
+    HAPError err;
+
+    bool isSet[3];
+    HAPRawBufferZero(isSet, sizeof isSet);
+    for (;;) {
+        HAPTLV tlv;
+        bool found;
+        err = HAPTLVReaderGetNext(reader, &found, &tlv);
+        if (err) {
+            HAPAssert(err == kHAPError_InvalidData);
+            return err;
+        }
+        if (!found) {
+            break;
+        }
+
+        switch (tlv.type) {
+            case 0x01: {
+                if (isSet[0]) {
+                    HAPLogTLV(&generatedTLVLogObject, 0x01, "kTLVType_Identifier", "Duplicate TLV.");
+                    return kHAPError_InvalidData;
+                }
+                isSet[0] = true;
+                if (tlv.value.numBytes > 36) {
+                    HAPLogTLV(
+                            &generatedTLVLogObject,
+                            0x01,
+                            "kTLVType_Identifier",
+                            "Invalid length: %zu.",
+                            tlv.value.numBytes);
+                    return kHAPError_InvalidData;
+                }
+                if (HAPStringGetNumBytes(tlv.value.bytes) != tlv.value.numBytes) {
+                    HAPLogTLV(
+                            &generatedTLVLogObject,
+                            0x01,
+                            "kTLVType_Identifier",
+                            "Invalid string value: Contains NULL characters.");
+                    return kHAPError_InvalidData;
+                }
+                if (!HAPUTF8IsValidData(tlv.value.bytes, tlv.value.numBytes)) {
+                    HAPLogTLV(
+                            &generatedTLVLogObject,
+                            0x01,
+                            "kTLVType_Identifier",
+                            "Invalid string value: Not valid UTF-8.");
+                    return kHAPError_InvalidData;
+                }
+                if (!IsValidPairingIdentifier(tlv.value.bytes)) {
+                    HAPLogTLV(&generatedTLVLogObject, 0x01, "kTLVType_Identifier", "Invalid string value.");
+                    return kHAPError_InvalidData;
+                }
+                value->identifier = (char*) (uintptr_t) tlv.value.bytes;
+            } break;
+            case 0x03: {
+                if (isSet[1]) {
+                    HAPLogTLV(&generatedTLVLogObject, 0x03, "kTLVType_PublicKey", "Duplicate TLV.");
+                    return kHAPError_InvalidData;
+                }
+                isSet[1] = true;
+                if (tlv.value.numBytes < 32 || tlv.value.numBytes > 32) {
+                    HAPLogTLV(
+                            &generatedTLVLogObject,
+                            0x03,
+                            "kTLVType_PublicKey",
+                            "Invalid length: %zu.",
+                            tlv.value.numBytes);
+                    return kHAPError_InvalidData;
+                }
+                value->publicKey.bytes = (void*) (uintptr_t) tlv.value.bytes;
+                value->publicKey.numBytes = tlv.value.numBytes;
+            } break;
+            case 0x0B: {
+                if (isSet[2]) {
+                    HAPLogTLV(&generatedTLVLogObject, 0x0B, "kTLVType_Permissions", "Duplicate TLV.");
+                    return kHAPError_InvalidData;
+                }
+                isSet[2] = true;
+                if (tlv.value.numBytes > sizeof(uint8_t)) {
+                    HAPLogTLV(
+                            &generatedTLVLogObject,
+                            0x0B,
+                            "kTLVType_Permissions",
+                            "Invalid integer length (%zu bytes).",
+                            tlv.value.numBytes);
+                    return kHAPError_InvalidData;
+                }
+                uint8_t integerValue = 0;
+                const uint8_t* integerBytes = tlv.value.bytes;
+                for (size_t i = 0; i < tlv.value.numBytes; i++) {
+                    integerValue |= (uint8_t)(((unsigned int) integerBytes[i]) << (i * CHAR_BIT));
+                }
+                if (integerValue > 1) {
+                    HAPLogTLV(&generatedTLVLogObject, 0x0B, "kTLVType_Permissions", "Invalid integer value.");
+                    return kHAPError_InvalidData;
+                }
+                value->permissions = integerValue;
+            } break;
+            default: {
+                HAPLogSensitiveBuffer(
+                        &generatedTLVLogObject,
+                        tlv.value.bytes,
+                        tlv.value.numBytes,
+                        "[%02x] Ignored TLV.",
+                        tlv.type);
+            } break;
+        }
+    }
+
+    if (!isSet[0]) {
+        HAPLogTLV(&generatedTLVLogObject, 0x01, "kTLVType_Identifier", "TLV missing.");
+        return kHAPError_InvalidData;
+    }
+    if (!isSet[1]) {
+        HAPLogTLV(&generatedTLVLogObject, 0x03, "kTLVType_PublicKey", "TLV missing.");
+        return kHAPError_InvalidData;
+    }
+    if (!isSet[2]) {
+        HAPLogTLV(&generatedTLVLogObject, 0x0B, "kTLVType_Permissions", "TLV missing.");
+        return kHAPError_InvalidData;
+    }
+    return kHAPError_None;
+}
+
+typedef struct {
+    HAPTLVWriterRef* writer;
+    HAPError err;
+    bool needsSeparator;
+} EncodePairingSequenceContext;
+
+static void EncodePairingSequenceItem(void* _Nullable context_, HAPTLVValue* item_, bool* shouldContinue) {
+    HAPPrecondition(context_);
+    EncodePairingSequenceContext* context = context_;
+    HAPPrecondition(item_);
+    Pairing* item = item_;
+    HAPPrecondition(shouldContinue);
+
+    HAPError err;
+
+    if (context->needsSeparator) {
+        err = HAPTLVWriterAppend(
+                context->writer, &(const HAPTLV) { .type = 0xFF, .value = { .bytes = NULL, .numBytes = 0 } });
+        if (err) {
+            HAPAssert(err == kHAPError_OutOfResources);
+            context->err = err;
+            *shouldContinue = false;
+            return;
+        }
+    }
+    context->needsSeparator = true;
+
+    // Pairing.
+    void* bytes;
+    size_t maxBytes;
+    HAPTLVWriterGetScratchBytes(context->writer, &bytes, &maxBytes);
+
+    size_t numBytes;
+    HAPTLVWriterRef subWriter;
+    HAPTLVWriterCreate(&subWriter, bytes, maxBytes);
+    err = EncodePairing(&subWriter, item);
+    if (err) {
+        HAPLogTLV(&generatedTLVLogObject, 0x0C, "Pairing", "Value encoding failed.");
+        context->err = err;
+        *shouldContinue = false;
+        return;
+    }
+    HAPTLVWriterGetBuffer(&subWriter, &bytes, &numBytes);
+
+    err = HAPTLVWriterAppend(
+            context->writer, &(const HAPTLV) { .type = 0x0C, .value = { .bytes = bytes, .numBytes = numBytes } });
+    if (err) {
+        HAPAssert(err == kHAPError_OutOfResources);
+        context->err = err;
+        *shouldContinue = false;
+        return;
+    }
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError EncodePairingSequence(HAPTLVWriterRef* writer, PairingSequence* value) {
+    HAPPrecondition(writer);
+    HAPPrecondition(value);
+    HAPPrecondition(value->enumerate);
+
+    HAPError err;
+
+    EncodePairingSequenceContext context;
+    HAPRawBufferZero(&context, sizeof context);
+    context.writer = writer;
+    err = value->enumerate(&value->dataSource, EncodePairingSequenceItem, &context);
+    if (!err) {
+        err = context.err;
+    }
+    return err;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError EnumeratePairingSequence(
+        HAPSequenceTLVDataSourceRef* dataSource,
+        HAPSequenceTLVEnumerateCallback callback,
+        void* _Nullable context) {
+    HAPPrecondition(dataSource);
+    HAPPrecondition(callback);
+
+    HAPError err;
+
+    HAPTLVReaderRef* reader = (HAPTLVReaderRef*) dataSource;
+    size_t dataSourceOffset = HAP_OFFSETOF(PairingSequence, dataSource);
+    PairingSequence* value = (PairingSequence*) ((char*) dataSource - dataSourceOffset);
+    bool shouldContinue = true;
+    for (;;) {
+        HAPTLV tlv;
+        bool found;
+        err = HAPTLVReaderGetNext(reader, &found, &tlv);
+        if (err) {
+            HAPAssert(err == kHAPError_InvalidData);
+            return err;
+        }
+        if (!found) {
+            break;
+        }
+
+        switch (tlv.type) {
+            case 0x0C: {
+                HAPTLVReaderRef subReader;
+                HAPTLVReaderCreate(&subReader, (void*) (uintptr_t) tlv.value.bytes, tlv.value.numBytes);
+                err = DecodePairing(&subReader, &value->_);
+                if (err) {
+                    HAPAssert(err == kHAPError_InvalidData);
+                    HAPLogTLV(&generatedTLVLogObject, 0x0C, "Pairing", "Invalid value.");
+                    return err;
+                }
+                if (shouldContinue) {
+                    callback(context, &value->_, &shouldContinue);
+                }
+            } break;
+            case 0xFF: {
+            } break;
+            default: {
+                HAPLogSensitiveBuffer(
+                        &generatedTLVLogObject,
+                        tlv.value.bytes,
+                        tlv.value.numBytes,
+                        "[%02x] Ignored TLV.",
+                        tlv.type);
+            } break;
+        }
+    }
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError DecodePairingSequence(HAPTLVReaderRef* reader, PairingSequence* value) {
+    HAPPrecondition(reader);
+    HAPPrecondition(value);
+
+    // Items are decoded when the sequence is enumerated.
+    HAPRawBufferZero(value, sizeof *value);
+    HAPRawBufferCopyBytes(&value->dataSource, reader, sizeof *reader);
+    value->enumerate = EnumeratePairingSequence;
+    return kHAPError_None;
+}
+
+typedef struct {
+    HAPTLVWriterRef* writer;
+    HAPError err;
+    bool needsSeparator;
+} EncodeIdentifierSequenceContext;
+
+static void EncodeIdentifierSequenceItem(void* _Nullable context_, HAPTLVValue* item_, bool* shouldContinue) {
+    HAPPrecondition(context_);
+    EncodeIdentifierSequenceContext* context = context_;
+    HAPPrecondition(item_);
+    uint16_t* item = item_;
+    HAPPrecondition(shouldContinue);
+
+    HAPError err;
+
+    if (context->needsSeparator) {
+        err = HAPTLVWriterAppend(
+                context->writer, &(const HAPTLV) { .type = 0xFF, .value = { .bytes = NULL, .numBytes = 0 } });
+        if (err) {
+            HAPAssert(err == kHAPError_OutOfResources);
+            context->err = err;
+            *shouldContinue = false;
+            return;
+        }
+    }
+    context->needsSeparator = true;
+
+    // Identifier.
+    void* bytes;
+    size_t maxBytes;
+    HAPTLVWriterGetScratchBytes(context->writer, &bytes, &maxBytes);
+
+    size_t numBytes;
+    HAPPrecondition((*item) >= 1);
+    if (maxBytes < sizeof(uint16_t)) {
+        HAPLogTLV(&generatedTLVLogObject, 0x0D, "Identifier", "Not enough memory to encode integer value.");
+        context->err = kHAPError_OutOfResources;
+        *shouldContinue = false;
+        return;
+    }
+    HAPWriteLittleUInt16(bytes, (*item));
+    numBytes = sizeof(uint16_t);
+
+    err = HAPTLVWriterAppend(
+            context->writer, &(const HAPTLV) { .type = 0x0D, .value = { .bytes = bytes, .numBytes = numBytes } });
+    if (err) {
+        HAPAssert(err == kHAPError_OutOfResources);
+        context->err = err;
+        *shouldContinue = false;
+        return;
+    }
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError EncodeIdentifierSequence(HAPTLVWriterRef* writer, IdentifierSequence* value) {
+    HAPPrecondition(writer);
+    HAPPrecondition(value);
+    HAPPrecondition(value->enumerate);
+
+    HAPError err;
+
+    EncodeIdentifierSequenceContext context;
+    HAPRawBufferZero(&context, sizeof context);
+    context.writer = writer;
+    err = value->enumerate(&value->dataSource, EncodeIdentifierSequenceItem, &context);
+    if (!err) {
+        err = context.err;
+    }
+    return err;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError EnumerateIdentifierSequence(
+        HAPSequenceTLVDataSourceRef* dataSource,
+        HAPSequenceTLVEnumerateCallback callback,
+        void* _Nullable context) {
+    HAPPrecondition(dataSource);
+    HAPPrecondition(callback);
+
+    HAPError err;
+
+    HAPTLVReaderRef* reader = (HAPTLVReaderRef*) dataSource;
+    size_t dataSourceOffset = HAP_OFFSETOF(IdentifierSequence, dataSource);
+    IdentifierSequence* value = (IdentifierSequence*) ((char*) dataSource - dataSourceOffset);
+    bool shouldContinue = true;
+    for (;;) {
+        HAPTLV tlv;
+        bool found;
+        err = HAPTLVReaderGetNext(reader, &found, &tlv);
+        if (err) {
+            HAPAssert(err == kHAPError_InvalidData);
+            return err;
+        }
+        if (!found) {
+            break;
+        }
+
+        switch (tlv.type) {
+            case 0x0D: {
+                if (tlv.value.numBytes > sizeof(uint16_t)) {
+                    HAPLogTLV(
+                            &generatedTLVLogObject,
+                            0x0D,
+                            "Identifier",
+                            "Invalid integer length (%zu bytes).",
+                            tlv.value.numBytes);
+                    return kHAPError_InvalidData;
+                }
+                uint16_t integerValue = 0;
+                const uint8_t* integerBytes = tlv.value.bytes;
+                for (size_t i = 0; i < tlv.value.numBytes; i++) {
+                    integerValue |= (uint16_t)(((unsigned int) integerBytes[i]) << (i * CHAR_BIT));
+                }
+                if (integerValue < 1) {
+                    HAPLogTLV(&generatedTLVLogObject, 0x0D, "Identifier", "Invalid integer value.");
+                    return kHAPError_InvalidData;
+                }
+                value->_ = integerValue;
+                if (shouldContinue) {
+                    callback(context, &value->_, &shouldContinue);
+                }
+            } break;
+            case 0xFF: {
+            } break;
+            default: {
+                HAPLogSensitiveBuffer(
+                        &generatedTLVLogObject,
+                        tlv.value.bytes,
+                        tlv.value.numBytes,
+                        "[%02x] Ignored TLV.",
+                        tlv.type);
+            } break;
+        }
+    }
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError DecodeIdentifierSequence(HAPTLVReaderRef* reader, IdentifierSequence* value) {
+    HAPPrecondition(reader);
+    HAPPrecondition(value);
+
+    // Items are decoded when the sequence is enumerated.
+    HAPRawBufferZero(value, sizeof *value);
+    HAPRawBufferCopyBytes(&value->dataSource, reader, sizeof *reader);
+    value->enumerate = EnumerateIdentifierSequence;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError EncodeListPairingsResponse(HAPTLVWriterRef* writer, ListPairingsResponse* value) {
+    HAPPrecondition(writer);
+    HAPPrecondition(value);
+
+    HAPError err;
+
+    // kTLVType_State.
+    {
+        void* bytes;
+        size_t maxBytes;
+        HAPTLVWriterGetScratchBytes(writer, &bytes, &maxBytes);
+
+        size_t numBytes;
+        HAPPrecondition(value->state >= 1);
+        HAPPrecondition(value->state <= 6);
+        if (maxBytes < sizeof(uint8_t)) {
+            HAPLogTLV(&generatedTLVLogObject, 0x06, "kTLVType_State", "Not enough memory to encode integer value.");
+            return kHAPError_OutOfResources;
+        }
+        HAPWriteUInt8(bytes, (uint8_t) value->state);
+        numBytes = sizeof(uint8_t);
+
+        err = HAPTLVWriterAppend(
+                writer, &(const HAPTLV) { .type = 0x06, .value = { .bytes = bytes, .numBytes = numBytes } });
+        if (err) {
+            HAPAssert(err == kHAPError_OutOfResources);
+            return err;
+        }
+    }
+
+    // Pairings.
+    {
+        void* bytes;
+        size_t maxBytes;
+        HAPTLVWriterGetScratchBytes(writer, &bytes, &maxBytes);
+
+        size_t numBytes;
+        HAPTLVWriterRef subWriter;
+        HAPTLVWriterCreate(&subWriter, bytes, maxBytes);
+        err = EncodePairingSequence(&subWriter, &value->pairings);
+        if (err) {
+            HAPLogTLV(&generatedTLVLogObject, 0x0E, "Pairings", "Value encoding failed.");
+            return err;
+        }
+        HAPTLVWriterGetBuffer(&subWriter, &bytes, &numBytes);
+
+        err = HAPTLVWriterAppend(
+                writer, &(const HAPTLV) { .type = 0x0E, .value = { .bytes = bytes, .numBytes = numBytes } });
+        if (err) {
+            HAPAssert(err == kHAPError_OutOfResources);
+            return err;
+        }
+    }
+
+    // Identifiers.
+    {
+        void* bytes;
+        size_t maxBytes;
+        HAPTLVWriterGetScratchBytes(writer, &bytes, &maxBytes);
+
+        size_t numBytes;
+        HAPTLVWriterRef subWriter;
+        HAPTLVWriterCreate(&subWriter, bytes, maxBytes);
+        err = EncodeIdentifierSequence(&subWriter, &value->identifiers);
+        if (err) {
+            HAPLogTLV(&generatedTLVLogObject, 0x0F, "Identifiers", "Value encoding failed.");
+            return err;
+        }
+        HAPTLVWriterGetBuffer(&subWriter, &bytes, &numBytes);
+
+        err = HAPTLVWriterAppend(
+                writer, &(const HAPTLV) { .type = 0x0F, .value = { .bytes = bytes, .numBytes = numBytes } });
+        if (err) {
+            HAPAssert(err == kHAPError_OutOfResources);
+            return err;
+        }
+    }
+
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError DecodeListPairingsResponse(HAPTLVReaderRef* reader, ListPairingsResponse* value) {
+    HAPPrecondition(reader);
+    HAPPrecondition(value);
+
+    HAPError err;
+
+    bool isSet[3];
+    HAPRawBufferZero(isSet, sizeof isSet);
+    for (;;) {
+        HAPTLV tlv;
+        bool found;
+        err = HAPTLVReaderGetNext(reader, &found, &tlv);
+        if (err) {
+            HAPAssert(err == kHAPError_InvalidData);
+            return err;
+        }
+        if (!found) {
+            break;
+        }
+
+        switch (tlv.type) {
+            case 0x06: {
+                if (isSet[0]) {
+                    HAPLogTLV(&generatedTLVLogObject, 0x06, "kTLVType_State", "Duplicate TLV.");
+                    return kHAPError_InvalidData;
+                }
+                isSet[0] = true;
+                if (tlv.value.numBytes > sizeof(uint8_t)) {
+                    HAPLogTLV(
+                            &generatedTLVLogObject,
+                            0x06,
+                            "kTLVType_State",
+                            "Invalid integer length (%zu bytes).",
+                            tlv.value.numBytes);
+                    return kHAPError_InvalidData;
+                }
+                uint8_t integerValue = 0;
+                const uint8_t* integerBytes = tlv.value.bytes;
+                for (size_t i = 0; i < tlv.value.numBytes; i++) {
+                    integerValue |= (uint8_t)(((unsigned int) integerBytes[i]) << (i * CHAR_BIT));
+                }
+                if (integerValue < 1 || integerValue > 6) {
+                    HAPLogTLV(&generatedTLVLogObject, 0x06, "kTLVType_State", "Invalid integer value.");
+                    return kHAPError_InvalidData;
+                }
+                value->state = integerValue;
+            } break;
+            case 0x0E: {
+                if (isSet[1]) {
+                    HAPLogTLV(&generatedTLVLogObject, 0x0E, "Pairings", "Duplicate TLV.");
+                    return kHAPError_InvalidData;
+                }
+                isSet[1] = true;
+                HAPTLVReaderRef subReader;
+                HAPTLVReaderCreate(&subReader, (void*) (uintptr_t) tlv.value.bytes, tlv.value.numBytes);
+                err = DecodePairingSequence(&subReader, &value->pairings);
+                if (err) {
+                    HAPAssert(err == kHAPError_InvalidData);
+                    HAPLogTLV(&generatedTLVLogObject, 0x0E, "Pairings", "Invalid value.");
+                    return err;
+                }
+            } break;
+            case 0x0F: {
+                if (isSet[2]) {
+                    HAPLogTLV(&generatedTLVLogObject, 0x0F, "Identifiers", "Duplicate TLV.");
+                    return kHAPError_InvalidData;
+                }
+                isSet[2] = true;
+                HAPTLVReaderRef subReader;
+                HAPTLVReaderCreate(&subReader, (void*) (uintptr_t) tlv.value.bytes, tlv.value.numBytes);
+                err = DecodeIdentifierSequence(&subReader, &value->identifiers);
+                if (err) {
+                    HAPAssert(err == kHAPError_InvalidData);
+                    HAPLogTLV(&generatedTLVLogObject, 0x0F, "Identifiers", "Invalid value.");
+                    return err;
+                }
+            } break;
+            default: {
+                HAPLogSensitiveBuffer(
+                        &generatedTLVLogObject,
+                        tlv.value.bytes,
+                        tlv.value.numBytes,
+                        "[%02x] Ignored TLV.",
+                        tlv.type);
+            } break;
+        }
+    }
+
+    if (!isSet[0]) {
+        HAPLogTLV(&generatedTLVLogObject, 0x06, "kTLVType_State", "TLV missing.");
+        return kHAPError_InvalidData;
+    }
+    if (!isSet[1]) {
+        HAPLogTLV(&generatedTLVLogObject, 0x0E, "Pairings", "TLV missing.");
+        return kHAPError_InvalidData;
+    }
+    if (!isSet[2]) {
+        HAPLogTLV(&generatedTLVLogObject, 0x0F, "Identifiers", "TLV missing.");
+        return kHAPError_InvalidData;
+    }
+    return kHAPError_None;
+}
+
+HAP_DIAGNOSTIC_POP
@@ -0,0 +1,449 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+// Checks that the encoders and decoders generated by TLVCodeGenerator behave like HAPTLVReaderDecode and
+// HAPTLVWriterEncode. The pair setup messages are the ones from HAPTLVTest.
+
+#include "HAPTLVCodeGeneratorTest+Formats.h"
+
+#include "HAPTLVCodeGeneratorTest+Generated.h"
+
+static void CheckDataEqual(const HAPDataTLVValue* value, const HAPDataTLVValue* otherValue) {
+    HAPPrecondition(value);
+    HAPPrecondition(otherValue);
+
+    HAPAssert(value->numBytes == otherValue->numBytes);
+    HAPAssert(HAPRawBufferAreEqual(value->bytes, otherValue->bytes, value->numBytes));
+}
+
+static void CheckPairSetupMessagesEqual(const PairSetupMessage* value, const PairSetupMessage* otherValue) {
+    HAPPrecondition(value);
+    HAPPrecondition(otherValue);
+
+    HAPAssert(value->methodIsSet == otherValue->methodIsSet);
+    if (value->methodIsSet) {
+        HAPAssert(value->method == otherValue->method);
+    }
+    HAPAssert(value->identifierIsSet == otherValue->identifierIsSet);
+    if (value->identifierIsSet) {
+        HAPAssert(HAPStringAreEqual(value->identifier, otherValue->identifier));
+    }
+    HAPAssert(value->saltIsSet == otherValue->saltIsSet);
+    if (value->saltIsSet) {
+        CheckDataEqual(&value->salt, &otherValue->salt);
+    }
+    HAPAssert(value->publicKeyIsSet == otherValue->publicKeyIsSet);
+    if (value->publicKeyIsSet) {
+        CheckDataEqual(&value->publicKey, &otherValue->publicKey);
+    }
+    HAPAssert(value->proofIsSet == otherValue->proofIsSet);
+    if (value->proofIsSet) {
+        CheckDataEqual(&value->proof, &otherValue->proof);
+    }
+    HAPAssert(value->encryptedDataIsSet == otherValue->encryptedDataIsSet);
+    if (value->encryptedDataIsSet) {
+        CheckDataEqual(&value->encryptedData, &otherValue->encryptedData);
+    }
+    HAPAssert(value->state == otherValue->state);
+    HAPAssert(value->errorIsSet == otherValue->errorIsSet);
+    if (value->errorIsSet) {
+        HAPAssert(value->error == otherValue->error);
+    }
+    HAPAssert(value->flagsIsSet == otherValue->flagsIsSet);
+    if (value->flagsIsSet) {
+        HAPAssert(value->flags == otherValue->flags);
+    }
+}
+
+/**
+ * Encodes a pair setup message with the interpreter and with the generated encoder for every buffer size up to the
+ * size of the encoded message, and checks that the results are identical.
+ */
+static void CheckEncodePairSetupMessage(PairSetupMessage* value, const void* expectedBytes, size_t numExpectedBytes) {
+    HAPPrecondition(value);
+
+    HAPError err;
+
+    static uint8_t buffers[2][1024];
+    for (size_t maxBytes = 0; maxBytes <= sizeof buffers[0]; maxBytes++) {
+        HAPTLVWriterRef writer;
+        HAPTLVWriterRef generatedWriter;
+        HAPTLVWriterCreate(&writer, buffers[0], maxBytes);
+        HAPTLVWriterCreate(&generatedWriter, buffers[1], maxBytes);
+        HAPError expectedErr = HAPTLVWriterEncodeVoid(&writer, &kPairSetupMessageFormat, value);
+        err = EncodePairSetupMessage(&generatedWriter, value);
+        HAPAssert(err == expectedErr);
+        if (err) {
+            HAPAssert(err == kHAPError_OutOfResources);
+            continue;
+        }
+
+        void* bytes;
+        size_t numBytes;
+        void* generatedBytes;
+        size_t numGeneratedBytes;
+        HAPTLVWriterGetBuffer(&writer, &bytes, &numBytes);
+        HAPTLVWriterGetBuffer(&generatedWriter, &generatedBytes, &numGeneratedBytes);
+        HAPAssert(numGeneratedBytes == numBytes);
+        HAPAssert(HAPRawBufferAreEqual(generatedBytes, bytes, numBytes));
+        if (expectedBytes) {
+            HAPAssert(numBytes == numExpectedBytes);
+            HAPAssert(HAPRawBufferAreEqual(bytes, HAPNonnullVoid(expectedBytes), numBytes));
+        }
+        return;
+    }
+    HAPFatalError();
+}
+
+/**
+ * Decodes a pair setup message with the interpreter and with the generated decoder, checks that the results are
+ * identical, and re-encodes the decoded message.
+ *
+ * @param      tlvBytes             Encoded pair setup message.
+ * @param      numTLVBytes          Length of encoded pair setup message.
+ * @param      expectedErr          Expected result of decoding.
+ * @param      isCanonical          Whether encoding the decoded message reproduces the encoded pair setup message.
+ */
+static void CheckPairSetupMessage(const void* tlvBytes, size_t numTLVBytes, HAPError expectedErr, bool isCanonical) {
+    HAPPrecondition(tlvBytes);
+
+    HAPError err;
+
+    static uint8_t bytes[1024];
+    static uint8_t generatedBytes[1024];
+    HAPAssert(numTLVBytes <= sizeof bytes);
+    HAPRawBufferCopyBytes(bytes, tlvBytes, numTLVBytes);
+    HAPRawBufferCopyBytes(generatedBytes, tlvBytes, numTLVBytes);
+
+    PairSetupMessage value;
+    PairSetupMessage generatedValue;
+    HAPRawBufferZero(&value, sizeof value);
+    HAPRawBufferZero(&generatedValue, sizeof generatedValue);
+
+    HAPTLVReaderRef reader;
+    HAPTLVReaderRef generatedReader;
+    HAPTLVReaderCreate(&reader, bytes, numTLVBytes);
+    HAPTLVReaderCreate(&generatedReader, generatedBytes, numTLVBytes);
+    err = HAPTLVReaderDecodeVoid(&reader, &kPairSetupMessageFormat, &value);
+    HAPAssert(err == expectedErr);
+    err = DecodePairSetupMessage(&generatedReader, &generatedValue);
+    HAPAssert(err == expectedErr);
+    if (err) {
+        return;
+    }
+    CheckPairSetupMessagesEqual(&value, &generatedValue);
+    CheckEncodePairSetupMessage(&generatedValue, isCanonical ? tlvBytes : NULL, numTLVBytes);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static uint8_t publicKey[] = { 0x2a, 0x4f, 0x0c, 0x15, 0x93, 0x11, 0x86, 0x4b, 0xd1, 0x69, 0xe7,
+                                0x3b, 0x52, 0x44, 0x8c, 0x0f, 0x67, 0xc1, 0xb3, 0x9e, 0x0e, 0x71,
+                                0x88, 0x21, 0x7d, 0x3f, 0x5a, 0x60, 0xf4, 0x2d, 0xde, 0x96 };
+
+static Pairing pairings[3];
+static uint16_t identifiers[4];
+
+HAP_RESULT_USE_CHECK
+static HAPError EnumeratePairings(
+        HAPSequenceTLVDataSourceRef* dataSource HAP_UNUSED,
+        HAPSequenceTLVEnumerateCallback callback,
+        void* _Nullable context) {
+    HAPPrecondition(callback);
+
+    bool shouldContinue = true;
+    for (size_t i = 0; shouldContinue && i < HAPArrayCount(pairings); i++) {
+        callback(context, &pairings[i], &shouldContinue);
+    }
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError EnumerateIdentifiers(
+        HAPSequenceTLVDataSourceRef* dataSource HAP_UNUSED,
+        HAPSequenceTLVEnumerateCallback callback,
+        void* _Nullable context) {
+    HAPPrecondition(callback);
+
+    bool shouldContinue = true;
+    for (size_t i = 0; shouldContinue && i < HAPArrayCount(identifiers); i++) {
+        callback(context, &identifiers[i], &shouldContinue);
+    }
+    return kHAPError_None;
+}
+
+static size_t numEnumeratedPairings;
+
+static void CheckPairing(void* _Nullable context HAP_UNUSED, HAPTLVValue* value_, bool* shouldContinue) {
+    HAPPrecondition(value_);
+    const Pairing* value = value_;
+    HAPPrecondition(shouldContinue);
+
+    HAPAssert(numEnumeratedPairings < HAPArrayCount(pairings));
+    const Pairing* expectedValue = &pairings[numEnumeratedPairings++];
+    HAPAssert(HAPStringAreEqual(value->identifier, expectedValue->identifier));
+    CheckDataEqual(&value->publicKey, &expectedValue->publicKey);
+    HAPAssert(value->permissions == expectedValue->permissions);
+}
+
+static size_t numEnumeratedIdentifiers;
+
+static void CheckIdentifier(void* _Nullable context HAP_UNUSED, HAPTLVValue* value_, bool* shouldContinue) {
+    HAPPrecondition(value_);
+    const uint16_t* value = value_;
+    HAPPrecondition(shouldContinue);
+
+    HAPAssert(numEnumeratedIdentifiers < HAPArrayCount(identifiers));
+    HAPAssert(*value == identifiers[numEnumeratedIdentifiers++]);
+}
+
+static void CheckListPairingsResponse(void) {
+    HAPError err;
+
+    static char pairingIdentifiers[HAPArrayCount(pairings)][37];
+    for (size_t i = 0; i < HAPArrayCount(pairings); i++) {
+        size_t numIdentifierBytes = i == 0 ? sizeof pairingIdentifiers[i] - 1 : 1 + i;
+        for (size_t j = 0; j < numIdentifierBytes; j++) {
+            pairingIdentifiers[i][j] = (char) ('A' + i);
+        }
+        pairingIdentifiers[i][numIdentifierBytes] = '\0';
+        pairings[i].identifier = pairingIdentifiers[i];
+        pairings[i].publicKey.bytes = publicKey;
+        pairings[i].publicKey.numBytes = sizeof publicKey;
+        pairings[i].permissions = (uint8_t)(i == 0);
+    }
+    for (size_t i = 0; i < HAPArrayCount(identifiers); i++) {
+        identifiers[i] = (uint16_t)(1 + i * 0x1234);
+    }
+
+    // Encode.
+    static uint8_t bytes[1024];
+    static uint8_t generatedBytes[1024];
+    size_t numBytes;
+    {
+        ListPairingsResponse value;
+        HAPRawBufferZero(&value, sizeof value);
+        value.state = 2;
+        value.pairings.enumerate = EnumeratePairings;
+        value.identifiers.enumerate = EnumerateIdentifiers;
+
+        HAPTLVWriterRef writer;
+        HAPTLVWriterRef generatedWriter;
+        HAPTLVWriterCreate(&writer, bytes, sizeof bytes);
+        HAPTLVWriterCreate(&generatedWriter, generatedBytes, sizeof generatedBytes);
+        err = HAPTLVWriterEncodeVoid(&writer, &kListPairingsResponseFormat, &value);
+        HAPAssert(!err);
+        err = EncodeListPairingsResponse(&generatedWriter, &value);
+        HAPAssert(!err);
+
+        void* tlvBytes;
+        void* generatedTLVBytes;
+        size_t numGeneratedBytes;
+        HAPTLVWriterGetBuffer(&writer, &tlvBytes, &numBytes);
+        HAPTLVWriterGetBuffer(&generatedWriter, &generatedTLVBytes, &numGeneratedBytes);
+        HAPAssert(numGeneratedBytes == numBytes);
+        HAPAssert(HAPRawBufferAreEqual(generatedTLVBytes, tlvBytes, numBytes));
+        HAPRawBufferCopyBytes(bytes, tlvBytes, numBytes);
+    }
+
+    // Decode and enumerate.
+    {
+        ListPairingsResponse value;
+        HAPRawBufferZero(&value, sizeof value);
+        HAPTLVReaderRef reader;
+        HAPTLVReaderCreate(&reader, bytes, numBytes);
+        err = DecodeListPairingsResponse(&reader, &value);
+        HAPAssert(!err);
+        HAPAssert(value.state == 2);
+
+        numEnumeratedPairings = 0;
+        err = value.pairings.enumerate(&value.pairings.dataSource, CheckPairing, NULL);
+        HAPAssert(!err);
+        HAPAssert(numEnumeratedPairings == HAPArrayCount(pairings));
+
+        numEnumeratedIdentifiers = 0;
+        err = value.identifiers.enumerate(&value.identifiers.dataSource, CheckIdentifier, NULL);
+        HAPAssert(!err);
+        HAPAssert(numEnumeratedIdentifiers == HAPArrayCount(identifiers));
+    }
+
+    // Maximum length of an encoded pairing.
+    {
+        HAPTLVWriterRef writer;
+        HAPTLVWriterCreate(&writer, generatedBytes, sizeof generatedBytes);
+        err = EncodePairing(&writer, &pairings[0]);
+        HAPAssert(!err);
+
+        void* tlvBytes;
+        size_t numTLVBytes;
+        HAPTLVWriterGetBuffer(&writer, &tlvBytes, &numTLVBytes);
+        HAPAssert(numTLVBytes == kPairing_MaxBytes);
+    }
+}
+
+int main() {
+    // HomeKit Pair Setup M1.
+    {
+        const uint8_t bytes[] = { 0x00, 0x01, 0x00, 0x06, 0x01, 0x01 };
+        CheckPairSetupMessage(bytes, sizeof bytes, kHAPError_None, /* isCanonical: */ true);
+    }
+
+    // HomeKit Pair Setup M2 with fragmented public key.
+    {
+        uint8_t bytes[3 + 2 + 16 + 2 + 255 + 2 + 129];
+        size_t numBytes = 0;
+        bytes[numBytes++] = 0x06;
+        bytes[numBytes++] = 0x01;
+        bytes[numBytes++] = 0x02;
+        bytes[numBytes++] = 0x02;
+        bytes[numBytes++] = 0x10;
+        for (size_t i = 0; i < 16; i++) {
+            bytes[numBytes++] = (uint8_t)(0xA0 + i);
+        }
+        bytes[numBytes++] = 0x03;
+        bytes[numBytes++] = 0xFF;
+        for (size_t i = 0; i < 255; i++) {
+            bytes[numBytes++] = (uint8_t)(i * 7);
+        }
+        bytes[numBytes++] = 0x03;
+        bytes[numBytes++] = 0x81;
+        for (size_t i = 0; i < 129; i++) {
+            bytes[numBytes++] = (uint8_t) ~i;
+        }
+        HAPAssert(numBytes == sizeof bytes);
+        CheckPairSetupMessage(bytes, sizeof bytes, kHAPError_None, /* isCanonical: */ false);
+    }
+
+    // HomeKit Pair Setup M4.
+    {
+        const uint8_t bytes[] = { 0x06, 0x01, 0x04,
+
+                                  0x04, 0x40, 0x5f, 0x7a, 0x20, 0xd3, 0x4d, 0x1f, 0x16, 0x8f, 0x2b, 0x5f, 0x0f, 0xcd,
+                                  0x0c, 0x7f, 0xe3, 0x27, 0xa5, 0x40, 0xa5, 0x51, 0x7c, 0xf7, 0x0b, 0x7e, 0x2a, 0x34,
+                                  0x88, 0x01, 0x48, 0x90, 0x7e, 0xe4, 0x25, 0xf2, 0x6c, 0xb0, 0xbd, 0x63, 0x2a, 0xa0,
+                                  0x39, 0x98, 0xc8, 0xc8, 0x7b, 0xbb, 0xcd, 0xdc, 0x2f, 0x0d, 0x08, 0x89, 0xb7, 0x70,
+                                  0x0a, 0xf8, 0x1c, 0x46, 0xb6, 0x31, 0x83, 0x3f, 0x57, 0xf9 };
+        CheckPairSetupMessage(bytes, sizeof bytes, kHAPError_None, /* isCanonical: */ false);
+    }
+
+    // HomeKit Pair Setup M5.
+    {
+        const uint8_t bytes[] = {
+            0x05, 0x9a, 0xef, 0x74, 0x54, 0x5d, 0xab, 0x72, 0xfb, 0xcc, 0x34, 0x02, 0xd9, 0x0b, 0x79, 0xcc, 0xd1, 0xa6,
+            0x00, 0x66, 0x4f, 0xf8, 0x2b, 0x30, 0x3a, 0x64, 0x1b, 0xa7, 0xe5, 0xf9, 0xef, 0xe3, 0xda, 0x5c, 0x9c, 0x0d,
+            0x67, 0x46, 0x7d, 0x7e, 0x05, 0x3c, 0xd3, 0x32, 0x30, 0x6e, 0xc6, 0xc6, 0x06, 0xfa, 0x38, 0x69, 0x20, 0xb7,
+            0x33, 0xfd, 0xfd, 0x25, 0x1e, 0xe7, 0xd9, 0x4b, 0x31, 0x5a, 0xc6, 0x51, 0x02, 0xaf, 0x8b, 0x08, 0x6e, 0x95,
+            0x25, 0xbd, 0x93, 0xa9, 0x2b, 0x62, 0xc3, 0x6d, 0xdb, 0x01, 0xde, 0xe9, 0x46, 0x15, 0x78, 0x18, 0x87, 0xc5,
+            0x7d, 0x2e, 0xd7, 0x8a, 0x4e, 0x7b, 0x2d, 0x3a, 0x59, 0x17, 0xb7, 0xe1, 0x69, 0x4e, 0x86, 0x74, 0xc0, 0xaa,
+            0xf7, 0xe7, 0xea, 0x46, 0x67, 0xf8, 0xea, 0x4f, 0x1f, 0x59, 0x75, 0xd4, 0x6f, 0x01, 0x30, 0xf1, 0x7a, 0x72,
+            0x1e, 0x38, 0x72, 0x47, 0xdc, 0x2f, 0x1b, 0x1f, 0xea, 0x5e, 0xd0, 0x8d, 0x0d, 0x8a, 0x1c, 0x22, 0x67, 0xd9,
+            0xf9, 0x3f, 0xb8, 0xf0, 0xe8, 0xbe, 0x5a, 0x58, 0x06, 0x19, 0x85, 0x7a,
+
+            0x06, 0x01, 0x05
+        };
+        CheckPairSetupMessage(bytes, sizeof bytes, kHAPError_None, /* isCanonical: */ true);
+    }
+
+    // HomeKit Pair Setup M6.
+    {
+        const uint8_t bytes[] = { 0x06, 0x01, 0x06,
+
+                                  0x05, 0x87, 0x8b, 0xc8, 0x42, 0xd6, 0xb8, 0x60, 0xac, 0x76, 0x36, 0xe8, 0xb0, 0xe5,
+                                  0xc7, 0x7a, 0x5b, 0x56, 0x23, 0xc4, 0xd4, 0x83, 0x2f, 0xdb, 0x16, 0x24, 0x50, 0x27,
+                                  0x7f, 0xd5, 0xdd, 0xd5, 0x11, 0x9d, 0x5f, 0x95, 0xba, 0xd7, 0xe0, 0xdd, 0x46, 0x52,
+                                  0xa8, 0xaf, 0xd1, 0xc0, 0xe7, 0x41, 0x2e, 0x5c, 0x54, 0x63, 0x59, 0x55, 0x24, 0x2c,
+                                  0xa1, 0x3e, 0xfb, 0xd7, 0xa7, 0xd1, 0x8d, 0xdc, 0x03, 0x1d, 0x14, 0x3c, 0x2f, 0x3b,
+                                  0x7d, 0x4d, 0x29, 0xf1, 0x33, 0xe8, 0x68, 0x79, 0x62, 0x52, 0xd6, 0x16, 0x5c, 0x7f,
+                                  0x57, 0xb2, 0xda, 0xbe, 0xe4, 0xb8, 0xfc, 0xb6, 0xf8, 0x3d, 0x3b, 0xa4, 0xb0, 0x19,
+                                  0x3e, 0xf9, 0x25, 0x2d, 0xe1, 0x2c, 0xab, 0x93, 0x10, 0xfc, 0x08, 0x7e, 0x59, 0x3b,
+                                  0x7a, 0x70, 0x83, 0x4c, 0xf8, 0x46, 0xab, 0x87, 0x83, 0xa1, 0x67, 0x29, 0xe7, 0x05,
+                                  0x5b, 0x8f, 0x73, 0x1c, 0x57, 0x2f, 0xea, 0xec, 0x33, 0xbe, 0xd5 };
+        CheckPairSetupMessage(bytes, sizeof bytes, kHAPError_None, /* isCanonical: */ false);
+    }
+
+    // Identifier, error, flags and unknown TLV items.
+    {
+        const uint8_t bytes[] = { 0x01, 0x04, 'a',  'b',  'c',  'd',  0x06, 0x01, 0x04, 0x07, 0x01,
+                                  0x02, 0x13, 0x04, 0x78, 0x56, 0x34, 0x12, 0x42, 0x01, 0x00 };
+        CheckPairSetupMessage(bytes, sizeof bytes, kHAPError_None, /* isCanonical: */ false);
+    }
+
+    // Integers shorter than their type.
+    {
+        const uint8_t bytes[] = { 0x06, 0x01, 0x03, 0x13, 0x02, 0x34, 0x12 };
+        CheckPairSetupMessage(bytes, sizeof bytes, kHAPError_None, /* isCanonical: */ false);
+    }
+    {
+        const uint8_t bytes[] = { 0x00, 0x00, 0x06, 0x01, 0x03 };
+        CheckPairSetupMessage(bytes, sizeof bytes, kHAPError_None, /* isCanonical: */ false);
+    }
+
+    // Missing state.
+    {
+        const uint8_t bytes[] = { 0x00, 0x01, 0x00 };
+        CheckPairSetupMessage(bytes, sizeof bytes, kHAPError_InvalidData, /* isCanonical: */ false);
+    }
+
+    // Duplicate state.
+    {
+        const uint8_t bytes[] = { 0x06, 0x01, 0x01, 0x06, 0x01, 0x01 };
+        CheckPairSetupMessage(bytes, sizeof bytes, kHAPError_InvalidData, /* isCanonical: */ false);
+    }
+
+    // State out of range.
+    {
+        const uint8_t bytes[] = { 0x06, 0x01, 0x07 };
+        CheckPairSetupMessage(bytes, sizeof bytes, kHAPError_InvalidData, /* isCanonical: */ false);
+    }
+
+    // Integer too long.
+    {
+        const uint8_t bytes[] = { 0x06, 0x01, 0x01, 0x13, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00 };
+        CheckPairSetupMessage(bytes, sizeof bytes, kHAPError_InvalidData, /* isCanonical: */ false);
+    }
+
+    // Invalid enumeration value and length.
+    {
+        const uint8_t bytes[] = { 0x06, 0x01, 0x02, 0x07, 0x01, 0x08 };
+        CheckPairSetupMessage(bytes, sizeof bytes, kHAPError_InvalidData, /* isCanonical: */ false);
+    }
+    {
+        const uint8_t bytes[] = { 0x06, 0x01, 0x02, 0x07, 0x02, 0x01, 0x00 };
+        CheckPairSetupMessage(bytes, sizeof bytes, kHAPError_InvalidData, /* isCanonical: */ false);
+    }
+
+    // Data length out of range.
+    {
+        const uint8_t bytes[] = { 0x06, 0x01, 0x02, 0x02, 0x01, 0x00 };
+        CheckPairSetupMessage(bytes, sizeof bytes, kHAPError_InvalidData, /* isCanonical: */ false);
+    }
+
+    // Invalid strings.
+    {
+        const uint8_t bytes[] = { 0x06, 0x01, 0x01, 0x01, 0x03, 'a', 0x00, 'b' };
+        CheckPairSetupMessage(bytes, sizeof bytes, kHAPError_InvalidData, /* isCanonical: */ false);
+    }
+    {
+        const uint8_t bytes[] = { 0x06, 0x01, 0x01, 0x01, 0x02, 0xC3, 0x28 };
+        CheckPairSetupMessage(bytes, sizeof bytes, kHAPError_InvalidData, /* isCanonical: */ false);
+    }
+    {
+        const uint8_t bytes[] = { 0x06, 0x01, 0x01, 0x01, 0x00 };
+        CheckPairSetupMessage(bytes, sizeof bytes, kHAPError_InvalidData, /* isCanonical: */ false);
+    }
+
+    // Struct validation callback.
+    {
+        const uint8_t bytes[] = { 0x06, 0x01, 0x03, 0x02, 0x10, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05,
+                                  0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f };
+        CheckPairSetupMessage(bytes, sizeof bytes, kHAPError_InvalidData, /* isCanonical: */ false);
+    }
+
+    // Sequences.
+    CheckListPairingsResponse();
+
+    return 0;
+}
@@ -0,0 +1,222 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+// Decodes the same TLV structures with and without scratch memory to check that indexed lookups of struct members
+// produce the same results as scanning the buffer for every member.
+
+#include "HAP+Internal.h"
+
+typedef struct {
+    uint16_t number;
+    HAPDataTLVValue data;
+} NestedValue;
+
+typedef struct {
+    uint8_t number;
+    HAPDataTLVValue data;
+    char* name;
+    bool nameIsSet;
+    NestedValue nested;
+} TestValue;
+
+static const HAPUInt8TLVFormat kUInt8Format = { .type = kHAPTLVFormatType_UInt8,
+                                                .constraints = { .minimumValue = 0, .maximumValue = UINT8_MAX } };
+static const HAPUInt16TLVFormat kUInt16Format = { .type = kHAPTLVFormatType_UInt16,
+                                                  .constraints = { .minimumValue = 0, .maximumValue = UINT16_MAX } };
+static const HAPDataTLVFormat kDataFormat = { .type = kHAPTLVFormatType_Data,
+                                              .constraints = { .minLength = 0, .maxLength = SIZE_MAX } };
+static const HAPStringTLVFormat kStringFormat = { .type = kHAPTLVFormatType_String,
+                                                  .constraints = { .minLength = 0, .maxLength = SIZE_MAX } };
+
+static const HAPStructTLVMember kNestedNumberMember = { .valueOffset = HAP_OFFSETOF(NestedValue, number),
+                                                        .tlvType = 0x01,
+                                                        .debugDescription = "Number",
+                                                        .format = &kUInt16Format };
+static const HAPStructTLVMember kNestedDataMember = { .valueOffset = HAP_OFFSETOF(NestedValue, data),
+                                                      .tlvType = 0x02,
+                                                      .debugDescription = "Data",
+                                                      .format = &kDataFormat };
+static const HAPStructTLVFormat kNestedFormat = {
+    .type = kHAPTLVFormatType_Struct,
+    .members = (const HAPStructTLVMember* const[]) { &kNestedNumberMember, &kNestedDataMember, NULL }
+};
+
+static const HAPStructTLVMember kNumberMember = { .valueOffset = HAP_OFFSETOF(TestValue, number),
+                                                  .tlvType = 0x01,
+                                                  .debugDescription = "Number",
+                                                  .format = &kUInt8Format };
+static const HAPStructTLVMember kDataMember = { .valueOffset = HAP_OFFSETOF(TestValue, data),
+                                                .tlvType = 0x02,
+                                                .debugDescription = "Data",
+                                                .format = &kDataFormat };
+static const HAPStructTLVMember kNameMember = { .valueOffset = HAP_OFFSETOF(TestValue, name),
+                                                .isSetOffset = HAP_OFFSETOF(TestValue, nameIsSet),
+                                                .tlvType = 0x03,
+                                                .debugDescription = "Name",
+                                                .format = &kStringFormat,
+                                                .isOptional = true };
+static const HAPStructTLVMember kNestedMember = { .valueOffset = HAP_OFFSETOF(TestValue, nested),
+                                                  .tlvType = 0x04,
+                                                  .debugDescription = "Nested",
+                                                  .format = &kNestedFormat };
+static const HAPStructTLVFormat kTestFormat = {
+    .type = kHAPTLVFormatType_Struct,
+    .members = (const HAPStructTLVMember* const[]) { &kNumberMember, &kDataMember, &kNameMember, &kNestedMember, NULL }
+};
+
+/**
+ * Decodes a TLV structure.
+ *
+ * @param      tlvBytes             Encoded TLV structure.
+ * @param      numTLVBytes          Length of encoded TLV structure.
+ * @param      numScratchBytes      Amount of scratch memory to provide to the reader.
+ * @param[out] bytes                Buffer to decode in. Decoded values point into this buffer.
+ * @param      maxBytes             Capacity of buffer.
+ * @param[out] value                Decoded value.
+ *
+ * @return Result of decoding.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError Decode(
+        const void* tlvBytes,
+        size_t numTLVBytes,
+        size_t numScratchBytes,
+        uint8_t* bytes,
+        size_t maxBytes,
+        TestValue* value) {
+    HAPPrecondition(tlvBytes);
+    HAPPrecondition(bytes);
+    HAPPrecondition(numTLVBytes + numScratchBytes <= maxBytes);
+    HAPPrecondition(value);
+
+    HAPRawBufferCopyBytes(bytes, tlvBytes, numTLVBytes);
+    HAPRawBufferZero(value, sizeof *value);
+
+    HAPTLVReaderRef reader;
+    HAPTLVReaderCreateWithOptions(
+            &reader,
+            &(const HAPTLVReaderOptions) {
+                    .bytes = bytes, .numBytes = numTLVBytes, .maxBytes = numTLVBytes + numScratchBytes });
+    return HAPTLVReaderDecodeVoid(&reader, &kTestFormat, value);
+}
+
+static void CheckDataEqual(
+        const HAPDataTLVValue* value,
+        const uint8_t* bytes,
+        const HAPDataTLVValue* otherValue,
+        const uint8_t* otherBytes) {
+    HAPPrecondition(value);
+    HAPPrecondition(bytes);
+    HAPPrecondition(otherValue);
+    HAPPrecondition(otherBytes);
+
+    HAPAssert(value->numBytes == otherValue->numBytes);
+    HAPAssert((const uint8_t*) value->bytes - bytes == (const uint8_t*) otherValue->bytes - otherBytes);
+    HAPAssert(HAPRawBufferAreEqual(value->bytes, otherValue->bytes, value->numBytes));
+}
+
+/**
+ * Checks that decoding with and without scratch memory produces the same result.
+ */
+static void Check(const void* tlvBytes, size_t numTLVBytes, HAPError expectedErr) {
+    HAPPrecondition(tlvBytes);
+
+    HAPError err;
+
+    static uint8_t bytes[1024];
+    static uint8_t indexedBytes[1024];
+    TestValue value;
+    TestValue indexedValue;
+
+    err = Decode(tlvBytes, numTLVBytes, /* numScratchBytes: */ 0, bytes, sizeof bytes, &value);
+    HAPAssert(err == expectedErr);
+    err = Decode(
+            tlvBytes, numTLVBytes, sizeof indexedBytes - numTLVBytes, indexedBytes, sizeof indexedBytes, &indexedValue);
+    HAPAssert(err == expectedErr);
+    if (err) {
+        return;
+    }
+
+    HAPAssert(value.number == indexedValue.number);
+    CheckDataEqual(&value.data, bytes, &indexedValue.data, indexedBytes);
+    HAPAssert(value.nameIsSet == indexedValue.nameIsSet);
+    if (value.nameIsSet) {
+        HAPAssert((uint8_t*) value.name - bytes == (uint8_t*) indexedValue.name - indexedBytes);
+        HAPAssert(HAPStringAreEqual(HAPNonnull(value.name), HAPNonnull(indexedValue.name)));
+    }
+    HAPAssert(value.nested.number == indexedValue.nested.number);
+    CheckDataEqual(&value.nested.data, bytes, &indexedValue.nested.data, indexedBytes);
+
+    // Both buffers must have been processed identically.
+    HAPAssert(HAPRawBufferAreEqual(bytes, indexedBytes, numTLVBytes));
+}
+
+int main() {
+    uint8_t tlvBytes[600];
+    size_t numTLVBytes;
+
+    // Members in order.
+    {
+        static const uint8_t bytes[] = { 0x01, 0x01, 0x2A, 0x02, 0x03, 0xAA, 0xBB, 0xCC, 0x03, 0x02, 'h',  'i',
+                                         0x04, 0x07, 0x01, 0x02, 0x34, 0x12, 0x02, 0x01, 0xDD };
+        Check(bytes, sizeof bytes, kHAPError_None);
+    }
+
+    // Members in reverse order, interleaved with unknown TLV items, without optional member.
+    {
+        static const uint8_t bytes[] = { 0x09, 0x00, 0x04, 0x08, 0x02, 0x00, 0x09, 0x00, 0x01, 0x02, 0x07, 0x00,
+                                         0x02, 0x01, 0xFF, 0x09, 0x01, 0x00, 0x01, 0x01, 0x2A, 0x09, 0x00 };
+        Check(bytes, sizeof bytes, kHAPError_None);
+    }
+
+    // Fragmented data member followed by a nested struct.
+    {
+        numTLVBytes = 0;
+        tlvBytes[numTLVBytes++] = 0x02;
+        tlvBytes[numTLVBytes++] = 0xFF;
+        for (size_t i = 0; i < 0xFF; i++) {
+            tlvBytes[numTLVBytes++] = (uint8_t) i;
+        }
+        tlvBytes[numTLVBytes++] = 0x02;
+        tlvBytes[numTLVBytes++] = 0x10;
+        for (size_t i = 0; i < 0x10; i++) {
+            tlvBytes[numTLVBytes++] = (uint8_t) ~i;
+        }
+        static const uint8_t tail[] = { 0x04, 0x07, 0x01, 0x02, 0x00, 0x01, 0x02, 0x01, 0x05, 0x01, 0x01, 0x07 };
+        HAPRawBufferCopyBytes(&tlvBytes[numTLVBytes], tail, sizeof tail);
+        numTLVBytes += sizeof tail;
+        Check(tlvBytes, numTLVBytes, kHAPError_None);
+    }
+
+    // Duplicate members.
+    {
+        static const uint8_t bytes[] = { 0x01, 0x01, 0x2A, 0x02, 0x00, 0x04, 0x00, 0x01, 0x01, 0x2B };
+        Check(bytes, sizeof bytes, kHAPError_InvalidData);
+    }
+    {
+        static const uint8_t bytes[] = { 0x01, 0x01, 0x2A, 0x02, 0x00, 0x04, 0x00, 0x03, 0x00, 0x03, 0x00 };
+        Check(bytes, sizeof bytes, kHAPError_InvalidData);
+    }
+    {
+        static const uint8_t bytes[] = { 0x01, 0x01, 0x2A, 0x02, 0x00, 0x04, 0x06, 0x01,
+                                         0x00, 0x02, 0x00, 0x02, 0x00, 0x09, 0x00 };
+        Check(bytes, sizeof bytes, kHAPError_InvalidData);
+    }
+
+    // Missing member.
+    {
+        static const uint8_t bytes[] = { 0x01, 0x01, 0x2A, 0x04, 0x00 };
+        Check(bytes, sizeof bytes, kHAPError_InvalidData);
+    }
+
+    // Invalid member value.
+    {
+        static const uint8_t bytes[] = { 0x01, 0x02, 0x2A, 0x00, 0x02, 0x00, 0x04, 0x00 };
+        Check(bytes, sizeof bytes, kHAPError_InvalidData);
+    }
+
+    return 0;
+}
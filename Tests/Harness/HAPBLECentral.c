@@ -0,0 +1,877 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAP+Internal.h"
+#include "HAPBLECentral.h"
+#include "HAPPlatformBLEPeripheralManager+Test.h"
+
+static const HAPLogObject bleCentralLogObject = { .subsystem = "com.apple.mfi.HomeKit.Core.Test",
+                                                  .category = "BLECentral" };
+
+/**
+ * Characteristic Instance ID descriptor type.
+ */
+static const HAPPlatformBLEPeripheralManagerUUID kBLECentralDescriptorUUID_CharacteristicInstanceID = {
+    { 0x9A, 0x93, 0x96, 0xD7, 0xBD, 0x6A, 0xD9, 0xB5, 0x16, 0x46, 0xD2, 0x81, 0xFE, 0xF0, 0x46, 0xDC }
+};
+
+void HAPBLECentralCreate(HAPBLECentral* central, const HAPBLECentralOptions* options) {
+    HAPPrecondition(central);
+    HAPPrecondition(options);
+    HAPPrecondition(options->blePeripheralManager);
+    HAPPrecondition(options->pairingIdentifier);
+    HAPPrecondition(options->pairingIdentifier->numBytes <= sizeof options->pairingIdentifier->bytes);
+    HAPPrecondition(options->longTermSecretKey);
+    HAPPrecondition(options->accessoryLongTermPublicKey);
+
+    HAPRawBufferZero(central, sizeof *central);
+    central->blePeripheralManager = options->blePeripheralManager;
+    central->pairingIdentifier = *options->pairingIdentifier;
+    HAPRawBufferCopyBytes(central->ltsk, options->longTermSecretKey, sizeof central->ltsk);
+    HAP_ed25519_public_key(central->ltpk, central->ltsk);
+    HAPRawBufferCopyBytes(central->accessoryLTPK, options->accessoryLongTermPublicKey, sizeof central->accessoryLTPK);
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPBLECentralConnect(HAPBLECentral* central, uint16_t mtu) {
+    HAPPrecondition(central);
+    HAPPrecondition(mtu >= kHAPPlatformBLEPeripheralManager_DefaultMTU);
+
+    HAPError err;
+
+    HAPPlatformBLEPeripheralManagerConnectionHandle connectionHandle;
+    err = HAPPlatformBLEPeripheralManagerConnectCentral(central->blePeripheralManager, &connectionHandle);
+    if (err) {
+        HAPAssert(err == kHAPError_InvalidState);
+        return err;
+    }
+    central->mtu = mtu;
+    if (mtu != kHAPPlatformBLEPeripheralManager_DefaultMTU) {
+        HAPPlatformBLEPeripheralManagerCentralExchangeMTU(central->blePeripheralManager, mtu);
+    }
+    HAPRawBufferZero(&central->session, sizeof central->session);
+    return kHAPError_None;
+}
+
+void HAPBLECentralDisconnect(HAPBLECentral* central) {
+    HAPPrecondition(central);
+
+    if (HAPPlatformBLEPeripheralManagerIsCentralConnected(central->blePeripheralManager)) {
+        HAPPlatformBLEPeripheralManagerDisconnectCentral(central->blePeripheralManager);
+    }
+    HAPRawBufferZero(&central->session, sizeof central->session);
+}
+
+/**
+ * Writes a GATT value and accounts for the ATT round trips that are needed to transfer it.
+ *
+ * - Values up to ATT_MTU - 3 bytes are sent with a "Write Request". Longer values are sent with
+ *   "Prepare Write Requests" of up to ATT_MTU - 5 bytes each, followed by an "Execute Write Request".
+ *
+ * @param      central              Simulated central.
+ * @param      attributeHandle      Attribute handle to write.
+ * @param      bytes                Value.
+ * @param      numBytes             Length of value.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If the write was rejected.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError WriteGATTValue(
+        HAPBLECentral* central,
+        HAPPlatformBLEPeripheralManagerAttributeHandle attributeHandle,
+        const void* bytes,
+        size_t numBytes) {
+    HAPPrecondition(central);
+    HAPPrecondition(bytes);
+
+    HAPError err;
+
+    err = HAPPlatformBLEPeripheralManagerCentralWriteAttribute(
+            central->blePeripheralManager, attributeHandle, bytes, numBytes);
+    if (err) {
+        HAPLog(&bleCentralLogObject, "GATT write to 0x%04x rejected: %u.", attributeHandle, err);
+        return kHAPError_InvalidState;
+    }
+
+    central->statistics.numGATTWrites++;
+    central->statistics.numRequestBytes += numBytes;
+    if (numBytes <= (size_t)(central->mtu - 3)) {
+        central->statistics.numRoundTrips++;
+    } else {
+        size_t numPrepareBytes = (size_t)(central->mtu - 5);
+        central->statistics.numRoundTrips += (numBytes + numPrepareBytes - 1) / numPrepareBytes + 1;
+    }
+    return kHAPError_None;
+}
+
+/**
+ * Reads a GATT value and accounts for the ATT round trips that are needed to transfer it.
+ *
+ * - A value is read with a "Read Request" followed by "Read Blob Requests" until a response is shorter than
+ *   ATT_MTU - 1 bytes.
+ *
+ * @param      central              Simulated central.
+ * @param      attributeHandle      Attribute handle to read.
+ * @param[out] bytes                Buffer to fill value into.
+ * @param      maxBytes             Capacity of buffer.
+ * @param[out] numBytes             Length of value.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If the read was rejected.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError ReadGATTValue(
+        HAPBLECentral* central,
+        HAPPlatformBLEPeripheralManagerAttributeHandle attributeHandle,
+        void* bytes,
+        size_t maxBytes,
+        size_t* numBytes) {
+    HAPPrecondition(central);
+    HAPPrecondition(bytes);
+    HAPPrecondition(numBytes);
+
+    HAPError err;
+
+    err = HAPPlatformBLEPeripheralManagerCentralReadAttribute(
+            central->blePeripheralManager, attributeHandle, bytes, maxBytes, numBytes);
+    if (err) {
+        HAPLog(&bleCentralLogObject, "GATT read from 0x%04x rejected: %u.", attributeHandle, err);
+        return kHAPError_InvalidState;
+    }
+
+    central->statistics.numGATTReads++;
+    central->statistics.numResponseBytes += *numBytes;
+    size_t numRoundTrips = *numBytes / (size_t)(central->mtu - 1) + 1;
+    central->statistics.numRoundTrips += numRoundTrips;
+    central->statistics.numReadRoundTrips += numRoundTrips;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPBLECentralDiscoverCharacteristic(
+        HAPBLECentral* central,
+        const HAPUUID* serviceType,
+        const HAPUUID* characteristicType,
+        HAPBLECentralCharacteristic* characteristic) {
+    HAPPrecondition(central);
+    HAPPrecondition(serviceType);
+    HAPPrecondition(characteristicType);
+    HAPPrecondition(characteristic);
+
+    HAPError err;
+
+    HAPRawBufferZero(characteristic, sizeof *characteristic);
+
+    HAPAssert(sizeof *serviceType == sizeof(HAPPlatformBLEPeripheralManagerUUID));
+    HAPAssert(sizeof *characteristicType == sizeof(HAPPlatformBLEPeripheralManagerUUID));
+    err = HAPPlatformBLEPeripheralManagerFindCharacteristic(
+            central->blePeripheralManager,
+            (const HAPPlatformBLEPeripheralManagerUUID*) serviceType,
+            (const HAPPlatformBLEPeripheralManagerUUID*) characteristicType,
+            &characteristic->valueHandle,
+            &characteristic->cccDescriptorHandle);
+    if (err) {
+        HAPAssert(err == kHAPError_InvalidState);
+        return err;
+    }
+
+    // The Characteristic Instance ID descriptor is always readable in the clear.
+    HAPPlatformBLEPeripheralManagerAttributeHandle iidHandle;
+    err = HAPPlatformBLEPeripheralManagerFindDescriptor(
+            central->blePeripheralManager,
+            characteristic->valueHandle,
+            &kBLECentralDescriptorUUID_CharacteristicInstanceID,
+            &iidHandle);
+    if (err) {
+        HAPAssert(err == kHAPError_InvalidState);
+        return err;
+    }
+    uint8_t iidBytes[sizeof(uint16_t)];
+    size_t numIIDBytes;
+    err = ReadGATTValue(central, iidHandle, iidBytes, sizeof iidBytes, &numIIDBytes);
+    if (err) {
+        return err;
+    }
+    if (numIIDBytes != sizeof iidBytes) {
+        HAPLog(&bleCentralLogObject, "Characteristic Instance ID descriptor has invalid length (%zu).", numIIDBytes);
+        return kHAPError_InvalidState;
+    }
+    characteristic->iid = HAPReadLittleUInt16(iidBytes);
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPBLECentralPerformTransaction(
+        HAPBLECentral* central,
+        const HAPBLECentralCharacteristic* characteristic,
+        HAPPDUOpcode opcode,
+        const void* _Nullable requestBodyBytes,
+        size_t numRequestBodyBytes,
+        HAPBLEPDUStatus* status,
+        void* _Nullable responseBodyBytes,
+        size_t maxResponseBodyBytes,
+        size_t* numResponseBodyBytes) {
+    HAPPrecondition(central);
+    HAPPrecondition(characteristic);
+    HAPPrecondition(characteristic->valueHandle);
+    HAPPrecondition(!numRequestBodyBytes || requestBodyBytes);
+    HAPPrecondition(numRequestBodyBytes <= UINT16_MAX);
+    HAPPrecondition(status);
+    HAPPrecondition(!maxResponseBodyBytes || responseBodyBytes);
+    HAPPrecondition(numResponseBodyBytes);
+
+    HAPError err;
+
+    // The security state at the start of a procedure applies to all of its fragments.
+    bool isSecured = central->session.isSecured;
+    size_t numTagBytes = isSecured ? CHACHA20_POLY1305_TAG_BYTES : 0;
+    uint8_t tid = central->tid++;
+
+    uint8_t bytes[kHAPPlatformBLEPeripheralManager_MaxAttributeBytes];
+    size_t numBytes;
+
+    // Write request fragments.
+    size_t numSentBodyBytes = 0;
+    do {
+        HAPBLEPDU pdu;
+        HAPRawBufferZero(&pdu, sizeof pdu);
+        size_t maxBodyBytes = sizeof bytes - numTagBytes;
+        if (!numSentBodyBytes) {
+            pdu.controlField.fragmentationStatus = kHAPBLEPDUFragmentationStatus_FirstFragment;
+            pdu.controlField.type = kHAPBLEPDUType_Request;
+            pdu.controlField.length = kHAPBLEPDUControlFieldLength_1Byte;
+            pdu.fixedParams.request.opcode = opcode;
+            pdu.fixedParams.request.tid = tid;
+            pdu.fixedParams.request.iid = characteristic->iid;
+            maxBodyBytes -= kHAPBLEPDU_NumRequestHeaderBytes + kHAPBLEPDU_NumBodyHeaderBytes;
+        } else {
+            pdu.controlField.fragmentationStatus = kHAPBLEPDUFragmentationStatus_Continuation;
+            pdu.controlField.type = kHAPBLEPDUType_Request;
+            pdu.controlField.length = kHAPBLEPDUControlFieldLength_1Byte;
+            pdu.fixedParams.continuation.tid = tid;
+            maxBodyBytes -= kHAPBLEPDU_NumContinuationHeaderBytes;
+        }
+        if (requestBodyBytes) {
+            size_t numFragmentBytes = numRequestBodyBytes - numSentBodyBytes;
+            if (numFragmentBytes > maxBodyBytes) {
+                numFragmentBytes = maxBodyBytes;
+            }
+            pdu.body.totalBodyBytes = (uint16_t) numRequestBodyBytes;
+            pdu.body.bytes = &((const uint8_t*) requestBodyBytes)[numSentBodyBytes];
+            pdu.body.numBytes = (uint16_t) numFragmentBytes;
+            numSentBodyBytes += numFragmentBytes;
+        }
+        err = HAPBLEPDUSerialize(&pdu, bytes, sizeof bytes - numTagBytes, &numBytes);
+        HAPAssert(!err);
+
+        if (isSecured) {
+            uint8_t nonce[] = { HAPExpandLittleUInt64(central->session.controllerToAccessoryNonce) };
+            HAP_chacha20_poly1305_encrypt(
+                    &bytes[numBytes],
+                    bytes,
+                    bytes,
+                    numBytes,
+                    nonce,
+                    sizeof nonce,
+                    central->session.controllerToAccessoryKey);
+            central->session.controllerToAccessoryNonce++;
+            numBytes += CHACHA20_POLY1305_TAG_BYTES;
+        }
+        err = WriteGATTValue(central, characteristic->valueHandle, bytes, numBytes);
+        if (err) {
+            return err;
+        }
+    } while (numSentBodyBytes < numRequestBodyBytes);
+
+    // Read response fragments.
+    *numResponseBodyBytes = 0;
+    size_t totalBodyBytes = 0;
+    bool isFirstFragment = true;
+    do {
+        err = ReadGATTValue(central, characteristic->valueHandle, bytes, sizeof bytes, &numBytes);
+        if (err) {
+            return err;
+        }
+
+        if (isSecured) {
+            if (numBytes < CHACHA20_POLY1305_TAG_BYTES) {
+                HAPLog(&bleCentralLogObject, "Encrypted response fragment too short (%zu bytes).", numBytes);
+                return kHAPError_InvalidData;
+            }
+            numBytes -= CHACHA20_POLY1305_TAG_BYTES;
+            uint8_t nonce[] = { HAPExpandLittleUInt64(central->session.accessoryToControllerNonce) };
+            int e = HAP_chacha20_poly1305_decrypt(
+                    &bytes[numBytes],
+                    bytes,
+                    bytes,
+                    numBytes,
+                    nonce,
+                    sizeof nonce,
+                    central->session.accessoryToControllerKey);
+            if (e) {
+                HAPLog(&bleCentralLogObject, "Decryption of response fragment failed.");
+                return kHAPError_InvalidData;
+            }
+            central->session.accessoryToControllerNonce++;
+        }
+
+        HAPBLEPDU pdu;
+        if (isFirstFragment) {
+            err = HAPBLEPDUDeserialize(&pdu, bytes, numBytes);
+            if (err) {
+                HAPAssert(err == kHAPError_InvalidData);
+                return err;
+            }
+            if (pdu.controlField.type != kHAPBLEPDUType_Response || pdu.fixedParams.response.tid != tid) {
+                HAPLog(&bleCentralLogObject, "Unexpected response PDU.");
+                return kHAPError_InvalidData;
+            }
+            *status = pdu.fixedParams.response.status;
+            totalBodyBytes = pdu.body.totalBodyBytes;
+            isFirstFragment = false;
+        } else {
+            err = HAPBLEPDUDeserializeContinuation(
+                    &pdu,
+                    bytes,
+                    numBytes,
+                    kHAPBLEPDUType_Response,
+                    totalBodyBytes,
+                    *numResponseBodyBytes);
+            if (err) {
+                HAPAssert(err == kHAPError_InvalidData);
+                return err;
+            }
+            if (pdu.fixedParams.continuation.tid != tid) {
+                HAPLog(&bleCentralLogObject, "Unexpected continuation PDU.");
+                return kHAPError_InvalidData;
+            }
+        }
+        if (pdu.body.numBytes) {
+            if (maxResponseBodyBytes - *numResponseBodyBytes < pdu.body.numBytes) {
+                HAPLog(&bleCentralLogObject, "Not enough space to store response body (%zu bytes).", totalBodyBytes);
+                return kHAPError_OutOfResources;
+            }
+            HAPRawBufferCopyBytes(
+                    &((uint8_t*) HAPNonnullVoid(responseBodyBytes))[*numResponseBodyBytes],
+                    HAPNonnullVoid(pdu.body.bytes),
+                    pdu.body.numBytes);
+            *numResponseBodyBytes += pdu.body.numBytes;
+        }
+    } while (*numResponseBodyBytes < totalBodyBytes);
+
+    central->statistics.numTransactions++;
+    return kHAPError_None;
+}
+
+/**
+ * Performs a HAP Characteristic Write-with-Response Procedure.
+ *
+ * @param      central              Simulated central.
+ * @param      characteristic       Characteristic to write.
+ * @param      bytes                Characteristic value.
+ * @param      numBytes             Length of characteristic value.
+ * @param[out] responseBytes        Buffer to fill the response value into.
+ * @param      maxResponseBytes     Capacity of buffer.
+ * @param[out] numResponseBytes     Length of response value.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If the request was rejected.
+ * @return kHAPError_InvalidData    If the response is malformed.
+ * @return kHAPError_OutOfResources If a buffer is not large enough.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError WriteCharacteristicWithResponse(
+        HAPBLECentral* central,
+        const HAPBLECentralCharacteristic* characteristic,
+        const void* bytes,
+        size_t numBytes,
+        void* responseBytes,
+        size_t maxResponseBytes,
+        size_t* numResponseBytes) {
+    HAPPrecondition(central);
+    HAPPrecondition(characteristic);
+    HAPPrecondition(bytes);
+    HAPPrecondition(responseBytes);
+    HAPPrecondition(numResponseBytes);
+
+    HAPError err;
+
+    static uint8_t bodyBytes[UINT16_MAX];
+    HAPTLVWriterRef writer;
+    HAPTLVWriterCreate(&writer, bodyBytes, sizeof bodyBytes);
+    err = HAPTLVWriterAppend(
+            &writer,
+            &(const HAPTLV) { .type = kHAPBLEPDUTLVType_Value, .value = { .bytes = bytes, .numBytes = numBytes } });
+    if (err) {
+        HAPAssert(err == kHAPError_OutOfResources);
+        return err;
+    }
+    const uint8_t returnResponse = 1;
+    err = HAPTLVWriterAppend(
+            &writer,
+            &(const HAPTLV) { .type = kHAPBLEPDUTLVType_ReturnResponse,
+                              .value = { .bytes = &returnResponse, .numBytes = sizeof returnResponse } });
+    if (err) {
+        HAPAssert(err == kHAPError_OutOfResources);
+        return err;
+    }
+    void* requestBodyBytes;
+    size_t numRequestBodyBytes;
+    HAPTLVWriterGetBuffer(&writer, &requestBodyBytes, &numRequestBodyBytes);
+
+    HAPBLEPDUStatus status;
+    size_t numResponseBodyBytes;
+    err = HAPBLECentralPerformTransaction(
+            central,
+            characteristic,
+            kHAPPDUOpcode_CharacteristicWrite,
+            requestBodyBytes,
+            numRequestBodyBytes,
+            &status,
+            bodyBytes,
+            sizeof bodyBytes,
+            &numResponseBodyBytes);
+    if (err) {
+        return err;
+    }
+    if (status != kHAPBLEPDUStatus_Success) {
+        HAPLog(&bleCentralLogObject, "Write-with-Response rejected with status 0x%02x.", status);
+        return kHAPError_InvalidState;
+    }
+
+    HAPTLVReaderRef reader;
+    HAPTLVReaderCreate(&reader, bodyBytes, numResponseBodyBytes);
+    HAPTLV valueTLV;
+    valueTLV.type = kHAPBLEPDUTLVType_Value;
+    err = HAPTLVReaderGetAll(&reader, (HAPTLV* const[]) { &valueTLV, NULL });
+    if (err) {
+        HAPAssert(err == kHAPError_InvalidData);
+        return err;
+    }
+    if (!valueTLV.value.bytes) {
+        HAPLog(&bleCentralLogObject, "Write-with-Response response does not contain a value.");
+        return kHAPError_InvalidData;
+    }
+    if (valueTLV.value.numBytes > maxResponseBytes) {
+        HAPLog(&bleCentralLogObject, "Not enough space to store response value (%zu bytes).", valueTLV.value.numBytes);
+        return kHAPError_OutOfResources;
+    }
+    HAPRawBufferCopyBytes(responseBytes, valueTLV.value.bytes, valueTLV.value.numBytes);
+    *numResponseBytes = valueTLV.value.numBytes;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPBLECentralPairVerify(HAPBLECentral* central) {
+    HAPPrecondition(central);
+
+    HAPError err;
+
+    // See HomeKit Accessory Protocol Specification R14
+    // Section 5.7 Pair Verify
+    HAPBLECentralCharacteristic pairVerify;
+    err = HAPBLECentralDiscoverCharacteristic(
+            central, &kHAPServiceType_Pairing, &kHAPCharacteristicType_PairVerify, &pairVerify);
+    if (err) {
+        return err;
+    }
+
+    // Pair Verify always starts over an unsecured session.
+    HAPRawBufferZero(&central->session, sizeof central->session);
+
+    // M1: Verify Start Request.
+    uint8_t cv_SK[X25519_SCALAR_BYTES];
+    uint8_t cv_PK[X25519_BYTES];
+    HAPPlatformRandomNumberFill(cv_SK, sizeof cv_SK);
+    HAP_X25519_scalarmult_base(cv_PK, cv_SK);
+
+    uint8_t bytes[1024];
+    size_t numBytes;
+    {
+        uint8_t requestBytes[64];
+        HAPTLVWriterRef writer;
+        HAPTLVWriterCreate(&writer, requestBytes, sizeof requestBytes);
+        const uint8_t state = 1;
+        err = HAPTLVWriterAppend(
+                &writer,
+                &(const HAPTLV) { .type = kHAPPairingTLVType_State,
+                                  .value = { .bytes = &state, .numBytes = sizeof state } });
+        HAPAssert(!err);
+        err = HAPTLVWriterAppend(
+                &writer,
+                &(const HAPTLV) { .type = kHAPPairingTLVType_PublicKey,
+                                  .value = { .bytes = cv_PK, .numBytes = sizeof cv_PK } });
+        HAPAssert(!err);
+        void* tlvBytes;
+        size_t numTLVBytes;
+        HAPTLVWriterGetBuffer(&writer, &tlvBytes, &numTLVBytes);
+
+        err = WriteCharacteristicWithResponse(
+                central, &pairVerify, tlvBytes, numTLVBytes, bytes, sizeof bytes, &numBytes);
+        if (err) {
+            return err;
+        }
+    }
+
+    // M2: Verify Start Response.
+    uint8_t accessoryCvPK[X25519_BYTES];
+    uint8_t cv_KEY[X25519_BYTES];
+    uint8_t sessionKey[CHACHA20_POLY1305_KEY_BYTES];
+    {
+        HAPTLVReaderRef reader;
+        HAPTLVReaderCreate(&reader, bytes, numBytes);
+        HAPTLV stateTLV, errorTLV, publicKeyTLV, encryptedDataTLV;
+        stateTLV.type = kHAPPairingTLVType_State;
+        errorTLV.type = kHAPPairingTLVType_Error;
+        publicKeyTLV.type = kHAPPairingTLVType_PublicKey;
+        encryptedDataTLV.type = kHAPPairingTLVType_EncryptedData;
+        err = HAPTLVReaderGetAll(
+                &reader, (HAPTLV* const[]) { &stateTLV, &errorTLV, &publicKeyTLV, &encryptedDataTLV, NULL });
+        if (err) {
+            HAPAssert(err == kHAPError_InvalidData);
+            return err;
+        }
+        if (!stateTLV.value.bytes || stateTLV.value.numBytes != 1 || ((const uint8_t*) stateTLV.value.bytes)[0] != 2) {
+            HAPLog(&bleCentralLogObject, "Pair Verify M2: Invalid kTLVType_State.");
+            return kHAPError_InvalidData;
+        }
+        if (errorTLV.value.bytes) {
+            HAPLog(&bleCentralLogObject, "Pair Verify M2: Accessory reported an error.");
+            return kHAPError_InvalidState;
+        }
+        if (!publicKeyTLV.value.bytes || publicKeyTLV.value.numBytes != sizeof accessoryCvPK ||
+            !encryptedDataTLV.value.bytes || encryptedDataTLV.value.numBytes < CHACHA20_POLY1305_TAG_BYTES) {
+            HAPLog(&bleCentralLogObject, "Pair Verify M2: Malformed response.");
+            return kHAPError_InvalidData;
+        }
+        HAPRawBufferCopyBytes(accessoryCvPK, publicKeyTLV.value.bytes, sizeof accessoryCvPK);
+
+        // Derive the symmetric session encryption key.
+        HAP_X25519_scalarmult(cv_KEY, cv_SK, accessoryCvPK);
+        static const uint8_t salt[] = "Pair-Verify-Encrypt-Salt";
+        static const uint8_t info[] = "Pair-Verify-Encrypt-Info";
+        HAP_hkdf_sha512(
+                sessionKey, sizeof sessionKey, cv_KEY, sizeof cv_KEY, salt, sizeof salt - 1, info, sizeof info - 1);
+
+        // Decrypt the sub-TLV.
+        uint8_t* encryptedData = (uint8_t*) encryptedDataTLV.value.bytes;
+        size_t numEncryptedDataBytes = encryptedDataTLV.value.numBytes - CHACHA20_POLY1305_TAG_BYTES;
+        static const uint8_t nonce[] = "PV-Msg02";
+        int e = HAP_chacha20_poly1305_decrypt(
+                &encryptedData[numEncryptedDataBytes],
+                encryptedData,
+                encryptedData,
+                numEncryptedDataBytes,
+                nonce,
+                sizeof nonce - 1,
+                sessionKey);
+        if (e) {
+            HAPLog(&bleCentralLogObject, "Pair Verify M2: Decryption of kTLVType_EncryptedData failed.");
+            return kHAPError_InvalidData;
+        }
+
+        HAPTLVReaderRef subReader;
+        HAPTLVReaderCreate(&subReader, encryptedData, numEncryptedDataBytes);
+        HAPTLV identifierTLV, signatureTLV;
+        identifierTLV.type = kHAPPairingTLVType_Identifier;
+        signatureTLV.type = kHAPPairingTLVType_Signature;
+        err = HAPTLVReaderGetAll(&subReader, (HAPTLV* const[]) { &identifierTLV, &signatureTLV, NULL });
+        if (err) {
+            HAPAssert(err == kHAPError_InvalidData);
+            return err;
+        }
+        if (!identifierTLV.value.bytes || identifierTLV.value.numBytes > 64 || !signatureTLV.value.bytes ||
+            signatureTLV.value.numBytes != ED25519_BYTES) {
+            HAPLog(&bleCentralLogObject, "Pair Verify M2: Malformed sub-TLV.");
+            return kHAPError_InvalidData;
+        }
+
+        // Verify AccessoryInfo: AccessoryCvPK, AccessoryPairingID, iOSDeviceCvPK.
+        uint8_t infoBytes[X25519_BYTES + 64 + X25519_BYTES];
+        size_t numInfoBytes = 0;
+        HAPRawBufferCopyBytes(&infoBytes[numInfoBytes], accessoryCvPK, sizeof accessoryCvPK);
+        numInfoBytes += sizeof accessoryCvPK;
+        HAPRawBufferCopyBytes(&infoBytes[numInfoBytes], identifierTLV.value.bytes, identifierTLV.value.numBytes);
+        numInfoBytes += identifierTLV.value.numBytes;
+        HAPRawBufferCopyBytes(&infoBytes[numInfoBytes], cv_PK, sizeof cv_PK);
+        numInfoBytes += sizeof cv_PK;
+        e = HAP_ed25519_verify(signatureTLV.value.bytes, infoBytes, numInfoBytes, central->accessoryLTPK);
+        if (e) {
+            HAPLog(&bleCentralLogObject, "Pair Verify M2: AccessoryInfo signature is incorrect.");
+            return kHAPError_InvalidData;
+        }
+    }
+
+    // M3: Verify Finish Request.
+    {
+        // Sign iOSDeviceInfo: iOSDeviceCvPK, iOSDevicePairingID, AccessoryCvPK.
+        uint8_t infoBytes[X25519_BYTES + sizeof central->pairingIdentifier.bytes + X25519_BYTES];
+        size_t numInfoBytes = 0;
+        HAPRawBufferCopyBytes(&infoBytes[numInfoBytes], cv_PK, sizeof cv_PK);
+        numInfoBytes += sizeof cv_PK;
+        HAPRawBufferCopyBytes(
+                &infoBytes[numInfoBytes], central->pairingIdentifier.bytes, central->pairingIdentifier.numBytes);
+        numInfoBytes += central->pairingIdentifier.numBytes;
+        HAPRawBufferCopyBytes(&infoBytes[numInfoBytes], accessoryCvPK, sizeof accessoryCvPK);
+        numInfoBytes += sizeof accessoryCvPK;
+        uint8_t signature[ED25519_BYTES];
+        HAP_ed25519_sign(signature, infoBytes, numInfoBytes, central->ltsk, central->ltpk);
+
+        uint8_t subBytes[128];
+        HAPTLVWriterRef subWriter;
+        HAPTLVWriterCreate(&subWriter, subBytes, sizeof subBytes - CHACHA20_POLY1305_TAG_BYTES);
+        err = HAPTLVWriterAppend(
+                &subWriter,
+                &(const HAPTLV) { .type = kHAPPairingTLVType_Identifier,
+                                  .value = { .bytes = central->pairingIdentifier.bytes,
+                                             .numBytes = central->pairingIdentifier.numBytes } });
+        HAPAssert(!err);
+        err = HAPTLVWriterAppend(
+                &subWriter,
+                &(const HAPTLV) { .type = kHAPPairingTLVType_Signature,
+                                  .value = { .bytes = signature, .numBytes = sizeof signature } });
+        HAPAssert(!err);
+        void* encryptedData;
+        size_t numEncryptedDataBytes;
+        HAPTLVWriterGetBuffer(&subWriter, &encryptedData, &numEncryptedDataBytes);
+        static const uint8_t nonce[] = "PV-Msg03";
+        HAP_chacha20_poly1305_encrypt(
+                &((uint8_t*) encryptedData)[numEncryptedDataBytes],
+                encryptedData,
+                encryptedData,
+                numEncryptedDataBytes,
+                nonce,
+                sizeof nonce - 1,
+                sessionKey);
+        numEncryptedDataBytes += CHACHA20_POLY1305_TAG_BYTES;
+
+        uint8_t requestBytes[256];
+        HAPTLVWriterRef writer;
+        HAPTLVWriterCreate(&writer, requestBytes, sizeof requestBytes);
+        const uint8_t state = 3;
+        err = HAPTLVWriterAppend(
+                &writer,
+                &(const HAPTLV) { .type = kHAPPairingTLVType_State,
+                                  .value = { .bytes = &state, .numBytes = sizeof state } });
+        HAPAssert(!err);
+        err = HAPTLVWriterAppend(
+                &writer,
+                &(const HAPTLV) { .type = kHAPPairingTLVType_EncryptedData,
+                                  .value = { .bytes = encryptedData, .numBytes = numEncryptedDataBytes } });
+        HAPAssert(!err);
+        void* tlvBytes;
+        size_t numTLVBytes;
+        HAPTLVWriterGetBuffer(&writer, &tlvBytes, &numTLVBytes);
+
+        err = WriteCharacteristicWithResponse(
+                central, &pairVerify, tlvBytes, numTLVBytes, bytes, sizeof bytes, &numBytes);
+        if (err) {
+            return err;
+        }
+    }
+
+    // M4: Verify Finish Response.
+    {
+        HAPTLVReaderRef reader;
+        HAPTLVReaderCreate(&reader, bytes, numBytes);
+        HAPTLV stateTLV, errorTLV;
+        stateTLV.type = kHAPPairingTLVType_State;
+        errorTLV.type = kHAPPairingTLVType_Error;
+        err = HAPTLVReaderGetAll(&reader, (HAPTLV* const[]) { &stateTLV, &errorTLV, NULL });
+        if (err) {
+            HAPAssert(err == kHAPError_InvalidData);
+            return err;
+        }
+        if (!stateTLV.value.bytes || stateTLV.value.numBytes != 1 || ((const uint8_t*) stateTLV.value.bytes)[0] != 4) {
+            HAPLog(&bleCentralLogObject, "Pair Verify M4: Invalid kTLVType_State.");
+            return kHAPError_InvalidData;
+        }
+        if (errorTLV.value.bytes) {
+            HAPLog(&bleCentralLogObject, "Pair Verify M4: Accessory reported an error.");
+            return kHAPError_InvalidState;
+        }
+    }
+
+    // Derive encryption keys.
+    // See HomeKit Accessory Protocol Specification R14
+    // Section 7.4.7.2 Session Security
+    static const uint8_t salt[] = "Control-Salt";
+    static const uint8_t writeInfo[] = "Control-Write-Encryption-Key";
+    static const uint8_t readInfo[] = "Control-Read-Encryption-Key";
+    HAP_hkdf_sha512(
+            central->session.controllerToAccessoryKey,
+            sizeof central->session.controllerToAccessoryKey,
+            cv_KEY,
+            sizeof cv_KEY,
+            salt,
+            sizeof salt - 1,
+            writeInfo,
+            sizeof writeInfo - 1);
+    HAP_hkdf_sha512(
+            central->session.accessoryToControllerKey,
+            sizeof central->session.accessoryToControllerKey,
+            cv_KEY,
+            sizeof cv_KEY,
+            salt,
+            sizeof salt - 1,
+            readInfo,
+            sizeof readInfo - 1);
+    central->session.isSecured = true;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPBLECentralReadCharacteristic(
+        HAPBLECentral* central,
+        const HAPBLECentralCharacteristic* characteristic,
+        void* bytes,
+        size_t maxBytes,
+        size_t* numBytes) {
+    HAPPrecondition(central);
+    HAPPrecondition(characteristic);
+    HAPPrecondition(bytes);
+    HAPPrecondition(numBytes);
+
+    HAPError err;
+
+    static uint8_t bodyBytes[UINT16_MAX];
+    HAPBLEPDUStatus status;
+    size_t numBodyBytes;
+    err = HAPBLECentralPerformTransaction(
+            central,
+            characteristic,
+            kHAPPDUOpcode_CharacteristicRead,
+            /* requestBodyBytes: */ NULL,
+            /* numRequestBodyBytes: */ 0,
+            &status,
+            bodyBytes,
+            sizeof bodyBytes,
+            &numBodyBytes);
+    if (err) {
+        return err;
+    }
+    if (status != kHAPBLEPDUStatus_Success) {
+        HAPLog(&bleCentralLogObject, "Read rejected with status 0x%02x.", status);
+        return kHAPError_InvalidState;
+    }
+
+    HAPTLVReaderRef reader;
+    HAPTLVReaderCreate(&reader, bodyBytes, numBodyBytes);
+    HAPTLV valueTLV;
+    valueTLV.type = kHAPBLEPDUTLVType_Value;
+    err = HAPTLVReaderGetAll(&reader, (HAPTLV* const[]) { &valueTLV, NULL });
+    if (err) {
+        HAPAssert(err == kHAPError_InvalidData);
+        return err;
+    }
+    if (!valueTLV.value.bytes) {
+        HAPLog(&bleCentralLogObject, "Read response does not contain a value.");
+        return kHAPError_InvalidData;
+    }
+    if (valueTLV.value.numBytes > maxBytes) {
+        HAPLog(&bleCentralLogObject, "Not enough space to store value (%zu bytes).", valueTLV.value.numBytes);
+        return kHAPError_OutOfResources;
+    }
+    HAPRawBufferCopyBytes(bytes, valueTLV.value.bytes, valueTLV.value.numBytes);
+    *numBytes = valueTLV.value.numBytes;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPBLECentralWriteCharacteristic(
+        HAPBLECentral* central,
+        const HAPBLECentralCharacteristic* characteristic,
+        const void* bytes,
+        size_t numBytes) {
+    HAPPrecondition(central);
+    HAPPrecondition(characteristic);
+    HAPPrecondition(bytes);
+
+    HAPError err;
+
+    static uint8_t bodyBytes[UINT16_MAX];
+    HAPTLVWriterRef writer;
+    HAPTLVWriterCreate(&writer, bodyBytes, sizeof bodyBytes);
+    err = HAPTLVWriterAppend(
+            &writer,
+            &(const HAPTLV) { .type = kHAPBLEPDUTLVType_Value, .value = { .bytes = bytes, .numBytes = numBytes } });
+    if (err) {
+        HAPAssert(err == kHAPError_OutOfResources);
+        return err;
+    }
+    void* requestBodyBytes;
+    size_t numRequestBodyBytes;
+    HAPTLVWriterGetBuffer(&writer, &requestBodyBytes, &numRequestBodyBytes);
+
+    HAPBLEPDUStatus status;
+    size_t numResponseBodyBytes;
+    err = HAPBLECentralPerformTransaction(
+            central,
+            characteristic,
+            kHAPPDUOpcode_CharacteristicWrite,
+            requestBodyBytes,
+            numRequestBodyBytes,
+            &status,
+            /* responseBodyBytes: */ NULL,
+            /* maxResponseBodyBytes: */ 0,
+            &numResponseBodyBytes);
+    if (err) {
+        return err;
+    }
+    if (status != kHAPBLEPDUStatus_Success) {
+        HAPLog(&bleCentralLogObject, "Write rejected with status 0x%02x.", status);
+        return kHAPError_InvalidState;
+    }
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPBLECentralSetIndicationsEnabled(
+        HAPBLECentral* central,
+        const HAPBLECentralCharacteristic* characteristic,
+        bool enable) {
+    HAPPrecondition(central);
+    HAPPrecondition(characteristic);
+    HAPPrecondition(characteristic->cccDescriptorHandle);
+
+    uint8_t bytes[sizeof(uint16_t)];
+    HAPWriteLittleUInt16(bytes, enable ? 0x0002u : 0x0000u);
+    return WriteGATTValue(central, characteristic->cccDescriptorHandle, bytes, sizeof bytes);
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPBLECentralReceiveIndication(
+        HAPBLECentral* central,
+        HAPPlatformBLEPeripheralManagerAttributeHandle* valueHandle) {
+    HAPPrecondition(central);
+    HAPPrecondition(valueHandle);
+
+    HAPError err;
+
+    size_t numBytes;
+    err = HAPPlatformBLEPeripheralManagerCentralConfirmIndication(
+            central->blePeripheralManager, valueHandle, /* bytes: */ NULL, /* maxBytes: */ 0, &numBytes);
+    if (err == kHAPError_OutOfResources) {
+        HAPLog(&bleCentralLogObject, "Received indication that carries a value.");
+        return kHAPError_InvalidData;
+    } else if (err) {
+        HAPAssert(err == kHAPError_InvalidState);
+        return err;
+    }
+
+    // Handle Value Indication and Handle Value Confirmation.
+    central->statistics.numIndications++;
+    central->statistics.numRoundTrips++;
+    return kHAPError_None;
+}
+
+void HAPBLECentralGetStatistics(const HAPBLECentral* central, HAPBLECentralStatistics* statistics) {
+    HAPPrecondition(central);
+    HAPPrecondition(statistics);
+
+    *statistics = central->statistics;
+}
@@ -0,0 +1,272 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#ifndef HAP_BLE_CENTRAL_H
+#define HAP_BLE_CENTRAL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "HAP+Internal.h"
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull begin
+#endif
+
+/**
+ * Statistics of a simulated HAP-BLE central.
+ */
+typedef struct {
+    size_t numTransactions;   /**< Number of completed HAP-BLE transactions. */
+    size_t numGATTWrites;     /**< Number of GATT writes, i.e., number of request fragments. */
+    size_t numGATTReads;      /**< Number of GATT reads, i.e., number of response fragments. */
+    size_t numRoundTrips;     /**< Number of ATT request / response round trips. */
+    size_t numReadRoundTrips; /**< Number of "Read Request" and "Read Blob Request" round trips. */
+    size_t numIndications;    /**< Number of confirmed Handle Value Indications. */
+    size_t numRequestBytes;   /**< Number of GATT value bytes that have been written. */
+    size_t numResponseBytes;  /**< Number of GATT value bytes that have been read. */
+} HAPBLECentralStatistics;
+
+/**
+ * Simulated HAP-BLE central initialization options.
+ */
+typedef struct {
+    /** BLE peripheral manager of the accessory server. Must be the Mock BLE peripheral manager. */
+    HAPPlatformBLEPeripheralManagerRef blePeripheralManager;
+
+    /** Pairing identifier of the controller. */
+    const HAPControllerPairingIdentifier* pairingIdentifier;
+
+    /** Ed25519 long-term secret key of the controller. */
+    const uint8_t* longTermSecretKey;
+
+    /** Ed25519 long-term public key of the accessory server. */
+    const uint8_t* accessoryLongTermPublicKey;
+} HAPBLECentralOptions;
+
+/**
+ * Simulated HAP-BLE central.
+ *
+ * - The central connects through the test hooks of the Mock BLE peripheral manager and exchanges HAP-BLE PDUs
+ *   in the same way as a controller does, including fragmentation and encryption of every GATT value.
+ */
+typedef struct {
+    // Opaque type. Do not access the instance fields directly.
+    /**@cond */
+    HAPPlatformBLEPeripheralManagerRef blePeripheralManager;
+    HAPControllerPairingIdentifier pairingIdentifier;
+    uint8_t ltsk[ED25519_SECRET_KEY_BYTES];
+    uint8_t ltpk[ED25519_PUBLIC_KEY_BYTES];
+    uint8_t accessoryLTPK[ED25519_PUBLIC_KEY_BYTES];
+
+    uint16_t mtu;
+    uint8_t tid;
+
+    struct {
+        uint8_t controllerToAccessoryKey[CHACHA20_POLY1305_KEY_BYTES];
+        uint64_t controllerToAccessoryNonce;
+        uint8_t accessoryToControllerKey[CHACHA20_POLY1305_KEY_BYTES];
+        uint64_t accessoryToControllerNonce;
+        bool isSecured : 1;
+    } session;
+
+    HAPBLECentralStatistics statistics;
+    /**@endcond */
+} HAPBLECentral;
+
+/**
+ * HAP characteristic as seen by a simulated HAP-BLE central.
+ */
+typedef struct {
+    HAPPlatformBLEPeripheralManagerAttributeHandle valueHandle;         /**< Characteristic value handle. */
+    HAPPlatformBLEPeripheralManagerAttributeHandle cccDescriptorHandle; /**< CCC descriptor handle, or 0. */
+    uint16_t iid;                                                       /**< Characteristic instance ID. */
+} HAPBLECentralCharacteristic;
+
+/**
+ * Initializes a simulated HAP-BLE central.
+ *
+ * @param[out] central              Simulated central.
+ * @param      options              Initialization options.
+ */
+void HAPBLECentralCreate(HAPBLECentral* central, const HAPBLECentralOptions* options);
+
+/**
+ * Connects to the accessory server and negotiates the ATT MTU.
+ *
+ * @param      central              Simulated central.
+ * @param      mtu                  ATT MTU. At least kHAPPlatformBLEPeripheralManager_DefaultMTU.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If the accessory server is not connectable.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPBLECentralConnect(HAPBLECentral* central, uint16_t mtu);
+
+/**
+ * Disconnects from the accessory server.
+ *
+ * @param      central              Simulated central.
+ */
+void HAPBLECentralDisconnect(HAPBLECentral* central);
+
+/**
+ * Looks up a HAP characteristic and reads its instance ID.
+ *
+ * @param      central              Simulated central.
+ * @param      serviceType          Type of the service that contains the characteristic.
+ * @param      characteristicType   Type of the characteristic.
+ * @param[out] characteristic       Characteristic.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If the characteristic is not published or could not be read.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPBLECentralDiscoverCharacteristic(
+        HAPBLECentral* central,
+        const HAPUUID* serviceType,
+        const HAPUUID* characteristicType,
+        HAPBLECentralCharacteristic* characteristic);
+
+/**
+ * Performs a HAP-BLE transaction, i.e., writes a request and reads the corresponding response.
+ *
+ * - If a HAP session is established, every GATT value is encrypted.
+ *
+ * @param      central              Simulated central.
+ * @param      characteristic       Characteristic to access.
+ * @param      opcode               HAP Opcode of the request.
+ * @param      requestBodyBytes     Request body, or NULL if the request has no body.
+ * @param      numRequestBodyBytes  Length of request body.
+ * @param[out] status               Status of the response.
+ * @param[out] responseBodyBytes    Buffer to fill response body into.
+ * @param      maxResponseBodyBytes Capacity of response body buffer.
+ * @param[out] numResponseBodyBytes Length of response body.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If a GATT write or read was rejected.
+ * @return kHAPError_InvalidData    If the response is malformed or could not be decrypted.
+ * @return kHAPError_OutOfResources If the response body buffer is not large enough.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPBLECentralPerformTransaction(
+        HAPBLECentral* central,
+        const HAPBLECentralCharacteristic* characteristic,
+        HAPPDUOpcode opcode,
+        const void* _Nullable requestBodyBytes,
+        size_t numRequestBodyBytes,
+        HAPBLEPDUStatus* status,
+        void* _Nullable responseBodyBytes,
+        size_t maxResponseBodyBytes,
+        size_t* numResponseBodyBytes);
+
+/**
+ * Establishes a HAP session with Pair Verify.
+ *
+ * - The controller must already be paired with the accessory server.
+ *
+ * @param      central              Simulated central.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If a GATT write or read was rejected or the accessory server reported an error.
+ * @return kHAPError_InvalidData    If the accessory server sent a malformed or unauthenticated response.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPBLECentralPairVerify(HAPBLECentral* central);
+
+/**
+ * Reads the value of a HAP characteristic.
+ *
+ * @param      central              Simulated central.
+ * @param      characteristic       Characteristic to read.
+ * @param[out] bytes                Buffer to fill the characteristic value into.
+ * @param      maxBytes             Capacity of buffer.
+ * @param[out] numBytes             Length of characteristic value.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If the request was rejected.
+ * @return kHAPError_InvalidData    If the response is malformed.
+ * @return kHAPError_OutOfResources If the buffer is not large enough.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPBLECentralReadCharacteristic(
+        HAPBLECentral* central,
+        const HAPBLECentralCharacteristic* characteristic,
+        void* bytes,
+        size_t maxBytes,
+        size_t* numBytes);
+
+/**
+ * Writes the value of a HAP characteristic.
+ *
+ * @param      central              Simulated central.
+ * @param      characteristic       Characteristic to write.
+ * @param      bytes                Characteristic value.
+ * @param      numBytes             Length of characteristic value.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If the request was rejected.
+ * @return kHAPError_InvalidData    If the response is malformed.
+ * @return kHAPError_OutOfResources If the characteristic value is too long.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPBLECentralWriteCharacteristic(
+        HAPBLECentral* central,
+        const HAPBLECentralCharacteristic* characteristic,
+        const void* bytes,
+        size_t numBytes);
+
+/**
+ * Enables or disables indications for a HAP characteristic.
+ *
+ * @param      central              Simulated central.
+ * @param      characteristic       Characteristic. Must support indications.
+ * @param      enable               Whether indications are enabled.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If the write was rejected.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPBLECentralSetIndicationsEnabled(
+        HAPBLECentral* central,
+        const HAPBLECentralCharacteristic* characteristic,
+        bool enable);
+
+/**
+ * Receives and confirms a pending Handle Value Indication.
+ *
+ * - HAP-BLE indications do not carry a value. The characteristic has to be read to fetch the updated value.
+ *
+ * @param      central              Simulated central.
+ * @param[out] valueHandle          Characteristic value handle of the characteristic whose value changed.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If no indication is pending.
+ * @return kHAPError_InvalidData    If the indication carries a value.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPBLECentralReceiveIndication(
+        HAPBLECentral* central,
+        HAPPlatformBLEPeripheralManagerAttributeHandle* valueHandle);
+
+/**
+ * Returns the statistics that have been collected since the central was created.
+ *
+ * @param      central              Simulated central.
+ * @param[out] statistics           Statistics.
+ */
+void HAPBLECentralGetStatistics(const HAPBLECentral* central, HAPBLECentralStatistics* statistics);
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull end
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,997 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAP+Internal.h"
+#include "HAPIPController.h"
+#include "HAPPlatformTCPStreamManager+Test.h"
+
+static const HAPLogObject ipControllerLogObject = { .subsystem = "com.apple.mfi.HomeKit.Core.Test",
+                                                    .category = "IPController" };
+
+/**
+ * Number of run loop iterations without progress after which the accessory server is considered unresponsive.
+ */
+#define kHAPIPController_MaxIdleIterations ((size_t) 16)
+
+/**
+ * Length of AAD data in the IP security protocol.
+ */
+#define kHAPIPController_NumAADBytes ((size_t) 2)
+
+void HAPIPControllerCreate(HAPIPController* controller, const HAPIPControllerOptions* options) {
+    HAPPrecondition(controller);
+    HAPPrecondition(options);
+    HAPPrecondition(options->tcpStreamManager);
+    HAPPrecondition(options->pairingIdentifier);
+    HAPPrecondition(options->pairingIdentifier->numBytes <= sizeof options->pairingIdentifier->bytes);
+    HAPPrecondition(options->longTermSecretKey);
+    HAPPrecondition(options->accessoryLongTermPublicKey);
+
+    HAPRawBufferZero(controller, sizeof *controller);
+    controller->tcpStreamManager = options->tcpStreamManager;
+    controller->pairingIdentifier = *options->pairingIdentifier;
+    HAPRawBufferCopyBytes(controller->ltsk, options->longTermSecretKey, sizeof controller->ltsk);
+    HAP_ed25519_public_key(controller->ltpk, controller->ltsk);
+    HAPRawBufferCopyBytes(
+            controller->accessoryLTPK, options->accessoryLongTermPublicKey, sizeof controller->accessoryLTPK);
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPIPControllerConnect(HAPIPController* controller) {
+    HAPPrecondition(controller);
+    HAPPrecondition(!controller->isConnected);
+
+    HAPError err;
+
+    err = HAPPlatformTCPStreamManagerConnectToListener(controller->tcpStreamManager, &controller->tcpStream);
+    if (err) {
+        HAPAssert(err == kHAPError_OutOfResources);
+        return err;
+    }
+    controller->isConnected = true;
+    HAPRawBufferZero(&controller->session, sizeof controller->session);
+    controller->inboundBuffer.position = 0;
+    controller->inboundBuffer.numBytes = 0;
+    return kHAPError_None;
+}
+
+void HAPIPControllerDisconnect(HAPIPController* controller) {
+    HAPPrecondition(controller);
+
+    if (controller->isConnected) {
+        HAPPlatformTCPStreamManagerClientClose(controller->tcpStreamManager, controller->tcpStream);
+        controller->isConnected = false;
+    }
+    HAPRawBufferZero(&controller->session, sizeof controller->session);
+}
+
+HAP_RESULT_USE_CHECK
+HAPPlatformTCPStreamRef HAPIPControllerGetTCPStream(const HAPIPController* controller) {
+    HAPPrecondition(controller);
+    HAPPrecondition(controller->isConnected);
+
+    return controller->tcpStream;
+}
+
+/**
+ * Writes raw bytes to the TCP stream.
+ *
+ * @param      controller           Simulated controller.
+ * @param      bytes                Bytes to write.
+ * @param      numBytes             Number of bytes to write.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If the connection was closed or the accessory server stopped reading.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError WriteRawBytes(HAPIPController* controller, const void* bytes, size_t numBytes) {
+    HAPPrecondition(controller);
+    HAPPrecondition(controller->isConnected);
+    HAPPrecondition(bytes);
+
+    HAPError err;
+
+    size_t numWrittenBytes = 0;
+    size_t numIdleIterations = 0;
+    while (numWrittenBytes < numBytes) {
+        size_t n;
+        err = HAPPlatformTCPStreamClientWrite(
+                controller->tcpStreamManager,
+                controller->tcpStream,
+                &((const uint8_t*) bytes)[numWrittenBytes],
+                numBytes - numWrittenBytes,
+                &n);
+        if (err) {
+            HAPAssert(err == kHAPError_Busy);
+            if (numIdleIterations++ == kHAPIPController_MaxIdleIterations) {
+                HAPLog(&ipControllerLogObject, "Accessory server stopped reading.");
+                return kHAPError_InvalidState;
+            }
+            HAPPlatformClockAdvance(0);
+            continue;
+        }
+        if (!n) {
+            HAPLog(&ipControllerLogObject, "Connection closed by accessory server.");
+            return kHAPError_InvalidState;
+        }
+        numWrittenBytes += n;
+        numIdleIterations = 0;
+    }
+    return kHAPError_None;
+}
+
+/**
+ * Reads raw bytes from the TCP stream.
+ *
+ * @param      controller           Simulated controller.
+ * @param[out] bytes                Buffer to fill.
+ * @param      minBytes             Minimum number of bytes to read.
+ * @param      maxBytes             Capacity of buffer.
+ * @param[out] numBytes             Number of bytes read.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If the connection was closed or no data is available.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError
+        ReadRawBytes(HAPIPController* controller, void* bytes, size_t minBytes, size_t maxBytes, size_t* numBytes) {
+    HAPPrecondition(controller);
+    HAPPrecondition(controller->isConnected);
+    HAPPrecondition(bytes);
+    HAPPrecondition(minBytes <= maxBytes);
+    HAPPrecondition(numBytes);
+
+    HAPError err;
+
+    *numBytes = 0;
+    size_t numIdleIterations = 0;
+    while (*numBytes < minBytes) {
+        size_t n;
+        err = HAPPlatformTCPStreamClientRead(
+                controller->tcpStreamManager,
+                controller->tcpStream,
+                &((uint8_t*) bytes)[*numBytes],
+                maxBytes - *numBytes,
+                &n);
+        if (err) {
+            HAPAssert(err == kHAPError_Busy);
+            if (numIdleIterations++ == kHAPIPController_MaxIdleIterations) {
+                return kHAPError_InvalidState;
+            }
+            HAPPlatformClockAdvance(0);
+            continue;
+        }
+        if (!n) {
+            HAPLog(&ipControllerLogObject, "Connection closed by accessory server.");
+            return kHAPError_InvalidState;
+        }
+        *numBytes += n;
+        numIdleIterations = 0;
+    }
+    return kHAPError_None;
+}
+
+/**
+ * Writes bytes to the accessory server, encrypting them if a HAP session is established.
+ *
+ * @param      controller           Simulated controller.
+ * @param      bytes                Bytes to write.
+ * @param      numBytes             Number of bytes to write.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If the connection was closed or the accessory server stopped reading.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError WriteBytes(HAPIPController* controller, const void* bytes, size_t numBytes) {
+    HAPPrecondition(controller);
+    HAPPrecondition(bytes);
+
+    HAPError err;
+
+    if (!controller->session.isSecured) {
+        return WriteRawBytes(controller, bytes, numBytes);
+    }
+
+    // See HomeKit Accessory Protocol Specification R14
+    // Section 6.5.2 Session Security
+    size_t numFrameBytes;
+    for (size_t i = 0; i < numBytes; i += numFrameBytes) {
+        numFrameBytes = HAPMin(numBytes - i, kHAPIPSecurityProtocol_MaxFrameBytes);
+
+        uint8_t frameBytes[kHAPIPController_NumAADBytes + kHAPIPSecurityProtocol_MaxFrameBytes +
+                           CHACHA20_POLY1305_TAG_BYTES];
+        HAPWriteLittleUInt16(frameBytes, numFrameBytes);
+        uint8_t nonce[] = { HAPExpandLittleUInt64(controller->session.controllerToAccessoryNonce) };
+        HAP_chacha20_poly1305_encrypt_aad(
+                &frameBytes[kHAPIPController_NumAADBytes + numFrameBytes],
+                &frameBytes[kHAPIPController_NumAADBytes],
+                &((const uint8_t*) bytes)[i],
+                numFrameBytes,
+                frameBytes,
+                kHAPIPController_NumAADBytes,
+                nonce,
+                sizeof nonce,
+                controller->session.controllerToAccessoryKey);
+        controller->session.controllerToAccessoryNonce++;
+
+        err = WriteRawBytes(
+                controller, frameBytes, kHAPIPController_NumAADBytes + numFrameBytes + CHACHA20_POLY1305_TAG_BYTES);
+        if (err) {
+            return err;
+        }
+    }
+    return kHAPError_None;
+}
+
+/**
+ * Refills the inbound buffer once all of its bytes have been consumed.
+ *
+ * - If a HAP session is established, exactly one frame is read and decrypted.
+ *
+ * @param      controller           Simulated controller.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If the connection was closed or no data is available.
+ * @return kHAPError_InvalidData    If a frame is malformed or could not be decrypted.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError FillInboundBuffer(HAPIPController* controller) {
+    HAPPrecondition(controller);
+    HAPPrecondition(controller->inboundBuffer.position == controller->inboundBuffer.numBytes);
+
+    HAPError err;
+
+    uint8_t* bytes = controller->inboundBuffer.bytes;
+    size_t numBytes;
+    if (!controller->session.isSecured) {
+        err = ReadRawBytes(controller, bytes, 1, sizeof controller->inboundBuffer.bytes, &numBytes);
+        if (err) {
+            return err;
+        }
+        controller->inboundBuffer.position = 0;
+        controller->inboundBuffer.numBytes = numBytes;
+        return kHAPError_None;
+    }
+
+    err = ReadRawBytes(controller, bytes, kHAPIPController_NumAADBytes, kHAPIPController_NumAADBytes, &numBytes);
+    if (err) {
+        return err;
+    }
+    size_t numFrameBytes = HAPReadLittleUInt16(bytes);
+    if (!numFrameBytes || numFrameBytes > kHAPIPSecurityProtocol_MaxFrameBytes) {
+        HAPLog(&ipControllerLogObject, "Invalid frame length (%zu bytes).", numFrameBytes);
+        return kHAPError_InvalidData;
+    }
+    err = ReadRawBytes(
+            controller,
+            &bytes[kHAPIPController_NumAADBytes],
+            numFrameBytes + CHACHA20_POLY1305_TAG_BYTES,
+            numFrameBytes + CHACHA20_POLY1305_TAG_BYTES,
+            &numBytes);
+    if (err) {
+        return err;
+    }
+    uint8_t nonce[] = { HAPExpandLittleUInt64(controller->session.accessoryToControllerNonce) };
+    int e = HAP_chacha20_poly1305_decrypt_aad(
+            &bytes[kHAPIPController_NumAADBytes + numFrameBytes],
+            &bytes[kHAPIPController_NumAADBytes],
+            &bytes[kHAPIPController_NumAADBytes],
+            numFrameBytes,
+            bytes,
+            kHAPIPController_NumAADBytes,
+            nonce,
+            sizeof nonce,
+            controller->session.accessoryToControllerKey);
+    if (e) {
+        HAPLog(&ipControllerLogObject, "Decryption of frame failed.");
+        return kHAPError_InvalidData;
+    }
+    controller->session.accessoryToControllerNonce++;
+    controller->inboundBuffer.position = kHAPIPController_NumAADBytes;
+    controller->inboundBuffer.numBytes = kHAPIPController_NumAADBytes + numFrameBytes;
+    return kHAPError_None;
+}
+
+/**
+ * Reads a line that is terminated by CRLF.
+ *
+ * @param      controller           Simulated controller.
+ * @param[out] line                 Buffer to fill the NULL-terminated line into, without CRLF.
+ * @param      maxLineBytes         Capacity of line buffer.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If the connection was closed or no data is available.
+ * @return kHAPError_InvalidData    If the line is too long or a frame could not be decrypted.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError ReadLine(HAPIPController* controller, char* line, size_t maxLineBytes) {
+    HAPPrecondition(controller);
+    HAPPrecondition(line);
+    HAPPrecondition(maxLineBytes);
+
+    HAPError err;
+
+    size_t numLineBytes = 0;
+    for (;;) {
+        if (controller->inboundBuffer.position == controller->inboundBuffer.numBytes) {
+            err = FillInboundBuffer(controller);
+            if (err) {
+                return err;
+            }
+        }
+        char c = (char) controller->inboundBuffer.bytes[controller->inboundBuffer.position++];
+        if (c == '\n' && numLineBytes && line[numLineBytes - 1] == '\r') {
+            line[numLineBytes - 1] = '\0';
+            return kHAPError_None;
+        }
+        if (numLineBytes == maxLineBytes - 1) {
+            HAPLog(&ipControllerLogObject, "Line too long.");
+            return kHAPError_InvalidData;
+        }
+        line[numLineBytes++] = c;
+    }
+}
+
+/**
+ * Reads message body bytes.
+ *
+ * @param      controller           Simulated controller.
+ * @param[out] bodyBytes            Buffer to fill message body into, or NULL to discard the bytes.
+ * @param      maxBodyBytes         Capacity of message body buffer.
+ * @param[in,out] numBodyBytes      Length of message body. Incremented by the number of bytes read.
+ * @param      numBytes             Number of bytes to read.
+ *
+ * @return kHAPError_None           If successful. *numBodyBytes may exceed maxBodyBytes if bytes were dropped.
+ * @return kHAPError_InvalidState   If the connection was closed or no data is available.
+ * @return kHAPError_InvalidData    If a frame could not be decrypted.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError ReadBody(
+        HAPIPController* controller,
+        void* _Nullable bodyBytes,
+        size_t maxBodyBytes,
+        size_t* numBodyBytes,
+        size_t numBytes) {
+    HAPPrecondition(controller);
+    HAPPrecondition(numBodyBytes);
+
+    HAPError err;
+
+    while (numBytes) {
+        if (controller->inboundBuffer.position == controller->inboundBuffer.numBytes) {
+            err = FillInboundBuffer(controller);
+            if (err) {
+                return err;
+            }
+        }
+        size_t n = HAPMin(numBytes, controller->inboundBuffer.numBytes - controller->inboundBuffer.position);
+        if (bodyBytes && *numBodyBytes < maxBodyBytes) {
+            HAPRawBufferCopyBytes(
+                    &((uint8_t*) bodyBytes)[*numBodyBytes],
+                    &controller->inboundBuffer.bytes[controller->inboundBuffer.position],
+                    HAPMin(n, maxBodyBytes - *numBodyBytes));
+        }
+        controller->inboundBuffer.position += n;
+        *numBodyBytes += n;
+        numBytes -= n;
+    }
+    return kHAPError_None;
+}
+
+/**
+ * Parses a hexadecimal chunk size.
+ *
+ * @param      description          Chunk size line.
+ * @param[out] value                Chunk size.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidData    If the chunk size is malformed.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError ParseChunkSize(const char* description, size_t* value) {
+    HAPPrecondition(description);
+    HAPPrecondition(value);
+
+    *value = 0;
+    size_t i;
+    for (i = 0; description[i]; i++) {
+        char c = description[i];
+        size_t digit;
+        if (c >= '0' && c <= '9') {
+            digit = (size_t)(c - '0');
+        } else if (c >= 'A' && c <= 'F') {
+            digit = (size_t)(c - 'A' + 10);
+        } else if (c >= 'a' && c <= 'f') {
+            digit = (size_t)(c - 'a' + 10);
+        } else {
+            return kHAPError_InvalidData;
+        }
+        if (*value > (SIZE_MAX - digit) / 16) {
+            return kHAPError_InvalidData;
+        }
+        *value = *value * 16 + digit;
+    }
+    return i ? kHAPError_None : kHAPError_InvalidData;
+}
+
+/**
+ * Checks whether a string starts with a prefix.
+ *
+ * @param      string               String.
+ * @param      prefix               Prefix.
+ *
+ * @return true                     If the string starts with the prefix.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool HasPrefix(const char* string, const char* prefix) {
+    HAPPrecondition(string);
+    HAPPrecondition(prefix);
+
+    size_t numPrefixBytes = HAPStringGetNumBytes(prefix);
+    return HAPStringGetNumBytes(string) >= numPrefixBytes && HAPRawBufferAreEqual(string, prefix, numPrefixBytes);
+}
+
+/**
+ * Reads an HTTP response or an event notification.
+ *
+ * @param      controller           Simulated controller.
+ * @param[out] isEvent              Whether the message is an event notification.
+ * @param[out] status               Status code.
+ * @param[out] bodyBytes            Buffer to fill message body into, or NULL to discard the message body.
+ * @param      maxBodyBytes         Capacity of message body buffer.
+ * @param[out] numBodyBytes         Length of message body.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If the connection was closed or no message is available.
+ * @return kHAPError_InvalidData    If the message is malformed or could not be decrypted.
+ * @return kHAPError_OutOfResources If the message body buffer is not large enough.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError ReadMessage(
+        HAPIPController* controller,
+        bool* isEvent,
+        unsigned int* status,
+        void* _Nullable bodyBytes,
+        size_t maxBodyBytes,
+        size_t* numBodyBytes) {
+    HAPPrecondition(controller);
+    HAPPrecondition(isEvent);
+    HAPPrecondition(status);
+    HAPPrecondition(numBodyBytes);
+
+    HAPError err;
+
+    // Status line.
+    char line[256];
+    err = ReadLine(controller, line, sizeof line);
+    if (err) {
+        return err;
+    }
+    size_t numPrefixBytes;
+    if (HasPrefix(line, "HTTP/1.1 ")) {
+        *isEvent = false;
+        numPrefixBytes = sizeof "HTTP/1.1 " - 1;
+    } else if (HasPrefix(line, "EVENT/1.0 ")) {
+        *isEvent = true;
+        numPrefixBytes = sizeof "EVENT/1.0 " - 1;
+    } else {
+        HAPLog(&ipControllerLogObject, "Malformed status line: %s.", line);
+        return kHAPError_InvalidData;
+    }
+    *status = 0;
+    for (size_t i = 0; i < 3; i++) {
+        char c = line[numPrefixBytes + i];
+        if (c < '0' || c > '9') {
+            HAPLog(&ipControllerLogObject, "Malformed status line: %s.", line);
+            return kHAPError_InvalidData;
+        }
+        *status = *status * 10 + (unsigned int) (c - '0');
+    }
+
+    // Header fields.
+    bool isChunked = false;
+    uint64_t contentLength = 0;
+    for (;;) {
+        err = ReadLine(controller, line, sizeof line);
+        if (err) {
+            return err;
+        }
+        if (!line[0]) {
+            break;
+        }
+        if (HasPrefix(line, "Content-Length: ")) {
+            err = HAPUInt64FromString(&line[sizeof "Content-Length: " - 1], &contentLength);
+            if (err) {
+                HAPLog(&ipControllerLogObject, "Malformed header field: %s.", line);
+                return kHAPError_InvalidData;
+            }
+        } else if (HAPStringAreEqual(line, "Transfer-Encoding: chunked")) {
+            isChunked = true;
+        }
+    }
+
+    // Body.
+    *numBodyBytes = 0;
+    if (isChunked) {
+        for (;;) {
+            err = ReadLine(controller, line, sizeof line);
+            if (err) {
+                return err;
+            }
+            size_t numChunkBytes;
+            err = ParseChunkSize(line, &numChunkBytes);
+            if (err) {
+                HAPLog(&ipControllerLogObject, "Malformed chunk size: %s.", line);
+                return err;
+            }
+            if (numChunkBytes) {
+                err = ReadBody(controller, bodyBytes, maxBodyBytes, numBodyBytes, numChunkBytes);
+                if (err) {
+                    return err;
+                }
+            }
+            err = ReadLine(controller, line, sizeof line);
+            if (err) {
+                return err;
+            }
+            if (line[0]) {
+                HAPLog(&ipControllerLogObject, "Chunk not terminated by CRLF.");
+                return kHAPError_InvalidData;
+            }
+            if (!numChunkBytes) {
+                break;
+            }
+        }
+    } else if (contentLength) {
+        if (contentLength > SIZE_MAX) {
+            return kHAPError_InvalidData;
+        }
+        err = ReadBody(controller, bodyBytes, maxBodyBytes, numBodyBytes, (size_t) contentLength);
+        if (err) {
+            return err;
+        }
+    }
+    if (bodyBytes && *numBodyBytes > maxBodyBytes) {
+        HAPLog(&ipControllerLogObject, "Message body too long (%zu bytes).", *numBodyBytes);
+        return kHAPError_OutOfResources;
+    }
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPIPControllerSendRequest(
+        HAPIPController* controller,
+        const char* method,
+        const char* uri,
+        const char* _Nullable contentType,
+        const void* _Nullable requestBodyBytes,
+        size_t numRequestBodyBytes) {
+    HAPPrecondition(controller);
+    HAPPrecondition(controller->isConnected);
+    HAPPrecondition(method);
+    HAPPrecondition(uri);
+    HAPPrecondition(!contentType == !requestBodyBytes);
+    HAPPrecondition(requestBodyBytes || !numRequestBodyBytes);
+
+    HAPError err;
+
+    static char headerBytes[kHAPIPSession_DefaultInboundBufferSize];
+    if (contentType) {
+        err = HAPStringWithFormat(
+                headerBytes,
+                sizeof headerBytes,
+                "%s %s HTTP/1.1\r\n"
+                "Host: HAPIPController\r\n"
+                "Content-Type: %s\r\n"
+                "Content-Length: %zu\r\n\r\n",
+                method,
+                uri,
+                HAPNonnull(contentType),
+                numRequestBodyBytes);
+    } else {
+        err = HAPStringWithFormat(
+                headerBytes, sizeof headerBytes, "%s %s HTTP/1.1\r\nHost: HAPIPController\r\n\r\n", method, uri);
+    }
+    if (err) {
+        HAPAssert(err == kHAPError_OutOfResources);
+        return err;
+    }
+    err = WriteBytes(controller, headerBytes, HAPStringGetNumBytes(headerBytes));
+    if (err) {
+        return err;
+    }
+    if (numRequestBodyBytes) {
+        err = WriteBytes(controller, HAPNonnullVoid(requestBodyBytes), numRequestBodyBytes);
+        if (err) {
+            return err;
+        }
+    }
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPIPControllerReceiveResponse(
+        HAPIPController* controller,
+        unsigned int* status,
+        void* _Nullable responseBodyBytes,
+        size_t maxResponseBodyBytes,
+        size_t* numResponseBodyBytes) {
+    HAPPrecondition(controller);
+    HAPPrecondition(controller->isConnected);
+    HAPPrecondition(status);
+    HAPPrecondition(numResponseBodyBytes);
+
+    HAPError err;
+
+    for (;;) {
+        bool isEvent;
+        err = ReadMessage(
+                controller, &isEvent, status, responseBodyBytes, maxResponseBodyBytes, numResponseBodyBytes);
+        if (err) {
+            return err;
+        }
+        if (!isEvent) {
+            return kHAPError_None;
+        }
+        HAPLogInfo(&ipControllerLogObject, "Discarding event notification received while waiting for response.");
+    }
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPIPControllerPerformRequest(
+        HAPIPController* controller,
+        const char* method,
+        const char* uri,
+        const char* _Nullable contentType,
+        const void* _Nullable requestBodyBytes,
+        size_t numRequestBodyBytes,
+        unsigned int* status,
+        void* _Nullable responseBodyBytes,
+        size_t maxResponseBodyBytes,
+        size_t* numResponseBodyBytes) {
+    HAPPrecondition(controller);
+    HAPPrecondition(status);
+    HAPPrecondition(numResponseBodyBytes);
+
+    HAPError err;
+
+    err = HAPIPControllerSendRequest(controller, method, uri, contentType, requestBodyBytes, numRequestBodyBytes);
+    if (err) {
+        return err;
+    }
+    return HAPIPControllerReceiveResponse(
+            controller, status, responseBodyBytes, maxResponseBodyBytes, numResponseBodyBytes);
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPIPControllerReceiveEvent(
+        HAPIPController* controller,
+        void* bodyBytes,
+        size_t maxBodyBytes,
+        size_t* numBodyBytes) {
+    HAPPrecondition(controller);
+    HAPPrecondition(controller->isConnected);
+    HAPPrecondition(bodyBytes);
+    HAPPrecondition(numBodyBytes);
+
+    HAPError err;
+
+    bool isEvent;
+    unsigned int status;
+    err = ReadMessage(controller, &isEvent, &status, bodyBytes, maxBodyBytes, numBodyBytes);
+    if (err) {
+        return err;
+    }
+    if (!isEvent || status != 200) {
+        HAPLog(&ipControllerLogObject, "Unexpected message while waiting for event notification.");
+        return kHAPError_InvalidData;
+    }
+    return kHAPError_None;
+}
+
+/**
+ * Sends a Pair Verify request and reads the response.
+ *
+ * @param      controller           Simulated controller.
+ * @param      requestBytes         TLV request.
+ * @param      numRequestBytes      Length of TLV request.
+ * @param[out] responseBytes        Buffer to fill TLV response into.
+ * @param      maxResponseBytes     Capacity of response buffer.
+ * @param[out] numResponseBytes     Length of TLV response.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If the connection was closed or the request was rejected.
+ * @return kHAPError_InvalidData    If the response is malformed.
+ * @return kHAPError_OutOfResources If the response buffer is not large enough.
+ */
+HAP_RESULT_USE_CHECK
+static HAPError PostPairVerify(
+        HAPIPController* controller,
+        const void* requestBytes,
+        size_t numRequestBytes,
+        void* responseBytes,
+        size_t maxResponseBytes,
+        size_t* numResponseBytes) {
+    HAPPrecondition(controller);
+    HAPPrecondition(requestBytes);
+    HAPPrecondition(responseBytes);
+    HAPPrecondition(numResponseBytes);
+
+    HAPError err;
+
+    unsigned int status;
+    err = HAPIPControllerPerformRequest(
+            controller,
+            "POST",
+            "/pair-verify",
+            "application/pairing+tlv8",
+            requestBytes,
+            numRequestBytes,
+            &status,
+            responseBytes,
+            maxResponseBytes,
+            numResponseBytes);
+    if (err) {
+        return err;
+    }
+    if (status != 200) {
+        HAPLog(&ipControllerLogObject, "POST /pair-verify failed with status %u.", status);
+        return kHAPError_InvalidState;
+    }
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+HAPError HAPIPControllerPairVerify(HAPIPController* controller) {
+    HAPPrecondition(controller);
+    HAPPrecondition(controller->isConnected);
+
+    HAPError err;
+
+    // See HomeKit Accessory Protocol Specification R14
+    // Section 5.7 Pair Verify
+    // Pair Verify always starts over an unsecured session.
+    HAPRawBufferZero(&controller->session, sizeof controller->session);
+
+    // M1: Verify Start Request.
+    uint8_t cv_SK[X25519_SCALAR_BYTES];
+    uint8_t cv_PK[X25519_BYTES];
+    HAPPlatformRandomNumberFill(cv_SK, sizeof cv_SK);
+    HAP_X25519_scalarmult_base(cv_PK, cv_SK);
+
+    uint8_t bytes[1024];
+    size_t numBytes;
+    {
+        uint8_t requestBytes[64];
+        HAPTLVWriterRef writer;
+        HAPTLVWriterCreate(&writer, requestBytes, sizeof requestBytes);
+        const uint8_t state = 1;
+        err = HAPTLVWriterAppend(
+                &writer,
+                &(const HAPTLV) { .type = kHAPPairingTLVType_State,
+                                  .value = { .bytes = &state, .numBytes = sizeof state } });
+        HAPAssert(!err);
+        err = HAPTLVWriterAppend(
+                &writer,
+                &(const HAPTLV) { .type = kHAPPairingTLVType_PublicKey,
+                                  .value = { .bytes = cv_PK, .numBytes = sizeof cv_PK } });
+        HAPAssert(!err);
+        void* tlvBytes;
+        size_t numTLVBytes;
+        HAPTLVWriterGetBuffer(&writer, &tlvBytes, &numTLVBytes);
+
+        err = PostPairVerify(controller, tlvBytes, numTLVBytes, bytes, sizeof bytes, &numBytes);
+        if (err) {
+            return err;
+        }
+    }
+
+    // M2: Verify Start Response.
+    uint8_t accessoryCvPK[X25519_BYTES];
+    uint8_t cv_KEY[X25519_BYTES];
+    uint8_t sessionKey[CHACHA20_POLY1305_KEY_BYTES];
+    {
+        HAPTLVReaderRef reader;
+        HAPTLVReaderCreate(&reader, bytes, numBytes);
+        HAPTLV stateTLV, errorTLV, publicKeyTLV, encryptedDataTLV;
+        stateTLV.type = kHAPPairingTLVType_State;
+        errorTLV.type = kHAPPairingTLVType_Error;
+        publicKeyTLV.type = kHAPPairingTLVType_PublicKey;
+        encryptedDataTLV.type = kHAPPairingTLVType_EncryptedData;
+        err = HAPTLVReaderGetAll(
+                &reader, (HAPTLV* const[]) { &stateTLV, &errorTLV, &publicKeyTLV, &encryptedDataTLV, NULL });
+        if (err) {
+            HAPAssert(err == kHAPError_InvalidData);
+            return err;
+        }
+        if (!stateTLV.value.bytes || stateTLV.value.numBytes != 1 || ((const uint8_t*) stateTLV.value.bytes)[0] != 2) {
+            HAPLog(&ipControllerLogObject, "Pair Verify M2: Invalid kTLVType_State.");
+            return kHAPError_InvalidData;
+        }
+        if (errorTLV.value.bytes) {
+            HAPLog(&ipControllerLogObject, "Pair Verify M2: Accessory reported an error.");
+            return kHAPError_InvalidState;
+        }
+        if (!publicKeyTLV.value.bytes || publicKeyTLV.value.numBytes != sizeof accessoryCvPK ||
+            !encryptedDataTLV.value.bytes || encryptedDataTLV.value.numBytes < CHACHA20_POLY1305_TAG_BYTES) {
+            HAPLog(&ipControllerLogObject, "Pair Verify M2: Malformed response.");
+            return kHAPError_InvalidData;
+        }
+        HAPRawBufferCopyBytes(accessoryCvPK, publicKeyTLV.value.bytes, sizeof accessoryCvPK);
+
+        // Derive the symmetric session encryption key.
+        HAP_X25519_scalarmult(cv_KEY, cv_SK, accessoryCvPK);
+        static const uint8_t salt[] = "Pair-Verify-Encrypt-Salt";
+        static const uint8_t info[] = "Pair-Verify-Encrypt-Info";
+        HAP_hkdf_sha512(
+                sessionKey, sizeof sessionKey, cv_KEY, sizeof cv_KEY, salt, sizeof salt - 1, info, sizeof info - 1);
+
+        // Decrypt the sub-TLV.
+        uint8_t* encryptedData = (uint8_t*) encryptedDataTLV.value.bytes;
+        size_t numEncryptedDataBytes = encryptedDataTLV.value.numBytes - CHACHA20_POLY1305_TAG_BYTES;
+        static const uint8_t nonce[] = "PV-Msg02";
+        int e = HAP_chacha20_poly1305_decrypt(
+                &encryptedData[numEncryptedDataBytes],
+                encryptedData,
+                encryptedData,
+                numEncryptedDataBytes,
+                nonce,
+                sizeof nonce - 1,
+                sessionKey);
+        if (e) {
+            HAPLog(&ipControllerLogObject, "Pair Verify M2: Decryption of kTLVType_EncryptedData failed.");
+            return kHAPError_InvalidData;
+        }
+
+        HAPTLVReaderRef subReader;
+        HAPTLVReaderCreate(&subReader, encryptedData, numEncryptedDataBytes);
+        HAPTLV identifierTLV, signatureTLV;
+        identifierTLV.type = kHAPPairingTLVType_Identifier;
+        signatureTLV.type = kHAPPairingTLVType_Signature;
+        err = HAPTLVReaderGetAll(&subReader, (HAPTLV* const[]) { &identifierTLV, &signatureTLV, NULL });
+        if (err) {
+            HAPAssert(err == kHAPError_InvalidData);
+            return err;
+        }
+        if (!identifierTLV.value.bytes || identifierTLV.value.numBytes > 64 || !signatureTLV.value.bytes ||
+            signatureTLV.value.numBytes != ED25519_BYTES) {
+            HAPLog(&ipControllerLogObject, "Pair Verify M2: Malformed sub-TLV.");
+            return kHAPError_InvalidData;
+        }
+
+        // Verify AccessoryInfo: AccessoryCvPK, AccessoryPairingID, iOSDeviceCvPK.
+        uint8_t infoBytes[X25519_BYTES + 64 + X25519_BYTES];
+        size_t numInfoBytes = 0;
+        HAPRawBufferCopyBytes(&infoBytes[numInfoBytes], accessoryCvPK, sizeof accessoryCvPK);
+        numInfoBytes += sizeof accessoryCvPK;
+        HAPRawBufferCopyBytes(&infoBytes[numInfoBytes], identifierTLV.value.bytes, identifierTLV.value.numBytes);
+        numInfoBytes += identifierTLV.value.numBytes;
+        HAPRawBufferCopyBytes(&infoBytes[numInfoBytes], cv_PK, sizeof cv_PK);
+        numInfoBytes += sizeof cv_PK;
+        e = HAP_ed25519_verify(signatureTLV.value.bytes, infoBytes, numInfoBytes, controller->accessoryLTPK);
+        if (e) {
+            HAPLog(&ipControllerLogObject, "Pair Verify M2: AccessoryInfo signature is incorrect.");
+            return kHAPError_InvalidData;
+        }
+    }
+
+    // M3: Verify Finish Request.
+    {
+        // Sign iOSDeviceInfo: iOSDeviceCvPK, iOSDevicePairingID, AccessoryCvPK.
+        uint8_t infoBytes[X25519_BYTES + sizeof controller->pairingIdentifier.bytes + X25519_BYTES];
+        size_t numInfoBytes = 0;
+        HAPRawBufferCopyBytes(&infoBytes[numInfoBytes], cv_PK, sizeof cv_PK);
+        numInfoBytes += sizeof cv_PK;
+        HAPRawBufferCopyBytes(
+                &infoBytes[numInfoBytes], controller->pairingIdentifier.bytes, controller->pairingIdentifier.numBytes);
+        numInfoBytes += controller->pairingIdentifier.numBytes;
+        HAPRawBufferCopyBytes(&infoBytes[numInfoBytes], accessoryCvPK, sizeof accessoryCvPK);
+        numInfoBytes += sizeof accessoryCvPK;
+        uint8_t signature[ED25519_BYTES];
+        HAP_ed25519_sign(signature, infoBytes, numInfoBytes, controller->ltsk, controller->ltpk);
+
+        uint8_t subBytes[128];
+        HAPTLVWriterRef subWriter;
+        HAPTLVWriterCreate(&subWriter, subBytes, sizeof subBytes - CHACHA20_POLY1305_TAG_BYTES);
+        err = HAPTLVWriterAppend(
+                &subWriter,
+                &(const HAPTLV) { .type = kHAPPairingTLVType_Identifier,
+                                  .value = { .bytes = controller->pairingIdentifier.bytes,
+                                             .numBytes = controller->pairingIdentifier.numBytes } });
+        HAPAssert(!err);
+        err = HAPTLVWriterAppend(
+                &subWriter,
+                &(const HAPTLV) { .type = kHAPPairingTLVType_Signature,
+                                  .value = { .bytes = signature, .numBytes = sizeof signature } });
+        HAPAssert(!err);
+        void* encryptedData;
+        size_t numEncryptedDataBytes;
+        HAPTLVWriterGetBuffer(&subWriter, &encryptedData, &numEncryptedDataBytes);
+        static const uint8_t nonce[] = "PV-Msg03";
+        HAP_chacha20_poly1305_encrypt(
+                &((uint8_t*) encryptedData)[numEncryptedDataBytes],
+                encryptedData,
+                encryptedData,
+                numEncryptedDataBytes,
+                nonce,
+                sizeof nonce - 1,
+                sessionKey);
+        numEncryptedDataBytes += CHACHA20_POLY1305_TAG_BYTES;
+
+        uint8_t requestBytes[256];
+        HAPTLVWriterRef writer;
+        HAPTLVWriterCreate(&writer, requestBytes, sizeof requestBytes);
+        const uint8_t state = 3;
+        err = HAPTLVWriterAppend(
+                &writer,
+                &(const HAPTLV) { .type = kHAPPairingTLVType_State,
+                                  .value = { .bytes = &state, .numBytes = sizeof state } });
+        HAPAssert(!err);
+        err = HAPTLVWriterAppend(
+                &writer,
+                &(const HAPTLV) { .type = kHAPPairingTLVType_EncryptedData,
+                                  .value = { .bytes = encryptedData, .numBytes = numEncryptedDataBytes } });
+        HAPAssert(!err);
+        void* tlvBytes;
+        size_t numTLVBytes;
+        HAPTLVWriterGetBuffer(&writer, &tlvBytes, &numTLVBytes);
+
+        err = PostPairVerify(controller, tlvBytes, numTLVBytes, bytes, sizeof bytes, &numBytes);
+        if (err) {
+            return err;
+        }
+    }
+
+    // M4: Verify Finish Response.
+    {
+        HAPTLVReaderRef reader;
+        HAPTLVReaderCreate(&reader, bytes, numBytes);
+        HAPTLV stateTLV, errorTLV;
+        stateTLV.type = kHAPPairingTLVType_State;
+        errorTLV.type = kHAPPairingTLVType_Error;
+        err = HAPTLVReaderGetAll(&reader, (HAPTLV* const[]) { &stateTLV, &errorTLV, NULL });
+        if (err) {
+            HAPAssert(err == kHAPError_InvalidData);
+            return err;
+        }
+        if (!stateTLV.value.bytes || stateTLV.value.numBytes != 1 || ((const uint8_t*) stateTLV.value.bytes)[0] != 4) {
+            HAPLog(&ipControllerLogObject, "Pair Verify M4: Invalid kTLVType_State.");
+            return kHAPError_InvalidData;
+        }
+        if (errorTLV.value.bytes) {
+            HAPLog(&ipControllerLogObject, "Pair Verify M4: Accessory reported an error.");
+            return kHAPError_InvalidState;
+        }
+    }
+
+    // Derive encryption keys.
+    // See HomeKit Accessory Protocol Specification R14
+    // Section 6.5.2 Session Security
+    static const uint8_t salt[] = "Control-Salt";
+    static const uint8_t writeInfo[] = "Control-Write-Encryption-Key";
+    static const uint8_t readInfo[] = "Control-Read-Encryption-Key";
+    HAP_hkdf_sha512(
+            controller->session.controllerToAccessoryKey,
+            sizeof controller->session.controllerToAccessoryKey,
+            cv_KEY,
+            sizeof cv_KEY,
+            salt,
+            sizeof salt - 1,
+            writeInfo,
+            sizeof writeInfo - 1);
+    HAP_hkdf_sha512(
+            controller->session.accessoryToControllerKey,
+            sizeof controller->session.accessoryToControllerKey,
+            cv_KEY,
+            sizeof cv_KEY,
+            salt,
+            sizeof salt - 1,
+            readInfo,
+            sizeof readInfo - 1);
+    controller->session.isSecured = true;
+    return kHAPError_None;
+}
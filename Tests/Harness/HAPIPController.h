@@ -0,0 +1,240 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#ifndef HAP_IP_CONTROLLER_H
+#define HAP_IP_CONTROLLER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "HAP+Internal.h"
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull begin
+#endif
+
+/**
+ * Simulated HAP-IP controller initialization options.
+ */
+typedef struct {
+    /** TCP stream manager of the accessory server. Must be the Mock TCP stream manager. */
+    HAPPlatformTCPStreamManagerRef tcpStreamManager;
+
+    /** Pairing identifier of the controller. */
+    const HAPControllerPairingIdentifier* pairingIdentifier;
+
+    /** Ed25519 long-term secret key of the controller. */
+    const uint8_t* longTermSecretKey;
+
+    /** Ed25519 long-term public key of the accessory server. */
+    const uint8_t* accessoryLongTermPublicKey;
+} HAPIPControllerOptions;
+
+/**
+ * Simulated HAP-IP controller.
+ *
+ * - The controller connects through the test hooks of the Mock TCP stream manager and exchanges HTTP messages
+ *   in the same way as a controller does, including encryption of every frame once a HAP session is established.
+ */
+typedef struct {
+    // Opaque type. Do not access the instance fields directly.
+    /**@cond */
+    HAPPlatformTCPStreamManagerRef tcpStreamManager;
+    HAPPlatformTCPStreamRef tcpStream;
+    bool isConnected : 1;
+
+    HAPControllerPairingIdentifier pairingIdentifier;
+    uint8_t ltsk[ED25519_SECRET_KEY_BYTES];
+    uint8_t ltpk[ED25519_PUBLIC_KEY_BYTES];
+    uint8_t accessoryLTPK[ED25519_PUBLIC_KEY_BYTES];
+
+    struct {
+        uint8_t controllerToAccessoryKey[CHACHA20_POLY1305_KEY_BYTES];
+        uint64_t controllerToAccessoryNonce;
+        uint8_t accessoryToControllerKey[CHACHA20_POLY1305_KEY_BYTES];
+        uint64_t accessoryToControllerNonce;
+        bool isSecured : 1;
+    } session;
+
+    struct {
+        uint8_t bytes[kHAPIPSecurityProtocol_MaxFrameBytes + 2 + CHACHA20_POLY1305_TAG_BYTES];
+        size_t position;
+        size_t numBytes;
+    } inboundBuffer;
+    /**@endcond */
+} HAPIPController;
+
+/**
+ * Initializes a simulated HAP-IP controller.
+ *
+ * @param[out] controller           Simulated controller.
+ * @param      options              Initialization options.
+ */
+void HAPIPControllerCreate(HAPIPController* controller, const HAPIPControllerOptions* options);
+
+/**
+ * Connects to the accessory server.
+ *
+ * @param      controller           Simulated controller.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_OutOfResources If the accessory server cannot accept more connections.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPIPControllerConnect(HAPIPController* controller);
+
+/**
+ * Disconnects from the accessory server.
+ *
+ * @param      controller           Simulated controller.
+ */
+void HAPIPControllerDisconnect(HAPIPController* controller);
+
+/**
+ * Returns the TCP stream of the connection to the accessory server.
+ *
+ * @param      controller           Simulated controller. Must be connected.
+ *
+ * @return TCP stream, as seen by the accessory server.
+ */
+HAP_RESULT_USE_CHECK
+HAPPlatformTCPStreamRef HAPIPControllerGetTCPStream(const HAPIPController* controller);
+
+/**
+ * Establishes a HAP session with Pair Verify.
+ *
+ * - The controller must already be paired with the accessory server.
+ *
+ * @param      controller           Simulated controller.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If the connection was closed or the accessory server reported an error.
+ * @return kHAPError_InvalidData    If the accessory server sent a malformed or unauthenticated response.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPIPControllerPairVerify(HAPIPController* controller);
+
+/**
+ * Sends an HTTP request without waiting for the response.
+ *
+ * - If a HAP session is established, every frame is encrypted.
+ *
+ * @param      controller           Simulated controller.
+ * @param      method               HTTP method.
+ * @param      uri                  Request URI.
+ * @param      contentType          Content type of the request body, or NULL if the request has no body.
+ * @param      requestBodyBytes     Request body, or NULL if the request has no body.
+ * @param      numRequestBodyBytes  Length of request body.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If the connection was closed or the accessory server stopped reading.
+ * @return kHAPError_OutOfResources If the request header is too long.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPIPControllerSendRequest(
+        HAPIPController* controller,
+        const char* method,
+        const char* uri,
+        const char* _Nullable contentType,
+        const void* _Nullable requestBodyBytes,
+        size_t numRequestBodyBytes);
+
+/**
+ * Reads the response to a request that has been sent with HAPIPControllerSendRequest.
+ *
+ * - Event notifications that are received while waiting for the response are discarded.
+ *
+ * - Responses with chunked transfer encoding are reassembled.
+ *
+ * @param      controller           Simulated controller.
+ * @param[out] status               HTTP status code of the response.
+ * @param[out] responseBodyBytes    Buffer to fill response body into, or NULL to discard the response body.
+ * @param      maxResponseBodyBytes Capacity of response body buffer.
+ * @param[out] numResponseBodyBytes Length of response body.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If the connection was closed or no response is available.
+ * @return kHAPError_InvalidData    If the response is malformed or could not be decrypted.
+ * @return kHAPError_OutOfResources If the response body buffer is not large enough.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPIPControllerReceiveResponse(
+        HAPIPController* controller,
+        unsigned int* status,
+        void* _Nullable responseBodyBytes,
+        size_t maxResponseBodyBytes,
+        size_t* numResponseBodyBytes);
+
+/**
+ * Sends an HTTP request and reads the corresponding response.
+ *
+ * - If a HAP session is established, every frame is encrypted.
+ *
+ * - Event notifications that are received while waiting for the response are discarded.
+ *
+ * - Responses with chunked transfer encoding are reassembled.
+ *
+ * @param      controller           Simulated controller.
+ * @param      method               HTTP method.
+ * @param      uri                  Request URI.
+ * @param      contentType          Content type of the request body, or NULL if the request has no body.
+ * @param      requestBodyBytes     Request body, or NULL if the request has no body.
+ * @param      numRequestBodyBytes  Length of request body.
+ * @param[out] status               HTTP status code of the response.
+ * @param[out] responseBodyBytes    Buffer to fill response body into, or NULL to discard the response body.
+ * @param      maxResponseBodyBytes Capacity of response body buffer.
+ * @param[out] numResponseBodyBytes Length of response body.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If the connection was closed.
+ * @return kHAPError_InvalidData    If the response is malformed or could not be decrypted.
+ * @return kHAPError_OutOfResources If the response body buffer is not large enough.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPIPControllerPerformRequest(
+        HAPIPController* controller,
+        const char* method,
+        const char* uri,
+        const char* _Nullable contentType,
+        const void* _Nullable requestBodyBytes,
+        size_t numRequestBodyBytes,
+        unsigned int* status,
+        void* _Nullable responseBodyBytes,
+        size_t maxResponseBodyBytes,
+        size_t* numResponseBodyBytes);
+
+/**
+ * Receives a pending event notification.
+ *
+ * - Event notifications are only sent once the run loop has processed the pending timers of the accessory server.
+ *
+ * @param      controller           Simulated controller.
+ * @param[out] bodyBytes            Buffer to fill event notification body into.
+ * @param      maxBodyBytes         Capacity of event notification body buffer.
+ * @param[out] numBodyBytes         Length of event notification body.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_InvalidState   If no event notification is pending or the connection was closed.
+ * @return kHAPError_InvalidData    If the event notification is malformed or could not be decrypted.
+ * @return kHAPError_OutOfResources If the event notification body buffer is not large enough.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPIPControllerReceiveEvent(
+        HAPIPController* controller,
+        void* bodyBytes,
+        size_t maxBodyBytes,
+        size_t* numBodyBytes);
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull end
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
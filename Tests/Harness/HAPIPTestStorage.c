@@ -0,0 +1,61 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "HAPIPTestStorage.h"
+
+/**
+ * Maximum number of event notification elements per IP session.
+ */
+#define kHAPIPTestStorage_MaxEventNotifications \
+    HAPIPSessionGetNumEventNotifications(kHAPIPTestStorage_MaxCharacteristics, kHAPIPTestStorage_MaxValueDigests)
+
+static HAPIPSession ipTestSessions[kHAPIPTestStorage_MaxSessions];
+static uint8_t ipTestInboundBuffers[kHAPIPTestStorage_MaxSessions][kHAPIPSession_DefaultInboundBufferSize];
+static uint8_t ipTestOutboundBuffers[kHAPIPTestStorage_MaxSessions][kHAPIPSession_DefaultOutboundBufferSize];
+static HAPIPEventNotificationRef ipTestEventNotifications[kHAPIPTestStorage_MaxSessions]
+                                                         [kHAPIPTestStorage_MaxEventNotifications];
+static HAPIPReadContextRef ipTestReadContexts[kHAPIPTestStorage_MaxCharacteristics];
+static HAPIPWriteContextRef ipTestWriteContexts[kHAPIPTestStorage_MaxCharacteristics];
+static HAPIPCharacteristicIndexElementRef ipTestCharacteristicIndexElements[kHAPIPTestStorage_MaxCharacteristics];
+static HAPIPCharacteristicValueCacheElementRef ipTestValueCacheElements[kHAPIPTestStorage_MaxCharacteristics];
+static uint8_t ipTestScratchBuffer[kHAPIPSession_DefaultScratchBufferSize];
+
+void HAPIPTestStorageCreate(HAPIPAccessoryServerStorage* storage, const HAPIPTestStorageOptions* options) {
+    HAPPrecondition(storage);
+    HAPPrecondition(options);
+    HAPPrecondition(options->numSessions && options->numSessions <= kHAPIPTestStorage_MaxSessions);
+    HAPPrecondition(
+            options->maxCharacteristics && options->maxCharacteristics <= kHAPIPTestStorage_MaxCharacteristics);
+    HAPPrecondition(options->numValueDigests <= kHAPIPTestStorage_MaxValueDigests);
+    HAPPrecondition(options->numValueCacheElements <= options->maxCharacteristics);
+
+    HAPRawBufferZero(ipTestSessions, sizeof ipTestSessions);
+    for (size_t i = 0; i < options->numSessions; i++) {
+        ipTestSessions[i].inboundBuffer.bytes = ipTestInboundBuffers[i];
+        ipTestSessions[i].inboundBuffer.numBytes = sizeof ipTestInboundBuffers[i];
+        ipTestSessions[i].outboundBuffer.bytes = ipTestOutboundBuffers[i];
+        ipTestSessions[i].outboundBuffer.numBytes = sizeof ipTestOutboundBuffers[i];
+        ipTestSessions[i].eventNotifications = ipTestEventNotifications[i];
+        ipTestSessions[i].numEventNotifications =
+                HAPIPSessionGetNumEventNotifications(options->maxCharacteristics, options->numValueDigests);
+    }
+
+    HAPRawBufferZero(storage, sizeof *storage);
+    storage->sessions = ipTestSessions;
+    storage->numSessions = options->numSessions;
+    storage->readContexts = ipTestReadContexts;
+    storage->numReadContexts = options->maxCharacteristics;
+    storage->writeContexts = ipTestWriteContexts;
+    storage->numWriteContexts = options->maxCharacteristics;
+    storage->characteristicIndexElements = ipTestCharacteristicIndexElements;
+    storage->numCharacteristicIndexElements = options->maxCharacteristics;
+    if (options->numValueCacheElements) {
+        storage->valueCacheElements = ipTestValueCacheElements;
+        storage->numValueCacheElements = options->numValueCacheElements;
+    }
+    storage->scratchBuffer.bytes = ipTestScratchBuffer;
+    storage->scratchBuffer.numBytes = sizeof ipTestScratchBuffer;
+}
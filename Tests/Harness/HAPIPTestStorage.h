@@ -0,0 +1,79 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#ifndef HAP_IP_TEST_STORAGE_H
+#define HAP_IP_TEST_STORAGE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "HAP+Internal.h"
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull begin
+#endif
+
+/**
+ * Maximum number of IP sessions.
+ */
+#define kHAPIPTestStorage_MaxSessions kHAPIPSessionStorage_DefaultNumElements
+
+/**
+ * Maximum number of characteristics and services of the accessory database.
+ */
+#define kHAPIPTestStorage_MaxCharacteristics ((size_t) 4500)
+
+/**
+ * Maximum number of characteristics with the ip.suppressUnchangedEventNotifications property.
+ */
+#define kHAPIPTestStorage_MaxValueDigests ((size_t) 32)
+
+/**
+ * IP accessory server storage options.
+ */
+typedef struct {
+    /** Number of IP sessions. 1 ... kHAPIPTestStorage_MaxSessions. */
+    size_t numSessions;
+
+    /**
+     * Maximum number of characteristics and services of the accessory database.
+     * 1 ... kHAPIPTestStorage_MaxCharacteristics.
+     *
+     * - Determines the number of read contexts, write contexts, characteristic index elements,
+     *   and event notification elements per session.
+     */
+    size_t maxCharacteristics;
+
+    /**
+     * Number of characteristics with the ip.suppressUnchangedEventNotifications property.
+     * 0 ... kHAPIPTestStorage_MaxValueDigests.
+     */
+    size_t numValueDigests;
+
+    /** Number of characteristic value cache elements. 0 ... maxCharacteristics. */
+    size_t numValueCacheElements;
+} HAPIPTestStorageOptions;
+
+/**
+ * Prepares IP accessory server storage with default buffer sizes.
+ *
+ * - The storage is backed by static memory. Creating storage invalidates the previously created one.
+ *
+ * @param[out] storage              IP accessory server storage.
+ * @param      options              Options.
+ */
+void HAPIPTestStorageCreate(HAPIPAccessoryServerStorage* storage, const HAPIPTestStorageOptions* options);
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull end
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,109 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "LightBulbDB.h"
+#include "TemplateDB.h"
+
+HAP_RESULT_USE_CHECK
+static HAPError IdentifyLightBulbDBAccessory(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPAccessoryIdentifyRequest* request HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleLightBulbOnRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPBoolCharacteristicReadRequest* request HAP_UNUSED,
+        bool* value,
+        void* _Nullable context HAP_UNUSED) {
+    *value = true;
+    return kHAPError_None;
+}
+
+const HAPBoolCharacteristic lightBulbOnCharacteristic = {
+    .format = kHAPCharacteristicFormat_Bool,
+    .iid = kIID_LightBulbOn,
+    .characteristicType = &kHAPCharacteristicType_On,
+    .debugDescription = kHAPCharacteristicDebugDescription_On,
+    .manufacturerDescription = NULL,
+    .properties = { .readable = true,
+                    .writable = false,
+                    .supportsEventNotification = true,
+                    .hidden = false,
+                    .requiresTimedWrite = false,
+                    .supportsAuthorizationData = false,
+                    .ip = { .controlPoint = false, .supportsWriteResponse = false },
+                    .ble = { .supportsBroadcastNotification = false,
+                             .supportsDisconnectedNotification = false,
+                             .readableWithoutSecurity = false,
+                             .writableWithoutSecurity = false } },
+    .callbacks = { .handleRead = HandleLightBulbOnRead, .handleWrite = NULL }
+};
+
+const HAPService lightBulbService = {
+    .iid = kIID_LightBulb,
+    .serviceType = &kHAPServiceType_LightBulb,
+    .debugDescription = kHAPServiceDebugDescription_LightBulb,
+    .name = NULL,
+    .properties = { .primaryService = true, .hidden = false, .ble = { .supportsConfiguration = false } },
+    .linkedServices = NULL,
+    .characteristics = (const HAPCharacteristic* const[]) { &lightBulbOnCharacteristic, NULL }
+};
+
+const HAPAccessory lightBulbAccessory = { .aid = 1,
+                                          .category = kHAPAccessoryCategory_Lighting,
+                                          .name = "Acme Light Bulb",
+                                          .manufacturer = "Acme",
+                                          .model = "LightBulb1,1",
+                                          .serialNumber = "099DB48E9E28",
+                                          .firmwareVersion = "1",
+                                          .hardwareVersion = "1",
+                                          .services = (const HAPService* const[]) { &accessoryInformationService,
+                                                                                    &hapProtocolInformationService,
+                                                                                    &pairingService,
+                                                                                    &lightBulbService,
+                                                                                    NULL },
+                                          .callbacks = { .identify = IdentifyLightBulbDBAccessory } };
+
+const HAPAccessory bridgeAccessory = { .aid = 1,
+                                       .category = kHAPAccessoryCategory_Bridges,
+                                       .name = "Acme Bridge",
+                                       .manufacturer = "Acme",
+                                       .model = "Bridge1,1",
+                                       .serialNumber = "099DB48E9E28",
+                                       .firmwareVersion = "1",
+                                       .hardwareVersion = "1",
+                                       .services = (const HAPService* const[]) { &accessoryInformationService,
+                                                                                 &hapProtocolInformationService,
+                                                                                 &pairingService,
+                                                                                 NULL },
+                                       .callbacks = { .identify = IdentifyLightBulbDBAccessory } };
+
+const HAPAccessory bridgedLightBulbAccessory = {
+    .aid = 2,
+    .category = kHAPAccessoryCategory_BridgedAccessory,
+    .name = "Acme Light Bulb",
+    .manufacturer = "Acme",
+    .model = "LightBulb1,1",
+    .serialNumber = "099DB48E9E29",
+    .firmwareVersion = "1",
+    .services = (const HAPService* const[]) { &accessoryInformationService, &lightBulbService, NULL },
+    .callbacks = { .identify = IdentifyLightBulbDBAccessory }
+};
+
+const HAPAccessory secondBridgedLightBulbAccessory = {
+    .aid = 3,
+    .category = kHAPAccessoryCategory_BridgedAccessory,
+    .name = "Acme Light Bulb",
+    .manufacturer = "Acme",
+    .model = "LightBulb1,1",
+    .serialNumber = "099DB48E9E2A",
+    .firmwareVersion = "1",
+    .services = (const HAPService* const[]) { &accessoryInformationService, &lightBulbService, NULL },
+    .callbacks = { .identify = IdentifyLightBulbDBAccessory }
+};
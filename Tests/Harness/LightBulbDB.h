@@ -0,0 +1,69 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#ifndef LIGHT_BULB_DB_H
+#define LIGHT_BULB_DB_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "HAP+Internal.h"
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull begin
+#endif
+
+/**
+ * IID constants.
+ */
+#define kIID_LightBulb   ((uint64_t) 0x0030)
+#define kIID_LightBulbOn ((uint64_t) 0x0031)
+
+/**
+ * On characteristic of the light bulb service. Readable and supports event notifications. Always reads as on.
+ */
+extern const HAPBoolCharacteristic lightBulbOnCharacteristic;
+
+/**
+ * Light Bulb service.
+ */
+extern const HAPService lightBulbService;
+
+/**
+ * Standalone light bulb accessory with aid 1.
+ *
+ * - Provides the TemplateDB Accessory Information, HAP Protocol Information and Pairing services,
+ *   and the light bulb service.
+ */
+extern const HAPAccessory lightBulbAccessory;
+
+/**
+ * Bridge accessory with aid 1.
+ *
+ * - Provides the TemplateDB Accessory Information, HAP Protocol Information and Pairing services.
+ */
+extern const HAPAccessory bridgeAccessory;
+
+/**
+ * Bridged light bulb accessories with aid 2 and aid 3.
+ *
+ * - Provide the TemplateDB Accessory Information service and the light bulb service.
+ */
+/**@{*/
+extern const HAPAccessory bridgedLightBulbAccessory;
+extern const HAPAccessory secondBridgedLightBulbAccessory;
+/**@}*/
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull end
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
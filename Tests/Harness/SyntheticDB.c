@@ -0,0 +1,560 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "SyntheticDB.h"
+#include "TemplateDB.h"
+
+/**
+ * Storage for a synthetic characteristic of any format.
+ */
+typedef union {
+    HAPBaseCharacteristic base;
+    HAPDataCharacteristic data;
+    HAPBoolCharacteristic boolCharacteristic;
+    HAPUInt8Characteristic uint8Characteristic;
+    HAPUInt16Characteristic uint16Characteristic;
+    HAPUInt32Characteristic uint32Characteristic;
+    HAPUInt64Characteristic uint64Characteristic;
+    HAPIntCharacteristic intCharacteristic;
+    HAPFloatCharacteristic floatCharacteristic;
+    HAPStringCharacteristic stringCharacteristic;
+    HAPTLV8Characteristic tlv8Characteristic;
+} SyntheticCharacteristic;
+
+static HAPUUID syntheticServiceTypes[kSyntheticDB_MaxServices];
+static HAPUUID syntheticCharacteristicTypes[kSyntheticDB_MaxCharacteristics];
+static SyntheticCharacteristic syntheticCharacteristics[kSyntheticDB_MaxServices][kSyntheticDB_MaxCharacteristics];
+static const HAPCharacteristic* _Nullable syntheticCharacteristicLists[kSyntheticDB_MaxServices]
+                                                                      [kSyntheticDB_MaxCharacteristics + 1];
+static HAPService syntheticServices[kSyntheticDB_MaxServices];
+static const HAPService* syntheticServiceList[kSyntheticDB_MaxServices];
+
+static const HAPService* _Nullable primaryAccessoryServices[3 + kSyntheticDB_MaxServices + 1];
+static const HAPService* _Nullable bridgedAccessoryServices[1 + kSyntheticDB_MaxServices + 1];
+static HAPAccessory syntheticPrimaryAccessory;
+static HAPAccessory syntheticBridgedAccessories[kHAPAccessoryServerMaxBridgedAccessories];
+static const HAPAccessory* _Nullable syntheticBridgedAccessoryList[kHAPAccessoryServerMaxBridgedAccessories + 1];
+
+static size_t numSyntheticCallbacks;
+
+HAP_RESULT_USE_CHECK
+size_t SyntheticDBGetNumCallbacks(void) {
+    return numSyntheticCallbacks;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+HAP_RESULT_USE_CHECK
+static HAPError IdentifySyntheticAccessory(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPAccessoryIdentifyRequest* request HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleSyntheticDataRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPDataCharacteristicReadRequest* request HAP_UNUSED,
+        void* valueBytes,
+        size_t maxValueBytes,
+        size_t* numValueBytes,
+        void* _Nullable context HAP_UNUSED) {
+    static const uint8_t value[] = { 0xDE, 0xAD, 0xBE, 0xEF };
+    HAPPrecondition(maxValueBytes >= sizeof value);
+    HAPRawBufferCopyBytes(valueBytes, value, sizeof value);
+    *numValueBytes = sizeof value;
+    numSyntheticCallbacks++;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleSyntheticDataWrite(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPDataCharacteristicWriteRequest* request HAP_UNUSED,
+        const void* valueBytes HAP_UNUSED,
+        size_t numValueBytes HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    numSyntheticCallbacks++;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleSyntheticBoolRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPBoolCharacteristicReadRequest* request HAP_UNUSED,
+        bool* value,
+        void* _Nullable context HAP_UNUSED) {
+    *value = true;
+    numSyntheticCallbacks++;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleSyntheticBoolWrite(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPBoolCharacteristicWriteRequest* request HAP_UNUSED,
+        bool value HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    numSyntheticCallbacks++;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleSyntheticUInt8Read(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPUInt8CharacteristicReadRequest* request HAP_UNUSED,
+        uint8_t* value,
+        void* _Nullable context HAP_UNUSED) {
+    *value = 50;
+    numSyntheticCallbacks++;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleSyntheticUInt8Write(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPUInt8CharacteristicWriteRequest* request HAP_UNUSED,
+        uint8_t value HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    numSyntheticCallbacks++;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleSyntheticUInt16Read(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPUInt16CharacteristicReadRequest* request HAP_UNUSED,
+        uint16_t* value,
+        void* _Nullable context HAP_UNUSED) {
+    *value = 1000;
+    numSyntheticCallbacks++;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleSyntheticUInt16Write(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPUInt16CharacteristicWriteRequest* request HAP_UNUSED,
+        uint16_t value HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    numSyntheticCallbacks++;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleSyntheticUInt32Read(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPUInt32CharacteristicReadRequest* request HAP_UNUSED,
+        uint32_t* value,
+        void* _Nullable context HAP_UNUSED) {
+    *value = 100000;
+    numSyntheticCallbacks++;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleSyntheticUInt32Write(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPUInt32CharacteristicWriteRequest* request HAP_UNUSED,
+        uint32_t value HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    numSyntheticCallbacks++;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleSyntheticUInt64Read(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPUInt64CharacteristicReadRequest* request HAP_UNUSED,
+        uint64_t* value,
+        void* _Nullable context HAP_UNUSED) {
+    *value = 10000000000;
+    numSyntheticCallbacks++;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleSyntheticUInt64Write(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPUInt64CharacteristicWriteRequest* request HAP_UNUSED,
+        uint64_t value HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    numSyntheticCallbacks++;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleSyntheticIntRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPIntCharacteristicReadRequest* request HAP_UNUSED,
+        int32_t* value,
+        void* _Nullable context HAP_UNUSED) {
+    *value = -42;
+    numSyntheticCallbacks++;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleSyntheticIntWrite(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPIntCharacteristicWriteRequest* request HAP_UNUSED,
+        int32_t value HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    numSyntheticCallbacks++;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleSyntheticFloatRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPFloatCharacteristicReadRequest* request HAP_UNUSED,
+        float* value,
+        void* _Nullable context HAP_UNUSED) {
+    *value = 21.5F;
+    numSyntheticCallbacks++;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleSyntheticFloatWrite(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPFloatCharacteristicWriteRequest* request HAP_UNUSED,
+        float value HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    numSyntheticCallbacks++;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleSyntheticStringRead(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPStringCharacteristicReadRequest* request HAP_UNUSED,
+        char* value,
+        size_t maxValueBytes,
+        void* _Nullable context HAP_UNUSED) {
+    static const char string[] = "Synthetic";
+    HAPPrecondition(maxValueBytes >= sizeof string);
+    HAPRawBufferCopyBytes(value, string, sizeof string);
+    numSyntheticCallbacks++;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleSyntheticStringWrite(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPStringCharacteristicWriteRequest* request HAP_UNUSED,
+        const char* value HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    numSyntheticCallbacks++;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleSyntheticTLV8Read(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPTLV8CharacteristicReadRequest* request HAP_UNUSED,
+        HAPTLVWriterRef* responseWriter,
+        void* _Nullable context HAP_UNUSED) {
+    static const uint8_t value = 1;
+    HAPError err = HAPTLVWriterAppend(
+            responseWriter, &(const HAPTLV) { .type = 1, .value = { .bytes = &value, .numBytes = sizeof value } });
+    if (err) {
+        HAPAssert(err == kHAPError_OutOfResources);
+        return err;
+    }
+    numSyntheticCallbacks++;
+    return kHAPError_None;
+}
+
+HAP_RESULT_USE_CHECK
+static HAPError HandleSyntheticTLV8Write(
+        HAPAccessoryServerRef* server HAP_UNUSED,
+        const HAPTLV8CharacteristicWriteRequest* request HAP_UNUSED,
+        HAPTLVReaderRef* requestReader HAP_UNUSED,
+        void* _Nullable context HAP_UNUSED) {
+    numSyntheticCallbacks++;
+    return kHAPError_None;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Formats of synthetic characteristics, in the order of HAPCharacteristicFormat.
+ */
+static const HAPCharacteristicFormat kSyntheticFormats[] = {
+    kHAPCharacteristicFormat_Data,   kHAPCharacteristicFormat_Bool,   kHAPCharacteristicFormat_UInt8,
+    kHAPCharacteristicFormat_UInt16, kHAPCharacteristicFormat_UInt32, kHAPCharacteristicFormat_UInt64,
+    kHAPCharacteristicFormat_Int,    kHAPCharacteristicFormat_Float,  kHAPCharacteristicFormat_String,
+    kHAPCharacteristicFormat_TLV8
+};
+HAP_STATIC_ASSERT(HAPArrayCount(kSyntheticFormats) == kSyntheticDB_NumFormats, SyntheticFormats);
+
+/**
+ * Creates a vendor-specific UUID for synthetic attribute types.
+ *
+ * @param[out] uuid                 UUID.
+ * @param      kind                 1 for service types, 2 for characteristic types.
+ * @param      index                Index of the synthetic service or characteristic.
+ */
+static void CreateSyntheticType(HAPUUID* uuid, uint8_t kind, size_t index) {
+    HAPPrecondition(uuid);
+    HAPPrecondition(index <= UINT8_MAX);
+
+    // xxxxxxxx-5359-4E54-4845-544943444200, in reversed network byte order.
+    *uuid = (HAPUUID) {
+        { 0x00, 0x42, 0x44, 0x43, 0x49, 0x54, 0x45, 0x48, 0x54, 0x4E, 0x59, 0x53, (uint8_t) index, 0x00, kind, 0x00 }
+    };
+}
+
+/**
+ * Initializes a synthetic characteristic.
+ *
+ * @param[out] characteristic       Synthetic characteristic.
+ * @param      iid                  Instance ID.
+ * @param      characteristicType   Characteristic type.
+ * @param      format               Format.
+ */
+static void CreateSyntheticCharacteristic(
+        SyntheticCharacteristic* characteristic,
+        uint64_t iid,
+        const HAPUUID* characteristicType,
+        HAPCharacteristicFormat format) {
+    HAPPrecondition(characteristic);
+    HAPPrecondition(characteristicType);
+
+    HAPRawBufferZero(characteristic, sizeof *characteristic);
+
+    const HAPCharacteristicProperties properties = { .readable = true,
+                                                     .writable = true,
+                                                     .supportsEventNotification = true,
+                                                     .hidden = false,
+                                                     .requiresTimedWrite = false,
+                                                     .supportsAuthorizationData = false,
+                                                     .ip = { .controlPoint = false, .supportsWriteResponse = false },
+                                                     .ble = { .supportsBroadcastNotification = false,
+                                                              .supportsDisconnectedNotification = false,
+                                                              .readableWithoutSecurity = false,
+                                                              .writableWithoutSecurity = false } };
+    switch (format) {
+        case kHAPCharacteristicFormat_Data: {
+            characteristic->data = (HAPDataCharacteristic) {
+                .format = format,
+                .iid = iid,
+                .characteristicType = characteristicType,
+                .debugDescription = "synthetic-data",
+                .properties = properties,
+                .constraints = { .maxLength = 64 },
+                .callbacks = { .handleRead = HandleSyntheticDataRead, .handleWrite = HandleSyntheticDataWrite }
+            };
+        } break;
+        case kHAPCharacteristicFormat_Bool: {
+            characteristic->boolCharacteristic = (HAPBoolCharacteristic) {
+                .format = format,
+                .iid = iid,
+                .characteristicType = characteristicType,
+                .debugDescription = "synthetic-bool",
+                .properties = properties,
+                .callbacks = { .handleRead = HandleSyntheticBoolRead, .handleWrite = HandleSyntheticBoolWrite }
+            };
+        } break;
+        case kHAPCharacteristicFormat_UInt8: {
+            characteristic->uint8Characteristic = (HAPUInt8Characteristic) {
+                .format = format,
+                .iid = iid,
+                .characteristicType = characteristicType,
+                .debugDescription = "synthetic-uint8",
+                .properties = properties,
+                .units = kHAPCharacteristicUnits_Percentage,
+                .constraints = { .minimumValue = 0, .maximumValue = 100, .stepValue = 1 },
+                .callbacks = { .handleRead = HandleSyntheticUInt8Read, .handleWrite = HandleSyntheticUInt8Write }
+            };
+        } break;
+        case kHAPCharacteristicFormat_UInt16: {
+            characteristic->uint16Characteristic = (HAPUInt16Characteristic) {
+                .format = format,
+                .iid = iid,
+                .characteristicType = characteristicType,
+                .debugDescription = "synthetic-uint16",
+                .properties = properties,
+                .units = kHAPCharacteristicUnits_None,
+                .constraints = { .minimumValue = 0, .maximumValue = UINT16_MAX, .stepValue = 1 },
+                .callbacks = { .handleRead = HandleSyntheticUInt16Read, .handleWrite = HandleSyntheticUInt16Write }
+            };
+        } break;
+        case kHAPCharacteristicFormat_UInt32: {
+            characteristic->uint32Characteristic = (HAPUInt32Characteristic) {
+                .format = format,
+                .iid = iid,
+                .characteristicType = characteristicType,
+                .debugDescription = "synthetic-uint32",
+                .properties = properties,
+                .units = kHAPCharacteristicUnits_Seconds,
+                .constraints = { .minimumValue = 0, .maximumValue = UINT32_MAX, .stepValue = 1 },
+                .callbacks = { .handleRead = HandleSyntheticUInt32Read, .handleWrite = HandleSyntheticUInt32Write }
+            };
+        } break;
+        case kHAPCharacteristicFormat_UInt64: {
+            characteristic->uint64Characteristic = (HAPUInt64Characteristic) {
+                .format = format,
+                .iid = iid,
+                .characteristicType = characteristicType,
+                .debugDescription = "synthetic-uint64",
+                .properties = properties,
+                .units = kHAPCharacteristicUnits_None,
+                .constraints = { .minimumValue = 0, .maximumValue = UINT64_MAX, .stepValue = 1 },
+                .callbacks = { .handleRead = HandleSyntheticUInt64Read, .handleWrite = HandleSyntheticUInt64Write }
+            };
+        } break;
+        case kHAPCharacteristicFormat_Int: {
+            characteristic->intCharacteristic = (HAPIntCharacteristic) {
+                .format = format,
+                .iid = iid,
+                .characteristicType = characteristicType,
+                .debugDescription = "synthetic-int",
+                .properties = properties,
+                .units = kHAPCharacteristicUnits_None,
+                .constraints = { .minimumValue = -100, .maximumValue = 100, .stepValue = 1 },
+                .callbacks = { .handleRead = HandleSyntheticIntRead, .handleWrite = HandleSyntheticIntWrite }
+            };
+        } break;
+        case kHAPCharacteristicFormat_Float: {
+            characteristic->floatCharacteristic = (HAPFloatCharacteristic) {
+                .format = format,
+                .iid = iid,
+                .characteristicType = characteristicType,
+                .debugDescription = "synthetic-float",
+                .properties = properties,
+                .units = kHAPCharacteristicUnits_Celsius,
+                .constraints = { .minimumValue = -100, .maximumValue = 100, .stepValue = 0.5F },
+                .callbacks = { .handleRead = HandleSyntheticFloatRead, .handleWrite = HandleSyntheticFloatWrite }
+            };
+        } break;
+        case kHAPCharacteristicFormat_String: {
+            characteristic->stringCharacteristic = (HAPStringCharacteristic) {
+                .format = format,
+                .iid = iid,
+                .characteristicType = characteristicType,
+                .debugDescription = "synthetic-string",
+                .properties = properties,
+                .constraints = { .maxLength = 64 },
+                .callbacks = { .handleRead = HandleSyntheticStringRead, .handleWrite = HandleSyntheticStringWrite }
+            };
+        } break;
+        case kHAPCharacteristicFormat_TLV8: {
+            characteristic->tlv8Characteristic = (HAPTLV8Characteristic) {
+                .format = format,
+                .iid = iid,
+                .characteristicType = characteristicType,
+                .debugDescription = "synthetic-tlv8",
+                .properties = properties,
+                .callbacks = { .handleRead = HandleSyntheticTLV8Read, .handleWrite = HandleSyntheticTLV8Write }
+            };
+        } break;
+    }
+}
+
+void SyntheticDBCreate(SyntheticDB* db, const SyntheticDBOptions* options) {
+    HAPPrecondition(db);
+    HAPPrecondition(options);
+    HAPPrecondition(options->numBridgedAccessories <= kHAPAccessoryServerMaxBridgedAccessories);
+    HAPPrecondition(options->numServices >= 1 && options->numServices <= kSyntheticDB_MaxServices);
+    HAPPrecondition(options->numCharacteristics >= 1 && options->numCharacteristics <= kSyntheticDB_MaxCharacteristics);
+
+    // Synthetic services.
+    for (size_t j = 0; j < options->numCharacteristics; j++) {
+        CreateSyntheticType(&syntheticCharacteristicTypes[j], /* kind: */ 2, j);
+    }
+    for (size_t i = 0; i < options->numServices; i++) {
+        CreateSyntheticType(&syntheticServiceTypes[i], /* kind: */ 1, i);
+
+        uint64_t serviceIID = kSyntheticDB_ServiceIIDBase + i * kSyntheticDB_ServiceIIDStride;
+        for (size_t j = 0; j < options->numCharacteristics; j++) {
+            CreateSyntheticCharacteristic(
+                    &syntheticCharacteristics[i][j],
+                    serviceIID + 1 + j,
+                    &syntheticCharacteristicTypes[j],
+                    kSyntheticFormats[j % kSyntheticDB_NumFormats]);
+            syntheticCharacteristicLists[i][j] = &syntheticCharacteristics[i][j];
+        }
+        syntheticCharacteristicLists[i][options->numCharacteristics] = NULL;
+
+        syntheticServices[i] = (HAPService) {
+            .iid = serviceIID,
+            .serviceType = &syntheticServiceTypes[i],
+            .debugDescription = "synthetic-service",
+            .name = NULL,
+            .properties = { .primaryService = i == 0, .hidden = false, .ble = { .supportsConfiguration = false } },
+            .linkedServices = NULL,
+            .characteristics = syntheticCharacteristicLists[i]
+        };
+        syntheticServiceList[i] = &syntheticServices[i];
+    }
+
+    // Primary accessory.
+    size_t numPrimaryAccessoryServices = 0;
+    primaryAccessoryServices[numPrimaryAccessoryServices++] = &accessoryInformationService;
+    primaryAccessoryServices[numPrimaryAccessoryServices++] = &hapProtocolInformationService;
+    primaryAccessoryServices[numPrimaryAccessoryServices++] = &pairingService;
+    if (!options->numBridgedAccessories) {
+        for (size_t i = 0; i < options->numServices; i++) {
+            primaryAccessoryServices[numPrimaryAccessoryServices++] = &syntheticServices[i];
+        }
+    }
+    primaryAccessoryServices[numPrimaryAccessoryServices] = NULL;
+    syntheticPrimaryAccessory = (HAPAccessory) {
+        .aid = 1,
+        .category = options->numBridgedAccessories ? kHAPAccessoryCategory_Bridges : kHAPAccessoryCategory_Other,
+        .name = "Acme Synthetic",
+        .manufacturer = "Acme",
+        .model = "Synthetic1,1",
+        .serialNumber = "099DB48E9E28",
+        .firmwareVersion = "1",
+        .hardwareVersion = "1",
+        .services = primaryAccessoryServices,
+        .callbacks = { .identify = IdentifySyntheticAccessory }
+    };
+
+    // Bridged accessories.
+    size_t numBridgedAccessoryServices = 0;
+    bridgedAccessoryServices[numBridgedAccessoryServices++] = &accessoryInformationService;
+    for (size_t i = 0; i < options->numServices; i++) {
+        bridgedAccessoryServices[numBridgedAccessoryServices++] = &syntheticServices[i];
+    }
+    bridgedAccessoryServices[numBridgedAccessoryServices] = NULL;
+    for (size_t i = 0; i < options->numBridgedAccessories; i++) {
+        syntheticBridgedAccessories[i] = (HAPAccessory) { .aid = 2 + i,
+                                                          .category = kHAPAccessoryCategory_BridgedAccessory,
+                                                          .name = "Acme Synthetic Bridged",
+                                                          .manufacturer = "Acme",
+                                                          .model = "SyntheticBridged1,1",
+                                                          .serialNumber = "099DB48E9E28",
+                                                          .firmwareVersion = "1",
+                                                          .hardwareVersion = "1",
+                                                          .services = bridgedAccessoryServices,
+                                                          .callbacks = { .identify = IdentifySyntheticAccessory } };
+        syntheticBridgedAccessoryList[i] = &syntheticBridgedAccessories[i];
+    }
+    syntheticBridgedAccessoryList[options->numBridgedAccessories] = NULL;
+
+    HAPRawBufferZero(db, sizeof *db);
+    db->primaryAccessory = &syntheticPrimaryAccessory;
+    db->bridgedAccessories = options->numBridgedAccessories ? syntheticBridgedAccessoryList : NULL;
+    db->numBridgedAccessories = options->numBridgedAccessories;
+    db->services = syntheticServiceList;
+    db->numServices = options->numServices;
+    db->numCharacteristics = options->numCharacteristics;
+}
+
+HAP_RESULT_USE_CHECK
+const HAPCharacteristic*
+        SyntheticDBGetCharacteristic(const SyntheticDB* db, size_t serviceIndex, size_t characteristicIndex) {
+    HAPPrecondition(db);
+    HAPPrecondition(serviceIndex < db->numServices);
+    HAPPrecondition(characteristicIndex < db->numCharacteristics);
+
+    return HAPNonnull(db->services[serviceIndex]->characteristics[characteristicIndex]);
+}
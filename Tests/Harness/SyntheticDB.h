@@ -0,0 +1,140 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#ifndef SYNTHETIC_DB_H
+#define SYNTHETIC_DB_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "HAP+Internal.h"
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull begin
+#endif
+
+/**
+ * Maximum number of synthetic services per accessory.
+ */
+#define kSyntheticDB_MaxServices ((size_t) 16)
+
+/**
+ * Maximum number of characteristics per synthetic service.
+ */
+#define kSyntheticDB_MaxCharacteristics ((size_t) 30)
+
+/**
+ * Number of characteristic formats. The characteristics of a synthetic service cycle through all formats.
+ */
+#define kSyntheticDB_NumFormats ((size_t) 10)
+
+/**
+ * Instance ID of the first synthetic service.
+ *
+ * - Synthetic service i has instance ID kSyntheticDB_ServiceIIDBase + i * kSyntheticDB_ServiceIIDStride.
+ *
+ * - Characteristic j of a synthetic service has the instance ID of the service + 1 + j.
+ */
+#define kSyntheticDB_ServiceIIDBase ((uint64_t) 0x100)
+
+/**
+ * Instance ID distance between consecutive synthetic services.
+ */
+#define kSyntheticDB_ServiceIIDStride ((uint64_t) 0x20)
+HAP_STATIC_ASSERT(kSyntheticDB_MaxCharacteristics < kSyntheticDB_ServiceIIDStride, SyntheticDB_ServiceIIDStride);
+
+/**
+ * Synthetic accessory database options.
+ */
+typedef struct {
+    /**
+     * Number of bridged accessories.
+     *
+     * - If 0, the database describes a standalone accessory that provides the synthetic services itself.
+     *
+     * - At most kHAPAccessoryServerMaxBridgedAccessories.
+     */
+    size_t numBridgedAccessories;
+
+    /** Number of synthetic services per accessory. 1 ... kSyntheticDB_MaxServices. */
+    size_t numServices;
+
+    /** Number of characteristics per synthetic service. 1 ... kSyntheticDB_MaxCharacteristics. */
+    size_t numCharacteristics;
+} SyntheticDBOptions;
+
+/**
+ * Synthetic accessory database.
+ *
+ * - The primary accessory provides the TemplateDB Accessory Information, HAP Protocol Information and Pairing
+ *   services. Bridged accessories provide the TemplateDB Accessory Information service. The synthetic services
+ *   are provided by every bridged accessory, or by the primary accessory if there are no bridged accessories.
+ *
+ * - Synthetic characteristics are readable, writable and support event notifications. Characteristic j of a
+ *   synthetic service has format j % kSyntheticDB_NumFormats in the order of HAPCharacteristicFormat.
+ *   Every synthetic service and characteristic has its own vendor-specific type.
+ *
+ * - The database is backed by static storage. Creating a database invalidates the previously created one.
+ */
+typedef struct {
+    /** Primary accessory. */
+    const HAPAccessory* primaryAccessory;
+
+    /** NULL-terminated array of bridged accessories, or NULL if the database describes a standalone accessory. */
+    const HAPAccessory* _Nullable const* _Nullable bridgedAccessories;
+
+    /** Number of bridged accessories. */
+    size_t numBridgedAccessories;
+
+    /** Synthetic services, indexed by synthetic service index. */
+    const HAPService* const* services;
+
+    /** Number of synthetic services per accessory. */
+    size_t numServices;
+
+    /** Number of characteristics per synthetic service. */
+    size_t numCharacteristics;
+} SyntheticDB;
+
+/**
+ * Creates a synthetic accessory database.
+ *
+ * @param[out] db                   Synthetic accessory database.
+ * @param      options              Options.
+ */
+void SyntheticDBCreate(SyntheticDB* db, const SyntheticDBOptions* options);
+
+/**
+ * Returns a characteristic of a synthetic service.
+ *
+ * @param      db                   Synthetic accessory database.
+ * @param      serviceIndex         Synthetic service index.
+ * @param      characteristicIndex  Characteristic index within the synthetic service.
+ *
+ * @return Characteristic.
+ */
+HAP_RESULT_USE_CHECK
+const HAPCharacteristic*
+        SyntheticDBGetCharacteristic(const SyntheticDB* db, size_t serviceIndex, size_t characteristicIndex);
+
+/**
+ * Returns the number of times that the value of synthetic characteristics has been read or written.
+ *
+ * @return Number of read and write callback invocations on synthetic characteristics.
+ */
+HAP_RESULT_USE_CHECK
+size_t SyntheticDBGetNumCallbacks(void);
+
+#if __has_feature(nullability)
+#pragma clang assume_nonnull end
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,126 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+#include "util_http_reader.h"
+
+/**
+ * Concatenation of all tokens that were reported by the reader, separated by '|'.
+ */
+typedef struct {
+    char bytes[1024];
+    size_t numBytes;
+} Transcript;
+
+static void AppendToTranscript(Transcript* transcript, const char* bytes, size_t numBytes) {
+    HAPPrecondition(transcript);
+    HAPPrecondition(numBytes <= sizeof transcript->bytes - transcript->numBytes);
+
+    HAPRawBufferCopyBytes(&transcript->bytes[transcript->numBytes], bytes, numBytes);
+    transcript->numBytes += numBytes;
+}
+
+/**
+ * Reads an HTTP message in chunks of the given size and records the reported tokens.
+ *
+ * @return Final state of the reader.
+ */
+static int ReadMessage(const char* message, size_t chunkSize, Transcript* transcript) {
+    HAPPrecondition(message);
+    HAPPrecondition(chunkSize);
+    HAPPrecondition(transcript);
+
+    char buffer[1024];
+    size_t numBytes = HAPStringGetNumBytes(message);
+    HAPPrecondition(numBytes <= sizeof buffer);
+    HAPRawBufferCopyBytes(buffer, message, numBytes);
+
+    struct util_http_reader r;
+    util_http_reader_init(&r, util_HTTP_READER_TYPE_REQUEST);
+    transcript->numBytes = 0;
+
+    size_t position = 0;
+    size_t limit = 0;
+    while ((r.state != util_HTTP_READER_STATE_DONE) && (r.state != util_HTTP_READER_STATE_ERROR)) {
+        if (position == limit) {
+            if (limit == numBytes) {
+                break;
+            }
+            limit = numBytes - limit < chunkSize ? numBytes : limit + chunkSize;
+        }
+        position += util_http_reader_read(&r, &buffer[position], limit - position);
+        if (r.result_token) {
+            AppendToTranscript(transcript, r.result_token, r.result_length);
+        }
+        switch (r.state) {
+            case util_HTTP_READER_STATE_COMPLETED_METHOD:
+            case util_HTTP_READER_STATE_COMPLETED_URI:
+            case util_HTTP_READER_STATE_COMPLETED_VERSION:
+            case util_HTTP_READER_STATE_COMPLETED_HEADER_NAME:
+            case util_HTTP_READER_STATE_COMPLETED_HEADER_VALUE: {
+                AppendToTranscript(transcript, "|", 1);
+            } break;
+            default: {
+            } break;
+        }
+    }
+    return r.state;
+}
+
+static void TestRequest(const char* message, int expectedState, const char* _Nullable expectedTranscript) {
+    HAPPrecondition(message);
+
+    HAPLogInfo(&kHAPLog_Default, "util_http_reader_test: %s", message);
+
+    // Every chunk size must produce the same tokens, regardless of where the chunk boundaries fall.
+    for (size_t chunkSize = 1; chunkSize <= HAPStringGetNumBytes(message); chunkSize++) {
+        Transcript transcript;
+        int state = ReadMessage(message, chunkSize, &transcript);
+        HAPAssert(state == expectedState);
+        if (expectedTranscript) {
+            HAPAssert(transcript.numBytes == HAPStringGetNumBytes(HAPNonnull(expectedTranscript)));
+            HAPAssert(HAPRawBufferAreEqual(transcript.bytes, HAPNonnull(expectedTranscript), transcript.numBytes));
+        }
+    }
+}
+
+int main() {
+    TestRequest("GET /accessories HTTP/1.1\r\n\r\n", util_HTTP_READER_STATE_DONE, "GET|/accessories|HTTP/1.1|");
+    TestRequest(
+            "PUT /characteristics HTTP/1.1\r\n"
+            "Content-Type: application/hap+json\r\n"
+            "Content-Length: 17\r\n\r\n",
+            util_HTTP_READER_STATE_DONE,
+            "PUT|/characteristics|HTTP/1.1|Content-Type| application/hap+json|Content-Length| 17|");
+
+    // Header field values that span multiple SIMD blocks, with quoted strings and quoted pairs.
+    TestRequest(
+            "POST /pairings HTTP/1.1\r\n"
+            "X-Long: 0123456789abcdef0123456789abcdef0123456789abcdef\r\n"
+            "X-Quoted: \"quoted \\\" string with\ttab\" and some trailing text after it\r\n\r\n",
+            util_HTTP_READER_STATE_DONE,
+            "POST|/pairings|HTTP/1.1|X-Long| 0123456789abcdef0123456789abcdef0123456789abcdef|"
+            "X-Quoted| \"quoted \\\" string with\ttab\" and some trailing text after it|");
+
+    // Non-ASCII octets are text.
+    TestRequest(
+            "GET / HTTP/1.1\r\n"
+            "X-Name: \xC3\xA4\xC3\xB6\xC3\xBC\xC3\xA4\xC3\xB6\xC3\xBC\xC3\xA4\xC3\xB6\xC3\xBC\r\n\r\n",
+            util_HTTP_READER_STATE_DONE,
+            "GET|/|HTTP/1.1|X-Name| \xC3\xA4\xC3\xB6\xC3\xBC\xC3\xA4\xC3\xB6\xC3\xBC\xC3\xA4\xC3\xB6\xC3\xBC|");
+
+    // Control characters within header field values are rejected.
+    TestRequest(
+            "GET / HTTP/1.1\r\nX-Name: 0123456789abcdef\x01"
+            "0123456789abcdef\r\n\r\n",
+            util_HTTP_READER_STATE_ERROR,
+            NULL);
+    TestRequest("GET / HTTP/1.1\r\nX-Name: 0123456789abcdef\x7F\r\n\r\n", util_HTTP_READER_STATE_ERROR, NULL);
+
+    // Quoted strings may not span lines.
+    TestRequest("GET / HTTP/1.1\r\nX-Name: \"0123456789abcdef\r\n\r\n", util_HTTP_READER_STATE_ERROR, NULL);
+
+    return 0;
+}
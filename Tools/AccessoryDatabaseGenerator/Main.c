@@ -0,0 +1,1749 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+// Generates a const accessory attribute database from a JSON description.
+//
+// The input describes the accessories of the database with their services and characteristics:
+//
+//     {
+//         "prefix": "Bridge",
+//         "bridgedAccessories": "bridgedAccessories",
+//         "accessories": [
+//             {
+//                 "identifier": "bridgeAccessory", "aid": 1, "category": "Bridges", "name": "Acme Bridge", ...
+//                 "services": [
+//                     {
+//                         "identifier": "lightBulbService", "iid": 48, "type": "LightBulb", "primaryService": true,
+//                         "characteristics": [
+//                             {
+//                                 "identifier": "lightBulbOnCharacteristic", "iid": 49, "type": "On",
+//                                 "format": "bool", "properties": { "readable": true, "writable": true },
+//                                 "handleRead": "HandleLightBulbOnRead", "handleWrite": "HandleLightBulbOnWrite"
+//                             }
+//                         ]
+//                     },
+//                     "accessoryInformationService"
+//                 ]
+//             }
+//         ]
+//     }
+//
+// Member names follow the fields of HAPAccessory, HAPService and the characteristic structures. Services and
+// characteristics may be shared by referring to an earlier definition by its identifier. Types are the names of
+// Apple-defined types, e.g., "On" for kHAPCharacteristicType_On. The first accessory is the primary accessory,
+// further accessories are bridged accessories. Accessories without identifier are not emitted and only contribute
+// their services, e.g., when the HAPAccessory structure is filled in at runtime.
+//
+// The generated code contains the database as const definitions and storage sizing constants that are computed with
+// HAPAccessoryServerGetStorageRequirements. Bridged accessories are sorted by accessory instance ID, services and
+// characteristics by instance ID, so that the IP characteristic index is already sorted when the accessory server
+// starts. Valid values of UInt8 characteristics are not supported.
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "HAP+Internal.h"
+
+/** Path of the input file. Used in diagnostics. */
+static const char* inputPath;
+
+static void Fail(size_t line, const char* format, ...) HAP_PRINTFLIKE(2, 3);
+
+/**
+ * Reports an error in the input file and terminates the program.
+ *
+ * @param      line                 Line in the input file. 0 if not applicable.
+ * @param      format               Format string.
+ */
+static void Fail(size_t line, const char* format, ...) {
+    HAPPrecondition(format);
+
+    fprintf(stderr, "%s:%zu: error: ", inputPath ? inputPath : "AccessoryDatabaseGenerator", line);
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fprintf(stderr, "\n");
+    exit(EXIT_FAILURE);
+}
+
+HAP_RESULT_USE_CHECK
+static void* Allocate(size_t numBytes) {
+    void* bytes = calloc(1, numBytes ? numBytes : 1);
+    if (!bytes) {
+        Fail(0, "Out of memory.");
+    }
+    return HAPNonnullVoid(bytes);
+}
+
+/**
+ * Growable array of pointers.
+ */
+typedef struct {
+    void* _Nullable* _Nullable items;
+    size_t numItems;
+    size_t maxItems;
+} Array;
+
+static void AppendItem(Array* array, void* item) {
+    HAPPrecondition(array);
+    HAPPrecondition(item);
+
+    if (array->numItems == array->maxItems) {
+        size_t maxItems = 2 * array->maxItems + 4;
+        void** items = Allocate(maxItems * sizeof *items);
+        if (array->numItems) {
+            HAPRawBufferCopyBytes(items, HAPNonnull(array->items), array->numItems * sizeof *items);
+            free(array->items);
+        }
+        array->items = items;
+        array->maxItems = maxItems;
+    }
+    HAPNonnull(array->items)[array->numItems++] = item;
+}
+
+HAP_RESULT_USE_CHECK
+static void* GetItem(const Array* array, size_t index) {
+    HAPPrecondition(array);
+    HAPPrecondition(index < array->numItems);
+
+    return HAPNonnullVoid(HAPNonnull(array->items)[index]);
+}
+
+/**
+ * Sorts an array with insertion sort. Databases are small and usually declared in ascending order.
+ */
+static void SortItems(Array* array, int (*compare)(const void* item, const void* otherItem)) {
+    HAPPrecondition(array);
+    HAPPrecondition(compare);
+
+    for (size_t i = 1; i < array->numItems; i++) {
+        void* item = GetItem(array, i);
+        size_t j = i;
+        while (j && compare(GetItem(array, j - 1), item) > 0) {
+            HAPNonnull(array->items)[j] = GetItem(array, j - 1);
+            j--;
+        }
+        HAPNonnull(array->items)[j] = item;
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Growable text buffer.
+ */
+typedef struct {
+    char* _Nullable bytes;
+    size_t numBytes;
+    size_t maxBytes;
+} Text;
+
+static void AppendBytes(Text* text, const char* bytes, size_t numBytes) {
+    HAPPrecondition(text);
+    HAPPrecondition(bytes);
+
+    if (text->maxBytes - text->numBytes <= numBytes) {
+        size_t maxBytes = 2 * (text->numBytes + numBytes) + 64;
+        char* newBytes = Allocate(maxBytes);
+        if (text->bytes) {
+            HAPRawBufferCopyBytes(newBytes, HAPNonnull(text->bytes), text->numBytes);
+            free(text->bytes);
+        }
+        text->bytes = newBytes;
+        text->maxBytes = maxBytes;
+    }
+    HAPRawBufferCopyBytes(&HAPNonnull(text->bytes)[text->numBytes], bytes, numBytes);
+    text->numBytes += numBytes;
+    HAPNonnull(text->bytes)[text->numBytes] = '\0';
+}
+
+static void AppendFormat(Text* text, const char* format, ...) HAP_PRINTFLIKE(2, 3);
+
+static void AppendFormat(Text* text, const char* format, ...) {
+    HAPPrecondition(text);
+    HAPPrecondition(format);
+
+    char bytes[1024];
+    va_list args;
+    va_start(args, format);
+    int numBytes = vsnprintf(bytes, sizeof bytes, format, args);
+    va_end(args);
+    if (numBytes < 0 || (size_t) numBytes >= sizeof bytes) {
+        Fail(0, "Generated line too long.");
+    }
+    AppendBytes(text, bytes, (size_t) numBytes);
+}
+
+HAP_RESULT_USE_CHECK
+static char* CopyString(const char* bytes, size_t numBytes) {
+    HAPPrecondition(bytes);
+
+    char* string = Allocate(numBytes + 1);
+    HAPRawBufferCopyBytes(string, bytes, numBytes);
+    return string;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * JSON value kinds.
+ */
+typedef enum {
+    kValueKind_Null,
+    kValueKind_Bool,
+    kValueKind_Number,
+    kValueKind_String,
+    kValueKind_Array,
+    kValueKind_Object
+} ValueKind;
+
+typedef struct Value Value;
+
+/**
+ * Parsed JSON value.
+ */
+struct Value {
+    ValueKind kind;
+    size_t line;
+
+    /** Value of a bool. */
+    bool boolValue;
+
+    /** Unescaped string or text of a number. */
+    char* _Nullable text;
+
+    /** Members of an object or elements of an array. Keys are NULL for arrays. */
+    char* _Nullable* _Nullable keys;
+    Value* _Nullable* _Nullable values;
+    bool* _Nullable isUsed;
+    size_t numValues;
+};
+
+/**
+ * JSON parser state.
+ */
+typedef struct {
+    const char* bytes;
+    size_t numBytes;
+    size_t position;
+    size_t line;
+} Parser;
+
+static void SkipWhitespace(Parser* parser) {
+    HAPPrecondition(parser);
+
+    while (parser->position < parser->numBytes) {
+        char c = parser->bytes[parser->position];
+        if (c == '\n') {
+            parser->line++;
+        } else if (c != ' ' && c != '\t' && c != '\r') {
+            break;
+        }
+        parser->position++;
+    }
+}
+
+HAP_RESULT_USE_CHECK
+static bool ConsumeCharacter(Parser* parser, char c) {
+    HAPPrecondition(parser);
+
+    SkipWhitespace(parser);
+    if (parser->position < parser->numBytes && parser->bytes[parser->position] == c) {
+        parser->position++;
+        return true;
+    }
+    return false;
+}
+
+static void ExpectCharacter(Parser* parser, char c) {
+    HAPPrecondition(parser);
+
+    if (!ConsumeCharacter(parser, c)) {
+        Fail(parser->line, "Expected '%c'.", c);
+    }
+}
+
+HAP_RESULT_USE_CHECK
+static char* ParseString(Parser* parser) {
+    HAPPrecondition(parser);
+
+    ExpectCharacter(parser, '"');
+    Text text = { 0 };
+    AppendBytes(&text, "", 0);
+    for (;;) {
+        if (parser->position == parser->numBytes || parser->bytes[parser->position] == '\n') {
+            Fail(parser->line, "Unterminated string.");
+        }
+        char c = parser->bytes[parser->position++];
+        if (c == '"') {
+            break;
+        }
+        if ((unsigned char) c < 0x20) {
+            Fail(parser->line, "Control character in string.");
+        }
+        if (c == '\\') {
+            if (parser->position == parser->numBytes) {
+                Fail(parser->line, "Unterminated string.");
+            }
+            c = parser->bytes[parser->position++];
+            switch (c) {
+                case '"':
+                case '\\':
+                case '/': {
+                } break;
+                case 'n': {
+                    c = '\n';
+                } break;
+                case 't': {
+                    c = '\t';
+                } break;
+                default: {
+                    Fail(parser->line, "Unsupported escape sequence '\\%c'.", c);
+                }
+            }
+        }
+        AppendBytes(&text, &c, 1);
+    }
+    return HAPNonnull(text.bytes);
+}
+
+HAP_RESULT_USE_CHECK
+static bool IsNumberCharacter(char c) {
+    return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+HAP_RESULT_USE_CHECK
+static Value* ParseValue(Parser* parser);
+
+static void AppendMember(Value* value, char* _Nullable key, Value* member, size_t* maxValues) {
+    HAPPrecondition(value);
+    HAPPrecondition(member);
+    HAPPrecondition(maxValues);
+
+    if (value->numValues == *maxValues) {
+        *maxValues = 2 * *maxValues + 4;
+        char** keys = Allocate(*maxValues * sizeof *keys);
+        Value** values = Allocate(*maxValues * sizeof *values);
+        bool* isUsed = Allocate(*maxValues * sizeof *isUsed);
+        if (value->numValues) {
+            HAPRawBufferCopyBytes(keys, HAPNonnull(value->keys), value->numValues * sizeof *keys);
+            HAPRawBufferCopyBytes(values, HAPNonnull(value->values), value->numValues * sizeof *values);
+            free(value->keys);
+            free(value->values);
+            free(value->isUsed);
+        }
+        value->keys = keys;
+        value->values = values;
+        value->isUsed = isUsed;
+    }
+    HAPNonnull(value->keys)[value->numValues] = key;
+    HAPNonnull(value->values)[value->numValues] = member;
+    value->numValues++;
+}
+
+HAP_RESULT_USE_CHECK
+static Value* ParseValue(Parser* parser) {
+    HAPPrecondition(parser);
+
+    SkipWhitespace(parser);
+    Value* value = Allocate(sizeof *value);
+    value->line = parser->line;
+    if (parser->position == parser->numBytes) {
+        Fail(parser->line, "Expected value.");
+    }
+    const char* bytes = &parser->bytes[parser->position];
+    size_t numBytes = parser->numBytes - parser->position;
+    size_t maxValues = 0;
+    if (bytes[0] == '{') {
+        value->kind = kValueKind_Object;
+        parser->position++;
+        if (!ConsumeCharacter(parser, '}')) {
+            do {
+                SkipWhitespace(parser);
+                size_t line = parser->line;
+                char* key = ParseString(parser);
+                for (size_t i = 0; i < value->numValues; i++) {
+                    if (HAPStringAreEqual(HAPNonnull(HAPNonnull(value->keys)[i]), key)) {
+                        Fail(line, "Duplicate member '%s'.", key);
+                    }
+                }
+                ExpectCharacter(parser, ':');
+                AppendMember(value, key, ParseValue(parser), &maxValues);
+            } while (ConsumeCharacter(parser, ','));
+            ExpectCharacter(parser, '}');
+        }
+    } else if (bytes[0] == '[') {
+        value->kind = kValueKind_Array;
+        parser->position++;
+        if (!ConsumeCharacter(parser, ']')) {
+            do {
+                AppendMember(value, NULL, ParseValue(parser), &maxValues);
+            } while (ConsumeCharacter(parser, ','));
+            ExpectCharacter(parser, ']');
+        }
+    } else if (bytes[0] == '"') {
+        value->kind = kValueKind_String;
+        value->text = ParseString(parser);
+    } else if (numBytes >= 4 && HAPRawBufferAreEqual(bytes, "true", 4)) {
+        value->kind = kValueKind_Bool;
+        value->boolValue = true;
+        parser->position += 4;
+    } else if (numBytes >= 5 && HAPRawBufferAreEqual(bytes, "false", 5)) {
+        value->kind = kValueKind_Bool;
+        value->boolValue = false;
+        parser->position += 5;
+    } else if (numBytes >= 4 && HAPRawBufferAreEqual(bytes, "null", 4)) {
+        value->kind = kValueKind_Null;
+        parser->position += 4;
+    } else if (IsNumberCharacter(bytes[0])) {
+        value->kind = kValueKind_Number;
+        size_t i = 0;
+        while (i < numBytes && IsNumberCharacter(bytes[i])) {
+            i++;
+        }
+        value->text = CopyString(bytes, i);
+        parser->position += i;
+    } else {
+        Fail(parser->line, "Unexpected character '%c'.", bytes[0]);
+    }
+    return value;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+HAP_RESULT_USE_CHECK
+static const char* GetValueKindDescription(ValueKind kind) {
+    switch (kind) {
+        case kValueKind_Null: {
+            return "null";
+        }
+        case kValueKind_Bool: {
+            return "a bool";
+        }
+        case kValueKind_Number: {
+            return "a number";
+        }
+        case kValueKind_String: {
+            return "a string";
+        }
+        case kValueKind_Array: {
+            return "an array";
+        }
+        case kValueKind_Object: {
+            return "an object";
+        }
+    }
+    HAPFatalError();
+}
+
+static void ExpectKind(const Value* value, ValueKind kind, const char* description) {
+    HAPPrecondition(value);
+    HAPPrecondition(description);
+
+    if (value->kind != kind) {
+        Fail(value->line, "Expected %s for %s.", GetValueKindDescription(kind), description);
+    }
+}
+
+/**
+ * Looks up a member of an object and marks it as used.
+ *
+ * @param      object               Object.
+ * @param      key                  Member name.
+ *
+ * @return Member value if present, NULL otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static const Value* _Nullable GetMember(const Value* object, const char* key) {
+    HAPPrecondition(object);
+    HAPPrecondition(object->kind == kValueKind_Object);
+    HAPPrecondition(key);
+
+    for (size_t i = 0; i < object->numValues; i++) {
+        if (HAPStringAreEqual(HAPNonnull(HAPNonnull(object->keys)[i]), key)) {
+            HAPNonnull(object->isUsed)[i] = true;
+            return HAPNonnull(object->values)[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Reports members of an object that have not been looked up. Catches misspelled member names.
+ */
+static void CheckMembersAreUsed(const Value* object) {
+    HAPPrecondition(object);
+    HAPPrecondition(object->kind == kValueKind_Object);
+
+    for (size_t i = 0; i < object->numValues; i++) {
+        if (!HAPNonnull(object->isUsed)[i]) {
+            Fail(HAPNonnull(object->values)[i]->line, "Unknown member '%s'.", HAPNonnull(object->keys)[i]);
+        }
+    }
+}
+
+HAP_RESULT_USE_CHECK
+static const Value* GetRequiredMember(const Value* object, const char* key) {
+    HAPPrecondition(object);
+    HAPPrecondition(key);
+
+    const Value* _Nullable value = GetMember(object, key);
+    if (!value) {
+        Fail(object->line, "Missing member '%s'.", key);
+    }
+    return HAPNonnull(value);
+}
+
+HAP_RESULT_USE_CHECK
+static bool GetBool(const Value* object, const char* key) {
+    HAPPrecondition(object);
+    HAPPrecondition(key);
+
+    const Value* _Nullable value = GetMember(object, key);
+    if (!value) {
+        return false;
+    }
+    ExpectKind(HAPNonnull(value), kValueKind_Bool, key);
+    return HAPNonnull(value)->boolValue;
+}
+
+/**
+ * Gets a string member. Null and missing members are returned as NULL.
+ */
+HAP_RESULT_USE_CHECK
+static const char* _Nullable GetString(const Value* object, const char* key) {
+    HAPPrecondition(object);
+    HAPPrecondition(key);
+
+    const Value* _Nullable value = GetMember(object, key);
+    if (!value || HAPNonnull(value)->kind == kValueKind_Null) {
+        return NULL;
+    }
+    ExpectKind(HAPNonnull(value), kValueKind_String, key);
+    return HAPNonnull(HAPNonnull(value)->text);
+}
+
+HAP_RESULT_USE_CHECK
+static bool IsIdentifier(const char* string) {
+    HAPPrecondition(string);
+
+    if (!string[0] || (string[0] >= '0' && string[0] <= '9')) {
+        return false;
+    }
+    for (const char* c = string; *c; c++) {
+        if (!((*c >= 'a' && *c <= 'z') || (*c >= 'A' && *c <= 'Z') || (*c >= '0' && *c <= '9') || *c == '_')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Gets a member that names a C identifier. Null and missing members are returned as NULL.
+ */
+HAP_RESULT_USE_CHECK
+static const char* _Nullable GetIdentifier(const Value* object, const char* key) {
+    HAPPrecondition(object);
+    HAPPrecondition(key);
+
+    const char* _Nullable identifier = GetString(object, key);
+    if (identifier && !IsIdentifier(HAPNonnull(identifier))) {
+        Fail(HAPNonnull(GetMember(object, key))->line, "'%s' is not a valid identifier.", HAPNonnull(identifier));
+    }
+    return identifier;
+}
+
+HAP_RESULT_USE_CHECK
+static const char* GetRequiredIdentifier(const Value* object, const char* key) {
+    HAPPrecondition(object);
+    HAPPrecondition(key);
+
+    const char* _Nullable identifier = GetIdentifier(object, key);
+    if (!identifier) {
+        Fail(object->line, "Missing member '%s'.", key);
+    }
+    return HAPNonnull(identifier);
+}
+
+/**
+ * Parses an integer number in the range [minimumValue, maximumValue].
+ *
+ * Unsigned values above INT64_MAX are returned as their two's complement representation.
+ */
+HAP_RESULT_USE_CHECK
+static int64_t GetIntegerValue(const Value* value, const char* key, int64_t minimumValue, uint64_t maximumValue) {
+    HAPPrecondition(value);
+    HAPPrecondition(key);
+
+    ExpectKind(value, kValueKind_Number, key);
+    const char* text = HAPNonnull(value->text);
+    char* end;
+    errno = 0;
+    if (minimumValue < 0) {
+        long long result = strtoll(text, &end, 10);
+        if (*end || end == text || text[0] == '+') {
+            Fail(value->line, "Expected an integer for %s.", key);
+        }
+        if (errno || result < minimumValue || result > (int64_t) maximumValue) {
+            Fail(value->line, "Value of %s is out of range.", key);
+        }
+        return (int64_t) result;
+    }
+    unsigned long long result = strtoull(text, &end, 10);
+    if (*end || end == text || text[0] == '-' || text[0] == '+') {
+        Fail(value->line, "Expected an unsigned integer for %s.", key);
+    }
+    if (errno || result > maximumValue) {
+        Fail(value->line, "Value of %s is out of range.", key);
+    }
+    return (int64_t) result;
+}
+
+HAP_RESULT_USE_CHECK
+static uint64_t GetUnsignedInteger(const Value* object, const char* key, uint64_t maximumValue) {
+    HAPPrecondition(object);
+    HAPPrecondition(key);
+
+    return (uint64_t) GetIntegerValue(GetRequiredMember(object, key), key, 0, maximumValue);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Characteristic format description.
+ */
+typedef struct {
+    /** Name of the format in the input. */
+    const char* name;
+
+    /** Format. */
+    HAPCharacteristicFormat format;
+
+    /** Suffix of the structure name and format constant, e.g., UInt8 for HAPUInt8Characteristic. */
+    const char* typeName;
+
+    /** Whether the format has units and a value range. */
+    bool isNumeric;
+
+    /** Minimum and maximum of integer formats. */
+    int64_t minimumValue;
+    uint64_t maximumValue;
+
+    /** Names of the limits of integer formats. */
+    const char* _Nullable minimumValueName;
+    const char* _Nullable maximumValueName;
+
+    /** Maximum of the maxLength constraint. 0 if the format has no length constraint. */
+    uint64_t maxLength;
+} Format;
+
+static const Format kFormats[] = {
+    { .name = "data", .format = kHAPCharacteristicFormat_Data, .typeName = "Data", .maxLength = UINT32_MAX },
+    { .name = "bool", .format = kHAPCharacteristicFormat_Bool, .typeName = "Bool" },
+    { .name = "uint8",
+      .format = kHAPCharacteristicFormat_UInt8,
+      .typeName = "UInt8",
+      .isNumeric = true,
+      .maximumValue = UINT8_MAX,
+      .maximumValueName = "UINT8_MAX" },
+    { .name = "uint16",
+      .format = kHAPCharacteristicFormat_UInt16,
+      .typeName = "UInt16",
+      .isNumeric = true,
+      .maximumValue = UINT16_MAX,
+      .maximumValueName = "UINT16_MAX" },
+    { .name = "uint32",
+      .format = kHAPCharacteristicFormat_UInt32,
+      .typeName = "UInt32",
+      .isNumeric = true,
+      .maximumValue = UINT32_MAX,
+      .maximumValueName = "UINT32_MAX" },
+    { .name = "uint64",
+      .format = kHAPCharacteristicFormat_UInt64,
+      .typeName = "UInt64",
+      .isNumeric = true,
+      .maximumValue = UINT64_MAX,
+      .maximumValueName = "UINT64_MAX" },
+    { .name = "int",
+      .format = kHAPCharacteristicFormat_Int,
+      .typeName = "Int",
+      .isNumeric = true,
+      .minimumValue = INT32_MIN,
+      .maximumValue = INT32_MAX,
+      .minimumValueName = "INT32_MIN",
+      .maximumValueName = "INT32_MAX" },
+    { .name = "float", .format = kHAPCharacteristicFormat_Float, .typeName = "Float", .isNumeric = true },
+    { .name = "string", .format = kHAPCharacteristicFormat_String, .typeName = "String", .maxLength = UINT16_MAX },
+    { .name = "tlv8", .format = kHAPCharacteristicFormat_TLV8, .typeName = "TLV8" }
+};
+
+/**
+ * Units of numeric characteristics.
+ */
+static const struct {
+    /** Name of the units in the input. */
+    const char* name;
+
+    /** Suffix of the units constant. */
+    const char* typeName;
+} kUnits[] = { { "celsius", "Celsius" },
+               { "arcdegrees", "ArcDegrees" },
+               { "percentage", "Percentage" },
+               { "lux", "Lux" },
+               { "seconds", "Seconds" } };
+
+/**
+ * Types whose transport support or event notification state differs from other types.
+ *
+ * The storage sizing constants are computed with the real type so that they agree with the accessory server.
+ * Other types are represented by placeholders. See HAPIPCharacteristicIsSupported,
+ * HAPIPCharacteristicSuppressesUnchangedEventNotifications and HAPAccessoryServerSupportsService.
+ */
+static const struct {
+    const char* name;
+    const HAPUUID* type;
+} kCharacteristicTypes[] = { { "ServiceSignature", &kHAPCharacteristicType_ServiceSignature },
+                             { "ProgrammableSwitchEvent", &kHAPCharacteristicType_ProgrammableSwitchEvent } },
+  kServiceTypes[] = { { "Pairing", &kHAPServiceType_Pairing } };
+
+/** Placeholder for other types. */
+static const HAPUUID kPlaceholderType = HAPUUIDCreateAppleDefined(0);
+
+/**
+ * Characteristic of the database.
+ */
+typedef struct {
+    size_t line;
+    const char* identifier;
+    const Format* format;
+    uint64_t iid;
+    const char* typeName;
+    const char* _Nullable manufacturerDescription;
+    HAPCharacteristicProperties properties;
+    const char* _Nullable unitsName;
+    const Value* _Nullable minimumValue;
+    const Value* _Nullable maximumValue;
+    const Value* _Nullable stepValue;
+    uint64_t maxLength;
+    const char* _Nullable handleRead;
+    const char* _Nullable handleWrite;
+
+    /** Characteristic passed to the HAP library when computing the storage sizing constants. */
+    union {
+        HAPBaseCharacteristic base;
+        HAPDataCharacteristic data;
+        HAPBoolCharacteristic boolean;
+        HAPUInt8Characteristic uint8;
+        HAPUInt16Characteristic uint16;
+        HAPUInt32Characteristic uint32;
+        HAPUInt64Characteristic uint64;
+        HAPIntCharacteristic integer;
+        HAPFloatCharacteristic floatingPoint;
+        HAPStringCharacteristic string;
+        HAPTLV8Characteristic tlv8;
+    } value;
+} Characteristic;
+
+/**
+ * Service of the database.
+ */
+typedef struct {
+    size_t line;
+    const char* identifier;
+    uint64_t iid;
+    const char* typeName;
+    const char* _Nullable name;
+    bool primaryService;
+    bool hidden;
+    bool supportsConfiguration;
+
+    /** Linked services. Elements are Service. */
+    Array linkedServices;
+
+    /** Characteristics. Elements are Characteristic. */
+    Array characteristics;
+
+    /** Service passed to the HAP library when computing the storage sizing constants. */
+    HAPService value;
+} Service;
+
+/**
+ * Accessory of the database.
+ */
+typedef struct {
+    size_t line;
+    const char* _Nullable identifier;
+    uint64_t aid;
+    const char* _Nullable categoryName;
+    const char* _Nullable name;
+    const char* _Nullable manufacturer;
+    const char* _Nullable model;
+    const char* _Nullable serialNumber;
+    const char* _Nullable firmwareVersion;
+    const char* _Nullable hardwareVersion;
+    const char* _Nullable identify;
+
+    /** Services. Elements are Service. */
+    Array services;
+
+    /** Accessory passed to the HAP library when computing the storage sizing constants. */
+    HAPAccessory value;
+} Accessory;
+
+/** Accessories. Elements are Accessory. The first accessory is the primary accessory. */
+static Array accessories;
+
+/** Services in order of definition. Elements are Service. */
+static Array services;
+
+/** Characteristics in order of definition. Elements are Characteristic. */
+static Array characteristics;
+
+/**
+ * Reports an identifier that is already used by another object of the database.
+ */
+static void CheckIdentifierIsUnique(const char* identifier, size_t line) {
+    HAPPrecondition(identifier);
+
+    for (size_t i = 0; i < accessories.numItems; i++) {
+        const Accessory* accessory = GetItem(&accessories, i);
+        if (accessory->identifier && HAPStringAreEqual(HAPNonnull(accessory->identifier), identifier)) {
+            Fail(line, "Identifier '%s' already used on line %zu.", identifier, accessory->line);
+        }
+    }
+    for (size_t i = 0; i < services.numItems; i++) {
+        const Service* service = GetItem(&services, i);
+        if (HAPStringAreEqual(service->identifier, identifier)) {
+            Fail(line, "Identifier '%s' already used on line %zu.", identifier, service->line);
+        }
+    }
+    for (size_t i = 0; i < characteristics.numItems; i++) {
+        const Characteristic* characteristic = GetItem(&characteristics, i);
+        if (HAPStringAreEqual(characteristic->identifier, identifier)) {
+            Fail(line, "Identifier '%s' already used on line %zu.", identifier, characteristic->line);
+        }
+    }
+}
+
+HAP_RESULT_USE_CHECK
+static const HAPUUID* GetType(const char* typeName, bool isService) {
+    HAPPrecondition(typeName);
+
+    if (isService) {
+        for (size_t i = 0; i < HAPArrayCount(kServiceTypes); i++) {
+            if (HAPStringAreEqual(kServiceTypes[i].name, typeName)) {
+                return kServiceTypes[i].type;
+            }
+        }
+    } else {
+        for (size_t i = 0; i < HAPArrayCount(kCharacteristicTypes); i++) {
+            if (HAPStringAreEqual(kCharacteristicTypes[i].name, typeName)) {
+                return kCharacteristicTypes[i].type;
+            }
+        }
+    }
+    return &kPlaceholderType;
+}
+
+/**
+ * Parses the numeric constraints of a characteristic.
+ */
+static void ParseNumericConstraints(Characteristic* characteristic, const Value* object) {
+    HAPPrecondition(characteristic);
+    HAPPrecondition(characteristic->format->isNumeric);
+    HAPPrecondition(object);
+
+    const Format* format = characteristic->format;
+    const char* _Nullable unitsName = GetString(object, "units");
+    if (unitsName) {
+        for (size_t i = 0; i < HAPArrayCount(kUnits); i++) {
+            if (HAPStringAreEqual(kUnits[i].name, HAPNonnull(unitsName))) {
+                characteristic->unitsName = kUnits[i].typeName;
+            }
+        }
+        if (!characteristic->unitsName) {
+            Fail(object->line, "Unknown units '%s'.", HAPNonnull(unitsName));
+        }
+    }
+
+    characteristic->minimumValue = GetRequiredMember(object, "minimumValue");
+    characteristic->maximumValue = GetRequiredMember(object, "maximumValue");
+    characteristic->stepValue = GetMember(object, "stepValue");
+    if (format->format == kHAPCharacteristicFormat_Float) {
+        const Value* _Nullable values[] = { characteristic->minimumValue,
+                                            characteristic->maximumValue,
+                                            characteristic->stepValue };
+        for (size_t i = 0; i < HAPArrayCount(values); i++) {
+            if (values[i]) {
+                ExpectKind(HAPNonnull(values[i]), kValueKind_Number, "a float constraint");
+                char* end;
+                (void) strtod(HAPNonnull(HAPNonnull(values[i])->text), &end);
+                if (*end) {
+                    Fail(HAPNonnull(values[i])->line, "Expected a number.");
+                }
+            }
+        }
+        return;
+    }
+    int64_t minimumValue = GetIntegerValue(
+            HAPNonnull(characteristic->minimumValue), "minimumValue", format->minimumValue, format->maximumValue);
+    int64_t maximumValue = GetIntegerValue(
+            HAPNonnull(characteristic->maximumValue), "maximumValue", format->minimumValue, format->maximumValue);
+    if (characteristic->stepValue) {
+        int64_t stepValue = GetIntegerValue(HAPNonnull(characteristic->stepValue), "stepValue", 0, format->maximumValue);
+        (void) stepValue;
+    }
+    bool isOrdered = format->minimumValue < 0 ? minimumValue <= maximumValue :
+                                                (uint64_t) minimumValue <= (uint64_t) maximumValue;
+    if (!isOrdered) {
+        Fail(object->line, "minimumValue must not exceed maximumValue.");
+    }
+}
+
+HAP_RESULT_USE_CHECK
+static Characteristic* ParseCharacteristic(const Value* object) {
+    HAPPrecondition(object);
+
+    if (object->kind == kValueKind_String) {
+        for (size_t i = 0; i < characteristics.numItems; i++) {
+            Characteristic* characteristic = GetItem(&characteristics, i);
+            if (HAPStringAreEqual(characteristic->identifier, HAPNonnull(object->text))) {
+                return characteristic;
+            }
+        }
+        Fail(object->line, "Unknown characteristic '%s'.", HAPNonnull(object->text));
+    }
+    ExpectKind(object, kValueKind_Object, "a characteristic");
+
+    Characteristic* characteristic = Allocate(sizeof *characteristic);
+    characteristic->line = object->line;
+    characteristic->identifier = GetRequiredIdentifier(object, "identifier");
+    CheckIdentifierIsUnique(characteristic->identifier, object->line);
+    characteristic->iid = GetUnsignedInteger(object, "iid", UINT64_MAX);
+    if (!characteristic->iid) {
+        Fail(object->line, "Instance ID must not be 0.");
+    }
+    characteristic->typeName = GetRequiredIdentifier(object, "type");
+    const Value* formatValue = GetRequiredMember(object, "format");
+    ExpectKind(formatValue, kValueKind_String, "format");
+    const char* formatName = HAPNonnull(formatValue->text);
+    for (size_t i = 0; i < HAPArrayCount(kFormats); i++) {
+        if (HAPStringAreEqual(kFormats[i].name, formatName)) {
+            characteristic->format = &kFormats[i];
+        }
+    }
+    if (!characteristic->format) {
+        Fail(object->line, "Unknown format '%s'.", formatName);
+    }
+    characteristic->manufacturerDescription = GetString(object, "manufacturerDescription");
+
+    const Value* _Nullable properties = GetMember(object, "properties");
+    if (properties) {
+        ExpectKind(HAPNonnull(properties), kValueKind_Object, "properties");
+        HAPCharacteristicProperties* p = &characteristic->properties;
+        p->readable = GetBool(HAPNonnull(properties), "readable");
+        p->writable = GetBool(HAPNonnull(properties), "writable");
+        p->supportsEventNotification = GetBool(HAPNonnull(properties), "supportsEventNotification");
+        p->hidden = GetBool(HAPNonnull(properties), "hidden");
+        p->requiresTimedWrite = GetBool(HAPNonnull(properties), "requiresTimedWrite");
+        p->supportsAuthorizationData = GetBool(HAPNonnull(properties), "supportsAuthorizationData");
+        const Value* _Nullable ip = GetMember(HAPNonnull(properties), "ip");
+        if (ip) {
+            ExpectKind(HAPNonnull(ip), kValueKind_Object, "ip");
+            p->ip.controlPoint = GetBool(HAPNonnull(ip), "controlPoint");
+            p->ip.supportsWriteResponse = GetBool(HAPNonnull(ip), "supportsWriteResponse");
+            p->ip.suppressUnchangedEventNotifications =
+                    GetBool(HAPNonnull(ip), "suppressUnchangedEventNotifications");
+            p->ip.cacheable = GetBool(HAPNonnull(ip), "cacheable");
+            CheckMembersAreUsed(HAPNonnull(ip));
+        }
+        const Value* _Nullable ble = GetMember(HAPNonnull(properties), "ble");
+        if (ble) {
+            ExpectKind(HAPNonnull(ble), kValueKind_Object, "ble");
+            p->ble.supportsBroadcastNotification = GetBool(HAPNonnull(ble), "supportsBroadcastNotification");
+            p->ble.supportsDisconnectedNotification = GetBool(HAPNonnull(ble), "supportsDisconnectedNotification");
+            p->ble.readableWithoutSecurity = GetBool(HAPNonnull(ble), "readableWithoutSecurity");
+            p->ble.writableWithoutSecurity = GetBool(HAPNonnull(ble), "writableWithoutSecurity");
+            CheckMembersAreUsed(HAPNonnull(ble));
+        }
+        CheckMembersAreUsed(HAPNonnull(properties));
+    }
+
+    if (characteristic->format->isNumeric) {
+        ParseNumericConstraints(characteristic, object);
+    }
+    if (characteristic->format->maxLength) {
+        characteristic->maxLength = GetUnsignedInteger(object, "maxLength", characteristic->format->maxLength);
+    }
+    characteristic->handleRead = GetIdentifier(object, "handleRead");
+    characteristic->handleWrite = GetIdentifier(object, "handleWrite");
+    if (characteristic->properties.readable && !characteristic->handleRead) {
+        Fail(object->line, "Readable characteristic requires handleRead.");
+    }
+    if (characteristic->properties.writable && !characteristic->handleWrite) {
+        Fail(object->line, "Writable characteristic requires handleWrite.");
+    }
+    CheckMembersAreUsed(object);
+
+    HAPBaseCharacteristic* value = &characteristic->value.base;
+    value->format = characteristic->format->format;
+    value->iid = characteristic->iid;
+    value->characteristicType = GetType(characteristic->typeName, /* isService: */ false);
+    value->debugDescription = characteristic->identifier;
+    value->properties = characteristic->properties;
+
+    AppendItem(&characteristics, characteristic);
+    return characteristic;
+}
+
+HAP_RESULT_USE_CHECK
+static int CompareCharacteristics(const void* item, const void* otherItem) {
+    const Characteristic* characteristic = item;
+    const Characteristic* otherCharacteristic = otherItem;
+    return characteristic->iid < otherCharacteristic->iid ? -1 : characteristic->iid > otherCharacteristic->iid;
+}
+
+HAP_RESULT_USE_CHECK
+static Service* ParseService(const Value* object) {
+    HAPPrecondition(object);
+
+    if (object->kind == kValueKind_String) {
+        for (size_t i = 0; i < services.numItems; i++) {
+            Service* service = GetItem(&services, i);
+            if (HAPStringAreEqual(service->identifier, HAPNonnull(object->text))) {
+                return service;
+            }
+        }
+        Fail(object->line, "Unknown service '%s'.", HAPNonnull(object->text));
+    }
+    ExpectKind(object, kValueKind_Object, "a service");
+
+    Service* service = Allocate(sizeof *service);
+    service->line = object->line;
+    service->identifier = GetRequiredIdentifier(object, "identifier");
+    CheckIdentifierIsUnique(service->identifier, object->line);
+    service->iid = GetUnsignedInteger(object, "iid", UINT16_MAX);
+    if (!service->iid) {
+        Fail(object->line, "Instance ID must not be 0.");
+    }
+    service->typeName = GetRequiredIdentifier(object, "type");
+    service->name = GetString(object, "name");
+    service->primaryService = GetBool(object, "primaryService");
+    service->hidden = GetBool(object, "hidden");
+    service->supportsConfiguration = GetBool(object, "supportsConfiguration");
+
+    const Value* _Nullable linkedServices = GetMember(object, "linkedServices");
+    if (linkedServices) {
+        ExpectKind(HAPNonnull(linkedServices), kValueKind_Array, "linkedServices");
+        for (size_t i = 0; i < HAPNonnull(linkedServices)->numValues; i++) {
+            const Value* linkedService = HAPNonnull(HAPNonnull(linkedServices)->values)[i];
+            ExpectKind(linkedService, kValueKind_String, "a linked service");
+            AppendItem(&service->linkedServices, ParseService(linkedService));
+        }
+    }
+
+    const Value* characteristicValues = GetRequiredMember(object, "characteristics");
+    ExpectKind(characteristicValues, kValueKind_Array, "characteristics");
+    for (size_t i = 0; i < characteristicValues->numValues; i++) {
+        Characteristic* characteristic = ParseCharacteristic(HAPNonnull(characteristicValues->values)[i]);
+        for (size_t j = 0; j < service->characteristics.numItems; j++) {
+            if (GetItem(&service->characteristics, j) == characteristic) {
+                Fail(object->line, "Characteristic '%s' specified multiple times.", characteristic->identifier);
+            }
+        }
+        AppendItem(&service->characteristics, characteristic);
+    }
+    SortItems(&service->characteristics, CompareCharacteristics);
+    CheckMembersAreUsed(object);
+
+    service->value.iid = service->iid;
+    service->value.serviceType = GetType(service->typeName, /* isService: */ true);
+    service->value.debugDescription = service->identifier;
+    service->value.name = service->name;
+    service->value.properties.primaryService = service->primaryService;
+    service->value.properties.hidden = service->hidden;
+    service->value.properties.ble.supportsConfiguration = service->supportsConfiguration;
+    const HAPCharacteristic** characteristicValuesArray =
+            Allocate((service->characteristics.numItems + 1) * sizeof *characteristicValuesArray);
+    for (size_t i = 0; i < service->characteristics.numItems; i++) {
+        Characteristic* characteristic = GetItem(&service->characteristics, i);
+        characteristicValuesArray[i] = &characteristic->value;
+    }
+    service->value.characteristics = characteristicValuesArray;
+
+    AppendItem(&services, service);
+    return service;
+}
+
+HAP_RESULT_USE_CHECK
+static int CompareServices(const void* item, const void* otherItem) {
+    const Service* service = item;
+    const Service* otherService = otherItem;
+    return service->iid < otherService->iid ? -1 : service->iid > otherService->iid;
+}
+
+HAP_RESULT_USE_CHECK
+static int CompareAccessories(const void* item, const void* otherItem) {
+    const Accessory* accessory = item;
+    const Accessory* otherAccessory = otherItem;
+    return accessory->aid < otherAccessory->aid ? -1 : accessory->aid > otherAccessory->aid;
+}
+
+/**
+ * Checks that instance IDs are unique within the accessory and that linked services belong to it.
+ *
+ * @return Whether the characteristics of the accessory are in ascending instance ID order.
+ */
+HAP_RESULT_USE_CHECK
+static bool CheckAccessory(const Accessory* accessory) {
+    HAPPrecondition(accessory);
+
+    uint64_t previousIID = 0;
+    bool isSorted = true;
+    for (size_t i = 0; i < accessory->services.numItems; i++) {
+        const Service* service = GetItem(&accessory->services, i);
+        for (size_t j = 0; j < service->linkedServices.numItems; j++) {
+            const Service* linkedService = GetItem(&service->linkedServices, j);
+            bool isLinkedServiceFound = false;
+            for (size_t k = 0; k < accessory->services.numItems; k++) {
+                isLinkedServiceFound = isLinkedServiceFound || GetItem(&accessory->services, k) == linkedService;
+            }
+            if (!isLinkedServiceFound) {
+                Fail(service->line,
+                     "Linked service '%s' is not a service of accessory %llu.",
+                     linkedService->identifier,
+                     (unsigned long long) accessory->aid);
+            }
+        }
+        for (size_t j = 0; j < service->characteristics.numItems; j++) {
+            const Characteristic* characteristic = GetItem(&service->characteristics, j);
+            if (j && characteristic->iid == previousIID) {
+                Fail(characteristic->line,
+                     "Instance ID %llu used multiple times.",
+                     (unsigned long long) characteristic->iid);
+            }
+            isSorted = isSorted && characteristic->iid > previousIID;
+            previousIID = characteristic->iid;
+        }
+    }
+
+    // Services and characteristics share the instance ID space of the accessory.
+    for (size_t i = 0; i < accessory->services.numItems; i++) {
+        const Service* service = GetItem(&accessory->services, i);
+        for (size_t j = i; j < accessory->services.numItems; j++) {
+            const Service* otherService = GetItem(&accessory->services, j);
+            if (j != i && otherService->iid == service->iid) {
+                Fail(otherService->line, "Instance ID %llu used multiple times.", (unsigned long long) service->iid);
+            }
+            for (size_t k = 0; k < otherService->characteristics.numItems; k++) {
+                const Characteristic* characteristic = GetItem(&otherService->characteristics, k);
+                if (characteristic->iid == service->iid) {
+                    Fail(characteristic->line,
+                         "Instance ID %llu used multiple times.",
+                         (unsigned long long) service->iid);
+                }
+                for (size_t l = 0; j != i && l < service->characteristics.numItems; l++) {
+                    const Characteristic* serviceCharacteristic = GetItem(&service->characteristics, l);
+                    if (serviceCharacteristic->iid == characteristic->iid) {
+                        Fail(characteristic->line,
+                             "Instance ID %llu used multiple times.",
+                             (unsigned long long) characteristic->iid);
+                    }
+                }
+            }
+        }
+    }
+    return isSorted;
+}
+
+HAP_RESULT_USE_CHECK
+static Accessory* ParseAccessory(const Value* object, bool isPrimaryAccessory) {
+    HAPPrecondition(object);
+
+    ExpectKind(object, kValueKind_Object, "an accessory");
+    Accessory* accessory = Allocate(sizeof *accessory);
+    accessory->line = object->line;
+    accessory->identifier = GetIdentifier(object, "identifier");
+    if (accessory->identifier) {
+        CheckIdentifierIsUnique(HAPNonnull(accessory->identifier), object->line);
+    }
+    accessory->aid = GetUnsignedInteger(object, "aid", UINT64_MAX);
+    if (isPrimaryAccessory ? accessory->aid != kHAPIPAccessoryProtocolAID_PrimaryAccessory :
+                             accessory->aid == kHAPIPAccessoryProtocolAID_PrimaryAccessory || !accessory->aid) {
+        Fail(object->line,
+             "The primary accessory must have accessory instance ID 1 and be the first accessory, "
+             "bridged accessories must have other accessory instance IDs.");
+    }
+    accessory->categoryName = GetIdentifier(object, "category");
+    accessory->name = GetString(object, "name");
+    accessory->manufacturer = GetString(object, "manufacturer");
+    accessory->model = GetString(object, "model");
+    accessory->serialNumber = GetString(object, "serialNumber");
+    accessory->firmwareVersion = GetString(object, "firmwareVersion");
+    accessory->hardwareVersion = GetString(object, "hardwareVersion");
+    accessory->identify = GetIdentifier(object, "identify");
+    if (accessory->identifier &&
+        (!accessory->categoryName || !accessory->name || !accessory->manufacturer || !accessory->model ||
+         !accessory->serialNumber || !accessory->firmwareVersion || !accessory->identify)) {
+        Fail(object->line,
+             "Accessories with identifier require category, name, manufacturer, model, serialNumber, "
+             "firmwareVersion and identify.");
+    }
+
+    const Value* serviceValues = GetRequiredMember(object, "services");
+    ExpectKind(serviceValues, kValueKind_Array, "services");
+    for (size_t i = 0; i < serviceValues->numValues; i++) {
+        Service* service = ParseService(HAPNonnull(serviceValues->values)[i]);
+        for (size_t j = 0; j < accessory->services.numItems; j++) {
+            if (GetItem(&accessory->services, j) == service) {
+                Fail(object->line, "Service '%s' specified multiple times.", service->identifier);
+            }
+        }
+        AppendItem(&accessory->services, service);
+    }
+    SortItems(&accessory->services, CompareServices);
+    CheckMembersAreUsed(object);
+
+    if (!CheckAccessory(accessory)) {
+        fprintf(stderr,
+                "%s:%zu: warning: Instance IDs of accessory %llu are not ascending in service order. "
+                "The characteristic index will be sorted when the accessory server starts.\n",
+                inputPath,
+                object->line,
+                (unsigned long long) accessory->aid);
+    }
+
+    accessory->value.aid = accessory->aid;
+    const HAPService** serviceValuesArray = Allocate((accessory->services.numItems + 1) * sizeof *serviceValuesArray);
+    for (size_t i = 0; i < accessory->services.numItems; i++) {
+        Service* service = GetItem(&accessory->services, i);
+        serviceValuesArray[i] = &service->value;
+    }
+    accessory->value.services = serviceValuesArray;
+
+    return accessory;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/** Generated code. */
+static Text output;
+
+static void Emit(size_t indentation, const char* format, ...) HAP_PRINTFLIKE(2, 3);
+
+/**
+ * Emits a line of generated code.
+ *
+ * @param      indentation          Number of spaces.
+ * @param      format               Format string.
+ */
+static void Emit(size_t indentation, const char* format, ...) {
+    HAPPrecondition(format);
+
+    for (size_t i = 0; i < indentation; i++) {
+        AppendBytes(&output, " ", 1);
+    }
+    char bytes[1024];
+    va_list args;
+    va_start(args, format);
+    int numBytes = vsnprintf(bytes, sizeof bytes, format, args);
+    va_end(args);
+    if (numBytes < 0 || (size_t) numBytes >= sizeof bytes) {
+        Fail(0, "Generated line too long.");
+    }
+    AppendBytes(&output, bytes, (size_t) numBytes);
+    AppendBytes(&output, "\n", 1);
+}
+
+/**
+ * Emits an empty line.
+ */
+static void EmitEmptyLine(void) {
+    AppendBytes(&output, "\n", 1);
+}
+
+/** Column limit of generated code. */
+#define kMaxLineLength ((size_t) 120)
+
+/**
+ * Emits a braced list initializer. Elements are moved to separate lines if the list does not fit on one line.
+ *
+ * @param      indentation          Number of spaces.
+ * @param      prefix               Text before the opening brace.
+ * @param      elements             Elements.
+ * @param      numElements          Number of elements.
+ * @param      suffix               Text after the closing brace.
+ */
+static void EmitList(
+        size_t indentation,
+        const char* prefix,
+        const char* const* elements,
+        size_t numElements,
+        const char* suffix) {
+    HAPPrecondition(prefix);
+    HAPPrecondition(elements);
+    HAPPrecondition(suffix);
+
+    Text text = { 0 };
+    AppendFormat(&text, "%s{ ", prefix);
+    for (size_t i = 0; i < numElements; i++) {
+        AppendFormat(&text, "%s%s", i ? ", " : "", elements[i]);
+    }
+    AppendFormat(&text, " }%s", suffix);
+    if (indentation + text.numBytes <= kMaxLineLength) {
+        Emit(indentation, "%s", HAPNonnull(text.bytes));
+    } else {
+        size_t elementIndentation = indentation + HAPStringGetNumBytes(prefix) + HAPStringGetNumBytes("{ ");
+        for (size_t i = 0; i < numElements; i++) {
+            if (!i) {
+                Emit(indentation, "%s{ %s,", prefix, elements[i]);
+            } else if (i == numElements - 1) {
+                Emit(elementIndentation, "%s }%s", elements[i], suffix);
+            } else {
+                Emit(elementIndentation, "%s,", elements[i]);
+            }
+        }
+    }
+    free(text.bytes);
+}
+
+/**
+ * Returns a C string literal for a string, or NULL.
+ */
+HAP_RESULT_USE_CHECK
+static char* GetStringLiteral(const char* _Nullable string) {
+    Text text = { 0 };
+    if (!string) {
+        AppendBytes(&text, "NULL", 4);
+        return HAPNonnull(text.bytes);
+    }
+    AppendBytes(&text, "\"", 1);
+    for (const char* c = HAPNonnull(string); *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            AppendFormat(&text, "\\%c", *c);
+        } else if (*c == '\n') {
+            AppendBytes(&text, "\\n", 2);
+        } else if (*c == '\t') {
+            AppendBytes(&text, "\\t", 2);
+        } else {
+            AppendBytes(&text, c, 1);
+        }
+    }
+    AppendBytes(&text, "\"", 1);
+    return HAPNonnull(text.bytes);
+}
+
+HAP_RESULT_USE_CHECK
+static const char* GetBoolLiteral(bool value) {
+    return value ? "true" : "false";
+}
+
+/**
+ * Returns the C expression for a constraint value of a numeric characteristic.
+ */
+HAP_RESULT_USE_CHECK
+static char* GetNumericLiteral(const Format* format, const Value* _Nullable value) {
+    HAPPrecondition(format);
+
+    Text text = { 0 };
+    if (!value) {
+        AppendBytes(&text, "0", 1);
+    } else if (format->format == kHAPCharacteristicFormat_Float) {
+        const char* valueText = HAPNonnull(HAPNonnull(value)->text);
+        bool isInteger = true;
+        for (const char* c = valueText; *c; c++) {
+            isInteger = isInteger && *c != '.' && *c != 'e' && *c != 'E';
+        }
+        AppendFormat(&text, "%s%sF", valueText, isInteger ? ".0" : "");
+    } else {
+        int64_t integerValue = GetIntegerValue(HAPNonnull(value), "value", format->minimumValue, format->maximumValue);
+        if (format->minimumValueName && integerValue == format->minimumValue) {
+            AppendFormat(&text, "%s", HAPNonnull(format->minimumValueName));
+        } else if (format->minimumValue < 0 ? integerValue == (int64_t) format->maximumValue :
+                                              (uint64_t) integerValue == format->maximumValue) {
+            AppendFormat(&text, "%s", HAPNonnull(format->maximumValueName));
+        } else if (format->minimumValue < 0) {
+            AppendFormat(&text, "%lld", (long long) integerValue);
+        } else {
+            AppendFormat(&text, "%llu", (unsigned long long) (uint64_t) integerValue);
+        }
+    }
+    return HAPNonnull(text.bytes);
+}
+
+static void EmitCharacteristic(const Characteristic* characteristic) {
+    HAPPrecondition(characteristic);
+
+    const Format* format = characteristic->format;
+    const HAPCharacteristicProperties* p = &characteristic->properties;
+    Emit(0, "const HAP%sCharacteristic %s = {", format->typeName, characteristic->identifier);
+    Emit(4, ".format = kHAPCharacteristicFormat_%s,", format->typeName);
+    Emit(4, ".iid = 0x%04llX,", (unsigned long long) characteristic->iid);
+    Emit(4, ".characteristicType = &kHAPCharacteristicType_%s,", characteristic->typeName);
+    Emit(4, ".debugDescription = kHAPCharacteristicDebugDescription_%s,", characteristic->typeName);
+    Emit(4, ".manufacturerDescription = %s,", GetStringLiteral(characteristic->manufacturerDescription));
+    Emit(4, ".properties = { .readable = %s,", GetBoolLiteral(p->readable));
+    Emit(20, ".writable = %s,", GetBoolLiteral(p->writable));
+    Emit(20, ".supportsEventNotification = %s,", GetBoolLiteral(p->supportsEventNotification));
+    Emit(20, ".hidden = %s,", GetBoolLiteral(p->hidden));
+    Emit(20, ".requiresTimedWrite = %s,", GetBoolLiteral(p->requiresTimedWrite));
+    Emit(20, ".supportsAuthorizationData = %s,", GetBoolLiteral(p->supportsAuthorizationData));
+    Emit(20, ".ip = { .controlPoint = %s,", GetBoolLiteral(p->ip.controlPoint));
+    Emit(28, ".supportsWriteResponse = %s,", GetBoolLiteral(p->ip.supportsWriteResponse));
+    Emit(28,
+         ".suppressUnchangedEventNotifications = %s,",
+         GetBoolLiteral(p->ip.suppressUnchangedEventNotifications));
+    Emit(28, ".cacheable = %s },", GetBoolLiteral(p->ip.cacheable));
+    Emit(20, ".ble = { .supportsBroadcastNotification = %s,", GetBoolLiteral(p->ble.supportsBroadcastNotification));
+    Emit(29, ".supportsDisconnectedNotification = %s,", GetBoolLiteral(p->ble.supportsDisconnectedNotification));
+    Emit(29, ".readableWithoutSecurity = %s,", GetBoolLiteral(p->ble.readableWithoutSecurity));
+    Emit(29, ".writableWithoutSecurity = %s } },", GetBoolLiteral(p->ble.writableWithoutSecurity));
+    if (format->isNumeric) {
+        Emit(4, ".units = kHAPCharacteristicUnits_%s,", characteristic->unitsName ? characteristic->unitsName : "None");
+        Emit(4, ".constraints = { .minimumValue = %s,", GetNumericLiteral(format, characteristic->minimumValue));
+        Emit(21, ".maximumValue = %s,", GetNumericLiteral(format, characteristic->maximumValue));
+        if (format->format == kHAPCharacteristicFormat_UInt8) {
+            Emit(21, ".stepValue = %s,", GetNumericLiteral(format, characteristic->stepValue));
+            Emit(21, ".validValues = NULL,");
+            Emit(21, ".validValuesRanges = NULL },");
+        } else {
+            Emit(21, ".stepValue = %s },", GetNumericLiteral(format, characteristic->stepValue));
+        }
+    }
+    if (format->maxLength) {
+        Emit(4, ".constraints = { .maxLength = %llu },", (unsigned long long) characteristic->maxLength);
+    }
+    const char* callbacks[] = {
+        characteristic->handleRead ? HAPNonnull(characteristic->handleRead) : "NULL",
+        characteristic->handleWrite ? HAPNonnull(characteristic->handleWrite) : "NULL",
+    };
+    Text handleRead = { 0 };
+    Text handleWrite = { 0 };
+    AppendFormat(&handleRead, ".handleRead = %s", callbacks[0]);
+    AppendFormat(&handleWrite, ".handleWrite = %s", callbacks[1]);
+    const char* elements[] = { HAPNonnull(handleRead.bytes), HAPNonnull(handleWrite.bytes) };
+    EmitList(4, ".callbacks = ", elements, HAPArrayCount(elements), "");
+    Emit(0, "};");
+    EmitEmptyLine();
+    free(handleRead.bytes);
+    free(handleWrite.bytes);
+}
+
+static void EmitService(const Service* service) {
+    HAPPrecondition(service);
+
+    Emit(0, "const HAPService %s = {", service->identifier);
+    Emit(4, ".iid = 0x%04llX,", (unsigned long long) service->iid);
+    Emit(4, ".serviceType = &kHAPServiceType_%s,", service->typeName);
+    Emit(4, ".debugDescription = kHAPServiceDebugDescription_%s,", service->typeName);
+    Emit(4, ".name = %s,", GetStringLiteral(service->name));
+    Emit(4,
+         ".properties = { .primaryService = %s, .hidden = %s, .ble = { .supportsConfiguration = %s } },",
+         GetBoolLiteral(service->primaryService),
+         GetBoolLiteral(service->hidden),
+         GetBoolLiteral(service->supportsConfiguration));
+    if (service->linkedServices.numItems) {
+        char** elements = Allocate((service->linkedServices.numItems + 1) * sizeof *elements);
+        for (size_t i = 0; i < service->linkedServices.numItems; i++) {
+            const Service* linkedService = GetItem(&service->linkedServices, i);
+            Text text = { 0 };
+            AppendFormat(&text, "0x%04llX", (unsigned long long) linkedService->iid);
+            elements[i] = HAPNonnull(text.bytes);
+        }
+        elements[service->linkedServices.numItems] = CopyString("0", 1);
+        EmitList(4,
+                 ".linkedServices = (const uint16_t[]) ",
+                 (const char* const*) elements,
+                 service->linkedServices.numItems + 1,
+                 ",");
+    } else {
+        Emit(4, ".linkedServices = NULL,");
+    }
+    char** elements = Allocate((service->characteristics.numItems + 1) * sizeof *elements);
+    for (size_t i = 0; i < service->characteristics.numItems; i++) {
+        const Characteristic* characteristic = GetItem(&service->characteristics, i);
+        Text text = { 0 };
+        AppendFormat(&text, "&%s", characteristic->identifier);
+        elements[i] = HAPNonnull(text.bytes);
+    }
+    elements[service->characteristics.numItems] = CopyString("NULL", 4);
+    EmitList(4,
+             ".characteristics = (const HAPCharacteristic* const[]) ",
+             (const char* const*) elements,
+             service->characteristics.numItems + 1,
+             "");
+    Emit(0, "};");
+    EmitEmptyLine();
+}
+
+static void EmitAccessory(const Accessory* accessory) {
+    HAPPrecondition(accessory);
+    HAPPrecondition(accessory->identifier);
+
+    Emit(0, "const HAPAccessory %s = {", HAPNonnull(accessory->identifier));
+    Emit(4, ".aid = %llu,", (unsigned long long) accessory->aid);
+    Emit(4, ".category = kHAPAccessoryCategory_%s,", HAPNonnull(accessory->categoryName));
+    Emit(4, ".name = %s,", GetStringLiteral(accessory->name));
+    Emit(4, ".manufacturer = %s,", GetStringLiteral(accessory->manufacturer));
+    Emit(4, ".model = %s,", GetStringLiteral(accessory->model));
+    Emit(4, ".serialNumber = %s,", GetStringLiteral(accessory->serialNumber));
+    Emit(4, ".firmwareVersion = %s,", GetStringLiteral(accessory->firmwareVersion));
+    Emit(4, ".hardwareVersion = %s,", GetStringLiteral(accessory->hardwareVersion));
+    char** elements = Allocate((accessory->services.numItems + 1) * sizeof *elements);
+    for (size_t i = 0; i < accessory->services.numItems; i++) {
+        const Service* service = GetItem(&accessory->services, i);
+        Text text = { 0 };
+        AppendFormat(&text, "&%s", service->identifier);
+        elements[i] = HAPNonnull(text.bytes);
+    }
+    elements[accessory->services.numItems] = CopyString("NULL", 4);
+    EmitList(4,
+             ".services = (const HAPService* const[]) ",
+             (const char* const*) elements,
+             accessory->services.numItems + 1,
+             ",");
+    Emit(4, ".callbacks = { .identify = %s }", HAPNonnull(accessory->identify));
+    Emit(0, "};");
+    EmitEmptyLine();
+}
+
+/**
+ * Emits the generated file.
+ *
+ * @param      inputName            Name of the input file.
+ * @param      prefix               Prefix of the storage sizing constants.
+ * @param      bridgedAccessoriesIdentifier Identifier of the bridged accessories array, if any.
+ */
+static void EmitFile(const char* inputName, const char* prefix, const char* _Nullable bridgedAccessoriesIdentifier) {
+    HAPPrecondition(inputName);
+    HAPPrecondition(prefix);
+
+    // Storage sizing constants.
+    const Accessory* primaryAccessory = GetItem(&accessories, 0);
+    const HAPAccessory** bridgedAccessories = Allocate(accessories.numItems * sizeof *bridgedAccessories);
+    for (size_t i = 1; i < accessories.numItems; i++) {
+        const Accessory* accessory = GetItem(&accessories, i);
+        bridgedAccessories[i - 1] = &accessory->value;
+    }
+    HAPAccessoryServerStorageUsage requirements;
+    HAPAccessoryServerGetStorageRequirements(&primaryAccessory->value, bridgedAccessories, &requirements);
+    size_t numAttributes = 0;
+    for (size_t i = 0; i < accessories.numItems; i++) {
+        const Accessory* accessory = GetItem(&accessories, i);
+        for (size_t j = 0; j < accessory->services.numItems; j++) {
+            const Service* service = GetItem(&accessory->services, j);
+            numAttributes += 1 + service->characteristics.numItems;
+        }
+    }
+
+    Emit(0, "// Copyright (c) 2015-2019 The HomeKit ADK Contributors");
+    Emit(0, "//");
+    Emit(0, "// Licensed under the Apache License, Version 2.0 (the “License”);");
+    Emit(0, "// you may not use this file except in compliance with the License.");
+    Emit(0, "// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.");
+    EmitEmptyLine();
+    Emit(0, "// Generated by AccessoryDatabaseGenerator from %s. Do not edit.", inputName);
+    Emit(0, "//");
+    Emit(0, "// Include in one translation unit after the callbacks referenced by the database have been declared.");
+    EmitEmptyLine();
+    Emit(0, "/** Total number of services and characteristics of all accessories. */");
+    Emit(0, "#define k%s_AttributeCount ((size_t) %zu)", prefix, numAttributes);
+    EmitEmptyLine();
+    Emit(0, "/** Number of IP read contexts, write contexts and characteristic index elements. */");
+    Emit(0,
+         "#define k%s_NumIPCharacteristicIndexElements ((size_t) %zu)",
+         prefix,
+         requirements.ip.numCharacteristicIndexElements);
+    EmitEmptyLine();
+    Emit(0, "/** Number of event notification elements per IP session. */");
+    Emit(0, "#define k%s_NumIPEventNotifications ((size_t) %zu)", prefix, requirements.ip.numEventNotifications);
+    EmitEmptyLine();
+    Emit(0, "/** Number of IP characteristic value cache elements. */");
+    Emit(0, "#define k%s_NumIPValueCacheElements ((size_t) %zu)", prefix, requirements.ip.numValueCacheElements);
+    EmitEmptyLine();
+    Emit(0, "/** Number of BLE GATT table elements. */");
+    Emit(0, "#define k%s_NumBLEGATTTableElements ((size_t) %zu)", prefix, requirements.ble.numGATTTableElements);
+    EmitEmptyLine();
+
+    for (size_t i = 0; i < characteristics.numItems; i++) {
+        EmitCharacteristic(GetItem(&characteristics, i));
+    }
+    for (size_t i = 0; i < services.numItems; i++) {
+        EmitService(GetItem(&services, i));
+    }
+    for (size_t i = 0; i < accessories.numItems; i++) {
+        const Accessory* accessory = GetItem(&accessories, i);
+        if (accessory->identifier) {
+            EmitAccessory(accessory);
+        }
+    }
+    if (bridgedAccessoriesIdentifier) {
+        char** elements = Allocate(accessories.numItems * sizeof *elements);
+        for (size_t i = 1; i < accessories.numItems; i++) {
+            const Accessory* accessory = GetItem(&accessories, i);
+            Text text = { 0 };
+            AppendFormat(&text, "&%s", HAPNonnull(accessory->identifier));
+            elements[i - 1] = HAPNonnull(text.bytes);
+        }
+        elements[accessories.numItems - 1] = CopyString("NULL", 4);
+        Text prefixText = { 0 };
+        AppendFormat(
+                &prefixText, "const HAPAccessory* _Nullable const %s[] = ", HAPNonnull(bridgedAccessoriesIdentifier));
+        EmitList(0, HAPNonnull(prefixText.bytes), (const char* const*) elements, accessories.numItems, ";");
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+HAP_RESULT_USE_CHECK
+static bool ReadFile(const char* path, char* _Nullable* _Nonnull bytes, size_t* numBytes) {
+    HAPPrecondition(path);
+    HAPPrecondition(bytes);
+    HAPPrecondition(numBytes);
+
+    *bytes = NULL;
+    *numBytes = 0;
+
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+    Text text = { 0 };
+    for (;;) {
+        char buffer[4096];
+        size_t numBufferBytes = fread(buffer, 1, sizeof buffer, file);
+        if (!numBufferBytes) {
+            break;
+        }
+        AppendBytes(&text, buffer, numBufferBytes);
+    }
+    bool ok = !ferror(file);
+    fclose(file);
+    if (!ok) {
+        free(text.bytes);
+        return false;
+    }
+    *bytes = text.bytes ? text.bytes : CopyString("", 0);
+    *numBytes = text.numBytes;
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    const char* _Nullable outputPath = NULL;
+    bool isCheck = false;
+    int i = 1;
+    for (; i < argc - 1; i += 2) {
+        if (HAPStringAreEqual(argv[i], "-o")) {
+            outputPath = argv[i + 1];
+        } else if (HAPStringAreEqual(argv[i], "--check")) {
+            outputPath = argv[i + 1];
+            isCheck = true;
+        } else {
+            break;
+        }
+    }
+    if (i != argc - 1) {
+        fprintf(stderr,
+                "Usage: AccessoryDatabaseGenerator [-o OUTPUT | --check GOLDEN] INPUT\n"
+                "\n"
+                "Generates a const accessory attribute database and storage sizing constants from the JSON\n"
+                "description in INPUT. With --check, compares the generated code against GOLDEN instead.\n");
+        return EXIT_FAILURE;
+    }
+    inputPath = argv[i];
+
+    char* _Nullable inputBytes;
+    size_t numInputBytes;
+    if (!ReadFile(inputPath, &inputBytes, &numInputBytes)) {
+        Fail(0, "Cannot read file.");
+    }
+    Parser parser = { .bytes = HAPNonnull(inputBytes), .numBytes = numInputBytes, .line = 1 };
+    const Value* root = ParseValue(&parser);
+    SkipWhitespace(&parser);
+    if (parser.position != parser.numBytes) {
+        Fail(parser.line, "Unexpected text after the database description.");
+    }
+    ExpectKind(root, kValueKind_Object, "the database description");
+    const char* prefix = GetRequiredIdentifier(root, "prefix");
+    const char* _Nullable bridgedAccessoriesIdentifier = GetIdentifier(root, "bridgedAccessories");
+    const Value* accessoryValues = GetRequiredMember(root, "accessories");
+    ExpectKind(accessoryValues, kValueKind_Array, "accessories");
+    if (!accessoryValues->numValues) {
+        Fail(accessoryValues->line, "Expected at least one accessory.");
+    }
+    for (size_t j = 0; j < accessoryValues->numValues; j++) {
+        Accessory* accessory = ParseAccessory(HAPNonnull(accessoryValues->values)[j], /* isPrimaryAccessory: */ !j);
+        for (size_t k = 0; k < accessories.numItems; k++) {
+            if (((const Accessory*) GetItem(&accessories, k))->aid == accessory->aid) {
+                Fail(accessory->line,
+                     "Accessory instance ID %llu used multiple times.",
+                     (unsigned long long) accessory->aid);
+            }
+        }
+        if (j && bridgedAccessoriesIdentifier && !accessory->identifier) {
+            Fail(accessory->line, "Bridged accessories require an identifier.");
+        }
+        AppendItem(&accessories, accessory);
+    }
+    CheckMembersAreUsed(root);
+    if (accessories.numItems > 1 && !bridgedAccessoriesIdentifier) {
+        Fail(root->line, "Missing member 'bridgedAccessories'.");
+    }
+    if (accessories.numItems == 1 && bridgedAccessoriesIdentifier) {
+        Fail(root->line, "'bridgedAccessories' requires bridged accessories.");
+    }
+
+    // Keep the primary accessory first.
+    Array bridgedAccessories = { 0 };
+    for (size_t j = 1; j < accessories.numItems; j++) {
+        AppendItem(&bridgedAccessories, GetItem(&accessories, j));
+    }
+    SortItems(&bridgedAccessories, CompareAccessories);
+    for (size_t j = 0; j < bridgedAccessories.numItems; j++) {
+        HAPNonnull(accessories.items)[j + 1] = GetItem(&bridgedAccessories, j);
+    }
+
+    const char* inputName = inputPath;
+    for (const char* c = inputPath; *c; c++) {
+        if (*c == '/' || *c == '\\') {
+            inputName = c + 1;
+        }
+    }
+    EmitFile(inputName, prefix, bridgedAccessoriesIdentifier);
+
+    if (isCheck) {
+        char* _Nullable goldenBytes;
+        size_t numGoldenBytes;
+        if (!ReadFile(HAPNonnull(outputPath), &goldenBytes, &numGoldenBytes)) {
+            fprintf(stderr, "%s: error: Cannot read file.\n", HAPNonnull(outputPath));
+            return EXIT_FAILURE;
+        }
+        if (numGoldenBytes != output.numBytes ||
+            !HAPRawBufferAreEqual(HAPNonnull(goldenBytes), HAPNonnull(output.bytes), output.numBytes)) {
+            fprintf(stderr,
+                    "%s: error: Generated code differs. Regenerate with: AccessoryDatabaseGenerator -o %s %s\n",
+                    HAPNonnull(outputPath),
+                    HAPNonnull(outputPath),
+                    inputPath);
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    FILE* file = outputPath ? fopen(HAPNonnull(outputPath), "wb") : stdout;
+    if (!file) {
+        fprintf(stderr, "%s: error: Cannot write file.\n", HAPNonnull(outputPath));
+        return EXIT_FAILURE;
+    }
+    bool ok = fwrite(HAPNonnull(output.bytes), 1, output.numBytes, file) == output.numBytes;
+    if (outputPath) {
+        ok = !fclose(file) && ok;
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,365 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+// Decodes binary logs that have been captured by an executable that was built with HAP_LOG_BINARY set.
+//
+// Format, subsystem and category strings are not part of the log. They are read from the executable that produced
+// the log, which must be the exact same build. Only little-endian ELF executables are supported.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "HAP+Internal.h"
+
+// ELF definitions. <elf.h> is not available on all hosts.
+#define kELF_Magic            "\x7F" "ELF"
+#define kELF_ClassIndex       4
+#define kELF_Class32          1
+#define kELF_Class64          2
+#define kELF_DataIndex        5
+#define kELF_DataLittleEndian 1
+#define kELF_IdentNumBytes    16
+#define kELF_SectionProgBits  1
+
+/**
+ * Loaded section of the executable.
+ */
+typedef struct {
+    /** Virtual address of the section. */
+    uint64_t address;
+
+    /** Offset of the section in the executable file. */
+    uint64_t offset;
+
+    /** Size of the section. */
+    uint64_t size;
+} Section;
+
+/**
+ * Loaded executable.
+ */
+typedef struct {
+    const uint8_t* bytes;
+    size_t numBytes;
+    Section* sections;
+    size_t numSections;
+    uint64_t formatSectionAddress;
+} Executable;
+
+static void Fail(const char* format, ...) HAP_PRINTFLIKE(1, 2);
+
+/**
+ * Reports an error and terminates the program.
+ *
+ * @param      format               Format string.
+ */
+static void Fail(const char* format, ...) {
+    HAPPrecondition(format);
+
+    fprintf(stderr, "LogDecoder: error: ");
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fprintf(stderr, "\n");
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * Reads a file into memory.
+ *
+ * @param      file                 File.
+ * @param[out] bytes                File contents. Must be freed by the caller.
+ * @param[out] numBytes             Length of the file contents.
+ *
+ * @return true                     If successful.
+ * @return false                    If the file could not be read.
+ */
+HAP_RESULT_USE_CHECK
+static bool ReadFile(FILE* file, uint8_t* _Nullable* _Nonnull bytes, size_t* numBytes) {
+    HAPPrecondition(file);
+    HAPPrecondition(bytes);
+    HAPPrecondition(numBytes);
+
+    *bytes = NULL;
+    *numBytes = 0;
+    size_t maxBytes = 0;
+    for (;;) {
+        if (*numBytes == maxBytes) {
+            maxBytes = maxBytes ? 2 * maxBytes : 64 * 1024;
+            uint8_t* _Nullable newBytes = realloc(*bytes, maxBytes);
+            if (!newBytes) {
+                Fail("Out of memory.");
+            }
+            *bytes = newBytes;
+        }
+        size_t n = fread(&(*bytes)[*numBytes], 1, maxBytes - *numBytes, file);
+        if (!n) {
+            break;
+        }
+        *numBytes += n;
+    }
+    return !ferror(file);
+}
+
+/**
+ * Reads an unsigned little-endian integer from the executable.
+ *
+ * @param      executable           Executable.
+ * @param      offset               Offset of the integer.
+ * @param      numBytes             Size of the integer.
+ *
+ * @return Integer.
+ */
+HAP_RESULT_USE_CHECK
+static uint64_t ReadInteger(const Executable* executable, uint64_t offset, size_t numBytes) {
+    HAPPrecondition(executable);
+
+    if (offset > executable->numBytes || numBytes > executable->numBytes - offset) {
+        Fail("Executable is truncated.");
+    }
+    uint64_t value = 0;
+    for (size_t i = 0; i < numBytes; i++) {
+        value |= (uint64_t) executable->bytes[offset + i] << (8 * i);
+    }
+    return value;
+}
+
+/**
+ * Loads the section table of an ELF executable.
+ *
+ * @param      executable           Executable.
+ */
+static void LoadSections(Executable* executable) {
+    HAPPrecondition(executable);
+
+    if (executable->numBytes < kELF_IdentNumBytes ||
+        !HAPRawBufferAreEqual(executable->bytes, kELF_Magic, sizeof kELF_Magic - 1)) {
+        Fail("Not an ELF executable.");
+    }
+    if (executable->bytes[kELF_DataIndex] != kELF_DataLittleEndian) {
+        Fail("Only little-endian executables are supported.");
+    }
+    bool is64Bit = executable->bytes[kELF_ClassIndex] == kELF_Class64;
+    if (!is64Bit && executable->bytes[kELF_ClassIndex] != kELF_Class32) {
+        Fail("Unsupported ELF class.");
+    }
+    size_t numAddressBytes = is64Bit ? 8 : 4;
+
+    // ELF header.
+    uint64_t sectionTableOffset = ReadInteger(executable, is64Bit ? 0x28 : 0x20, numAddressBytes);
+    uint64_t numSectionHeaderBytes = ReadInteger(executable, is64Bit ? 0x3A : 0x2E, 2);
+    uint64_t numSectionHeaders = ReadInteger(executable, is64Bit ? 0x3C : 0x30, 2);
+    uint64_t sectionNamesIndex = ReadInteger(executable, is64Bit ? 0x3E : 0x32, 2);
+    if (!numSectionHeaders || sectionNamesIndex >= numSectionHeaders) {
+        Fail("Executable does not contain section names.");
+    }
+
+    // Section headers: name, type, flags, address, offset, size.
+    uint64_t sectionNamesOffset = ReadInteger(
+            executable,
+            sectionTableOffset + sectionNamesIndex * numSectionHeaderBytes + 8 + 2 * numAddressBytes,
+            numAddressBytes);
+
+    executable->sections = calloc(numSectionHeaders, sizeof(Section));
+    if (!executable->sections) {
+        Fail("Out of memory.");
+    }
+    bool hasFormatSection = false;
+    for (uint64_t i = 0; i < numSectionHeaders; i++) {
+        uint64_t header = sectionTableOffset + i * numSectionHeaderBytes;
+        uint64_t nameOffset = ReadInteger(executable, header, 4);
+        uint64_t type = ReadInteger(executable, header + 4, 4);
+        uint64_t address = ReadInteger(executable, header + 8 + numAddressBytes, numAddressBytes);
+        uint64_t offset = ReadInteger(executable, header + 8 + 2 * numAddressBytes, numAddressBytes);
+        uint64_t size = ReadInteger(executable, header + 8 + 3 * numAddressBytes, numAddressBytes);
+        if (type != kELF_SectionProgBits || !address) {
+            continue;
+        }
+        if (offset > executable->numBytes || size > executable->numBytes - offset) {
+            Fail("Executable is truncated.");
+        }
+        executable->sections[executable->numSections++] =
+                (Section) { .address = address, .offset = offset, .size = size };
+
+        uint64_t nameAddress = sectionNamesOffset + nameOffset;
+        const char* name = (const char*) &executable->bytes[nameAddress];
+        size_t numNameBytes = sizeof kHAPLogBinaryFormatSection;
+        if (nameAddress <= executable->numBytes && numNameBytes <= executable->numBytes - nameAddress &&
+            HAPRawBufferAreEqual(name, kHAPLogBinaryFormatSection, numNameBytes)) {
+            executable->formatSectionAddress = address;
+            hasFormatSection = true;
+        }
+    }
+    if (!hasFormatSection) {
+        Fail("Executable does not contain binary log format strings. Was it built with HAP_LOG_BINARY?");
+    }
+}
+
+/**
+ * Resolves a string that is referenced by a binary log record.
+ *
+ * @param      context              Executable.
+ * @param      offset               Offset of the string relative to the start of the format string section.
+ *
+ * @return String, if it could be resolved. NULL otherwise.
+ */
+static const char* _Nullable ResolveString(void* _Nullable context, int64_t offset) {
+    HAPPrecondition(context);
+    const Executable* executable = context;
+
+    uint64_t address = executable->formatSectionAddress + (uint64_t) offset;
+    for (size_t i = 0; i < executable->numSections; i++) {
+        const Section* section = &executable->sections[i];
+        if (address < section->address || address - section->address >= section->size) {
+            continue;
+        }
+        const char* string = (const char*) &executable->bytes[section->offset + (address - section->address)];
+        size_t maxStringBytes = (size_t)(section->size - (address - section->address));
+        for (size_t j = 0; j < maxStringBytes; j++) {
+            if (!string[j]) {
+                return string;
+            }
+        }
+        return NULL;
+    }
+    return NULL;
+}
+
+/**
+ * Prints a decoded log record, using the same layout as the POSIX platform log.
+ *
+ * @param      record               Decoded log record.
+ */
+static void PrintRecord(const HAPLogBinaryRecord* record) {
+    HAPPrecondition(record);
+
+    if (record->recordType == kHAPLogBinaryRecordType_Dropped) {
+        printf("<%llu log messages dropped>\n", (unsigned long long) record->numDroppedMessages);
+        return;
+    }
+
+    printf("%8llu.%03llu\t",
+           (unsigned long long) (record->time / HAPSecond),
+           (unsigned long long) (record->time % HAPSecond));
+    switch (record->type) {
+        case kHAPLogType_Debug: {
+            printf("Debug");
+        } break;
+        case kHAPLogType_Info: {
+            printf("Info");
+        } break;
+        case kHAPLogType_Default: {
+            printf("Default");
+        } break;
+        case kHAPLogType_Error: {
+            printf("Error");
+        } break;
+        case kHAPLogType_Fault: {
+            printf("Fault");
+        } break;
+    }
+    printf("\t");
+    if (record->subsystem) {
+        printf("[%s", record->subsystem);
+        if (record->category) {
+            printf(":%s", record->category);
+        }
+        printf("] ");
+    }
+    printf("%s\n", HAPNonnull(record->message));
+
+    if (record->bufferBytes) {
+        const uint8_t* b = record->bufferBytes;
+        size_t length = record->numBufferBytes;
+        if (length == 0) {
+            printf("\n");
+        } else {
+            size_t i = 0;
+            do {
+                printf("    %04zx ", i);
+                for (size_t n = 0; n != 8 * 4; n++) {
+                    if (n % 4 == 0) {
+                        printf(" ");
+                    }
+                    if ((n <= length) && (i < length - n)) {
+                        printf("%02x", b[i + n]);
+                    } else {
+                        printf("  ");
+                    }
+                }
+                printf("    ");
+                for (size_t n = 0; n != 8 * 4; n++) {
+                    if (i != length) {
+                        printf("%c", (32 <= b[i]) && (b[i] < 127) ? b[i] : '.');
+                        i++;
+                    }
+                }
+                printf("\n");
+            } while (i != length);
+        }
+        if (record->numTruncatedBufferBytes) {
+            printf("    <%zu bytes truncated>\n", record->numTruncatedBufferBytes);
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 2 && argc != 3) {
+        fprintf(stderr,
+                "Usage: LogDecoder EXECUTABLE [LOG]\n"
+                "\n"
+                "Decodes the binary log LOG, or standard input, that has been captured by EXECUTABLE.\n"
+                "EXECUTABLE must have been built with HAP_LOG_BINARY set.\n");
+        return EXIT_FAILURE;
+    }
+
+    Executable executable;
+    HAPRawBufferZero(&executable, sizeof executable);
+    FILE* file = fopen(argv[1], "rb");
+    uint8_t* _Nullable executableBytes;
+    if (!file || !ReadFile(file, &executableBytes, &executable.numBytes)) {
+        Fail("Cannot read executable %s.", argv[1]);
+    }
+    fclose(file);
+    executable.bytes = HAPNonnull(executableBytes);
+    LoadSections(&executable);
+
+    file = argc == 3 ? fopen(argv[2], "rb") : stdin;
+    uint8_t* _Nullable logBytes;
+    size_t numLogBytes;
+    if (!file || !ReadFile(file, &logBytes, &numLogBytes)) {
+        Fail("Cannot read log.");
+    }
+    if (file != stdin) {
+        fclose(file);
+    }
+
+    for (size_t offset = 0; offset < numLogBytes;) {
+        char message[2 * 1024];
+        size_t numRecordBytes;
+        HAPLogBinaryRecord record;
+        HAPError err = HAPLogBinaryDecodeRecord(
+                &HAPNonnull(logBytes)[offset],
+                numLogBytes - offset,
+                &numRecordBytes,
+                ResolveString,
+                &executable,
+                message,
+                sizeof message,
+                &record);
+        if (err) {
+            Fail("Malformed record at offset %zu. Does the log belong to the executable?", offset);
+        }
+        PrintRecord(&record);
+        offset += numRecordBytes;
+    }
+
+    free(logBytes);
+    free(executable.sections);
+    free(executableBytes);
+    return EXIT_SUCCESS;
+}
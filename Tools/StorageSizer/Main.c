@@ -0,0 +1,190 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+// Computes the accessory server storage that is required to serve the accessory database of an application.
+//
+// The tool is linked against the App.c and DB.c of an application and sizes the storage for the accessory that is
+// returned by AppGetAccessoryInfo. Element counts that depend on the accessory database are computed exactly.
+// The number of IP sessions and the buffer sizes depend on the workload and cannot be derived from the accessory
+// database. They are taken from the command line options, which default to the values that are used by the sample
+// applications, and are only raised to the minimum that is accepted by the accessory server. Buffer sizes can be
+// measured on a running accessory server with HAPAccessoryServerGetStorageHighWaterMarks.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "HAP+Internal.h"
+
+/**
+ * Returns the accessory that is served by the application. Provided by App.c.
+ */
+extern const HAPAccessory* AppGetAccessoryInfo(void);
+
+/**
+ * Default size of the HAP-BLE procedure buffer, as used by the sample applications.
+ */
+#define kDefaultProcedureBufferSize ((size_t) 2048)
+
+/**
+ * Command line option that overrides a workload parameter.
+ */
+typedef struct {
+    /** Option name. */
+    const char* name;
+
+    /** Workload parameter. */
+    size_t* value;
+} Option;
+
+/**
+ * Prints a storage field.
+ *
+ * @param      name                 Name of the field.
+ * @param      numElements          Number of elements or bytes.
+ * @param      numBytes             Total size in bytes.
+ * @param[in,out] totalNumBytes     Total size of the storage structure in bytes.
+ */
+static void PrintField(const char* name, size_t numElements, size_t numBytes, size_t* totalNumBytes) {
+    HAPPrecondition(name);
+    HAPPrecondition(totalNumBytes);
+
+    printf("  %-36s %10zu %12zu\n", name, numElements, numBytes);
+    *totalNumBytes += numBytes;
+}
+
+int main(int argc, char* argv[]) {
+    HAPError err;
+
+    size_t numIPSessions = kHAPIPSessionStorage_DefaultNumElements;
+    size_t numInboundBufferBytes = kHAPIPSession_DefaultInboundBufferSize;
+    size_t numOutboundBufferBytes = kHAPIPSession_DefaultOutboundBufferSize;
+    size_t numScratchBufferBytes = kHAPIPSession_DefaultScratchBufferSize;
+    size_t numSessionCacheElements = kHAPBLESessionCache_MinElements;
+    size_t numProcedureBufferBytes = kDefaultProcedureBufferSize;
+    const Option options[] = {
+        { "--ip-sessions", &numIPSessions },
+        { "--ip-inbound-buffer", &numInboundBufferBytes },
+        { "--ip-outbound-buffer", &numOutboundBufferBytes },
+        { "--ip-scratch-buffer", &numScratchBufferBytes },
+        { "--ble-session-cache", &numSessionCacheElements },
+        { "--ble-procedure-buffer", &numProcedureBufferBytes },
+    };
+
+    for (int i = 1; i < argc; i += 2) {
+        const Option* option = NULL;
+        for (size_t j = 0; j < HAPArrayCount(options); j++) {
+            if (HAPStringAreEqual(argv[i], options[j].name)) {
+                option = &options[j];
+                break;
+            }
+        }
+        uint64_t value = 0;
+        err = option && i + 1 < argc ? HAPUInt64FromString(argv[i + 1], &value) : kHAPError_InvalidData;
+        if (err || value > SIZE_MAX) {
+            fprintf(stderr,
+                    "Usage: StorageSizer [OPTION N]...\n"
+                    "\n"
+                    "Computes the accessory server storage that is required to serve the accessory database.\n"
+                    "\n"
+                    "Element counts that depend on the accessory database are computed. The options below are\n"
+                    "workload parameters that cannot be computed. Their values are printed as given, marked with *,\n"
+                    "and are only raised to the minimum that is accepted by the accessory server. Measure them on a\n"
+                    "running accessory server with HAPAccessoryServerGetStorageHighWaterMarks.\n"
+                    "\n"
+                    "Options:\n"
+                    "  --ip-sessions N           Number of concurrent IP connections (default: %zu).\n"
+                    "  --ip-inbound-buffer N     Size of the inbound buffer of an IP session (default: %zu).\n"
+                    "  --ip-outbound-buffer N    Size of the outbound buffer of an IP session (default: %zu).\n"
+                    "  --ip-scratch-buffer N     Size of the IP scratch buffer (default: %zu).\n"
+                    "  --ble-session-cache N     Number of BLE Pair Resume session cache elements (default: %zu).\n"
+                    "  --ble-procedure-buffer N  Size of the HAP-BLE procedure buffer (default: %zu).\n",
+                    kHAPIPSessionStorage_DefaultNumElements,
+                    kHAPIPSession_DefaultInboundBufferSize,
+                    kHAPIPSession_DefaultOutboundBufferSize,
+                    kHAPIPSession_DefaultScratchBufferSize,
+                    kHAPBLESessionCache_MinElements,
+                    kDefaultProcedureBufferSize);
+            return EXIT_FAILURE;
+        }
+        *HAPNonnull(option)->value = (size_t) value;
+    }
+
+    const HAPAccessory* accessory = AppGetAccessoryInfo();
+    HAPAccessoryServerStorageUsage requirements;
+    HAPAccessoryServerGetStorageRequirements(accessory, /* bridgedAccessories: */ NULL, &requirements);
+
+    // Workload parameters below the minimum that is accepted by the accessory server are raised.
+    numIPSessions = HAPMax(numIPSessions, requirements.ip.numSessions);
+    numSessionCacheElements = HAPMax(numSessionCacheElements, requirements.ble.numSessionCacheElements);
+    numProcedureBufferBytes = HAPMax(numProcedureBufferBytes, requirements.ble.numProcedureBufferBytes);
+
+    printf("Accessory: %s\n", accessory->name);
+    printf("\n  %-36s %10s %12s\n", "HAPIPAccessoryServerStorage", "Elements", "Bytes");
+    size_t numIPBytes = 0;
+    PrintField("sessions *", numIPSessions, numIPSessions * sizeof(HAPIPSession), &numIPBytes);
+    PrintField(
+            "sessions[].inboundBuffer.numBytes *",
+            numInboundBufferBytes,
+            numIPSessions * numInboundBufferBytes,
+            &numIPBytes);
+    PrintField(
+            "sessions[].outboundBuffer.numBytes *",
+            numOutboundBufferBytes,
+            numIPSessions * numOutboundBufferBytes,
+            &numIPBytes);
+    PrintField(
+            "sessions[].numEventNotifications",
+            requirements.ip.numEventNotifications,
+            numIPSessions * requirements.ip.numEventNotifications * sizeof(HAPIPEventNotificationRef),
+            &numIPBytes);
+    PrintField(
+            "numReadContexts",
+            requirements.ip.numReadContexts,
+            requirements.ip.numReadContexts * sizeof(HAPIPReadContextRef),
+            &numIPBytes);
+    PrintField(
+            "numWriteContexts",
+            requirements.ip.numWriteContexts,
+            requirements.ip.numWriteContexts * sizeof(HAPIPWriteContextRef),
+            &numIPBytes);
+    PrintField(
+            "numCharacteristicIndexElements",
+            requirements.ip.numCharacteristicIndexElements,
+            requirements.ip.numCharacteristicIndexElements * sizeof(HAPIPCharacteristicIndexElementRef),
+            &numIPBytes);
+    PrintField(
+            "numValueCacheElements",
+            requirements.ip.numValueCacheElements,
+            requirements.ip.numValueCacheElements * sizeof(HAPIPCharacteristicValueCacheElementRef),
+            &numIPBytes);
+    PrintField("scratchBuffer.numBytes *", numScratchBufferBytes, numScratchBufferBytes, &numIPBytes);
+    printf("  %-36s %10s %12zu\n", "Total", "", numIPBytes);
+
+    printf("\n  %-36s %10s %12s\n", "HAPBLEAccessoryServerStorage", "Elements", "Bytes");
+    size_t numBLEBytes = 0;
+    PrintField(
+            "numGATTTableElements",
+            requirements.ble.numGATTTableElements,
+            requirements.ble.numGATTTableElements * sizeof(HAPBLEGATTTableElementRef),
+            &numBLEBytes);
+    PrintField(
+            "numSessionCacheElements *",
+            numSessionCacheElements,
+            numSessionCacheElements * sizeof(HAPBLESessionCacheElementRef),
+            &numBLEBytes);
+    PrintField("session", 1, sizeof(HAPSessionRef), &numBLEBytes);
+    PrintField(
+            "numProcedures",
+            requirements.ble.numProcedures,
+            requirements.ble.numProcedures * sizeof(HAPBLEProcedureRef),
+            &numBLEBytes);
+    PrintField("procedureBuffer.numBytes *", numProcedureBufferBytes, numProcedureBufferBytes, &numBLEBytes);
+    printf("  %-36s %10s %12zu\n", "Total", "", numBLEBytes);
+
+    printf("\n* Workload parameter taken from the command line options. Not computed from the accessory database.\n");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,2084 @@
+// Copyright (c) 2015-2019 The HomeKit ADK Contributors
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.
+
+// Generates specialized TLV encode and decode functions from HAPStructTLVFormat and HAPSequenceTLVFormat declarations.
+//
+// The input is a C header containing format declarations of the form
+//
+//     static const HAPStructTLVFormat kFooFormat = { .type = kHAPTLVFormatType_Struct, .members = ... };
+//
+// as they would be passed to HAPTLVReaderDecode and HAPTLVWriterEncode. For every struct and sequence format the
+// generator emits EncodeFoo and DecodeFoo functions that walk the members in straight-line code, and for every struct
+// format with bounded members a kFoo_MaxBytes constant with the maximum length of the encoded value.
+//
+// Generated decoders read the TLV items sequentially with HAPTLVReaderGetNext and therefore reject TLV fragments
+// with a length of 0 that the interpreter would accept. Sequence items are validated when they are enumerated.
+// Flat members and union formats are not supported.
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "HAP+Internal.h"
+
+/** Path of the input file. Used in diagnostics. */
+static const char* inputPath;
+
+static void Fail(size_t line, const char* format, ...) HAP_PRINTFLIKE(2, 3);
+
+/**
+ * Reports an error in the input file and terminates the program.
+ *
+ * @param      line                 Line in the input file. 0 if not applicable.
+ * @param      format               Format string.
+ */
+static void Fail(size_t line, const char* format, ...) {
+    HAPPrecondition(format);
+
+    fprintf(stderr, "%s:%zu: error: ", inputPath ? inputPath : "TLVCodeGenerator", line);
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fprintf(stderr, "\n");
+    exit(EXIT_FAILURE);
+}
+
+HAP_RESULT_USE_CHECK
+static void* Allocate(size_t numBytes) {
+    void* bytes = calloc(1, numBytes ? numBytes : 1);
+    if (!bytes) {
+        Fail(0, "Out of memory.");
+    }
+    return HAPNonnullVoid(bytes);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Growable text buffer.
+ */
+typedef struct {
+    char* _Nullable bytes;
+    size_t numBytes;
+    size_t maxBytes;
+} Text;
+
+static void AppendBytes(Text* text, const char* bytes, size_t numBytes) {
+    HAPPrecondition(text);
+    HAPPrecondition(bytes);
+
+    if (text->maxBytes - text->numBytes <= numBytes) {
+        size_t maxBytes = 2 * (text->numBytes + numBytes) + 64;
+        char* newBytes = Allocate(maxBytes);
+        if (text->bytes) {
+            HAPRawBufferCopyBytes(newBytes, HAPNonnull(text->bytes), text->numBytes);
+            free(text->bytes);
+        }
+        text->bytes = newBytes;
+        text->maxBytes = maxBytes;
+    }
+    HAPRawBufferCopyBytes(&HAPNonnull(text->bytes)[text->numBytes], bytes, numBytes);
+    text->numBytes += numBytes;
+    HAPNonnull(text->bytes)[text->numBytes] = '\0';
+}
+
+static void AppendFormat(Text* text, const char* format, va_list args) HAP_PRINTFLIKE(2, 0);
+
+static void AppendFormat(Text* text, const char* format, va_list args) {
+    HAPPrecondition(text);
+    HAPPrecondition(format);
+
+    char bytes[1024];
+    int numBytes = vsnprintf(bytes, sizeof bytes, format, args);
+    if (numBytes < 0 || (size_t) numBytes >= sizeof bytes) {
+        Fail(0, "Generated line too long.");
+    }
+    AppendBytes(text, bytes, (size_t) numBytes);
+}
+
+HAP_RESULT_USE_CHECK
+static char* CopyString(const char* bytes, size_t numBytes) {
+    HAPPrecondition(bytes);
+
+    char* string = Allocate(numBytes + 1);
+    HAPRawBufferCopyBytes(string, bytes, numBytes);
+    return string;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Token kinds.
+ */
+typedef enum {
+    kTokenKind_End,
+    kTokenKind_Identifier,
+    kTokenKind_Number,
+    kTokenKind_Literal,
+    kTokenKind_Punctuator
+} TokenKind;
+
+/**
+ * Minimal C tokenizer. Comments and preprocessor directives are skipped.
+ */
+typedef struct {
+    const char* bytes;
+    size_t numBytes;
+    size_t position;
+    size_t line;
+    bool isAtStartOfLine;
+
+    /** Current token. */
+    struct {
+        TokenKind kind;
+        const char* bytes;
+        size_t numBytes;
+        size_t line;
+    } token;
+} Parser;
+
+HAP_RESULT_USE_CHECK
+static bool IsIdentifierCharacter(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+static void ReadToken(Parser* parser) {
+    HAPPrecondition(parser);
+
+    const char* bytes = parser->bytes;
+    for (;;) {
+        if (parser->position == parser->numBytes) {
+            parser->token.kind = kTokenKind_End;
+            parser->token.bytes = &bytes[parser->position];
+            parser->token.numBytes = 0;
+            parser->token.line = parser->line;
+            return;
+        }
+        char c = bytes[parser->position];
+        if (c == '\n') {
+            parser->line++;
+            parser->isAtStartOfLine = true;
+            parser->position++;
+        } else if (c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v') {
+            parser->position++;
+        } else if (c == '#' && parser->isAtStartOfLine) {
+            // Preprocessor directive, including continuation lines.
+            while (parser->position < parser->numBytes && bytes[parser->position] != '\n') {
+                if (bytes[parser->position] == '\\' && parser->position + 1 < parser->numBytes &&
+                    bytes[parser->position + 1] == '\n') {
+                    parser->line++;
+                    parser->position++;
+                }
+                parser->position++;
+            }
+        } else if (c == '/' && parser->position + 1 < parser->numBytes && bytes[parser->position + 1] == '/') {
+            while (parser->position < parser->numBytes && bytes[parser->position] != '\n') {
+                parser->position++;
+            }
+        } else if (c == '/' && parser->position + 1 < parser->numBytes && bytes[parser->position + 1] == '*') {
+            parser->position += 2;
+            while (parser->position + 1 < parser->numBytes &&
+                   !(bytes[parser->position] == '*' && bytes[parser->position + 1] == '/')) {
+                if (bytes[parser->position] == '\n') {
+                    parser->line++;
+                }
+                parser->position++;
+            }
+            if (parser->position + 1 >= parser->numBytes) {
+                Fail(parser->line, "Unterminated comment.");
+            }
+            parser->position += 2;
+        } else {
+            break;
+        }
+    }
+
+    parser->isAtStartOfLine = false;
+    parser->token.bytes = &bytes[parser->position];
+    parser->token.line = parser->line;
+    size_t start = parser->position;
+    char c = bytes[parser->position++];
+    if ((c >= '0' && c <= '9') || IsIdentifierCharacter(c)) {
+        parser->token.kind = (c >= '0' && c <= '9') ? kTokenKind_Number : kTokenKind_Identifier;
+        while (parser->position < parser->numBytes &&
+               (IsIdentifierCharacter(bytes[parser->position]) || bytes[parser->position] == '.')) {
+            if (bytes[parser->position] == '.' && parser->token.kind != kTokenKind_Number) {
+                break;
+            }
+            parser->position++;
+        }
+    } else if (c == '"' || c == '\'') {
+        parser->token.kind = kTokenKind_Literal;
+        while (parser->position < parser->numBytes && bytes[parser->position] != c) {
+            if (bytes[parser->position] == '\\') {
+                parser->position++;
+            }
+            if (parser->position < parser->numBytes && bytes[parser->position] == '\n') {
+                Fail(parser->line, "Unterminated literal.");
+            }
+            parser->position++;
+        }
+        if (parser->position >= parser->numBytes) {
+            Fail(parser->line, "Unterminated literal.");
+        }
+        parser->position++;
+    } else {
+        parser->token.kind = kTokenKind_Punctuator;
+    }
+    parser->token.numBytes = parser->position - start;
+}
+
+HAP_RESULT_USE_CHECK
+static bool IsToken(const Parser* parser, const char* text) {
+    HAPPrecondition(parser);
+    HAPPrecondition(text);
+
+    size_t numTextBytes = HAPStringGetNumBytes(text);
+    return parser->token.kind != kTokenKind_End && parser->token.numBytes == numTextBytes &&
+           HAPRawBufferAreEqual(parser->token.bytes, text, numTextBytes);
+}
+
+static void ExpectToken(Parser* parser, const char* text) {
+    HAPPrecondition(parser);
+    HAPPrecondition(text);
+
+    if (!IsToken(parser, text)) {
+        Fail(parser->token.line,
+             "Expected '%s' but found '%.*s'.",
+             text,
+             (int) parser->token.numBytes,
+             parser->token.bytes);
+    }
+    ReadToken(parser);
+}
+
+/**
+ * Appends the current token to a text, separated by a space where needed, and advances to the next token.
+ */
+static void AppendToken(Parser* parser, Text* text) {
+    HAPPrecondition(parser);
+    HAPPrecondition(text);
+
+    if (text->numBytes) {
+        char previous = HAPNonnull(text->bytes)[text->numBytes - 1];
+        char next = parser->token.bytes[0];
+        bool isSpaceNeeded = (IsIdentifierCharacter(previous) && IsIdentifierCharacter(next)) ||
+                             (previous == ')' && (IsIdentifierCharacter(next) || next == '(')) || previous == ',' ||
+                             next == '*' || (previous == '*' && IsIdentifierCharacter(next));
+        if (isSpaceNeeded) {
+            AppendBytes(text, " ", 1);
+        }
+    }
+    AppendBytes(text, parser->token.bytes, parser->token.numBytes);
+    ReadToken(parser);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Node kinds of a parsed initializer.
+ */
+typedef enum {
+    /** Braced initializer list. */
+    kNodeKind_List,
+
+    /** Expression, kept as text. */
+    kNodeKind_Expression,
+
+    /** Address of a declaration: &name. */
+    kNodeKind_Reference,
+
+    /** Compound literal or address of a compound literal: (type) { ... } or &(type) { ... }. */
+    kNodeKind_CompoundLiteral,
+
+    /** HAP_OFFSETOF(type, member). */
+    kNodeKind_Offset
+} NodeKind;
+
+typedef struct Node Node;
+
+struct Node {
+    NodeKind kind;
+    size_t line;
+
+    /** Expression text, reference name, compound literal type or offset type. */
+    char* _Nullable text;
+
+    /** Member of an offset. */
+    char* _Nullable memberName;
+
+    /** Body of a compound literal. */
+    Node* _Nullable body;
+
+    /** Entries of a list. Designators are NULL for positional entries. */
+    char* _Nullable* _Nullable designators;
+    Node* _Nullable* _Nullable values;
+    size_t numValues;
+};
+
+HAP_RESULT_USE_CHECK
+static Node* CreateNode(NodeKind kind, size_t line) {
+    Node* node = Allocate(sizeof *node);
+    node->kind = kind;
+    node->line = line;
+    return node;
+}
+
+HAP_RESULT_USE_CHECK
+static Node* ParseValue(Parser* parser);
+
+HAP_RESULT_USE_CHECK
+static Node* ParseList(Parser* parser) {
+    HAPPrecondition(parser);
+
+    Node* node = CreateNode(kNodeKind_List, parser->token.line);
+    size_t maxValues = 0;
+    ExpectToken(parser, "{");
+    while (!IsToken(parser, "}")) {
+        char* _Nullable designator = NULL;
+        if (IsToken(parser, ".")) {
+            ReadToken(parser);
+            if (parser->token.kind != kTokenKind_Identifier) {
+                Fail(parser->token.line, "Expected designator.");
+            }
+            designator = CopyString(parser->token.bytes, parser->token.numBytes);
+            ReadToken(parser);
+            ExpectToken(parser, "=");
+        }
+        if (node->numValues == maxValues) {
+            maxValues = 2 * maxValues + 4;
+            char** designators = Allocate(maxValues * sizeof *designators);
+            Node** values = Allocate(maxValues * sizeof *values);
+            if (node->numValues) {
+                HAPRawBufferCopyBytes(
+                        designators, HAPNonnull(node->designators), node->numValues * sizeof *designators);
+                HAPRawBufferCopyBytes(values, HAPNonnull(node->values), node->numValues * sizeof *values);
+                free(node->designators);
+                free(node->values);
+            }
+            node->designators = designators;
+            node->values = values;
+        }
+        HAPNonnull(node->designators)[node->numValues] = designator;
+        HAPNonnull(node->values)[node->numValues] = ParseValue(parser);
+        node->numValues++;
+        if (!IsToken(parser, ",")) {
+            break;
+        }
+        ReadToken(parser);
+    }
+    ExpectToken(parser, "}");
+    return node;
+}
+
+/**
+ * Parses the tokens between a pair of parentheses.
+ */
+static void ParseParenthesized(Parser* parser, Text* text) {
+    HAPPrecondition(parser);
+    HAPPrecondition(text);
+
+    ExpectToken(parser, "(");
+    size_t depth = 0;
+    while (depth || !IsToken(parser, ")")) {
+        if (parser->token.kind == kTokenKind_End) {
+            Fail(parser->token.line, "Unbalanced parentheses.");
+        }
+        if (IsToken(parser, "(")) {
+            depth++;
+        } else if (IsToken(parser, ")")) {
+            depth--;
+        }
+        AppendToken(parser, text);
+    }
+    ExpectToken(parser, ")");
+}
+
+/**
+ * Appends tokens up to the end of the current initializer entry.
+ */
+static void ParseExpression(Parser* parser, Text* text) {
+    HAPPrecondition(parser);
+    HAPPrecondition(text);
+
+    size_t depth = 0;
+    while (depth || (!IsToken(parser, ",") && !IsToken(parser, "}"))) {
+        if (parser->token.kind == kTokenKind_End) {
+            Fail(parser->token.line, "Unexpected end of input.");
+        }
+        if (IsToken(parser, "(") || IsToken(parser, "[") || IsToken(parser, "{")) {
+            depth++;
+        } else if (IsToken(parser, ")") || IsToken(parser, "]") || IsToken(parser, "}")) {
+            depth--;
+        }
+        AppendToken(parser, text);
+    }
+}
+
+HAP_RESULT_USE_CHECK
+static Node* ParseValue(Parser* parser) {
+    HAPPrecondition(parser);
+
+    size_t line = parser->token.line;
+    if (IsToken(parser, "{")) {
+        return ParseList(parser);
+    }
+    if (IsToken(parser, "&")) {
+        ReadToken(parser);
+        if (IsToken(parser, "(")) {
+            Text type = { 0 };
+            ParseParenthesized(parser, &type);
+            Node* node = CreateNode(kNodeKind_CompoundLiteral, line);
+            node->text = type.bytes;
+            node->body = ParseList(parser);
+            return node;
+        }
+        if (parser->token.kind != kTokenKind_Identifier) {
+            Fail(line, "Expected identifier after '&'.");
+        }
+        Node* node = CreateNode(kNodeKind_Reference, line);
+        node->text = CopyString(parser->token.bytes, parser->token.numBytes);
+        ReadToken(parser);
+        return node;
+    }
+    if (IsToken(parser, "HAP_OFFSETOF")) {
+        ReadToken(parser);
+        ExpectToken(parser, "(");
+        Text type = { 0 };
+        while (!IsToken(parser, ",")) {
+            if (parser->token.kind == kTokenKind_End) {
+                Fail(line, "Unexpected end of input.");
+            }
+            AppendToken(parser, &type);
+        }
+        ExpectToken(parser, ",");
+        Text member = { 0 };
+        while (!IsToken(parser, ")")) {
+            if (parser->token.kind == kTokenKind_End) {
+                Fail(line, "Unexpected end of input.");
+            }
+            AppendToken(parser, &member);
+        }
+        ExpectToken(parser, ")");
+        if (!type.bytes || !member.bytes) {
+            Fail(line, "Invalid HAP_OFFSETOF.");
+        }
+        Node* node = CreateNode(kNodeKind_Offset, line);
+        node->text = type.bytes;
+        node->memberName = member.bytes;
+        return node;
+    }
+
+    Text text = { 0 };
+    if (IsToken(parser, "(")) {
+        Text type = { 0 };
+        ParseParenthesized(parser, &type);
+        if (IsToken(parser, "{")) {
+            Node* node = CreateNode(kNodeKind_CompoundLiteral, line);
+            node->text = type.bytes;
+            node->body = ParseList(parser);
+            return node;
+        }
+        AppendBytes(&text, "(", 1);
+        if (type.bytes) {
+            AppendBytes(&text, HAPNonnull(type.bytes), type.numBytes);
+        }
+        AppendBytes(&text, ")", 1);
+    }
+    ParseExpression(parser, &text);
+    if (!text.bytes) {
+        Fail(line, "Expected expression.");
+    }
+    Node* node = CreateNode(kNodeKind_Expression, line);
+    node->text = text.bytes;
+    return node;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Top-level declaration of the form [static] const Type name = { ... };
+ */
+typedef struct {
+    char* name;
+    Node* value;
+} Declaration;
+
+static Declaration* declarations;
+static size_t numDeclarations;
+
+static void ParseDeclarations(const char* bytes, size_t numBytes) {
+    HAPPrecondition(bytes);
+
+    Parser parser = { .bytes = bytes, .numBytes = numBytes, .line = 1, .isAtStartOfLine = true };
+    ReadToken(&parser);
+
+    size_t maxDeclarations = 0;
+    size_t depth = 0;
+    while (parser.token.kind != kTokenKind_End) {
+        if (!depth && IsToken(&parser, "const")) {
+            Parser state = parser;
+            ReadToken(&parser);
+            if (parser.token.kind == kTokenKind_Identifier) {
+                ReadToken(&parser);
+                if (parser.token.kind == kTokenKind_Identifier) {
+                    char* name = CopyString(parser.token.bytes, parser.token.numBytes);
+                    ReadToken(&parser);
+                    if (IsToken(&parser, "=")) {
+                        ReadToken(&parser);
+                        if (IsToken(&parser, "{")) {
+                            if (numDeclarations == maxDeclarations) {
+                                maxDeclarations = 2 * maxDeclarations + 16;
+                                Declaration* newDeclarations = Allocate(maxDeclarations * sizeof *newDeclarations);
+                                if (numDeclarations) {
+                                    HAPRawBufferCopyBytes(
+                                            newDeclarations, declarations, numDeclarations * sizeof *declarations);
+                                    free(declarations);
+                                }
+                                declarations = newDeclarations;
+                            }
+                            declarations[numDeclarations].name = name;
+                            declarations[numDeclarations].value = ParseList(&parser);
+                            numDeclarations++;
+                            continue;
+                        }
+                    }
+                    free(name);
+                }
+            }
+            parser = state;
+        }
+        if (IsToken(&parser, "{")) {
+            depth++;
+        } else if (IsToken(&parser, "}")) {
+            if (!depth) {
+                Fail(parser.token.line, "Unbalanced braces.");
+            }
+            depth--;
+        }
+        ReadToken(&parser);
+    }
+}
+
+HAP_RESULT_USE_CHECK
+static const Declaration* _Nullable FindDeclaration(const char* name) {
+    HAPPrecondition(name);
+
+    for (size_t i = 0; i < numDeclarations; i++) {
+        if (HAPStringAreEqual(declarations[i].name, name)) {
+            return &declarations[i];
+        }
+    }
+    return NULL;
+}
+
+HAP_RESULT_USE_CHECK
+static Node* _Nullable GetEntry(const Node* list, const char* designator) {
+    HAPPrecondition(list);
+    HAPPrecondition(list->kind == kNodeKind_List);
+    HAPPrecondition(designator);
+
+    for (size_t i = 0; i < list->numValues; i++) {
+        const char* _Nullable entryDesignator = HAPNonnull(list->designators)[i];
+        if (entryDesignator && HAPStringAreEqual(HAPNonnull(entryDesignator), designator)) {
+            return HAPNonnull(list->values)[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Gets the text of an expression entry.
+ *
+ * @return Text of the expression, or NULL if the entry is missing or NULL.
+ */
+HAP_RESULT_USE_CHECK
+static const char* _Nullable GetExpression(const Node* list, const char* designator) {
+    HAPPrecondition(list);
+    HAPPrecondition(designator);
+
+    const Node* _Nullable node = GetEntry(list, designator);
+    if (!node) {
+        return NULL;
+    }
+    if (node->kind != kNodeKind_Expression) {
+        Fail(node->line, "Expected expression for .%s.", designator);
+    }
+    if (HAPStringAreEqual(HAPNonnull(node->text), "NULL")) {
+        return NULL;
+    }
+    return node->text;
+}
+
+HAP_RESULT_USE_CHECK
+static const char* GetRequiredExpression(const Node* list, const char* designator) {
+    HAPPrecondition(list);
+    HAPPrecondition(designator);
+
+    const char* _Nullable text = GetExpression(list, designator);
+    if (!text) {
+        Fail(list->line, "Missing .%s.", designator);
+    }
+    return HAPNonnull(text);
+}
+
+HAP_RESULT_USE_CHECK
+static bool GetFlag(const Node* list, const char* designator) {
+    HAPPrecondition(list);
+    HAPPrecondition(designator);
+
+    const char* _Nullable text = GetExpression(list, designator);
+    if (!text || HAPStringAreEqual(HAPNonnull(text), "false") || HAPStringAreEqual(HAPNonnull(text), "0")) {
+        return false;
+    }
+    if (HAPStringAreEqual(HAPNonnull(text), "true") || HAPStringAreEqual(HAPNonnull(text), "1")) {
+        return true;
+    }
+    Fail(list->line, "Unsupported value for .%s: %s.", designator, HAPNonnull(text));
+    return false;
+}
+
+HAP_RESULT_USE_CHECK
+static const Node* GetOffset(const Node* list, const char* designator) {
+    HAPPrecondition(list);
+    HAPPrecondition(designator);
+
+    const Node* _Nullable node = GetEntry(list, designator);
+    if (!node || node->kind != kNodeKind_Offset) {
+        Fail(list->line, "Expected HAP_OFFSETOF(type, member) for .%s.", designator);
+    }
+    return HAPNonnull(node);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Integer constant with sign and magnitude.
+ */
+typedef struct {
+    bool isKnown;
+    bool isNegative;
+    uint64_t magnitude;
+} Constant;
+
+/**
+ * Evaluates an integer literal or a limit macro from <stdint.h>.
+ */
+HAP_RESULT_USE_CHECK
+static Constant EvaluateConstant(const char* text) {
+    HAPPrecondition(text);
+
+    static const struct {
+        const char* name;
+        bool isNegative;
+        uint64_t magnitude;
+    } kLimits[] = {
+        { "UINT8_MAX", false, UINT8_MAX },         { "UINT16_MAX", false, UINT16_MAX },
+        { "UINT32_MAX", false, UINT32_MAX },       { "UINT64_MAX", false, UINT64_MAX },
+        { "INT8_MIN", true, (uint64_t) INT8_MAX + 1 }, { "INT8_MAX", false, INT8_MAX },
+        { "INT16_MIN", true, (uint64_t) INT16_MAX + 1 }, { "INT16_MAX", false, INT16_MAX },
+        { "INT32_MIN", true, (uint64_t) INT32_MAX + 1 }, { "INT32_MAX", false, INT32_MAX },
+        { "INT64_MIN", true, (uint64_t) INT64_MAX + 1 }, { "INT64_MAX", false, INT64_MAX },
+    };
+
+    Constant constant = { 0 };
+    const char* c = text;
+    if (*c == '-') {
+        constant.isNegative = true;
+        c++;
+    }
+    for (size_t i = 0; i < HAPArrayCount(kLimits); i++) {
+        if (HAPStringAreEqual(c, kLimits[i].name)) {
+            if (constant.isNegative) {
+                return (Constant) { 0 };
+            }
+            constant.isKnown = true;
+            constant.isNegative = kLimits[i].isNegative;
+            constant.magnitude = kLimits[i].magnitude;
+            return constant;
+        }
+    }
+    if (*c < '0' || *c > '9') {
+        return (Constant) { 0 };
+    }
+    unsigned int base = 10;
+    if (c[0] == '0' && (c[1] == 'x' || c[1] == 'X')) {
+        base = 16;
+        c += 2;
+    } else if (c[0] == '0') {
+        base = 8;
+    }
+    for (; *c; c++) {
+        unsigned int digit;
+        if (*c >= '0' && *c <= '9') {
+            digit = (unsigned int) (*c - '0');
+        } else if (*c >= 'a' && *c <= 'f') {
+            digit = (unsigned int) (*c - 'a') + 10;
+        } else if (*c >= 'A' && *c <= 'F') {
+            digit = (unsigned int) (*c - 'A') + 10;
+        } else {
+            break;
+        }
+        if (digit >= base || constant.magnitude > (UINT64_MAX - digit) / base) {
+            return (Constant) { 0 };
+        }
+        constant.magnitude = constant.magnitude * base + digit;
+    }
+    for (; *c; c++) {
+        if (*c != 'u' && *c != 'U' && *c != 'l' && *c != 'L') {
+            return (Constant) { 0 };
+        }
+    }
+    if (!constant.magnitude) {
+        constant.isNegative = false;
+    }
+    constant.isKnown = true;
+    return constant;
+}
+
+HAP_RESULT_USE_CHECK
+static bool IsConstantEqual(const char* text, bool isNegative, uint64_t magnitude) {
+    HAPPrecondition(text);
+
+    Constant constant = EvaluateConstant(text);
+    return constant.isKnown && constant.isNegative == isNegative && constant.magnitude == magnitude;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Properties of the integer format types.
+ */
+typedef struct {
+    HAPTLVFormatType type;
+    const char* typeName;
+    const char* intermediateTypeName;
+    const char* writeFunction;
+    size_t numBytes;
+    bool isSigned;
+} IntegerInfo;
+
+static const IntegerInfo kIntegerInfos[] = {
+    { kHAPTLVFormatType_UInt8, "uint8_t", "unsigned int", "HAPWriteUInt8", 1, false },
+    { kHAPTLVFormatType_UInt16, "uint16_t", "unsigned int", "HAPWriteLittleUInt16", 2, false },
+    { kHAPTLVFormatType_UInt32, "uint32_t", "unsigned long", "HAPWriteLittleUInt32", 4, false },
+    { kHAPTLVFormatType_UInt64, "uint64_t", "uint64_t", "HAPWriteLittleUInt64", 8, false },
+    { kHAPTLVFormatType_Int8, "int8_t", "int", "HAPWriteUInt8", 1, true },
+    { kHAPTLVFormatType_Int16, "int16_t", "int", "HAPWriteLittleInt16", 2, true },
+    { kHAPTLVFormatType_Int32, "int32_t", "long", "HAPWriteLittleInt32", 4, true },
+    { kHAPTLVFormatType_Int64, "int64_t", "int64_t", "HAPWriteLittleInt64", 8, true },
+};
+
+HAP_RESULT_USE_CHECK
+static const IntegerInfo* _Nullable GetIntegerInfo(HAPTLVFormatType type) {
+    for (size_t i = 0; i < HAPArrayCount(kIntegerInfos); i++) {
+        if (kIntegerInfos[i].type == type) {
+            return &kIntegerInfos[i];
+        }
+    }
+    return NULL;
+}
+
+HAP_RESULT_USE_CHECK
+static bool IsMinimumTrivial(const IntegerInfo* info, const char* text) {
+    HAPPrecondition(info);
+    HAPPrecondition(text);
+
+    if (!info->isSigned) {
+        return IsConstantEqual(text, false, 0);
+    }
+    return IsConstantEqual(text, true, (uint64_t) 1 << (info->numBytes * CHAR_BIT - 1));
+}
+
+HAP_RESULT_USE_CHECK
+static bool IsMaximumTrivial(const IntegerInfo* info, const char* text) {
+    HAPPrecondition(info);
+    HAPPrecondition(text);
+
+    if (!info->isSigned) {
+        return IsConstantEqual(
+                text, false, info->numBytes == 8 ? UINT64_MAX : ((uint64_t) 1 << (info->numBytes * 8)) - 1);
+    }
+    return IsConstantEqual(text, false, ((uint64_t) 1 << (info->numBytes * CHAR_BIT - 1)) - 1);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+typedef struct Format Format;
+
+/**
+ * Struct member, sequence item or sequence separator.
+ */
+typedef struct {
+    Format* format;
+    const char* tlvType;
+    const char* debugDescription;
+
+    /** Type containing the member value. NULL for separators. */
+    const char* _Nullable valueTypeName;
+
+    /** Name of the member value. NULL for separators. */
+    const char* _Nullable valueMemberName;
+
+    /** Name of the bool indicating whether an optional member value is present. */
+    const char* _Nullable isSetMemberName;
+
+    bool isOptional;
+} Member;
+
+struct Format {
+    /** Declaration, or body of the compound literal. */
+    const Node* list;
+
+    /** Base name of generated functions. */
+    char* name;
+
+    HAPTLVFormatType type;
+    bool isBeingCreated;
+
+    /** Constraints of integer, data and string formats. */
+    const char* _Nullable minimum;
+    const char* _Nullable maximum;
+
+    /** Callbacks. */
+    const char* _Nullable isValid;
+    const char* _Nullable encode;
+    const char* _Nullable decode;
+
+    /** Type of the value of struct and sequence formats. */
+    const char* _Nullable valueTypeName;
+
+    /** Struct members. */
+    Member* _Nullable members;
+    size_t numMembers;
+
+    /** Sequence item and separator. */
+    Member item;
+    Member separator;
+};
+
+/** Formats in dependency order. */
+static Format** formats;
+static size_t numFormats;
+
+HAP_RESULT_USE_CHECK
+static HAPTLVFormatType ParseFormatType(const Node* list) {
+    HAPPrecondition(list);
+
+    static const struct {
+        const char* name;
+        HAPTLVFormatType type;
+    } kFormatTypes[] = {
+        { "kHAPTLVFormatType_None", kHAPTLVFormatType_None },
+        { "kHAPTLVFormatType_Enum", kHAPTLVFormatType_Enum },
+        { "kHAPTLVFormatType_UInt8", kHAPTLVFormatType_UInt8 },
+        { "kHAPTLVFormatType_UInt16", kHAPTLVFormatType_UInt16 },
+        { "kHAPTLVFormatType_UInt32", kHAPTLVFormatType_UInt32 },
+        { "kHAPTLVFormatType_UInt64", kHAPTLVFormatType_UInt64 },
+        { "kHAPTLVFormatType_Int8", kHAPTLVFormatType_Int8 },
+        { "kHAPTLVFormatType_Int16", kHAPTLVFormatType_Int16 },
+        { "kHAPTLVFormatType_Int32", kHAPTLVFormatType_Int32 },
+        { "kHAPTLVFormatType_Int64", kHAPTLVFormatType_Int64 },
+        { "kHAPTLVFormatType_Data", kHAPTLVFormatType_Data },
+        { "kHAPTLVFormatType_String", kHAPTLVFormatType_String },
+        { "kHAPTLVFormatType_Value", kHAPTLVFormatType_Value },
+        { "kHAPTLVFormatType_Sequence", kHAPTLVFormatType_Sequence },
+        { "kHAPTLVFormatType_Struct", kHAPTLVFormatType_Struct },
+        { "kHAPTLVFormatType_Union", kHAPTLVFormatType_Union },
+    };
+
+    const char* text = GetRequiredExpression(list, "type");
+    for (size_t i = 0; i < HAPArrayCount(kFormatTypes); i++) {
+        if (HAPStringAreEqual(text, kFormatTypes[i].name)) {
+            return kFormatTypes[i].type;
+        }
+    }
+    Fail(list->line, "Unknown format type: %s.", text);
+    return kHAPTLVFormatType_None;
+}
+
+/**
+ * Derives the base name of generated functions from a declaration name: kFooFormat -> Foo.
+ */
+HAP_RESULT_USE_CHECK
+static char* GetBaseName(const char* name) {
+    HAPPrecondition(name);
+
+    size_t numBytes = HAPStringGetNumBytes(name);
+    if (numBytes > 1 && name[0] == 'k' && name[1] >= 'A' && name[1] <= 'Z') {
+        name++;
+        numBytes--;
+    }
+    if (numBytes > 6 && HAPStringAreEqual(&name[numBytes - 6], "Format")) {
+        numBytes -= 6;
+    }
+    return CopyString(name, numBytes);
+}
+
+HAP_RESULT_USE_CHECK
+static Format* GetFormat(const Node* node, const char* nameHint);
+
+/**
+ * Resolves a &name reference or a &(type) { ... } compound literal to the initializer list.
+ */
+HAP_RESULT_USE_CHECK
+static const Node* ResolveList(const Node* node, const char* _Nullable* _Nullable name) {
+    HAPPrecondition(node);
+
+    if (name) {
+        *name = NULL;
+    }
+    if (node->kind == kNodeKind_Reference) {
+        const Declaration* _Nullable declaration = FindDeclaration(HAPNonnull(node->text));
+        if (!declaration) {
+            Fail(node->line, "Unknown declaration: %s.", HAPNonnull(node->text));
+        }
+        if (name) {
+            *name = HAPNonnull(declaration)->name;
+        }
+        return HAPNonnull(declaration)->value;
+    }
+    if (node->kind == kNodeKind_CompoundLiteral) {
+        return HAPNonnull(node->body);
+    }
+    Fail(node->line, "Expected &declaration or compound literal.");
+    return node;
+}
+
+static void ParseMember(const Node* list, const char* parentName, bool isSeparator, Member* member) {
+    HAPPrecondition(list);
+    HAPPrecondition(parentName);
+    HAPPrecondition(member);
+
+    HAPRawBufferZero(member, sizeof *member);
+    member->tlvType = GetRequiredExpression(list, "tlvType");
+    member->debugDescription = GetRequiredExpression(list, "debugDescription");
+    if (GetFlag(list, "isFlat")) {
+        Fail(list->line, "Flat members are not supported.");
+    }
+    if (!isSeparator) {
+        const Node* offset = GetOffset(list, "valueOffset");
+        member->valueTypeName = offset->text;
+        member->valueMemberName = offset->memberName;
+        member->isOptional = GetFlag(list, "isOptional");
+        if (member->isOptional) {
+            const Node* isSetOffset = GetOffset(list, "isSetOffset");
+            if (!HAPStringAreEqual(HAPNonnull(isSetOffset->text), HAPNonnull(offset->text))) {
+                Fail(list->line, "Offsets of a member must refer to the same type.");
+            }
+            member->isSetMemberName = isSetOffset->memberName;
+        }
+    }
+
+    const Node* _Nullable formatNode = GetEntry(list, "format");
+    if (!formatNode) {
+        Fail(list->line, "Missing .format.");
+    }
+    Text nameHint = { 0 };
+    AppendBytes(&nameHint, parentName, HAPStringGetNumBytes(parentName));
+    const char* suffix = member->valueMemberName ? HAPNonnull(member->valueMemberName) : "Separator";
+    AppendBytes(&nameHint, "_", 1);
+    for (const char* c = suffix; *c; c++) {
+        AppendBytes(&nameHint, IsIdentifierCharacter(*c) ? c : "_", 1);
+    }
+    member->format = GetFormat(HAPNonnull(formatNode), HAPNonnull(nameHint.bytes));
+    if (member->format->type == kHAPTLVFormatType_Union) {
+        Fail(list->line, "Union formats are not supported.");
+    }
+    if (isSeparator != (member->format->type == kHAPTLVFormatType_None)) {
+        Fail(list->line,
+             isSeparator ? "Separators must use a kHAPTLVFormatType_None format." :
+                           "Only separators may use a kHAPTLVFormatType_None format.");
+    }
+}
+
+HAP_RESULT_USE_CHECK
+static Format* GetFormat(const Node* node, const char* nameHint) {
+    HAPPrecondition(node);
+    HAPPrecondition(nameHint);
+
+    const char* _Nullable declarationName;
+    const Node* list = ResolveList(node, &declarationName);
+    for (size_t i = 0; i < numFormats; i++) {
+        if (formats[i]->list == list) {
+            return formats[i];
+        }
+    }
+
+    Format* format = Allocate(sizeof *format);
+    format->list = list;
+    format->name = declarationName ? GetBaseName(HAPNonnull(declarationName)) :
+                                     CopyString(nameHint, HAPStringGetNumBytes(nameHint));
+    format->type = ParseFormatType(list);
+    format->isBeingCreated = true;
+
+    const Node* _Nullable constraints = GetEntry(list, "constraints");
+    const Node* _Nullable callbacks = GetEntry(list, "callbacks");
+    if (constraints && HAPNonnull(constraints)->kind != kNodeKind_List) {
+        Fail(node->line, "Expected list for .constraints.");
+    }
+    if (callbacks && HAPNonnull(callbacks)->kind != kNodeKind_List) {
+        Fail(node->line, "Expected list for .callbacks.");
+    }
+
+    switch (format->type) {
+        case kHAPTLVFormatType_None: {
+        } break;
+        case kHAPTLVFormatType_Enum: {
+            if (!callbacks) {
+                Fail(list->line, "Missing .callbacks.");
+            }
+            format->isValid = GetRequiredExpression(HAPNonnull(callbacks), "isValid");
+        } break;
+        case kHAPTLVFormatType_UInt8:
+        case kHAPTLVFormatType_UInt16:
+        case kHAPTLVFormatType_UInt32:
+        case kHAPTLVFormatType_UInt64:
+        case kHAPTLVFormatType_Int8:
+        case kHAPTLVFormatType_Int16:
+        case kHAPTLVFormatType_Int32:
+        case kHAPTLVFormatType_Int64: {
+            if (!constraints) {
+                Fail(list->line, "Missing .constraints.");
+            }
+            format->minimum = GetRequiredExpression(HAPNonnull(constraints), "minimumValue");
+            format->maximum = GetRequiredExpression(HAPNonnull(constraints), "maximumValue");
+        } break;
+        case kHAPTLVFormatType_Data:
+        case kHAPTLVFormatType_String: {
+            if (!constraints) {
+                Fail(list->line, "Missing .constraints.");
+            }
+            format->minimum = GetRequiredExpression(HAPNonnull(constraints), "minLength");
+            format->maximum = GetRequiredExpression(HAPNonnull(constraints), "maxLength");
+            if (callbacks) {
+                format->isValid = GetExpression(HAPNonnull(callbacks), "isValid");
+            }
+        } break;
+        case kHAPTLVFormatType_Value: {
+            if (!callbacks) {
+                Fail(list->line, "Missing .callbacks.");
+            }
+            format->decode = GetRequiredExpression(HAPNonnull(callbacks), "decode");
+            format->encode = GetRequiredExpression(HAPNonnull(callbacks), "encode");
+        } break;
+        case kHAPTLVFormatType_Sequence: {
+            const Node* _Nullable item = GetEntry(list, "item");
+            const Node* _Nullable separator = GetEntry(list, "separator");
+            if (!item || HAPNonnull(item)->kind != kNodeKind_List || !separator ||
+                HAPNonnull(separator)->kind != kNodeKind_List) {
+                Fail(list->line, "Expected lists for .item and .separator.");
+            }
+            ParseMember(HAPNonnull(item), format->name, /* isSeparator: */ false, &format->item);
+            ParseMember(HAPNonnull(separator), format->name, /* isSeparator: */ true, &format->separator);
+            if (!HAPStringAreEqual(HAPNonnull(format->item.valueMemberName), "_")) {
+                Fail(list->line, "Sequence item values must be stored in the _ member.");
+            }
+            format->valueTypeName = format->item.valueTypeName;
+        } break;
+        case kHAPTLVFormatType_Struct: {
+            if (callbacks) {
+                format->isValid = GetExpression(HAPNonnull(callbacks), "isValid");
+            }
+            const Node* _Nullable members = GetEntry(list, "members");
+            if (!members || HAPNonnull(members)->kind != kNodeKind_CompoundLiteral) {
+                Fail(list->line, "Expected compound literal for .members.");
+            }
+            const Node* body = HAPNonnull(HAPNonnull(members)->body);
+            format->members = Allocate(body->numValues * sizeof *format->members);
+            for (size_t i = 0; i < body->numValues; i++) {
+                const Node* value = HAPNonnull(body->values)[i];
+                if (value->kind == kNodeKind_Expression && HAPStringAreEqual(HAPNonnull(value->text), "NULL")) {
+                    break;
+                }
+                Member* member = &HAPNonnull(format->members)[format->numMembers++];
+                ParseMember(ResolveList(value, NULL), format->name, /* isSeparator: */ false, member);
+                if (format->valueTypeName &&
+                    !HAPStringAreEqual(HAPNonnull(format->valueTypeName), HAPNonnull(member->valueTypeName))) {
+                    Fail(value->line, "Members of a struct must refer to the same type.");
+                }
+                format->valueTypeName = member->valueTypeName;
+            }
+            if (!format->numMembers) {
+                Fail(list->line, "Structs without members are not supported.");
+            }
+        } break;
+        case kHAPTLVFormatType_Union: {
+        } break;
+    }
+
+    // Append after nested formats so that formats are in dependency order.
+    format->isBeingCreated = false;
+    Format** newFormats = Allocate((numFormats + 1) * sizeof *newFormats);
+    if (numFormats) {
+        HAPRawBufferCopyBytes(newFormats, formats, numFormats * sizeof *formats);
+        free(formats);
+    }
+    formats = newFormats;
+    formats[numFormats++] = format;
+    return format;
+}
+
+HAP_RESULT_USE_CHECK
+static bool IsAggregate(const Format* format) {
+    HAPPrecondition(format);
+
+    return format->type == kHAPTLVFormatType_Sequence || format->type == kHAPTLVFormatType_Struct ||
+           format->type == kHAPTLVFormatType_Union;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Gets the maximum length of an encoded value.
+ *
+ * @return true                     If the length is bounded.
+ * @return false                    Otherwise.
+ */
+HAP_RESULT_USE_CHECK
+static bool GetMaxValueBytes(const Format* format, uint64_t* numBytes) {
+    HAPPrecondition(format);
+    HAPPrecondition(numBytes);
+
+    const IntegerInfo* _Nullable info = GetIntegerInfo(format->type);
+    if (info) {
+        *numBytes = HAPNonnull(info)->numBytes;
+        return true;
+    }
+    switch (format->type) {
+        case kHAPTLVFormatType_None: {
+            *numBytes = 0;
+        }
+            return true;
+        case kHAPTLVFormatType_Enum: {
+            *numBytes = sizeof(uint8_t);
+        }
+            return true;
+        case kHAPTLVFormatType_Data:
+        case kHAPTLVFormatType_String: {
+            Constant maxLength = EvaluateConstant(HAPNonnull(format->maximum));
+            if (!maxLength.isKnown || maxLength.isNegative || maxLength.magnitude > UINT32_MAX) {
+                return false;
+            }
+            *numBytes = maxLength.magnitude;
+        }
+            return true;
+        case kHAPTLVFormatType_Struct: {
+            *numBytes = 0;
+            for (size_t i = 0; i < format->numMembers; i++) {
+                uint64_t numValueBytes;
+                if (!GetMaxValueBytes(HAPNonnull(format->members)[i].format, &numValueBytes)) {
+                    return false;
+                }
+                uint64_t numFragments = numValueBytes ? (numValueBytes + UINT8_MAX - 1) / UINT8_MAX : 1;
+                *numBytes += numValueBytes + 2 * numFragments;
+            }
+        }
+            return true;
+        default: {
+        }
+            return false;
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/** Generated code. */
+static Text output;
+
+static void Emit(size_t indentation, const char* format, ...) HAP_PRINTFLIKE(2, 3);
+
+/**
+ * Emits a line of generated code.
+ *
+ * @param      indentation          Indentation level.
+ * @param      format               Format string.
+ */
+static void Emit(size_t indentation, const char* format, ...) {
+    HAPPrecondition(format);
+
+    for (size_t i = 0; i < indentation; i++) {
+        AppendBytes(&output, "    ", 4);
+    }
+    va_list args;
+    va_start(args, format);
+    AppendFormat(&output, format, args);
+    va_end(args);
+    AppendBytes(&output, "\n", 1);
+}
+
+/**
+ * Emits an empty line.
+ */
+static void EmitEmptyLine(void) {
+    AppendBytes(&output, "\n", 1);
+}
+
+/** Column limit of generated code. */
+#define kMaxLineLength ((size_t) 120)
+
+/**
+ * Emits a function call statement. Arguments are moved to separate lines if the call does not fit on one line.
+ *
+ * @param      indentation          Indentation level.
+ * @param      function             Name of the function.
+ * @param      arguments            Arguments.
+ * @param      numArguments         Number of arguments.
+ */
+static void EmitCall(size_t indentation, const char* function, const char* const* arguments, size_t numArguments) {
+    HAPPrecondition(function);
+    HAPPrecondition(arguments);
+
+    size_t numBytes = 4 * indentation + HAPStringGetNumBytes(function) + HAPStringGetNumBytes("();");
+    for (size_t i = 0; i < numArguments; i++) {
+        numBytes += HAPStringGetNumBytes(arguments[i]) + (i ? HAPStringGetNumBytes(", ") : 0);
+    }
+    if (numBytes <= kMaxLineLength) {
+        for (size_t i = 0; i < indentation; i++) {
+            AppendBytes(&output, "    ", 4);
+        }
+        AppendBytes(&output, function, HAPStringGetNumBytes(function));
+        AppendBytes(&output, "(", 1);
+        for (size_t i = 0; i < numArguments; i++) {
+            if (i) {
+                AppendBytes(&output, ", ", 2);
+            }
+            AppendBytes(&output, arguments[i], HAPStringGetNumBytes(arguments[i]));
+        }
+        AppendBytes(&output, ");\n", 3);
+        return;
+    }
+    Emit(indentation, "%s(", function);
+    for (size_t i = 0; i < numArguments; i++) {
+        Emit(indentation + 2, "%s%s", arguments[i], i == numArguments - 1 ? ");" : ",");
+    }
+}
+
+/**
+ * Emits a HAPLogTLV statement.
+ *
+ * @param      indentation          Indentation level.
+ * @param      tlvType              TLV type expression.
+ * @param      debugDescription     Debug description expression.
+ * @param      message              Log message. Must not contain quotes or backslashes.
+ * @param      argument             Format argument of the log message, if applicable.
+ */
+static void EmitLog(
+        size_t indentation,
+        const char* tlvType,
+        const char* debugDescription,
+        const char* message,
+        const char* _Nullable argument) {
+    HAPPrecondition(tlvType);
+    HAPPrecondition(debugDescription);
+    HAPPrecondition(message);
+
+    char quotedMessage[256];
+    int numBytes = snprintf(quotedMessage, sizeof quotedMessage, "\"%s\"", message);
+    HAPAssert(numBytes > 0 && (size_t) numBytes < sizeof quotedMessage);
+    const char* arguments[] = { "&generatedTLVLogObject", tlvType, debugDescription, quotedMessage, argument };
+    EmitCall(indentation, "HAPLogTLV", arguments, argument ? 5 : 4);
+}
+
+/**
+ * Gets the text of a string literal for use in comments.
+ */
+HAP_RESULT_USE_CHECK
+static const char* GetCommentText(const char* literal) {
+    HAPPrecondition(literal);
+
+    size_t numBytes = HAPStringGetNumBytes(literal);
+    if (numBytes >= 2 && literal[0] == '"' && literal[numBytes - 1] == '"') {
+        return CopyString(&literal[1], numBytes - 2);
+    }
+    return literal;
+}
+
+/**
+ * How errors are reported by generated code.
+ */
+typedef enum {
+    /** Return the error. */
+    kErrorMode_Return,
+
+    /** Store the error in the enumeration context and stop enumerating. */
+    kErrorMode_Context
+} ErrorMode;
+
+static void EmitError(size_t indentation, ErrorMode mode, const char* error) {
+    HAPPrecondition(error);
+
+    if (mode == kErrorMode_Return) {
+        Emit(indentation, "return %s;", error);
+    } else {
+        Emit(indentation, "context->err = %s;", error);
+        Emit(indentation, "*shouldContinue = false;");
+        Emit(indentation, "return;");
+    }
+}
+
+/**
+ * Wraps an expression in parentheses unless it is a plain identifier or number.
+ */
+HAP_RESULT_USE_CHECK
+static const char* Parenthesize(const char* text) {
+    HAPPrecondition(text);
+
+    const char* c = text;
+    if (*c == '-') {
+        c++;
+    }
+    for (; *c; c++) {
+        if (!IsIdentifierCharacter(*c)) {
+            Text parenthesized = { 0 };
+            AppendBytes(&parenthesized, "(", 1);
+            AppendBytes(&parenthesized, text, HAPStringGetNumBytes(text));
+            AppendBytes(&parenthesized, ")", 1);
+            return HAPNonnull(parenthesized.bytes);
+        }
+    }
+    return text;
+}
+
+/**
+ * Emits code that encodes a scalar value into bytes / maxBytes and sets numBytes.
+ */
+static void EmitEncodeScalar(
+        size_t indentation,
+        ErrorMode mode,
+        const Format* format,
+        const Member* member,
+        const char* value) {
+    HAPPrecondition(format);
+    HAPPrecondition(member);
+    HAPPrecondition(value);
+
+    const char* tlvType = member->tlvType;
+    const char* debugDescription = member->debugDescription;
+    const IntegerInfo* _Nullable info = GetIntegerInfo(format->type);
+    if (info) {
+        if (!IsMinimumTrivial(HAPNonnull(info), HAPNonnull(format->minimum))) {
+            Emit(indentation, "HAPPrecondition(%s >= %s);", value, Parenthesize(HAPNonnull(format->minimum)));
+        }
+        if (!IsMaximumTrivial(HAPNonnull(info), HAPNonnull(format->maximum))) {
+            Emit(indentation, "HAPPrecondition(%s <= %s);", value, Parenthesize(HAPNonnull(format->maximum)));
+        }
+        Emit(indentation, "if (maxBytes < sizeof(%s)) {", HAPNonnull(info)->typeName);
+        EmitLog(indentation + 1, tlvType, debugDescription, "Not enough memory to encode integer value.", NULL);
+        EmitError(indentation + 1, mode, "kHAPError_OutOfResources");
+        Emit(indentation, "}");
+        if (HAPNonnull(info)->numBytes == 1) {
+            Emit(indentation, "%s(bytes, (uint8_t) %s);", HAPNonnull(info)->writeFunction, value);
+        } else {
+            Emit(indentation, "%s(bytes, %s);", HAPNonnull(info)->writeFunction, value);
+        }
+        Emit(indentation, "numBytes = sizeof(%s);", HAPNonnull(info)->typeName);
+        return;
+    }
+
+    switch (format->type) {
+        case kHAPTLVFormatType_Enum: {
+            Emit(indentation, "HAPPrecondition(%s(%s));", HAPNonnull(format->isValid), value);
+            Emit(indentation, "if (maxBytes < sizeof(uint8_t)) {");
+            EmitLog(indentation + 1, tlvType, debugDescription, "Not enough memory to encode enumeration value.", NULL);
+            EmitError(indentation + 1, mode, "kHAPError_OutOfResources");
+            Emit(indentation, "}");
+            Emit(indentation, "HAPWriteUInt8(bytes, (uint8_t) %s);", value);
+            Emit(indentation, "numBytes = sizeof(uint8_t);");
+        } break;
+        case kHAPTLVFormatType_Data: {
+            if (!IsConstantEqual(HAPNonnull(format->minimum), false, 0)) {
+                Emit(indentation,
+                     "HAPPrecondition(%s.numBytes >= %s);",
+                     value,
+                     Parenthesize(HAPNonnull(format->minimum)));
+            }
+            if (!HAPStringAreEqual(HAPNonnull(format->maximum), "SIZE_MAX")) {
+                Emit(indentation,
+                     "HAPPrecondition(%s.numBytes <= %s);",
+                     value,
+                     Parenthesize(HAPNonnull(format->maximum)));
+            }
+            Emit(indentation, "if (maxBytes < %s.numBytes) {", value);
+            EmitLog(indentation + 1, tlvType, debugDescription, "Not enough memory to encode data value.", NULL);
+            EmitError(indentation + 1, mode, "kHAPError_OutOfResources");
+            Emit(indentation, "}");
+            Emit(indentation, "HAPRawBufferCopyBytes(bytes, %s.bytes, %s.numBytes);", value, value);
+            Emit(indentation, "numBytes = %s.numBytes;", value);
+        } break;
+        case kHAPTLVFormatType_String: {
+            Emit(indentation, "size_t numValueBytes = HAPStringGetNumBytes(%s);", value);
+            if (format->isValid) {
+                Emit(indentation, "HAPPrecondition(%s(%s));", HAPNonnull(format->isValid), value);
+            }
+            Emit(indentation, "HAPPrecondition(HAPUTF8IsValidData(%s, numValueBytes));", value);
+            if (!IsConstantEqual(HAPNonnull(format->minimum), false, 0)) {
+                Emit(indentation, "HAPPrecondition(numValueBytes >= %s);", Parenthesize(HAPNonnull(format->minimum)));
+            }
+            if (!HAPStringAreEqual(HAPNonnull(format->maximum), "SIZE_MAX")) {
+                Emit(indentation, "HAPPrecondition(numValueBytes <= %s);", Parenthesize(HAPNonnull(format->maximum)));
+            }
+            Emit(indentation, "if (maxBytes < numValueBytes) {");
+            EmitLog(indentation + 1, tlvType, debugDescription, "Not enough memory to encode string value.", NULL);
+            EmitError(indentation + 1, mode, "kHAPError_OutOfResources");
+            Emit(indentation, "}");
+            Emit(indentation, "HAPRawBufferCopyBytes(bytes, %s, numValueBytes);", value);
+            Emit(indentation, "numBytes = numValueBytes;");
+        } break;
+        case kHAPTLVFormatType_Value: {
+            Emit(indentation, "err = %s(&%s, bytes, maxBytes, &numBytes);", HAPNonnull(format->encode), value);
+            Emit(indentation, "if (err) {");
+            Emit(indentation + 1,
+                 "HAPAssert(err == kHAPError_Unknown || err == kHAPError_InvalidState || "
+                 "err == kHAPError_OutOfResources || err == kHAPError_Busy);");
+            EmitLog(indentation + 1, tlvType, debugDescription, "Not enough memory to encode value.", NULL);
+            EmitError(indentation + 1, mode, "err");
+            Emit(indentation, "}");
+            Emit(indentation, "HAPAssert(numBytes <= maxBytes);");
+        } break;
+        default: {
+            HAPFatalError();
+        }
+    }
+}
+
+/**
+ * Emits statements that encode a member value and append it to the writer.
+ *
+ * The statements must be placed in their own block.
+ */
+static void EmitEncodeTLV(
+        size_t indentation,
+        ErrorMode mode,
+        const char* writer,
+        const Member* member,
+        const char* value) {
+    HAPPrecondition(writer);
+    HAPPrecondition(member);
+    HAPPrecondition(value);
+
+    const Format* format = member->format;
+    Emit(indentation, "void* bytes;");
+    Emit(indentation, "size_t maxBytes;");
+    Emit(indentation, "HAPTLVWriterGetScratchBytes(%s, &bytes, &maxBytes);", writer);
+    EmitEmptyLine();
+    Emit(indentation, "size_t numBytes;");
+    if (IsAggregate(format)) {
+        Emit(indentation, "HAPTLVWriterRef subWriter;");
+        Emit(indentation, "HAPTLVWriterCreate(&subWriter, bytes, maxBytes);");
+        size_t numValueBytes = HAPStringGetNumBytes(value);
+        if (numValueBytes > 3 && value[0] == '(' && value[1] == '*' && value[numValueBytes - 1] == ')') {
+            // Dereferenced pointer: (*item).
+            Emit(indentation,
+                 "err = Encode%s(&subWriter, %.*s);",
+                 format->name,
+                 (int) (numValueBytes - 3),
+                 &value[2]);
+        } else {
+            Emit(indentation, "err = Encode%s(&subWriter, &%s);", format->name, value);
+        }
+        Emit(indentation, "if (err) {");
+        EmitLog(indentation + 1, member->tlvType, member->debugDescription, "Value encoding failed.", NULL);
+        EmitError(indentation + 1, mode, "err");
+        Emit(indentation, "}");
+        Emit(indentation, "HAPTLVWriterGetBuffer(&subWriter, &bytes, &numBytes);");
+    } else {
+        EmitEncodeScalar(indentation, mode, format, member, value);
+    }
+    EmitEmptyLine();
+    Emit(indentation, "err = HAPTLVWriterAppend(");
+    Emit(indentation + 2,
+         "%s, &(const HAPTLV) { .type = %s, .value = { .bytes = bytes, .numBytes = numBytes } });",
+         writer,
+         member->tlvType);
+    Emit(indentation, "if (err) {");
+    Emit(indentation + 1, "HAPAssert(err == kHAPError_OutOfResources);");
+    EmitError(indentation + 1, mode, "err");
+    Emit(indentation, "}");
+}
+
+/**
+ * Emits code that decodes the value of the TLV item tlv into a member value.
+ */
+static void EmitDecodeTLV(size_t indentation, const Member* member, const char* value) {
+    HAPPrecondition(member);
+    HAPPrecondition(value);
+
+    const Format* format = member->format;
+    const char* tlvType = member->tlvType;
+    const char* debugDescription = member->debugDescription;
+    if (IsAggregate(format)) {
+        Emit(indentation, "HAPTLVReaderRef subReader;");
+        Emit(indentation, "HAPTLVReaderCreate(&subReader, (void*) (uintptr_t) tlv.value.bytes, tlv.value.numBytes);");
+        Emit(indentation, "err = Decode%s(&subReader, &%s);", format->name, value);
+        Emit(indentation, "if (err) {");
+        Emit(indentation + 1, "HAPAssert(err == kHAPError_InvalidData);");
+        EmitLog(indentation + 1, tlvType, debugDescription, "Invalid value.", NULL);
+        Emit(indentation + 1, "return err;");
+        Emit(indentation, "}");
+        return;
+    }
+
+    const IntegerInfo* _Nullable info = GetIntegerInfo(format->type);
+    if (info) {
+        const char* typeName = HAPNonnull(info)->typeName;
+        bool isMinimumTrivial = IsMinimumTrivial(HAPNonnull(info), HAPNonnull(format->minimum));
+        bool isMaximumTrivial = IsMaximumTrivial(HAPNonnull(info), HAPNonnull(format->maximum));
+        Emit(indentation, "if (tlv.value.numBytes > sizeof(%s)) {", typeName);
+        EmitLog(indentation + 1,
+                tlvType,
+                debugDescription,
+                "Invalid integer length (%zu bytes).",
+                "tlv.value.numBytes");
+        Emit(indentation + 1, "return kHAPError_InvalidData;");
+        Emit(indentation, "}");
+        Emit(indentation, "%s integerValue = 0;", typeName);
+        Emit(indentation, "const uint8_t* integerBytes = tlv.value.bytes;");
+        Emit(indentation, "for (size_t i = 0; i < tlv.value.numBytes; i++) {");
+        Emit(indentation + 1,
+             "integerValue |= (%s)(((%s) integerBytes[i]) << (i * CHAR_BIT));",
+             typeName,
+             HAPNonnull(info)->intermediateTypeName);
+        Emit(indentation, "}");
+        if (!isMinimumTrivial || !isMaximumTrivial) {
+            if (isMinimumTrivial) {
+                Emit(indentation, "if (integerValue > %s) {", Parenthesize(HAPNonnull(format->maximum)));
+            } else if (isMaximumTrivial) {
+                Emit(indentation, "if (integerValue < %s) {", Parenthesize(HAPNonnull(format->minimum)));
+            } else {
+                Emit(indentation,
+                     "if (integerValue < %s || integerValue > %s) {",
+                     Parenthesize(HAPNonnull(format->minimum)),
+                     Parenthesize(HAPNonnull(format->maximum)));
+            }
+            EmitLog(indentation + 1, tlvType, debugDescription, "Invalid integer value.", NULL);
+            Emit(indentation + 1, "return kHAPError_InvalidData;");
+            Emit(indentation, "}");
+        }
+        Emit(indentation, "%s = integerValue;", value);
+        return;
+    }
+
+    switch (format->type) {
+        case kHAPTLVFormatType_Enum: {
+            Emit(indentation, "if (tlv.value.numBytes != sizeof(uint8_t)) {");
+            EmitLog(indentation + 1,
+                    tlvType,
+                    debugDescription,
+                    "Invalid enumeration length (%zu bytes).",
+                    "tlv.value.numBytes");
+            Emit(indentation + 1, "return kHAPError_InvalidData;");
+            Emit(indentation, "}");
+            Emit(indentation, "uint8_t enumerationValue = HAPReadUInt8(tlv.value.bytes);");
+            Emit(indentation, "if (!%s(enumerationValue)) {", HAPNonnull(format->isValid));
+            EmitLog(indentation + 1, tlvType, debugDescription, "Invalid enumeration value: %u.", "enumerationValue");
+            Emit(indentation + 1, "return kHAPError_InvalidData;");
+            Emit(indentation, "}");
+            Emit(indentation, "%s = enumerationValue;", value);
+        } break;
+        case kHAPTLVFormatType_Data:
+        case kHAPTLVFormatType_String: {
+            bool isMinimumTrivial = IsConstantEqual(HAPNonnull(format->minimum), false, 0);
+            bool isMaximumTrivial = HAPStringAreEqual(HAPNonnull(format->maximum), "SIZE_MAX");
+            if (!isMinimumTrivial || !isMaximumTrivial) {
+                if (isMinimumTrivial) {
+                    Emit(indentation, "if (tlv.value.numBytes > %s) {", Parenthesize(HAPNonnull(format->maximum)));
+                } else if (isMaximumTrivial) {
+                    Emit(indentation, "if (tlv.value.numBytes < %s) {", Parenthesize(HAPNonnull(format->minimum)));
+                } else {
+                    Emit(indentation,
+                         "if (tlv.value.numBytes < %s || tlv.value.numBytes > %s) {",
+                         Parenthesize(HAPNonnull(format->minimum)),
+                         Parenthesize(HAPNonnull(format->maximum)));
+                }
+                EmitLog(indentation + 1, tlvType, debugDescription, "Invalid length: %zu.", "tlv.value.numBytes");
+                Emit(indentation + 1, "return kHAPError_InvalidData;");
+                Emit(indentation, "}");
+            }
+            if (format->type == kHAPTLVFormatType_Data) {
+                Emit(indentation, "%s.bytes = (void*) (uintptr_t) tlv.value.bytes;", value);
+                Emit(indentation, "%s.numBytes = tlv.value.numBytes;", value);
+                break;
+            }
+            Emit(indentation, "if (HAPStringGetNumBytes(tlv.value.bytes) != tlv.value.numBytes) {");
+            EmitLog(indentation + 1,
+                    tlvType,
+                    debugDescription,
+                    "Invalid string value: Contains NULL characters.",
+                    NULL);
+            Emit(indentation + 1, "return kHAPError_InvalidData;");
+            Emit(indentation, "}");
+            Emit(indentation, "if (!HAPUTF8IsValidData(tlv.value.bytes, tlv.value.numBytes)) {");
+            EmitLog(indentation + 1, tlvType, debugDescription, "Invalid string value: Not valid UTF-8.", NULL);
+            Emit(indentation + 1, "return kHAPError_InvalidData;");
+            Emit(indentation, "}");
+            if (format->isValid) {
+                Emit(indentation, "if (!%s(tlv.value.bytes)) {", HAPNonnull(format->isValid));
+                EmitLog(indentation + 1, tlvType, debugDescription, "Invalid string value.", NULL);
+                Emit(indentation + 1, "return kHAPError_InvalidData;");
+                Emit(indentation, "}");
+            }
+            Emit(indentation, "%s = (char*) (uintptr_t) tlv.value.bytes;", value);
+        } break;
+        case kHAPTLVFormatType_Value: {
+            Emit(indentation,
+                 "err = %s(&%s, (void*) (uintptr_t) tlv.value.bytes, tlv.value.numBytes);",
+                 HAPNonnull(format->decode),
+                 value);
+            Emit(indentation, "if (err) {");
+            Emit(indentation + 1, "HAPAssert(err == kHAPError_InvalidData);");
+            EmitLog(indentation + 1, tlvType, debugDescription, "Invalid value.", NULL);
+            Emit(indentation + 1, "return err;");
+            Emit(indentation, "}");
+        } break;
+        default: {
+            HAPFatalError();
+        }
+    }
+}
+
+/**
+ * Emits the loop header that reads TLV items one by one.
+ */
+static void EmitReadLoopBegin(size_t indentation, const char* reader) {
+    HAPPrecondition(reader);
+
+    Emit(indentation, "for (;;) {");
+    Emit(indentation + 1, "HAPTLV tlv;");
+    Emit(indentation + 1, "bool found;");
+    Emit(indentation + 1, "err = HAPTLVReaderGetNext(%s, &found, &tlv);", reader);
+    Emit(indentation + 1, "if (err) {");
+    Emit(indentation + 2, "HAPAssert(err == kHAPError_InvalidData);");
+    Emit(indentation + 2, "return err;");
+    Emit(indentation + 1, "}");
+    Emit(indentation + 1, "if (!found) {");
+    Emit(indentation + 2, "break;");
+    Emit(indentation + 1, "}");
+    EmitEmptyLine();
+    Emit(indentation + 1, "switch (tlv.type) {");
+}
+
+static void EmitReadLoopEnd(size_t indentation) {
+    Emit(indentation + 2, "default: {");
+    const char* arguments[] = {
+        "&generatedTLVLogObject", "tlv.value.bytes", "tlv.value.numBytes", "\"[%02x] Ignored TLV.\"", "tlv.type"
+    };
+    EmitCall(indentation + 3, "HAPLogSensitiveBuffer", arguments, HAPArrayCount(arguments));
+    Emit(indentation + 2, "} break;");
+    Emit(indentation + 1, "}");
+    Emit(indentation, "}");
+}
+
+static void EmitStructFunctions(const Format* format) {
+    HAPPrecondition(format);
+    HAPPrecondition(format->type == kHAPTLVFormatType_Struct);
+
+    const char* name = format->name;
+    const char* valueTypeName = HAPNonnull(format->valueTypeName);
+    const Member* members = HAPNonnull(format->members);
+
+    Emit(0, "HAP_RESULT_USE_CHECK");
+    Emit(0, "static HAPError Encode%s(HAPTLVWriterRef* writer, %s* value) {", name, valueTypeName);
+    Emit(1, "HAPPrecondition(writer);");
+    Emit(1, "HAPPrecondition(value);");
+    if (format->isValid) {
+        Emit(1, "HAPPrecondition(%s(value));", HAPNonnull(format->isValid));
+    }
+    EmitEmptyLine();
+    Emit(1, "HAPError err;");
+    for (size_t i = 0; i < format->numMembers; i++) {
+        const Member* member = &members[i];
+        Text value = { 0 };
+        AppendBytes(&value, "value->", 7);
+        AppendBytes(
+                &value, HAPNonnull(member->valueMemberName), HAPStringGetNumBytes(HAPNonnull(member->valueMemberName)));
+        EmitEmptyLine();
+        Emit(1, "// %s.", GetCommentText(member->debugDescription));
+        if (member->isOptional) {
+            Emit(1, "if (value->%s) {", HAPNonnull(member->isSetMemberName));
+        } else {
+            Emit(1, "{");
+        }
+        EmitEncodeTLV(2, kErrorMode_Return, "writer", member, HAPNonnull(value.bytes));
+        Emit(1, "}");
+        free(value.bytes);
+    }
+    EmitEmptyLine();
+    Emit(1, "return kHAPError_None;");
+    Emit(0, "}");
+    EmitEmptyLine();
+
+    Emit(0, "HAP_RESULT_USE_CHECK");
+    Emit(0, "static HAPError Decode%s(HAPTLVReaderRef* reader, %s* value) {", name, valueTypeName);
+    Emit(1, "HAPPrecondition(reader);");
+    Emit(1, "HAPPrecondition(value);");
+    EmitEmptyLine();
+    Emit(1, "HAPError err;");
+    EmitEmptyLine();
+    Emit(1, "bool isSet[%zu];", format->numMembers);
+    Emit(1, "HAPRawBufferZero(isSet, sizeof isSet);");
+    EmitReadLoopBegin(1, "reader");
+    for (size_t i = 0; i < format->numMembers; i++) {
+        const Member* member = &members[i];
+        Text value = { 0 };
+        AppendBytes(&value, "value->", 7);
+        AppendBytes(
+                &value, HAPNonnull(member->valueMemberName), HAPStringGetNumBytes(HAPNonnull(member->valueMemberName)));
+        Emit(3, "case %s: {", member->tlvType);
+        Emit(4, "if (isSet[%zu]) {", i);
+        EmitLog(5, member->tlvType, member->debugDescription, "Duplicate TLV.", NULL);
+        Emit(5, "return kHAPError_InvalidData;");
+        Emit(4, "}");
+        Emit(4, "isSet[%zu] = true;", i);
+        EmitDecodeTLV(4, member, HAPNonnull(value.bytes));
+        Emit(3, "} break;");
+        free(value.bytes);
+    }
+    EmitReadLoopEnd(1);
+    EmitEmptyLine();
+    for (size_t i = 0; i < format->numMembers; i++) {
+        const Member* member = &members[i];
+        if (member->isOptional) {
+            Emit(1, "value->%s = isSet[%zu];", HAPNonnull(member->isSetMemberName), i);
+        } else {
+            Emit(1, "if (!isSet[%zu]) {", i);
+            EmitLog(2, member->tlvType, member->debugDescription, "TLV missing.", NULL);
+            Emit(2, "return kHAPError_InvalidData;");
+            Emit(1, "}");
+        }
+    }
+    if (format->isValid) {
+        Emit(1, "if (!%s(value)) {", HAPNonnull(format->isValid));
+        Emit(2, "return kHAPError_InvalidData;");
+        Emit(1, "}");
+    }
+    Emit(1, "return kHAPError_None;");
+    Emit(0, "}");
+    EmitEmptyLine();
+}
+
+/**
+ * Gets the C type of a value of a scalar or struct format, as passed to sequence enumeration callbacks.
+ */
+HAP_RESULT_USE_CHECK
+static const char* GetItemTypeName(const Format* format) {
+    HAPPrecondition(format);
+
+    const IntegerInfo* _Nullable info = GetIntegerInfo(format->type);
+    if (info) {
+        return HAPNonnull(info)->typeName;
+    }
+    switch (format->type) {
+        case kHAPTLVFormatType_Enum: {
+            return "uint8_t";
+        }
+        case kHAPTLVFormatType_Data: {
+            return "HAPDataTLVValue";
+        }
+        case kHAPTLVFormatType_String: {
+            return "char*";
+        }
+        case kHAPTLVFormatType_Value: {
+            return "HAPTLVValue";
+        }
+        default: {
+            return HAPNonnull(format->valueTypeName);
+        }
+    }
+}
+
+static void EmitSequenceFunctions(const Format* format) {
+    HAPPrecondition(format);
+    HAPPrecondition(format->type == kHAPTLVFormatType_Sequence);
+
+    const char* name = format->name;
+    const char* valueTypeName = HAPNonnull(format->valueTypeName);
+    const Member* item = &format->item;
+    const Member* separator = &format->separator;
+    const char* itemTypeName = GetItemTypeName(item->format);
+
+    Emit(0, "typedef struct {");
+    Emit(1, "HAPTLVWriterRef* writer;");
+    Emit(1, "HAPError err;");
+    Emit(1, "bool needsSeparator;");
+    Emit(0, "} Encode%sContext;", name);
+    EmitEmptyLine();
+    Emit(0, "static void Encode%sItem(void* _Nullable context_, HAPTLVValue* item_, bool* shouldContinue) {", name);
+    Emit(1, "HAPPrecondition(context_);");
+    Emit(1, "Encode%sContext* context = context_;", name);
+    Emit(1, "HAPPrecondition(item_);");
+    Emit(1, "%s* item = item_;", itemTypeName);
+    Emit(1, "HAPPrecondition(shouldContinue);");
+    EmitEmptyLine();
+    Emit(1, "HAPError err;");
+    EmitEmptyLine();
+    Emit(1, "if (context->needsSeparator) {");
+    Emit(2, "err = HAPTLVWriterAppend(");
+    Emit(4,
+         "context->writer, &(const HAPTLV) { .type = %s, .value = { .bytes = NULL, .numBytes = 0 } });",
+         separator->tlvType);
+    Emit(2, "if (err) {");
+    Emit(3, "HAPAssert(err == kHAPError_OutOfResources);");
+    EmitError(3, kErrorMode_Context, "err");
+    Emit(2, "}");
+    Emit(1, "}");
+    Emit(1, "context->needsSeparator = true;");
+    EmitEmptyLine();
+    Emit(1, "// %s.", GetCommentText(item->debugDescription));
+    EmitEncodeTLV(1, kErrorMode_Context, "context->writer", item, "(*item)");
+    Emit(0, "}");
+    EmitEmptyLine();
+
+    Emit(0, "HAP_RESULT_USE_CHECK");
+    Emit(0, "static HAPError Encode%s(HAPTLVWriterRef* writer, %s* value) {", name, valueTypeName);
+    Emit(1, "HAPPrecondition(writer);");
+    Emit(1, "HAPPrecondition(value);");
+    Emit(1, "HAPPrecondition(value->enumerate);");
+    EmitEmptyLine();
+    Emit(1, "HAPError err;");
+    EmitEmptyLine();
+    Emit(1, "Encode%sContext context;", name);
+    Emit(1, "HAPRawBufferZero(&context, sizeof context);");
+    Emit(1, "context.writer = writer;");
+    Emit(1, "err = value->enumerate(&value->dataSource, Encode%sItem, &context);", name);
+    Emit(1, "if (!err) {");
+    Emit(2, "err = context.err;");
+    Emit(1, "}");
+    Emit(1, "return err;");
+    Emit(0, "}");
+    EmitEmptyLine();
+
+    Emit(0, "HAP_RESULT_USE_CHECK");
+    Emit(0, "static HAPError Enumerate%s(", name);
+    Emit(2, "HAPSequenceTLVDataSourceRef* dataSource,");
+    Emit(2, "HAPSequenceTLVEnumerateCallback callback,");
+    Emit(2, "void* _Nullable context) {");
+    Emit(1, "HAPPrecondition(dataSource);");
+    Emit(1, "HAPPrecondition(callback);");
+    EmitEmptyLine();
+    Emit(1, "HAPError err;");
+    EmitEmptyLine();
+    Emit(1, "HAPTLVReaderRef* reader = (HAPTLVReaderRef*) dataSource;");
+    Emit(1, "size_t dataSourceOffset = HAP_OFFSETOF(%s, dataSource);", valueTypeName);
+    Emit(1, "%s* value = (%s*) ((char*) dataSource - dataSourceOffset);", valueTypeName, valueTypeName);
+    Emit(1, "bool shouldContinue = true;");
+    EmitReadLoopBegin(1, "reader");
+    Emit(3, "case %s: {", item->tlvType);
+    EmitDecodeTLV(4, item, "value->_");
+    Emit(4, "if (shouldContinue) {");
+    Emit(5, "callback(context, &value->_, &shouldContinue);");
+    Emit(4, "}");
+    Emit(3, "} break;");
+    Emit(3, "case %s: {", separator->tlvType);
+    Emit(3, "} break;");
+    EmitReadLoopEnd(1);
+    Emit(1, "return kHAPError_None;");
+    Emit(0, "}");
+    EmitEmptyLine();
+
+    Emit(0, "HAP_RESULT_USE_CHECK");
+    Emit(0, "static HAPError Decode%s(HAPTLVReaderRef* reader, %s* value) {", name, valueTypeName);
+    Emit(1, "HAPPrecondition(reader);");
+    Emit(1, "HAPPrecondition(value);");
+    EmitEmptyLine();
+    Emit(1, "// Items are decoded when the sequence is enumerated.");
+    Emit(1, "HAPRawBufferZero(value, sizeof *value);");
+    Emit(1, "HAPRawBufferCopyBytes(&value->dataSource, reader, sizeof *reader);");
+    Emit(1, "value->enumerate = Enumerate%s;", name);
+    Emit(1, "return kHAPError_None;");
+    Emit(0, "}");
+    EmitEmptyLine();
+}
+
+static void EmitFile(const char* inputName) {
+    HAPPrecondition(inputName);
+
+    Emit(0, "// Copyright (c) 2015-2019 The HomeKit ADK Contributors");
+    Emit(0, "//");
+    Emit(0, "// Licensed under the Apache License, Version 2.0 (the “License”);");
+    Emit(0, "// you may not use this file except in compliance with the License.");
+    Emit(0, "// See [CONTRIBUTORS.md] for the list of HomeKit ADK project authors.");
+    EmitEmptyLine();
+    Emit(0, "// Generated by TLVCodeGenerator from %s. Do not edit.", inputName);
+    Emit(0, "//");
+    Emit(0, "// Include after the value types and callbacks referenced by the formats have been declared.");
+    EmitEmptyLine();
+    Emit(0, "#ifndef HAP_TLV_GENERATED_CODE_SUPPORT");
+    Emit(0, "#define HAP_TLV_GENERATED_CODE_SUPPORT");
+    Emit(0,
+         "static const HAPLogObject generatedTLVLogObject = { .subsystem = kHAP_LogSubsystem, "
+         ".category = \"TLVGenerated\" };");
+    Emit(0,
+         "HAP_STATIC_ASSERT(sizeof(HAPTLVReaderRef) <= sizeof(HAPSequenceTLVDataSourceRef), "
+         "HAPTLVGeneratedSequenceDataSource);");
+    Emit(0, "#endif");
+    EmitEmptyLine();
+
+    for (size_t i = 0; i < numFormats; i++) {
+        const Format* format = formats[i];
+        uint64_t numBytes;
+        if (format->type == kHAPTLVFormatType_Struct && GetMaxValueBytes(format, &numBytes)) {
+            Emit(0, "/** Maximum length of an encoded %s value. */", format->name);
+            Emit(0, "#define k%s_MaxBytes ((size_t) %llu)", format->name, (unsigned long long) numBytes);
+            EmitEmptyLine();
+        }
+    }
+
+    Emit(0, "HAP_DIAGNOSTIC_PUSH");
+    Emit(0, "HAP_DIAGNOSTIC_IGNORED_CLANG(\"-Wunused-function\")");
+    Emit(0, "HAP_DIAGNOSTIC_IGNORED_GCC(\"-Wunused-function\")");
+    EmitEmptyLine();
+    for (size_t i = 0; i < numFormats; i++) {
+        const Format* format = formats[i];
+        if (!IsAggregate(format)) {
+            continue;
+        }
+        Emit(0, "HAP_RESULT_USE_CHECK");
+        Emit(0,
+             "static HAPError Encode%s(HAPTLVWriterRef* writer, %s* value);",
+             format->name,
+             HAPNonnull(format->valueTypeName));
+        EmitEmptyLine();
+        Emit(0, "HAP_RESULT_USE_CHECK");
+        Emit(0,
+             "static HAPError Decode%s(HAPTLVReaderRef* reader, %s* value);",
+             format->name,
+             HAPNonnull(format->valueTypeName));
+        EmitEmptyLine();
+    }
+    for (size_t i = 0; i < numFormats; i++) {
+        const Format* format = formats[i];
+        if (format->type == kHAPTLVFormatType_Struct) {
+            EmitStructFunctions(format);
+        } else if (format->type == kHAPTLVFormatType_Sequence) {
+            EmitSequenceFunctions(format);
+        }
+    }
+    Emit(0, "HAP_DIAGNOSTIC_POP");
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+HAP_RESULT_USE_CHECK
+static bool ReadFile(const char* path, char* _Nullable* _Nonnull bytes, size_t* numBytes) {
+    HAPPrecondition(path);
+    HAPPrecondition(bytes);
+    HAPPrecondition(numBytes);
+
+    *bytes = NULL;
+    *numBytes = 0;
+
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+    Text text = { 0 };
+    for (;;) {
+        char buffer[4096];
+        size_t numBufferBytes = fread(buffer, 1, sizeof buffer, file);
+        if (!numBufferBytes) {
+            break;
+        }
+        AppendBytes(&text, buffer, numBufferBytes);
+    }
+    bool ok = !ferror(file);
+    fclose(file);
+    if (!ok) {
+        free(text.bytes);
+        return false;
+    }
+    *bytes = text.bytes ? text.bytes : CopyString("", 0);
+    *numBytes = text.numBytes;
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    const char* _Nullable outputPath = NULL;
+    bool isCheck = false;
+    int i = 1;
+    for (; i < argc - 1; i += 2) {
+        if (HAPStringAreEqual(argv[i], "-o")) {
+            outputPath = argv[i + 1];
+        } else if (HAPStringAreEqual(argv[i], "--check")) {
+            outputPath = argv[i + 1];
+            isCheck = true;
+        } else {
+            break;
+        }
+    }
+    if (i != argc - 1) {
+        fprintf(stderr,
+                "Usage: TLVCodeGenerator [-o OUTPUT | --check GOLDEN] INPUT\n"
+                "\n"
+                "Generates encode and decode functions for the HAPStructTLVFormat and HAPSequenceTLVFormat\n"
+                "declarations in INPUT. With --check, compares the generated code against GOLDEN instead.\n");
+        return EXIT_FAILURE;
+    }
+    inputPath = argv[i];
+
+    char* _Nullable inputBytes;
+    size_t numInputBytes;
+    if (!ReadFile(inputPath, &inputBytes, &numInputBytes)) {
+        Fail(0, "Cannot read file.");
+    }
+    ParseDeclarations(HAPNonnull(inputBytes), numInputBytes);
+    for (size_t j = 0; j < numDeclarations; j++) {
+        const Node* _Nullable type = GetEntry(declarations[j].value, "type");
+        if (!type || HAPNonnull(type)->kind != kNodeKind_Expression) {
+            continue;
+        }
+        const char* text = HAPNonnull(HAPNonnull(type)->text);
+        if (HAPStringAreEqual(text, "kHAPTLVFormatType_Struct") ||
+            HAPStringAreEqual(text, "kHAPTLVFormatType_Sequence")) {
+            Node reference = { .kind = kNodeKind_Reference, .line = declarations[j].value->line };
+            reference.text = declarations[j].name;
+            const Format* format = GetFormat(&reference, declarations[j].name);
+            HAPAssert(format->list == declarations[j].value);
+        }
+    }
+    if (!numFormats) {
+        Fail(0, "No struct or sequence formats found.");
+    }
+
+    const char* inputName = inputPath;
+    for (const char* c = inputPath; *c; c++) {
+        if (*c == '/' || *c == '\\') {
+            inputName = c + 1;
+        }
+    }
+    EmitFile(inputName);
+
+    if (isCheck) {
+        char* _Nullable goldenBytes;
+        size_t numGoldenBytes;
+        if (!ReadFile(HAPNonnull(outputPath), &goldenBytes, &numGoldenBytes)) {
+            fprintf(stderr, "%s: error: Cannot read file.\n", HAPNonnull(outputPath));
+            return EXIT_FAILURE;
+        }
+        if (numGoldenBytes != output.numBytes ||
+            !HAPRawBufferAreEqual(HAPNonnull(goldenBytes), HAPNonnull(output.bytes), output.numBytes)) {
+            fprintf(stderr,
+                    "%s: error: Generated code differs. Regenerate with: TLVCodeGenerator -o %s %s\n",
+                    HAPNonnull(outputPath),
+                    HAPNonnull(outputPath),
+                    inputPath);
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    FILE* file = outputPath ? fopen(HAPNonnull(outputPath), "wb") : stdout;
+    if (!file) {
+        fprintf(stderr, "%s: error: Cannot write file.\n", HAPNonnull(outputPath));
+        return EXIT_FAILURE;
+    }
+    bool ok = fwrite(HAPNonnull(output.bytes), 1, output.numBytes, file) == output.numBytes;
+    if (outputPath) {
+        ok = !fclose(file) && ok;
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}